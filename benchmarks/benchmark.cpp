@@ -0,0 +1,156 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "benchmark.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <iomanip>
+
+#include "util/allocation_tracker.hpp"
+
+namespace {
+
+/** samples has to be sorted */
+double percentile(const std::vector<double>& samples, double p)
+{
+  if (samples.empty())
+    return 0.0;
+
+  const size_t index = static_cast<size_t>(p * static_cast<double>(samples.size() - 1) + 0.5);
+  return samples[std::min(index, samples.size() - 1)];
+}
+
+} // namespace
+
+BenchmarkRunner::BenchmarkRunner(const std::string& filter) :
+  m_filter(filter),
+  m_results()
+{
+}
+
+bool
+BenchmarkRunner::is_enabled(const std::string& name) const
+{
+  return m_filter.empty() || name.find(m_filter) != std::string::npos;
+}
+
+void
+BenchmarkRunner::run(const std::string& name, int iterations, size_t items,
+                     const std::function<void ()>& func)
+{
+  if (!is_enabled(name))
+    return;
+
+  func();
+
+  std::vector<double> samples;
+  samples.reserve(iterations);
+  const uint64_t allocations = AllocationTracker::get_thread_allocation_count();
+  for (int i = 0; i < iterations; ++i)
+  {
+    const auto start = std::chrono::steady_clock::now();
+    func();
+    const auto end = std::chrono::steady_clock::now();
+    samples.push_back(static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count()));
+  }
+  const uint64_t allocated = AllocationTracker::get_thread_allocation_count() - allocations;
+
+  double ns = 0.0;
+  for (const double sample : samples) {
+    ns += sample;
+  }
+  std::sort(samples.begin(), samples.end());
+
+  Result result;
+  result.name = name;
+  result.iterations = iterations;
+  result.items = items;
+  result.ns_per_iteration = ns / iterations;
+  result.ns_per_item = result.ns_per_iteration / static_cast<double>(std::max<size_t>(1, items));
+  result.ns_p50 = percentile(samples, 0.50);
+  result.ns_p99 = percentile(samples, 0.99);
+  result.allocations = AllocationTracker::is_available() ? static_cast<double>(allocated) / iterations : -1.0;
+  m_results.push_back(result);
+}
+
+void
+BenchmarkRunner::add_metric(const std::string& name, double value)
+{
+  if (m_results.empty())
+    return;
+
+  m_results.back().metrics.emplace_back(name, value);
+}
+
+void
+BenchmarkRunner::print(std::ostream& out) const
+{
+  out << std::left << std::setw(48) << "benchmark"
+      << std::right << std::setw(10) << "iter"
+      << std::setw(10) << "items"
+      << std::setw(16) << "ns/iter"
+      << std::setw(14) << "ns/item"
+      << std::setw(16) << "p50"
+      << std::setw(16) << "p99" << '\n';
+
+  for (const auto& result : m_results)
+  {
+    out << std::left << std::setw(48) << result.name
+        << std::right << std::setw(10) << result.iterations
+        << std::setw(10) << result.items
+        << std::fixed << std::setprecision(1)
+        << std::setw(16) << result.ns_per_iteration
+        << std::setw(14) << result.ns_per_item
+        << std::setw(16) << result.ns_p50
+        << std::setw(16) << result.ns_p99;
+    if (result.allocations >= 0.0) {
+      out << "  allocations=" << result.allocations;
+    }
+    for (const auto& metric : result.metrics) {
+      out << "  " << metric.first << '=' << metric.second;
+    }
+    out << '\n';
+  }
+}
+
+void
+BenchmarkRunner::print_json(std::ostream& out) const
+{
+  // benchmark and metric names never need escaping
+  out << "[\n";
+  for (size_t i = 0; i < m_results.size(); ++i)
+  {
+    const Result& result = m_results[i];
+    out << "  {\"name\": \"" << result.name << "\""
+        << ", \"iterations\": " << result.iterations
+        << ", \"items\": " << result.items
+        << ", \"ns_per_iteration\": " << result.ns_per_iteration
+        << ", \"ns_per_item\": " << result.ns_per_item
+        << ", \"ns_p50\": " << result.ns_p50
+        << ", \"ns_p99\": " << result.ns_p99;
+    if (result.allocations >= 0.0) {
+      out << ", \"allocations\": " << result.allocations;
+    }
+    for (const auto& metric : result.metrics) {
+      out << ", \"" << metric.first << "\": " << metric.second;
+    }
+    out << ((i + 1 < m_results.size()) ? "},\n" : "}\n");
+  }
+  out << "]\n";
+}
+
+/* EOF */
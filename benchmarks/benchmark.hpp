@@ -0,0 +1,79 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_BENCHMARKS_BENCHMARK_HPP
+#define HEADER_SUPERTUX_BENCHMARKS_BENCHMARK_HPP
+
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+/** Minimal timing harness for benchmark_supertux2, each benchmark
+    runs a function a number of times and reports the time per item
+    the function processed, e.g. ns per object for a collision pass */
+class BenchmarkRunner final
+{
+public:
+  BenchmarkRunner(const std::string& filter);
+
+  /** Returns true if the benchmark name matches the filter */
+  bool is_enabled(const std::string& name) const;
+
+  /** Runs func once as a warmup, then iterations times, each call is
+      expected to process items items. Every iteration is timed on its
+      own for the percentiles, builds with allocation tracking also
+      count the heap allocations. */
+  void run(const std::string& name, int iterations, size_t items,
+           const std::function<void ()>& func);
+
+  /** Attaches an extra value to the last benchmark that ran, e.g.
+      the draw calls per frame of a render benchmark */
+  void add_metric(const std::string& name, double value);
+
+  void print(std::ostream& out) const;
+
+  /** Writes all results and their metrics as a JSON array */
+  void print_json(std::ostream& out) const;
+
+private:
+  struct Result
+  {
+    std::string name;
+    int iterations;
+    size_t items;
+    double ns_per_iteration;
+    double ns_per_item;
+    double ns_p50;
+    double ns_p99;
+    /** Per iteration, negative without allocation tracking */
+    double allocations;
+    std::vector<std::pair<std::string, double> > metrics;
+  };
+
+private:
+  std::string m_filter;
+  std::vector<Result> m_results;
+
+private:
+  BenchmarkRunner(const BenchmarkRunner&) = delete;
+  BenchmarkRunner& operator=(const BenchmarkRunner&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,194 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "collision_benchmark.hpp"
+
+#include <sstream>
+
+#include "benchmark.hpp"
+#include "collision/collision_system.hpp"
+#include "math/random.hpp"
+#include "math/rectf.hpp"
+#include "supertux/level.hpp"
+#include "supertux/level_parser.hpp"
+#include "supertux/moving_object.hpp"
+#include "supertux/sector.hpp"
+#include "util/log.hpp"
+
+namespace {
+
+const int SECTOR_WIDTH = 400;
+const int SECTOR_HEIGHT = 30;
+
+/** A plain solid block from images/tiles.strf */
+const int SOLID_TILE = 47;
+
+const int QUERIES = 1000;
+
+/** Builds the source of a level with a single sector of the given
+    number of objects and solid tilemaps, the same seed always
+    produces the same level */
+std::string
+generate_level(int objects, int tilemaps, unsigned seed)
+{
+  Random rng;
+  rng.seed(seed);
+
+  std::ostringstream out;
+  out << "(supertux-level\n"
+      << "  (version 3)\n"
+      << "  (name (_ \"Collision Benchmark\"))\n"
+      << "  (author \"SuperTux Team\")\n"
+      << "  (license \"GPL 2+ / CC-by-sa 3.0\")\n"
+      << "  (sector\n"
+      << "    (name \"main\")\n"
+      << "    (camera (name \"Camera\") (mode \"normal\"))\n"
+      << "    (spawnpoint (name \"main\") (x 64) (y 64))\n";
+
+  for (int i = 0; i < tilemaps; ++i)
+  {
+    out << "    (tilemap (solid #t) (z-pos " << i << ")"
+        << " (width " << SECTOR_WIDTH << ") (height " << SECTOR_HEIGHT << ")\n"
+        << "      (tiles";
+    for (int y = 0; y < SECTOR_HEIGHT; ++y) {
+      for (int x = 0; x < SECTOR_WIDTH; ++x) {
+        // ground for the first tilemap, scattered platforms for all
+        const bool ground = (i == 0 && y >= SECTOR_HEIGHT - 2);
+        const bool platform = (y % 6 == 5) && rng.rand(8) == 0;
+        out << ' ' << ((ground || platform) ? SOLID_TILE : 0);
+      }
+    }
+    out << "))\n";
+  }
+
+  for (int i = 0; i < objects; ++i)
+  {
+    const int x = rng.rand(64, SECTOR_WIDTH * 32 - 64);
+    const int y = rng.rand(32, (SECTOR_HEIGHT - 3) * 32);
+    const int kind = rng.rand(10);
+    if (kind < 6) {
+      out << "    (coin (x " << x << ") (y " << y << "))\n";
+    } else if (kind < 9) {
+      out << "    (snowball (x " << x << ") (y " << y << ") (direction \"left\"))\n";
+    } else {
+      out << "    (bonusblock (x " << x / 32 * 32 << ") (y " << y / 32 * 32 << "))\n";
+    }
+  }
+
+  out << "  )\n"
+      << ")\n";
+  return out.str();
+}
+
+size_t
+count_collision_objects(Sector& sector)
+{
+  size_t count = 0;
+  for (const auto& object : sector.get_objects()) {
+    if (dynamic_cast<MovingObject*>(object.get())) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+void
+run_sector_benchmarks(BenchmarkRunner& runner, const std::string& prefix, Sector& sector)
+{
+  const size_t objects = count_collision_objects(sector);
+  const Rectf region(0.0f, 0.0f, sector.get_width(), sector.get_height());
+
+  runner.run(prefix + "/sector_update", 200, objects, [&sector] {
+      sector.update(1.0f / 60.0f);
+    });
+
+  runner.run(prefix + "/collision_update", 200, objects, [&sector] {
+      sector.get_collision_system().update();
+    });
+
+  std::vector<Rectf> rects;
+  std::vector<std::pair<Vector, Vector> > lines;
+  Random rng;
+  rng.seed(1234);
+  for (int i = 0; i < QUERIES; ++i)
+  {
+    const Vector pos(rng.randf(region.get_left(), region.get_right()),
+                     rng.randf(region.get_top(), region.get_bottom()));
+    rects.emplace_back(pos, Sizef(rng.randf(8.0f, 64.0f), rng.randf(8.0f, 64.0f)));
+    lines.emplace_back(pos, pos + Vector(rng.randf(-512.0f, 512.0f), rng.randf(-256.0f, 256.0f)));
+  }
+
+  runner.run(prefix + "/is_free_of_statics", 20, QUERIES, [&sector, &rects] {
+      for (const auto& rect : rects) {
+        sector.is_free_of_statics(rect);
+      }
+    });
+
+  runner.run(prefix + "/free_line_of_sight", 20, QUERIES, [&sector, &lines] {
+      for (const auto& line : lines) {
+        sector.free_line_of_sight(line.first, line.second);
+      }
+    });
+}
+
+void
+run_level_benchmarks(BenchmarkRunner& runner, const std::string& prefix, Level& level)
+{
+  for (size_t i = 0; i < level.get_sector_count(); ++i)
+  {
+    Sector& sector = *level.get_sector(i);
+    sector.activate("main");
+    run_sector_benchmarks(runner, prefix + "/" + sector.get_name(), sector);
+    sector.deactivate();
+  }
+}
+
+} // namespace
+
+void
+run_collision_benchmarks(BenchmarkRunner& runner, const std::vector<std::string>& levels)
+{
+  const int object_counts[] = { 100, 1000, 5000 };
+  const int tilemap_counts[] = { 1, 4 };
+
+  for (const auto& objects : object_counts)
+  {
+    for (const auto& tilemaps : tilemap_counts)
+    {
+      std::ostringstream prefix;
+      prefix << "synthetic/" << objects << "_objects_" << tilemaps << "_tilemaps";
+
+      std::istringstream source(generate_level(objects, tilemaps, 42));
+      auto level = LevelParser::from_stream(source, prefix.str(), false, false);
+      run_level_benchmarks(runner, prefix.str(), *level);
+    }
+  }
+
+  for (const auto& filename : levels)
+  {
+    try
+    {
+      auto level = LevelParser::from_file(filename, false, false);
+      run_level_benchmarks(runner, filename, *level);
+    }
+    catch(const std::exception& err)
+    {
+      log_warning << "Couldn't benchmark level '" << filename << "': " << err.what() << std::endl;
+    }
+  }
+}
+
+/* EOF */
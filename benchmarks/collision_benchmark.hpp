@@ -0,0 +1,32 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_BENCHMARKS_COLLISION_BENCHMARK_HPP
+#define HEADER_SUPERTUX_BENCHMARKS_COLLISION_BENCHMARK_HPP
+
+#include <string>
+#include <vector>
+
+class BenchmarkRunner;
+
+/** Times CollisionSystem::update(), is_free_of_statics() and
+    free_line_of_sight() on generated sectors with a varying number of
+    objects and solid tilemaps and on the given .stl levels */
+void run_collision_benchmarks(BenchmarkRunner& runner, const std::vector<std::string>& levels);
+
+#endif
+
+/* EOF */
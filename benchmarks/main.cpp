@@ -0,0 +1,170 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <config.h>
+
+#include <SDL.h>
+#include <SDL_ttf.h>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <physfs.h>
+#include <stdexcept>
+#include <stdlib.h>
+#include <string.h>
+
+#include "audio/sound_manager.hpp"
+#include "benchmark.hpp"
+#include "collision_benchmark.hpp"
+#include "control/input_manager.hpp"
+#include "render_benchmark.hpp"
+#include "sprite/sprite_data.hpp"
+#include "sprite/sprite_manager.hpp"
+#include "squirrel/squirrel_virtual_machine.hpp"
+#include "supertux/console.hpp"
+#include "supertux/gameconfig.hpp"
+#include "supertux/globals.hpp"
+#include "supertux/resources.hpp"
+#include "supertux/tile_manager.hpp"
+#include "supertux/tile_set.hpp"
+#include "util/log.hpp"
+#include "video/ttf_surface_manager.hpp"
+#include "video/video_system.hpp"
+
+namespace {
+
+void
+print_usage(const char* arg0)
+{
+  std::cout << "Usage: " << arg0 << " [OPTIONS] [LEVELFILE]...\n"
+            << "\n"
+            << "  --filter TEXT   Run only the benchmarks whose name contains TEXT\n"
+            << "  --video NAME    Render with NAME: null (default), sdl, opengl33, opengl20 or auto\n"
+            << "  --frames N      Render N frames per scene (default: 200)\n"
+            << "  --json FILE     Also write the results as JSON to FILE\n"
+            << "\n"
+            << "Level files are given relative to the data directory,\n"
+            << "e.g. levels/world1/welcome_antarctica.stl\n";
+}
+
+} // namespace
+
+int
+main(int argc, char** argv)
+{
+  std::string filter;
+  std::string video = "null";
+  int frames = 200;
+  std::string json_file;
+  std::vector<std::string> levels;
+  for (int i = 1; i < argc; ++i)
+  {
+    if (strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+      filter = argv[++i];
+    } else if (strcmp(argv[i], "--video") == 0 && i + 1 < argc) {
+      video = argv[++i];
+    } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+      frames = std::max(1, atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+      json_file = argv[++i];
+    } else if (strcmp(argv[i], "--help") == 0) {
+      print_usage(argv[0]);
+      return 0;
+    } else {
+      levels.push_back(argv[i]);
+    }
+  }
+
+  g_log_level = LOG_WARNING;
+
+  if (!PHYSFS_init(argv[0]))
+  {
+    std::cerr << "Couldn't initialize physfs: " << PHYSFS_getLastErrorCode() << std::endl;
+    return 1;
+  }
+  PHYSFS_mount(BUILD_DATA_DIR, nullptr, 1);
+
+  VideoSystem::Enum video_system_type;
+  try
+  {
+    video_system_type = VideoSystem::get_video_system(video);
+  }
+  catch(const std::exception& err)
+  {
+    std::cerr << err.what() << std::endl;
+    return 1;
+  }
+
+  const Uint32 sdl_flags = SDL_INIT_TIMER | ((video_system_type == VideoSystem::VIDEO_NULL) ? 0 : SDL_INIT_VIDEO);
+  if (SDL_Init(sdl_flags) < 0 || TTF_Init() < 0)
+  {
+    std::cerr << "Couldn't initialize SDL: " << SDL_GetError() << std::endl;
+    return 1;
+  }
+
+  int result = 0;
+  try
+  {
+    // the same setup as Main::launch_game(), with nothing played
+    g_config = std::make_unique<Config>();
+    g_config->sound_enabled = false;
+    g_config->music_enabled = false;
+
+    ConsoleBuffer console_buffer;
+    InputManager input_manager(g_config->keyboard_config, g_config->joystick_config);
+    std::unique_ptr<VideoSystem> video_system = VideoSystem::create(video_system_type);
+    // measure the rendering, not the display refresh rate
+    video_system->set_vsync(0);
+    TTFSurfaceManager ttf_surface_manager;
+    SoundManager sound_manager;
+    sound_manager.enable_sound(false);
+    sound_manager.enable_music(false);
+    SquirrelVirtualMachine scripting(false);
+    TileManager tile_manager;
+    SpriteManager sprite_manager;
+    Resources resources;
+    Console console(console_buffer);
+
+    BenchmarkRunner runner(filter);
+    run_collision_benchmarks(runner, levels);
+    run_render_benchmarks(runner, *video_system, frames);
+    runner.print(std::cout);
+
+    if (!json_file.empty())
+    {
+      std::ofstream out(json_file);
+      if (!out) {
+        throw std::runtime_error("couldn't open " + json_file);
+      }
+      runner.print_json(out);
+    }
+  }
+  catch(const std::exception& err)
+  {
+    std::cerr << "Benchmark failed: " << err.what() << std::endl;
+    result = 1;
+  }
+
+  g_config.reset();
+  TTF_Quit();
+  SDL_Quit();
+  PHYSFS_deinit();
+
+  return result;
+}
+
+/* EOF */
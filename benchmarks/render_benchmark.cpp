@@ -0,0 +1,233 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "render_benchmark.hpp"
+
+#include <functional>
+#include <sstream>
+
+#include "benchmark.hpp"
+#include "math/random.hpp"
+#include "math/rectf.hpp"
+#include "supertux/debug.hpp"
+#include "supertux/resources.hpp"
+#include "video/compositor.hpp"
+#include "video/drawing_context.hpp"
+#include "video/font.hpp"
+#include "video/layer.hpp"
+#include "video/render_stats.hpp"
+#include "video/surface.hpp"
+#include "video/video_system.hpp"
+
+namespace {
+
+const float TILE_SIZE = 32.0f;
+
+/** Draws three full screen tile layers, batched per layer the same
+    way TileMap::draw() does */
+void
+draw_forest(DrawingContext& context)
+{
+  static const SurfacePtr tiles = Surface::from_file("images/tiles/forest/foresttiles-1.png");
+
+  const int tiles_per_row = tiles->get_width() / static_cast<int>(TILE_SIZE);
+  const int tile_count = tiles_per_row * (tiles->get_height() / static_cast<int>(TILE_SIZE));
+  const int columns = context.get_width() / static_cast<int>(TILE_SIZE) + 1;
+  const int rows = context.get_height() / static_cast<int>(TILE_SIZE) + 1;
+
+  const int layers[] = { LAYER_BACKGROUNDTILES, LAYER_TILES, LAYER_FOREGROUNDTILES };
+  for (int layer : layers)
+  {
+    std::vector<Rectf> srcrects;
+    std::vector<Rectf> dstrects;
+    for (int y = 0; y < rows; ++y) {
+      for (int x = 0; x < columns; ++x) {
+        const int tile = (x * 7 + y * 13 + layer) % tile_count;
+        const int tile_x = tile % tiles_per_row;
+        const int tile_y = tile / tiles_per_row;
+        srcrects.emplace_back(static_cast<float>(tile_x) * TILE_SIZE, static_cast<float>(tile_y) * TILE_SIZE,
+                              static_cast<float>(tile_x + 1) * TILE_SIZE, static_cast<float>(tile_y + 1) * TILE_SIZE);
+        dstrects.emplace_back(static_cast<float>(x) * TILE_SIZE, static_cast<float>(y) * TILE_SIZE,
+                              static_cast<float>(x + 1) * TILE_SIZE, static_cast<float>(y + 1) * TILE_SIZE);
+      }
+    }
+    context.color().draw_surface_batch(tiles, std::move(srcrects), std::move(dstrects), Color::WHITE, layer);
+  }
+}
+
+/** Thousands of rotated snow flakes, batched per texture like
+    ParticleSystem::draw() */
+void
+draw_particles(DrawingContext& context)
+{
+  static const SurfacePtr flakes[] = {
+    Surface::from_file("images/particles/snow0.png"),
+    Surface::from_file("images/particles/snow1.png"),
+    Surface::from_file("images/particles/snow2.png")
+  };
+  const int PARTICLES = 3000;
+
+  Random rng;
+  rng.seed(1);
+
+  for (const auto& flake : flakes)
+  {
+    std::vector<Rectf> srcrects;
+    std::vector<Rectf> dstrects;
+    std::vector<float> angles;
+    const Rectf srcrect(0.0f, 0.0f, static_cast<float>(flake->get_width()), static_cast<float>(flake->get_height()));
+    for (int i = 0; i < PARTICLES / 3; ++i)
+    {
+      const Vector pos(rng.randf(0.0f, static_cast<float>(context.get_width())),
+                       rng.randf(0.0f, static_cast<float>(context.get_height())));
+      srcrects.push_back(srcrect);
+      dstrects.emplace_back(pos, srcrect.get_size());
+      angles.push_back(rng.randf(0.0f, 360.0f));
+    }
+    context.color().draw_surface_batch(flake, std::move(srcrects), std::move(dstrects), std::move(angles),
+                                       Color::WHITE, LAYER_FOREGROUND1);
+  }
+}
+
+/** A dark castle wall lit by 100 lights on the lightmap */
+void
+draw_castle(DrawingContext& context)
+{
+  static const SurfacePtr wall = Surface::from_file("images/tiles/castle/castle_wall.png");
+  static const SurfacePtr light = Surface::from_file("images/objects/lightmap_light/lightmap_light-medium.png");
+  const int LIGHTS = 100;
+
+  context.set_ambient_color(Color(0.05f, 0.05f, 0.1f));
+
+  for (float y = 0.0f; y < static_cast<float>(context.get_height()); y += static_cast<float>(wall->get_height())) {
+    for (float x = 0.0f; x < static_cast<float>(context.get_width()); x += static_cast<float>(wall->get_width())) {
+      context.color().draw_surface(wall, Vector(x, y), LAYER_TILES);
+    }
+  }
+
+  Random rng;
+  rng.seed(2);
+  for (int i = 0; i < LIGHTS; ++i)
+  {
+    const Vector pos(rng.randf(0.0f, static_cast<float>(context.get_width())),
+                     rng.randf(0.0f, static_cast<float>(context.get_height())));
+    const Color color(rng.randf(0.3f, 1.0f), rng.randf(0.3f, 1.0f), rng.randf(0.3f, 1.0f));
+    const Vector center(static_cast<float>(light->get_width()) / 2.0f,
+                        static_cast<float>(light->get_height()) / 2.0f);
+    context.light().draw_surface(light, pos - center, 0.0f, color, Blend::ADD, LAYER_OBJECTS);
+  }
+}
+
+/** A menu background with a screen full of text */
+void
+draw_menu(DrawingContext& context)
+{
+  const float line_height = Resources::normal_font->get_height() + 2.0f;
+  const Rectf rect(40.0f, 20.0f,
+                   static_cast<float>(context.get_width()) - 40.0f,
+                   static_cast<float>(context.get_height()) - 20.0f);
+
+  context.color().draw_filled_rect(rect, Color(0.2f, 0.3f, 0.4f, 0.8f), LAYER_GUI - 10);
+
+  int line = 0;
+  for (float y = rect.get_top() + 10.0f; y < rect.get_bottom() - line_height; y += line_height)
+  {
+    std::ostringstream text;
+    text << "Menu entry " << line << ": The quick brown fox jumps over the lazy dog";
+    context.color().draw_text(Resources::normal_font, text.str(), Vector(rect.get_left() + 10.0f, y),
+                              ALIGN_LEFT, LAYER_GUI, (line % 2) ? Color::WHITE : Color(1.0f, 1.0f, 0.6f));
+    line += 1;
+  }
+}
+
+/** A dense field of coins, each drawn on its own like Coin::draw() */
+void
+draw_coins(DrawingContext& context)
+{
+  static const SurfacePtr coin = Surface::from_file("images/objects/coin/coin-0.png");
+
+  for (float y = 0.0f; y < static_cast<float>(context.get_height()); y += TILE_SIZE / 2.0f) {
+    for (float x = 0.0f; x < static_cast<float>(context.get_width()); x += TILE_SIZE / 2.0f) {
+      context.color().draw_surface(coin, Vector(x, y), LAYER_OBJECTS);
+    }
+  }
+}
+
+} // namespace
+
+void
+run_render_benchmarks(BenchmarkRunner& runner, VideoSystem& video_system, int frames)
+{
+  struct Scene
+  {
+    const char* name;
+    std::function<void (DrawingContext&)> draw;
+  };
+
+  const Scene scenes[] = {
+    { "forest", draw_forest },
+    { "particles", draw_particles },
+    { "castle", draw_castle },
+    { "menu", draw_menu },
+    { "coins", draw_coins }
+  };
+
+  // draw calls and GPU times are only recorded while the stats are shown
+  const bool show_render_stats = g_debug.show_render_stats;
+  g_debug.show_render_stats = true;
+
+  for (const auto& scene : scenes)
+  {
+    const std::string name = "render/" + video_system.get_name() + "/" + scene.name;
+    if (!runner.is_enabled(name))
+      continue;
+
+    RenderStats::Counters totals;
+    int measured_frames = 0;
+
+    runner.run(name, frames, 1, [&video_system, &scene, &totals, &measured_frames]{
+        Compositor compositor(video_system);
+        scene.draw(compositor.make_context());
+        compositor.render();
+
+        // frames only become complete once their GPU times are in
+        const RenderStats::Frame* frame = g_render_stats.get_complete_frame();
+        if (frame)
+        {
+          totals.requests += frame->totals.requests;
+          totals.draw_calls += frame->totals.draw_calls;
+          totals.vertices += frame->totals.vertices;
+          totals.texture_binds += frame->totals.texture_binds;
+          totals.gpu_ms += frame->totals.gpu_ms;
+          measured_frames += 1;
+        }
+      });
+
+    if (measured_frames > 0)
+    {
+      const double count = static_cast<double>(measured_frames);
+      runner.add_metric("requests", static_cast<double>(totals.requests) / count);
+      runner.add_metric("draw_calls", static_cast<double>(totals.draw_calls) / count);
+      runner.add_metric("vertices", static_cast<double>(totals.vertices) / count);
+      runner.add_metric("texture_binds", static_cast<double>(totals.texture_binds) / count);
+      runner.add_metric("gpu_ms", static_cast<double>(totals.gpu_ms) / count);
+    }
+  }
+
+  g_debug.show_render_stats = show_render_stats;
+}
+
+/* EOF */
@@ -0,0 +1,31 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_BENCHMARKS_RENDER_BENCHMARK_HPP
+#define HEADER_SUPERTUX_BENCHMARKS_RENDER_BENCHMARK_HPP
+
+class BenchmarkRunner;
+class VideoSystem;
+
+/** Draws a set of canned scenes (forest tiles, particles, a dark
+    castle with many lights, a text heavy menu and a coin field) and
+    times Compositor::render() for each on the given video system,
+    draw calls and GPU time are taken from g_render_stats */
+void run_render_benchmarks(BenchmarkRunner& runner, VideoSystem& video_system, int frames);
+
+#endif
+
+/* EOF */
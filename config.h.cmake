@@ -27,6 +27,10 @@
 
 #cmakedefine HAVE_LIBCURL
 
+#cmakedefine ENABLE_ALLOCATION_TRACKING
+#cmakedefine SQUIRREL_MEMORY_TRACKING
+#cmakedefine ENABLE_DETERMINISTIC_FLOAT
+
 #define BUILD_DATA_DIR "${BUILD_DATA_DIR}"
 
 #define BUILD_CONFIG_DATA_DIR "${BUILD_CONFIG_DATA_DIR}"
@@ -4,16 +4,46 @@ in vec2 texcoord;
 in vec2 position;
 in vec4 diffuse;
 
+// per instance attributes, used when quads is set
+in vec4 quad_dstrect;
+in vec4 quad_srcrect;
+in float quad_angle;
+in vec4 quad_color;
+
 out vec2 texcoord_var;
 out vec4 diffuse_var;
 
 uniform mat3 modelviewprojection;
+uniform bool quads;
 
 void main(void)
 {
-  texcoord_var = texcoord;
-  diffuse_var = diffuse;
-  gl_Position = vec4(vec3(position, 1) * modelviewprojection, 1.0);
+  if (quads)
+  {
+    // triangle strip: top left, top right, bottom left, bottom right
+    vec2 corner = vec2(float(gl_VertexID & 1), float(gl_VertexID >> 1));
+    vec2 pos = mix(quad_dstrect.xy, quad_dstrect.zw, corner);
+
+    if (quad_angle != 0.0)
+    {
+      // rotated around the center
+      vec2 center = (quad_dstrect.xy + quad_dstrect.zw) * 0.5;
+      vec2 rel = pos - center;
+      float s = sin(quad_angle);
+      float c = cos(quad_angle);
+      pos = vec2(rel.x * c - rel.y * s, rel.x * s + rel.y * c) + center;
+    }
+
+    texcoord_var = mix(quad_srcrect.xy, quad_srcrect.zw, corner);
+    diffuse_var = quad_color;
+    gl_Position = vec4(vec3(pos, 1) * modelviewprojection, 1.0);
+  }
+  else
+  {
+    texcoord_var = texcoord;
+    diffuse_var = diffuse;
+    gl_Position = vec4(vec3(position, 1) * modelviewprojection, 1.0);
+  }
 }
 
 /* EOF */
@@ -18,6 +18,9 @@
 #include "addon/addon_manager.hpp"
 
 #include <physfs.h>
+#include <sstream>
+#include <stdint.h>
+#include <unordered_map>
 
 #include "addon/addon.hpp"
 #include "addon/md5.hpp"
@@ -30,12 +33,30 @@
 #include "util/reader_collection.hpp"
 #include "util/reader_document.hpp"
 #include "util/reader_mapping.hpp"
+#include "util/job_system.hpp"
 #include "util/string_util.hpp"
+#include "util/writer.hpp"
 
 namespace {
 
 static const char* ADDON_INFO_PATH = "/addons/repository.nfo";
 
+/** MD5 and .nfo content of installed archives, so unchanged archives
+    neither have to be hashed nor mounted on startup */
+static const char* ARCHIVE_CACHE_PATH = "cache/addon-archives";
+
+struct ArchiveCacheEntry
+{
+  ArchiveCacheEntry() : size(0), mtime(0), md5(), nfo() {}
+
+  uint64_t size;
+  int64_t mtime;
+  std::string md5;
+  std::string nfo;
+};
+
+using ArchiveCache = std::unordered_map<std::string, ArchiveCacheEntry>;
+
 MD5 md5_from_file(const std::string& filename)
 {
   // TODO: this does not work as expected for some files -- IFileStream seems to not always behave like an ifstream.
@@ -75,6 +96,111 @@ MD5 md5_from_archive(const std::string& filename)
   }
 }
 
+bool stat_archive(const std::string& filename, uint64_t& size, int64_t& mtime)
+{
+  PHYSFS_Stat statbuf;
+  if (!PHYSFS_stat(filename.c_str(), &statbuf) ||
+      statbuf.filetype != PHYSFS_FILETYPE_REGULAR || statbuf.filesize < 0)
+    return false;
+
+  size = static_cast<uint64_t>(statbuf.filesize);
+  mtime = statbuf.modtime;
+  return true;
+}
+
+ArchiveCache read_archive_cache()
+{
+  ArchiveCache cache;
+  if (!PHYSFS_exists(ARCHIVE_CACHE_PATH))
+    return cache;
+
+  try
+  {
+    auto doc = ReaderDocument::from_file(ARCHIVE_CACHE_PATH);
+    auto root = doc.get_root();
+    if (root.get_name() != "supertux-addon-archives")
+      return cache;
+
+    auto iter = root.get_mapping().get_iter();
+    while (iter.next())
+    {
+      if (iter.get_key() != "archive")
+        continue;
+
+      auto mapping = iter.as_mapping();
+      std::string filename;
+      std::string size;
+      std::string mtime;
+      ArchiveCacheEntry entry;
+      if (!mapping.get("file", filename) ||
+          !mapping.get("size", size) ||
+          !mapping.get("mtime", mtime) ||
+          !mapping.get("md5", entry.md5) ||
+          !mapping.get("nfo", entry.nfo))
+        continue;
+
+      // 64 bit values don't fit into sexp integers
+      entry.size = std::stoull(size);
+      entry.mtime = std::stoll(mtime);
+      cache[filename] = entry;
+    }
+  }
+  catch(const std::exception& e)
+  {
+    log_warning << "couldn't read add-on cache: " << e.what() << std::endl;
+    cache.clear();
+  }
+  return cache;
+}
+
+void write_archive_cache(const ArchiveCache& cache)
+{
+  if (!PHYSFS_exists("cache") && !PHYSFS_mkdir("cache"))
+  {
+    log_warning << "couldn't create cache directory: " << PHYSFS_getLastErrorCode() << std::endl;
+    return;
+  }
+
+  try
+  {
+    Writer writer(ARCHIVE_CACHE_PATH);
+    writer.start_list("supertux-addon-archives");
+    for (const auto& it : cache)
+    {
+      writer.start_list("archive");
+      writer.write("file", it.first);
+      writer.write("size", std::to_string(it.second.size));
+      writer.write("mtime", std::to_string(it.second.mtime));
+      writer.write("md5", it.second.md5);
+      writer.write("nfo", it.second.nfo);
+      writer.end_list("archive");
+    }
+    writer.end_list("supertux-addon-archives");
+  }
+  catch(const std::exception& e)
+  {
+    log_warning << "couldn't write add-on cache: " << e.what() << std::endl;
+  }
+}
+
+bool read_file(const std::string& filename, std::string& data)
+{
+  PHYSFS_File* file = PHYSFS_openRead(filename.c_str());
+  if (!file)
+    return false;
+
+  const PHYSFS_sint64 length = PHYSFS_fileLength(file);
+  bool success = false;
+  if (length >= 0)
+  {
+    data.resize(static_cast<size_t>(length));
+    success = length == 0 ||
+      PHYSFS_readBytes(file, &data[0], static_cast<PHYSFS_uint64>(length)) == length;
+  }
+  PHYSFS_close(file);
+  return success;
+}
+
 static Addon& get_addon(const AddonManager::AddonList& list, const AddonId& id,
                         bool installed)
 {
@@ -116,6 +242,7 @@ static PHYSFS_EnumerateCallbackResult add_to_dictionary_path(void *data, const c
         log_debug << "Adding \"" << full_path << "\" to dictionary search path" << std::endl;
         // We want translations from addons to have precedence
         g_dictionary_manager->add_directory(full_path, true);
+        invalidate_translations();
     }
     return PHYSFS_ENUM_OK;
 }
@@ -126,6 +253,7 @@ static PHYSFS_EnumerateCallbackResult remove_from_dictionary_path(void *data, co
     if (physfsutil::is_directory(full_path))
     {
         g_dictionary_manager->remove_directory(full_path);
+        invalidate_translations();
     }
     return PHYSFS_ENUM_OK;
 }
@@ -133,7 +261,7 @@ static PHYSFS_EnumerateCallbackResult remove_from_dictionary_path(void *data, co
 
 AddonManager::AddonManager(const std::string& addon_directory,
                            std::vector<Config::Addon>& addon_config) :
-  m_downloader(),
+  m_downloader(g_config->download_connections),
   m_addon_directory(addon_directory),
   m_repository_url("https://raw.githubusercontent.com/SuperTux/addons/master/index-0_6.nfo"),
   m_addon_config(addon_config),
@@ -177,6 +305,9 @@ AddonManager::AddonManager(const std::string& addon_directory,
     catch(const std::exception& err)
     {
         log_warning << "parsing repository.nfo failed: " << err.what() << std::endl;
+
+        // don't let a conditional request keep the broken file around
+        PHYSFS_delete(ADDON_INFO_PATH);
     }
   }
   else
@@ -247,16 +378,20 @@ AddonManager::request_check_online()
   }
   else
   {
-    m_transfer_status = m_downloader.request_download(m_repository_url, ADDON_INFO_PATH);
+    m_transfer_status = m_downloader.request_download(m_repository_url, ADDON_INFO_PATH, true);
 
     m_transfer_status->then(
       [this](bool success)
       {
+        const bool not_modified = m_transfer_status->not_modified;
         m_transfer_status = {};
 
         if (success)
         {
-          m_repository_addons = parse_addon_infos(ADDON_INFO_PATH);
+          // the index parsed at startup is still current
+          if (!not_modified || m_repository_addons.empty()) {
+            m_repository_addons = parse_addon_infos(ADDON_INFO_PATH);
+          }
           m_has_been_updated = true;
         }
       });
@@ -458,6 +593,7 @@ AddonManager::enable_addon(const AddonId& addon_id)
       }
       addon.set_enabled(true);
     }
+    physfsutil::invalidate_cache();
   }
 }
 
@@ -486,6 +622,7 @@ AddonManager::disable_addon(const AddonId& addon_id)
       }
       addon.set_enabled(false);
     }
+    physfsutil::invalidate_cache();
   }
 }
 
@@ -531,6 +668,7 @@ AddonManager::mount_old_addons()
       }
     }
   }
+  physfsutil::invalidate_cache();
 }
 
 void
@@ -545,6 +683,7 @@ AddonManager::unmount_old_addons()
       }
     }
   }
+  physfsutil::invalidate_cache();
 }
 
 bool
@@ -633,7 +772,7 @@ AddonManager::scan_for_info(const std::string& archive_os_path) const
 }
 
 void
-AddonManager::add_installed_archive(const std::string& archive, const std::string& md5)
+AddonManager::add_installed_archive(const std::string& archive, const std::string& md5, std::string* nfo_content)
 {
   const char* realdir = PHYSFS_getRealDir(archive.c_str());
   if (!realdir)
@@ -646,6 +785,7 @@ AddonManager::add_installed_archive(const std::string& archive, const std::strin
     std::string os_path = FileSystem::join(realdir, archive);
 
     PHYSFS_mount(os_path.c_str(), nullptr, 1);
+    physfsutil::invalidate_cache();
 
     std::string nfo_filename = scan_for_info(os_path);
 
@@ -660,6 +800,10 @@ AddonManager::add_installed_archive(const std::string& archive, const std::strin
         std::unique_ptr<Addon> addon = Addon::parse(nfo_filename);
         addon->set_install_filename(os_path, md5);
         m_installed_addons.push_back(std::move(addon));
+
+        if (nfo_content && !read_file(nfo_filename, *nfo_content)) {
+          nfo_content->clear();
+        }
       }
       catch (const std::runtime_error& e)
       {
@@ -668,6 +812,34 @@ AddonManager::add_installed_archive(const std::string& archive, const std::strin
     }
 
     PHYSFS_unmount(os_path.c_str());
+    physfsutil::invalidate_cache();
+  }
+}
+
+bool
+AddonManager::add_cached_archive(const std::string& archive, const std::string& md5, const std::string& nfo_content)
+{
+  const char* realdir = PHYSFS_getRealDir(archive.c_str());
+  if (!realdir)
+    return false;
+
+  try
+  {
+    std::istringstream stream(nfo_content);
+    auto doc = ReaderDocument::from_stream(stream, archive);
+    auto root = doc.get_root();
+    if (root.get_name() != "supertux-addoninfo")
+      return false;
+
+    std::unique_ptr<Addon> addon = Addon::parse(root.get_mapping());
+    addon->set_install_filename(FileSystem::join(realdir, archive), md5);
+    m_installed_addons.push_back(std::move(addon));
+    return true;
+  }
+  catch (const std::exception& e)
+  {
+    log_debug << "ignoring cached add-on info for " << archive << ": " << e.what() << std::endl;
+    return false;
   }
 }
 
@@ -675,11 +847,71 @@ void
 AddonManager::add_installed_addons()
 {
   auto archives = scan_for_archives();
+  ArchiveCache cache = read_archive_cache();
+  ArchiveCache new_cache;
+
+  // hash the archives that changed in parallel, directories have no
+  // hash and are always scanned as their content can change freely
+  std::vector<uint64_t> sizes(archives.size());
+  std::vector<int64_t> mtimes(archives.size());
+  std::vector<std::string> md5s(archives.size());
+  std::vector<bool> cached(archives.size(), false);
+  std::vector<JobSystem::Handle> jobs;
+  for (size_t i = 0; i < archives.size(); ++i)
+  {
+    if (stat_archive(archives[i], sizes[i], mtimes[i]))
+    {
+      auto it = cache.find(archives[i]);
+      if (it != cache.end() && it->second.size == sizes[i] && it->second.mtime == mtimes[i])
+      {
+        md5s[i] = it->second.md5;
+        cached[i] = true;
+        continue;
+      }
+    }
+
+    auto job = [&archives, &md5s, i] { md5s[i] = md5_from_archive(archives[i]).hex_digest(); };
+    if (JobSystem::current()) {
+      jobs.push_back(JobSystem::current()->schedule(job));
+    } else {
+      job();
+    }
+  }
+
+  // the jobs refer to the locals above, so all of them have to finish
+  std::exception_ptr error;
+  for (const auto& job : jobs) {
+    try {
+      JobSystem::current()->wait(job);
+    } catch(...) {
+      error = std::current_exception();
+    }
+  }
+  if (error) {
+    std::rethrow_exception(error);
+  }
 
-  for (const auto& archive : archives)
+  bool changed = false;
+  for (size_t i = 0; i < archives.size(); ++i)
   {
-    MD5 md5 = md5_from_archive(archive);
-    add_installed_archive(archive, md5.hex_digest());
+    if (cached[i] && add_cached_archive(archives[i], md5s[i], cache[archives[i]].nfo))
+    {
+      new_cache[archives[i]] = cache[archives[i]];
+      continue;
+    }
+
+    ArchiveCacheEntry entry;
+    add_installed_archive(archives[i], md5s[i], &entry.nfo);
+    if (!entry.nfo.empty() && stat_archive(archives[i], entry.size, entry.mtime))
+    {
+      entry.md5 = md5s[i];
+      new_cache[archives[i]] = entry;
+      changed = true;
+    }
+  }
+
+  if (changed || new_cache.size() != cache.size()) {
+    write_archive_cache(new_cache);
   }
 }
 
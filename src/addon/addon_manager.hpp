@@ -91,7 +91,11 @@ private:
 
   /** add \a archive, given as physfs path, to the list of installed
       archives */
-  void add_installed_archive(const std::string& archive, const std::string& md5);
+  void add_installed_archive(const std::string& archive, const std::string& md5, std::string* nfo_content = nullptr);
+
+  /** add \a archive from the .nfo content cached in a previous run,
+      without mounting it, returns false if that didn't work out */
+  bool add_cached_archive(const std::string& archive, const std::string& md5, const std::string& nfo_content);
 
   /** search for an .nfo file in the top level directory that
       originates from \a archive, \a archive is a OS path */
@@ -20,12 +20,17 @@
 #include <algorithm>
 #include <array>
 #include <assert.h>
+#include <atomic>
+#include <ctype.h>
 #include <memory>
 #include <physfs.h>
 #include <sstream>
 #include <stdexcept>
 #include <version.h>
 
+#include "physfs/ifile_stream.hpp"
+#include "physfs/ofile_stream.hpp"
+#include "util/file_system.hpp"
 #include "util/log.hpp"
 
 namespace {
@@ -54,6 +59,24 @@ size_t my_curl_physfs_write(void* ptr, size_t size, size_t nmemb, void* userdata
   }
 }
 
+/** Stores the value of \a header in \a value if \a line is that
+    header, returns false otherwise */
+bool parse_header(const std::string& line, const std::string& header, std::string& value)
+{
+  if (line.size() <= header.size() + 1 || line[header.size()] != ':')
+    return false;
+
+  for (size_t i = 0; i < header.size(); ++i) {
+    if (tolower(static_cast<unsigned char>(line[i])) != tolower(static_cast<unsigned char>(header[i])))
+      return false;
+  }
+
+  const size_t begin = line.find_first_not_of(" \t", header.size() + 1);
+  const size_t end = line.find_last_not_of(" \t\r\n");
+  value = (begin == std::string::npos || end < begin) ? std::string() : line.substr(begin, end - begin + 1);
+  return true;
+}
+
 } // namespace
 
 void
@@ -79,24 +102,71 @@ private:
   std::array<char, CURL_ERROR_SIZE> m_error_buffer;
 
   TransferStatusPtr m_status;
+
+  /** Data goes to a .part file first, which a later transfer of the
+      same file continues with a Range request */
+  std::string m_filename;
+  std::string m_part_filename;
   std::unique_ptr<PHYSFS_file, int(*)(PHYSFS_File*)> m_fout;
+  PHYSFS_sint64 m_resume_from;
+  bool m_started;
+
+  /** Validators of a conditional transfer, the sent ones are replaced
+      by the I/O thread with the ones of the response */
+  bool m_conditional;
+  std::string m_etag_filename;
+  std::string m_etag;
+  std::string m_last_modified;
+  std::unique_ptr<curl_slist, void(*)(curl_slist*)> m_headers;
+
+  /** Written by the I/O thread, copied into m_status by
+      Downloader::update() */
+  std::atomic<int> m_dltotal;
+  std::atomic<int> m_dlnow;
+  std::atomic<int> m_ultotal;
+  std::atomic<int> m_ulnow;
 
 public:
   Transfer(Downloader& downloader, TransferId id,
            const std::string& url,
-           const std::string& outfile) :
+           const std::string& outfile,
+           bool conditional) :
     m_downloader(downloader),
     m_id(id),
     m_url(url),
     m_handle(),
     m_error_buffer({{'\0'}}),
     m_status(new TransferStatus(m_downloader, id)),
-    m_fout(PHYSFS_openWrite(outfile.c_str()), PHYSFS_close)
+    m_filename(outfile),
+    m_part_filename(outfile + ".part"),
+    m_fout(nullptr, PHYSFS_close),
+    m_resume_from(0),
+    m_started(false),
+    m_conditional(conditional),
+    m_etag_filename(outfile + ".etag"),
+    m_etag(),
+    m_last_modified(),
+    m_headers(nullptr, curl_slist_free_all),
+    m_dltotal(0),
+    m_dlnow(0),
+    m_ultotal(0),
+    m_ulnow(0)
   {
+    PHYSFS_Stat statbuf;
+    if (PHYSFS_stat(m_part_filename.c_str(), &statbuf) && statbuf.filesize > 0)
+    {
+      m_fout.reset(PHYSFS_openAppend(m_part_filename.c_str()));
+      m_resume_from = statbuf.filesize;
+    }
+    else
+    {
+      m_fout.reset(PHYSFS_openWrite(m_part_filename.c_str()));
+    }
+
     if (!m_fout)
     {
       std::ostringstream out;
-      out << "PHYSFS_openRead() failed: " << PHYSFS_getLastErrorCode();
+      out << "PHYSFS_openWrite() failed: " << PHYSFS_getLastErrorCode();
       throw std::runtime_error(out.str());
     }
 
@@ -117,6 +187,23 @@ public:
       curl_easy_setopt(m_handle, CURLOPT_NOSIGNAL, 1);
       curl_easy_setopt(m_handle, CURLOPT_FAILONERROR, 1);
       curl_easy_setopt(m_handle, CURLOPT_FOLLOWLOCATION, 1);
+      curl_easy_setopt(m_handle, CURLOPT_TCP_KEEPALIVE, 1L);
+
+      if (m_resume_from > 0)
+      {
+        log_info << "resuming " << url << " at " << m_resume_from << " bytes" << std::endl;
+        curl_easy_setopt(m_handle, CURLOPT_RESUME_FROM_LARGE, static_cast<curl_off_t>(m_resume_from));
+      }
+      else if (m_conditional)
+      {
+        add_validators();
+      }
+
+      if (m_conditional)
+      {
+        curl_easy_setopt(m_handle, CURLOPT_HEADERDATA, this);
+        curl_easy_setopt(m_handle, CURLOPT_HEADERFUNCTION, &Transfer::on_header_wrap);
+      }
 
       curl_easy_setopt(m_handle, CURLOPT_NOPROGRESS, 0);
       curl_easy_setopt(m_handle, CURLOPT_PROGRESSDATA, this);
@@ -154,30 +241,181 @@ public:
     return m_url;
   }
 
+  void update_status()
+  {
+    m_status->dltotal = m_dltotal;
+    m_status->dlnow = m_dlnow;
+    m_status->ultotal = m_ultotal;
+    m_status->ulnow = m_ulnow;
+  }
+
+  /** Closes the .part file and, if the transfer succeeded, moves it
+      into place, returns false if that failed */
+  bool finish(bool success)
+  {
+    update_status();
+    m_fout.reset();
+
+    if (success && m_conditional)
+    {
+      long response_code = 0;
+      curl_easy_getinfo(m_handle, CURLINFO_RESPONSE_CODE, &response_code);
+      if (response_code == 304)
+      {
+        log_info << m_url << " not modified" << std::endl;
+        m_status->not_modified = true;
+        PHYSFS_delete(m_part_filename.c_str());
+        return true;
+      }
+    }
+
+    if (!success)
+    {
+      // keep partial data around for resuming
+      PHYSFS_Stat statbuf;
+      if (PHYSFS_stat(m_part_filename.c_str(), &statbuf) && statbuf.filesize == 0) {
+        PHYSFS_delete(m_part_filename.c_str());
+      }
+      return false;
+    }
+
+    const char* writedir = PHYSFS_getWriteDir();
+    if (!writedir)
+      return false;
+
+    // PhysFS has no rename
+    if (PHYSFS_exists(m_filename.c_str())) {
+      PHYSFS_delete(m_filename.c_str());
+    }
+    if (!FileSystem::rename(FileSystem::join(writedir, m_part_filename),
+                            FileSystem::join(writedir, m_filename)))
+    {
+      return false;
+    }
+
+    if (m_conditional) {
+      save_validators();
+    }
+    return true;
+  }
+
   size_t on_data(void* ptr, size_t size, size_t nmemb)
   {
-    PHYSFS_writeBytes(m_fout.get(), ptr, size * nmemb);
+    if (!m_started)
+    {
+      m_started = true;
+
+      // the server may ignore the Range request and send everything
+      long response_code = 0;
+      curl_easy_getinfo(m_handle, CURLINFO_RESPONSE_CODE, &response_code);
+      if (m_resume_from > 0 && response_code != 206)
+      {
+        m_fout.reset(PHYSFS_openWrite(m_part_filename.c_str()));
+        m_resume_from = 0;
+        if (!m_fout)
+          return 0;
+      }
+    }
+
+    const PHYSFS_sint64 written = PHYSFS_writeBytes(m_fout.get(), ptr, size * nmemb);
+    return written < 0 ? 0 : static_cast<size_t>(written);
+  }
+
+  size_t on_header(char* ptr, size_t size, size_t nmemb)
+  {
+    const std::string line(ptr, size * nmemb);
+
+    // a redirect or a 100 Continue starts a new set of headers
+    if (line.compare(0, 5, "HTTP/") == 0)
+    {
+      m_etag.clear();
+      m_last_modified.clear();
+    }
+    else if (!parse_header(line, "ETag", m_etag))
+    {
+      parse_header(line, "Last-Modified", m_last_modified);
+    }
     return size * nmemb;
   }
 
   int on_progress(double dltotal, double dlnow,
                    double ultotal, double ulnow)
   {
-    m_status->dltotal = static_cast<int>(dltotal);
-    m_status->dlnow = static_cast<int>(dlnow);
+    // cURL only counts the bytes of this transfer
+    const double resumed = static_cast<double>(m_resume_from);
+    m_dltotal = static_cast<int>(dltotal > 0.0 ? dltotal + resumed : 0.0);
+    m_dlnow = static_cast<int>(dlnow + resumed);
 
-    m_status->ultotal = static_cast<int>(ultotal);
-    m_status->ulnow = static_cast<int>(ulnow);
+    m_ultotal = static_cast<int>(ultotal);
+    m_ulnow = static_cast<int>(ulnow);
 
     return 0;
   }
 
 private:
+  /** Sends the validators of the last download, as long as it was
+      from the same URL and the file is still around */
+  void add_validators()
+  {
+    if (!PHYSFS_exists(m_filename.c_str()) ||
+        !PHYSFS_exists(m_etag_filename.c_str()))
+      return;
+
+    std::string url;
+    std::string etag;
+    std::string last_modified;
+    {
+      IFileStream in(m_etag_filename);
+      std::getline(in, url);
+      std::getline(in, etag);
+      std::getline(in, last_modified);
+    }
+
+    if (url != m_url)
+      return;
+
+    if (!etag.empty()) {
+      m_headers.reset(curl_slist_append(m_headers.release(), ("If-None-Match: " + etag).c_str()));
+    }
+    if (!last_modified.empty()) {
+      m_headers.reset(curl_slist_append(m_headers.release(), ("If-Modified-Since: " + last_modified).c_str()));
+    }
+    if (m_headers) {
+      curl_easy_setopt(m_handle, CURLOPT_HTTPHEADER, m_headers.get());
+    }
+  }
+
+  void save_validators()
+  {
+    if (m_etag.empty() && m_last_modified.empty())
+    {
+      if (PHYSFS_exists(m_etag_filename.c_str())) {
+        PHYSFS_delete(m_etag_filename.c_str());
+      }
+      return;
+    }
+
+    try
+    {
+      OFileStream out(m_etag_filename);
+      out << m_url << '\n' << m_etag << '\n' << m_last_modified << '\n';
+    }
+    catch(const std::exception& err)
+    {
+      log_warning << "couldn't write " << m_etag_filename << ": " << err.what() << std::endl;
+    }
+  }
+
   static size_t on_data_wrap(char* ptr, size_t size, size_t nmemb, void* userdata)
   {
     return static_cast<Transfer*>(userdata)->on_data(ptr, size, nmemb);
   }
 
+  static size_t on_header_wrap(char* ptr, size_t size, size_t nmemb, void* userdata)
+  {
+    return static_cast<Transfer*>(userdata)->on_header(ptr, size, nmemb);
+  }
+
   static int on_progress_wrap(void* userdata,
                               double dltotal, double dlnow,
                               double ultotal, double ulnow)
@@ -190,10 +428,18 @@ private:
   Transfer& operator=(const Transfer&) = delete;
 };
 
-Downloader::Downloader() :
+Downloader::Downloader(int max_connections) :
   m_multi_handle(),
+  m_easy_handle(),
   m_transfers(),
-  m_next_transfer_id(1)
+  m_next_transfer_id(1),
+  m_thread(),
+  m_mutex(),
+  m_cond(),
+  m_quit(false),
+  m_pending_add(),
+  m_pending_remove(),
+  m_finished()
 {
   curl_global_init(CURL_GLOBAL_ALL);
   m_multi_handle = curl_multi_init();
@@ -201,20 +447,110 @@ Downloader::Downloader() :
   {
     throw std::runtime_error("curl_multi_init() failed");
   }
+
+  if (max_connections > 0)
+  {
+    curl_multi_setopt(m_multi_handle, CURLMOPT_MAX_TOTAL_CONNECTIONS, static_cast<long>(max_connections));
+  }
+
+  m_easy_handle = curl_easy_init();
+  if (!m_easy_handle)
+  {
+    throw std::runtime_error("curl_easy_init() failed");
+  }
 }
 
 Downloader::~Downloader()
 {
+  if (m_thread.joinable())
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_quit = true;
+    }
+    wakeup();
+    m_thread.join();
+  }
+
   for (auto& transfer : m_transfers)
   {
     curl_multi_remove_handle(m_multi_handle, transfer->get_curl_handle());
   }
   m_transfers.clear();
+  m_pending_remove.clear();
 
+  curl_easy_cleanup(m_easy_handle);
   curl_multi_cleanup(m_multi_handle);
   curl_global_cleanup();
 }
 
+void
+Downloader::wakeup()
+{
+  m_cond.notify_one();
+#if LIBCURL_VERSION_NUM >= 0x074400
+  curl_multi_wakeup(m_multi_handle);
+#endif
+}
+
+void
+Downloader::run()
+{
+  int running_handles = 0;
+  while (true)
+  {
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_cond.wait(lock, [this, running_handles] {
+          return m_quit || running_handles > 0 || !m_pending_add.empty() || !m_pending_remove.empty();
+        });
+
+      if (m_quit)
+        return;
+
+      for (CURL* handle : m_pending_add) {
+        curl_multi_add_handle(m_multi_handle, handle);
+      }
+      m_pending_add.clear();
+
+      for (auto& transfer : m_pending_remove) {
+        curl_multi_remove_handle(m_multi_handle, transfer->get_curl_handle());
+      }
+      m_pending_remove.clear();
+    }
+
+    curl_multi_perform(m_multi_handle, &running_handles);
+
+    int msgs_in_queue;
+    CURLMsg* msg;
+    while ((msg = curl_multi_info_read(m_multi_handle, &msgs_in_queue)))
+    {
+      if (msg->msg == CURLMSG_DONE)
+      {
+        CURL* handle = msg->easy_handle;
+        const CURLcode result = msg->data.result;
+        curl_multi_remove_handle(m_multi_handle, handle);
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_finished.emplace_back(handle, result);
+      }
+      else
+      {
+        log_warning << "unhandled cURL message: " << msg->msg << std::endl;
+      }
+    }
+
+    if (running_handles > 0)
+    {
+#if LIBCURL_VERSION_NUM >= 0x074200
+      curl_multi_poll(m_multi_handle, nullptr, 0, 100, nullptr);
+#else
+      curl_multi_wait(m_multi_handle, nullptr, 0, 100, nullptr);
+#endif
+    }
+  }
+}
+
 void
 Downloader::download(const std::string& url,
                      size_t (*write_func)(void* ptr, size_t size, size_t nmemb, void* userdata),
@@ -223,8 +559,11 @@ Downloader::download(const std::string& url,
   log_info << "Downloading " << url << std::endl;
 
   char error_buffer[CURL_ERROR_SIZE+1];
+  error_buffer[0] = '\0';
 
-  CURL* curl_handle = curl_easy_init();
+  // reset() keeps the connection cache of the handle alive
+  CURL* curl_handle = m_easy_handle;
+  curl_easy_reset(curl_handle);
   curl_easy_setopt(curl_handle, CURLOPT_URL, url.c_str());
   curl_easy_setopt(curl_handle, CURLOPT_USERAGENT, "SuperTux/" PACKAGE_VERSION " libcURL");
   curl_easy_setopt(curl_handle, CURLOPT_WRITEFUNCTION, write_func);
@@ -234,8 +573,9 @@ Downloader::download(const std::string& url,
   curl_easy_setopt(curl_handle, CURLOPT_NOSIGNAL, 1);
   curl_easy_setopt(curl_handle, CURLOPT_FAILONERROR, 1);
   curl_easy_setopt(curl_handle, CURLOPT_FOLLOWLOCATION, 1);
+  curl_easy_setopt(curl_handle, CURLOPT_TCP_KEEPALIVE, 1L);
   CURLcode result = curl_easy_perform(curl_handle);
-  curl_easy_cleanup(curl_handle);
+  curl_easy_setopt(curl_handle, CURLOPT_ERRORBUFFER, nullptr);
 
   if (result != CURLE_OK)
   {
@@ -256,6 +596,12 @@ void
 Downloader::download(const std::string& url, const std::string& filename)
 {
   log_info << "download: " << url << " to " << filename << std::endl;
+
+  // validators of an earlier conditional transfer no longer match
+  const std::string etag_filename = filename + ".etag";
+  if (PHYSFS_exists(etag_filename.c_str())) {
+    PHYSFS_delete(etag_filename.c_str());
+  }
   std::unique_ptr<PHYSFS_file, int(*)(PHYSFS_File*)> fout(PHYSFS_openWrite(filename.c_str()),
                                                           PHYSFS_close);
   download(url, my_curl_physfs_write, fout.get());
@@ -277,8 +623,16 @@ Downloader::abort(TransferId id)
   {
     TransferStatusPtr status = (*it)->get_status();
 
-    curl_multi_remove_handle(m_multi_handle, (*it)->get_curl_handle());
+    // the I/O thread might still be writing, so it has to get rid of
+    // it, the .part file stays around for resuming
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_pending_add.erase(std::remove(m_pending_add.begin(), m_pending_add.end(), (*it)->get_curl_handle()),
+                          m_pending_add.end());
+      m_pending_remove.push_back(std::move(*it));
+    }
     m_transfers.erase(it);
+    wakeup();
 
     for (auto& callback : status->callbacks)
     {
@@ -297,85 +651,90 @@ Downloader::abort(TransferId id)
 void
 Downloader::update()
 {
-  // read data from the network
-  CURLMcode ret;
-  int running_handles;
-  while ((ret = curl_multi_perform(m_multi_handle, &running_handles)) == CURLM_CALL_MULTI_PERFORM)
+  std::vector<std::pair<CURL*, CURLcode> > finished;
   {
-    log_debug << "updating" << std::endl;
+    std::lock_guard<std::mutex> lock(m_mutex);
+    finished.swap(m_finished);
+  }
+
+  for (auto& transfer : m_transfers) {
+    transfer->update_status();
   }
 
-  // check if any downloads got finished
-  int msgs_in_queue;
-  CURLMsg* msg;
-  while ((msg = curl_multi_info_read(m_multi_handle, &msgs_in_queue)))
+  for (const auto& done : finished)
   {
-    switch (msg->msg)
+    CURLcode resultfromcurl = done.second;
+    log_info << "Download completed with " << resultfromcurl << std::endl;
+
+    auto it = std::find_if(m_transfers.begin(), m_transfers.end(),
+                           [&done](const std::unique_ptr<Transfer>& rhs) {
+                             return rhs->get_curl_handle() == done.first;
+                           });
+    if (it == m_transfers.end()) {
+      // aborted in the meantime
+      continue;
+    }
+
+    TransferStatusPtr status = (*it)->get_status();
+    status->error_msg = (*it)->get_error_buffer();
+    const bool moved = (*it)->finish(resultfromcurl == CURLE_OK);
+    m_transfers.erase(it);
+
+    if (resultfromcurl == CURLE_OK && moved)
+    {
+      bool success = true;
+      for (auto& callback : status->callbacks)
+      {
+        try
+        {
+          callback(success);
+        }
+        catch(const std::exception& err)
+        {
+          success = false;
+          log_warning << "Exception in Downloader: " << err.what() << std::endl;
+          status->error_msg = err.what();
+        }
+      }
+    }
+    else
     {
-      case CURLMSG_DONE:
+      if (resultfromcurl == CURLE_OK) {
+        status->error_msg = "couldn't move download into place";
+      }
+      log_warning << "Error: " << curl_easy_strerror(resultfromcurl) << std::endl;
+      for (auto& callback : status->callbacks)
+      {
+        try
         {
-          CURLcode resultfromcurl = msg->data.result;
-          log_info << "Download completed with " << resultfromcurl << std::endl;
-          curl_multi_remove_handle(m_multi_handle, msg->easy_handle);
-
-          auto it = std::find_if(m_transfers.begin(), m_transfers.end(),
-                                 [&msg](const std::unique_ptr<Transfer>& rhs) {
-                                   return rhs->get_curl_handle() == msg->easy_handle;
-                                 });
-          assert(it != m_transfers.end());
-          TransferStatusPtr status = (*it)->get_status();
-          status->error_msg = (*it)->get_error_buffer();
-          m_transfers.erase(it);
-
-          if (resultfromcurl == CURLE_OK)
-          {
-            bool success = true;
-            for (auto& callback : status->callbacks)
-            {
-              try
-              {
-                callback(success);
-              }
-              catch(const std::exception& err)
-              {
-                success = false;
-                log_warning << "Exception in Downloader: " << err.what() << std::endl;
-                status->error_msg = err.what();
-              }
-            }
-          }
-          else
-          {
-            log_warning << "Error: " << curl_easy_strerror(resultfromcurl) << std::endl;
-            for (auto& callback : status->callbacks)
-            {
-              try
-              {
-                callback(false);
-              }
-              catch(const std::exception& err)
-              {
-                log_warning << "Illegal exception in Downloader: " << err.what() << std::endl;
-              }
-            }
-          }
+          callback(false);
         }
-        break;
-
-      default:
-        log_warning << "unhandled cURL message: " << msg->msg << std::endl;
-        break;
+        catch(const std::exception& err)
+        {
+          log_warning << "Illegal exception in Downloader: " << err.what() << std::endl;
+        }
+      }
     }
   }
 }
 
 TransferStatusPtr
-Downloader::request_download(const std::string& url, const std::string& outfile)
+Downloader::request_download(const std::string& url, const std::string& outfile,
+                             bool conditional)
 {
   log_info << "request_download: " << url << std::endl;
-  auto transfer = std::make_unique<Transfer>(*this, m_next_transfer_id++, url, outfile);
-  curl_multi_add_handle(m_multi_handle, transfer->get_curl_handle());
+  auto transfer = std::make_unique<Transfer>(*this, m_next_transfer_id++, url, outfile, conditional);
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_pending_add.push_back(transfer->get_curl_handle());
+  }
   m_transfers.push_back(std::move(transfer));
+
+  if (!m_thread.joinable()) {
+    m_thread = std::thread(&Downloader::run, this);
+  } else {
+    wakeup();
+  }
   return m_transfers.back()->get_status();
 }
 
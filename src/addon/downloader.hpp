@@ -20,9 +20,13 @@
 
 #include <curl/curl.h>
 #include <curl/easy.h>
+#include <condition_variable>
 #include <functional>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
 #include <vector>
 
 typedef int TransferId;
@@ -42,6 +46,10 @@ public:
 
   std::string error_msg;
 
+  /** Set when a conditional request was answered with 304, the file
+      on disk was left untouched */
+  bool not_modified;
+
   TransferStatus(Downloader& downloader, TransferId id_) :
     m_downloader(downloader),
     id(id_),
@@ -50,7 +58,8 @@ public:
     dlnow(0),
     ultotal(0),
     ulnow(0),
-    error_msg()
+    error_msg(),
+    not_modified(false)
   {}
 
   void abort();
@@ -66,15 +75,39 @@ using TransferStatusPtr = std::shared_ptr<TransferStatus>;
 
 class Transfer;
 
+/** Asynchronous transfers run on an I/O thread of their own, which is
+    the only one touching the cURL multi handle. The main thread hands
+    new and aborted transfers over through queues, and update() picks
+    up finished ones and runs their callbacks. Transfers are written
+    to a .part file that a later request for the same file resumes. */
 class Downloader final
 {
 private:
   CURLM* m_multi_handle;
+
+  /** Reused by the blocking downloads, so they share connections */
+  CURL* m_easy_handle;
+
   std::vector<std::unique_ptr<Transfer> > m_transfers;
   int m_next_transfer_id;
 
+  std::thread m_thread;
+  std::mutex m_mutex;
+  std::condition_variable m_cond;
+  bool m_quit;
+
+  /** Handed from the main thread to the I/O thread, aborted transfers
+      are destroyed by the I/O thread after leaving the multi handle */
+  std::vector<CURL*> m_pending_add;
+  std::vector<std::unique_ptr<Transfer> > m_pending_remove;
+
+  /** Handed from the I/O thread back to the main thread */
+  std::vector<std::pair<CURL*, CURLcode> > m_finished;
+
 public:
-  Downloader();
+  /** \a max_connections limits the parallel connections, further
+      transfers are queued by cURL */
+  Downloader(int max_connections = 4);
   ~Downloader();
 
   /** Download \a url and return the result as string */
@@ -89,9 +122,21 @@ public:
 
   void update();
 
-  TransferStatusPtr request_download(const std::string& url, const std::string& filename);
+  /** With \a conditional the ETag and Last-Modified validators of the
+      previous download of \a url are sent along, they are kept next
+      to \a filename in a .etag file. An unchanged file is left alone
+      and reported through TransferStatus::not_modified. */
+  TransferStatusPtr request_download(const std::string& url, const std::string& filename,
+                                     bool conditional = false);
   void abort(TransferId id);
 
+private:
+  /** Main loop of the I/O thread */
+  void run();
+
+  /** Makes the I/O thread look at the queues */
+  void wakeup();
+
 private:
   Downloader(const Downloader&) = delete;
   Downloader& operator=(const Downloader&) = delete;
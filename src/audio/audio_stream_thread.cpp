@@ -0,0 +1,156 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "audio/audio_stream_thread.hpp"
+
+#include <algorithm>
+
+#include "audio/stream_sound_source.hpp"
+#include "util/profiler.hpp"
+
+namespace {
+
+/** A fragment of music lasts far longer than this, so refilling at
+    this rate keeps the queue full even when a refill is late */
+const std::chrono::milliseconds UPDATE_INTERVAL(10);
+
+} // namespace
+
+AudioStreamThread::AudioStreamThread() :
+  m_mutex(),
+  m_condition(),
+  m_sources(),
+  m_commands(),
+  m_quit(false),
+  m_start_time(std::chrono::steady_clock::now()),
+  m_thread()
+{
+  m_thread = std::thread([this]{ run(); });
+}
+
+AudioStreamThread::~AudioStreamThread()
+{
+  m_quit = true;
+  m_condition.notify_one();
+  m_thread.join();
+}
+
+void
+AudioStreamThread::add(StreamSoundSource* source)
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_sources.push_back(source);
+  }
+  m_condition.notify_one();
+}
+
+void
+AudioStreamThread::remove(StreamSoundSource* source)
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  // pending commands might still point to source, holding the mutex
+  // makes this thread the only consumer of the queue
+  process_commands();
+
+  m_sources.erase(std::remove(m_sources.begin(), m_sources.end(), source), m_sources.end());
+}
+
+void
+AudioStreamThread::set_fading(StreamSoundSource* source, int fade_state, float fade_time)
+{
+  push(Command{source, Command::FADE, fade_state, fade_time});
+}
+
+void
+AudioStreamThread::set_gain(StreamSoundSource* source, float gain)
+{
+  push(Command{source, Command::GAIN, 0, gain});
+}
+
+void
+AudioStreamThread::set_volume(StreamSoundSource* source, float volume)
+{
+  push(Command{source, Command::VOLUME, 0, volume});
+}
+
+void
+AudioStreamThread::push(const Command& command)
+{
+  // only happens if the stream thread hangs, dropping the command
+  // would leave the music at the wrong volume
+  while (!m_commands.push(command)) {
+    std::this_thread::yield();
+  }
+  m_condition.notify_one();
+}
+
+void
+AudioStreamThread::process_commands()
+{
+  Command command;
+  while (m_commands.pop(command))
+  {
+    switch (command.type)
+    {
+      case Command::FADE:
+        command.source->start_fading(static_cast<StreamSoundSource::FadeState>(command.fade_state),
+                                     command.value, get_time());
+        break;
+
+      case Command::GAIN:
+        command.source->OpenALSoundSource::set_gain(command.value);
+        break;
+
+      case Command::VOLUME:
+        command.source->OpenALSoundSource::set_volume(command.value);
+        break;
+    }
+  }
+}
+
+float
+AudioStreamThread::get_time() const
+{
+  return std::chrono::duration<float>(std::chrono::steady_clock::now() - m_start_time).count();
+}
+
+void
+AudioStreamThread::run()
+{
+  Profiler::set_thread_name("audio stream");
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_quit)
+  {
+    process_commands();
+
+    const float time = get_time();
+    for (auto* source : m_sources) {
+      source->update_stream(time);
+    }
+
+    if (m_sources.empty() && m_commands.empty()) {
+      m_condition.wait(lock, [this]{ return m_quit || !m_sources.empty() || !m_commands.empty(); });
+    } else {
+      m_condition.wait_for(lock, UPDATE_INTERVAL, [this]{ return m_quit.load() || !m_commands.empty(); });
+    }
+  }
+}
+
+/* EOF */
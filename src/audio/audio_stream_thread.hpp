@@ -0,0 +1,88 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_AUDIO_AUDIO_STREAM_THREAD_HPP
+#define HEADER_SUPERTUX_AUDIO_AUDIO_STREAM_THREAD_HPP
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "util/spsc_queue.hpp"
+
+class StreamSoundSource;
+
+/** Refills the buffers of all StreamSoundSources on a thread of its
+    own, so a long frame on the main thread doesn't starve the music.
+    Changes to gain, volume and fading are sent through a lock-free
+    queue and applied on the stream thread, which owns that state of
+    registered sources. Only the main thread may send commands. */
+class AudioStreamThread final
+{
+public:
+  AudioStreamThread();
+  ~AudioStreamThread();
+
+  void add(StreamSoundSource* source);
+
+  /** Returns once the stream thread no longer touches source */
+  void remove(StreamSoundSource* source);
+
+  void set_fading(StreamSoundSource* source, int fade_state, float fade_time);
+  void set_gain(StreamSoundSource* source, float gain);
+  void set_volume(StreamSoundSource* source, float volume);
+
+private:
+  struct Command
+  {
+    enum Type { FADE, GAIN, VOLUME };
+
+    StreamSoundSource* source;
+    Type type;
+    int fade_state;
+    float value;
+  };
+
+private:
+  void push(const Command& command);
+  void run();
+
+  /** Needs m_mutex to be held */
+  void process_commands();
+
+  float get_time() const;
+
+private:
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::vector<StreamSoundSource*> m_sources;
+  SPSCQueue<Command, 256> m_commands;
+  std::atomic<bool> m_quit;
+  const std::chrono::steady_clock::time_point m_start_time;
+  std::thread m_thread;
+
+private:
+  AudioStreamThread(const AudioStreamThread&) = delete;
+  AudioStreamThread& operator=(const AudioStreamThread&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -18,14 +18,26 @@
 
 #include <config.h>
 
+#include <algorithm>
 #include <assert.h>
 #include <physfs.h>
+#include <string.h>
 
-OggSoundFile::OggSoundFile(PHYSFS_File* file_, double loop_begin_, double loop_at_) :
+namespace {
+
+/** About three minutes of 44.1kHz stereo */
+const size_t MAX_LOOP_CACHE_SIZE = 32 * 1024 * 1024;
+
+} // namespace
+
+OggSoundFile::OggSoundFile(PHYSFS_File* file_, double loop_begin_, double loop_at_, bool cache_loop) :
   m_file(file_),
   m_vorbis_file(),
   m_loop_begin(),
-  m_loop_at()
+  m_loop_at(),
+  m_loop_cache_state(cache_loop ? LoopCache::PENDING : LoopCache::DISABLED),
+  m_loop_cache(),
+  m_loop_cache_pos(0)
 {
   ov_callbacks callbacks = { cb_read, cb_seek, cb_close, cb_tell };
   ov_open_callbacks(m_file, &m_vorbis_file, nullptr, 0, callbacks);
@@ -56,9 +68,18 @@ OggSoundFile::~OggSoundFile()
 size_t
 OggSoundFile::read(void* _buffer, size_t buffer_size)
 {
+  if (m_loop_cache_state == LoopCache::PLAYING)
+  {
+    const size_t count = std::min(buffer_size, m_loop_cache.size() - m_loop_cache_pos);
+    memcpy(_buffer, m_loop_cache.data() + m_loop_cache_pos, count);
+    m_loop_cache_pos += count;
+    return count;
+  }
+
   char*  buffer         = reinterpret_cast<char*> (_buffer);
   int    section        = 0;
   size_t totalBytesRead = 0;
+  bool   end_reached    = false;
 
   while (buffer_size>0) {
 #ifdef WORDS_BIGENDIAN
@@ -73,8 +94,10 @@ OggSoundFile::read(void* _buffer, size_t buffer_size)
       ogg_int64_t time                   = ov_pcm_tell(&m_vorbis_file);
       ogg_int64_t samples_left_till_loop = m_loop_at - time;
       ogg_int64_t bytes_left_till_loop = samples_left_till_loop * bytes_per_sample;
-      if (bytes_left_till_loop <= 4)
+      if (bytes_left_till_loop <= 4) {
+        end_reached = true;
         break;
+      }
 
       if (bytes_left_till_loop < static_cast<ogg_int64_t>(bytes_to_read)) {
         bytes_to_read    = static_cast<size_t>(bytes_left_till_loop);
@@ -85,6 +108,7 @@ OggSoundFile::read(void* _buffer, size_t buffer_size)
       = ov_read(&m_vorbis_file, buffer, static_cast<int>(bytes_to_read), bigendian,
                 2, 1, &section);
     if (bytesRead == 0) {
+      end_reached = true;
       break;
     }
     buffer_size    -= bytesRead;
@@ -92,12 +116,45 @@ OggSoundFile::read(void* _buffer, size_t buffer_size)
     totalBytesRead += bytesRead;
   }
 
+  if (m_loop_cache_state == LoopCache::RECORDING)
+  {
+    const char* data = reinterpret_cast<const char*> (_buffer);
+    m_loop_cache.insert(m_loop_cache.end(), data, data + totalBytesRead);
+
+    if (m_loop_cache.size() > MAX_LOOP_CACHE_SIZE) {
+      m_loop_cache.clear();
+      m_loop_cache.shrink_to_fit();
+      m_loop_cache_state = LoopCache::DISABLED;
+    } else if (end_reached) {
+      m_loop_cache_state = m_loop_cache.empty() ? LoopCache::DISABLED : LoopCache::COMPLETE;
+    }
+  }
+
   return totalBytesRead;
 }
 
 void
 OggSoundFile::reset()
 {
+  switch (m_loop_cache_state)
+  {
+    case LoopCache::COMPLETE:
+    case LoopCache::PLAYING:
+      m_loop_cache_state = LoopCache::PLAYING;
+      m_loop_cache_pos = 0;
+      return;
+
+    case LoopCache::PENDING:
+    case LoopCache::RECORDING:
+      // the loop region gets recorded from its start
+      m_loop_cache.clear();
+      m_loop_cache_state = LoopCache::RECORDING;
+      break;
+
+    case LoopCache::DISABLED:
+      break;
+  }
+
   ov_pcm_seek(&m_vorbis_file, m_loop_begin);
 }
 
@@ -17,6 +17,7 @@
 #ifndef HEADER_SUPERTUX_AUDIO_OGG_SOUND_FILE_HPP
 #define HEADER_SUPERTUX_AUDIO_OGG_SOUND_FILE_HPP
 
+#include <vector>
 #include <vorbis/vorbisfile.h>
 
 #include "audio/sound_file.hpp"
@@ -32,7 +33,11 @@ private:
   static long cb_tell(void* source);
 
 public:
-  OggSoundFile(PHYSFS_File* file, double loop_begin, double loop_at);
+  /** With cache_loop, the samples between loop_begin and loop_at get
+      kept in memory the first time they are played, so later loops
+      neither seek nor decode. Regions too large to keep are streamed
+      as usual. */
+  OggSoundFile(PHYSFS_File* file, double loop_begin, double loop_at, bool cache_loop);
   ~OggSoundFile();
 
   virtual size_t read(void* buffer, size_t buffer_size) override;
@@ -44,6 +49,11 @@ private:
   ogg_int64_t m_loop_begin;
   ogg_int64_t m_loop_at;
 
+  enum class LoopCache { DISABLED, PENDING, RECORDING, COMPLETE, PLAYING };
+  LoopCache m_loop_cache_state;
+  std::vector<char> m_loop_cache;
+  size_t m_loop_cache_pos;
+
 private:
   OggSoundFile(const OggSoundFile&) = delete;
   OggSoundFile& operator=(const OggSoundFile&) = delete;
@@ -0,0 +1,74 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "audio/prebuffered_sound_file.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+PrebufferedSoundFile::PrebufferedSoundFile(std::unique_ptr<SoundFile> file, size_t prebuffer_size) :
+  m_file(std::move(file)),
+  m_data(prebuffer_size),
+  m_pos(0)
+{
+  m_channels = m_file->m_channels;
+  m_rate = m_file->m_rate;
+  m_bits_per_sample = m_file->m_bits_per_sample;
+  m_size = m_file->m_size;
+
+  size_t bytesread = 0;
+  while (bytesread < m_data.size())
+  {
+    const size_t count = m_file->read(m_data.data() + bytesread, m_data.size() - bytesread);
+    if (count == 0)
+      break;
+    bytesread += count;
+  }
+  m_data.resize(bytesread);
+}
+
+size_t
+PrebufferedSoundFile::read(void* buffer, size_t buffer_size)
+{
+  if (m_pos >= m_data.size())
+    return m_file->read(buffer, buffer_size);
+
+  const size_t count = std::min(buffer_size, m_data.size() - m_pos);
+  memcpy(buffer, m_data.data() + m_pos, count);
+  m_pos += count;
+
+  if (m_pos < m_data.size())
+    return count;
+
+  // the prebuffered part is only played once
+  m_data.clear();
+  m_data.shrink_to_fit();
+  m_pos = 0;
+
+  // short reads mean end of file to callers
+  return count + m_file->read(static_cast<char*>(buffer) + count, buffer_size - count);
+}
+
+void
+PrebufferedSoundFile::reset()
+{
+  m_data.clear();
+  m_pos = 0;
+  m_file->reset();
+}
+
+/* EOF */
@@ -0,0 +1,49 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_AUDIO_PREBUFFERED_SOUND_FILE_HPP
+#define HEADER_SUPERTUX_AUDIO_PREBUFFERED_SOUND_FILE_HPP
+
+#include <vector>
+
+#include "audio/sound_file.hpp"
+
+/** Decodes the start of another SoundFile right away, so that reading
+    it later, e.g. when a StreamSoundSource fills its first buffers,
+    doesn't have to decode anything. Meant to be created on a worker
+    thread. */
+class PrebufferedSoundFile final : public SoundFile
+{
+public:
+  PrebufferedSoundFile(std::unique_ptr<SoundFile> file, size_t prebuffer_size);
+
+  virtual size_t read(void* buffer, size_t buffer_size) override;
+  virtual void reset() override;
+
+private:
+  std::unique_ptr<SoundFile> m_file;
+  std::vector<char> m_data;
+  size_t m_pos;
+
+private:
+  PrebufferedSoundFile(const PrebufferedSoundFile&) = delete;
+  PrebufferedSoundFile& operator=(const PrebufferedSoundFile&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -64,10 +64,12 @@ std::unique_ptr<SoundFile> load_music_file(const std::string& filename_original)
     std::string raw_music_file;
     float loop_begin = 0;
     float loop_at    = -1;
+    bool cache_loop  = false;
 
     music.get("file", raw_music_file);
     music.get("loop-begin", loop_begin);
     music.get("loop-at", loop_at);
+    music.get("cache-loop", cache_loop);
 
     if (loop_begin < 0) {
       throw SoundError("can't loop from negative value");
@@ -89,7 +91,7 @@ std::unique_ptr<SoundFile> load_music_file(const std::string& filename_original)
     }
     else
     {
-      return std::make_unique<OggSoundFile>(file, loop_begin, loop_at);
+      return std::make_unique<OggSoundFile>(file, loop_begin, loop_at, cache_loop);
     }
   }
 }
@@ -120,7 +122,7 @@ std::unique_ptr<SoundFile> load_sound_file(const std::string& filename)
   }
   else
   {
-    return std::make_unique<OggSoundFile>(file, 0, -1);
+    return std::make_unique<OggSoundFile>(file, 0, -1, false);
   }
 }
 
@@ -17,25 +17,67 @@
 #include "audio/sound_manager.hpp"
 
 #include <SDL.h>
+#include <algorithm>
 #include <assert.h>
+#include <math.h>
+#include <ostream>
 #include <stdexcept>
 #include <sstream>
 #include <memory>
 
+#include "audio/audio_stream_thread.hpp"
 #include "audio/dummy_sound_source.hpp"
+#include "audio/prebuffered_sound_file.hpp"
 #include "audio/sound_file.hpp"
 #include "audio/stream_sound_source.hpp"
+#include "supertux/asset_manifest.hpp"
+#include "supertux/gameconfig.hpp"
+#include "supertux/globals.hpp"
+#include "util/job_system.hpp"
 #include "util/log.hpp"
+#include "util/profiler.hpp"
+
+namespace {
+
+/** Number of voices for play(), OpenAL implementations commonly allow
+    at least 256 sources, leave plenty for music and sources owned by
+    game objects */
+const size_t MAX_VOICES = 32;
+
+/** Matches the reference distance set by OpenALSoundSource */
+const float REFERENCE_DISTANCE = 128.0f;
+
+/** Sounds that end up quieter than this at the listener are dropped */
+const float MIN_LOUDNESS = 0.01f;
+
+const SoundManager::SoundLimits DEFAULT_SOUND_LIMITS = { 30, 64.0f, 4 };
+
+/** Sounds this big or bigger are streamed instead of buffered */
+const size_t MAX_BUFFERED_SIZE = 100000;
+
+} // namespace
 
 SoundManager::SoundManager() :
   m_device(alcOpenDevice(nullptr)),
   m_context(alcCreateContext(m_device, nullptr)),
   m_sound_enabled(false),
   m_sound_volume(0),
+  m_stream_thread(new AudioStreamThread),
   m_buffers(),
+  m_buffers_bytes(0),
+  m_buffers_clock(0),
+  m_pending_sounds(),
   m_sources(),
-  m_update_list(),
+  m_voices(),
+  m_voice_serial(0),
+  m_sound_limits(),
+  m_listener_position(),
   m_music_source(),
+  m_fading_music(),
+  m_prepared_music(),
+  m_prepared_music_file(),
+  m_music_pending(false),
+  m_pending_music_fade(0.0f),
   m_music_enabled(false),
   m_music_volume(0),
   m_current_music()
@@ -53,6 +95,12 @@ SoundManager::SoundManager() :
     m_music_enabled = true;
 
     set_listener_orientation(Vector(0.0f, 0.0f), Vector(0.0f, -1.0f));
+
+    m_voices.reserve(MAX_VOICES);
+    for (size_t i = 0; i < MAX_VOICES; ++i) {
+      m_voices.push_back(Voice{std::make_unique<OpenALSoundSource>(), InternedString(), PRIORITY_LOW,
+                               0.0f, 0.0f, false, Vector(), 0, 0});
+    }
   } catch(std::exception& e) {
     if (m_context != nullptr) {
       alcDestroyContext(m_context);
@@ -70,10 +118,16 @@ SoundManager::SoundManager() :
 SoundManager::~SoundManager()
 {
   m_music_source.reset();
+  m_fading_music.clear();
+  m_voices.clear();
   m_sources.clear();
+  m_stream_thread.reset();
+
+  // the jobs only hold on to the filename
+  m_pending_sounds.clear();
 
   for (const auto& buffer : m_buffers) {
-    alDeleteBuffers(1, &buffer.second);
+    alDeleteBuffers(1, &buffer.second.buffer);
   }
 
   if (m_context != nullptr) {
@@ -86,64 +140,185 @@ SoundManager::~SoundManager()
   }
 }
 
+std::unique_ptr<SoundManager::DecodedSound>
+SoundManager::decode_sound_file(SoundFile& file)
+{
+  Profiler::Scope profile_scope("decode sound");
+
+  auto sound = std::make_unique<DecodedSound>();
+  sound->format = get_sample_format(file);
+  sound->rate = static_cast<ALsizei>(file.m_rate);
+  sound->size = file.m_size;
+  sound->samples.reset(new char[file.m_size]);
+  file.read(sound->samples.get(), file.m_size);
+  return sound;
+}
+
+std::unique_ptr<SoundManager::DecodedSound>
+SoundManager::decode_short_sound(const std::string& filename)
+{
+  std::unique_ptr<SoundFile> file(load_sound_file(filename));
+  if (file->m_size >= MAX_BUFFERED_SIZE)
+    return {};
+
+  return decode_sound_file(*file);
+}
+
 ALuint
-SoundManager::load_file_into_buffer(SoundFile& file)
+SoundManager::add_sound_buffer(const InternedString& filename, const DecodedSound& sound)
 {
-  ALenum format = get_sample_format(file);
+  evict_sound_buffers(sound.size);
+
   ALuint buffer;
   alGenBuffers(1, &buffer);
   check_al_error("Couldn't create audio buffer: ");
-  std::unique_ptr<char[]> samples(new char[file.m_size]);
-  file.read(samples.get(), file.m_size);
   log_debug << "buffer: " << buffer << "\n"
-            << "format: " << format << "\n"
-            << "samples: " << samples.get() << "\n"
-            << "file size: " << static_cast<ALsizei>(file.m_size) << "\n"
-            << "file rate: " << static_cast<ALsizei>(file.m_rate) << "\n";
-
-  alBufferData(buffer, format, samples.get(),
-               static_cast<ALsizei>(file.m_size),
-               static_cast<ALsizei>(file.m_rate));
+            << "format: " << sound.format << "\n"
+            << "file size: " << static_cast<ALsizei>(sound.size) << "\n"
+            << "file rate: " << sound.rate << "\n";
+
+  alBufferData(buffer, sound.format, sound.samples.get(),
+               static_cast<ALsizei>(sound.size), sound.rate);
   check_al_error("Couldn't fill audio buffer: ");
 
+  m_buffers[filename] = SoundBuffer{buffer, sound.size, m_buffers_clock++};
+  m_buffers_bytes += sound.size;
   return buffer;
 }
 
+void
+SoundManager::evict_sound_buffers(size_t extra_bytes)
+{
+  if (g_config->sound_cache_budget <= 0)
+    return;
+
+  const size_t budget = static_cast<size_t>(g_config->sound_cache_budget) * 1024 * 1024;
+  if (m_buffers_bytes + extra_bytes <= budget)
+    return;
+
+  // finished voices still have their last buffer attached
+  for (auto& voice : m_voices) {
+    if (!voice.source->playing() && !voice.source->paused()) {
+      alSourcei(voice.source->m_source, AL_BUFFER, AL_NONE);
+      voice.filename = InternedString();
+    }
+  }
+
+  typedef std::unordered_map<InternedString, SoundBuffer>::iterator BufferIterator;
+  std::vector<BufferIterator> candidates;
+  for (auto it = m_buffers.begin(); it != m_buffers.end(); ++it) {
+    candidates.push_back(it);
+  }
+  std::sort(candidates.begin(), candidates.end(),
+            [](const BufferIterator& lhs, const BufferIterator& rhs) {
+              return lhs->second.last_use < rhs->second.last_use;
+            });
+
+  for (const auto& it : candidates)
+  {
+    if (m_buffers_bytes + extra_bytes <= budget)
+      break;
+
+    // OpenAL refuses to delete buffers that are attached to a source
+    alGetError();
+    alDeleteBuffers(1, &it->second.buffer);
+    if (alGetError() != AL_NO_ERROR)
+      continue;
+
+    log_debug << "evicting sound '" << it->first << "' (" << it->second.bytes << " bytes)" << std::endl;
+    m_buffers_bytes -= it->second.bytes;
+    m_buffers.erase(it);
+  }
+}
+
+void
+SoundManager::finish_preloads()
+{
+  for (auto it = m_pending_sounds.begin(); it != m_pending_sounds.end(); )
+  {
+    if (it->second.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    {
+      ++it;
+      continue;
+    }
+
+    try {
+      auto sound = it->second.get();
+      if (sound && m_buffers.find(it->first) == m_buffers.end()) {
+        add_sound_buffer(it->first, *sound);
+      }
+    } catch(std::exception& e) {
+      log_warning << "Error while preloading sound file: " << e.what() << std::endl;
+    }
+    it = m_pending_sounds.erase(it);
+  }
+}
+
 std::unique_ptr<OpenALSoundSource>
 SoundManager::intern_create_sound_source(const std::string& filename)
 {
   assert(m_sound_enabled);
 
+  std::unique_ptr<SoundFile> stream_file;
+  ALuint buffer = get_sound_buffer(InternedString(filename), stream_file);
+  if (stream_file)
+  {
+    log_debug << "Playing \"" << filename <<
+      "\" as StreamSoundSource, file size: " << stream_file->m_size << std::endl;
+    auto stream_source = std::make_unique<StreamSoundSource>();
+    stream_source->set_volume(static_cast<float>(m_sound_volume) / 100.0f);
+    stream_source->set_sound_file(std::move(stream_file));
+    return std::unique_ptr<OpenALSoundSource>(stream_source.release());
+  }
+
   auto source = std::make_unique<OpenALSoundSource>();
   source->set_volume(static_cast<float>(m_sound_volume) / 100.0f);
+  alSourcei(source->m_source, AL_BUFFER, buffer);
+  return source;
+}
 
-  ALuint buffer;
-
+ALuint
+SoundManager::get_sound_buffer(const InternedString& filename, std::unique_ptr<SoundFile>& stream_file)
+{
   // reuse an existing static sound buffer
   auto it = m_buffers.find(filename);
-  if (it != m_buffers.end()) {
-    buffer = it->second;
-  } else {
-    // Load sound file
-    std::unique_ptr<SoundFile> file(load_sound_file(filename));
-
-    if (file->m_size < 100000) {
-      log_debug << "Adding \"" << filename <<
-        "\" into the buffer, file size: " << file->m_size << std::endl;
-      buffer = load_file_into_buffer(*file);
-      m_buffers.insert(std::make_pair(filename, buffer));
-    } else {
-      log_debug << "Playing \"" << filename <<
-        "\" as StreamSoundSource, file size: " << file->m_size << std::endl;
-      auto stream_source = std::make_unique<StreamSoundSource>();
-      stream_source->set_sound_file(std::move(file));
-      stream_source->set_volume(static_cast<float>(m_sound_volume) / 100.0f);
-      return std::unique_ptr<OpenALSoundSource>(stream_source.release());
+  if (it != m_buffers.end())
+  {
+    it->second.last_use = m_buffers_clock++;
+    return it->second.buffer;
+  }
+
+  // the sound might still be decoding on the JobSystem
+  auto pending = m_pending_sounds.find(filename);
+  if (pending != m_pending_sounds.end())
+  {
+    auto future = std::move(pending->second);
+    m_pending_sounds.erase(pending);
+
+    auto sound = future.get();
+    if (sound) {
+      if (auto manifest = AssetManifest::current()) {
+        manifest->record_sound(filename.str());
+      }
+      return add_sound_buffer(filename, *sound);
     }
   }
 
-  alSourcei(source->m_source, AL_BUFFER, buffer);
-  return source;
+  // Load sound file
+  std::unique_ptr<SoundFile> file(load_sound_file(filename.str()));
+
+  if (file->m_size >= MAX_BUFFERED_SIZE)
+  {
+    stream_file = std::move(file);
+    return 0;
+  }
+
+  if (auto manifest = AssetManifest::current()) {
+    manifest->record_sound(filename.str());
+  }
+  log_debug << "Adding \"" << filename <<
+    "\" into the buffer, file size: " << file->m_size << std::endl;
+  return add_sound_buffer(filename, *decode_sound_file(*file));
 }
 
 std::unique_ptr<SoundSource>
@@ -166,26 +341,42 @@ SoundManager::preload(const std::string& filename)
   if (!m_sound_enabled)
     return;
 
-  auto it = m_buffers.find(filename);
+  if (auto manifest = AssetManifest::current()) {
+    manifest->record_sound(filename);
+  }
+
   // already loaded?
-  if (it != m_buffers.end())
+  const InternedString name(filename);
+  if (m_buffers.find(name) != m_buffers.end() ||
+      m_pending_sounds.find(name) != m_pending_sounds.end())
     return;
-  try {
-    std::unique_ptr<SoundFile> file (load_sound_file(filename));
-    // only keep small files
-    if (file->m_size >= 100000)
-      return;
 
-    ALuint buffer = load_file_into_buffer(*file);
-    m_buffers.insert(std::make_pair(filename, buffer));
-  } catch(std::exception& e) {
-    log_warning << "Error while preloading sound file: " << e.what() << std::endl;
+  m_pending_sounds[name] = JobSystem::async([filename]{
+      return decode_short_sound(filename);
+    });
+}
+
+void
+SoundManager::debug_print(std::ostream& out) const
+{
+  out << "sounds:begin" << std::endl;
+  for (const auto& it : m_buffers)
+  {
+    out << "  sound filename:" << it.first
+        << " bytes:" << it.second.bytes
+        << " age:" << m_buffers_clock - it.second.last_use << std::endl;
   }
+  out << "sounds:end" << std::endl;
+
+  out << "total sound count:" << m_buffers.size() << std::endl;
+  out << "total sound bytes:" << m_buffers_bytes
+      << " budget:" << g_config->sound_cache_budget << "MB" << std::endl;
+  out << "pending sound count:" << m_pending_sounds.size() << std::endl;
 }
 
 void
-SoundManager::play(const std::string& filename, const Vector& pos,
-  const float gain)
+SoundManager::play(const InternedString& filename, const Vector& pos,
+  const float gain, Priority priority)
 {
   if (!m_sound_enabled)
     return;
@@ -194,22 +385,161 @@ SoundManager::play(const std::string& filename, const Vector& pos,
   // the value is set to min(sound_gain * sound_volume, 1)
   assert(gain >= 0.0f && gain <= 1.0f);
 
+  const bool relative = pos.x < 0 || pos.y < 0;
+
+  // roughly what the inverse distance model of OpenAL makes of it
+  float loudness = gain;
+  if (!relative)
+  {
+    const float distance = (pos - m_listener_position).norm();
+    if (distance > REFERENCE_DISTANCE) {
+      loudness *= REFERENCE_DISTANCE / distance;
+    }
+    if (loudness < MIN_LOUDNESS)
+      return;
+  }
+
   try {
-    std::unique_ptr<OpenALSoundSource> source(intern_create_sound_source(filename));
-    source->set_gain(gain);
+    std::unique_ptr<SoundFile> stream_file;
+    ALuint buffer = get_sound_buffer(filename, stream_file);
 
-    if (pos.x < 0 || pos.y < 0) {
-      source->set_relative(true);
-    } else {
-      source->set_position(pos);
+    if (stream_file)
+    {
+      // long sounds are streamed and can't use a voice
+      auto source = std::make_unique<StreamSoundSource>();
+      source->set_volume(static_cast<float>(m_sound_volume) / 100.0f);
+      source->set_gain(gain);
+      if (relative) {
+        source->set_relative(true);
+      } else {
+        source->set_position(pos);
+      }
+      source->set_sound_file(std::move(stream_file));
+      source->play();
+      m_sources.push_back(std::move(source));
+      return;
+    }
+
+    Voice* voice = nullptr;
+    if (coalesce(filename, relative, pos, gain, loudness, voice))
+      return;
+
+    if (!voice) {
+      voice = find_voice(priority, loudness);
     }
-    source->play();
-    m_sources.push_back(std::move(source));
+    if (!voice)
+      return;
+
+    OpenALSoundSource& source = *voice->source;
+    source.stop();
+    alSourcei(source.m_source, AL_BUFFER, buffer);
+    source.set_looping(false);
+    source.set_pitch(1.0f);
+    source.set_velocity(Vector(0.0f, 0.0f));
+    source.set_volume(static_cast<float>(m_sound_volume) / 100.0f);
+    source.set_gain(gain);
+    source.set_relative(relative);
+    source.set_position(relative ? Vector(0.0f, 0.0f) : pos);
+    source.play();
+
+    voice->filename = filename;
+    voice->priority = priority;
+    voice->gain = gain;
+    voice->loudness = loudness;
+    voice->relative = relative;
+    voice->position = pos;
+    voice->start_ticks = SDL_GetTicks();
+    voice->serial = m_voice_serial++;
   } catch(std::exception& e) {
     log_warning << "Couldn't play sound " << filename << ": " << e.what() << std::endl;
   }
 }
 
+SoundManager::Voice*
+SoundManager::find_voice(Priority priority, float loudness)
+{
+  Voice* victim = nullptr;
+  for (auto& voice : m_voices)
+  {
+    if (!voice.source->playing() && !voice.source->paused())
+      return &voice;
+
+    if (voice.priority > priority)
+      continue;
+
+    if (!victim ||
+        voice.priority < victim->priority ||
+        (voice.priority == victim->priority &&
+         (voice.loudness < victim->loudness ||
+          (voice.loudness == victim->loudness && voice.serial < victim->serial))))
+    {
+      victim = &voice;
+    }
+  }
+
+  // don't replace an equally important sound by a quieter one
+  if (victim && victim->priority == priority && victim->loudness > loudness)
+    return nullptr;
+
+  return victim;
+}
+
+bool
+SoundManager::coalesce(const InternedString& filename, bool relative, const Vector& pos,
+                       float gain, float loudness, Voice*& oldest)
+{
+  const SoundLimits& limits = get_sound_limits(filename);
+  const Uint32 now = SDL_GetTicks();
+
+  int count = 0;
+  for (auto& voice : m_voices)
+  {
+    if (voice.filename != filename || !voice.source->playing())
+      continue;
+
+    if (now - voice.start_ticks <= limits.coalesce_time &&
+        voice.relative == relative &&
+        (relative || (pos - voice.position).norm() <= limits.coalesce_distance))
+    {
+      // the sounds are close to in phase, so this is louder than a
+      // single one but quieter than twice the amplitude
+      const float boosted = std::min(1.0f, sqrtf(voice.gain * voice.gain + gain * gain));
+      if (voice.gain > 0.0f) {
+        voice.loudness = std::max(voice.loudness * boosted / voice.gain, loudness);
+      }
+      voice.gain = boosted;
+      voice.source->set_gain(boosted);
+      return true;
+    }
+
+    count += 1;
+    if (!oldest || voice.serial < oldest->serial) {
+      oldest = &voice;
+    }
+  }
+
+  if (count < limits.max_voices) {
+    oldest = nullptr;
+  }
+  return false;
+}
+
+void
+SoundManager::set_sound_limits(const std::string& filename, const SoundLimits& limits)
+{
+  m_sound_limits[InternedString(filename)] = limits;
+}
+
+const SoundManager::SoundLimits&
+SoundManager::get_sound_limits(const InternedString& filename) const
+{
+  auto it = m_sound_limits.find(filename);
+  if (it != m_sound_limits.end())
+    return it->second;
+
+  return DEFAULT_SOUND_LIMITS;
+}
+
 void
 SoundManager::manage_source(std::unique_ptr<SoundSource> source)
 {
@@ -226,7 +556,7 @@ SoundManager::register_for_update(StreamSoundSource* sss)
 {
   if (sss)
   {
-    m_update_list.push_back(sss);
+    m_stream_thread->add(sss);
   }
 }
 
@@ -235,14 +565,7 @@ SoundManager::remove_from_update(StreamSoundSource* sss)
 {
   if (sss)
   {
-    auto it = m_update_list.begin();
-    while (it != m_update_list.end()) {
-      if (*it == sss) {
-        it = m_update_list.erase(it);
-      } else {
-        ++it;
-      }
-    }
+    m_stream_thread->remove(sss);
   }
 }
 
@@ -265,6 +588,8 @@ SoundManager::enable_music(bool enable)
   if (m_music_enabled) {
     play_music(m_current_music);
   } else {
+    m_music_pending = false;
+    m_fading_music.clear();
     if (m_music_source) {
       m_music_source.reset();
     }
@@ -274,11 +599,13 @@ SoundManager::enable_music(bool enable)
 void
 SoundManager::stop_music(float fadetime)
 {
+  m_music_pending = false;
   if (fadetime > 0) {
     if (m_music_source
        && m_music_source->get_fade_state() != StreamSoundSource::FadingOff)
       m_music_source->set_fading(StreamSoundSource::FadingOff, fadetime);
   } else {
+    m_fading_music.clear();
     m_music_source.reset();
   }
   m_current_music = "";
@@ -289,11 +616,42 @@ SoundManager::set_music_volume(int volume)
 {
   m_music_volume = volume;
   if (m_music_source != nullptr) m_music_source->set_volume(static_cast<float>(volume) / 100.0f);
+  for (auto& music : m_fading_music) {
+    music->set_volume(static_cast<float>(volume) / 100.0f);
+  }
+}
+
+void
+SoundManager::prepare_music(const std::string& filename)
+{
+  if (!m_music_enabled || filename.empty() || filename == m_prepared_music)
+    return;
+
+  if (filename == m_current_music && m_music_source && !m_music_pending)
+    return;
+
+  decode_music(filename);
 }
 
-void 
+void
+SoundManager::decode_music(const std::string& filename)
+{
+  m_prepared_music = filename;
+  m_prepared_music_file = JobSystem::async([filename]() -> std::unique_ptr<SoundFile> {
+      return std::make_unique<PrebufferedSoundFile>(load_sound_file(filename),
+                                                    StreamSoundSource::STREAMBUFFERSIZE);
+    });
+}
+
+void
 SoundManager::play_music(const std::string& filename, float fadetime)
 {
+  if (filename == m_current_music && m_music_pending)
+  {
+    m_pending_music_fade = fadetime;
+    return;
+  }
+
   if (filename == m_current_music && m_music_source != nullptr)
   {
     if (m_music_source->paused())
@@ -307,6 +665,7 @@ SoundManager::play_music(const std::string& filename, float fadetime)
     return;
   }
   m_current_music = filename;
+  m_music_pending = false;
   if (!m_music_enabled)
     return;
 
@@ -315,19 +674,47 @@ SoundManager::play_music(const std::string& filename, float fadetime)
     return;
   }
 
+  // the current music keeps playing until the new one is decoded
+  if (filename != m_prepared_music) {
+    decode_music(filename);
+  }
+  m_music_pending = true;
+  m_pending_music_fade = fadetime;
+  start_pending_music();
+}
+
+void
+SoundManager::start_pending_music()
+{
+  if (!m_music_pending || !m_prepared_music_file.valid() ||
+      m_prepared_music_file.wait_for(std::chrono::seconds(0)) != std::future_status::ready)
+    return;
+
+  m_music_pending = false;
+  m_prepared_music.clear();
+
+  const float fadetime = m_pending_music_fade;
   try {
     auto newmusic = std::make_unique<StreamSoundSource>();
-    newmusic->set_sound_file(load_sound_file(filename));
     newmusic->set_looping(true);
     newmusic->set_relative(true);
     newmusic->set_volume(static_cast<float>(m_music_volume) / 100.0f);
     if (fadetime > 0)
       newmusic->set_fading(StreamSoundSource::FadingOn, fadetime);
+    newmusic->set_sound_file(m_prepared_music_file.get());
     newmusic->play();
 
+    // crossfade, the new track starts while the old one fades out
+    if (m_music_source && fadetime > 0 && m_music_source->playing())
+    {
+      if (m_music_source->get_fade_state() != StreamSoundSource::FadingOff)
+        m_music_source->set_fading(StreamSoundSource::FadingOff, fadetime);
+      m_fading_music.push_back(std::move(m_music_source));
+    }
+
     m_music_source = std::move(newmusic);
   } catch(std::exception& e) {
-    log_warning << "Couldn't play music file '" << filename << "': " << e.what() << std::endl;
+    log_warning << "Couldn't play music file '" << m_current_music << "': " << e.what() << std::endl;
     // When this happens, previous music continued playing, stop it, just in case.
     stop_music(0);
   }
@@ -342,6 +729,9 @@ SoundManager::play_music(const std::string& filename, bool fade)
 void
 SoundManager::pause_music(float fadetime)
 {
+  // tracks fading out would end during the pause anyway
+  m_fading_music.clear();
+
   if (m_music_source == nullptr)
     return;
 
@@ -362,6 +752,11 @@ SoundManager::pause_sounds()
       source->pause();
     }
   }
+  for (auto& voice : m_voices) {
+    if (voice.source->playing()) {
+      voice.source->pause();
+    }
+  }
 }
 
 void
@@ -372,6 +767,11 @@ SoundManager::resume_sounds()
       source->resume();
     }
   }
+  for (auto& voice : m_voices) {
+    if (voice.source->paused()) {
+      voice.source->resume();
+    }
+  }
 }
 
 void
@@ -380,6 +780,9 @@ SoundManager::stop_sounds()
   for (auto& source : m_sources) {
     source->stop();
   }
+  for (auto& voice : m_voices) {
+    voice.source->stop();
+  }
 }
 
 void
@@ -389,6 +792,9 @@ SoundManager::set_sound_volume(int volume)
   for (auto& source : m_sources) {
     source->set_volume(static_cast<float>(volume) / 100.0f);
   }
+  for (auto& voice : m_voices) {
+    voice.source->set_volume(static_cast<float>(volume) / 100.0f);
+  }
 }
 
 void
@@ -409,6 +815,8 @@ SoundManager::resume_music(float fadetime)
 void
 SoundManager::set_listener_position(const Vector& pos)
 {
+  m_listener_position = pos;
+
   static Uint32 lastticks = SDL_GetTicks();
 
   Uint32 current_ticks = SDL_GetTicks();
@@ -435,6 +843,9 @@ SoundManager::set_listener_orientation(const Vector& at, const Vector& up)
 void
 SoundManager::update()
 {
+  // checked every frame, tracks should switch as soon as they're decoded
+  start_pending_music();
+
   static Uint32 lasttime = SDL_GetTicks();
   Uint32 now = SDL_GetTicks();
 
@@ -442,6 +853,14 @@ SoundManager::update()
     return;
   lasttime = now;
 
+  finish_preloads();
+
+  m_fading_music.erase(std::remove_if(m_fading_music.begin(), m_fading_music.end(),
+                                      [](const std::unique_ptr<StreamSoundSource>& music) {
+                                        return !music->playing();
+                                      }),
+                       m_fading_music.end());
+
   // update and check for finished sound sources
   for (auto it = m_sources.begin(); it != m_sources.end(); ) {
     auto& source = *it;
@@ -454,23 +873,11 @@ SoundManager::update()
       ++it;
     }
   }
-  // check streaming sounds
-  if (m_music_source) {
-    m_music_source->update();
-  }
-
   if (m_context)
   {
     alcProcessContext(m_context);
     check_alc_error("Error while processing audio context: ");
   }
-
-  //run update() for stream_sound_source
-  auto s = m_update_list.begin();
-  while (s != m_update_list.end()) {
-    (*s)->update();
-    ++s;
-  }
 }
 
 ALenum
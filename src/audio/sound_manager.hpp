@@ -17,9 +17,12 @@
 #ifndef HEADER_SUPERTUX_AUDIO_SOUND_MANAGER_HPP
 #define HEADER_SUPERTUX_AUDIO_SOUND_MANAGER_HPP
 
-#include <map>
+#include <future>
+#include <iosfwd>
 #include <memory>
+#include <stdint.h>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <al.h>
@@ -27,7 +30,9 @@
 
 #include "math/vector.hpp"
 #include "util/currenton.hpp"
+#include "util/interned_string.hpp"
 
+class AudioStreamThread;
 class SoundFile;
 class SoundSource;
 class StreamSoundSource;
@@ -39,12 +44,41 @@ class SoundManager final : public Currenton<SoundManager>
   friend class StreamSoundSource;
 
 private:
-  static ALuint load_file_into_buffer(SoundFile& file);
+  struct DecodedSound
+  {
+    ALenum format;
+    ALsizei rate;
+    size_t size;
+    std::unique_ptr<char[]> samples;
+  };
+
+  static std::unique_ptr<DecodedSound> decode_sound_file(SoundFile& file);
+
+  /** Decodes a short sound on a worker, returns nullptr for sounds that
+      get streamed */
+  static std::unique_ptr<DecodedSound> decode_short_sound(const std::string& filename);
   static ALenum get_sample_format(const SoundFile& file);
 
   static void print_openal_version();
   static void check_al_error(const char* message);
 
+public:
+  /** Decides which sound gets a voice when all voices are in use */
+  enum Priority { PRIORITY_LOW, PRIORITY_NORMAL, PRIORITY_HIGH };
+
+  /** Limits for how often play() starts the same sound */
+  struct SoundLimits
+  {
+    /** Plays of the same sound within this many milliseconds at
+        positions closer than coalesce_distance merge into one voice,
+        which gets louder instead */
+    uint32_t coalesce_time;
+    float coalesce_distance;
+
+    /** Further plays restart the oldest voice of the sound */
+    int max_voices;
+  };
+
 public:
   SoundManager();
   virtual ~SoundManager();
@@ -57,27 +91,52 @@ public:
       This function never throws exceptions, but might return a DummySoundSource */
   std::unique_ptr<SoundSource> create_sound_source(const std::string& filename);
 
-  /** Convenience functions to simply play a sound at a given position. */
-  void play(const std::string& name, const Vector& pos = Vector(-1, -1),
-    const float gain = 0.5f);
-  void play(const std::string& name, const float gain)
+  /** Convenience functions to simply play a sound at a given position.
+      These use a fixed pool of voices, when all are busy the new sound
+      replaces the quietest and then oldest voice of lower or equal
+      priority, or is dropped. Sounds too far away from the listener
+      to be heard are dropped right away. Repeated plays of the same
+      sound are merged or limited according to its SoundLimits. Objects
+      playing a sound often can keep its InternedString around to skip
+      the lookup of the name. */
+  void play(const InternedString& name, const Vector& pos = Vector(-1, -1),
+    const float gain = 0.5f, Priority priority = PRIORITY_NORMAL);
+  void play(const InternedString& name, const float gain, Priority priority = PRIORITY_NORMAL)
   {
-    play(name, Vector(-1, -1), gain);
+    play(name, Vector(-1, -1), gain, priority);
   }
 
 
+  /** Changes the coalescing and rate limits for one sound file */
+  void set_sound_limits(const std::string& name, const SoundLimits& limits);
+
   /** Adds the source to the list of managed sources (= the source gets deleted
       when it finished playing) */
   void manage_source(std::unique_ptr<SoundSource> source);
 
-  /** preloads a sound, so that you don't get a lag later when playing it */
+  /** preloads a sound, so that you don't get a lag later when playing it.
+      The sound is decoded on a worker thread and becomes available
+      with one of the next update() calls. */
   void preload(const std::string& name);
 
+  /** prints the sound buffers in memory with their sizes */
+  void debug_print(std::ostream& out) const;
+
+  /** Bytes of the decoded sound effects kept in OpenAL buffers */
+  size_t get_buffer_bytes() const { return m_buffers_bytes; }
+  size_t get_buffer_count() const { return m_buffers.size(); }
+
   void set_listener_position(const Vector& position);
   void set_listener_velocity(const Vector& velocity);
   void set_listener_orientation(const Vector& at, const Vector& up);
 
   void enable_music(bool music_enabled);
+  /** Opens and decodes the start of filename on a worker thread, so a
+      later play_music() can switch to it without a hitch */
+  void prepare_music(const std::string& filename);
+
+  /** Switches to filename once it's decoded, the current music keeps
+      playing until then. With a fadetime both tracks crossfade. */
   void play_music(const std::string& filename, float fadetime);
   void play_music(const std::string& filename, bool fade = false);
   void pause_music(float fadetime = 0);
@@ -97,16 +156,63 @@ public:
   std::string get_current_music() const { return m_current_music; }
   void update();
 
-  /** Tell soundmanager to call update() for stream_sound_source. */
+  /** Have the stream thread refill the buffers of stream_sound_source. */
   void register_for_update(StreamSoundSource* sss);
 
-  /** Unsubscribe from updates for stream_sound_source. */
+  /** Unsubscribe from updates for stream_sound_source, waits until
+      the stream thread is done with it. */
   void remove_from_update(StreamSoundSource* sss);
 
+  AudioStreamThread& get_stream_thread() { return *m_stream_thread; }
+
+private:
+  struct Voice
+  {
+    std::unique_ptr<OpenALSoundSource> source;
+    InternedString filename;
+    Priority priority;
+    float gain;
+    float loudness;
+    bool relative;
+    Vector position;
+    uint32_t start_ticks;
+    unsigned int serial;
+  };
+
 private:
   /** creates a new sound source, might throw exceptions, never returns nullptr */
   std::unique_ptr<OpenALSoundSource> intern_create_sound_source(const std::string& filename);
 
+  /** Returns the buffer of a short sound, loading it if needed. Long
+      sounds are not buffered, their file is returned in stream_file
+      and 0 is returned instead. Might throw exceptions. */
+  ALuint get_sound_buffer(const InternedString& filename, std::unique_ptr<SoundFile>& stream_file);
+
+  ALuint add_sound_buffer(const InternedString& filename, const DecodedSound& sound);
+
+  /** Frees least recently used buffers until extra_bytes more fit into
+      the sound_cache_budget. Buffers still attached to a source stay. */
+  void evict_sound_buffers(size_t extra_bytes);
+
+  /** Uploads the sounds that finished decoding on the worker */
+  void finish_preloads();
+
+  void decode_music(const std::string& filename);
+
+  /** Starts the track play_music() asked for if it's decoded */
+  void start_pending_music();
+
+  /** Returns an idle voice or the one to steal for a new sound, nullptr
+      if all voices are more important */
+  Voice* find_voice(Priority priority, float loudness);
+
+  /** Handles a play() of a sound that is already playing, returns
+      true if that took care of it */
+  bool coalesce(const InternedString& filename, bool relative, const Vector& pos,
+                float gain, float loudness, Voice*& voice);
+
+  const SoundLimits& get_sound_limits(const InternedString& filename) const;
+
   void check_alc_error(const char* message) const;
 
 private:
@@ -115,13 +221,40 @@ private:
   bool m_sound_enabled;
   int m_sound_volume;
 
-  std::map<std::string, ALuint> m_buffers;
+  /** Declared before the sources, which unregister on destruction */
+  std::unique_ptr<AudioStreamThread> m_stream_thread;
+
+  struct SoundBuffer
+  {
+    ALuint buffer;
+    size_t bytes;
+    unsigned int last_use;
+  };
+
+  std::unordered_map<InternedString, SoundBuffer> m_buffers;
+  size_t m_buffers_bytes;
+  unsigned int m_buffers_clock;
+
+  /** Sounds decoding on the JobSystem */
+  std::unordered_map<InternedString, std::future<std::unique_ptr<DecodedSound> > > m_pending_sounds;
   std::vector<std::unique_ptr<OpenALSoundSource> > m_sources;
 
-  std::vector<StreamSoundSource*> m_update_list;
+  /** Sources for play(), generated once and recycled */
+  std::vector<Voice> m_voices;
+  unsigned int m_voice_serial;
+  std::unordered_map<InternedString, SoundLimits> m_sound_limits;
+  Vector m_listener_position;
 
   std::unique_ptr<StreamSoundSource> m_music_source;
 
+  /** Previous tracks during a crossfade */
+  std::vector<std::unique_ptr<StreamSoundSource> > m_fading_music;
+
+  std::string m_prepared_music;
+  std::future<std::unique_ptr<SoundFile> > m_prepared_music_file;
+  bool m_music_pending;
+  float m_pending_music_fade;
+
   bool m_music_enabled;
   int m_music_volume;
   std::string m_current_music;
@@ -14,14 +14,18 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
+#include "audio/stream_sound_source.hpp"
+
+#include "audio/audio_stream_thread.hpp"
 #include "audio/sound_file.hpp"
 #include "audio/sound_manager.hpp"
-#include "audio/stream_sound_source.hpp"
-#include "supertux/globals.hpp"
 #include "util/log.hpp"
+#include "util/profiler.hpp"
 
 StreamSoundSource::StreamSoundSource() :
   m_file(),
+  m_buffers(),
+  m_registered(false),
   m_fade_state(NoFading),
   m_fade_start_time(),
   m_fade_time(),
@@ -36,8 +40,6 @@ StreamSoundSource::StreamSoundSource() :
   {
     log_warning << e.what() << std::endl;
   }
-  //add me to update list
-  SoundManager::current()->register_for_update( this );
 }
 
 StreamSoundSource::~StreamSoundSource()
@@ -61,6 +63,12 @@ StreamSoundSource::~StreamSoundSource()
 void
 StreamSoundSource::set_sound_file(std::unique_ptr<SoundFile> newfile)
 {
+  if (m_registered)
+  {
+    SoundManager::current()->remove_from_update(this);
+    m_registered = false;
+  }
+
   m_file = std::move(newfile);
 
   ALint queued;
@@ -69,11 +77,40 @@ StreamSoundSource::set_sound_file(std::unique_ptr<SoundFile> newfile)
     if (fillBufferAndQueue(m_buffers[i]) == false)
       break;
   }
+
+  SoundManager::current()->register_for_update(this);
+  m_registered = true;
+}
+
+void
+StreamSoundSource::set_gain(float gain)
+{
+  if (m_registered) {
+    SoundManager::current()->get_stream_thread().set_gain(this, gain);
+  } else {
+    OpenALSoundSource::set_gain(gain);
+  }
+}
+
+void
+StreamSoundSource::set_volume(float volume)
+{
+  if (m_registered) {
+    SoundManager::current()->get_stream_thread().set_volume(this, volume);
+  } else {
+    OpenALSoundSource::set_volume(volume);
+  }
 }
 
 void
-StreamSoundSource::update()
+StreamSoundSource::update_stream(float time)
 {
+  Profiler::Scope profile_scope("stream refill");
+
+  if (m_fade_start_time < 0.0f) {
+    m_fade_start_time = time;
+  }
+
   ALint processed = 0;
   alGetSourcei(m_source, AL_BUFFERS_PROCESSED, &processed);
   for (ALint i = 0; i < processed; ++i) {
@@ -93,7 +130,10 @@ StreamSoundSource::update()
   }
 
   if (!playing()) {
-    if (processed == 0 || !m_looping)
+    // paused or stopped on purpose from the main thread
+    ALint state = AL_STOPPED;
+    alGetSourcei(m_source, AL_SOURCE_STATE, &state);
+    if (processed == 0 || !m_looping || state != AL_STOPPED)
       return;
 
     // we might have to restart the source if we had a buffer underrun
@@ -102,33 +142,52 @@ StreamSoundSource::update()
   }
 
   if (m_fade_state == FadingOn || m_fade_state == FadingResume) {
-    float time = g_real_time - m_fade_start_time;
-    if (time >= m_fade_time) {
-      set_gain(1.0);
+    float elapsed = time - m_fade_start_time;
+    if (elapsed >= m_fade_time) {
+      OpenALSoundSource::set_gain(1.0);
       m_fade_state = NoFading;
     } else {
-      set_gain(time / m_fade_time);
+      OpenALSoundSource::set_gain(elapsed / m_fade_time);
     }
   } else if (m_fade_state == FadingOff || m_fade_state == FadingPause) {
-    float time = g_real_time - m_fade_start_time;
-    if (time >= m_fade_time) {
+    float elapsed = time - m_fade_start_time;
+    if (elapsed >= m_fade_time) {
       if (m_fade_state == FadingOff)
         stop();
       else
         pause();
       m_fade_state = NoFading;
     } else {
-      set_gain( (m_fade_time - time) / m_fade_time);
+      OpenALSoundSource::set_gain( (m_fade_time - elapsed) / m_fade_time);
     }
   }
 }
 
 void
 StreamSoundSource::set_fading(FadeState state, float fade_time_)
+{
+  // visible to get_fade_state() right away, the stream thread
+  // starts the fade once it gets the command
+  m_fade_state = state;
+
+  if (m_registered) {
+    SoundManager::current()->get_stream_thread().set_fading(this, state, fade_time_);
+  } else {
+    // the fade starts with the first update
+    if (state == FadingOn) {
+      OpenALSoundSource::set_gain(0.0f);
+    }
+    m_fade_time = fade_time_;
+    m_fade_start_time = -1.0f;
+  }
+}
+
+void
+StreamSoundSource::start_fading(FadeState state, float fade_time_, float time)
 {
   m_fade_state = state;
   m_fade_time = fade_time_;
-  m_fade_start_time = g_real_time;
+  m_fade_start_time = time;
 }
 
 bool
@@ -17,14 +17,24 @@
 #ifndef HEADER_SUPERTUX_AUDIO_STREAM_SOUND_SOURCE_HPP
 #define HEADER_SUPERTUX_AUDIO_STREAM_SOUND_SOURCE_HPP
 
+#include <atomic>
+#include <memory>
+
 #include "audio/openal_sound_source.hpp"
 
 class SoundFile;
 
+/** Plays a sound file that is decoded while playing. Once a file is
+    set the buffers are refilled by the AudioStreamThread, gain, volume
+    and fading changes are then forwarded to that thread. */
 class StreamSoundSource final : public OpenALSoundSource
 {
-private:
+  friend class AudioStreamThread;
+
+public:
+  /** Bytes set_sound_file() decodes before playback starts */
   static const size_t STREAMBUFFERSIZE = 1024 * 500;
+private:
   static const size_t STREAMFRAGMENTS = 5;
   static const size_t STREAMFRAGMENTSIZE = STREAMBUFFERSIZE / STREAMFRAGMENTS;
 
@@ -35,9 +45,12 @@ public:
   StreamSoundSource();
   virtual ~StreamSoundSource();
 
-  virtual void update() override;
   virtual void set_looping(bool looping_) override { m_looping = looping_; }
+  virtual void set_gain(float gain) override;
+  virtual void set_volume(float volume) override;
 
+  /** Set the looping mode, volume and fading before the file, so the
+      first buffers are already filled with them applied */
   void set_sound_file(std::unique_ptr<SoundFile> newfile);
 
   void set_fading(FadeState state, float fadetime);
@@ -47,14 +60,21 @@ public:
 private:
   bool fillBufferAndQueue(ALuint buffer);
 
+  /** Called on the stream thread once registered */
+  void update_stream(float time);
+  void start_fading(FadeState state, float fade_time, float time);
+
 private:
   std::unique_ptr<SoundFile> m_file;
   ALuint m_buffers[STREAMFRAGMENTS];
 
-  FadeState m_fade_state;
+  /** Set once the stream thread owns the file and the fading state */
+  bool m_registered;
+
+  std::atomic<FadeState> m_fade_state;
   float m_fade_start_time;
   float m_fade_time;
-  bool m_looping;
+  std::atomic<bool> m_looping;
 
 private:
   StreamSoundSource(const StreamSoundSource&) = delete;
@@ -41,6 +41,11 @@ static const float BURN_TIME = 1;
 static const float X_OFFSCREEN_DISTANCE = 1280;
 static const float Y_OFFSCREEN_DISTANCE = 800;
 
+/** Active badguys only get deactivated this much further away than
+    inactive ones get activated, so they don't flip between the two
+    states while moving along the border */
+static const float DEACTIVATE_MARGIN = 64;
+
 BadGuy::BadGuy(const Vector& pos, const std::string& sprite_name_, int layer_,
                const std::string& light_sprite_name) :
   BadGuy(pos, Direction::LEFT, sprite_name_, layer_, light_sprite_name)
@@ -173,7 +178,7 @@ BadGuy::update(float dt_sec)
       return;
     }
   }
-  if ((m_state != STATE_INACTIVE) && is_offscreen()) {
+  if ((m_state != STATE_INACTIVE) && is_offscreen(DEACTIVATE_MARGIN)) {
     if (m_state == STATE_ACTIVE) deactivate();
     set_state(STATE_INACTIVE);
   }
@@ -599,14 +604,26 @@ BadGuy::set_state(State state_)
 }
 
 bool
-BadGuy::is_offscreen() const
+BadGuy::is_dormant(Vector& pos) const
 {
+  if (m_state != STATE_INIT && m_state != STATE_INACTIVE)
+    return false;
+
+  pos = m_col.m_bbox.get_middle();
+  return true;
+}
+
+bool
+BadGuy::is_offscreen(float margin) const
+{
+  const float x_distance = X_OFFSCREEN_DISTANCE + margin;
+  const float y_distance = Y_OFFSCREEN_DISTANCE + margin;
+
   Vector cam_dist;
   Vector player_dist;
-  Camera& cam = Sector::get().get_camera();
-  cam_dist = cam.get_center() - m_col.m_bbox.get_middle();
+  cam_dist = Sector::get().get_camera().get_view_state().center - m_col.m_bbox.get_middle();
   if (Editor::is_active()) {
-      if ((fabsf(cam_dist.x) <= X_OFFSCREEN_DISTANCE) && (fabsf(cam_dist.y) <= Y_OFFSCREEN_DISTANCE)) {
+      if ((fabsf(cam_dist.x) <= x_distance) && (fabsf(cam_dist.y) <= y_distance)) {
         return false;
     }
   }
@@ -618,8 +635,8 @@ BadGuy::is_offscreen() const
   }
   // In SuperTux 0.1.x, Badguys were activated when Tux<->Badguy center distance was approx. <= ~668px
   // This doesn't work for wide-screen monitors which give us a virt. res. of approx. 1066px x 600px
-  if (((fabsf(player_dist.x) <= X_OFFSCREEN_DISTANCE) && (fabsf(player_dist.y) <= Y_OFFSCREEN_DISTANCE))
-      ||((fabsf(cam_dist.x) <= X_OFFSCREEN_DISTANCE) && (fabsf(cam_dist.y) <= Y_OFFSCREEN_DISTANCE))) {
+  if (((fabsf(player_dist.x) <= x_distance) && (fabsf(player_dist.y) <= y_distance))
+      ||((fabsf(cam_dist.x) <= x_distance) && (fabsf(cam_dist.y) <= y_distance))) {
     return false;
   }
   return true;
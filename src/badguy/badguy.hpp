@@ -49,6 +49,9 @@ public:
       state and calls active_update and inactive_update */
   virtual void update(float dt_sec) override;
 
+  /** Inactive badguys only wait for try_activate() to succeed */
+  virtual bool is_dormant(Vector& pos) const override;
+
   virtual std::string get_class() const override { return "badguy"; }
   virtual std::string get_display_name() const override { return _("Badguy"); }
 
@@ -190,9 +193,9 @@ protected:
   /** returns a pointer to the nearest player or 0 if no player is available */
   Player* get_nearest_player() const;
 
-  /** initial position of the enemy. Also the position where enemy
-      respawns when after being deactivated. */
-  bool is_offscreen() const;
+  /** Returns true if the enemy is too far away from the camera and
+      the nearest player to be active, margin widens that distance */
+  bool is_offscreen(float margin = 0.0f) const;
 
   /** Returns true if we might soon fall at least @c height
       pixels. Minimum value for height is 1 pixel */
@@ -34,6 +34,14 @@ const float TIME_STUNNED = 0.5f;
 const float NORMAL_WALK_SPEED = 80.0f;
 const float EXPLODING_WALK_SPEED = 160.0f;
 
+// switched to every frame while exploding
+const ActionId ACTION_LEFT("left");
+const ActionId ACTION_RIGHT("right");
+const ActionId ACTION_ACTIVE_LEFT("active-left");
+const ActionId ACTION_ACTIVE_RIGHT("active-right");
+const ActionId ACTION_TICKING_LEFT("ticking-left");
+const ActionId ACTION_TICKING_RIGHT("ticking-right");
+
 } // namespace
 
 Haywire::Haywire(const ReaderMapping& reader) :
@@ -126,14 +134,14 @@ Haywire::active_update(float dt_sec)
 
   if (is_exploding) {
 	  if (stomped_timer.get_timeleft() < 0.05f) {
-        set_action ((m_dir == Direction::LEFT) ? "ticking-left" : "ticking-right", /* loops = */ -1);
-        walk_left_action = "ticking-left";
-        walk_right_action = "ticking-right";
+        set_action ((m_dir == Direction::LEFT) ? ACTION_TICKING_LEFT : ACTION_TICKING_RIGHT, /* loops = */ -1);
+        walk_left_action = ACTION_TICKING_LEFT;
+        walk_right_action = ACTION_TICKING_RIGHT;
     }
     else {
-        set_action ((m_dir == Direction::LEFT) ? "active-left" : "active-right", /* loops = */ 1);
-        walk_left_action = "active-left";
-	      walk_right_action = "active-right";
+        set_action ((m_dir == Direction::LEFT) ? ACTION_ACTIVE_LEFT : ACTION_ACTIVE_RIGHT, /* loops = */ 1);
+        walk_left_action = ACTION_ACTIVE_LEFT;
+	      walk_right_action = ACTION_ACTIVE_RIGHT;
     }
 
     auto p = get_nearest_player ();
@@ -220,8 +228,8 @@ Haywire::start_exploding()
 void
 Haywire::stop_exploding()
 {
-  walk_left_action = "left";
-  walk_right_action = "right";
+  walk_left_action = ACTION_LEFT;
+  walk_right_action = ACTION_RIGHT;
   set_walk_speed(NORMAL_WALK_SPEED);
   time_until_explosion = 0.0f;
   is_exploding = false;
@@ -0,0 +1,364 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "collision/aabb_tree.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+namespace {
+
+Rectf merge(const Rectf& lhs, const Rectf& rhs)
+{
+  return Rectf(std::min(lhs.get_left(), rhs.get_left()),
+               std::min(lhs.get_top(), rhs.get_top()),
+               std::max(lhs.get_right(), rhs.get_right()),
+               std::max(lhs.get_bottom(), rhs.get_bottom()));
+}
+
+float perimeter(const Rectf& rect)
+{
+  return 2.0f * (rect.get_width() + rect.get_height());
+}
+
+bool encloses(const Rectf& outer, const Rectf& inner)
+{
+  return
+    outer.get_left() <= inner.get_left() &&
+    outer.get_top() <= inner.get_top() &&
+    inner.get_right() <= outer.get_right() &&
+    inner.get_bottom() <= outer.get_bottom();
+}
+
+} // namespace
+
+AABBTree::AABBTree(float margin) :
+  m_margin(margin),
+  m_nodes(),
+  m_root(NULL_NODE),
+  m_free_list(NULL_NODE),
+  m_stack()
+{
+}
+
+bool
+AABBTree::overlaps(const Rectf& lhs, const Rectf& rhs)
+{
+  // inclusive, like collision::intersects()
+  return !(lhs.get_right() < rhs.get_left() || lhs.get_left() > rhs.get_right() ||
+           lhs.get_bottom() < rhs.get_top() || lhs.get_top() > rhs.get_bottom());
+}
+
+bool
+AABBTree::overlaps_segment(const Rectf& rect, const Vector& start, const Vector& end)
+{
+  const Rectf segment_bbox(std::min(start.x, end.x), std::min(start.y, end.y),
+                           std::max(start.x, end.x), std::max(start.y, end.y));
+  if (!overlaps(rect, segment_bbox))
+    return false;
+
+  // separating axis perpendicular to the segment
+  const Vector dir = end - start;
+  const Vector normal(-dir.y, dir.x);
+  const Vector center = rect.get_middle();
+  const Vector half(rect.get_width() / 2.0f, rect.get_height() / 2.0f);
+
+  const float separation = fabsf(normal * (start - center));
+  const float radius = fabsf(normal.x) * half.x + fabsf(normal.y) * half.y;
+  return separation <= radius;
+}
+
+int
+AABBTree::allocate_node()
+{
+  if (m_free_list == NULL_NODE)
+  {
+    m_nodes.emplace_back();
+    m_nodes.back().height = 0;
+    return static_cast<int>(m_nodes.size()) - 1;
+  }
+  else
+  {
+    const int node = m_free_list;
+    m_free_list = m_nodes[node].parent;
+    m_nodes[node] = Node();
+    m_nodes[node].height = 0;
+    return node;
+  }
+}
+
+void
+AABBTree::free_node(int node)
+{
+  m_nodes[node] = Node();
+  m_nodes[node].parent = m_free_list;
+  m_free_list = node;
+}
+
+int
+AABBTree::insert(CollisionObject* object, const Rectf& rect)
+{
+  const int proxy = allocate_node();
+  m_nodes[proxy].rect = rect.grown(m_margin);
+  m_nodes[proxy].object = object;
+  insert_leaf(proxy);
+  return proxy;
+}
+
+void
+AABBTree::remove(int proxy)
+{
+  assert(proxy >= 0 && m_nodes[proxy].is_leaf());
+
+  remove_leaf(proxy);
+  free_node(proxy);
+}
+
+bool
+AABBTree::move(int proxy, const Rectf& rect)
+{
+  assert(proxy >= 0 && m_nodes[proxy].is_leaf());
+
+  if (encloses(m_nodes[proxy].rect, rect))
+    return false;
+
+  remove_leaf(proxy);
+  m_nodes[proxy].rect = rect.grown(m_margin);
+  insert_leaf(proxy);
+  return true;
+}
+
+void
+AABBTree::insert_leaf(int leaf)
+{
+  if (m_root == NULL_NODE)
+  {
+    m_root = leaf;
+    m_nodes[leaf].parent = NULL_NODE;
+    return;
+  }
+
+  // find the best sibling using the surface area heuristic
+  const Rectf leaf_rect = m_nodes[leaf].rect;
+  int index = m_root;
+  while (!m_nodes[index].is_leaf())
+  {
+    const int child1 = m_nodes[index].child1;
+    const int child2 = m_nodes[index].child2;
+
+    const float area = perimeter(m_nodes[index].rect);
+    const float combined_area = perimeter(merge(m_nodes[index].rect, leaf_rect));
+
+    // cost of creating a new parent for this node and the new leaf
+    const float cost = 2.0f * combined_area;
+
+    // minimum cost of pushing the leaf further down the tree
+    const float inheritance_cost = 2.0f * (combined_area - area);
+
+    auto descend_cost = [this, &leaf_rect, inheritance_cost](int child) {
+      const float merged = perimeter(merge(leaf_rect, m_nodes[child].rect));
+      if (m_nodes[child].is_leaf()) {
+        return merged + inheritance_cost;
+      } else {
+        return merged - perimeter(m_nodes[child].rect) + inheritance_cost;
+      }
+    };
+
+    const float cost1 = descend_cost(child1);
+    const float cost2 = descend_cost(child2);
+
+    if (cost < cost1 && cost < cost2)
+      break;
+
+    index = (cost1 < cost2) ? child1 : child2;
+  }
+
+  const int sibling = index;
+
+  // create a new parent
+  const int old_parent = m_nodes[sibling].parent;
+  const int new_parent = allocate_node();
+  m_nodes[new_parent].parent = old_parent;
+  m_nodes[new_parent].rect = merge(leaf_rect, m_nodes[sibling].rect);
+  m_nodes[new_parent].height = m_nodes[sibling].height + 1;
+  m_nodes[new_parent].child1 = sibling;
+  m_nodes[new_parent].child2 = leaf;
+  m_nodes[sibling].parent = new_parent;
+  m_nodes[leaf].parent = new_parent;
+
+  if (old_parent != NULL_NODE)
+  {
+    if (m_nodes[old_parent].child1 == sibling) {
+      m_nodes[old_parent].child1 = new_parent;
+    } else {
+      m_nodes[old_parent].child2 = new_parent;
+    }
+  }
+  else
+  {
+    m_root = new_parent;
+  }
+
+  // walk back up the tree fixing heights and rectangles
+  index = m_nodes[leaf].parent;
+  while (index != NULL_NODE)
+  {
+    index = balance(index);
+
+    Node& node = m_nodes[index];
+    node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+    node.rect = merge(m_nodes[node.child1].rect, m_nodes[node.child2].rect);
+
+    index = node.parent;
+  }
+}
+
+void
+AABBTree::remove_leaf(int leaf)
+{
+  if (leaf == m_root)
+  {
+    m_root = NULL_NODE;
+    return;
+  }
+
+  const int parent = m_nodes[leaf].parent;
+  const int grand_parent = m_nodes[parent].parent;
+  const int sibling = (m_nodes[parent].child1 == leaf) ? m_nodes[parent].child2 : m_nodes[parent].child1;
+
+  if (grand_parent != NULL_NODE)
+  {
+    // destroy the parent and connect the sibling to the grand parent
+    if (m_nodes[grand_parent].child1 == parent) {
+      m_nodes[grand_parent].child1 = sibling;
+    } else {
+      m_nodes[grand_parent].child2 = sibling;
+    }
+    m_nodes[sibling].parent = grand_parent;
+    free_node(parent);
+
+    int index = grand_parent;
+    while (index != NULL_NODE)
+    {
+      index = balance(index);
+
+      Node& node = m_nodes[index];
+      node.height = 1 + std::max(m_nodes[node.child1].height, m_nodes[node.child2].height);
+      node.rect = merge(m_nodes[node.child1].rect, m_nodes[node.child2].rect);
+
+      index = node.parent;
+    }
+  }
+  else
+  {
+    m_root = sibling;
+    m_nodes[sibling].parent = NULL_NODE;
+    free_node(parent);
+  }
+
+  m_nodes[leaf].parent = NULL_NODE;
+}
+
+int
+AABBTree::balance(int a)
+{
+  if (m_nodes[a].is_leaf() || m_nodes[a].height < 2)
+    return a;
+
+  const int b = m_nodes[a].child1;
+  const int c = m_nodes[a].child2;
+  const int diff = m_nodes[c].height - m_nodes[b].height;
+
+  // rotate c up
+  if (diff > 1)
+  {
+    const int f = m_nodes[c].child1;
+    const int g = m_nodes[c].child2;
+
+    m_nodes[c].child1 = a;
+    m_nodes[c].parent = m_nodes[a].parent;
+    m_nodes[a].parent = c;
+
+    if (m_nodes[c].parent != NULL_NODE)
+    {
+      if (m_nodes[m_nodes[c].parent].child1 == a) {
+        m_nodes[m_nodes[c].parent].child1 = c;
+      } else {
+        m_nodes[m_nodes[c].parent].child2 = c;
+      }
+    }
+    else
+    {
+      m_root = c;
+    }
+
+    // keep the higher grandchild below c
+    const int keep = (m_nodes[f].height > m_nodes[g].height) ? f : g;
+    const int move = (keep == f) ? g : f;
+
+    m_nodes[c].child2 = keep;
+    m_nodes[a].child2 = move;
+    m_nodes[move].parent = a;
+    m_nodes[a].rect = merge(m_nodes[b].rect, m_nodes[move].rect);
+    m_nodes[c].rect = merge(m_nodes[a].rect, m_nodes[keep].rect);
+    m_nodes[a].height = 1 + std::max(m_nodes[b].height, m_nodes[move].height);
+    m_nodes[c].height = 1 + std::max(m_nodes[a].height, m_nodes[keep].height);
+
+    return c;
+  }
+
+  // rotate b up
+  if (diff < -1)
+  {
+    const int d = m_nodes[b].child1;
+    const int e = m_nodes[b].child2;
+
+    m_nodes[b].child1 = a;
+    m_nodes[b].parent = m_nodes[a].parent;
+    m_nodes[a].parent = b;
+
+    if (m_nodes[b].parent != NULL_NODE)
+    {
+      if (m_nodes[m_nodes[b].parent].child1 == a) {
+        m_nodes[m_nodes[b].parent].child1 = b;
+      } else {
+        m_nodes[m_nodes[b].parent].child2 = b;
+      }
+    }
+    else
+    {
+      m_root = b;
+    }
+
+    const int keep = (m_nodes[d].height > m_nodes[e].height) ? d : e;
+    const int move = (keep == d) ? e : d;
+
+    m_nodes[b].child2 = keep;
+    m_nodes[a].child1 = move;
+    m_nodes[move].parent = a;
+    m_nodes[a].rect = merge(m_nodes[c].rect, m_nodes[move].rect);
+    m_nodes[b].rect = merge(m_nodes[a].rect, m_nodes[keep].rect);
+    m_nodes[a].height = 1 + std::max(m_nodes[c].height, m_nodes[move].height);
+    m_nodes[b].height = 1 + std::max(m_nodes[a].height, m_nodes[keep].height);
+
+    return b;
+  }
+
+  return a;
+}
+
+/* EOF */
@@ -0,0 +1,180 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_COLLISION_AABB_TREE_HPP
+#define HEADER_SUPERTUX_COLLISION_AABB_TREE_HPP
+
+#include <vector>
+
+#include "math/rectf.hpp"
+#include "math/vector.hpp"
+
+class CollisionObject;
+
+/** Dynamic bounding volume hierarchy over CollisionObjects. Leaves
+    store a "fat" rectangle that is grown by a margin, so objects
+    moving a little don't require the tree to be touched. Queries
+    report every object whose fat rectangle matches, callers still
+    have to do the exact test against the current bbox. */
+class AABBTree final
+{
+public:
+  static const int NULL_NODE = -1;
+
+public:
+  AABBTree(float margin = 32.0f);
+
+  /** Adds the object with the given bbox, returns the proxy id */
+  int insert(CollisionObject* object, const Rectf& rect);
+
+  void remove(int proxy);
+
+  /** Updates the bbox of a proxy, returns true if the tree had to
+      be changed because rect left the fat rectangle */
+  bool move(int proxy, const Rectf& rect);
+
+  const Rectf& get_fat_rect(int proxy) const { return m_nodes[proxy].rect; }
+
+  /** Calls callback(CollisionObject*) for every object whose fat
+      rectangle overlaps rect, the traversal stops as soon as the
+      callback returns false */
+  template<typename F>
+  void query(const Rectf& rect, F callback) const;
+
+  /** Calls callback(CollisionObject*) for every object whose fat
+      rectangle is crossed by the line segment from start to end,
+      the traversal stops as soon as the callback returns false */
+  template<typename F>
+  void raycast(const Vector& start, const Vector& end, F callback) const;
+
+  /** Height of the tree, for debugging and tests */
+  int get_height() const { return m_root == NULL_NODE ? 0 : m_nodes[m_root].height; }
+
+private:
+  struct Node
+  {
+    Node() : rect(), object(nullptr), parent(NULL_NODE), child1(NULL_NODE), child2(NULL_NODE), height(-1) {}
+
+    bool is_leaf() const { return child1 == NULL_NODE; }
+
+    Rectf rect;
+    CollisionObject* object;
+
+    /** doubles as link in the free list */
+    int parent;
+    int child1;
+    int child2;
+
+    /** leaf = 0, free node = -1 */
+    int height;
+  };
+
+private:
+  static bool overlaps(const Rectf& lhs, const Rectf& rhs);
+  static bool overlaps_segment(const Rectf& rect, const Vector& start, const Vector& end);
+
+  int allocate_node();
+  void free_node(int node);
+
+  void insert_leaf(int leaf);
+  void remove_leaf(int leaf);
+
+  /** Performs a left or right rotation if node is imbalanced,
+      returns the new root of the subtree */
+  int balance(int node);
+
+private:
+  float m_margin;
+  std::vector<Node> m_nodes;
+  int m_root;
+  int m_free_list;
+
+  /** Scratch stack for the traversals */
+  mutable std::vector<int> m_stack;
+
+private:
+  AABBTree(const AABBTree&) = delete;
+  AABBTree& operator=(const AABBTree&) = delete;
+};
+
+template<typename F>
+void
+AABBTree::query(const Rectf& rect, F callback) const
+{
+  if (m_root == NULL_NODE)
+    return;
+
+  // callbacks may run another query, so work on a local copy of the stack
+  std::vector<int> stack;
+  stack.swap(m_stack);
+  stack.clear();
+  stack.push_back(m_root);
+
+  while (!stack.empty())
+  {
+    const Node& node = m_nodes[stack.back()];
+    stack.pop_back();
+
+    if (!overlaps(node.rect, rect))
+      continue;
+
+    if (node.is_leaf()) {
+      if (!callback(node.object))
+        break;
+    } else {
+      stack.push_back(node.child2);
+      stack.push_back(node.child1);
+    }
+  }
+
+  stack.swap(m_stack);
+}
+
+template<typename F>
+void
+AABBTree::raycast(const Vector& start, const Vector& end, F callback) const
+{
+  if (m_root == NULL_NODE)
+    return;
+
+  std::vector<int> stack;
+  stack.swap(m_stack);
+  stack.clear();
+  stack.push_back(m_root);
+
+  while (!stack.empty())
+  {
+    const Node& node = m_nodes[stack.back()];
+    stack.pop_back();
+
+    if (!overlaps_segment(node.rect, start, end))
+      continue;
+
+    if (node.is_leaf()) {
+      if (!callback(node.object))
+        break;
+    } else {
+      stack.push_back(node.child2);
+      stack.push_back(node.child1);
+    }
+  }
+
+  stack.swap(m_stack);
+}
+
+#endif
+
+/* EOF */
@@ -0,0 +1,219 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "collision/bbox_array.hpp"
+
+#include <assert.h>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define SUPERTUX_BBOX_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(__ARM_NEON__)
+#  define SUPERTUX_BBOX_NEON
+#  include <arm_neon.h>
+#endif
+
+#include "math/rectf.hpp"
+
+namespace {
+
+/** Returns true if the box intersects rect, written so that NaN
+    boxes never intersect */
+inline bool
+box_intersects(float left, float top, float right, float bottom, const Rectf& rect)
+{
+  return
+    right >= rect.get_left() && left <= rect.get_right() &&
+    bottom >= rect.get_top() && top <= rect.get_bottom();
+}
+
+#if defined(SUPERTUX_BBOX_SSE2)
+
+/** Tests four boxes at once, bit i of the result is set if box i
+    intersects the rectangle given by the splatted coordinates */
+inline int
+intersect4(__m128 left, __m128 top, __m128 right, __m128 bottom,
+           __m128 rect_left, __m128 rect_top, __m128 rect_right, __m128 rect_bottom)
+{
+  const __m128 x = _mm_and_ps(_mm_cmpge_ps(right, rect_left), _mm_cmple_ps(left, rect_right));
+  const __m128 y = _mm_and_ps(_mm_cmpge_ps(bottom, rect_top), _mm_cmple_ps(top, rect_bottom));
+  return _mm_movemask_ps(_mm_and_ps(x, y));
+}
+
+#elif defined(SUPERTUX_BBOX_NEON)
+
+inline int
+intersect4(float32x4_t left, float32x4_t top, float32x4_t right, float32x4_t bottom,
+           float32x4_t rect_left, float32x4_t rect_top, float32x4_t rect_right, float32x4_t rect_bottom)
+{
+  const uint32x4_t x = vandq_u32(vcgeq_f32(right, rect_left), vcleq_f32(left, rect_right));
+  const uint32x4_t y = vandq_u32(vcgeq_f32(bottom, rect_top), vcleq_f32(top, rect_bottom));
+  const uint32x4_t mask = vandq_u32(x, y);
+  return
+    static_cast<int>(vgetq_lane_u32(mask, 0) & 1) |
+    static_cast<int>(vgetq_lane_u32(mask, 1) & 2) |
+    static_cast<int>(vgetq_lane_u32(mask, 2) & 4) |
+    static_cast<int>(vgetq_lane_u32(mask, 3) & 8);
+}
+
+#endif
+
+} // namespace
+
+BBoxArray::BBoxArray() :
+  m_left(),
+  m_top(),
+  m_right(),
+  m_bottom()
+{
+}
+
+void
+BBoxArray::reset(size_t size)
+{
+  const float nan = std::numeric_limits<float>::quiet_NaN();
+  m_left.assign(size, nan);
+  m_top.assign(size, nan);
+  m_right.assign(size, nan);
+  m_bottom.assign(size, nan);
+}
+
+void
+BBoxArray::set(size_t index, const Rectf& rect)
+{
+  assert(index < size());
+
+  m_left[index] = rect.get_left();
+  m_top[index] = rect.get_top();
+  m_right[index] = rect.get_right();
+  m_bottom[index] = rect.get_bottom();
+}
+
+void
+BBoxArray::query(const Rectf& rect, std::vector<size_t>& result) const
+{
+  result.clear();
+
+  size_t i = 0;
+
+#if defined(SUPERTUX_BBOX_SSE2)
+  const __m128 rect_left = _mm_set1_ps(rect.get_left());
+  const __m128 rect_top = _mm_set1_ps(rect.get_top());
+  const __m128 rect_right = _mm_set1_ps(rect.get_right());
+  const __m128 rect_bottom = _mm_set1_ps(rect.get_bottom());
+  for (; i + 4 <= size(); i += 4)
+  {
+    int mask = intersect4(_mm_loadu_ps(&m_left[i]), _mm_loadu_ps(&m_top[i]),
+                          _mm_loadu_ps(&m_right[i]), _mm_loadu_ps(&m_bottom[i]),
+                          rect_left, rect_top, rect_right, rect_bottom);
+    for (size_t j = i; mask; ++j, mask >>= 1) {
+      if (mask & 1) {
+        result.push_back(j);
+      }
+    }
+  }
+#elif defined(SUPERTUX_BBOX_NEON)
+  const float32x4_t rect_left = vdupq_n_f32(rect.get_left());
+  const float32x4_t rect_top = vdupq_n_f32(rect.get_top());
+  const float32x4_t rect_right = vdupq_n_f32(rect.get_right());
+  const float32x4_t rect_bottom = vdupq_n_f32(rect.get_bottom());
+  for (; i + 4 <= size(); i += 4)
+  {
+    int mask = intersect4(vld1q_f32(&m_left[i]), vld1q_f32(&m_top[i]),
+                          vld1q_f32(&m_right[i]), vld1q_f32(&m_bottom[i]),
+                          rect_left, rect_top, rect_right, rect_bottom);
+    for (size_t j = i; mask; ++j, mask >>= 1) {
+      if (mask & 1) {
+        result.push_back(j);
+      }
+    }
+  }
+#endif
+
+  for (; i < size(); ++i) {
+    if (box_intersects(m_left[i], m_top[i], m_right[i], m_bottom[i], rect)) {
+      result.push_back(i);
+    }
+  }
+}
+
+void
+BBoxArray::filter(const Rectf& rect, const std::vector<size_t>& candidates,
+                  std::vector<size_t>& result) const
+{
+  result.clear();
+
+  size_t i = 0;
+
+#if defined(SUPERTUX_BBOX_SSE2)
+  const __m128 rect_left = _mm_set1_ps(rect.get_left());
+  const __m128 rect_top = _mm_set1_ps(rect.get_top());
+  const __m128 rect_right = _mm_set1_ps(rect.get_right());
+  const __m128 rect_bottom = _mm_set1_ps(rect.get_bottom());
+  for (; i + 4 <= candidates.size(); i += 4)
+  {
+    const size_t c0 = candidates[i];
+    const size_t c1 = candidates[i + 1];
+    const size_t c2 = candidates[i + 2];
+    const size_t c3 = candidates[i + 3];
+    assert(c0 < size() && c1 < size() && c2 < size() && c3 < size());
+
+    int mask = intersect4(_mm_setr_ps(m_left[c0], m_left[c1], m_left[c2], m_left[c3]),
+                          _mm_setr_ps(m_top[c0], m_top[c1], m_top[c2], m_top[c3]),
+                          _mm_setr_ps(m_right[c0], m_right[c1], m_right[c2], m_right[c3]),
+                          _mm_setr_ps(m_bottom[c0], m_bottom[c1], m_bottom[c2], m_bottom[c3]),
+                          rect_left, rect_top, rect_right, rect_bottom);
+    for (size_t j = i; mask; ++j, mask >>= 1) {
+      if (mask & 1) {
+        result.push_back(candidates[j]);
+      }
+    }
+  }
+#elif defined(SUPERTUX_BBOX_NEON)
+  const float32x4_t rect_left = vdupq_n_f32(rect.get_left());
+  const float32x4_t rect_top = vdupq_n_f32(rect.get_top());
+  const float32x4_t rect_right = vdupq_n_f32(rect.get_right());
+  const float32x4_t rect_bottom = vdupq_n_f32(rect.get_bottom());
+  for (; i + 4 <= candidates.size(); i += 4)
+  {
+    const size_t c[4] = { candidates[i], candidates[i + 1], candidates[i + 2], candidates[i + 3] };
+    const float left[4] = { m_left[c[0]], m_left[c[1]], m_left[c[2]], m_left[c[3]] };
+    const float top[4] = { m_top[c[0]], m_top[c[1]], m_top[c[2]], m_top[c[3]] };
+    const float right[4] = { m_right[c[0]], m_right[c[1]], m_right[c[2]], m_right[c[3]] };
+    const float bottom[4] = { m_bottom[c[0]], m_bottom[c[1]], m_bottom[c[2]], m_bottom[c[3]] };
+
+    int mask = intersect4(vld1q_f32(left), vld1q_f32(top), vld1q_f32(right), vld1q_f32(bottom),
+                          rect_left, rect_top, rect_right, rect_bottom);
+    for (size_t j = i; mask; ++j, mask >>= 1) {
+      if (mask & 1) {
+        result.push_back(candidates[j]);
+      }
+    }
+  }
+#endif
+
+  for (; i < candidates.size(); ++i)
+  {
+    const size_t c = candidates[i];
+    assert(c < size());
+    if (box_intersects(m_left[c], m_top[c], m_right[c], m_bottom[c], rect)) {
+      result.push_back(c);
+    }
+  }
+}
+
+/* EOF */
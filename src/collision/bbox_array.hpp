@@ -0,0 +1,64 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_COLLISION_BBOX_ARRAY_HPP
+#define HEADER_SUPERTUX_COLLISION_BBOX_ARRAY_HPP
+
+#include <stddef.h>
+#include <vector>
+
+class Rectf;
+
+/** Bounding boxes stored as separate arrays of left, top, right and
+    bottom coordinates, so one rectangle can be tested against four
+    boxes at once with SSE2 or NEON. Other platforms use a scalar
+    loop. Tests are inclusive like collision::intersects(). */
+class BBoxArray final
+{
+public:
+  BBoxArray();
+
+  /** Resizes the array, all boxes are reset to ones that never
+      intersect anything */
+  void reset(size_t size);
+
+  void set(size_t index, const Rectf& rect);
+
+  size_t size() const { return m_left.size(); }
+
+  /** Fills result with the indices of all boxes intersecting rect, in
+      ascending order */
+  void query(const Rectf& rect, std::vector<size_t>& result) const;
+
+  /** Fills result with those candidates whose box intersects rect,
+      keeping their order */
+  void filter(const Rectf& rect, const std::vector<size_t>& candidates,
+              std::vector<size_t>& result) const;
+
+private:
+  std::vector<float> m_left;
+  std::vector<float> m_top;
+  std::vector<float> m_right;
+  std::vector<float> m_bottom;
+
+private:
+  BBoxArray(const BBoxArray&) = delete;
+  BBoxArray& operator=(const BBoxArray&) = delete;
+};
+
+#endif
+
+/* EOF */
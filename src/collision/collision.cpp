@@ -17,6 +17,7 @@
 #include "collision/collision.hpp"
 
 #include <algorithm>
+#include <vector>
 
 #include "math/aatriangle.hpp"
 #include "math/rectf.hpp"
@@ -36,6 +37,7 @@ bool intersects(const Rectf& r1, const Rectf& r2)
 //---------------------------------------------------------------------------
 
 namespace {
+
 inline void makePlane(const Vector& p1, const Vector& p2, Vector& n, float& c)
 {
   n = Vector(p2.y - p1.y, p1.x - p2.x);
@@ -45,17 +47,9 @@ inline void makePlane(const Vector& p1, const Vector& p2, Vector& n, float& c)
   c /= nval;
 }
 
-}
-
-bool rectangle_aatriangle(Constraints* constraints, const Rectf& rect,
-                          const AATriangle& triangle, const Vector& addl_ground_movement)
+/** The part of the tile covered by the deformed triangle */
+Rectf get_slope_area(const AATriangle& triangle)
 {
-  if (!intersects(rect, triangle.bbox))
-    return false;
-
-  Vector normal;
-  float c = 0.0;
-  Vector p1;
   Rectf area;
   switch (triangle.dir & AATriangle::DEFORM_MASK) {
     case 0:
@@ -81,30 +75,118 @@ bool rectangle_aatriangle(Constraints* constraints, const Rectf& rect,
     default:
       assert(false);
   }
+  return area;
+}
+
+/** The end points of the sloped edge, in the order makePlane() wants
+    them for the normal to point out of the triangle */
+void get_slope_edge(const Rectf& area, int dir, Vector& from, Vector& to)
+{
+  switch (dir & AATriangle::DIRECTION_MASK) {
+    case AATriangle::SOUTHWEST:
+      from = area.p1();
+      to = area.p2();
+      break;
+    case AATriangle::NORTHEAST:
+      from = area.p2();
+      to = area.p1();
+      break;
+    case AATriangle::SOUTHEAST:
+      from = Vector(area.get_left(), area.get_bottom());
+      to = Vector(area.get_right(), area.get_top());
+      break;
+    case AATriangle::NORTHWEST:
+      from = Vector(area.get_right(), area.get_top());
+      to = Vector(area.get_left(), area.get_bottom());
+      break;
+    default:
+      assert(false);
+  }
+}
+
+/** Normal of a slope tile, which only depends on its direction and
+    deform flags, not on where the tile is */
+struct SlopePlane
+{
+  /** Not normalized, as makePlane() computes it */
+  Vector edge_normal;
+  float length;
+  Vector normal;
+};
+
+const int SLOPE_DATA_COUNT = (AATriangle::DIRECTION_MASK | AATriangle::DEFORM_MASK) + 1;
+
+/** Every slope of a 32x32 tile, built once instead of taking a
+    square root and a few divisions for each tested slope */
+const SlopePlane& get_slope_plane(int dir)
+{
+  static const std::vector<SlopePlane> planes = [] {
+    std::vector<SlopePlane> result(SLOPE_DATA_COUNT);
+    for (int data = 0; data < SLOPE_DATA_COUNT; ++data) {
+      const int deform = data & AATriangle::DEFORM_MASK;
+      if ((data & ~(AATriangle::DIRECTION_MASK | AATriangle::DEFORM_MASK)) != 0 ||
+          deform > AATriangle::DEFORM_RIGHT)
+        continue;
+
+      const Rectf area = get_slope_area(AATriangle(Rectf(0.0f, 0.0f, 32.0f, 32.0f), data));
+      Vector from, to;
+      get_slope_edge(area, data, from, to);
+
+      SlopePlane& plane = result[data];
+      plane.edge_normal = Vector(to.y - from.y, from.x - to.x);
+      plane.length = plane.edge_normal.norm();
+      plane.normal = plane.edge_normal / plane.length;
+    }
+    return result;
+  }();
+
+  return planes[dir & (AATriangle::DIRECTION_MASK | AATriangle::DEFORM_MASK)];
+}
+
+}
 
+bool rectangle_aatriangle(Constraints* constraints, const Rectf& rect,
+                          const AATriangle& triangle, const Vector& addl_ground_movement)
+{
+  if (!intersects(rect, triangle.bbox))
+    return false;
+
+  const Rectf area = get_slope_area(triangle);
+
+  Vector p1;
   switch (triangle.dir & AATriangle::DIRECTION_MASK) {
     case AATriangle::SOUTHWEST:
       p1 = Vector(rect.get_left(), rect.get_bottom());
-      makePlane(area.p1(), area.p2(), normal, c);
       break;
     case AATriangle::NORTHEAST:
       p1 = Vector(rect.get_right(), rect.get_top());
-      makePlane(area.p2(), area.p1(), normal, c);
       break;
     case AATriangle::SOUTHEAST:
       p1 = rect.p2();
-      makePlane(Vector(area.get_left(), area.get_bottom()),
-                Vector(area.get_right(), area.get_top()), normal, c);
       break;
     case AATriangle::NORTHWEST:
       p1 = rect.p1();
-      makePlane(Vector(area.get_right(), area.get_top()),
-                Vector(area.get_left(), area.get_bottom()), normal, c);
       break;
     default:
       assert(false);
   }
 
+  Vector from, to;
+  get_slope_edge(area, triangle.dir, from, to);
+
+  Vector normal;
+  float c = 0.0;
+  const SlopePlane& plane = get_slope_plane(triangle.dir);
+  const Vector edge_normal(to.y - from.y, from.x - to.x);
+  if (edge_normal == plane.edge_normal) {
+    // same operations as makePlane(), minus the normalization
+    normal = plane.normal;
+    c = -(to * edge_normal) / plane.length;
+  } else {
+    // not a 32x32 tile or the position isn't exactly representable
+    makePlane(from, to, normal, c);
+  }
+
   float n_p1 = -(normal * p1);
   float depth = n_p1 - c;
   if (depth < 0)
@@ -174,6 +256,48 @@ void set_rectangle_rectangle_constraints(Constraints* constraints,
   }
 }
 
+bool sweep(const Rectf& rect, const Vector& movement, const Rectf& obstacle, float& time)
+{
+  // entry and exit time of the movement on each axis
+  float entry_x, exit_x;
+  if (movement.x > 0) {
+    entry_x = (obstacle.get_left() - rect.get_right()) / movement.x;
+    exit_x = (obstacle.get_right() - rect.get_left()) / movement.x;
+  } else if (movement.x < 0) {
+    entry_x = (obstacle.get_right() - rect.get_left()) / movement.x;
+    exit_x = (obstacle.get_left() - rect.get_right()) / movement.x;
+  } else if (rect.get_right() > obstacle.get_left() && rect.get_left() < obstacle.get_right()) {
+    entry_x = -std::numeric_limits<float>::infinity();
+    exit_x = std::numeric_limits<float>::infinity();
+  } else {
+    return false;
+  }
+
+  float entry_y, exit_y;
+  if (movement.y > 0) {
+    entry_y = (obstacle.get_top() - rect.get_bottom()) / movement.y;
+    exit_y = (obstacle.get_bottom() - rect.get_top()) / movement.y;
+  } else if (movement.y < 0) {
+    entry_y = (obstacle.get_bottom() - rect.get_top()) / movement.y;
+    exit_y = (obstacle.get_top() - rect.get_bottom()) / movement.y;
+  } else if (rect.get_bottom() > obstacle.get_top() && rect.get_top() < obstacle.get_bottom()) {
+    entry_y = -std::numeric_limits<float>::infinity();
+    exit_y = std::numeric_limits<float>::infinity();
+  } else {
+    return false;
+  }
+
+  const float entry = std::max(entry_x, entry_y);
+  const float exit = std::min(exit_x, exit_y);
+
+  // overlapping at the start, grazing a corner or out of reach
+  if (entry < 0.0f || entry >= exit || entry > 1.0f)
+    return false;
+
+  time = entry;
+  return true;
+}
+
 bool line_intersects_line(const Vector& line1_start, const Vector& line1_end, const Vector& line2_start, const Vector& line2_end)
 {
   // Adapted from Striker, (C) 1999 Joris van der Hoeven, GPL
@@ -132,6 +132,14 @@ bool rectangle_aatriangle(Constraints* constraints, const Rectf& rect,
 void set_rectangle_rectangle_constraints(Constraints* constraints,
                                          const Rectf& r1, const Rectf& r2, const Vector& addl_ground_movement = Vector(0,0));
 
+/** Sweeps rect along movement and checks when it first touches
+ * obstacle. Returns true if that happens within the movement and
+ * stores the fraction of the movement in time. Rectangles that
+ * already overlap at the start are not reported, the regular
+ * constraint solving takes care of those.
+ */
+bool sweep(const Rectf& rect, const Vector& movement, const Rectf& obstacle, float& time);
+
 bool line_intersects_line(const Vector& line1_start, const Vector& line1_end, const Vector& line2_start, const Vector& line2_end);
 bool intersects_line(const Rectf& r, const Vector& line_start, const Vector& line_end);
 
@@ -0,0 +1,188 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "collision/collision_grid.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <math.h>
+
+#include "math/rectf.hpp"
+
+namespace {
+
+/** Objects covering more cells than this are not put into cells at
+    all, e.g. huge triggers or path-less platforms spanning the sector */
+const int MAX_CELLS_PER_ENTRY = 64;
+
+/** Queries covering more cells than this simply return all entries */
+const int MAX_CELLS_PER_QUERY = 1024;
+
+} // namespace
+
+CollisionGrid::CollisionGrid(float cell_size) :
+  m_cell_size(cell_size),
+  m_cells(),
+  m_used_cells(),
+  m_oversized(),
+  m_entries()
+{
+}
+
+void
+CollisionGrid::clear()
+{
+  for (const auto& key : m_used_cells) {
+    m_cells[key].clear();
+  }
+  m_used_cells.clear();
+  m_oversized.clear();
+
+  for (auto& entry : m_entries) {
+    entry.present = false;
+  }
+}
+
+bool
+CollisionGrid::get_cells(const Rectf& rect, Rect& cells) const
+{
+  const float left = floorf(rect.get_left() / m_cell_size);
+  const float top = floorf(rect.get_top() / m_cell_size);
+  const float right = floorf(rect.get_right() / m_cell_size);
+  const float bottom = floorf(rect.get_bottom() / m_cell_size);
+
+  // also catches NaN and infinity
+  if (!(right - left < static_cast<float>(MAX_CELLS_PER_QUERY)) ||
+      !(bottom - top < static_cast<float>(MAX_CELLS_PER_QUERY)) ||
+      !(fabsf(left) < 1.0e9f) || !(fabsf(top) < 1.0e9f))
+  {
+    return false;
+  }
+
+  // the range is inclusive as touching rectangles count as intersecting
+  cells = Rect(static_cast<int>(left), static_cast<int>(top),
+               static_cast<int>(right), static_cast<int>(bottom));
+  return true;
+}
+
+void
+CollisionGrid::link(size_t index, Entry& entry)
+{
+  const int width = entry.cells.right - entry.cells.left + 1;
+  const int height = entry.cells.bottom - entry.cells.top + 1;
+  if (entry.oversized || width * height > MAX_CELLS_PER_ENTRY)
+  {
+    entry.oversized = true;
+    m_oversized.push_back(index);
+    return;
+  }
+
+  for (int y = entry.cells.top; y <= entry.cells.bottom; ++y) {
+    for (int x = entry.cells.left; x <= entry.cells.right; ++x) {
+      const uint64_t key = get_key(x, y);
+      auto& cell = m_cells[key];
+      if (cell.empty()) {
+        m_used_cells.push_back(key);
+      }
+      cell.push_back(index);
+    }
+  }
+}
+
+void
+CollisionGrid::unlink(size_t index, Entry& entry)
+{
+  if (entry.oversized)
+  {
+    m_oversized.erase(std::find(m_oversized.begin(), m_oversized.end(), index));
+    return;
+  }
+
+  for (int y = entry.cells.top; y <= entry.cells.bottom; ++y) {
+    for (int x = entry.cells.left; x <= entry.cells.right; ++x) {
+      auto& cell = m_cells[get_key(x, y)];
+      cell.erase(std::find(cell.begin(), cell.end(), index));
+    }
+  }
+}
+
+void
+CollisionGrid::insert(size_t index, const Rectf& rect)
+{
+  if (index >= m_entries.size()) {
+    m_entries.resize(index + 1);
+  }
+
+  Entry& entry = m_entries[index];
+  assert(!entry.present);
+
+  entry.present = true;
+  entry.oversized = !get_cells(rect, entry.cells);
+  link(index, entry);
+}
+
+void
+CollisionGrid::update(size_t index, const Rectf& rect)
+{
+  assert(index < m_entries.size() && m_entries[index].present);
+  Entry& entry = m_entries[index];
+
+  Rect cells;
+  const bool oversized = !get_cells(rect, cells);
+  if (oversized == entry.oversized &&
+      (oversized || cells == entry.cells))
+  {
+    return;
+  }
+
+  unlink(index, entry);
+  entry.cells = cells;
+  entry.oversized = oversized;
+  link(index, entry);
+}
+
+void
+CollisionGrid::query(const Rectf& rect, std::vector<size_t>& result) const
+{
+  result.clear();
+
+  Rect cells;
+  if (!get_cells(rect, cells))
+  {
+    // too large to walk the cells, every entry is a candidate
+    for (size_t i = 0; i < m_entries.size(); ++i) {
+      if (m_entries[i].present) {
+        result.push_back(i);
+      }
+    }
+    return;
+  }
+
+  for (int y = cells.top; y <= cells.bottom; ++y) {
+    for (int x = cells.left; x <= cells.right; ++x) {
+      auto it = m_cells.find(get_key(x, y));
+      if (it != m_cells.end()) {
+        result.insert(result.end(), it->second.begin(), it->second.end());
+      }
+    }
+  }
+  result.insert(result.end(), m_oversized.begin(), m_oversized.end());
+
+  std::sort(result.begin(), result.end());
+  result.erase(std::unique(result.begin(), result.end()), result.end());
+}
+
+/* EOF */
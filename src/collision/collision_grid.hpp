@@ -0,0 +1,96 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_COLLISION_COLLISION_GRID_HPP
+#define HEADER_SUPERTUX_COLLISION_COLLISION_GRID_HPP
+
+#include <unordered_map>
+#include <vector>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "math/rect.hpp"
+
+class Rectf;
+
+/** Uniform grid used as broadphase by the CollisionSystem. Entries
+    are identified by an index chosen by the caller (usually the
+    position in the CollisionSystem's object list), queries return
+    candidate indices sorted ascending so that the narrowphase can
+    visit them in the same order as a linear scan would. */
+class CollisionGrid final
+{
+public:
+  CollisionGrid(float cell_size = 128.0f);
+
+  /** Removes all entries, allocated cells are kept for reuse */
+  void clear();
+
+  /** Adds the entry with the given index covering rect */
+  void insert(size_t index, const Rectf& rect);
+
+  /** Moves an already inserted entry to cover rect, does nothing if
+      the entry still occupies the same cells */
+  void update(size_t index, const Rectf& rect);
+
+  /** Fills result with the indices of all entries sharing a cell with
+      rect, sorted ascending and without duplicates. This is a
+      conservative superset, callers still need to do the exact
+      intersection test. */
+  void query(const Rectf& rect, std::vector<size_t>& result) const;
+
+private:
+  struct Entry
+  {
+    Entry() : cells(), present(false), oversized(false) {}
+
+    Rect cells;
+    bool present;
+    bool oversized;
+  };
+
+private:
+  static uint64_t get_key(int x, int y)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+  }
+
+  /** Returns false if rect is too large or not finite to be put into cells */
+  bool get_cells(const Rectf& rect, Rect& cells) const;
+
+  void link(size_t index, Entry& entry);
+  void unlink(size_t index, Entry& entry);
+
+private:
+  float m_cell_size;
+  std::unordered_map<uint64_t, std::vector<size_t> > m_cells;
+
+  /** Keys of cells that have been filled since the last clear() */
+  std::vector<uint64_t> m_used_cells;
+
+  /** Entries spanning too many cells, these are returned by every query */
+  std::vector<size_t> m_oversized;
+
+  std::vector<Entry> m_entries;
+
+private:
+  CollisionGrid(const CollisionGrid&) = delete;
+  CollisionGrid& operator=(const CollisionGrid&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -39,6 +39,14 @@ public:
   /** called when tiles with special attributes have been touched */
   virtual void collision_tile(uint32_t /*tile_attributes*/) = 0;
 
+  /** called before the first collision() with other when the two
+      objects weren't touching in the previous frame */
+  virtual void collision_begin(GameObject& /*other*/) {}
+
+  /** called in the first frame the two objects stopped touching, not
+      called when either of them is removed from the sector */
+  virtual void collision_end(GameObject& /*other*/) {}
+
   virtual bool listener_is_valid() const = 0;
 };
 
@@ -18,6 +18,7 @@
 #include "collision/collision_object.hpp"
 
 #include "collision/collision_listener.hpp"
+#include "collision/collision_system.hpp"
 #include "supertux/game_object.hpp"
 
 CollisionObject::CollisionObject(CollisionGroup group, CollisionListener& listener) :
@@ -25,13 +26,35 @@ CollisionObject::CollisionObject(CollisionGroup group, CollisionListener& listen
   m_bbox(),
   m_movement(),
   m_group(group),
+  m_system(nullptr),
+  m_group_index(0),
+  m_sequence(0),
+  m_tree_proxy(-1),
+  m_rest_frames(0),
+  m_continuous(false),
+  m_previous_pos(),
   m_dest()
 {
 }
 
+void
+CollisionObject::set_group(CollisionGroup group)
+{
+  if (group == m_group)
+    return;
+
+  const CollisionGroup old_group = m_group;
+  m_group = group;
+  wake_up();
+  if (m_system) {
+    m_system->group_changed(*this, old_group);
+  }
+}
+
 void
 CollisionObject::collision_solid(const CollisionHit& hit)
 {
+  wake_up();
   m_listener.collision_solid(hit);
 }
 
@@ -44,19 +67,48 @@ CollisionObject::collides(CollisionObject& other, const CollisionHit& hit) const
 HitResponse
 CollisionObject::collision(CollisionObject& other, const CollisionHit& hit)
 {
+  wake_up();
   return m_listener.collision(dynamic_cast<GameObject&>(other.m_listener), hit);
 }
 
 void
 CollisionObject::collision_tile(uint32_t tile_attributes)
 {
+  wake_up();
   m_listener.collision_tile(tile_attributes);
 }
 
+void
+CollisionObject::collision_begin(CollisionObject& other)
+{
+  m_listener.collision_begin(dynamic_cast<GameObject&>(other.m_listener));
+}
+
+void
+CollisionObject::collision_end(CollisionObject& other)
+{
+  m_listener.collision_end(dynamic_cast<GameObject&>(other.m_listener));
+}
+
+void
+CollisionObject::bbox_changed()
+{
+  wake_up();
+  if (m_system) {
+    m_system->bbox_changed(*this);
+  }
+}
+
 bool
 CollisionObject::is_valid() const
 {
   return m_listener.listener_is_valid();
 }
 
+bool
+CollisionObject::is_sleeping() const
+{
+  return m_rest_frames >= CollisionSystem::SLEEP_FRAMES;
+}
+
 /* EOF */
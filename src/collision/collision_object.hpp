@@ -18,6 +18,7 @@
 #ifndef HEADER_SUPERTUX_COLLISION_COLLISION_OBJECT_HPP
 #define HEADER_SUPERTUX_COLLISION_COLLISION_OBJECT_HPP
 
+#include <stddef.h>
 #include <stdint.h>
 
 #include "collision/collision_group.hpp"
@@ -25,6 +26,7 @@
 #include "math/rectf.hpp"
 
 class CollisionListener;
+class CollisionSystem;
 class GameObject;
 
 class CollisionObject
@@ -48,6 +50,10 @@ public:
   /** called when tiles with special attributes have been touched */
   void collision_tile(uint32_t tile_attributes);
 
+  /** called when a contact with other starts or ends, see CollisionListener */
+  void collision_begin(CollisionObject& other);
+  void collision_end(CollisionObject& other);
+
   /** returns the bounding box of the Object */
   const Rectf& get_bbox() const
   {
@@ -66,6 +72,7 @@ public:
   {
     m_dest.move(pos - get_pos());
     m_bbox.set_pos(pos);
+    bbox_changed();
   }
 
   Vector get_pos() const
@@ -88,6 +95,7 @@ public:
   {
     m_dest.set_width(w);
     m_bbox.set_width(w);
+    bbox_changed();
   }
 
   /** sets the moving object's bbox to a specific size. Be careful
@@ -97,6 +105,7 @@ public:
   {
     m_dest.set_size(w, h);
     m_bbox.set_size(w, h);
+    bbox_changed();
   }
 
   CollisionGroup get_group() const
@@ -104,13 +113,48 @@ public:
     return m_group;
   }
 
+  /** changes the collision group, the CollisionSystem the object is
+      registered with gets notified so it can move the object to the
+      right group list */
+  void set_group(CollisionGroup group);
+
   bool is_valid() const;
 
+  /** Objects that didn't move and weren't touched by anything for a
+      while are put to sleep and skipped by the static and tile passes
+      of CollisionSystem::update(). They wake up again on their own
+      when they get a movement or are moved. */
+  bool is_sleeping() const;
+
+  /** Objects with continuous collision detection are not limited to
+      the maximum speed per frame of the CollisionSystem. Instead their
+      whole movement is swept against tiles and static objects, so
+      they can't tunnel through them. */
+  void set_continuous(bool continuous)
+  {
+    m_continuous = continuous;
+  }
+
+  bool is_continuous() const
+  {
+    return m_continuous;
+  }
+
+  /** Makes the CollisionSystem consider the object again */
+  void wake_up()
+  {
+    m_rest_frames = 0;
+  }
+
   CollisionListener& get_listener()
   {
     return m_listener;
   }
 
+private:
+  /** tells the CollisionSystem to update its query structures */
+  void bbox_changed();
+
 private:
   CollisionListener& m_listener;
 
@@ -122,9 +166,32 @@ public:
   /** The movement that will happen till next frame */
   Vector m_movement;
 
+private:
   /** The collision group */
   CollisionGroup m_group;
 
+  /** The CollisionSystem this object is registered with, if any */
+  CollisionSystem* m_system;
+
+  /** Position of this object in the group list of m_system */
+  size_t m_group_index;
+
+  /** Order in which the object was added to m_system, the
+      update() passes are sorted by it */
+  uint64_t m_sequence;
+
+  /** Proxy of this object in the AABBTree of m_system */
+  int m_tree_proxy;
+
+  /** Number of frames the object has been at rest, see is_sleeping() */
+  int m_rest_frames;
+
+  /** See set_continuous() */
+  bool m_continuous;
+
+  /** Position at the start of the logic step, for interpolated drawing */
+  Vector m_previous_pos;
+
 private:
   /** this is only here for internal collision detection use (don't touch this
       from outside collision detection code)
@@ -17,6 +17,9 @@
 
 #include "collision/collision_system.hpp"
 
+#include <algorithm>
+#include <math.h>
+
 #include "collision/collision.hpp"
 #include "editor/editor.hpp"
 #include "math/aatriangle.hpp"
@@ -26,6 +29,7 @@
 #include "supertux/constants.hpp"
 #include "supertux/sector.hpp"
 #include "supertux/tile.hpp"
+#include "util/profiler.hpp"
 #include "video/color.hpp"
 #include "video/drawing_context.hpp"
 
@@ -36,26 +40,253 @@ const float MAX_SPEED = 16.0f;
 // a small value... be careful as CD is very sensitive to it
 const float DELTA = .002f;
 
+// objects closer than this to something that moved aren't put to sleep
+const float WAKE_DISTANCE = 32.0f;
+
 } // namespace
 
 CollisionSystem::CollisionSystem(Sector& sector) :
   m_sector(sector),
-  m_objects()
+  m_groups(),
+  m_unsorted(),
+  m_next_sequence(0),
+  m_tree(),
+  m_statics(),
+  m_touchables(),
+  m_movers(),
+  m_active(),
+  m_tilemap_signature(0),
+  m_static_grid(),
+  m_touchable_grid(),
+  m_moving_grid(),
+  m_touchable_boxes(),
+  m_contacts(),
+  m_contact_index(),
+  m_frame(0),
+  m_static_candidates(),
+  m_candidates(),
+  m_hits(),
+  m_interpolated_positions()
 {
 }
 
 void
 CollisionSystem::add(CollisionObject* object)
 {
-  m_objects.push_back(object);
+  assert(object->m_system == nullptr);
+
+  object->m_system = this;
+  object->m_sequence = m_next_sequence++;
+  object->m_previous_pos = object->get_pos();
+  object->m_tree_proxy = m_tree.insert(object, object->get_bbox());
+  link(*object);
+  wake_nearby(object->get_bbox());
 }
 
 void
 CollisionSystem::remove(CollisionObject* object)
 {
-  m_objects.erase(
-    std::find(m_objects.begin(), m_objects.end(),
-              object));
+  assert(object->m_system == this);
+
+  unlink(*object, object->get_group());
+  remove_contacts(*object);
+  m_tree.remove(object->m_tree_proxy);
+  object->m_tree_proxy = -1;
+  object->m_system = nullptr;
+  wake_nearby(object->get_bbox());
+}
+
+void
+CollisionSystem::bbox_changed(CollisionObject& object)
+{
+  m_tree.move(object.m_tree_proxy, object.get_bbox());
+  wake_nearby(object.get_bbox());
+}
+
+void
+CollisionSystem::refit_tree()
+{
+  for (const auto& list : m_groups) {
+    for (const auto& object : list) {
+      m_tree.move(object->m_tree_proxy, object->get_bbox());
+    }
+  }
+}
+
+void
+CollisionSystem::group_changed(CollisionObject& object, CollisionGroup old_group)
+{
+  unlink(object, old_group);
+  link(object);
+  wake_nearby(object.get_bbox());
+}
+
+void
+CollisionSystem::wake_nearby(const Rectf& rect)
+{
+  const Rectf area = rect.grown(WAKE_DISTANCE);
+  m_tree.query(area, [&area](CollisionObject* object) {
+      if (collision::intersects(area, object->get_bbox())) {
+        object->wake_up();
+      }
+      return true;
+    });
+}
+
+void
+CollisionSystem::wake_sleepers()
+{
+  // a moving or changed tilemap can touch anything
+  bool tiles_changed = false;
+  size_t signature = 0;
+  for (const auto& solids : m_sector.get_solid_tilemaps()) {
+    signature = signature * 31 + reinterpret_cast<uintptr_t>(solids) + solids->get_revision();
+    if (solids->get_movement(true) != Vector(0, 0)) {
+      tiles_changed = true;
+    }
+  }
+
+  if (tiles_changed || signature != m_tilemap_signature)
+  {
+    m_tilemap_signature = signature;
+    for (const auto& solids : m_sector.get_solid_tilemaps()) {
+      solids->clear_dirty_region();
+    }
+    for (const auto& list : m_groups) {
+      for (const auto& object : list) {
+        object->wake_up();
+      }
+    }
+    return;
+  }
+
+  // changed tiles only wake up their neighbourhood
+  for (const auto& solids : m_sector.get_solid_tilemaps())
+  {
+    const Rect& dirty = solids->get_dirty_region();
+    if (dirty.empty())
+      continue;
+
+    wake_nearby(Rectf(solids->get_tile_position(dirty.left, dirty.top),
+                      solids->get_tile_position(dirty.right, dirty.bottom)));
+    solids->clear_dirty_region();
+  }
+
+  for (const auto& object : m_active)
+  {
+    const Rectf& bbox = object->get_bbox();
+    const Rectf& dest = object->m_dest;
+    wake_nearby(Rectf(std::min(bbox.get_left(), dest.get_left()),
+                      std::min(bbox.get_top(), dest.get_top()),
+                      std::max(bbox.get_right(), dest.get_right()),
+                      std::max(bbox.get_bottom(), dest.get_bottom())));
+  }
+}
+
+void
+CollisionSystem::link(CollisionObject& object)
+{
+  auto& list = m_groups[object.get_group()];
+
+  // new objects stay in order, objects changing groups usually don't
+  if (!list.empty() && list.back()->m_sequence > object.m_sequence) {
+    m_unsorted[object.get_group()] = true;
+  }
+
+  object.m_group_index = list.size();
+  list.push_back(&object);
+}
+
+void
+CollisionSystem::unlink(CollisionObject& object, CollisionGroup group)
+{
+  auto& list = m_groups[group];
+  assert(object.m_group_index < list.size() && list[object.m_group_index] == &object);
+
+  if (object.m_group_index + 1 < list.size()) {
+    list[object.m_group_index] = list.back();
+    list[object.m_group_index]->m_group_index = object.m_group_index;
+    m_unsorted[group] = true;
+  }
+  list.pop_back();
+}
+
+void
+CollisionSystem::sort_group(CollisionGroup group)
+{
+  if (!m_unsorted[group])
+    return;
+
+  auto& list = m_groups[group];
+  std::sort(list.begin(), list.end(),
+            [](const CollisionObject* lhs, const CollisionObject* rhs) {
+              return lhs->m_sequence < rhs->m_sequence;
+            });
+  for (size_t i = 0; i < list.size(); ++i) {
+    list[i]->m_group_index = i;
+  }
+  m_unsorted[group] = false;
+}
+
+void
+CollisionSystem::collect(ObjectList& out, std::initializer_list<CollisionGroup> groups)
+{
+  out.clear();
+  for (const auto& group : groups)
+  {
+    sort_group(group);
+    const size_t middle = out.size();
+    out.insert(out.end(), m_groups[group].begin(), m_groups[group].end());
+    std::inplace_merge(out.begin(), out.begin() + middle, out.end(),
+                       [](const CollisionObject* lhs, const CollisionObject* rhs) {
+                         return lhs->m_sequence < rhs->m_sequence;
+                       });
+  }
+}
+
+void
+CollisionSystem::store_previous_positions()
+{
+  for (const auto& group : m_groups) {
+    for (CollisionObject* object : group) {
+      object->m_previous_pos = object->m_bbox.p1();
+    }
+  }
+}
+
+void
+CollisionSystem::begin_interpolation(float alpha)
+{
+  // anything moving further than this in one step got teleported
+  const float MAX_DISTANCE = 128.0f;
+
+  assert(m_interpolated_positions.empty());
+  for (const auto& group : m_groups) {
+    for (CollisionObject* object : group)
+    {
+      const Vector pos = object->m_bbox.p1();
+      m_interpolated_positions.push_back(pos);
+
+      const Vector delta = pos - object->m_previous_pos;
+      if (fabsf(delta.x) < MAX_DISTANCE && fabsf(delta.y) < MAX_DISTANCE) {
+        // the bbox is restored before anything can query the tree
+        object->m_bbox.set_pos(object->m_previous_pos + delta * alpha);
+      }
+    }
+  }
+}
+
+void
+CollisionSystem::end_interpolation()
+{
+  size_t i = 0;
+  for (const auto& group : m_groups) {
+    for (CollisionObject* object : group) {
+      object->m_bbox.set_pos(m_interpolated_positions[i++]);
+    }
+  }
+  assert(i == m_interpolated_positions.size());
+  m_interpolated_positions.clear();
 }
 
 void
@@ -67,29 +298,34 @@ CollisionSystem::draw(DrawingContext& context)
   const Color cyan(0.0f, 1.0f, 1.0f, 0.75f);
   const Color orange(1.0f, 0.5f, 0.0f, 0.75f);
   const Color green_bright(0.7f, 1.0f, 0.7f, 0.75f);
-  for (auto& object : m_objects) {
-    Color color;
-    switch (object->get_group()) {
-    case COLGROUP_MOVING_STATIC:
-      color = violet;
-      break;
-    case COLGROUP_MOVING:
-      color = red;
-      break;
-    case COLGROUP_MOVING_ONLY_STATIC:
-      color = red_bright;
-      break;
-    case COLGROUP_STATIC:
-      color = cyan;
-      break;
-    case COLGROUP_TOUCHABLE:
-      color = orange;
-      break;
-    default:
-      color = green_bright;
+  for (const auto& list : m_groups) {
+    for (auto& object : list) {
+      Color color;
+      switch (object->get_group()) {
+      case COLGROUP_MOVING_STATIC:
+        color = violet;
+        break;
+      case COLGROUP_MOVING:
+        color = red;
+        break;
+      case COLGROUP_MOVING_ONLY_STATIC:
+        color = red_bright;
+        break;
+      case COLGROUP_STATIC:
+        color = cyan;
+        break;
+      case COLGROUP_TOUCHABLE:
+        color = orange;
+        break;
+      default:
+        color = green_bright;
+      }
+      if (object->is_sleeping()) {
+        color.alpha = 0.25f;
+      }
+      const Rectf& rect = object->get_bbox();
+      context.color().draw_filled_rect(rect, color, LAYER_FOREGROUND1 + 10);
     }
-    const Rectf& rect = object->get_bbox();
-    context.color().draw_filled_rect(rect, color, LAYER_FOREGROUND1 + 10);
   }
 }
 
@@ -183,35 +419,33 @@ CollisionSystem::collision_tilemap(collision::Constraints* constraints,
 
   for (const auto& solids : m_sector.get_solid_tilemaps())
   {
+    if (!solids->may_overlap(dest))
+      continue;
+
+    const TileAttributePlane& plane = solids->get_attribute_plane();
+
     // test with all tiles in this rectangle
     const Rect test_tiles = solids->get_tiles_overlapping(Rectf(x1, y1, x2, y2));
 
-    for (int x = test_tiles.left; x < test_tiles.right; ++x)
-    {
-      for (int y = test_tiles.top; y < test_tiles.bottom; ++y)
-      {
-        const Tile& tile = solids->get_tile(x, y);
-
-        // skip non-solid tiles
-        if (!tile.is_solid ())
-          continue;
+    // non-solid tiles are skipped by the plane
+    plane.for_each_solid(test_tiles, [&](int x, int y) {
         Rectf tile_bbox = solids->get_tile_bbox(x, y);
 
-        /* If the tile is a unisolid tile, the "is_solid()" function above
-         * didn't do a thorough check. Calculate the position and (relative)
+        /* If the tile is a unisolid tile, the plane didn't do a
+         * thorough check. Calculate the position and (relative)
          * movement of the object and determine whether or not the tile is
          * solid with regard to those parameters. */
-        if (tile.is_unisolid ()) {
+        if (plane.is_unisolid(x, y)) {
           Vector relative_movement = movement
             - solids->get_movement(/* actual = */ true);
 
-          if (!tile.is_solid (tile_bbox, object.get_bbox(), relative_movement))
-            continue;
+          if (!solids->get_tile(x, y).is_solid (tile_bbox, object.get_bbox(), relative_movement))
+            return true;
         }
 
-        if (tile.is_slope ()) { // slope tile
+        if (plane.is_slope(x, y)) { // slope tile
           AATriangle triangle;
-          int slope_data = tile.get_data();
+          int slope_data = plane.get_slope_data(x, y);
           if (solids->get_flip() & VERTICAL_FLIP)
             slope_data = AATriangle::vertical_flip(slope_data);
           triangle = AATriangle(tile_bbox, slope_data);
@@ -222,8 +456,8 @@ CollisionSystem::collision_tilemap(collision::Constraints* constraints,
           check_collisions(constraints, movement, dest, tile_bbox, nullptr, nullptr,
               solids->get_movement(/* actual = */ false));
         }
-      }
-    }
+        return true;
+      });
   }
 }
 
@@ -238,6 +472,9 @@ CollisionSystem::collision_tile_attributes(const Rectf& dest, const Vector& mov)
   uint32_t result = 0;
   for (auto& solids: m_sector.get_solid_tilemaps())
   {
+    if (!solids->may_overlap(Rectf(x1, y1, x2, y2 + SHIFT_DELTA)))
+      continue;
+
     // test with all tiles in this rectangle
     const Rect test_tiles = solids->get_tiles_overlapping(Rectf(x1, y1, x2, y2));
 
@@ -297,7 +534,7 @@ static void get_hit_normal(const Rectf& r1, const Rectf& r2, CollisionHit& hit,
 }
 
 void
-CollisionSystem::collision_object(CollisionObject* object1, CollisionObject* object2) const
+CollisionSystem::collision_object(CollisionObject* object1, CollisionObject* object2)
 {
   using namespace collision;
 
@@ -318,6 +555,8 @@ CollisionSystem::collision_object(CollisionObject* object1, CollisionObject* obj
     std::swap(hit.left, hit.right);
     std::swap(hit.top, hit.bottom);
 
+    touch(*object1, *object2);
+
     HitResponse response1 = object1->collision(*object2, hit);
     std::swap(hit.left, hit.right);
     std::swap(hit.top, hit.bottom);
@@ -343,9 +582,12 @@ CollisionSystem::collision_static(collision::Constraints* constraints,
 {
   collision_tilemap(constraints, movement, dest, object);
 
-  // collision with other (static) objects
-  for (auto& static_object : m_objects)
+  // collision with other (static) objects, the grid only narrows down
+  // the candidates, they are still visited in list order
+  m_static_grid.query(dest, m_static_candidates);
+  for (const auto& index : m_static_candidates)
   {
+    CollisionObject* static_object = m_statics[index];
     if (static_object->get_group() != COLGROUP_STATIC &&
         static_object->get_group() != COLGROUP_MOVING_STATIC)
       continue;
@@ -478,9 +720,69 @@ CollisionSystem::collision_static_constrains(CollisionObject& object)
   }
 }
 
+float
+CollisionSystem::sweep_static(CollisionObject& object)
+{
+  const Rectf& bbox = object.get_bbox();
+  const Vector movement = object.get_movement();
+  const Rectf dest = bbox.moved(movement);
+  const Rectf swept(std::min(bbox.get_left(), dest.get_left()),
+                    std::min(bbox.get_top(), dest.get_top()),
+                    std::max(bbox.get_right(), dest.get_right()),
+                    std::max(bbox.get_bottom(), dest.get_bottom()));
+
+  float toi = 1.0f;
+  float time;
+
+  for (const auto& solids : m_sector.get_solid_tilemaps())
+  {
+    if (!solids->may_overlap(swept))
+      continue;
+
+    const TileAttributePlane& plane = solids->get_attribute_plane();
+    const Vector relative_movement = movement - solids->get_movement(/* actual = */ true);
+
+    // slopes are swept as full tiles, the regular solver then slides
+    // the object onto the actual slope
+    plane.for_each_solid(solids->get_tiles_overlapping(swept), [&](int x, int y) {
+        const Rectf tile_bbox = solids->get_tile_bbox(x, y);
+        if (plane.is_unisolid(x, y) &&
+            !solids->get_tile(x, y).is_solid(tile_bbox, bbox, relative_movement))
+          return true;
+
+        if (collision::sweep(bbox, relative_movement, tile_bbox, time)) {
+          toi = std::min(toi, time);
+        }
+        return true;
+      });
+  }
+
+  m_static_grid.query(swept, m_static_candidates);
+  for (const auto& index : m_static_candidates)
+  {
+    CollisionObject* static_object = m_statics[index];
+    if (static_object == &object || !static_object->is_valid())
+      continue;
+    if (static_object->get_group() != COLGROUP_STATIC &&
+        static_object->get_group() != COLGROUP_MOVING_STATIC)
+      continue;
+
+    if (collision::sweep(bbox, movement - static_object->get_movement(), static_object->m_bbox, time)) {
+      toi = std::min(toi, time);
+    }
+  }
+
+  return toi;
+}
+
 void
 CollisionSystem::update()
 {
+  Profiler::Scope profile_scope("collision");
+
+  // catch up with objects that modified m_bbox directly
+  refit_tree();
+
   if (Editor::is_active()) {
     return;
     //Oběcts in editor shouldn't collide.
@@ -488,40 +790,87 @@ CollisionSystem::update()
 
   using namespace collision;
 
+  // objects removed or regrouped since the last update
+  for (int group = 0; group < NUM_GROUPS; ++group) {
+    sort_group(static_cast<CollisionGroup>(group));
+  }
+
   // calculate destination positions of the objects
-  for (const auto& object : m_objects)
-  {
-    const Vector mov = object->get_movement();
+  m_active.clear();
+  for (const auto& list : m_groups) {
+    for (const auto& object : list)
+    {
+      const Vector mov = object->get_movement();
+
+      // m_dest still holds the bbox applied last frame, unless the
+      // object was moved from the outside since then
+      if (mov != Vector(0, 0) || !(object->m_dest == object->get_bbox())) {
+        object->wake_up();
+        m_active.push_back(object);
+      } else if (!object->is_sleeping()) {
+        object->m_rest_frames += 1;
+      }
 
-    // make sure movement is never faster than MAX_SPEED. Norm is pretty fat, so two addl. checks are done before.
-    if (((mov.x > MAX_SPEED * static_cast<float>(M_SQRT1_2)) || (mov.y > MAX_SPEED * static_cast<float>(M_SQRT1_2))) && (mov.norm() > MAX_SPEED)) {
-      object->m_movement = mov.unit() * MAX_SPEED;
-      //log_debug << "Temporarily reduced object's speed of " << mov.norm() << " to " << object->movement.norm() << "." << std::endl;
-    }
+      // make sure movement is never faster than MAX_SPEED. Norm is pretty fat, so two addl. checks are done before.
+      // Continuous objects are swept in part1 instead.
+      if (!object->is_continuous() && ((mov.x > MAX_SPEED * static_cast<float>(M_SQRT1_2)) || (mov.y > MAX_SPEED * static_cast<float>(M_SQRT1_2))) && (mov.norm() > MAX_SPEED)) {
+        object->m_movement = mov.unit() * MAX_SPEED;
+        //log_debug << "Temporarily reduced object's speed of " << mov.norm() << " to " << object->movement.norm() << "." << std::endl;
+      }
 
-    object->m_dest = object->get_bbox();
-    object->m_dest.move(object->get_movement());
+      object->m_dest = object->get_bbox();
+      object->m_dest.move(object->get_movement());
+    }
   }
 
+  wake_sleepers();
+
   // part1: COLGROUP_MOVING vs COLGROUP_STATIC and tilemap
-  for (const auto& object : m_objects) {
+  collect(m_statics, { COLGROUP_STATIC, COLGROUP_MOVING_STATIC });
+  fill_grid(m_static_grid, m_statics, false);
+  collect(m_movers, { COLGROUP_MOVING_STATIC, COLGROUP_MOVING, COLGROUP_MOVING_ONLY_STATIC });
+  for (const auto& object : m_movers) {
     if ((object->get_group() != COLGROUP_MOVING
         && object->get_group() != COLGROUP_MOVING_STATIC
         && object->get_group() != COLGROUP_MOVING_ONLY_STATIC)
        || !object->is_valid())
       continue;
 
+    // nothing moved close to resting objects, so nothing can happen to them
+    if (object->is_sleeping())
+      continue;
+
+    // move fast continuous objects up to their first contact, the
+    // regular solver resolves the contact with the remaining movement
+    const Vector mov = object->get_movement();
+    if (object->is_continuous() && mov.norm() > MAX_SPEED) {
+      const float toi = sweep_static(*object);
+      if (toi < 1.0f) {
+        const Vector advance = mov * std::max(0.0f, toi - DELTA / mov.norm());
+        Vector remaining = mov - advance;
+        if (remaining.norm() > MAX_SPEED) {
+          remaining = remaining.unit() * MAX_SPEED;
+        }
+        object->m_movement = remaining;
+        object->m_dest = object->get_bbox().moved(advance + remaining);
+      }
+    }
+
     collision_static_constrains(*object);
   }
 
   // part2: COLGROUP_MOVING vs tile attributes
-  for (const auto& object : m_objects) {
+  collect(m_movers, { COLGROUP_MOVING_STATIC, COLGROUP_MOVING, COLGROUP_MOVING_ONLY_STATIC });
+  for (const auto& object : m_movers) {
     if ((object->get_group() != COLGROUP_MOVING
         && object->get_group() != COLGROUP_MOVING_STATIC
         && object->get_group() != COLGROUP_MOVING_ONLY_STATIC)
        || !object->is_valid())
       continue;
 
+    if (object->is_sleeping())
+      continue;
+
     uint32_t tile_attributes = collision_tile_attributes(object->m_dest, object->get_movement());
     if (tile_attributes >= Tile::FIRST_INTERESTING_FLAG) {
       object->collision_tile(tile_attributes);
@@ -529,14 +878,23 @@ CollisionSystem::update()
   }
 
   // part2.5: COLGROUP_MOVING vs COLGROUP_TOUCHABLE
-  for (const auto& object : m_objects)
+  collect(m_touchables, { COLGROUP_TOUCHABLE });
+  fill_grid(m_touchable_grid, m_touchables, true);
+  fill_boxes(m_touchable_boxes, m_touchables);
+  collect(m_movers, { COLGROUP_MOVING_STATIC, COLGROUP_MOVING });
+  for (const auto& object : m_movers)
   {
     if ((object->get_group() != COLGROUP_MOVING
         && object->get_group() != COLGROUP_MOVING_STATIC)
        || !object->is_valid())
       continue;
 
-    for (auto& object_2 : m_objects) {
+    Rectf queried = object->m_dest;
+    m_touchable_grid.query(queried, m_candidates);
+    m_touchable_boxes.filter(queried, m_candidates, m_hits);
+    for (size_t c = 0; c < m_hits.size(); ++c) {
+      const size_t index_2 = m_hits[c];
+      auto object_2 = m_touchables[index_2];
       if (object_2->get_group() != COLGROUP_TOUCHABLE
          || !object_2->is_valid())
         continue;
@@ -551,37 +909,187 @@ CollisionSystem::update()
         if (!object_2->collides(*object, hit))
           continue;
 
+        touch(*object, *object_2);
+
         object->collision(*object_2, hit);
         object_2->collision(*object, hit);
+
+        // collision handlers are free to move either object
+        m_touchable_grid.update(index_2, object_2->m_dest);
+        m_touchable_boxes.set(index_2, object_2->m_dest);
+        if (!(object->m_dest == queried)) {
+          queried = object->m_dest;
+          m_touchable_grid.query(queried, m_candidates);
+          m_touchable_boxes.filter(queried, m_candidates, m_hits);
+          c = std::upper_bound(m_hits.begin(), m_hits.end(), index_2) - m_hits.begin() - 1;
+        }
       }
     }
   }
 
   // part3: COLGROUP_MOVING vs COLGROUP_MOVING
-  for (auto i = m_objects.begin(); i != m_objects.end(); ++i)
+  collect(m_movers, { COLGROUP_MOVING_STATIC, COLGROUP_MOVING });
+  fill_grid(m_moving_grid, m_movers, true);
+  for (size_t i = 0; i < m_movers.size(); ++i)
   {
-    auto object = *i;
+    auto object = m_movers[i];
 
     if ((object->get_group() != COLGROUP_MOVING
         && object->get_group() != COLGROUP_MOVING_STATIC)
        || !object->is_valid())
       continue;
 
-    for (auto i2 = i+1; i2 != m_objects.end(); ++i2) {
-      auto object_2 = *i2;
+    // only pairs with a later object are tested, as in a plain i < j scan
+    Rectf queried = object->m_dest;
+    m_moving_grid.query(queried, m_candidates);
+    for (auto c = std::upper_bound(m_candidates.begin(), m_candidates.end(), i) - m_candidates.begin();
+         c < static_cast<ptrdiff_t>(m_candidates.size()); ++c) {
+      const size_t index_2 = m_candidates[c];
+      auto object_2 = m_movers[index_2];
       if ((object_2->get_group() != COLGROUP_MOVING
           && object_2->get_group() != COLGROUP_MOVING_STATIC)
          || !object_2->is_valid())
         continue;
 
       collision_object(object, object_2);
+
+      // collision response pushes objects apart, keep the grid in sync
+      m_moving_grid.update(index_2, object_2->m_dest);
+      if (!(object->m_dest == queried)) {
+        queried = object->m_dest;
+        m_moving_grid.update(i, queried);
+        m_moving_grid.query(queried, m_candidates);
+        c = std::upper_bound(m_candidates.begin(), m_candidates.end(), index_2) - m_candidates.begin() - 1;
+      }
     }
   }
 
   // apply object movement
-  for (const auto& object : m_objects) {
-    object->m_bbox = object->m_dest;
-    object->m_movement = Vector(0, 0);
+  for (const auto& list : m_groups) {
+    for (const auto& object : list) {
+      object->m_bbox = object->m_dest;
+      object->m_movement = Vector(0, 0);
+    }
+  }
+
+  refit_tree();
+
+  expire_contacts();
+  m_frame += 1;
+}
+
+CollisionSystem::ContactKey
+CollisionSystem::make_contact_key(const CollisionObject& lhs, const CollisionObject& rhs)
+{
+  if (std::less<const CollisionObject*>()(&lhs, &rhs)) {
+    return ContactKey(&lhs, &rhs);
+  } else {
+    return ContactKey(&rhs, &lhs);
+  }
+}
+
+void
+CollisionSystem::touch(CollisionObject& object1, CollisionObject& object2)
+{
+  const auto it = m_contact_index.find(make_contact_key(object1, object2));
+  if (it != m_contact_index.end())
+  {
+    m_contacts[it->second].frame = m_frame;
+    return;
+  }
+
+  m_contact_index[make_contact_key(object1, object2)] = m_contacts.size();
+  m_contacts.push_back({ &object1, &object2, m_frame });
+
+  object1.collision_begin(object2);
+  object2.collision_begin(object1);
+}
+
+void
+CollisionSystem::expire_contacts()
+{
+  bool expired = false;
+  for (const auto& contact : m_contacts)
+  {
+    if (contact.frame == m_frame)
+      continue;
+
+    expired = true;
+    if (contact.first->is_valid() && contact.second->is_valid()) {
+      contact.first->collision_end(*contact.second);
+      contact.second->collision_end(*contact.first);
+    }
+  }
+
+  if (!expired)
+    return;
+
+  const uint32_t frame = m_frame;
+  m_contacts.erase(std::remove_if(m_contacts.begin(), m_contacts.end(),
+                                  [frame](const Contact& contact) {
+                                    return contact.frame != frame;
+                                  }),
+                   m_contacts.end());
+
+  rebuild_contact_index();
+}
+
+void
+CollisionSystem::remove_contacts(const CollisionObject& object)
+{
+  const auto size = m_contacts.size();
+  m_contacts.erase(std::remove_if(m_contacts.begin(), m_contacts.end(),
+                                  [&object](const Contact& contact) {
+                                    return contact.first == &object || contact.second == &object;
+                                  }),
+                   m_contacts.end());
+
+  if (m_contacts.size() == size)
+    return;
+
+  rebuild_contact_index();
+}
+
+void
+CollisionSystem::rebuild_contact_index()
+{
+  m_contact_index.clear();
+  for (size_t i = 0; i < m_contacts.size(); ++i) {
+    m_contact_index[make_contact_key(*m_contacts[i].first, *m_contacts[i].second)] = i;
+  }
+}
+
+bool
+CollisionSystem::is_touching(const CollisionObject& lhs, const CollisionObject& rhs) const
+{
+  return m_contact_index.find(make_contact_key(lhs, rhs)) != m_contact_index.end();
+}
+
+void
+CollisionSystem::fill_grid(CollisionGrid& grid, const ObjectList& objects, bool use_dest) const
+{
+  grid.clear();
+  for (size_t i = 0; i < objects.size(); ++i)
+  {
+    const auto& object = objects[i];
+    if (!object->is_valid())
+      continue;
+
+    grid.insert(i, use_dest ? object->m_dest : object->m_bbox);
+  }
+}
+
+void
+CollisionSystem::fill_boxes(BBoxArray& boxes, const ObjectList& objects) const
+{
+  boxes.reset(objects.size());
+  for (size_t i = 0; i < objects.size(); ++i)
+  {
+    const auto& object = objects[i];
+    if (!object->is_valid())
+      continue;
+
+    boxes.set(i, object->m_dest);
   }
 }
 
@@ -591,29 +1099,34 @@ CollisionSystem::is_free_of_tiles(const Rectf& rect, const bool ignoreUnisolid)
   using namespace collision;
 
   for (const auto& solids : m_sector.get_solid_tilemaps()) {
+    if (!solids->may_overlap(rect))
+      continue;
+
+    const TileAttributePlane& plane = solids->get_attribute_plane();
+
     // test with all tiles in this rectangle
     const Rect test_tiles = solids->get_tiles_overlapping(rect);
 
-    for (int x = test_tiles.left; x < test_tiles.right; ++x) {
-      for (int y = test_tiles.top; y < test_tiles.bottom; ++y) {
-        const Tile& tile = solids->get_tile(x, y);
+    // plain solid tiles don't need a closer look
+    if (plane.any_fully_solid(test_tiles))
+      return false;
 
-        if (!(tile.get_attributes() & Tile::SOLID))
-          continue;
-        if (tile.is_unisolid () && ignoreUnisolid)
-          continue;
-        if (tile.is_slope ()) {
+    const bool free = plane.for_each_solid(test_tiles, [&](int x, int y) {
+        if (plane.is_unisolid(x, y) && ignoreUnisolid)
+          return true;
+        if (plane.is_slope(x, y)) {
           AATriangle triangle;
           const Rectf tbbox = solids->get_tile_bbox(x, y);
-          triangle = AATriangle(tbbox, tile.get_data());
+          triangle = AATriangle(tbbox, plane.get_slope_data(x, y));
           Constraints constraints;
           if (!collision::rectangle_aatriangle(&constraints, rect, triangle))
-            continue;
+            return true;
         }
         // We have a solid tile that overlaps the given rectangle.
         return false;
-      }
-    }
+      });
+    if (!free)
+      return false;
   }
 
   return true;
@@ -626,15 +1139,18 @@ CollisionSystem::is_free_of_statics(const Rectf& rect, const CollisionObject* ig
 
   if (!is_free_of_tiles(rect, ignoreUnisolid)) return false;
 
-  for (const auto& object : m_objects) {
-    if (object == ignore_object) continue;
-    if (!object->is_valid()) continue;
-    if (object->get_group() == COLGROUP_STATIC) {
-      if (intersects(rect, object->get_bbox())) return false;
-    }
-  }
+  bool result = true;
+  m_tree.query(rect, [&](CollisionObject* object) {
+      if (object == ignore_object) return true;
+      if (!object->is_valid()) return true;
+      if (object->get_group() == COLGROUP_STATIC &&
+          intersects(rect, object->get_bbox())) {
+        result = false;
+      }
+      return result;
+    });
 
-  return true;
+  return result;
 }
 
 bool
@@ -644,17 +1160,20 @@ CollisionSystem::is_free_of_movingstatics(const Rectf& rect, const CollisionObje
 
   if (!is_free_of_tiles(rect)) return false;
 
-  for (const auto& object : m_objects) {
-    if (object == ignore_object) continue;
-    if (!object->is_valid()) continue;
-    if ((object->get_group() == COLGROUP_MOVING)
-        || (object->get_group() == COLGROUP_MOVING_STATIC)
-        || (object->get_group() == COLGROUP_STATIC)) {
-      if (intersects(rect, object->get_bbox())) return false;
-    }
-  }
+  bool result = true;
+  m_tree.query(rect, [&](CollisionObject* object) {
+      if (object == ignore_object) return true;
+      if (!object->is_valid()) return true;
+      if ((object->get_group() == COLGROUP_MOVING
+           || object->get_group() == COLGROUP_MOVING_STATIC
+           || object->get_group() == COLGROUP_STATIC) &&
+          intersects(rect, object->get_bbox())) {
+        result = false;
+      }
+      return result;
+    });
 
-  return true;
+  return result;
 }
 
 bool
@@ -679,17 +1198,20 @@ CollisionSystem::free_line_of_sight(const Vector& line_start, const Vector& line
   }
 
   // check if no object is in the way
-  for (const auto& object : m_objects) {
-    if (object == ignore_object) continue;
-    if (!object->is_valid()) continue;
-    if ((object->get_group() == COLGROUP_MOVING)
-        || (object->get_group() == COLGROUP_MOVING_STATIC)
-        || (object->get_group() == COLGROUP_STATIC)) {
-      if (intersects_line(object->get_bbox(), line_start, line_end)) return false;
-    }
-  }
+  bool result = true;
+  m_tree.raycast(line_start, line_end, [&](CollisionObject* object) {
+      if (object == ignore_object) return true;
+      if (!object->is_valid()) return true;
+      if ((object->get_group() == COLGROUP_MOVING
+           || object->get_group() == COLGROUP_MOVING_STATIC
+           || object->get_group() == COLGROUP_STATIC) &&
+          intersects_line(object->get_bbox(), line_start, line_end)) {
+        result = false;
+      }
+      return result;
+    });
 
-  return true;
+  return result;
 }
 
 std::vector<CollisionObject*>
@@ -697,11 +1219,15 @@ CollisionSystem::get_nearby_objects (const Vector& center, float max_distance) c
 {
   std::vector<CollisionObject*> ret;
 
-  for (const auto& object : m_objects) {
-    float distance = object->get_bbox().distance(center);
-    if (distance <= max_distance)
-      ret.push_back(object);
-  }
+  // the middle of every matching bbox lies within this square
+  const Rectf area(center - Vector(max_distance, max_distance),
+                   center + Vector(max_distance, max_distance));
+  m_tree.query(area, [&](CollisionObject* object) {
+      float distance = object->get_bbox().distance(center);
+      if (distance <= max_distance)
+        ret.push_back(object);
+      return true;
+    });
 
   return ret;
 }
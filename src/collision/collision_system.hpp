@@ -18,10 +18,18 @@
 #ifndef HEADER_SUPERTUX_COLLISION_COLLISION_SYSTEM_HPP
 #define HEADER_SUPERTUX_COLLISION_COLLISION_SYSTEM_HPP
 
+#include <array>
+#include <initializer_list>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 #include <stdint.h>
 
+#include "collision/aabb_tree.hpp"
+#include "collision/bbox_array.hpp"
 #include "collision/collision.hpp"
+#include "collision/collision_grid.hpp"
+#include "collision/collision_group.hpp"
 
 class CollisionObject;
 class DrawingContext;
@@ -31,15 +39,38 @@ class Vector;
 
 class CollisionSystem final
 {
+public:
+  /** Number of frames an object has to be at rest before it is put
+      to sleep, see CollisionObject::is_sleeping() */
+  static const int SLEEP_FRAMES = 30;
+
 public:
   CollisionSystem(Sector& sector);
 
   void add(CollisionObject* object);
   void remove(CollisionObject* object);
 
+  /** Moves the object to the list of its new group, called by
+      CollisionObject::set_group() */
+  void group_changed(CollisionObject& object, CollisionGroup old_group);
+
+  /** Updates the query tree after the bbox of the object was changed
+      outside of update(), called by CollisionObject::set_pos() and friends */
+  void bbox_changed(CollisionObject& object);
+
   /** Draw collision shapes for debugging */
   void draw(DrawingContext& context);
 
+  /** Remembers the current positions for interpolated drawing, called
+      at the start of each logic step */
+  void store_previous_positions();
+
+  /** Moves every object alpha of the way from its previous to its
+      current position, so drawing can happen in between logic steps.
+      end_interpolation() has to be called before the next update(). */
+  void begin_interpolation(float alpha);
+  void end_interpolation();
+
   /** Checks for all possible collisions. And calls the
       collision_handlers, which the collision_objects provide for this
       case (or not). */
@@ -50,8 +81,39 @@ public:
   bool is_free_of_movingstatics(const Rectf& rect, const CollisionObject* ignore_object) const;
   bool free_line_of_sight(const Vector& line_start, const Vector& line_end, const CollisionObject* ignore_object) const;
 
+  /** Returns true if the two objects exchanged collision() callbacks
+      in the last update() */
+  bool is_touching(const CollisionObject& lhs, const CollisionObject& rhs) const;
+
+  /** Returns all objects whose bbox middle is within max_distance of center */
   std::vector<CollisionObject*> get_nearby_objects(const Vector& center, float max_distance) const;
 
+private:
+  typedef std::vector<CollisionObject*> ObjectList;
+
+  static const int NUM_GROUPS = COLGROUP_TOUCHABLE + 1;
+
+  /** A pair of objects that touched each other */
+  struct Contact
+  {
+    CollisionObject* first;
+    CollisionObject* second;
+
+    /** The last frame the pair was touching */
+    uint32_t frame;
+  };
+
+  typedef std::pair<const CollisionObject*, const CollisionObject*> ContactKey;
+
+  struct ContactKeyHash
+  {
+    size_t operator()(const ContactKey& key) const
+    {
+      return std::hash<const CollisionObject*>()(key.first) * 31 +
+        std::hash<const CollisionObject*>()(key.second);
+    }
+  };
+
 private:
   /** Does collision detection of an object against all other static
       objects (and the tilemap) in the level. Collision response is
@@ -71,13 +133,116 @@ private:
 
   uint32_t collision_tile_attributes(const Rectf& dest, const Vector& mov) const;
 
-  void collision_object(CollisionObject* object1, CollisionObject* object2) const;
+  void collision_object(CollisionObject* object1, CollisionObject* object2);
+
+  /** Records that the two objects are touching this frame, calls
+      collision_begin() on both if they weren't touching before */
+  void touch(CollisionObject& object1, CollisionObject& object2);
+
+  /** Calls collision_end() for and forgets about all pairs that
+      didn't touch this frame */
+  void expire_contacts();
+
+  /** Forgets about all pairs the object is part of, without events */
+  void remove_contacts(const CollisionObject& object);
+
+  void rebuild_contact_index();
+
+  static ContactKey make_contact_key(const CollisionObject& lhs, const CollisionObject& rhs);
 
   void collision_static_constrains(CollisionObject& object);
 
+  /** Sweeps the whole movement of a continuous object against solid
+      tiles and static objects in one pass and returns the earliest
+      time of impact as a fraction of the movement, or 1 */
+  float sweep_static(CollisionObject& object);
+
+  /** Appends the object to the list of its group */
+  void link(CollisionObject& object);
+
+  /** Removes the object from the given group list by moving the last
+      object into its place */
+  void unlink(CollisionObject& object, CollisionGroup group);
+
+  /** Restores the registration order of a group list that link() or
+      unlink() left out of order */
+  void sort_group(CollisionGroup group);
+
+  /** Fills out with the objects of the given groups, merged in the
+      order they were added, like the single object list in front of
+      the partitioning. The passes in update() iterate over such
+      snapshots, so collision handlers can change groups without
+      invalidating the iteration. */
+  void collect(ObjectList& out, std::initializer_list<CollisionGroup> groups);
+
+  /** Brings the query tree up to date with bboxes that were changed
+      directly, only objects that left their fat rectangle cost more
+      than a containment check */
+  void refit_tree();
+
+  /** Wakes up all objects close to the objects that moved this
+      frame, or all of them if a solid tilemap moved or changed */
+  void wake_sleepers();
+
+  /** Wakes up all objects overlapping rect grown by a small margin
+      and resets the rest counter of those that are still awake */
+  void wake_nearby(const Rectf& rect);
+
+  /** Rebuilds the broadphase grid with all valid objects of the list,
+      using either their bbox or their destination */
+  void fill_grid(CollisionGrid& grid, const ObjectList& objects, bool use_dest) const;
+
+  /** Stores the destinations of all valid objects of the list, so
+      grid candidates can be filtered four at a time */
+  void fill_boxes(BBoxArray& boxes, const ObjectList& objects) const;
+
 private:
   Sector& m_sector;
-  std::vector<CollisionObject*>  m_objects;
+
+  /** All registered objects, partitioned by CollisionGroup. Adding
+      and removing objects is constant time, which can break the order
+      by CollisionObject::m_sequence, m_unsorted marks the lists that
+      collect() has to sort first. */
+  std::array<ObjectList, NUM_GROUPS> m_groups;
+  std::array<bool, NUM_GROUPS> m_unsorted;
+  uint64_t m_next_sequence;
+
+  /** Bounding volume hierarchy over the bboxes of all objects, used
+      for range, line of sight and box queries */
+  AABBTree m_tree;
+
+  /** Snapshots used by update(), see collect() */
+  ObjectList m_statics;
+  ObjectList m_touchables;
+  ObjectList m_movers;
+
+  /** Objects that moved this frame, see wake_sleepers() */
+  ObjectList m_active;
+
+  /** Combined revisions of the solid tilemaps at the last update() */
+  size_t m_tilemap_signature;
+
+  /** Broadphase grids, only valid during update(). Entries are
+      indices into the snapshot lists. */
+  CollisionGrid m_static_grid;
+  CollisionGrid m_touchable_grid;
+  CollisionGrid m_moving_grid;
+
+  /** Destinations of m_touchables, kept in sync with m_touchable_grid */
+  BBoxArray m_touchable_boxes;
+
+  /** Objects touching each other, in the order the contacts started,
+      so collision_end() is called in a deterministic order */
+  std::vector<Contact> m_contacts;
+  std::unordered_map<ContactKey, size_t, ContactKeyHash> m_contact_index;
+  uint32_t m_frame;
+
+  std::vector<size_t> m_static_candidates;
+  std::vector<size_t> m_candidates;
+  std::vector<size_t> m_hits;
+
+  /** Real positions while drawing interpolated, in m_groups order */
+  std::vector<Vector> m_interpolated_positions;
 
 private:
   CollisionSystem(const CollisionSystem&) = delete;
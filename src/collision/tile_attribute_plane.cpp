@@ -0,0 +1,103 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "collision/tile_attribute_plane.hpp"
+
+#include "supertux/tile.hpp"
+
+TileAttributePlane::TileAttributePlane() :
+  m_width(0),
+  m_height(0),
+  m_words(0),
+  m_solid(),
+  m_unisolid(),
+  m_slope(),
+  m_water(),
+  m_slope_data()
+{
+}
+
+void
+TileAttributePlane::resize(int width, int height)
+{
+  m_width = width;
+  m_height = height;
+  m_words = (height + 63) / 64;
+
+  const size_t words = static_cast<size_t>(m_width) * static_cast<size_t>(m_words);
+  m_solid.assign(words, 0);
+  m_unisolid.assign(words, 0);
+  m_slope.assign(words, 0);
+  m_water.assign(words, 0);
+  std::vector<uint8_t>().swap(m_slope_data);
+}
+
+void
+TileAttributePlane::set(int x, int y, uint32_t attributes, int data)
+{
+  assert(x >= 0 && x < m_width && y >= 0 && y < m_height);
+
+  const size_t word = x * m_words + y / 64;
+  const uint64_t bit = uint64_t(1) << (y % 64);
+
+  auto assign = [word, bit](Bits& bits, bool value) {
+    if (value) {
+      bits[word] |= bit;
+    } else {
+      bits[word] &= ~bit;
+    }
+  };
+
+  assign(m_solid, (attributes & Tile::SOLID) != 0);
+  assign(m_unisolid, (attributes & Tile::UNISOLID) != 0);
+  assign(m_slope, (attributes & Tile::SLOPE) != 0);
+  assign(m_water, (attributes & Tile::WATER) != 0);
+
+  if (attributes & Tile::SLOPE)
+  {
+    if (m_slope_data.empty()) {
+      m_slope_data.assign(static_cast<size_t>(m_width) * static_cast<size_t>(m_height), 0);
+    }
+    m_slope_data[y * m_width + x] = static_cast<uint8_t>(data);
+  }
+  else if (!m_slope_data.empty())
+  {
+    m_slope_data[y * m_width + x] = 0;
+  }
+}
+
+bool
+TileAttributePlane::any_fully_solid(const Rect& cells) const
+{
+  if (cells.top >= cells.bottom)
+    return false;
+
+  const int first_word = cells.top / 64;
+  const int last_word = (cells.bottom - 1) / 64;
+  for (int x = cells.left; x < cells.right; ++x)
+  {
+    const size_t column = x * m_words;
+    for (int word = first_word; word <= last_word; ++word)
+    {
+      const size_t i = column + word;
+      if (m_solid[i] & ~(m_unisolid[i] | m_slope[i]) & row_mask(word, cells.top, cells.bottom))
+        return true;
+    }
+  }
+  return false;
+}
+
+/* EOF */
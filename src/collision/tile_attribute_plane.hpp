@@ -0,0 +1,166 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_COLLISION_TILE_ATTRIBUTE_PLANE_HPP
+#define HEADER_SUPERTUX_COLLISION_TILE_ATTRIBUTE_PLANE_HPP
+
+#include <assert.h>
+#include <vector>
+#include <stdint.h>
+
+#ifdef _MSC_VER
+#  include <intrin.h>
+#endif
+
+#include "math/rect.hpp"
+
+/** Packed copy of the collision relevant attributes of a TileMap, so
+    the collision code doesn't have to look up a Tile for every cell.
+    SOLID, UNISOLID, SLOPE and WATER are stored as one bit per cell,
+    column by column, so whole runs of 64 cells can be skipped at once. The slope
+    data (AATriangle direction and deform flags) gets a byte per cell,
+    allocated once the first slope is set, so that decoration layers
+    don't pay for it. */
+class TileAttributePlane final
+{
+public:
+  TileAttributePlane();
+
+  /** Resizes the plane and clears all cells */
+  void resize(int width, int height);
+
+  /** Stores the Tile::SOLID, Tile::UNISOLID, Tile::SLOPE and
+      Tile::WATER bits of attributes for the given cell, data is only
+      kept for slopes */
+  void set(int x, int y, uint32_t attributes, int data);
+
+  bool is_solid(int x, int y) const { return test(m_solid, x, y); }
+  bool is_unisolid(int x, int y) const { return test(m_unisolid, x, y); }
+  bool is_slope(int x, int y) const { return test(m_slope, x, y); }
+  bool is_water(int x, int y) const { return test(m_water, x, y); }
+  int get_slope_data(int x, int y) const { return m_slope_data.empty() ? 0 : m_slope_data[y * m_width + x]; }
+
+  /** Calls callback(x, y) for every solid cell in the half-open
+      rectangle of cell indices, in the same order as an outer loop
+      over x and an inner loop over y would. Stops and returns false
+      as soon as the callback returns false. */
+  template<typename F>
+  bool for_each_solid(const Rect& cells, F callback) const
+  {
+    return for_each_cell(m_solid, nullptr, cells, callback);
+  }
+
+  /** Like for_each_solid(), but also visits water cells */
+  template<typename F>
+  bool for_each_solid_or_water(const Rect& cells, F callback) const
+  {
+    return for_each_cell(m_solid, &m_water, cells, callback);
+  }
+
+  /** Returns true if any cell in the half-open rectangle is solid,
+      but neither unisolid nor a slope */
+  bool any_fully_solid(const Rect& cells) const;
+
+private:
+  typedef std::vector<uint64_t> Bits;
+
+  static int lowest_bit(uint64_t bits)
+  {
+    assert(bits != 0);
+#ifdef _MSC_VER
+    unsigned long index;
+    _BitScanForward64(&index, bits);
+    return static_cast<int>(index);
+#else
+    return __builtin_ctzll(bits);
+#endif
+  }
+
+  /** Visits the cells whose bit is set in first or, if given, in extra */
+  template<typename F>
+  bool for_each_cell(const Bits& first, const Bits* extra, const Rect& cells, F callback) const;
+
+  bool test(const Bits& bits, int x, int y) const
+  {
+    return (bits[x * m_words + y / 64] >> (y % 64)) & 1;
+  }
+
+  /** Mask of the bits of word that lie within [top, bottom) */
+  static uint64_t row_mask(int word, int top, int bottom)
+  {
+    uint64_t mask = ~uint64_t(0);
+    if (word == top / 64) {
+      mask &= ~uint64_t(0) << (top % 64);
+    }
+    if (word == (bottom - 1) / 64 && bottom % 64 != 0) {
+      mask &= (uint64_t(1) << (bottom % 64)) - 1;
+    }
+    return mask;
+  }
+
+private:
+  int m_width;
+  int m_height;
+
+  /** Words per column */
+  int m_words;
+
+  Bits m_solid;
+  Bits m_unisolid;
+  Bits m_slope;
+  Bits m_water;
+  std::vector<uint8_t> m_slope_data;
+
+private:
+  TileAttributePlane(const TileAttributePlane&) = delete;
+  TileAttributePlane& operator=(const TileAttributePlane&) = delete;
+};
+
+template<typename F>
+bool
+TileAttributePlane::for_each_cell(const Bits& first, const Bits* extra, const Rect& cells, F callback) const
+{
+  if (cells.top >= cells.bottom)
+    return true;
+
+  const int first_word = cells.top / 64;
+  const int last_word = (cells.bottom - 1) / 64;
+  for (int x = cells.left; x < cells.right; ++x)
+  {
+    const uint64_t* column = &first[x * m_words];
+    const uint64_t* extra_column = extra ? &(*extra)[x * m_words] : nullptr;
+    for (int word = first_word; word <= last_word; ++word)
+    {
+      uint64_t bits = column[word];
+      if (extra_column) {
+        bits |= extra_column[word];
+      }
+      bits &= row_mask(word, cells.top, cells.bottom);
+      while (bits)
+      {
+        const int y = word * 64 + lowest_bit(bits);
+        bits &= bits - 1;
+        if (!callback(x, y))
+          return false;
+      }
+    }
+  }
+  return true;
+}
+
+#endif
+
+/* EOF */
@@ -40,6 +40,8 @@ public:
   void on_controller_added(int joystick_index);
   void on_controller_removed(int instance_id);
 
+  int get_deadzone() const { return m_deadzone; }
+
 private:
   InputManager* m_parent;
   int m_deadzone;
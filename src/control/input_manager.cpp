@@ -26,6 +26,7 @@
 InputManager::InputManager(KeyboardConfig& keyboard_config,
                            JoystickConfig& joystick_config) :
   controller(new Controller),
+  m_axis_zones(),
   m_use_game_controller(joystick_config.m_use_game_controller),
   keyboard_manager(new KeyboardManager(this, keyboard_config)),
   joystick_manager(new JoystickManager(this, joystick_config)),
@@ -67,6 +68,77 @@ InputManager::reset()
   controller->reset();
 }
 
+int
+InputManager::get_axis_zone(const SDL_Event& event) const
+{
+  int value;
+  int dead_zone;
+  switch (event.type)
+  {
+    case SDL_JOYAXISMOTION:
+      value = event.jaxis.value;
+      dead_zone = joystick_manager->get_dead_zone();
+      break;
+
+    case SDL_CONTROLLERAXISMOTION:
+      value = event.caxis.value;
+      dead_zone = game_controller_manager->get_deadzone();
+      break;
+
+    default:
+      return 0;
+  }
+
+  if (value < -dead_zone) {
+    return -1;
+  } else if (value > dead_zone) {
+    return 1;
+  } else {
+    return 0;
+  }
+}
+
+bool
+InputManager::filter_event(const SDL_Event& event)
+{
+  switch (event.type)
+  {
+    case SDL_JOYAXISMOTION:
+    case SDL_CONTROLLERAXISMOTION:
+    {
+      const auto key = (event.type == SDL_JOYAXISMOTION) ?
+        std::make_tuple(event.type, event.jaxis.which, event.jaxis.axis) :
+        std::make_tuple(event.type, event.caxis.which, event.caxis.axis);
+      const int zone = get_axis_zone(event);
+      auto it = m_axis_zones.find(key);
+      if (it != m_axis_zones.end() && it->second == zone)
+        return false;
+
+      m_axis_zones[key] = zone;
+      return true;
+    }
+
+    case SDL_JOYDEVICEREMOVED:
+    case SDL_CONTROLLERDEVICEREMOVED:
+    {
+      // instance ids aren't reused, this just keeps the map small
+      const SDL_JoystickID which = (event.type == SDL_JOYDEVICEREMOVED) ?
+        event.jdevice.which : event.cdevice.which;
+      for (auto it = m_axis_zones.begin(); it != m_axis_zones.end();) {
+        if (std::get<1>(it->first) == which) {
+          it = m_axis_zones.erase(it);
+        } else {
+          ++it;
+        }
+      }
+      return true;
+    }
+
+    default:
+      return true;
+  }
+}
+
 void
 InputManager::process_event(const SDL_Event& event)
 {
@@ -22,6 +22,7 @@
 #include <SDL.h>
 #include <map>
 #include <string>
+#include <tuple>
 #include <vector>
 #include <memory>
 
@@ -48,6 +49,15 @@ public:
 
   void process_event(const SDL_Event& event);
 
+  /** -1, 0 or 1 for an axis event left, within or right of the dead
+      zone, the managers only look at that, 0 for other events */
+  int get_axis_zone(const SDL_Event& event) const;
+
+  /** Returns false for axis events that stay in the zone of the
+      previous event of their axis, those change no control and are
+      dropped before reaching process_event() and the menus */
+  bool filter_event(const SDL_Event& event);
+
   void update();
   void reset();
 
@@ -60,6 +70,9 @@ public:
 private:
   std::unique_ptr<Controller> controller;
 
+  /** zone of the last passed event per event type, device and axis */
+  std::map<std::tuple<Uint32, SDL_JoystickID, Uint8>, int> m_axis_zones;
+
 public:
   bool& m_use_game_controller;
   std::unique_ptr<KeyboardManager> keyboard_manager;
@@ -147,6 +147,12 @@ JoystickManager::process_hat_event(const SDL_JoyHatEvent& jhat)
   hat_state = jhat.value;
 }
 
+int
+JoystickManager::get_dead_zone() const
+{
+  return m_joystick_config.m_dead_zone;
+}
+
 void
 JoystickManager::process_axis_event(const SDL_JoyAxisEvent& jaxis)
 {
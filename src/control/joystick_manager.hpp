@@ -46,6 +46,7 @@ public:
   void on_joystick_removed(int instance_id);
 
   int get_num_joysticks() const { return static_cast<int>(joysticks.size()); }
+  int get_dead_zone() const;
 
 private:
   InputManager* parent;
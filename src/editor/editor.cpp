@@ -18,6 +18,7 @@
 
 #include <limits>
 #include <physfs.h>
+#include <sstream>
 
 #include "audio/sound_manager.hpp"
 #include "control/input_manager.hpp"
@@ -38,6 +39,7 @@
 #include "object/player.hpp"
 #include "object/spawnpoint.hpp"
 #include "object/tilemap.hpp"
+#include "physfs/ofile_stream.hpp"
 #include "physfs/util.hpp"
 #include "sprite/sprite_manager.hpp"
 #include "supertux/game_manager.hpp"
@@ -50,8 +52,10 @@
 #include "supertux/sector.hpp"
 #include "supertux/tile.hpp"
 #include "supertux/tile_manager.hpp"
+#include "supertux/tile_set.hpp"
 #include "supertux/world.hpp"
 #include "util/file_system.hpp"
+#include "util/reader_document.hpp"
 #include "util/reader_mapping.hpp"
 #include "util/string_util.hpp"
 #include "video/compositor.hpp"
@@ -60,6 +64,15 @@
 #include "video/video_system.hpp"
 #include "video/viewport.hpp"
 
+namespace {
+
+/** Seconds between writes of the recovery file */
+const float AUTOSAVE_INTERVAL = 60.0f;
+
+const char* AUTOSAVE_DIR = "autosave";
+
+} // namespace
+
 bool Editor::s_resaving_in_progress = false;
 
 bool
@@ -99,7 +112,15 @@ Editor::Editor() :
   m_bgr_surface(Surface::from_file("images/background/antarctic/arctis2.png")),
   m_undo_manager(new UndoManager),
   m_ignore_sector_change(false),
-  m_level_first_loaded(false)
+  m_level_first_loaded(false),
+  m_editor_update_objects(),
+  m_editor_update_sector(nullptr),
+  m_editor_update_count(0),
+  m_editor_update_generation(0),
+  m_autosave_timer(0.0f),
+  m_autosaved_serial(0),
+  m_autosave_job(),
+  m_recovery_checked()
 {
   auto toolbox_widget = std::make_unique<EditorToolboxWidget>(*this);
   auto layers_widget = std::make_unique<EditorLayersWidget>(*this);
@@ -123,6 +144,24 @@ Editor::Editor() :
 
 Editor::~Editor()
 {
+  // the job writes to a file, but doesn't touch the editor
+  if (JobSystem::current()) {
+    JobSystem::current()->wait(m_autosave_job);
+  }
+
+  set_tileset(nullptr);
+}
+
+void
+Editor::set_tileset(TileSet* tileset)
+{
+  if (tileset) {
+    tileset->add_user();
+  }
+  if (m_tileset) {
+    m_tileset->remove_user();
+  }
+  m_tileset = tileset;
 }
 
 void
@@ -192,7 +231,23 @@ Editor::update(float dt_sec, const Controller& controller)
   if (m_levelloaded && !m_leveltested) {
     BIND_SECTOR(*m_sector);
 
-    for (auto& object : m_sector->get_objects()) {
+    const auto& objects = m_sector->get_objects();
+    if (m_editor_update_sector != m_sector ||
+        m_editor_update_count != objects.size() ||
+        m_editor_update_generation != GameObjectManager::get_removal_generation())
+    {
+      m_editor_update_objects.clear();
+      for (const auto& object : objects) {
+        if (object->has_editor_update()) {
+          m_editor_update_objects.push_back(object.get());
+        }
+      }
+      m_editor_update_sector = m_sector;
+      m_editor_update_count = objects.size();
+      m_editor_update_generation = GameObjectManager::get_removal_generation();
+    }
+
+    for (auto* object : m_editor_update_objects) {
       object->editor_update();
     }
 
@@ -205,7 +260,117 @@ Editor::update(float dt_sec, const Controller& controller)
     m_sector->flush_game_objects();
 
     update_keyboard(controller);
+
+    update_autosave(dt_sec);
+  }
+}
+
+void
+Editor::update_autosave(float dt_sec)
+{
+  m_autosave_timer += dt_sec;
+  if (m_autosave_timer < AUTOSAVE_INTERVAL)
+    return;
+
+  if (!m_undo_manager->has_unsaved_changes() ||
+      m_undo_manager->get_serial() == m_autosaved_serial ||
+      !m_autosave_job.is_done() ||
+      !JobSystem::current())
+  {
+    return;
+  }
+
+  m_autosave_timer = 0.0f;
+  m_autosaved_serial = m_undo_manager->get_serial();
+
+  // the snapshot is already serialized for the undo history, copying
+  // it is all the work left on the main thread
+  PHYSFS_mkdir(AUTOSAVE_DIR);
+  std::string filename = get_recovery_filename();
+  std::string writedir = PHYSFS_getWriteDir();
+  m_autosave_job = JobSystem::current()->schedule(
+    [filename, writedir, snapshot = m_undo_manager->get_snapshot()]
+    {
+      try
+      {
+        const std::string tmpname = filename + ".tmp";
+        {
+          OFileStream out(tmpname);
+          out.write(snapshot.data(), snapshot.size());
+        }
+        if (!FileSystem::rename(FileSystem::join(writedir, tmpname),
+                                FileSystem::join(writedir, filename))) {
+          log_warning << "couldn't write recovery file " << filename << std::endl;
+        }
+      }
+      catch(const std::exception& err)
+      {
+        log_warning << "couldn't write recovery file " << filename << ": " << err.what() << std::endl;
+      }
+    });
+}
+
+std::string
+Editor::get_recovery_filename() const
+{
+  std::string name = m_world ? FileSystem::join(m_world->get_basedir(), m_levelfile) : m_levelfile;
+  for (auto& c : name) {
+    if (c == '/' || c == '\\' || c == ':') {
+      c = '_';
+    }
   }
+  return FileSystem::join(AUTOSAVE_DIR, name);
+}
+
+void
+Editor::discard_recovery()
+{
+  if (JobSystem::current()) {
+    JobSystem::current()->wait(m_autosave_job);
+  }
+  m_autosave_timer = 0.0f;
+
+  const std::string filename = get_recovery_filename();
+  if (PHYSFS_exists(filename.c_str())) {
+    PHYSFS_delete(filename.c_str());
+  }
+}
+
+void
+Editor::check_recovery()
+{
+  if (m_recovery_checked == m_levelfile)
+    return;
+  m_recovery_checked = m_levelfile;
+
+  const std::string filename = get_recovery_filename();
+  if (!PHYSFS_exists(filename.c_str()))
+    return;
+
+  m_enabled = false;
+  auto dialog = std::make_unique<Dialog>();
+  dialog->set_text(_("This level has unsaved changes from a previous session, do you want to restore them?"));
+  dialog->add_default_button(_("Yes"), [this, filename] {
+    try
+    {
+      ReaderMapping::s_translations_enabled = false;
+      auto level = LevelParser::from_file(filename, m_level->is_worldmap(), true);
+      ReaderMapping::s_translations_enabled = true;
+      set_level(std::move(level), false);
+      m_undo_manager->try_snapshot(*m_level);
+    }
+    catch(const std::exception& err)
+    {
+      ReaderMapping::s_translations_enabled = true;
+      log_warning << "couldn't restore " << filename << ": " << err.what() << std::endl;
+    }
+    m_enabled = true;
+  });
+  dialog->add_button(_("No"), [this] {
+    discard_recovery();
+    m_enabled = true;
+  });
+  MenuManager::instance().set_dialog(std::move(dialog));
 }
 
 void
@@ -214,6 +379,7 @@ Editor::save_level()
   m_undo_manager->reset_index();
   m_level->save(m_world ? FileSystem::join(m_world->get_basedir(), m_levelfile) :
               m_levelfile);
+  discard_recovery();
 }
 
 std::string
@@ -252,14 +418,22 @@ Editor::test_level(const boost::optional<std::pair<std::string, Vector>>& test_p
     current_world = owned_world.get();
   }
 
-  m_test_levelfile = FileSystem::join(directory, backup_filename);
-  m_level->save(m_test_levelfile);
   if (!m_level->is_worldmap())
   {
-    GameManager::current()->start_level(*current_world, backup_filename, test_pos);
+    // hand the level over in memory instead of going through a file,
+    // the backup filename is only used to name the level
+    std::stringstream level_stream;
+    m_level->save(level_stream);
+    auto document = std::make_unique<ReaderDocument>(
+      ReaderDocument::from_stream(level_stream, FileSystem::join(directory, backup_filename)));
+
+    m_test_levelfile.clear();
+    GameManager::current()->start_level(*current_world, backup_filename, test_pos, std::move(document));
   }
   else
   {
+    m_test_levelfile = FileSystem::join(directory, backup_filename);
+    m_level->save(m_test_levelfile);
     GameManager::current()->start_worldmap(*current_world, "", m_test_levelfile);
   }
 
@@ -418,7 +592,7 @@ Editor::set_level(std::unique_ptr<Level> level, bool reset)
   m_level = std::move(level);
 
   if (reset) {
-    m_tileset = TileManager::current()->get_tileset(m_level->get_tileset());
+    set_tileset(TileManager::current()->get_tileset(m_level->get_tileset()));
   }
 
   load_sector(sector_name);
@@ -454,6 +628,8 @@ Editor::reload_level()
                                    StringUtil::has_suffix(m_levelfile, ".stwm"),
                                    true));
   ReaderMapping::s_translations_enabled = true;
+
+  check_recovery();
 }
 
 void
@@ -464,6 +640,7 @@ Editor::quit_editor()
   auto quit = [this] ()
   {
     //Quit level editor
+    discard_recovery();
     m_world = nullptr;
     m_levelfile = "";
     m_levelloaded = false;
@@ -692,7 +869,7 @@ Editor::get_tilegroups() const
 void
 Editor::change_tileset()
 {
-  m_tileset = TileManager::current()->get_tileset(m_level->get_tileset());
+  set_tileset(TileManager::current()->get_tileset(m_level->get_tileset()));
   m_toolbox_widget->set_input_type(EditorToolboxWidget::InputType::NONE);
   for (const auto& sector : m_level->m_sectors) {
     for (auto& tilemap : sector->get_objects_by_type<TileMap>()) {
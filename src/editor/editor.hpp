@@ -29,6 +29,7 @@
 #include "supertux/world.hpp"
 #include "util/currenton.hpp"
 #include "util/file_system.hpp"
+#include "util/job_system.hpp"
 #include "util/log.hpp"
 #include "video/surface_ptr.hpp"
 
@@ -67,6 +68,7 @@ public:
   void disable_keyboard() { m_enabled = false; }
 
   Level* get_level() const { return m_level.get(); }
+  const UndoManager* get_undo_manager() const { return m_undo_manager.get(); }
 
   void set_world(std::unique_ptr<World> w);
   World* get_world() const { return m_world.get(); }
@@ -124,6 +126,8 @@ public:
 
   void add_layer(GameObject* layer) { m_layers_widget->add_layer(layer); }
 
+  void invalidate_object_index() { m_overlay_widget->invalidate_object_index(); }
+
   TileMap* get_selected_tilemap() const { return m_layers_widget->get_selected_tilemap(); }
 
   Sector* get_sector() { return m_sector; }
@@ -134,12 +138,27 @@ public:
 private:
   void set_sector(Sector* sector);
   void set_level(std::unique_ptr<Level> level, bool reset = true);
+
+  /** The toolbox keeps using the tileset when the level has no
+      tilemaps, so the editor counts as a user of it */
+  void set_tileset(TileSet* tileset);
+
   void reload_level();
   void quit_editor();
   void save_level();
   void test_level(const boost::optional<std::pair<std::string, Vector>>& test_pos);
   void update_keyboard(const Controller& controller);
 
+  /** Periodically writes the unsaved level to a recovery file, the
+      file is written by a background job from the undo snapshot */
+  void update_autosave(float dt_sec);
+  std::string get_recovery_filename() const;
+  void discard_recovery();
+
+  /** Offers to restore the level from a recovery file left behind by
+      an editor session that didn't save or quit cleanly */
+  void check_recovery();
+
 protected:
   std::unique_ptr<Level> m_level;
   std::unique_ptr<World> m_world;
@@ -180,6 +199,20 @@ private:
   
   bool m_level_first_loaded;
 
+  /** Objects of m_sector that need editor_update(), rebuilt when
+      objects got added or removed */
+  std::vector<GameObject*> m_editor_update_objects;
+  const Sector* m_editor_update_sector;
+  size_t m_editor_update_count;
+  uint32_t m_editor_update_generation;
+
+  float m_autosave_timer;
+  size_t m_autosaved_serial;
+  JobSystem::Handle m_autosave_job;
+
+  /** Level file for which recovery was already offered */
+  std::string m_recovery_checked;
+
 private:
   Editor(const Editor&) = delete;
   Editor& operator=(const Editor&) = delete;
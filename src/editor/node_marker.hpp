@@ -32,6 +32,7 @@ public:
   virtual bool has_settings() const override { return true; }
   virtual ObjectSettings get_settings() override;
   virtual void editor_update() override;
+  virtual bool has_editor_update() const override { return true; }
 
   void update_iterator();
   void update_node_times();
@@ -23,22 +23,20 @@
 
 ObjectIcon::ObjectIcon(const std::string& object_class, const std::string& icon) :
   m_object_class(object_class),
-  m_surface(Surface::from_file(icon)),
+  m_icon(icon),
+  m_surface(),
   m_offset()
 {
-  calculate_offset();
 }
 
 ObjectIcon::ObjectIcon(const ReaderMapping& reader) :
   m_object_class(),
+  m_icon("images/engine/icons/supertux.png"),
   m_surface(),
   m_offset()
 {
-  std::string icon = "images/engine/icons/supertux.png";
   reader.get("class", m_object_class);
-  reader.get("icon", icon);
-  m_surface = Surface::from_file(icon);
-  calculate_offset();
+  reader.get("icon", m_icon);
 }
 
 ObjectIcon::~ObjectIcon()
@@ -46,6 +44,13 @@ ObjectIcon::~ObjectIcon()
 
 }
 
+void
+ObjectIcon::load_surface()
+{
+  m_surface = Surface::from_file(m_icon);
+  calculate_offset();
+}
+
 void
 ObjectIcon::calculate_offset()
 {
@@ -64,6 +69,10 @@ ObjectIcon::calculate_offset()
 void
 ObjectIcon::draw(DrawingContext& context, const Vector& pos)
 {
+  if (!m_surface) {
+    load_surface();
+  }
+
   context.color().draw_surface_scaled(m_surface,
                                       Rectf(pos + m_offset, pos + Vector(32,32) - m_offset), LAYER_GUI - 9);
 }
@@ -25,6 +25,8 @@
 class DrawingContext;
 class ReaderMapping;
 
+/** The surface is only loaded the first time the icon is drawn, so
+    object groups that are never opened in the toolbox cost nothing */
 class ObjectIcon
 {
 public:
@@ -37,10 +39,12 @@ public:
   std::string get_object_class() const { return m_object_class; }
 
 private:
+  void load_surface();
   void calculate_offset();
 
 private:
   std::string m_object_class;
+  std::string m_icon;
   SurfacePtr m_surface;
   Vector m_offset;
 };
@@ -0,0 +1,118 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "editor/object_index.hpp"
+
+#include "math/rectf.hpp"
+#include "supertux/moving_object.hpp"
+#include "supertux/sector.hpp"
+
+EditorObjectIndex::EditorObjectIndex() :
+  m_grid(),
+  m_objects(),
+  m_indices(),
+  m_followers(),
+  m_valid(false),
+  m_sector(nullptr),
+  m_object_count(0),
+  m_generation(0),
+  m_candidates()
+{
+}
+
+void
+EditorObjectIndex::refresh(Sector& sector)
+{
+  if (!m_valid ||
+      m_sector != &sector ||
+      m_object_count != sector.get_objects().size() ||
+      m_generation != GameObjectManager::get_removal_generation())
+  {
+    rebuild(sector);
+    return;
+  }
+
+  for (const auto index : m_followers) {
+    m_grid.update(index, m_objects[index]->get_bbox());
+  }
+}
+
+void
+EditorObjectIndex::rebuild(Sector& sector)
+{
+  m_grid.clear();
+  m_objects.clear();
+  m_indices.clear();
+  m_followers.clear();
+
+  for (auto& object : sector.get_objects_by_type<MovingObject>())
+  {
+    const size_t index = m_objects.size();
+    m_objects.push_back(&object);
+    m_indices[&object] = index;
+    m_grid.insert(index, object.get_bbox());
+    if (object.has_editor_update()) {
+      m_followers.push_back(index);
+    }
+  }
+
+  m_valid = true;
+  m_sector = &sector;
+  m_object_count = sector.get_objects().size();
+  m_generation = GameObjectManager::get_removal_generation();
+}
+
+void
+EditorObjectIndex::update(MovingObject& object)
+{
+  auto it = m_indices.find(&object);
+  if (it == m_indices.end()) {
+    m_valid = false;
+  } else {
+    m_grid.update(it->second, object.get_bbox());
+  }
+}
+
+MovingObject*
+EditorObjectIndex::pick(const Vector& pos) const
+{
+  m_grid.query(Rectf(pos, pos), m_candidates);
+  for (const auto index : m_candidates)
+  {
+    MovingObject* object = m_objects[index];
+    if (object->get_bbox().contains(pos)) {
+      return object;
+    }
+  }
+  return nullptr;
+}
+
+void
+EditorObjectIndex::query_contained(const Rectf& rect, std::vector<MovingObject*>& result) const
+{
+  result.clear();
+  m_grid.query(rect, m_candidates);
+  for (const auto index : m_candidates)
+  {
+    MovingObject* object = m_objects[index];
+    if (rect.contains(object->get_bbox())) {
+      result.push_back(object);
+    }
+  }
+}
+
+/* EOF */
@@ -0,0 +1,83 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_EDITOR_OBJECT_INDEX_HPP
+#define HEADER_SUPERTUX_EDITOR_OBJECT_INDEX_HPP
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "collision/collision_grid.hpp"
+
+class MovingObject;
+class Rectf;
+class Sector;
+class Vector;
+
+/** Spatial index over the MovingObjects of the edited sector, used for
+    picking objects under the mouse and for rubber band selection. The
+    index is rebuilt when objects get added or removed, objects moved
+    by the editor have to be reported with update(), everything else
+    that may move objects around calls invalidate(). */
+class EditorObjectIndex final
+{
+public:
+  EditorObjectIndex();
+
+  /** Brings the index up to date with sector */
+  void refresh(Sector& sector);
+
+  /** Forces a rebuild on the next refresh() */
+  void invalidate() { m_valid = false; }
+
+  /** Updates the position of a single object */
+  void update(MovingObject& object);
+
+  /** Returns the first object in sector order whose bbox contains pos */
+  MovingObject* pick(const Vector& pos) const;
+
+  /** Fills result with all objects whose bbox lies within rect */
+  void query_contained(const Rectf& rect, std::vector<MovingObject*>& result) const;
+
+private:
+  void rebuild(Sector& sector);
+
+private:
+  CollisionGrid m_grid;
+  std::vector<MovingObject*> m_objects;
+  std::unordered_map<const MovingObject*, size_t> m_indices;
+
+  /** Objects that move along with paths or other objects each frame */
+  std::vector<size_t> m_followers;
+
+  bool m_valid;
+  const Sector* m_sector;
+  size_t m_object_count;
+  uint32_t m_generation;
+
+  /** Scratch space for the queries */
+  mutable std::vector<size_t> m_candidates;
+
+private:
+  EditorObjectIndex(const EditorObjectIndex&) = delete;
+  EditorObjectIndex& operator=(const EditorObjectIndex&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -16,16 +16,46 @@
 
 #include "editor/object_settings.hpp"
 
+#include <algorithm>
 #include <assert.h>
 #include <sexp/value.hpp>
+#include <unordered_map>
 
 #include "util/gettext.hpp"
 #include "video/color.hpp"
 
+namespace {
+
+/** Number of options the last settings of a given name ended up with,
+    the editor rebuilds the settings of an object on every hover, copy
+    and save, so reserving up front spares the reallocations. Only
+    used from the main thread. */
+std::unordered_map<std::string, size_t>&
+option_count_hints()
+{
+  static std::unordered_map<std::string, size_t> s_hints;
+  return s_hints;
+}
+
+} // namespace
+
 ObjectSettings::ObjectSettings(const std::string& name) :
   m_name(name),
   m_options()
 {
+  auto it = option_count_hints().find(m_name);
+  if (it != option_count_hints().end()) {
+    m_options.reserve(it->second);
+  }
+}
+
+ObjectSettings::~ObjectSettings()
+{
+  // moved-from settings are empty and don't lower the hint
+  if (!m_options.empty()) {
+    size_t& hint = option_count_hints()[m_name];
+    hint = std::max(hint, m_options.size());
+  }
 }
 
 void
@@ -39,6 +39,7 @@ class ObjectSettings final
 public:
   ObjectSettings(const std::string& name);
   ObjectSettings(ObjectSettings&&) = default;
+  ~ObjectSettings();
 
   const std::string& get_name() const { return m_name; }
 
@@ -16,9 +16,8 @@
 
 #include "editor/overlay_widget.hpp"
 
-#include "util/reader_document.hpp"
-#include "util/reader_mapping.hpp"
-#include "util/writer.hpp"
+#include <algorithm>
+#include <math.h>
 
 #include "editor/editor.hpp"
 #include "editor/node_marker.hpp"
@@ -72,7 +71,10 @@ EditorOverlayWidget::EditorOverlayWidget(Editor& editor) :
   m_edited_path(nullptr),
   m_last_node_marker(nullptr),
   m_object_tip(),
-  m_obj_mouse_desync(0, 0)
+  m_obj_mouse_desync(0, 0),
+  m_autotile_queue(),
+  m_grid_lines(),
+  m_object_index()
 {
 }
 
@@ -101,6 +103,7 @@ EditorOverlayWidget::on_level_change()
   m_edited_path = nullptr;
   m_last_node_marker = nullptr;
   m_hovered_object = nullptr;
+  m_object_index.invalidate();
 }
 
 void
@@ -166,6 +169,47 @@ EditorOverlayWidget::input_tile(const Vector& pos, uint32_t tile)
   tilemap->change(static_cast<int>(pos.x), static_cast<int>(pos.y), tile);
 }
 
+void
+EditorOverlayWidget::input_tiles(const std::vector<int>& xs, const std::vector<int>& ys, int sel_x, int sel_y)
+{
+  auto tilemap = m_editor.get_selected_tilemap();
+  if (!tilemap) {
+    return;
+  }
+
+  auto tiles = m_editor.get_tiles();
+  std::vector<TileMap::Span> spans;
+  std::vector<uint32_t> span_tiles;
+  for (size_t j = 0; j < ys.size(); ++j)
+  {
+    const int y = ys[j];
+    if (y < 0 || y >= tilemap->get_height() || (j > 0 && ys[j - 1] == y))
+      continue;
+
+    TileMap::Span span{y, 0, 0};
+    for (size_t i = 0; i < xs.size(); ++i)
+    {
+      const int x = xs[i];
+      if (x < 0 || x >= tilemap->get_width() || (i > 0 && xs[i - 1] == x))
+        continue;
+
+      if (span.left == span.right) {
+        span.left = x;
+      }
+      span.right = x + 1;
+      span_tiles.push_back(tiles->pos(sel_x + static_cast<int>(i), sel_y + static_cast<int>(j)));
+    }
+
+    if (span.left != span.right) {
+      spans.push_back(span);
+    }
+  }
+
+  if (!spans.empty()) {
+    tilemap->change_spans(spans, span_tiles);
+  }
+}
+
 void
 EditorOverlayWidget::autotile(const Vector& pos, uint32_t tile)
 {
@@ -189,24 +233,61 @@ EditorOverlayWidget::input_autotile(const Vector& pos, uint32_t tile)
 {
   this->input_tile(pos, tile);
 
-  float x = pos.x;
-  float y = pos.y;
-
-  this->autotile(Vector(x - 1.0f, y - 1.0f), tile);
-  this->autotile(Vector(x       , y - 1.0f), tile);
-  this->autotile(Vector(x + 1.0f, y - 1.0f), tile);
-  this->autotile(Vector(x - 1.0f, y       ), tile);
-  this->autotile(Vector(x       , y       ), tile);
-  this->autotile(Vector(x + 1.0f, y       ), tile);
-  this->autotile(Vector(x - 1.0f, y + 1.0f), tile);
-  this->autotile(Vector(x       , y + 1.0f), tile);
-  this->autotile(Vector(x + 1.0f, y + 1.0f), tile);
+  // the 3x3 neighborhood is resolved in flush_autotile(), so
+  // overlapping neighborhoods of a brush only get autotiled once
+  const int x = static_cast<int>(pos.x);
+  const int y = static_cast<int>(pos.y);
+  for (int dy = -1; dy <= 1; ++dy) {
+    for (int dx = -1; dx <= 1; ++dx) {
+      const uint64_t key = (static_cast<uint64_t>(static_cast<uint32_t>(y + dy)) << 32) |
+                           static_cast<uint32_t>(x + dx);
+      m_autotile_queue.emplace_back(key, tile);
+    }
+  }
+}
+
+void
+EditorOverlayWidget::flush_autotile()
+{
+  // the last placement touching a cell decides, as before
+  std::stable_sort(m_autotile_queue.begin(), m_autotile_queue.end(),
+                   [](const std::pair<uint64_t, uint32_t>& lhs, const std::pair<uint64_t, uint32_t>& rhs) {
+                     return lhs.first < rhs.first;
+                   });
+
+  for (size_t i = 0; i < m_autotile_queue.size(); ++i)
+  {
+    if (i + 1 < m_autotile_queue.size() && m_autotile_queue[i + 1].first == m_autotile_queue[i].first)
+      continue;
+
+    const uint64_t key = m_autotile_queue[i].first;
+    const int x = static_cast<int>(static_cast<uint32_t>(key & 0xffffffff));
+    const int y = static_cast<int>(static_cast<uint32_t>(key >> 32));
+    autotile(Vector(static_cast<float>(x), static_cast<float>(y)), m_autotile_queue[i].second);
+  }
+  m_autotile_queue.clear();
 }
 
 void
 EditorOverlayWidget::put_tile()
 {
   auto tiles = m_editor.get_tiles();
+  if (!autotile_mode)
+  {
+    // one bulk write, positions left of or above the tilemap are skipped
+    // just like input_tile() does
+    auto to_tile = [](float pos) { return pos < 0.0f ? -1 : static_cast<int>(pos); };
+    std::vector<int> xs, ys;
+    for (int x = 0; x < tiles->m_width; ++x) {
+      xs.push_back(to_tile(m_hovered_tile.x + static_cast<float>(x)));
+    }
+    for (int y = 0; y < tiles->m_height; ++y) {
+      ys.push_back(to_tile(m_hovered_tile.y + static_cast<float>(y)));
+    }
+    input_tiles(xs, ys, 0, 0);
+    return;
+  }
+
   Vector add_tile;
   for (add_tile.x = static_cast<float>(tiles->m_width) - 1.0f; add_tile.x >= 0.0f; add_tile.x--) {
     for (add_tile.y = static_cast<float>(tiles->m_height) - 1.0f; add_tile.y >= 0; add_tile.y--) {
@@ -219,6 +300,7 @@ EditorOverlayWidget::put_tile()
       }
     }
   }
+  flush_autotile();
 }
 
 void
@@ -230,6 +312,21 @@ EditorOverlayWidget::draw_rectangle()
   bool sgn_x = m_drag_start.x < m_sector_pos.x;
   bool sgn_y = m_drag_start.y < m_sector_pos.y;
 
+  if (!autotile_mode)
+  {
+    std::vector<int> xs, ys;
+    for (int x = static_cast<int>(dr.get_left()); x <= static_cast<int>(dr.get_right()); x++) {
+      xs.push_back(x);
+    }
+    for (int y = static_cast<int>(dr.get_top()); y <= static_cast<int>(dr.get_bottom()); y++) {
+      ys.push_back(y);
+    }
+    input_tiles(xs, ys,
+                sgn_x ? 0 : static_cast<int>(-dr.get_width()),
+                sgn_y ? 0 : static_cast<int>(-dr.get_height()));
+    return;
+  }
+
   int x_ = sgn_x ? 0 : static_cast<int>(-dr.get_width());
   for (int x = static_cast<int>(dr.get_left()); x <= static_cast<int>(dr.get_right()); x++, x_++) {
     int y_ = sgn_y ? 0 : static_cast<int>(-dr.get_height());
@@ -241,6 +338,7 @@ EditorOverlayWidget::draw_rectangle()
       }
     }
   }
+  flush_autotile();
 }
 
 bool
@@ -267,113 +365,109 @@ EditorOverlayWidget::fill()
     return;
   }
 
+  const int width = tilemap->get_width();
+  const int height = tilemap->get_height();
+  const int start_x = static_cast<int>(m_hovered_tile.x);
+  const int start_y = static_cast<int>(m_hovered_tile.y);
+  if (m_hovered_tile.x < 0 || m_hovered_tile.y < 0 || start_x >= width || start_y >= height) {
+    return;
+  }
+
   // The tile that is going to be replaced:
-  Uint32 replace_tile = tilemap->get_tile_id(static_cast<int>(m_hovered_tile.x), static_cast<int>(m_hovered_tile.y));
+  Uint32 replace_tile = tilemap->get_tile_id(start_x, start_y);
 
   if (replace_tile == tiles->pos(0, 0)) {
     // Replacing by the same tiles shouldn't do anything.
     return;
   }
 
-  std::vector<Vector> pos_stack;
-  pos_stack.clear();
-  pos_stack.push_back(m_hovered_tile);
-
-  // Passing recursively trough all tiles to be replaced...
-  while (pos_stack.size()) {
-
-    if (pos_stack.size() > 1000000) {
-      log_warning << "More than 1'000'000 tiles in stack to fill, STOP" << std::endl;
-      return;
-    }
-
-    Vector pos = pos_stack[pos_stack.size() - 1];
-    Vector tpos = pos - m_hovered_tile;
-
-    // Tests for being inside tilemap:
-    if ( pos.x < 0 ||
-         pos.y < 0 ||
-         pos.x >= static_cast<float>(tilemap->get_width()) ||
-         pos.y >= static_cast<float>(tilemap->get_height()))
-    {
-      pos_stack.pop_back();
+  auto brush = [&tiles, start_x, start_y](int x, int y) {
+    return tiles->pos(x - start_x, y - start_y);
+  };
+
+  // Find the whole region first, as horizontal spans
+  std::vector<bool> filled(static_cast<size_t>(width) * static_cast<size_t>(height), false);
+  auto can_fill = [&](int x, int y) {
+    return !filled[y * width + x] &&
+      check_tiles_for_fill(replace_tile, tilemap->get_tile_id(x, y), brush(x, y));
+  };
+
+  std::vector<TileMap::Span> spans;
+  std::vector<std::pair<int, int> > seeds;
+  seeds.emplace_back(start_x, start_y);
+  while (!seeds.empty())
+  {
+    const int x = seeds.back().first;
+    const int y = seeds.back().second;
+    seeds.pop_back();
+    if (filled[y * width + x])
       continue;
-    }
 
-    // Autotile will happen later, so that directional filling works properly
-    input_tile(pos, tiles->pos(static_cast<int>(tpos.x), static_cast<int>(tpos.y)));
+    int left = x;
+    while (left > 0 && can_fill(left - 1, y)) --left;
+    int right = x + 1;
+    while (right < width && can_fill(right, y)) ++right;
 
-    Vector pos_;
-
-    // Going left...
-    pos_ = pos + Vector(-1, 0);
-    if (pos_.x >= 0) {
-      if (check_tiles_for_fill(replace_tile,
-          tilemap->get_tile_id(static_cast<int>(pos_.x), static_cast<int>(pos_.y)),
-          tiles->pos(static_cast<int>(tpos.x - 1), static_cast<int>(tpos.y)))) {
-        pos_stack.push_back( pos_ );
-        continue;
-      }
+    for (int i = left; i < right; ++i) {
+      filled[y * width + i] = true;
     }
+    spans.push_back({ y, left, right });
 
-    // Going right...
-    pos_ = pos + Vector(1, 0);
-    if (pos_.x < static_cast<float>(tilemap->get_width())) {
-      if (check_tiles_for_fill(replace_tile,
-          tilemap->get_tile_id(static_cast<int>(pos_.x), static_cast<int>(pos_.y)),
-          tiles->pos(static_cast<int>(tpos.x + 1), static_cast<int>(tpos.y)))) {
-        pos_stack.push_back( pos_ );
+    // one seed per run of fillable tiles above and below
+    for (const int ny : { y - 1, y + 1 }) {
+      if (ny < 0 || ny >= height)
         continue;
-      }
-    }
 
-    // Going up...
-    pos_ = pos + Vector(0, -1);
-    if (pos_.y >= 0) {
-      if (check_tiles_for_fill(replace_tile,
-          tilemap->get_tile_id(static_cast<int>(pos_.x), static_cast<int>(pos_.y)),
-          tiles->pos(static_cast<int>(tpos.x), static_cast<int>(tpos.y - 1)))) {
-        pos_stack.push_back( pos_ );
-        continue;
+      bool in_run = false;
+      for (int i = left; i < right; ++i) {
+        const bool fillable = can_fill(i, ny);
+        if (fillable && !in_run) {
+          seeds.emplace_back(i, ny);
+        }
+        in_run = fillable;
       }
     }
+  }
 
-    // Going down...
-    pos_ = pos + Vector(0, 1);
-    if (pos_.y < static_cast<float>(tilemap->get_height())) {
-      if (check_tiles_for_fill(replace_tile,
-          tilemap->get_tile_id(static_cast<int>(pos_.x), static_cast<int>(pos_.y)),
-          tiles->pos(static_cast<int>(tpos.x), static_cast<int>(tpos.y + 1)))) {
-        pos_stack.push_back( pos_ );
-        continue;
-      }
+  std::vector<uint32_t> new_tiles;
+  for (const auto& span : spans) {
+    for (int x = span.left; x < span.right; ++x) {
+      new_tiles.push_back(brush(x, span.y));
     }
+  }
+  tilemap->change_spans(spans, new_tiles);
 
-    // Autotile happens after directional detection (because of borders; see snow tileset)
-    if (autotile_mode) {
-      input_autotile(pos, tiles->pos(static_cast<int>(tpos.x), static_cast<int>(tpos.y)));
-    }
+  if (!autotile_mode)
+    return;
 
-    // When tiles on each side are already filled or occupied by another tiles, it ends.
-    pos_stack.pop_back();
+  // Autotile the region and its border once, after all tiles are in
+  // place, so that directional filling works properly
+  std::vector<bool> autotiled(filled.size(), false);
+  for (const auto& span : spans) {
+    for (int y = std::max(0, span.y - 1); y <= std::min(height - 1, span.y + 1); ++y) {
+      for (int x = std::max(0, span.left - 1); x <= std::min(width - 1, span.right); ++x) {
+        if (!autotiled[y * width + x]) {
+          autotiled[y * width + x] = true;
+          tilemap->autotile(x, y, brush(x, y));
+        }
+      }
+    }
   }
 }
 
 void
 EditorOverlayWidget::hover_object()
 {
-  for (auto& moving_object : m_editor.get_sector()->get_objects_by_type<MovingObject>())
+  m_object_index.refresh(*m_editor.get_sector());
+  if (auto* moving_object = m_object_index.pick(m_sector_pos))
   {
-    Rectf bbox = moving_object.get_bbox();
-    if (bbox.contains(m_sector_pos)) {
-      if (&moving_object != m_hovered_object) {
-        m_hovered_object = &moving_object;
-        if (moving_object.has_settings()) {
-          m_object_tip = std::make_unique<Tip>(moving_object);
-        }
+    if (moving_object != m_hovered_object) {
+      m_hovered_object = moving_object;
+      if (moving_object->has_settings()) {
+        m_object_tip = std::make_unique<Tip>(*moving_object);
       }
-      return;
     }
+    return;
   }
   m_object_tip = nullptr;
   m_hovered_object = nullptr;
@@ -462,20 +556,13 @@ EditorOverlayWidget::clone_object()
     auto* pm = dynamic_cast<MarkerObject*>(m_hovered_object);
     if (!pm)
     {
-      m_obj_mouse_desync = m_sector_pos - m_hovered_object->get_pos();
-
-      // clone the current object by means of saving and loading it
-      auto game_object_uptr = [this]{
-        std::stringstream stream;
-        Writer writer(stream);
-        writer.start_list(m_hovered_object->get_class());
-        m_hovered_object->save(writer);
-        writer.end_list(m_hovered_object->get_class());
+      auto game_object_uptr = m_hovered_object->clone();
+      if (!game_object_uptr) {
+        m_dragged_object = nullptr;
+        return;
+      }
 
-        auto doc = ReaderDocument::from_stream(stream);
-        auto object_sx = doc.get_root();
-        return GameObjectFactory::instance().create(object_sx.get_name(), object_sx.get_mapping());
-      }();
+      m_obj_mouse_desync = m_sector_pos - m_hovered_object->get_pos();
 
       GameObject& game_object = m_editor.get_sector()->add_object(std::move(game_object_uptr));
 
@@ -517,6 +604,13 @@ EditorOverlayWidget::move_object()
       }
     }
     m_dragged_object->move_to(new_pos);
+
+    // markers drag paths and resize other objects along
+    if (dynamic_cast<MarkerObject*>(m_dragged_object)) {
+      m_object_index.invalidate();
+    } else {
+      m_object_index.update(*m_dragged_object);
+    }
   }
 }
 
@@ -537,11 +631,11 @@ EditorOverlayWidget::rubber_rect()
 {
   delete_markers();
   Rectf dr = drag_rect();
-  for (auto& moving_object : m_editor.get_sector()->get_objects_by_type<MovingObject>()) {
-    Rectf bbox = moving_object.get_bbox();
-    if (dr.contains(bbox)) {
-      moving_object.editor_delete();
-    }
+  std::vector<MovingObject*> objects;
+  m_object_index.refresh(*m_editor.get_sector());
+  m_object_index.query_contained(dr, objects);
+  for (auto* moving_object : objects) {
+    moving_object->editor_delete();
   }
   m_last_node_marker = nullptr;
 }
@@ -885,15 +979,28 @@ EditorOverlayWidget::draw_tile_tip(DrawingContext& context)
       return;
     }
 
-    Vector drawn_tile = m_hovered_tile;
     auto tiles = m_editor.get_tiles();
+    if (tiles->empty()) {
+      return;
+    }
 
-    for (drawn_tile.x = static_cast<float>(tiles->m_width) - 1.0f; drawn_tile.x >= 0.0f; drawn_tile.x--) {
-      for (drawn_tile.y = static_cast<float>(tiles->m_height) - 1.0f; drawn_tile.y >= 0.0f; drawn_tile.y--) {
+    // only walk the part of the selection that is on screen, a
+    // selection can be as large as the whole tilemap
+    const Vector& cam = m_editor.get_sector()->get_camera().get_translation();
+    const Vector view_start = sp_to_tp(cam) - m_hovered_tile;
+    const Vector view_end = sp_to_tp(cam + Vector(static_cast<float>(context.get_width()),
+                                                  static_cast<float>(context.get_height()))) - m_hovered_tile;
+    const int min_x = std::max(0, static_cast<int>(floorf(view_start.x)) - 1);
+    const int min_y = std::max(0, static_cast<int>(floorf(view_start.y)) - 1);
+    const int max_x = std::min(tiles->m_width - 1, static_cast<int>(ceilf(view_end.x)));
+    const int max_y = std::min(tiles->m_height - 1, static_cast<int>(ceilf(view_end.y)));
+
+    Vector drawn_tile;
+    for (drawn_tile.x = static_cast<float>(max_x); drawn_tile.x >= static_cast<float>(min_x); drawn_tile.x--) {
+      for (drawn_tile.y = static_cast<float>(max_y); drawn_tile.y >= static_cast<float>(min_y); drawn_tile.y--) {
         Vector on_tile = m_hovered_tile + drawn_tile;
 
-        if (m_editor.get_tiles()->empty() ||
-            on_tile.x < 0 ||
+        if (on_tile.x < 0 ||
             on_tile.y < 0 ||
             on_tile.x >= static_cast<float>(tilemap->get_width()) ||
             on_tile.y >= static_cast<float>(tilemap->get_height())) {
@@ -933,18 +1040,18 @@ EditorOverlayWidget::draw_tile_grid(DrawingContext& context, const Color& line_c
   end.x = std::min(float(tm_width), end.x);
   end.y = std::min(float(tm_height), end.y);
 
-  Vector line_start, line_end;
+  // all lines go out as one request
+  m_grid_lines.clear();
   for (int i = static_cast<int>(start.x); i <= static_cast<int>(end.x); i++) {
-    line_start = tile_screen_pos( Vector(static_cast<float>(i), 0.0f), tile_size );
-    line_end = tile_screen_pos( Vector(static_cast<float>(i), end.y), tile_size );
-    context.color().draw_line(line_start, line_end, line_color, current_tm->get_layer());
+    m_grid_lines.push_back(tile_screen_pos( Vector(static_cast<float>(i), 0.0f), tile_size ));
+    m_grid_lines.push_back(tile_screen_pos( Vector(static_cast<float>(i), end.y), tile_size ));
   }
 
   for (int i = static_cast<int>(start.y); i <= static_cast<int>(end.y); i++) {
-    line_start = tile_screen_pos( Vector(0.0f, static_cast<float>(i)), tile_size );
-    line_end = tile_screen_pos( Vector(end.x, static_cast<float>(i)), tile_size );
-    context.color().draw_line(line_start, line_end, line_color, current_tm->get_layer());
+    m_grid_lines.push_back(tile_screen_pos( Vector(0.0f, static_cast<float>(i)), tile_size ));
+    m_grid_lines.push_back(tile_screen_pos( Vector(end.x, static_cast<float>(i)), tile_size ));
   }
+  context.color().draw_lines(m_grid_lines, line_color, current_tm->get_layer());
 }
 
 void
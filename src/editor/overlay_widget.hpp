@@ -18,8 +18,10 @@
 #define HEADER_SUPERTUX_EDITOR_OVERLAY_WIDGET_HPP
 
 #include <SDL.h>
+#include <vector>
 
 #include "control/input_manager.hpp"
+#include "editor/object_index.hpp"
 #include "editor/widget.hpp"
 #include "math/vector.hpp"
 
@@ -67,6 +69,9 @@ public:
   void update_node_iterators();
   void on_level_change();
 
+  /** Called when objects may have changed their size or position */
+  void invalidate_object_index() { m_object_index.invalidate(); }
+
   void edit_path(Path* path, GameObject* new_marked_object = nullptr);
 
 private:
@@ -74,8 +79,17 @@ private:
 
 private:
   void input_tile(const Vector& pos, uint32_t tile);
+
+  /** Puts the tile selection into the selected tilemap with a single
+      bulk write. Column i of the selection, counted from sel_x, goes
+      to tile column xs[i], rows likewise. Coordinates outside of the
+      tilemap are skipped, so are repeats of the previous one. */
+  void input_tiles(const std::vector<int>& xs, const std::vector<int>& ys, int sel_x, int sel_y);
   void autotile(const Vector& pos, uint32_t tile);
   void input_autotile(const Vector& pos, uint32_t tile);
+
+  /** Autotiles every cell queued by input_autotile() once */
+  void flush_autotile();
   void put_tile();
   void draw_rectangle();
   bool check_tiles_for_fill(uint32_t replace_tile, uint32_t target_tile, uint32_t third_tile) const;
@@ -131,6 +145,15 @@ private:
   std::unique_ptr<Tip> m_object_tip;
   Vector m_obj_mouse_desync;
 
+  /** Cells to autotile, packed y and x, along with the tile whose
+      placement requested it */
+  std::vector<std::pair<uint64_t, uint32_t> > m_autotile_queue;
+
+  /** Scratch space for draw_tile_grid() */
+  std::vector<Vector> m_grid_lines;
+
+  EditorObjectIndex m_object_index;
+
 private:
   EditorOverlayWidget(const EditorOverlayWidget&) = delete;
   EditorOverlayWidget& operator=(const EditorOverlayWidget&) = delete;
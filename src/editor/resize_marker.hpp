@@ -37,6 +37,7 @@ public:
   virtual Vector get_offset() const override;
   virtual bool has_settings() const override { return false; }
   virtual void editor_update() override;
+  virtual bool has_editor_update() const override { return true; }
 
 private:
   void refresh_pos();
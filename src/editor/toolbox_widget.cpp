@@ -16,6 +16,8 @@
 
 #include "editor/toolbox_widget.hpp"
 
+#include <algorithm>
+
 #include "editor/editor.hpp"
 #include "editor/object_info.hpp"
 #include "editor/tile_selection.hpp"
@@ -107,13 +109,12 @@ void
 EditorToolboxWidget::draw_tilegroup(DrawingContext& context)
 {
   if (m_input_type == InputType::TILE) {
-    int pos = -1;
-    for (auto& tile_ID : m_active_tilegroup->tiles) {
-      pos++;
-      if (pos < m_starting_tile) {
-        continue;
-      }
-      auto position = get_tile_coords(pos - m_starting_tile);
+    const auto& tiles = m_active_tilegroup->tiles;
+    size_t begin, end;
+    get_visible_range(tiles.size(), begin, end);
+    for (size_t pos = begin; pos < end; ++pos) {
+      const uint32_t tile_ID = tiles[pos];
+      auto position = get_tile_coords(static_cast<int>(pos) - m_starting_tile);
       draw_tile(context.color(), *m_editor.get_tileset(), tile_ID, position, LAYER_GUI - 9);
 
       if (g_config->developer_mode && m_active_tilegroup->developers_group)
@@ -135,13 +136,11 @@ void
 EditorToolboxWidget::draw_objectgroup(DrawingContext& context)
 {
   if (m_input_type == InputType::OBJECT) {
-    int pos = -1;
-    for (auto& icon : m_object_info->m_groups[m_active_objectgroup].get_icons()) {
-      pos++;
-      if (pos < m_starting_tile) {
-        continue;
-      }
-      icon.draw(context, get_tile_coords(pos - m_starting_tile));
+    auto& icons = m_object_info->m_groups[m_active_objectgroup].get_icons();
+    size_t begin, end;
+    get_visible_range(icons.size(), begin, end);
+    for (size_t pos = begin; pos < end; ++pos) {
+      icons[pos].draw(context, get_tile_coords(static_cast<int>(pos) - m_starting_tile));
     }
   }
 }
@@ -494,6 +493,14 @@ EditorToolboxWidget::get_tile_coords(const int pos) const
                 static_cast<float>(y * 32 + m_Ypos));
 }
 
+void
+EditorToolboxWidget::get_visible_range(size_t size, size_t& begin, size_t& end) const
+{
+  const int rows = (SCREEN_HEIGHT - m_Ypos + 31) / 32;
+  begin = std::min(static_cast<size_t>(std::max(m_starting_tile, 0)), size);
+  end = std::min(begin + static_cast<size_t>(std::max(rows, 0) * 4), size);
+}
+
 int
 EditorToolboxWidget::get_tile_pos(const Vector& coords) const
 {
@@ -82,6 +82,11 @@ public:
 
 private:
   Vector get_tile_coords(const int pos) const;
+
+  /** Range [begin, end) of the items in a group of the given size
+      that are on screen at the current scroll position */
+  void get_visible_range(size_t size, size_t& begin, size_t& end) const;
+
   int get_tile_pos(const Vector& coords) const;
   Vector get_tool_coords(const int pos) const;
   int get_tool_pos(const Vector& coords) const;
@@ -16,8 +16,9 @@
 
 #include "editor/undo_manager.hpp"
 
-#include <sstream>
+#include <algorithm>
 #include <iostream>
+#include <sstream>
 
 #include "editor/editor.hpp"
 #include "supertux/level.hpp"
@@ -25,11 +26,22 @@
 #include "util/log.hpp"
 #include "util/reader_mapping.hpp"
 
+namespace {
+
+/** Oldest deltas are dropped once the history takes up more */
+const size_t MAX_UNDO_BYTES = 32 * 1024 * 1024;
+
+} // namespace
+
 UndoManager::UndoManager() :
-  m_max_snapshots(100),
+  m_max_bytes(MAX_UNDO_BYTES),
   m_index_pos(),
+  m_has_snapshot(false),
+  m_current(),
   m_undo_stack(),
-  m_redo_stack()
+  m_redo_stack(),
+  m_undo_bytes(0),
+  m_serial(0)
 {
 }
 
@@ -40,15 +52,11 @@ UndoManager::try_snapshot(Level& level)
   level.save(out);
   std::string level_snapshot = out.str();
 
-  if (m_undo_stack.empty())
-  {
-    push_undo_stack(std::move(level_snapshot));
-  }
-  else if (level_snapshot == m_undo_stack.back())
+  if (m_has_snapshot && level_snapshot == m_current)
   {
     log_debug << "skipping snapshot as nothing has changed" << std::endl;
   }
-  else // level_snapshot changed
+  else
   {
     push_undo_stack(std::move(level_snapshot));
   }
@@ -61,56 +69,103 @@ UndoManager::debug_print(const char* action)
   std::cout << action << std::endl;
   std::cout << "undo_stack: ";
   for(size_t i = 0; i < m_undo_stack.size(); ++i) {
-    std::cout << static_cast<const void*>(m_undo_stack[i].data()) << " ";
+    std::cout << m_undo_stack[i].offset << "+" << m_undo_stack[i].get_size() << " ";
   }
   std::cout << std::endl;
 
   std::cout << "redo_stack: ";
   for(size_t i = 0; i < m_redo_stack.size(); ++i) {
-    std::cout << static_cast<const void*>(m_redo_stack[i].data()) << " ";
+    std::cout << m_redo_stack[i].offset << "+" << m_redo_stack[i].get_size() << " ";
   }
   std::cout << std::endl;
   std::cout << std::endl;
 #endif
 }
 
+UndoManager::Delta
+UndoManager::make_delta(const std::string& before, const std::string& after)
+{
+  // everything between the common prefix and the common suffix
+  const size_t max_common = std::min(before.size(), after.size());
+  const auto prefix = std::mismatch(before.begin(), before.begin() + max_common, after.begin());
+  const size_t offset = static_cast<size_t>(prefix.first - before.begin());
+
+  const auto suffix = std::mismatch(before.rbegin(), before.rbegin() + (max_common - offset), after.rbegin());
+  const size_t suffix_length = static_cast<size_t>(suffix.first - before.rbegin());
+
+  Delta delta;
+  delta.offset = offset;
+  delta.before = before.substr(offset, before.size() - offset - suffix_length);
+  delta.after = after.substr(offset, after.size() - offset - suffix_length);
+  return delta;
+}
+
 void
 UndoManager::push_undo_stack(std::string&& level_snapshot)
 {
   log_info << "doing snapshot" << std::endl;
 
   m_redo_stack.clear();
-  m_undo_stack.push_back(std::move(level_snapshot));
+  if (m_has_snapshot)
+  {
+    m_undo_stack.push_back(make_delta(m_current, level_snapshot));
+    m_undo_bytes += m_undo_stack.back().get_size();
+  }
+  m_current = std::move(level_snapshot);
+  m_has_snapshot = true;
   m_index_pos += 1;
+  m_serial += 1;
 
   cleanup();
 
   debug_print("snapshot");
 }
 
+size_t
+UndoManager::get_memory_usage() const
+{
+  size_t bytes = m_current.capacity() + m_undo_bytes;
+  for (const auto& delta : m_redo_stack) {
+    bytes += delta.get_size();
+  }
+  return bytes;
+}
+
 void
 UndoManager::cleanup()
 {
-  while (m_undo_stack.size() > m_max_snapshots) {
-    m_undo_stack.erase(m_undo_stack.end() - m_max_snapshots,
-                       m_undo_stack.end());
+  while (m_undo_bytes > m_max_bytes && !m_undo_stack.empty()) {
+    m_undo_bytes -= m_undo_stack.front().get_size();
+    m_undo_stack.pop_front();
   }
 }
 
+std::unique_ptr<Level>
+UndoManager::load_current(const char* context) const
+{
+  std::istringstream in(m_current);
+  ReaderMapping::s_translations_enabled = false;
+  auto level = LevelParser::from_stream(in, context, Editor::current()->get_level()->is_worldmap(), true);
+  ReaderMapping::s_translations_enabled = true;
+  return level;
+}
+
 std::unique_ptr<Level>
 UndoManager::undo()
 {
-  if (m_undo_stack.size() < 2) return {};
+  if (m_undo_stack.empty()) return {};
 
-  m_redo_stack.push_back(std::move(m_undo_stack.back()));
+  Delta delta = std::move(m_undo_stack.back());
   m_undo_stack.pop_back();
+  m_undo_bytes -= delta.get_size();
 
-  std::istringstream in(m_undo_stack.back());
-  ReaderMapping::s_translations_enabled = false;
-  auto level = LevelParser::from_stream(in, "<undo_stack>", Editor::current()->get_level()->is_worldmap(), true);
-  ReaderMapping::s_translations_enabled = true;
+  m_current.replace(delta.offset, delta.after.size(), delta.before);
+  m_redo_stack.push_back(std::move(delta));
+
+  auto level = load_current("<undo_stack>");
 
   m_index_pos -= 1;
+  m_serial += 1;
 
   debug_print("undo");
 
@@ -122,15 +177,17 @@ UndoManager::redo()
 {
   if (m_redo_stack.empty()) return {};
 
-  m_undo_stack.push_back(std::move(m_redo_stack.back()));
+  Delta delta = std::move(m_redo_stack.back());
   m_redo_stack.pop_back();
 
+  m_current.replace(delta.offset, delta.before.size(), delta.after);
+  m_undo_bytes += delta.get_size();
+  m_undo_stack.push_back(std::move(delta));
+
   m_index_pos += 1;
+  m_serial += 1;
 
-  std::istringstream in(m_undo_stack.back());
-  ReaderMapping::s_translations_enabled = false;
-  auto level = LevelParser::from_stream(in, "<redo_stack>", Editor::current()->get_level()->is_worldmap(), true);
-  ReaderMapping::s_translations_enabled = true;
+  auto level = load_current("<redo_stack>");
 
   debug_print("redo");
 
@@ -17,15 +17,31 @@
 #ifndef HEADER_SUPERTUX_EDITOR_UNDO_MANAGER_HPP
 #define HEADER_SUPERTUX_EDITOR_UNDO_MANAGER_HPP
 
-#include <vector>
-#include <string>
+#include <deque>
 #include <memory>
+#include <string>
+#include <vector>
 
 class Level;
 
+/** Keeps the undo history as deltas between consecutive level
+    snapshots. Only the current snapshot is stored as a whole, every
+    history entry holds the span of text that changed, which for tile
+    edits is a few rows of one tilemap. The history is bounded by the
+    bytes it takes up instead of by the number of entries. */
 class UndoManager
 {
 private:
+  /** Turns one snapshot into another by replacing the text at offset */
+  struct Delta
+  {
+    size_t offset;
+    std::string before;
+    std::string after;
+
+    size_t get_size() const { return before.size() + after.size(); }
+  };
+
 public:
   UndoManager();
 
@@ -44,16 +60,34 @@ public:
     m_index_pos = 1;
   }
 
+  /** The serialized current level, empty before the first snapshot */
+  const std::string& get_snapshot() const { return m_current; }
+
+  /** Changes whenever the current snapshot does */
+  size_t get_serial() const { return m_serial; }
+
+  /** Bytes taken by the current snapshot and both stacks */
+  size_t get_memory_usage() const;
+
 private:
   void push_undo_stack(std::string&& level_snapshot);
   void cleanup();
   void debug_print(const char* action);
 
+  static Delta make_delta(const std::string& before, const std::string& after);
+  std::unique_ptr<Level> load_current(const char* context) const;
+
 private:
-  size_t m_max_snapshots;
+  size_t m_max_bytes;
   int m_index_pos;
-  std::vector<std::string> m_undo_stack;
-  std::vector<std::string> m_redo_stack;
+
+  bool m_has_snapshot;
+  std::string m_current;
+
+  std::deque<Delta> m_undo_stack;
+  std::vector<Delta> m_redo_stack;
+  size_t m_undo_bytes;
+  size_t m_serial;
 
 private:
   UndoManager(const UndoManager&) = delete;
@@ -57,6 +57,8 @@ Menu::Menu() :
   m_mn_input_char('\0'),
   m_menu_repeat_time(),
   m_menu_width(),
+  m_help_text(),
+  m_help_size(),
   m_items(),
   m_arrange_left(0),
   m_active_item(-1)
@@ -577,15 +579,29 @@ Menu::on_window_resize()
 void
 Menu::draw(DrawingContext& context)
 {
-  for (unsigned int i = 0; i < m_items.size(); ++i)
+  // long menus like the addon list scroll most of their items out of
+  // view, only the ones overlapping the screen get drawn, items are 24
+  // pixels high and the highlight reaches 2 pixels beyond that
+  const Rectf cliprect = context.get_cliprect();
+  const float menu_top = m_pos.y - get_height() / 2.0f;
+  const int begin = std::max(0, static_cast<int>(floorf((cliprect.get_top() - menu_top - 26.0f) / 24.0f)));
+  const int end = std::min(static_cast<int>(m_items.size()),
+                           static_cast<int>(ceilf((cliprect.get_bottom() - menu_top + 2.0f) / 24.0f)));
+
+  for (int i = begin; i < end; ++i)
   {
     draw_item(context, i);
   }
 
   if (!m_items[m_active_item]->get_help().empty())
   {
-    const int text_width = static_cast<int>(Resources::normal_font->get_text_width(m_items[m_active_item]->get_help()));
-    const int text_height = static_cast<int>(Resources::normal_font->get_text_height(m_items[m_active_item]->get_help()));
+    if (m_items[m_active_item]->get_help() != m_help_text) {
+      m_help_text = m_items[m_active_item]->get_help();
+      m_help_size = Sizef(Resources::normal_font->get_text_width(m_help_text),
+                          Resources::normal_font->get_text_height(m_help_text));
+    }
+    const int text_width = static_cast<int>(m_help_size.width);
+    const int text_height = static_cast<int>(m_help_size.height);
 
     const Rectf text_rect(m_pos.x - static_cast<float>(text_width) / 2.0f - 8.0f,
                           static_cast<float>(SCREEN_HEIGHT) - 48.0f - static_cast<float>(text_height) / 2.0f - 4.0f,
@@ -20,8 +20,10 @@
 #include <functional>
 #include <memory>
 #include <SDL.h>
+#include <string>
 
 #include "gui/menu_action.hpp"
+#include "math/sizef.hpp"
 #include "math/vector.hpp"
 #include "video/color.hpp"
 
@@ -139,6 +141,11 @@ private:
   float m_menu_repeat_time;
   float m_menu_width;
 
+  /** Help text of the active item and its size, only measured again
+      when the text changes */
+  std::string m_help_text;
+  Sizef m_help_size;
+
 public:
   std::vector<std::unique_ptr<MenuItem> > m_items;
 
@@ -0,0 +1,112 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "math/fast_random.hpp"
+
+#include <limits>
+
+namespace {
+
+const uint64_t PCG_MULTIPLIER = 6364136223846793005ULL;
+
+} // namespace
+
+FastRandom::FastRandom() :
+  m_state(0),
+  m_increment(0)
+{
+  seed(0);
+}
+
+FastRandom::FastRandom(uint64_t seed_, uint64_t stream) :
+  m_state(0),
+  m_increment(0)
+{
+  seed(seed_, stream);
+}
+
+void
+FastRandom::seed(uint64_t seed_, uint64_t stream)
+{
+  // the increment has to be odd
+  m_state = 0;
+  m_increment = (stream << 1) | 1;
+  next();
+  m_state += seed_;
+  next();
+}
+
+FastRandom
+FastRandom::split()
+{
+  const uint64_t seed_ = (static_cast<uint64_t>(next()) << 32) | next();
+  const uint64_t stream = (static_cast<uint64_t>(next()) << 32) | next();
+  return FastRandom(seed_, stream);
+}
+
+uint32_t
+FastRandom::next()
+{
+  const uint64_t old = m_state;
+  m_state = old * PCG_MULTIPLIER + m_increment;
+
+  // xorshift the high bits, then rotate by the top five
+  const uint32_t xorshifted = static_cast<uint32_t>(((old >> 18) ^ old) >> 27);
+  const uint32_t rot = static_cast<uint32_t>(old >> 59);
+  return (xorshifted >> rot) | (xorshifted << ((32 - rot) & 31));
+}
+
+int
+FastRandom::rand()
+{
+  return rand(0, std::numeric_limits<int>::max());
+}
+
+int
+FastRandom::rand(int v)
+{
+  return rand(0, v);
+}
+
+int
+FastRandom::rand(int u, int v)
+{
+  if (v <= u)
+    return u;
+
+  // multiply instead of modulo, the bias is far below what effects can show
+  const uint64_t range = static_cast<uint64_t>(static_cast<int64_t>(v) - u);
+  return static_cast<int>(u + static_cast<int64_t>((static_cast<uint64_t>(next()) * range) >> 32));
+}
+
+float
+FastRandom::randf(float v)
+{
+  return randf(0.0f, v);
+}
+
+float
+FastRandom::randf(float u, float v)
+{
+  // 24 bits are all a float can take
+  const float fraction = static_cast<float>(next() >> 8) * (1.0f / 16777216.0f);
+  const float result = u + (v - u) * fraction;
+  // rounding can end up on v
+  return result < v ? result : u;
+}
+
+/* EOF */
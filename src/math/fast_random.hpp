@@ -0,0 +1,68 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_MATH_FAST_RANDOM_HPP
+#define HEADER_SUPERTUX_MATH_FAST_RANDOM_HPP
+
+#include <stdint.h>
+
+/** PCG32 generator for effects. It has 16 bytes of state instead of
+    the 2.5 KB of std::mt19937 and is a lot faster, so every particle
+    system can own a stream of its own, which also makes them safe to
+    simulate in parallel. Streams with different ids are independent
+    even when seeded the same.
+
+    Not for anything that changes the game, gameRandom stays a Random
+    so recorded demos keep playing back the same. */
+class FastRandom final
+{
+public:
+  FastRandom();
+  FastRandom(uint64_t seed, uint64_t stream = 0);
+
+  void seed(uint64_t seed, uint64_t stream = 0);
+
+  /** Returns a new generator seeded from this one, on a different
+      stream */
+  FastRandom split();
+
+  /** Uniform 32 random bits */
+  uint32_t next();
+
+  /** Generate random integers between [0, INT_MAX) */
+  int rand();
+
+  /** Generate random integers between [0, v) */
+  int rand(int v);
+
+  /** Generate random integers between [u, v) */
+  int rand(int u, int v);
+
+  /** Generate random floats between [0, v) */
+  float randf(float v);
+
+  /** Generate random floats between [u, v) */
+  float randf(float u, float v);
+
+private:
+  uint64_t m_state;
+  uint64_t m_increment;
+};
+
+#endif
+
+/* EOF */
@@ -18,7 +18,7 @@
 
 #include <limits>
 
-Random graphicsRandom;
+FastRandom graphicsRandom;
 Random gameRandom;
 
 Random::Random() :
@@ -67,4 +67,12 @@ Random::randf(float u, float v)
   return dist(m_generator);
 }
 
+uint32_t
+Random::get_state_hash() const
+{
+  // the next output depends on the whole state
+  std::mt19937 copy = m_generator;
+  return static_cast<uint32_t>(copy());
+}
+
 /* EOF */
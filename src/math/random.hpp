@@ -18,6 +18,9 @@
 #define HEADER_SUPERTUX_MATH_RANDOM_HPP
 
 #include <random>
+#include <stdint.h>
+
+#include "math/fast_random.hpp"
 
 class Random
 {
@@ -42,6 +45,9 @@ public:
   /** Generate random floats between [u, v) */
   float randf(float u, float v);
 
+  /** Fingerprint of the generator state, doesn't advance it */
+  uint32_t get_state_hash() const;
+
 private:
   std::mt19937 m_generator;
 
@@ -51,7 +57,7 @@ private:
 };
 
 /** Use for random particle fx or whatever */
-extern Random graphicsRandom;
+extern FastRandom graphicsRandom;
 
 /** Use for game-changing random numbers */
 extern Random gameRandom;
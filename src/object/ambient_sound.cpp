@@ -16,6 +16,7 @@
 
 #include "object/ambient_sound.hpp"
 
+#include <algorithm>
 #include <limits>
 
 #include "audio/sound_manager.hpp"
@@ -26,6 +27,21 @@
 #include "util/reader_mapping.hpp"
 #include "video/drawing_context.hpp"
 
+namespace {
+
+/** Sources ambient sounds may use at once, leaving enough of OpenAL's
+    sources for the sound effects and music */
+const size_t MAX_PLAYING = 16;
+
+/** A silent sound has to be this much louder than the quietest playing
+    one to take over its source, so two sounds of about the same volume
+    don't keep swapping */
+const float TAKEOVER_FACTOR = 2.0f;
+
+} // namespace
+
+std::vector<AmbientSound*> AmbientSound::s_playing;
+
 AmbientSound::AmbientSound(const ReaderMapping& mapping) :
   MovingObject(mapping),
   ExposedObject<AmbientSound, scripting::AmbientSound>(this),
@@ -39,7 +55,7 @@ AmbientSound::AmbientSound(const ReaderMapping& mapping) :
   targetvolume(),
   currentvolume(0)
 {
-  m_col.m_group = COLGROUP_DISABLED;
+  set_group(COLGROUP_DISABLED);
 
   float w, h;
   mapping.get("x", m_col.m_bbox.get_left(), 0.0f);
@@ -88,7 +104,7 @@ AmbientSound::AmbientSound(const Vector& pos, float factor, float bias, float vo
   targetvolume(),
   currentvolume()
 {
-  m_col.m_group = COLGROUP_DISABLED;
+  set_group(COLGROUP_DISABLED);
 
   m_col.m_bbox.set_pos(pos);
   m_col.m_bbox.set_size(32, 32);
@@ -134,6 +150,9 @@ AmbientSound::after_editor_set()
 void
 AmbientSound::stop_playing()
 {
+  if (sound_source) {
+    s_playing.erase(std::find(s_playing.begin(), s_playing.end(), this));
+  }
   sound_source.reset();
 }
 
@@ -142,6 +161,20 @@ AmbientSound::start_playing()
 {
   if (Editor::is_active()) return;
 
+  if (s_playing.size() >= MAX_PLAYING)
+  {
+    auto quietest = std::min_element(s_playing.begin(), s_playing.end(),
+                                     [](const AmbientSound* lhs, const AmbientSound* rhs) {
+                                       return lhs->targetvolume * lhs->maximumvolume <
+                                         rhs->targetvolume * rhs->maximumvolume;
+                                     });
+    if (targetvolume * maximumvolume <
+        (*quietest)->targetvolume * (*quietest)->maximumvolume * TAKEOVER_FACTOR)
+      return;
+
+    (*quietest)->stop_playing();
+  }
+
   try {
     sound_source = SoundManager::current()->create_sound_source(sample);
     if (!sound_source)
@@ -149,8 +182,10 @@ AmbientSound::start_playing()
 
     sound_source->set_gain(0);
     sound_source->set_looping(true);
-    currentvolume=targetvolume=1e-20f;
+    // targetvolume stays, it decides which sounds keep their source
+    currentvolume=1e-20f;
     sound_source->play();
+    s_playing.push_back(this);
   } catch(std::exception& e) {
     log_warning << "Couldn't play '" << sample << "': " << e.what() << "" << std::endl;
     sound_source.reset();
@@ -166,8 +201,9 @@ AmbientSound::update(float dt_sec)
     float rx,ry;
 
     // Camera position
-    px=Sector::get().get_camera().get_center().x;
-    py=Sector::get().get_camera().get_center().y;
+    const Vector& center = Sector::get().get_camera().get_view_state().center;
+    px=center.x;
+    py=center.y;
 
     // Relate to which point in the area
     rx=px<m_col.m_bbox.get_left()?m_col.m_bbox.get_left():
@@ -39,6 +39,8 @@
 #ifndef HEADER_SUPERTUX_OBJECT_AMBIENT_SOUND_HPP
 #define HEADER_SUPERTUX_OBJECT_AMBIENT_SOUND_HPP
 
+#include <vector>
+
 #include "math/vector.hpp"
 #include "supertux/moving_object.hpp"
 #include "scripting/ambient_sound.hpp"
@@ -95,6 +97,12 @@ private:
   float targetvolume;  /// how loud we want to be
   float currentvolume; /// how loud we are
 
+  /** Ambient sounds that currently own a sound source. There are only
+      so many sources, when all are taken a louder sound takes over the
+      source of the quietest one, the others stay silent until they get
+      loud enough. */
+  static std::vector<AmbientSound*> s_playing;
+
 private:
   AmbientSound(const AmbientSound&) = delete;
   AmbientSound& operator=(const AmbientSound&) = delete;
@@ -16,9 +16,8 @@
 
 #include "object/background.hpp"
 
-#include <physfs.h>
-
 #include "editor/editor.hpp"
+#include "physfs/util.hpp"
 #include "supertux/d_scope.hpp"
 #include "supertux/globals.hpp"
 #include "util/reader.hpp"
@@ -264,6 +263,19 @@ Background::draw_image(DrawingContext& context, const Vector& pos_)
   }
   else
   {
+    // collect all repetitions of an image and hand them to the canvas
+    // as a single batch instead of issuing one request per tile
+    std::vector<Rectf> srcrects[3];
+    std::vector<Rectf> dstrects[3];
+    const SurfacePtr images[3] = { m_image, m_image_top, m_image_bottom };
+
+    auto add_tile = [&images, &srcrects, &dstrects](int idx, const Vector& p) {
+      const SurfacePtr& image = images[idx];
+      srcrects[idx].emplace_back(image->get_region());
+      dstrects[idx].emplace_back(p, Sizef(static_cast<float>(image->get_width()),
+                                          static_cast<float>(image->get_height())));
+    };
+
     switch (m_alignment)
     {
       case LEFT_ALIGNMENT:
@@ -271,7 +283,7 @@ Background::draw_image(DrawingContext& context, const Vector& pos_)
         {
           Vector p(pos_.x - parallax_image_size.width / 2.0f,
                    pos_.y + static_cast<float>(y) * img_h - img_h_2);
-          canvas.draw_surface(m_image, p, m_layer);
+          add_tile(0, p);
         }
         break;
 
@@ -280,7 +292,7 @@ Background::draw_image(DrawingContext& context, const Vector& pos_)
         {
           Vector p(pos_.x + parallax_image_size.width / 2.0f - img_w,
                    pos_.y + static_cast<float>(y) * img_h - img_h_2);
-          canvas.draw_surface(m_image, p, m_layer);
+          add_tile(0, p);
         }
         break;
 
@@ -289,7 +301,7 @@ Background::draw_image(DrawingContext& context, const Vector& pos_)
         {
           Vector p(pos_.x + static_cast<float>(x) * img_w - img_w_2,
                    pos_.y - parallax_image_size.height / 2.0f);
-          canvas.draw_surface(m_image, p, m_layer);
+          add_tile(0, p);
         }
         break;
 
@@ -298,7 +310,7 @@ Background::draw_image(DrawingContext& context, const Vector& pos_)
         {
           Vector p(pos_.x + static_cast<float>(x) * img_w - img_w_2,
                    pos_.y - img_h + parallax_image_size.height / 2.0f);
-          canvas.draw_surface(m_image, p, m_layer);
+          add_tile(0, p);
         }
         break;
 
@@ -311,19 +323,30 @@ Background::draw_image(DrawingContext& context, const Vector& pos_)
 
             if (m_image_top.get() != nullptr && (y < 0))
             {
-              canvas.draw_surface(m_image_top, p, m_layer);
+              add_tile(1, p);
             }
             else if (m_image_bottom.get() != nullptr && (y > 0))
             {
-              canvas.draw_surface(m_image_bottom, p, m_layer);
+              add_tile(2, p);
             }
             else
             {
-              canvas.draw_surface(m_image, p, m_layer);
+              add_tile(0, p);
             }
           }
         break;
     }
+
+    for (int idx = 0; idx < 3; ++idx)
+    {
+      if (!srcrects[idx].empty()) {
+        canvas.draw_surface_batch(images[idx],
+                                  std::move(srcrects[idx]),
+                                  std::move(dstrects[idx]),
+                                  Color(1.0f, 1.0f, 1.0f),
+                                  m_layer);
+      }
+    }
   }
 }
 
@@ -416,7 +439,7 @@ std::unordered_map<std::string, std::string> fallback_paths = {
 SurfacePtr
 Background::load_background(const std::string& image_path)
 {
-  if (PHYSFS_exists(image_path.c_str()))
+  if (physfsutil::exists_cached(image_path))
     // No need to search fallback paths
     return Surface::from_file(image_path);
 
@@ -14,8 +14,6 @@
 //  You should have received a copy of the GNU General Public License
 //  along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
-#include <physfs.h>
-
 #include "object/block.hpp"
 
 #include "audio/sound_manager.hpp"
@@ -26,6 +24,7 @@
 #include "object/growup.hpp"
 #include "object/player.hpp"
 #include "object/sprite_particle.hpp"
+#include "physfs/util.hpp"
 #include "sprite/sprite.hpp"
 #include "sprite/sprite_manager.hpp"
 #include "supertux/constants.hpp"
@@ -68,7 +67,7 @@ Block::Block(const ReaderMapping& mapping, const std::string& sprite_file) :
 
   std::string sf;
   mapping.get("sprite", sf);
-  if (sf.empty() || !PHYSFS_exists(sf.c_str())) {
+  if (sf.empty() || !physfsutil::exists_cached(sf)) {
     sf = sprite_file;
   }
   m_sprite = SpriteManager::current()->create(sf);
@@ -19,7 +19,7 @@
 #include "audio/sound_manager.hpp"
 #include "badguy/badguy.hpp"
 #include "editor/editor.hpp"
-#include "object/bouncy_coin.hpp"
+#include "object/bouncy_coin_system.hpp"
 #include "object/coin_explode.hpp"
 #include "object/coin_rain.hpp"
 #include "object/flower.hpp"
@@ -270,7 +270,7 @@ BonusBlock::try_open(Player* player)
   switch (m_contents) {
     case Content::COIN:
     {
-      Sector::get().add<BouncyCoin>(get_pos(), true);
+      Sector::get().get_bouncy_coins().add(get_pos(), true);
       player->get_status().add_coins(1);
       if (m_hit_counter != 0)
         Sector::get().get_level().m_stats.m_coins++;
@@ -0,0 +1,100 @@
+//  SuperTux
+//  Copyright (C) 2006 Matthias Braun <matze@braunis.de>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "object/bouncy_coin_system.hpp"
+
+#include "sprite/sprite.hpp"
+#include "sprite/sprite_manager.hpp"
+#include "supertux/globals.hpp"
+#include "video/drawing_context.hpp"
+
+namespace {
+
+/** this controls the time over which a bouncy coin fades */
+const float FADE_TIME = .2f;
+
+/** this is the total life time of a bouncy coin */
+const float LIFE_TIME = .5f;
+
+} // namespace
+
+BouncyCoinSystem::BouncyCoinSystem() :
+  m_sprites(),
+  m_positions(),
+  m_start_times(),
+  m_emerge_distances()
+{
+}
+
+void
+BouncyCoinSystem::add(const Vector& pos, bool emerge, const std::string& sprite_path)
+{
+  m_sprites.push_back(SpriteManager::current()->create(sprite_path));
+  m_positions.push_back(pos);
+  m_start_times.push_back(g_game_time);
+  m_emerge_distances.push_back(emerge ? static_cast<float>(m_sprites.back()->get_height()) : 0.0f);
+}
+
+void
+BouncyCoinSystem::update(float dt_sec)
+{
+  const float dist = -200 * dt_sec;
+
+  size_t out = 0;
+  for (size_t i = 0; i < m_positions.size(); ++i)
+  {
+    if (g_game_time - m_start_times[i] >= LIFE_TIME)
+      continue;
+
+    if (out != i) {
+      m_sprites[out] = std::move(m_sprites[i]);
+      m_positions[out] = m_positions[i];
+      m_start_times[out] = m_start_times[i];
+      m_emerge_distances[out] = m_emerge_distances[i];
+    }
+    m_positions[out].y += dist;
+    m_emerge_distances[out] += dist;
+    out += 1;
+  }
+
+  m_sprites.resize(out);
+  m_positions.resize(out);
+  m_start_times.resize(out);
+  m_emerge_distances.resize(out);
+}
+
+void
+BouncyCoinSystem::draw(DrawingContext& context)
+{
+  for (size_t i = 0; i < m_positions.size(); ++i)
+  {
+    const float time_left = LIFE_TIME - (g_game_time - m_start_times[i]);
+    const bool fading = time_left < FADE_TIME;
+    if (fading) {
+      context.push_transform();
+      context.set_alpha(time_left / FADE_TIME);
+    }
+
+    const int layer = (m_emerge_distances[i] > 0) ? LAYER_OBJECTS - 5 : LAYER_OBJECTS + 5;
+    m_sprites[i]->draw(context.color(), m_positions[i], layer);
+
+    if (fading) {
+      context.pop_transform();
+    }
+  }
+}
+
+/* EOF */
@@ -0,0 +1,60 @@
+//  SuperTux
+//  Copyright (C) 2006 Matthias Braun <matze@braunis.de>
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_OBJECT_BOUNCY_COIN_SYSTEM_HPP
+#define HEADER_SUPERTUX_OBJECT_BOUNCY_COIN_SYSTEM_HPP
+
+#include <string>
+#include <vector>
+
+#include "math/vector.hpp"
+#include "sprite/sprite_ptr.hpp"
+#include "supertux/game_object.hpp"
+
+/** The coins that jump out of bonus blocks and bricks or fly off when
+    a coin is collected. They are short-lived and come in bursts, so
+    instead of a GameObject each, one object per sector holds all of
+    them and updates and draws them in one go. */
+class BouncyCoinSystem final : public GameObject
+{
+public:
+  BouncyCoinSystem();
+
+  virtual void update(float dt_sec) override;
+  virtual void draw(DrawingContext& context) override;
+
+  virtual bool is_singleton() const override { return true; }
+  virtual bool is_saveable() const override { return false; }
+
+  void add(const Vector& pos, bool emerge = false,
+           const std::string& sprite_path = "images/objects/coin/coin.sprite");
+
+  size_t get_count() const { return m_positions.size(); }
+
+private:
+  std::vector<SpritePtr> m_sprites;
+  std::vector<Vector> m_positions;
+  std::vector<float> m_start_times;
+  std::vector<float> m_emerge_distances;
+
+private:
+  BouncyCoinSystem(const BouncyCoinSystem&) = delete;
+  BouncyCoinSystem& operator=(const BouncyCoinSystem&) = delete;
+};
+
+#endif
+
+/* EOF */
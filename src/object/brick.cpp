@@ -18,7 +18,7 @@
 
 #include "audio/sound_manager.hpp"
 #include "badguy/badguy.hpp"
-#include "object/bouncy_coin.hpp"
+#include "object/bouncy_coin_system.hpp"
 #include "object/explosion.hpp"
 #include "object/icecrusher.hpp"
 #include "object/player.hpp"
@@ -106,7 +106,7 @@ Brick::try_break(Player* player)
   SoundManager::current()->play("sounds/brick.wav");
   Player& player_one = Sector::get().get_player();
   if (m_coin_counter > 0 ) {
-    Sector::get().add<BouncyCoin>(get_pos(), true);
+    Sector::get().get_bouncy_coins().add(get_pos(), true);
     m_coin_counter--;
     player_one.get_status().add_coins(1);
     if (m_coin_counter == 0)
@@ -22,8 +22,10 @@
 #include "supertux/moving_object.hpp"
 #include "supertux/physic.hpp"
 #include "supertux/player_status.hpp"
+#include "util/object_pool.hpp"
 
-class Bullet final : public MovingObject
+class Bullet final : public MovingObject,
+                     public PooledObject<Bullet>
 {
 public:
   Bullet(const Vector& pos, float xm, Direction dir, BonusType type);
@@ -16,6 +16,7 @@
 
 #include "object/camera.hpp"
 
+#include <algorithm>
 #include <math.h>
 #include <physfs.h>
 
@@ -35,6 +36,9 @@
    0 is never get there, 1 is instant */
 static const float PEEK_ARRIVE_RATIO = 0.1f;
 
+/* seconds the camera movement is extrapolated for the prefetch rect */
+static const float PREFETCH_TIME = 1.0f;
+
 class CameraConfig final
 {
 public:
@@ -124,6 +128,9 @@ Camera::Camera(const std::string& name) :
   m_defaultmode(Mode::NORMAL),
   m_screen_size(SCREEN_WIDTH, SCREEN_HEIGHT),
   m_translation(),
+  m_previous_translation(),
+  m_prefetch_rect(),
+  m_view(),
   m_lookahead_mode(LookaheadMode::NONE),
   m_changetime(),
   m_lookahead_pos(),
@@ -140,6 +147,7 @@ Camera::Camera(const std::string& name) :
   m_config(std::make_unique<CameraConfig>())
 {
   reload_config();
+  update_view_state(Vector(0.0f, 0.0f));
 }
 
 Camera::Camera(const ReaderMapping& reader) :
@@ -149,6 +157,9 @@ Camera::Camera(const ReaderMapping& reader) :
   m_defaultmode(Mode::NORMAL),
   m_screen_size(SCREEN_WIDTH, SCREEN_HEIGHT),
   m_translation(),
+  m_previous_translation(),
+  m_prefetch_rect(),
+  m_view(),
   m_lookahead_mode(LookaheadMode::NONE),
   m_changetime(),
   m_lookahead_pos(),
@@ -193,6 +204,7 @@ Camera::Camera(const ReaderMapping& reader) :
   }
 
   reload_config();
+  update_view_state(Vector(0.0f, 0.0f));
 }
 
 Camera::~Camera()
@@ -238,6 +250,13 @@ Camera::get_translation() const
   return m_translation;
 }
 
+void
+Camera::set_translation(const Vector& translation)
+{
+  m_translation = translation;
+  update_view_state(m_view.velocity);
+}
+
 void
 Camera::reset(const Vector& tuxpos)
 {
@@ -249,6 +268,7 @@ Camera::reset(const Vector& tuxpos)
   keep_in_bounds(m_translation);
 
   m_cached_translation = m_translation;
+  update_view_state(Vector(0.0f, 0.0f));
 }
 
 void
@@ -285,13 +305,18 @@ static const float CAMERA_EPSILON = .00001f;
 void
 Camera::draw(DrawingContext& context)
 {
-  m_screen_size = Size(context.get_width(),
-                       context.get_height());
+  const Size screen_size(context.get_width(), context.get_height());
+  if (screen_size != m_screen_size) {
+    m_screen_size = screen_size;
+    update_view_state(m_view.velocity);
+  }
 }
 
 void
 Camera::update(float dt_sec)
 {
+  m_previous_translation = m_translation;
+
   switch (m_mode) {
     case Mode::NORMAL:
       update_scroll_normal(dt_sec);
@@ -306,6 +331,39 @@ Camera::update(float dt_sec)
       break;
   }
   shake();
+  update_prefetch_rect(dt_sec);
+  update_view_state(dt_sec > 0.0f ? (m_translation - m_previous_translation) / dt_sec : Vector(0.0f, 0.0f));
+}
+
+void
+Camera::update_view_state(const Vector& velocity)
+{
+  m_view.translation = m_translation;
+  m_view.center = get_center();
+  m_view.rect = Rectf(m_translation, Sizef(m_screen_size));
+  m_view.velocity = velocity;
+}
+
+void
+Camera::update_prefetch_rect(float dt_sec)
+{
+  const Sizef size(m_screen_size);
+  Vector goal = m_translation;
+  if (m_mode == Mode::SCROLLTO) {
+    goal = m_scroll_goal;
+  } else if (dt_sec > 0.0f) {
+    // scrolling is smooth except for jumps, which are capped here
+    Vector ahead = (m_translation - m_previous_translation) * (PREFETCH_TIME / dt_sec);
+    ahead.x = math::clamp(ahead.x, -size.width, size.width);
+    ahead.y = math::clamp(ahead.y, -size.height, size.height);
+    goal += ahead;
+    keep_in_bounds(goal);
+  }
+
+  m_prefetch_rect = Rectf(std::min(m_translation.x, goal.x),
+                          std::min(m_translation.y, goal.y),
+                          std::max(m_translation.x, goal.x) + size.width,
+                          std::max(m_translation.y, goal.y) + size.height);
 }
 
 void
@@ -676,6 +734,17 @@ Camera::update_scroll_to(float dt_sec)
   m_translation = m_scroll_from + (m_scroll_goal - m_scroll_from) * m_scroll_to_pos;
 }
 
+Vector
+Camera::get_interpolated_translation(float alpha) const
+{
+  const Vector delta = m_translation - m_previous_translation;
+  if (fabsf(delta.x) > static_cast<float>(m_screen_size.width) / 4.0f ||
+      fabsf(delta.y) > static_cast<float>(m_screen_size.height) / 4.0f) {
+    return m_translation;
+  }
+  return m_previous_translation + delta * alpha;
+}
+
 Vector
 Camera::get_center() const
 {
@@ -688,6 +757,7 @@ Camera::move(const int dx, const int dy)
 {
   m_translation.x += static_cast<float>(dx);
   m_translation.y += static_cast<float>(dy);
+  update_view_state(m_view.velocity);
 }
 
 bool
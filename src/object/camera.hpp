@@ -20,6 +20,7 @@
 #include <memory>
 #include <string>
 
+#include "math/rectf.hpp"
 #include "math/size.hpp"
 #include "math/vector.hpp"
 #include "object/path_object.hpp"
@@ -43,6 +44,23 @@ public:
     NORMAL, MANUAL, AUTOSCROLL, SCROLLTO
   };
 
+  /** What the camera shows, kept up to date whenever the translation
+      or the screen size changes, so objects culling, activating or
+      placing sounds against the view can just read it */
+  struct ViewState
+  {
+    ViewState() : translation(), center(), rect(), velocity() {}
+
+    Vector translation;
+    Vector center;
+
+    /** The visible area in sector coordinates */
+    Rectf rect;
+
+    /** Movement per second over the last update() */
+    Vector velocity;
+  };
+
 private:
   /** The camera basically provides lookahead on the left or right
       side or is undecided. */
@@ -80,7 +98,17 @@ public:
 
   /** return camera position */
   const Vector& get_translation() const;
-  void set_translation(const Vector& translation) { m_translation = translation; }
+  void set_translation(const Vector& translation);
+
+  const ViewState& get_view_state() const { return m_view; }
+
+  /** camera position alpha of the way from the last logic step to the
+      current one, jumps aren't interpolated */
+  Vector get_interpolated_translation(float alpha) const;
+
+  /** The view now plus where it is headed in the near future, work
+      for that area can be spread over the frames before it shows */
+  const Rectf& get_prefetch_rect() const { return m_prefetch_rect; }
 
   /** shake camera in a direction 1 time */
   void shake(float duration, float x, float y);
@@ -105,6 +133,8 @@ private:
   void update_scroll_to(float dt_sec);
   void keep_in_bounds(Vector& vector);
   void shake();
+  void update_prefetch_rect(float dt_sec);
+  void update_view_state(const Vector& velocity);
 
 private:
   Mode m_mode;
@@ -114,6 +144,13 @@ private:
 
   Vector m_translation;
 
+  /** m_translation before the last update() */
+  Vector m_previous_translation;
+
+  Rectf m_prefetch_rect;
+
+  ViewState m_view;
+
   // normal mode
   LookaheadMode m_lookahead_mode;
   float m_changetime;
@@ -20,15 +20,13 @@
 #include "video/surface.hpp"
 
 CloudParticleSystem::CloudParticleSystem() :
-  ParticleSystem(128),
-  cloudimage(Surface::from_file("images/particles/cloud.png"))
+  ParticleSystem(128)
 {
   init();
 }
 
 CloudParticleSystem::CloudParticleSystem(const ReaderMapping& reader) :
-  ParticleSystem(reader, 128),
-  cloudimage(Surface::from_file("images/particles/cloud.png"))
+  ParticleSystem(reader, 128)
 {
   init();
 }
@@ -39,30 +37,26 @@ CloudParticleSystem::~CloudParticleSystem()
 
 void CloudParticleSystem::init()
 {
+  textures.push_back(Surface::from_file("images/particles/cloud.png"));
+
   virtual_width = 2000.0;
 
   // create some random clouds
   for (size_t i=0; i<15; ++i) {
-    auto particle = std::make_unique<CloudParticle>();
-    particle->pos.x = graphicsRandom.randf(virtual_width);
-    particle->pos.y = graphicsRandom.randf(virtual_height);
-    particle->texture = cloudimage;
-    particle->speed = -graphicsRandom.randf(25.0, 54.0);
-
-    particles.push_back(std::move(particle));
+    Vector pos(graphicsRandom.randf(virtual_width),
+               graphicsRandom.randf(virtual_height));
+    add_particle(pos, -graphicsRandom.randf(25.0, 54.0), 0);
   }
 }
 
-void CloudParticleSystem::update(float dt_sec)
+void CloudParticleSystem::simulate(float dt_sec)
 {
-  if (!enabled)
-    return;
+  const size_t count = get_particle_count();
+  float* x = particle_x.data();
+  const float* speed = particle_speed.data();
 
-  for (auto& particle : particles) {
-    auto cloudParticle = dynamic_cast<CloudParticle*>(particle.get());
-    if (!cloudParticle)
-      continue;
-    cloudParticle->pos.x += cloudParticle->speed * dt_sec;
+  for (size_t i = 0; i < count; ++i) {
+    x[i] += speed[i] * dt_sec;
   }
 }
 
@@ -18,7 +18,6 @@
 #define HEADER_SUPERTUX_OBJECT_CLOUD_PARTICLE_SYSTEM_HPP
 
 #include "object/particlesystem.hpp"
-#include "video/surface_ptr.hpp"
 
 class ReaderMapping;
 
@@ -30,7 +29,6 @@ public:
   virtual ~CloudParticleSystem();
 
   void init();
-  virtual void update(float dt_sec) override;
 
   virtual std::string get_class() const override { return "particles-clouds"; }
   virtual std::string get_display_name() const override { return _("Cloud Particles"); }
@@ -39,18 +37,8 @@ public:
     return "images/engine/editor/clouds.png";
   }
 
-private:
-  class CloudParticle : public Particle
-  {
-  public:
-    float speed;
-
-    CloudParticle() :
-      speed()
-    {}
-  };
-
-  SurfacePtr cloudimage;
+protected:
+  virtual void simulate(float dt_sec) override;
 
 private:
   CloudParticleSystem(const CloudParticleSystem&) = delete;
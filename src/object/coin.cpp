@@ -19,7 +19,7 @@
 #include "audio/sound_manager.hpp"
 #include "audio/sound_source.hpp"
 #include "editor/editor.hpp"
-#include "object/bouncy_coin.hpp"
+#include "object/bouncy_coin_system.hpp"
 #include "object/player.hpp"
 #include "object/tilemap.hpp"
 #include "supertux/level.hpp"
@@ -89,6 +89,17 @@ Coin::update(float dt_sec)
   }
 }
 
+bool
+Coin::is_dormant(Vector& pos) const
+{
+  // only coins on a path do anything in update()
+  if (get_walker())
+    return false;
+
+  pos = m_col.m_bbox.get_middle();
+  return true;
+}
+
 void
 Coin::editor_update()
 {
@@ -170,7 +181,7 @@ Coin::collect()
   SoundManager::current()->manage_source(std::move(soundSource));
 
   Sector::get().get_player().get_status().add_coins(1, false);
-  Sector::get().add<BouncyCoin>(get_pos(), false, get_sprite_name());
+  Sector::get().get_bouncy_coins().add(get_pos(), false, get_sprite_name());
   Sector::get().get_level().m_stats.m_coins++;
   remove_me();
 
@@ -39,12 +39,14 @@ public:
   virtual HitResponse collision(GameObject& other, const CollisionHit& hit) override;
 
   virtual void update(float dt_sec) override;
+  virtual bool is_dormant(Vector& pos) const override;
   virtual std::string get_class() const override { return "coin"; }
   virtual std::string get_display_name() const override { return _("Coin"); }
 
   virtual ObjectSettings get_settings() override;
   virtual void after_editor_set() override;
   virtual void editor_update() override;
+  virtual bool has_editor_update() const override { return true; }
 
   virtual void move_to(const Vector& pos) override;
 
@@ -69,6 +71,7 @@ public:
   HeavyCoin(const ReaderMapping& reader);
 
   virtual void update(float dt_sec) override;
+  virtual bool is_dormant(Vector&) const override { return false; }
   virtual void collision_solid(const CollisionHit& hit) override;
 
   virtual std::string get_class() const override { return "heavycoin"; }
@@ -137,4 +137,14 @@ Decal::update(float)
   }
 }
 
+bool
+Decal::is_dormant(Vector& pos) const
+{
+  if (m_sprite_timer.started() || m_fade_timer.started())
+    return false;
+
+  pos = m_col.m_bbox.get_middle();
+  return true;
+}
+
 /* EOF */
@@ -43,6 +43,7 @@ public:
 
   virtual void draw(DrawingContext& context) override;
   virtual void update(float dt_sec) override;
+  virtual bool is_dormant(Vector& pos) const override;
 
   void fade_in(float fade_time);
   void fade_out(float fade_time);
@@ -23,9 +23,7 @@ Electrifier::Electrifier(TileChangeMap replacements, float seconds) :
   duration()
 {
   duration.start(seconds);
-  for (auto& tile : change_map) {
-    Sector::get().change_solid_tiles(tile.first, tile.second);
-  }
+  Sector::get().change_solid_tiles(std::vector<std::pair<uint32_t, uint32_t> >(change_map.begin(), change_map.end()));
 }
 
 Electrifier::Electrifier(uint32_t oldtile, uint32_t newtile, float seconds) :
@@ -33,18 +31,18 @@ Electrifier::Electrifier(uint32_t oldtile, uint32_t newtile, float seconds) :
   duration()
 {
   duration.start(seconds);
-  for (auto& tile : change_map) {
-    Sector::get().change_solid_tiles(tile.first, tile.second);
-  }
+  Sector::get().change_solid_tiles(std::vector<std::pair<uint32_t, uint32_t> >(change_map.begin(), change_map.end()));
 }
 
 void
 Electrifier::update(float )
 {
   if (duration.check()) {
-    for (const auto& tile : change_map){
-      Sector::get().change_solid_tiles(tile.second, tile.first);
+    std::vector<std::pair<uint32_t, uint32_t> > changes;
+    for (const auto& tile : change_map) {
+      changes.emplace_back(tile.second, tile.first);
     }
+    Sector::get().change_solid_tiles(changes);
     remove_me();
   }
 }
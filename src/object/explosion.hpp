@@ -18,12 +18,14 @@
 #define HEADER_SUPERTUX_OBJECT_EXPLOSION_HPP
 
 #include "object/moving_sprite.hpp"
+#include "util/object_pool.hpp"
 
 #define EXPLOSION_STRENGTH_DEFAULT (1464.8f * 32.0f * 32.0f)
 #define EXPLOSION_STRENGTH_NEAR (150.0f * 32.0f * 32.0f)
 
 /** Just your average explosion - goes boom, hurts Tux */
-class Explosion final : public MovingSprite
+class Explosion final : public MovingSprite,
+                        public PooledObject<Explosion>
 {
 public:
   /** Create new Explosion centered(!) at @c pos */
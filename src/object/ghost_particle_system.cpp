@@ -45,38 +45,40 @@ GhostParticleSystem::~GhostParticleSystem()
 void
 GhostParticleSystem::init()
 {
-  ghosts[0] = Surface::from_file("images/particles/ghost0.png");
-  ghosts[1] = Surface::from_file("images/particles/ghost1.png");
+  textures.push_back(Surface::from_file("images/particles/ghost0.png"));
+  textures.push_back(Surface::from_file("images/particles/ghost1.png"));
 
   virtual_width = static_cast<float>(SCREEN_WIDTH) * 2.0f;
 
   // create two ghosts
   size_t ghostcount = 2;
   for (size_t i=0; i<ghostcount; ++i) {
-    auto particle = std::make_unique<GhostParticle>();
-    particle->pos.x = graphicsRandom.randf(virtual_width);
-    particle->pos.y = graphicsRandom.randf(static_cast<float>(SCREEN_HEIGHT));
+    Vector pos(graphicsRandom.randf(virtual_width),
+               graphicsRandom.randf(static_cast<float>(SCREEN_HEIGHT)));
     int size = graphicsRandom.rand(2);
-    particle->texture = ghosts[size];
-    particle->speed = graphicsRandom.randf(std::max(50.0f, static_cast<float>(size) * 10.0f),
-                                           180.0f + static_cast<float>(size) * 10.0f);
-    particles.push_back(std::move(particle));
+    float speed = graphicsRandom.randf(std::max(50.0f, static_cast<float>(size) * 10.0f),
+                                       180.0f + static_cast<float>(size) * 10.0f);
+    add_particle(pos, speed, size);
   }
 }
 
 void
-GhostParticleSystem::update(float dt_sec)
+GhostParticleSystem::simulate(float dt_sec)
 {
-  if (!enabled)
-    return;
+  const size_t count = get_particle_count();
+  float* x = particle_x.data();
+  float* y = particle_y.data();
+  const float* speed = particle_speed.data();
 
-  for (const auto& part : particles) {
-    const auto& particle = dynamic_cast<GhostParticle*>(part.get());
-    particle->pos.y -= particle->speed * dt_sec;
-    particle->pos.x -= particle->speed * dt_sec;
-    if (particle->pos.y > static_cast<float>(SCREEN_HEIGHT)) {
-      particle->pos.y = fmodf(particle->pos.y , virtual_height);
-      particle->pos.x = graphicsRandom.randf(virtual_width);
+  for (size_t i = 0; i < count; ++i) {
+    y[i] -= speed[i] * dt_sec;
+    x[i] -= speed[i] * dt_sec;
+  }
+
+  for (size_t i = 0; i < count; ++i) {
+    if (y[i] > static_cast<float>(SCREEN_HEIGHT)) {
+      y[i] = fmodf(y[i] , virtual_height);
+      x[i] = random.randf(virtual_width);
     }
   }
 }
@@ -18,7 +18,6 @@
 #define HEADER_SUPERTUX_OBJECT_GHOST_PARTICLE_SYSTEM_HPP
 
 #include "object/particlesystem.hpp"
-#include "video/surface_ptr.hpp"
 
 class ReaderMapping;
 
@@ -30,7 +29,6 @@ public:
   virtual ~GhostParticleSystem();
 
   void init();
-  virtual void update(float dt_sec) override;
 
   virtual std::string get_class() const override { return "particles-ghosts"; }
   virtual std::string get_display_name() const override { return _("Ghost Particles"); }
@@ -39,18 +37,8 @@ public:
     return "images/engine/editor/ghostparticles.png";
   }
 
-private:
-  class GhostParticle : public Particle
-  {
-  public:
-    float speed;
-
-    GhostParticle() :
-      speed()
-    {}
-  };
-
-  SurfacePtr ghosts[2];
+protected:
+  virtual void simulate(float dt_sec) override;
 
 private:
   GhostParticleSystem(const GhostParticleSystem&) = delete;
@@ -34,7 +34,8 @@ LevelTime::LevelTime(const ReaderMapping& reader) :
   ExposedObject<LevelTime, scripting::LevelTime>(this),
   time_surface(Surface::from_file("images/engine/hud/time-0.png")),
   running(!Editor::is_active()),
-  time_left()
+  time_left(),
+  m_time_text()
 {
   reader.get("time", time_left, 0.0f);
   if (time_left <= 0 && !Editor::is_active()) {
@@ -81,18 +82,16 @@ LevelTime::draw(DrawingContext& context)
   context.set_translation(Vector(0, 0));
 
   if ((time_left > TIME_WARNING) || (int(g_game_time * 2.5f) % 2)) {
-    std::stringstream ss;
-    ss << int(time_left);
-    std::string time_text = ss.str();
+    m_time_text.set(Resources::normal_font, int(time_left));
 
     if (time_surface)
     {
-      float all_width = static_cast<float>(time_surface->get_width()) + Resources::normal_font->get_text_width(time_text);
+      float all_width = static_cast<float>(time_surface->get_width()) + m_time_text.get_width();
       context.color().draw_surface(time_surface,
                                    Vector((static_cast<float>(context.get_width()) - all_width) / 2.0f,
                                           BORDER_Y + 1),
                                    LAYER_FOREGROUND1);
-      context.color().draw_text(Resources::normal_font, time_text,
+      context.color().draw_text(Resources::normal_font, m_time_text.get_text(),
                                 Vector((static_cast<float>(context.get_width()) - all_width) / 2.0f + static_cast<float>(time_surface->get_width()),
                                        BORDER_Y),
                                 ALIGN_LEFT, LAYER_FOREGROUND1, LevelTime::text_color);
@@ -21,6 +21,7 @@
 #include "scripting/level_time.hpp"
 #include "supertux/game_object.hpp"
 #include "video/color.hpp"
+#include "video/number_text.hpp"
 #include "video/surface_ptr.hpp"
 
 class ReaderMapping;
@@ -62,6 +63,7 @@ private:
   SurfacePtr time_surface;
   bool running;
   float time_left;
+  NumberText m_time_text;
 
 private:
   LevelTime(const LevelTime&) = delete;
@@ -17,12 +17,12 @@
 #include "object/moving_sprite.hpp"
 
 #include <math.h>
-#include <physfs.h>
 
 #include "editor/editor.hpp"
 #include "math/random.hpp"
 #include "math/util.hpp"
 #include "object/sprite_particle.hpp"
+#include "physfs/util.hpp"
 #include "sprite/sprite_manager.hpp"
 #include "supertux/sector.hpp"
 #include "util/reader_mapping.hpp"
@@ -69,7 +69,7 @@ MovingSprite::MovingSprite(const ReaderMapping& reader, const std::string& sprit
   reader.get("sprite", m_sprite_name);
 
   //Make the sprite go default when the sprite file is invalid
-  if (m_sprite_name.empty() || !PHYSFS_exists(m_sprite_name.c_str())) {
+  if (m_sprite_name.empty() || !physfsutil::exists_cached(m_sprite_name)) {
     m_sprite = SpriteManager::current()->create(m_default_sprite_name);
   } else {
     m_sprite = SpriteManager::current()->create(m_sprite_name);
@@ -121,6 +121,13 @@ MovingSprite::set_action(const std::string& action, int loops)
   m_col.set_size(m_sprite->get_current_hitbox_width(), m_sprite->get_current_hitbox_height());
 }
 
+void
+MovingSprite::set_action(const ActionId& action, int loops)
+{
+  m_sprite->set_action(action, loops);
+  m_col.set_size(m_sprite->get_current_hitbox_width(), m_sprite->get_current_hitbox_height());
+}
+
 void
 MovingSprite::set_action_centered(const std::string& action, int loops)
 {
@@ -61,6 +61,7 @@ protected:
   /** set new action for sprite and resize bounding box.  use with
       care as you can easily get stuck when resizing the bounding box. */
   void set_action(const std::string& action, int loops);
+  void set_action(const ActionId& action, int loops);
 
   /** set new action for sprite and re-center bounding box.  use with
       care as you can easily get stuck when resizing the bounding
@@ -16,6 +16,7 @@
 
 #include "object/particles.hpp"
 
+#include <algorithm>
 #include <math.h>
 
 #include "math/random.hpp"
@@ -46,20 +47,21 @@ Particles::Particles(const Vector& epicenter, int min_angle, int max_angle,
   }
 
   // create particles
+  particles.reserve(number);
   for (int p = 0; p < number; p++)
   {
-    auto particle = std::make_unique<Particle>();
-    particle->pos = epicenter;
+    Particle particle;
+    particle.pos = epicenter;
 
     float angle = math::radians(graphicsRandom.randf(static_cast<float>(min_angle), static_cast<float>(max_angle)));
-    particle->vel.x = /*fabs*/(sinf(angle)) * initial_velocity.x;
+    particle.vel.x = /*fabs*/(sinf(angle)) * initial_velocity.x;
     //    if(angle >= math::PI && angle < math::TAU)
     //      particle->vel.x *= -1;  // work around to fix signal
-    particle->vel.y = /*fabs*/(cosf(angle)) * initial_velocity.y;
+    particle.vel.y = /*fabs*/(cosf(angle)) * initial_velocity.y;
     //    if(angle >= math::PI_2 && angle < 3*math::PI_2)
     //      particle->vel.y *= -1;
 
-    particles.push_back(std::move(particle));
+    particles.push_back(particle);
   }
 }
 
@@ -84,10 +86,11 @@ Particles::Particles(const Vector& epicenter, int min_angle, int max_angle,
   }
 
   // create particles
+  particles.reserve(number);
   for (int p = 0; p < number; p++)
   {
-    auto particle = std::make_unique<Particle>();
-    particle->pos = epicenter;
+    Particle particle;
+    particle.pos = epicenter;
 
     float velocity = (min_initial_velocity == max_initial_velocity) ? min_initial_velocity :
                      graphicsRandom.randf(min_initial_velocity, max_initial_velocity);
@@ -95,10 +98,10 @@ Particles::Particles(const Vector& epicenter, int min_angle, int max_angle,
       math::radians(static_cast<float>(min_angle)) :
       math::radians(graphicsRandom.randf(static_cast<float>(min_angle), static_cast<float>(max_angle)));
     // Note that angle defined as clockwise from vertical (up is zero degrees, right is 90 degrees)
-    particle->vel.x = (sinf(angle)) * velocity;
-    particle->vel.y = (-cosf(angle)) * velocity;
+    particle.vel.x = (sinf(angle)) * velocity;
+    particle.vel.y = (-cosf(angle)) * velocity;
 
-    particles.push_back(std::move(particle));
+    particles.push_back(particle);
   }
 }
 
@@ -108,20 +111,19 @@ Particles::update(float dt_sec)
   Vector camera = Sector::get().get_camera().get_translation();
 
   // update particles
-  for (auto i = particles.begin(); i != particles.end(); ) {
-    (*i)->pos.x += (*i)->vel.x * dt_sec;
-    (*i)->pos.y += (*i)->vel.y * dt_sec;
-
-    (*i)->vel.x += accel.x * dt_sec;
-    (*i)->vel.y += accel.y * dt_sec;
-
-    if ((*i)->pos.x < camera.x || (*i)->pos.x > static_cast<float>(SCREEN_WIDTH) + camera.x ||
-       (*i)->pos.y < camera.y || (*i)->pos.y > static_cast<float>(SCREEN_HEIGHT) + camera.y) {
-      i = particles.erase(i);
-    } else {
-      ++i;
-    }
-  }
+  particles.erase(
+    std::remove_if(particles.begin(), particles.end(),
+                   [this, &camera, dt_sec](Particle& particle) {
+                     particle.pos.x += particle.vel.x * dt_sec;
+                     particle.pos.y += particle.vel.y * dt_sec;
+
+                     particle.vel.x += accel.x * dt_sec;
+                     particle.vel.y += accel.y * dt_sec;
+
+                     return (particle.pos.x < camera.x || particle.pos.x > static_cast<float>(SCREEN_WIDTH) + camera.x ||
+                             particle.pos.y < camera.y || particle.pos.y > static_cast<float>(SCREEN_HEIGHT) + camera.y);
+                   }),
+    particles.end());
 
   if ((timer.check() && !live_forever) || particles.size() == 0)
     remove_me();
@@ -131,8 +133,8 @@ void
 Particles::draw(DrawingContext& context)
 {
   // draw particles
-  for (auto& particle : particles) {
-    context.color().draw_filled_rect(Rectf(particle->pos, Sizef(size,size)), color, drawing_layer);
+  for (const auto& particle : particles) {
+    context.color().draw_filled_rect(Rectf(particle.pos, Sizef(size,size)), color, drawing_layer);
   }
 }
 
@@ -17,14 +17,16 @@
 #ifndef HEADER_SUPERTUX_OBJECT_PARTICLES_HPP
 #define HEADER_SUPERTUX_OBJECT_PARTICLES_HPP
 
-#include <memory>
+#include <vector>
 
 #include "math/vector.hpp"
 #include "supertux/game_object.hpp"
 #include "supertux/timer.hpp"
+#include "util/object_pool.hpp"
 #include "video/color.hpp"
 
-class Particles final : public GameObject
+class Particles final : public GameObject,
+                        public PooledObject<Particles>
 {
 public:
   Particles(const Vector& epicenter, int min_angle, int max_angle,
@@ -62,7 +64,7 @@ private:
   float size;
   int drawing_layer;
 
-  std::vector<std::unique_ptr<Particle> > particles;
+  std::vector<Particle> particles;
 };
 
 #endif
@@ -16,6 +16,7 @@
 
 #include "object/particlesystem.hpp"
 
+#include <assert.h>
 #include <math.h>
 
 #include "supertux/globals.hpp"
@@ -33,10 +34,18 @@ ParticleSystem::ParticleSystem(const ReaderMapping& reader, float max_particle_s
   ExposedObject<ParticleSystem, scripting::ParticleSystem>(this),
   max_particle_size(max_particle_size_),
   z_pos(LAYER_BACKGROUND1),
-  particles(),
+  textures(),
+  particle_x(),
+  particle_y(),
+  particle_angle(),
+  particle_speed(),
+  particle_texture(),
   virtual_width(static_cast<float>(SCREEN_WIDTH) + max_particle_size * 2.0f),
   virtual_height(static_cast<float>(SCREEN_HEIGHT) + max_particle_size * 2.0f),
-  enabled(true)
+  enabled(true),
+  random(graphicsRandom.split()),
+  simulation_dt(0.0f),
+  simulation_pending(false)
 {
   reader.get("enabled", enabled, true);
   z_pos = reader_get_layer(reader, LAYER_BACKGROUND1);
@@ -47,10 +56,18 @@ ParticleSystem::ParticleSystem(float max_particle_size_) :
   ExposedObject<ParticleSystem, scripting::ParticleSystem>(this),
   max_particle_size(max_particle_size_),
   z_pos(LAYER_BACKGROUND1),
-  particles(),
+  textures(),
+  particle_x(),
+  particle_y(),
+  particle_angle(),
+  particle_speed(),
+  particle_texture(),
   virtual_width(static_cast<float>(SCREEN_WIDTH) + max_particle_size * 2.0f),
   virtual_height(static_cast<float>(SCREEN_HEIGHT) + max_particle_size * 2.0f),
-  enabled(true)
+  enabled(true),
+  random(graphicsRandom.split()),
+  simulation_dt(0.0f),
+  simulation_pending(false)
 {
 }
 
@@ -73,9 +90,34 @@ ParticleSystem::~ParticleSystem()
 {
 }
 
+void
+ParticleSystem::update(float dt_sec)
+{
+  if (!enabled)
+    return;
+
+  // updated twice without getting simulated in between
+  run_simulation();
+
+  simulation_dt = dt_sec;
+  simulation_pending = true;
+}
+
+void
+ParticleSystem::run_simulation()
+{
+  if (!simulation_pending)
+    return;
+
+  simulation_pending = false;
+  simulate(simulation_dt);
+}
+
 void
 ParticleSystem::draw(DrawingContext& context)
 {
+  run_simulation();
+
   if (!enabled)
     return;
 
@@ -85,45 +127,62 @@ ParticleSystem::draw(DrawingContext& context)
   context.push_transform();
   context.set_translation(Vector(max_particle_size,max_particle_size));
 
-  std::unordered_map<SurfacePtr, SurfaceBatch> batches;
-  for (const auto& particle : particles)
+  std::vector<SurfaceBatch> batches;
+  std::vector<float> widths;
+  batches.reserve(textures.size());
+  widths.reserve(textures.size());
+  for (const auto& texture : textures) {
+    batches.emplace_back(texture);
+    widths.push_back(static_cast<float>(texture->get_width()));
+  }
+
+  for (size_t i = 0; i < particle_x.size(); ++i)
   {
     // remap x,y coordinates onto screencoordinates
     Vector pos;
 
     // horizontal wrap when particle goes off screen to the left
-    const int particle_width = particle->texture->get_width();
-    pos.x = fmodf(particle->pos.x - scrollx, virtual_width);
-    if ((pos.x + static_cast<float>(particle_width)) < 0) pos.x += virtual_width;
+    const int texture = particle_texture[i];
+    pos.x = fmodf(particle_x[i] - scrollx, virtual_width);
+    if ((pos.x + widths[texture]) < 0) pos.x += virtual_width;
 
-    pos.y = fmodf(particle->pos.y - scrolly, virtual_height);
+    pos.y = fmodf(particle_y[i] - scrolly, virtual_height);
     if (pos.y < 0) pos.y += virtual_height;
 
     //if(pos.x > virtual_width) pos.x -= virtual_width;
     //if(pos.y > virtual_height) pos.y -= virtual_height;
 
-    auto it = batches.find(particle->texture);
-    if (it == batches.end()) {
-      const auto& batch_it = batches.emplace(particle->texture, SurfaceBatch(particle->texture));
-      batch_it.first->second.draw(pos, particle->angle);
-    } else {
-      it->second.draw(pos, particle->angle);
-    }
+    batches[texture].draw(pos, particle_angle[i]);
   }
 
-  for(auto& it : batches) {
-    auto& surface = it.first;
-    auto& batch = it.second;
-    context.color().draw_surface_batch(surface,
-                                       batch.move_srcrects(),
-                                       batch.move_dstrects(),
-                                       batch.move_angles(),
+  for (size_t i = 0; i < batches.size(); ++i) {
+    auto dstrects = batches[i].move_dstrects();
+    if (dstrects.empty())
+      continue;
+
+    context.color().draw_surface_batch(textures[i],
+                                       batches[i].move_srcrects(),
+                                       std::move(dstrects),
+                                       batches[i].move_angles(),
                                        Color::WHITE, z_pos);
   }
 
   context.pop_transform();
 }
 
+size_t
+ParticleSystem::add_particle(const Vector& pos, float speed, int texture, float angle)
+{
+  assert(texture >= 0 && static_cast<size_t>(texture) < textures.size());
+
+  particle_x.push_back(pos.x);
+  particle_y.push_back(pos.y);
+  particle_angle.push_back(angle);
+  particle_speed.push_back(speed);
+  particle_texture.push_back(static_cast<uint16_t>(texture));
+  return particle_x.size() - 1;
+}
+
 void
 ParticleSystem::set_enabled(bool enabled_)
 {
@@ -17,8 +17,10 @@
 #ifndef HEADER_SUPERTUX_OBJECT_PARTICLESYSTEM_HPP
 #define HEADER_SUPERTUX_OBJECT_PARTICLESYSTEM_HPP
 
+#include <stdint.h>
 #include <vector>
 
+#include "math/random.hpp"
 #include "math/vector.hpp"
 #include "squirrel/exposed_object.hpp"
 #include "scripting/particlesystem.hpp"
@@ -41,7 +43,10 @@ class ReaderMapping;
 
   Classes that implement a particle system should subclass from this
   class, initialize particles in the constructor and move them in the
-  simulate function.
+  simulate function. Particles are stored as structure of arrays, so
+  simulate() can run over them in tight loops, subclasses keep their
+  own per-particle values in arrays with the same indices. simulate() can run on a worker thread, anything
+  it needs from the rest of the world has to be fetched in update().
  */
 class ParticleSystem : public GameObject,
                        public ExposedObject<ParticleSystem, scripting::ParticleSystem>
@@ -51,8 +56,17 @@ public:
   ParticleSystem(float max_particle_size = 60);
   virtual ~ParticleSystem();
 
+  /** Queues the particle movement, subclasses fetch what simulate()
+      needs before calling this */
+  virtual void update(float dt_sec) override;
   virtual void draw(DrawingContext& context) override;
 
+  /** Moves the particles if update() queued it. Only touches the
+      particle system itself, so the Sector runs it on a worker thread,
+      during the collisions unless it reads the solid tilemaps. draw()
+      catches up if nobody did. */
+  void run_simulation();
+
   virtual std::string get_class() const override { return "particle-system"; }
   virtual std::string get_display_name() const override { return _("Particle system"); }
   virtual ObjectSettings get_settings() override;
@@ -63,36 +77,39 @@ public:
   int get_layer() const { return z_pos; }
 
 protected:
-  class Particle
-  {
-  public:
-    Particle() :
-      pos(),
-      angle(),
-      texture()
-    {}
-
-    virtual ~Particle()
-    {}
-
-    Vector pos;
-    // angle at which to draw particle
-    float angle;
-    SurfacePtr texture;
-
-  private:
-    Particle(const Particle&) = delete;
-    Particle& operator=(const Particle&) = delete;
-  };
+  /** Moves the particles, must not touch anything outside of the
+      particle system, e.g. graphicsRandom or the Sector */
+  virtual void simulate(float dt_sec) = 0;
+
+  /** Appends a particle drawn with textures[texture], returns its index */
+  size_t add_particle(const Vector& pos, float speed, int texture, float angle = 0.0f);
+
+  size_t get_particle_count() const { return particle_x.size(); }
 
 protected:
   float max_particle_size;
   int z_pos;
-  std::vector<std::unique_ptr<Particle> > particles;
+
+  std::vector<SurfacePtr> textures;
+
+  std::vector<float> particle_x;
+  std::vector<float> particle_y;
+  // angle at which to draw particle
+  std::vector<float> particle_angle;
+  std::vector<float> particle_speed;
+  std::vector<uint16_t> particle_texture;
+
   float virtual_width;
   float virtual_height;
   bool enabled;
 
+  /** for use in simulate(), graphicsRandom isn't thread safe */
+  FastRandom random;
+
+private:
+  float simulation_dt;
+  bool simulation_pending;
+
 private:
   ParticleSystem(const ParticleSystem&) = delete;
   ParticleSystem& operator=(const ParticleSystem&) = delete;
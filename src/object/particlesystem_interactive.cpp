@@ -32,7 +32,8 @@
 //      Add an option to set rain strength
 //      Fix rain being "respawned" over solid tiles
 ParticleSystem_Interactive::ParticleSystem_Interactive() :
-  ParticleSystem()
+  ParticleSystem(),
+  solid_tilemaps()
 {
   virtual_width = static_cast<float>(SCREEN_WIDTH);
   virtual_height = static_cast<float>(SCREEN_HEIGHT);
@@ -42,7 +43,8 @@ ParticleSystem_Interactive::ParticleSystem_Interactive() :
 }
 
 ParticleSystem_Interactive::ParticleSystem_Interactive(const ReaderMapping& mapping) :
-  ParticleSystem(mapping)
+  ParticleSystem(mapping),
+  solid_tilemaps()
 {
   virtual_width = static_cast<float>(SCREEN_WIDTH);
   virtual_height = static_cast<float>(SCREEN_HEIGHT);
@@ -55,39 +57,51 @@ ParticleSystem_Interactive::~ParticleSystem_Interactive()
 {
 }
 
+void
+ParticleSystem_Interactive::update(float dt_sec)
+{
+  if (!enabled)
+    return;
+
+  solid_tilemaps = Sector::get().get_solid_tilemaps();
+  ParticleSystem::update(dt_sec);
+}
+
 void
 ParticleSystem_Interactive::draw(DrawingContext& context)
 {
+  run_simulation();
+
   if (!enabled)
     return;
 
   context.push_transform();
 
-  std::unordered_map<SurfacePtr, SurfaceBatch> batches;
-  for (const auto& particle : particles) {
-    auto it = batches.find(particle->texture);
-    if (it == batches.end()) {
-      const auto& batch_it = batches.emplace(particle->texture,
-        SurfaceBatch(particle->texture));
-      batch_it.first->second.draw(particle->pos);
-    } else {
-      it->second.draw(particle->pos);
-    }
+  std::vector<SurfaceBatch> batches;
+  batches.reserve(textures.size());
+  for (const auto& texture : textures) {
+    batches.emplace_back(texture);
+  }
+
+  for (size_t i = 0; i < particle_x.size(); ++i) {
+    batches[particle_texture[i]].draw(Vector(particle_x[i], particle_y[i]));
   }
 
-  for(auto& it : batches) {
-    auto& surface = it.first;
-    auto& batch = it.second;
+  for (size_t i = 0; i < batches.size(); ++i) {
+    auto dstrects = batches[i].move_dstrects();
+    if (dstrects.empty())
+      continue;
+
     // FIXME: What is the colour used for?
-    context.color().draw_surface_batch(surface, batch.move_srcrects(),
-      batch.move_dstrects(), Color::WHITE, z_pos);
+    context.color().draw_surface_batch(textures[i], batches[i].move_srcrects(),
+      std::move(dstrects), Color::WHITE, z_pos);
   }
 
   context.pop_transform();
 }
 
 int
-ParticleSystem_Interactive::collision(Particle* object, const Vector& movement)
+ParticleSystem_Interactive::collision(const Vector& pos, const Vector& movement)
 {
   using namespace collision;
 
@@ -95,18 +109,18 @@ ParticleSystem_Interactive::collision(Particle* object, const Vector& movement)
   float x1, x2;
   float y1, y2;
 
-  x1 = object->pos.x;
+  x1 = pos.x;
   x2 = x1 + 32 + movement.x;
   if (x2 < x1) {
     x1 = x2;
-    x2 = object->pos.x;
+    x2 = pos.x;
   }
 
-  y1 = object->pos.y;
+  y1 = pos.y;
   y2 = y1 + 32 + movement.y;
   if (y2 < y1) {
     y1 = y2;
-    y2 = object->pos.y;
+    y2 = pos.y;
   }
   bool water = false;
 
@@ -120,30 +134,46 @@ ParticleSystem_Interactive::collision(Particle* object, const Vector& movement)
   dest.move(movement);
   Constraints constraints;
 
-  for (const auto& solids : Sector::get().get_solid_tilemaps()) {
+  for (const auto& solids : solid_tilemaps) {
+    auto test_tile = [&](int x, int y) {
+      const Tile& tile = solids->get_tile(x, y);
+
+      // skip non-solid tiles, except water
+      if (! (tile.get_attributes() & (Tile::WATER | Tile::SOLID)))
+        return true;
+
+      Rectf rect = solids->get_tile_bbox(x, y);
+      if (tile.is_slope ()) { // slope tile
+        AATriangle triangle = AATriangle(rect, tile.get_data());
+
+        if (rectangle_aatriangle(&constraints, dest, triangle)) {
+          if (tile.get_attributes() & Tile::WATER)
+            water = true;
+        }
+      } else { // normal rectangular tile
+        if (intersects(dest, rect)) {
+          if (tile.get_attributes() & Tile::WATER)
+            water = true;
+          set_rectangle_rectangle_constraints(&constraints, dest, rect);
+        }
+      }
+      return true;
+    };
+
     // FIXME Handle a nonzero tilemap offset
-    for (int x = starttilex; x*32 < max_x; ++x) {
-      for (int y = starttiley; y*32 < max_y; ++y) {
-        const Tile& tile = solids->get_tile(x, y);
-
-        // skip non-solid tiles, except water
-        if (! (tile.get_attributes() & (Tile::WATER | Tile::SOLID)))
-          continue;
-
-        Rectf rect = solids->get_tile_bbox(x, y);
-        if (tile.is_slope ()) { // slope tile
-          AATriangle triangle = AATriangle(rect, tile.get_data());
-
-          if (rectangle_aatriangle(&constraints, dest, triangle)) {
-            if (tile.get_attributes() & Tile::WATER)
-              water = true;
-          }
-        } else { // normal rectangular tile
-          if (intersects(dest, rect)) {
-            if (tile.get_attributes() & Tile::WATER)
-              water = true;
-            set_rectangle_rectangle_constraints(&constraints, dest, rect);
-          }
+    const Rect cells(starttilex, starttiley, (max_x + 31) / 32, (max_y + 31) / 32);
+    if (cells.left >= 0 && cells.top >= 0 &&
+        cells.right <= solids->get_width() && cells.bottom <= solids->get_height())
+    {
+      // the usual case, only the solid and water cells get looked at
+      solids->get_attribute_plane().for_each_solid_or_water(cells, test_tile);
+    }
+    else
+    {
+      // get_tile() repeats the border tiles outside of the tilemap
+      for (int x = starttilex; x*32 < max_x; ++x) {
+        for (int y = starttiley; y*32 < max_y; ++y) {
+          test_tile(x, y);
         }
       }
     }
@@ -167,4 +197,22 @@ ParticleSystem_Interactive::collision(Particle* object, const Vector& movement)
   }
 }
 
+void
+ParticleSystem_Interactive::collision(const float* x, const float* y, const float* movement,
+                                      const Vector& direction, size_t count,
+                                      std::vector<ParticleHit>& hits)
+{
+  hits.clear();
+  if (solid_tilemaps.empty())
+    return;
+
+  for (size_t i = 0; i < count; ++i)
+  {
+    const int type = collision(Vector(x[i], y[i]), direction * movement[i]);
+    if (type >= 0) {
+      hits.push_back({ i, type });
+    }
+  }
+}
+
 /* EOF */
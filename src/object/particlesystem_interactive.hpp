@@ -19,6 +19,7 @@
 
 #include "object/particlesystem.hpp"
 
+class TileMap;
 class Vector;
 
 /**
@@ -43,13 +44,37 @@ public:
   ParticleSystem_Interactive(const ReaderMapping& mapping);
   virtual ~ParticleSystem_Interactive();
 
+  virtual void update(float dt_sec) override;
   virtual void draw(DrawingContext& context) override;
   virtual std::string get_display_name() const override {
     return _("Interactive particle system");
   }
 
 protected:
-  int collision(Particle* particle, const Vector& movement);
+  struct ParticleHit
+  {
+    size_t index;
+
+    /** The result of collision() */
+    int type;
+  };
+
+protected:
+  /** Checks a particle at pos against the solid tilemaps fetched in
+      update() */
+  int collision(const Vector& pos, const Vector& movement);
+
+  /** Checks count particles at once, particle i moves by
+      direction * movement[i]. Only the particles that hit something
+      end up in hits, in order of their index. */
+  void collision(const float* x, const float* y, const float* movement,
+                 const Vector& direction, size_t count,
+                 std::vector<ParticleHit>& hits);
+
+private:
+  /** Copy of the Sector's list, which might change while simulate() runs.
+      The tilemaps themselves stay alive until the simulation is done. */
+  std::vector<TileMap*> solid_tilemaps;
 
 private:
   ParticleSystem_Interactive(const ParticleSystem_Interactive&) = delete;
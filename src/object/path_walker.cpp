@@ -36,7 +36,10 @@ PathWalker::PathWalker(UID path_uid, bool running_) :
   m_stop_at_node_nr(m_running?-1:0),
   m_node_time(0),
   m_node_mult(),
-  m_walking_speed(1.0)
+  m_walking_speed(1.0),
+  m_cached_path(nullptr),
+  m_cached_sector(nullptr),
+  m_cached_generation(0)
 {
   Path* path = get_path();
   if (!path) return;
@@ -55,15 +58,18 @@ PathWalker::get_path() const
 {
   if (!d_sector) return nullptr;
 
-  auto path_gameobject = d_sector->get_object_by_uid<PathGameObject>(m_path_uid);
-  if (!path_gameobject)
-  {
-    return nullptr;
-  }
-  else
+  if (m_cached_path &&
+      m_cached_sector == d_sector.get() &&
+      m_cached_generation == GameObjectManager::get_removal_generation())
   {
-    return &path_gameobject->get_path();
+    return m_cached_path;
   }
+
+  auto path_gameobject = d_sector->get_object_by_uid<PathGameObject>(m_path_uid);
+  m_cached_path = path_gameobject ? &path_gameobject->get_path() : nullptr;
+  m_cached_sector = d_sector.get();
+  m_cached_generation = GameObjectManager::get_removal_generation();
+  return m_cached_path;
 }
 
 void
@@ -19,11 +19,13 @@
 
 #include <string.h>
 #include <memory>
+#include <stdint.h>
 
 #include "object/path.hpp"
 #include "util/uid.hpp"
 
 class ObjectOption;
+class Sector;
 
 /** A walker that travels along a path */
 class PathWalker final
@@ -75,6 +77,12 @@ private:
 
   float m_walking_speed;
 
+  /** The path is looked up by UID several times per frame, the
+      result stays valid until any object gets removed */
+  mutable Path* m_cached_path;
+  mutable const Sector* m_cached_sector;
+  mutable uint32_t m_cached_generation;
+
 private:
   PathWalker(const PathWalker&) = delete;
   PathWalker& operator=(const PathWalker&) = delete;
@@ -355,11 +355,17 @@ Player::update(float dt_sec)
   // extend/shrink tux collision rectangle so that we fall through/walk over 1
   // tile holes
 
-  Rectf lookahead = get_bbox();
-  lookahead.set_right(lookahead.get_left() + 62);
-  bool pathBlocked = !Sector::get().is_free_of_statics(lookahead);
+  // only big Tux in water turns sideways to fit, so only then the
+  // space ahead needs to be checked
+  const bool big_swimming = (m_swimming || m_water_jump) && is_big();
+  bool pathBlocked = false;
+  if (big_swimming) {
+    Rectf lookahead = get_bbox();
+    lookahead.set_right(lookahead.get_left() + 62);
+    pathBlocked = !Sector::get().is_free_of_statics(lookahead);
+  }
 
-  if((m_swimming || m_water_jump) && is_big() && !pathBlocked)
+  if(big_swimming && !pathBlocked)
   {
     switch (m_dir)
     {
@@ -876,9 +882,9 @@ Player::do_jump(float yspeed) {
 
   // play sound
   if (is_big()) {
-    SoundManager::current()->play("sounds/bigjump.wav");
+    SoundManager::current()->play("sounds/bigjump.wav", 0.5f, SoundManager::PRIORITY_HIGH);
   } else {
-    SoundManager::current()->play("sounds/jump.wav");
+    SoundManager::current()->play("sounds/jump.wav", 0.5f, SoundManager::PRIORITY_HIGH);
   }
 }
 
@@ -1751,7 +1757,7 @@ Player::kill(bool completely)
   m_lightsprite->set_angle(0.0f);
 
   if (!completely && is_big()) {
-    SoundManager::current()->play("sounds/hurt.wav");
+    SoundManager::current()->play("sounds/hurt.wav", 0.5f, SoundManager::PRIORITY_HIGH);
 
     if (m_player_status.bonus == FIRE_BONUS
       || m_player_status.bonus == ICE_BONUS
@@ -1766,7 +1772,7 @@ Player::kill(bool completely)
       set_bonus(NO_BONUS, true);
     }
   } else {
-    SoundManager::current()->play("sounds/kill.wav");
+    SoundManager::current()->play("sounds/kill.wav", 0.5f, SoundManager::PRIORITY_HIGH);
 
     // do not die when in edit mode
     if (m_edit_mode) {
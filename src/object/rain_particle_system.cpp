@@ -16,8 +16,6 @@
 
 #include "object/rain_particle_system.hpp"
 
-#include <assert.h>
-
 #include "math/random.hpp"
 #include "object/camera.hpp"
 #include "object/rainsplash.hpp"
@@ -26,13 +24,23 @@
 #include "video/video_system.hpp"
 #include "video/viewport.hpp"
 
-RainParticleSystem::RainParticleSystem()
+RainParticleSystem::RainParticleSystem() :
+  gravity(),
+  camera_translation(),
+  splashes(),
+  movements(),
+  hits()
 {
   init();
 }
 
 RainParticleSystem::RainParticleSystem(const ReaderMapping& reader) :
-  ParticleSystem_Interactive(reader)
+  ParticleSystem_Interactive(reader),
+  gravity(),
+  camera_translation(),
+  splashes(),
+  movements(),
+  hits()
 {
   init();
 }
@@ -43,66 +51,89 @@ RainParticleSystem::~RainParticleSystem()
 
 void RainParticleSystem::init()
 {
-  rainimages[0] = Surface::from_file("images/particles/rain0.png");
-  rainimages[1] = Surface::from_file("images/particles/rain1.png");
+  textures.push_back(Surface::from_file("images/particles/rain0.png"));
+  textures.push_back(Surface::from_file("images/particles/rain1.png"));
 
   virtual_width = static_cast<float>(SCREEN_WIDTH) * 2.0f;
 
   // create some random raindrops
   size_t raindropcount = size_t(virtual_width/6.0f);
   for (size_t i=0; i<raindropcount; ++i) {
-    auto particle = std::make_unique<RainParticle>();
-    particle->pos.x = static_cast<float>(graphicsRandom.rand(int(virtual_width)));
-    particle->pos.y = static_cast<float>(graphicsRandom.rand(int(virtual_height)));
+    Vector pos(static_cast<float>(graphicsRandom.rand(int(virtual_width))),
+               static_cast<float>(graphicsRandom.rand(int(virtual_height))));
     int rainsize = graphicsRandom.rand(2);
-    particle->texture = rainimages[rainsize];
+    float speed;
     do {
-      particle->speed = (static_cast<float>(rainsize) + 1.0f) * 45.0f + graphicsRandom.randf(3.6f);
-    } while(particle->speed < 1);
+      speed = (static_cast<float>(rainsize) + 1.0f) * 45.0f + graphicsRandom.randf(3.6f);
+    } while(speed < 1);
 
-    particles.push_back(std::move(particle));
+    add_particle(pos, speed, rainsize);
   }
 }
 
 void RainParticleSystem::update(float dt_sec)
 {
-  if (!enabled)
-    return;
-
-  for (auto& it : particles) {
-    auto particle = dynamic_cast<RainParticle*>(it.get());
-    assert(particle);
-
-    float movement = particle->speed * dt_sec * Sector::get().get_gravity();
-    float abs_x = Sector::get().get_camera().get_translation().x;
-    float abs_y = Sector::get().get_camera().get_translation().y;
-    particle->pos.y += movement;
-    particle->pos.x -= movement;
-    int col = collision(particle, Vector(-movement, movement));
-    if ((particle->pos.y > static_cast<float>(SCREEN_HEIGHT) + abs_y) || (col >= 0)) {
+  for (const auto& pos : splashes) {
+    Sector::get().add<RainSplash>(pos, false);
+  }
+  splashes.clear();
+
+  gravity = Sector::get().get_gravity();
+  camera_translation = Sector::get().get_camera().get_translation();
+  ParticleSystem_Interactive::update(dt_sec);
+}
+
+void RainParticleSystem::simulate(float dt_sec)
+{
+  const size_t count = get_particle_count();
+  float* x = particle_x.data();
+  float* y = particle_y.data();
+  const float* speed = particle_speed.data();
+
+  const float abs_x = camera_translation.x;
+  const float abs_y = camera_translation.y;
+  const float bottom = static_cast<float>(SCREEN_HEIGHT) + abs_y;
+
+  movements.resize(count);
+  for (size_t i = 0; i < count; ++i) {
+    const float movement = speed[i] * dt_sec * gravity;
+    movements[i] = movement;
+    y[i] += movement;
+    x[i] -= movement;
+  }
+
+  collision(x, y, movements.data(), Vector(-1.0f, 1.0f), count, hits);
+
+  size_t next_hit = 0;
+  for (size_t i = 0; i < count; ++i) {
+    int col = -1;
+    if (next_hit < hits.size() && hits[next_hit].index == i) {
+      col = hits[next_hit].type;
+      next_hit += 1;
+    }
+    if ((y[i] > bottom) || (col >= 0)) {
       //Create rainsplash
-      if ((particle->pos.y <= static_cast<float>(SCREEN_HEIGHT) + abs_y) && (col >= 1)){
+      if ((y[i] <= bottom) && (col >= 1)){
         bool vertical = (col == 2);
         if (!vertical) { //check if collision happened from above
           int splash_x, splash_y; // move outside if statement when
                                   // uncommenting the else statement below.
-          splash_x = int(particle->pos.x);
-          splash_y = int(particle->pos.y) - (int(particle->pos.y) % 32) + 32;
-          Sector::get().add<RainSplash>(Vector(static_cast<float>(splash_x), static_cast<float>(splash_y)),
-                                             vertical);
+          splash_x = int(x[i]);
+          splash_y = int(y[i]) - (int(y[i]) % 32) + 32;
+          splashes.push_back(Vector(static_cast<float>(splash_x), static_cast<float>(splash_y)));
         }
         // Uncomment the following to display vertical splashes, too
         /* else {
-           splash_x = int(particle->pos.x) - (int(particle->pos.x) % 32) + 32;
-           splash_y = int(particle->pos.y);
-           Sector::get().add<RainSplash>(Vector(splash_x, splash_y),vertical);
+           splash_x = int(x[i]) - (int(x[i]) % 32) + 32;
+           splash_y = int(y[i]);
+           splashes.push_back(Vector(splash_x, splash_y));
            } */
       }
-      int new_x = graphicsRandom.rand(int(virtual_width)) + int(abs_x);
+      int new_x = random.rand(int(virtual_width)) + int(abs_x);
       int new_y = 0;
       //FIXME: Don't move particles over solid tiles
-      particle->pos.x = static_cast<float>(new_x);
-      particle->pos.y = static_cast<float>(new_y);
+      x[i] = static_cast<float>(new_x);
+      y[i] = static_cast<float>(new_y);
     }
   }
 }
@@ -17,8 +17,9 @@
 #ifndef HEADER_SUPERTUX_OBJECT_RAIN_PARTICLE_SYSTEM_HPP
 #define HEADER_SUPERTUX_OBJECT_RAIN_PARTICLE_SYSTEM_HPP
 
+#include <vector>
+
 #include "object/particlesystem_interactive.hpp"
-#include "video/surface_ptr.hpp"
 
 class RainParticleSystem final : public ParticleSystem_Interactive
 {
@@ -37,18 +38,20 @@ public:
     return "images/engine/editor/rain.png";
   }
 
+protected:
+  virtual void simulate(float dt_sec) override;
+
 private:
-  class RainParticle : public Particle
-  {
-  public:
-    float speed;
+  /** fetched in update() for simulate() */
+  float gravity;
+  Vector camera_translation;
 
-    RainParticle() :
-      speed()
-    {}
-  };
+  /** RainSplashes found by simulate(), added on the next update() */
+  std::vector<Vector> splashes;
 
-  SurfacePtr rainimages[2];
+  /** Scratch space for simulate() */
+  std::vector<float> movements;
+  std::vector<ParticleHit> hits;
 
 private:
   RainParticleSystem(const RainParticleSystem&) = delete;
@@ -20,10 +20,12 @@
 #include "math/vector.hpp"
 #include "sprite/sprite_manager.hpp"
 #include "supertux/game_object.hpp"
+#include "util/object_pool.hpp"
 
 class Player;
 
-class RainSplash final : public GameObject
+class RainSplash final : public GameObject,
+                         public PooledObject<RainSplash>
 {
 public:
   RainSplash(const Vector& pos, bool vertical);
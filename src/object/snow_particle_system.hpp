@@ -17,6 +17,8 @@
 #ifndef HEADER_SUPERTUX_OBJECT_SNOW_PARTICLE_SYSTEM_HPP
 #define HEADER_SUPERTUX_OBJECT_SNOW_PARTICLE_SYSTEM_HPP
 
+#include <vector>
+
 #include "object/particlesystem.hpp"
 #include "supertux/timer.hpp"
 
@@ -40,30 +42,20 @@ public:
 
   void init();
 
+protected:
+  virtual void simulate(float dt_sec) override;
+
 private:
-  class SnowParticle : public Particle
-  {
-  public:
-    float speed;
-    float wobble;
-    float anchorx;
-    float drift_speed;
-
-    // Turning speed
-    float spin_speed;
-
-    // for inertia
-    unsigned int flake_size;
-
-    SnowParticle() :
-      speed(),
-      wobble(),
-      anchorx(),
-      drift_speed(),
-      spin_speed(),
-      flake_size()
-    {}
-  };
+  // Per particle, in addition to the ones of ParticleSystem
+  std::vector<float> wobble;
+  std::vector<float> anchorx;
+  std::vector<float> drift_speed;
+
+  // Turning speed
+  std::vector<float> spin_speed;
+
+  // for inertia, stored as 1 / flake_size
+  std::vector<float> inertia;
 
   // Wind is simulated in discrete "gusts"
 
@@ -89,7 +81,8 @@ private:
   // Current blowing velocity of gust
   float gust_current_velocity;
 
-  SurfacePtr snowimages[3];
+  // sqrt of the Sector gravity, fetched in update() for simulate()
+  float sq_g;
 
 private:
   SnowParticleSystem(const SnowParticleSystem&) = delete;
@@ -21,11 +21,13 @@
 #include "math/anchor_point.hpp"
 #include "sprite/sprite_ptr.hpp"
 #include "supertux/game_object.hpp"
+#include "util/object_pool.hpp"
 #include "video/drawing_context.hpp"
 
 class Player;
 
-class SpriteParticle final : public GameObject
+class SpriteParticle final : public GameObject,
+                             public PooledObject<SpriteParticle>
 {
 public:
   SpriteParticle(SpritePtr sprite, const std::string& action,
@@ -38,7 +40,6 @@ public:
                  int drawing_layer = LAYER_OBJECTS-1);
   ~SpriteParticle();
 
-protected:
   virtual void update(float dt_sec) override;
   virtual void draw(DrawingContext& context) override;
   virtual bool is_saveable() const override {
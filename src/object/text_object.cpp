@@ -29,6 +29,7 @@ TextObject::TextObject(const std::string& name) :
   m_font(Resources::normal_font),
   m_text(),
   m_wrapped_text(),
+  m_wrapped_size(),
   m_fading(0),
   m_fadetime(0),
   m_visible(false),
@@ -36,6 +37,7 @@ TextObject::TextObject(const std::string& name) :
   m_anchor(ANCHOR_MIDDLE),
   m_pos(0, 0)
 {
+  wrap_text();
 }
 
 TextObject::~TextObject()
@@ -88,6 +90,9 @@ TextObject::wrap_text()
     }
     rest = overflow;
   } while (!rest.empty());
+
+  m_wrapped_size = Sizef(m_font->get_text_width(m_wrapped_text),
+                         m_font->get_text_height(m_wrapped_text));
 }
 
 void
@@ -138,8 +143,8 @@ TextObject::draw(DrawingContext& context)
     return;
   }
 
-  float width  = m_font->get_text_width(m_wrapped_text) + 20.0f;
-  float height = m_font->get_text_height(m_wrapped_text) + 20.0f;
+  float width  = m_wrapped_size.width + 20.0f;
+  float height = m_wrapped_size.height + 20.0f;
   Vector spos = m_pos + get_anchor_pos(Rectf(0, 0, static_cast<float>(context.get_width()), static_cast<float>(context.get_height() + SCREEN_HEIGHT) - 340.0f),
                                        width, height, m_anchor);
 
@@ -18,6 +18,7 @@
 #define HEADER_SUPERTUX_OBJECT_TEXT_OBJECT_HPP
 
 #include "math/anchor_point.hpp"
+#include "math/sizef.hpp"
 #include "scripting/text.hpp"
 #include "squirrel/exposed_object.hpp"
 #include "supertux/game_object.hpp"
@@ -60,6 +61,10 @@ private:
   FontPtr m_font;
   std::string m_text;
   std::string m_wrapped_text;
+
+  /** Size of m_wrapped_text, measured once per wrap_text() */
+  Sizef m_wrapped_size;
+
   float m_fading;
   float m_fadetime;
   bool m_visible;
@@ -16,16 +16,23 @@
 
 #include "object/tilemap.hpp"
 
+#include <mutex>
+#include <physfs.h>
 #include <tuple>
+#include <unordered_map>
 
 #include "editor/editor.hpp"
+#include "object/camera.hpp"
 #include "supertux/autotile.hpp"
 #include "supertux/debug.hpp"
 #include "supertux/globals.hpp"
 #include "supertux/sector.hpp"
 #include "supertux/tile.hpp"
 #include "supertux/tile_set.hpp"
+#include "util/flat_hash_map.hpp"
+#include "util/log.hpp"
 #include "util/reader.hpp"
+#include "util/reader_document.hpp"
 #include "util/reader_mapping.hpp"
 #include "util/writer.hpp"
 #include "video/drawing_context.hpp"
@@ -33,12 +40,105 @@
 #include "video/surface.hpp"
 #include "worldmap/worldmap.hpp"
 
+namespace {
+
+/** Chunks built ahead of the camera per logic step */
+const int PREBAKE_CHUNKS_PER_STEP = 2;
+
+/** Built chunks further than this many chunks away from the camera
+    are released again, so the cache stays bounded on long levels */
+const int KEEP_CHUNKS_DISTANCE = 8;
+
+/** Chunks checked for eviction per logic step */
+const int EVICT_CHUNKS_PER_STEP = 32;
+
+/** Lazily loaded tiles are decoded this many at a time when the
+    whole array is scanned or read */
+const size_t LAZY_TILES_PER_PIECE = 4096;
+
+} // namespace
+
+struct TileMap::LazyFile
+{
+  LazyFile(const std::string& filename_, size_t size_) :
+    filename(filename_), size(size_), file(nullptr), failed(false)
+  {}
+
+  ~LazyFile()
+  {
+    if (file) {
+      PHYSFS_close(file);
+    }
+  }
+
+  /** Returns the open file of the level, if the level got loaded
+      again since, size tells apart a changed file */
+  static std::shared_ptr<LazyFile> get(const std::string& filename, size_t size)
+  {
+    // levels can be parsed on worker threads
+    static std::mutex s_mutex;
+    static std::unordered_map<std::string, std::weak_ptr<LazyFile> > s_files;
+
+    std::lock_guard<std::mutex> lock(s_mutex);
+    auto& entry = s_files[filename];
+    auto file = entry.lock();
+    if (!file || file->size != size) {
+      file = std::make_shared<LazyFile>(filename, size);
+      entry = file;
+    }
+    return file;
+  }
+
+  /** Reads count bytes at offset, logs and gives up for good on the
+      first error */
+  bool read(size_t offset, char* data, size_t count)
+  {
+    if (failed)
+      return false;
+
+    if (!file) {
+      file = PHYSFS_openRead(filename.c_str());
+    }
+
+    // the offsets are only valid for the file the level was loaded from
+    if (!file ||
+        PHYSFS_fileLength(file) != static_cast<PHYSFS_sint64>(size) ||
+        !PHYSFS_seek(file, offset) ||
+        PHYSFS_readBytes(file, data, count) != static_cast<PHYSFS_sint64>(count))
+    {
+      log_warning << "Couldn't read tiles from '" << filename << "': "
+                  << PHYSFS_getLastErrorCode() << std::endl;
+      if (file) {
+        PHYSFS_close(file);
+        file = nullptr;
+      }
+      failed = true;
+      return false;
+    }
+    return true;
+  }
+
+  std::string filename;
+
+  /** of the file when the level was loaded */
+  size_t size;
+
+  /** opened on the first read */
+  PHYSFS_File* file;
+  bool failed;
+
+private:
+  LazyFile(const LazyFile&) = delete;
+  LazyFile& operator=(const LazyFile&) = delete;
+};
+
 TileMap::TileMap(const TileSet *new_tileset) :
   ExposedObject<TileMap, scripting::TileMap>(this),
   PathObject(),
   m_editor_active(true),
   m_tileset(new_tileset),
   m_tiles(),
+  m_lazy_tiles(),
   m_real_solid(false),
   m_effective_solid(false),
   m_speed_x(1),
@@ -61,8 +161,18 @@ TileMap::TileMap(const TileSet *new_tileset) :
   m_new_size_y(0),
   m_new_offset_x(0),
   m_new_offset_y(0),
-  m_add_path(false)
+  m_add_path(false),
+  m_revision(0),
+  m_dirty_region(),
+  m_attribute_plane(),
+  m_chunks(),
+  m_chunk_sweep(0),
+  m_draw_batches(),
+  m_draw_batch_index()
 {
+  if (m_tileset) {
+    m_tileset->add_user();
+  }
 }
 
 TileMap::TileMap(const TileSet *tileset_, const ReaderMapping& reader) :
@@ -72,6 +182,7 @@ TileMap::TileMap(const TileSet *tileset_, const ReaderMapping& reader) :
   m_editor_active(true),
   m_tileset(tileset_),
   m_tiles(),
+  m_lazy_tiles(),
   m_real_solid(false),
   m_effective_solid(false),
   m_speed_x(1),
@@ -94,9 +205,17 @@ TileMap::TileMap(const TileSet *tileset_, const ReaderMapping& reader) :
   m_new_size_y(0),
   m_new_offset_x(0),
   m_new_offset_y(0),
-  m_add_path(false)
+  m_add_path(false),
+  m_revision(0),
+  m_dirty_region(),
+  m_attribute_plane(),
+  m_chunks(),
+  m_chunk_sweep(0),
+  m_draw_batches(),
+  m_draw_batch_index()
 {
   assert(m_tileset);
+  m_tileset->add_user();
 
   reader.get("solid",  m_real_solid);
 
@@ -151,23 +270,55 @@ TileMap::TileMap(const TileSet *tileset_, const ReaderMapping& reader) :
     //throw std::runtime_error("Invalid/No width/height specified in tilemap.");
     m_width = 0;
     m_height = 0;
-    m_tiles.clear();
+    m_tiles = Tiles();
     resize(static_cast<int>(Sector::get().get_width() / 32.0f),
            static_cast<int>(Sector::get().get_height() / 32.0f));
     m_editor_active = false;
   } else {
-    if (!reader.get("tiles", m_tiles))
-      throw std::runtime_error("No tiles in tilemap.");
+    // decoration layers of binary levels are read in chunks later,
+    // for now only the IDs they use are collected
+    BinaryDocument::Blob blob;
+    if (!m_real_solid && !Editor::is_active() && reader.get_file_blob("tiles", blob)) {
+      if (static_cast<int>(blob.count) != m_width * m_height) {
+        throw std::runtime_error("wrong number of tiles in tilemap.");
+      }
 
-    if (int(m_tiles.size()) != m_width * m_height) {
-      throw std::runtime_error("wrong number of tiles in tilemap.");
+      const ReaderDocument& doc = reader.get_doc();
+      const int chunks_width = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+      const int chunks_height = (m_height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+      m_lazy_tiles = std::make_unique<LazyTiles>();
+      m_lazy_tiles->file = LazyFile::get(doc.get_filename(), doc.get_file_size());
+      m_lazy_tiles->blob = blob;
+      m_lazy_tiles->chunks.resize(chunks_width * chunks_height);
+
+      Tiles& used_ids = m_lazy_tiles->used_ids;
+      Tiles piece;
+      for (size_t first = 0; first < blob.count; first += LAZY_TILES_PER_PIECE) {
+        piece.resize(std::min(LAZY_TILES_PER_PIECE, blob.count - first));
+        doc.read_file_blob(blob, first, piece.size(), piece.data());
+        std::sort(piece.begin(), piece.end());
+        piece.erase(std::unique(piece.begin(), piece.end()), piece.end());
+
+        const size_t middle = used_ids.size();
+        used_ids.insert(used_ids.end(), piece.begin(), piece.end());
+        std::inplace_merge(used_ids.begin(), used_ids.begin() + middle, used_ids.end());
+        used_ids.erase(std::unique(used_ids.begin(), used_ids.end()), used_ids.end());
+      }
+      used_ids.shrink_to_fit();
+    } else {
+      if (!reader.get("tiles", m_tiles.write()))
+        throw std::runtime_error("No tiles in tilemap.");
+
+      if (int(m_tiles->size()) != m_width * m_height) {
+        throw std::runtime_error("wrong number of tiles in tilemap.");
+      }
     }
   }
 
   bool empty = true;
 
   // make sure all tiles used on the tilemap are loaded and tilemap isn't empty
-  for (const auto& tile : m_tiles) {
+  for (const auto& tile : m_lazy_tiles ? m_lazy_tiles->used_ids : *m_tiles) {
     if (tile != 0) {
       empty = false;
     }
@@ -175,12 +326,46 @@ TileMap::TileMap(const TileSet *tileset_, const ReaderMapping& reader) :
     m_tileset->get(tile);
   }
 
+  update_attribute_plane();
+
   if (empty)
   {
     log_info << "Tilemap '" << get_name() << "', z-pos '" << m_z_pos << "' is empty." << std::endl;
   }
 }
 
+std::unique_ptr<GameObject>
+TileMap::clone()
+{
+  // paths are referenced by UID, which changes in a new sector, so
+  // those go through saving and loading to be resolved by name again
+  if (get_path())
+    return GameObject::clone();
+
+  load_all_tiles();
+
+  auto tilemap = std::make_unique<TileMap>(m_tileset);
+  tilemap->set_name(get_name());
+  tilemap->m_editor_active = m_editor_active;
+  tilemap->m_tiles = m_tiles;
+  tilemap->m_real_solid = m_real_solid;
+  tilemap->m_effective_solid = m_effective_solid;
+  tilemap->m_speed_x = m_speed_x;
+  tilemap->m_speed_y = m_speed_y;
+  tilemap->m_width = m_width;
+  tilemap->m_height = m_height;
+  tilemap->m_z_pos = m_z_pos;
+  tilemap->m_offset = m_offset;
+  tilemap->m_flip = m_flip;
+  tilemap->m_alpha = m_alpha;
+  tilemap->m_current_alpha = m_current_alpha;
+  tilemap->m_tint = m_tint;
+  tilemap->m_current_tint = m_current_tint;
+  tilemap->m_draw_target = m_draw_target;
+  tilemap->update_attribute_plane();
+  return tilemap;
+}
+
 void
 TileMap::finish_construction()
 {
@@ -194,6 +379,9 @@ TileMap::finish_construction()
 
 TileMap::~TileMap()
 {
+  if (m_tileset) {
+    m_tileset->remove_user();
+  }
 }
 
 void
@@ -317,6 +505,10 @@ TileMap::update(float dt_sec)
       set_offset(Vector(0, 0));
     }
   }
+
+  if (Sector::current() && m_current_alpha != 0.0f && !g_debug.show_collision_rects) {
+    prebake_chunks(Sector::get().get_camera().get_prefetch_rect());
+  }
 }
 
 void
@@ -358,6 +550,19 @@ TileMap::draw(DrawingContext& context)
 
   Rectf draw_rect = context.get_cliprect();
   Rect t_draw_rect = get_tiles_overlapping(draw_rect);
+
+  if (Editor::is_active() || g_debug.show_collision_rects) {
+    draw_tiles(context, t_draw_rect);
+  } else {
+    draw_chunks(context.get_canvas(m_draw_target), t_draw_rect);
+  }
+
+  context.pop_transform();
+}
+
+void
+TileMap::draw_tiles(DrawingContext& context, const Rect& t_draw_rect)
+{
   Vector start = get_tile_position(t_draw_rect.left, t_draw_rect.top);
 
   Vector pos;
@@ -369,18 +574,17 @@ TileMap::draw(DrawingContext& context)
 
   for (pos.x = start.x, tx = t_draw_rect.left; tx < t_draw_rect.right; pos.x += 32, ++tx) {
     for (pos.y = start.y, ty = t_draw_rect.top; ty < t_draw_rect.bottom; pos.y += 32, ++ty) {
-      int index = ty*m_width + tx;
-      assert (index >= 0);
-      assert (index < (m_width * m_height));
+      assert (tx >= 0 && tx < m_width && ty >= 0 && ty < m_height);
 
-      if (m_tiles[index] == 0) continue;
-      const Tile& tile = m_tileset->get(m_tiles[index]);
+      const uint32_t id = get_tile_id_unchecked(tx, ty);
+      if (id == 0) continue;
+      const Tile& tile = m_tileset->get(id);
 
       if (g_debug.show_collision_rects) {
         tile.draw_debug(context.color(), pos, LAYER_FOREGROUND1);
       }
 
-      const SurfacePtr& surface = Editor::is_active() ? tile.get_current_editor_surface() : tile.get_current_surface();
+      const SurfacePtr surface = Editor::is_active() ? tile.get_current_editor_surface() : m_tileset->get_current_surface(id);
       if (surface) {
         std::get<0>(batches[surface]).emplace_back(surface->get_region());
         std::get<1>(batches[surface]).emplace_back(pos,
@@ -402,8 +606,218 @@ TileMap::draw(DrawingContext& context)
                                 m_current_tint, m_z_pos);
     }
   }
+}
 
-  context.pop_transform();
+void
+TileMap::draw_chunks(Canvas& canvas, const Rect& t_draw_rect)
+{
+  if (t_draw_rect.left >= t_draw_rect.right || t_draw_rect.top >= t_draw_rect.bottom)
+    return;
+
+  const int chunks_width = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  const int chunks_height = (m_height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  if (m_chunks.empty()) {
+    m_chunks.resize(chunks_width * chunks_height);
+  }
+
+  // merge the chunks into a single batch per surface, in first seen
+  // order so that the draw requests don't depend on pointer values
+  for (auto& batch : m_draw_batches) {
+    batch.srcrects.clear();
+    batch.dstrects.clear();
+  }
+  auto get_slot = [this](const SurfacePtr& surface) -> size_t {
+    auto it = m_draw_batch_index.find(surface.get());
+    if (it != m_draw_batch_index.end()) {
+      return it->second;
+    } else {
+      m_draw_batch_index[surface.get()] = m_draw_batches.size();
+      m_draw_batches.emplace_back();
+      m_draw_batches.back().surface = surface;
+      return m_draw_batches.size() - 1;
+    }
+  };
+
+  const int cx_end = (t_draw_rect.right - 1) / CHUNK_SIZE;
+  const int cy_end = (t_draw_rect.bottom - 1) / CHUNK_SIZE;
+  for (int cy = t_draw_rect.top / CHUNK_SIZE; cy <= cy_end; ++cy) {
+    for (int cx = t_draw_rect.left / CHUNK_SIZE; cx <= cx_end; ++cx) {
+      const Chunk& chunk = get_chunk(cx, cy);
+
+      for (const auto& cached : chunk.batches) {
+        if (cached.slot == NO_SLOT) {
+          cached.slot = get_slot(cached.surface);
+        }
+        ChunkBatch& batch = m_draw_batches[cached.slot];
+        batch.srcrects.insert(batch.srcrects.end(), cached.srcrects.begin(), cached.srcrects.end());
+        for (const auto& dstrect : cached.dstrects) {
+          batch.dstrects.push_back(dstrect.moved(m_offset));
+        }
+      }
+
+      for (const int index : chunk.animated) {
+        const SurfacePtr& surface = m_tileset->get_current_surface(
+          get_tile_id_unchecked(index % m_width, index / m_width));
+        if (surface) {
+          ChunkBatch& batch = m_draw_batches[get_slot(surface)];
+          batch.srcrects.emplace_back(surface->get_region());
+          batch.dstrects.emplace_back(get_tile_position(index % m_width, index / m_width),
+                                      Sizef(static_cast<float>(surface->get_width()),
+                                            static_cast<float>(surface->get_height())));
+        }
+      }
+    }
+  }
+
+  for (const auto& batch : m_draw_batches)
+  {
+    canvas.draw_surface_batch(batch.surface,
+                              batch.srcrects.data(),
+                              batch.dstrects.data(),
+                              batch.srcrects.size(),
+                              m_current_tint, m_z_pos);
+  }
+}
+
+void
+TileMap::prebake_chunks(const Rectf& rect)
+{
+  if (m_width == 0 || m_height == 0)
+    return;
+
+  // the same parallax scrolling as in draw()
+  const Rectf view(rect.get_left() * m_speed_x, rect.get_top() * m_speed_y,
+                   rect.get_left() * m_speed_x + rect.get_width(),
+                   rect.get_top() * m_speed_y + rect.get_height());
+  const Rect t_rect = get_tiles_overlapping(view);
+  if (t_rect.left >= t_rect.right || t_rect.top >= t_rect.bottom)
+    return;
+
+  const int chunks_width = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  const int chunks_height = (m_height + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  if (m_chunks.empty()) {
+    m_chunks.resize(chunks_width * chunks_height);
+  }
+
+  const Rect c_rect(t_rect.left / CHUNK_SIZE, t_rect.top / CHUNK_SIZE,
+                    (t_rect.right - 1) / CHUNK_SIZE, (t_rect.bottom - 1) / CHUNK_SIZE);
+  evict_chunks(c_rect.grown(KEEP_CHUNKS_DISTANCE));
+
+  if (m_lazy_tiles) {
+    // the tiles have to be there before the chunks get built or drawn,
+    // reading one more chunk around the prefetch rect keeps the file
+    // access out of draw() while the camera scrolls
+    const int left = std::max(0, c_rect.left - 1);
+    const int top = std::max(0, c_rect.top - 1);
+    const int right = std::min(chunks_width, c_rect.right + 2);
+    const int bottom = std::min(chunks_height, c_rect.bottom + 2);
+    for (int cy = top; cy < bottom; ++cy) {
+      for (int cx = left; cx < right;) {
+        if (!m_lazy_tiles->chunks[cy * chunks_width + cx].empty()) {
+          ++cx;
+          continue;
+        }
+
+        int end = cx + 1;
+        while (end < right && m_lazy_tiles->chunks[cy * chunks_width + end].empty()) {
+          ++end;
+        }
+        read_lazy_chunks(cx, end, cy);
+        cx = end;
+      }
+    }
+  }
+
+  int budget = PREBAKE_CHUNKS_PER_STEP;
+  for (int cy = c_rect.top; cy <= c_rect.bottom; ++cy) {
+    for (int cx = c_rect.left; cx <= c_rect.right; ++cx) {
+      if (!m_chunks[cy * chunks_width + cx].valid) {
+        get_chunk(cx, cy);
+        if (--budget == 0)
+          return;
+      }
+    }
+  }
+}
+
+void
+TileMap::evict_chunks(const Rect& keep)
+{
+  const int chunks_width = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  const int count = static_cast<int>(m_chunks.size());
+  for (int i = 0; i < std::min(EVICT_CHUNKS_PER_STEP, count); ++i)
+  {
+    m_chunk_sweep = (m_chunk_sweep + 1) % count;
+    const int cx = m_chunk_sweep % chunks_width;
+    const int cy = m_chunk_sweep / chunks_width;
+    Chunk& chunk = m_chunks[m_chunk_sweep];
+    const bool keep_chunk = keep.left <= cx && cx <= keep.right && keep.top <= cy && cy <= keep.bottom;
+
+    if (m_lazy_tiles && !keep_chunk) {
+      Tiles().swap(m_lazy_tiles->chunks[m_chunk_sweep]);
+    }
+
+    // empty chunks hold no memory, keeping them spares rescanning
+    // their tiles when they come back into view
+    if (chunk.batches.empty() && chunk.animated.empty())
+      continue;
+
+    if (chunk.valid && !keep_chunk) {
+      // swap to actually release the memory
+      std::vector<ChunkBatch>().swap(chunk.batches);
+      std::vector<int>().swap(chunk.animated);
+      chunk.valid = false;
+    }
+  }
+}
+
+const TileMap::Chunk&
+TileMap::get_chunk(int cx, int cy)
+{
+  const int chunks_width = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  Chunk& chunk = m_chunks[cy * chunks_width + cx];
+  if (chunk.valid)
+    return chunk;
+
+  chunk.batches.clear();
+  chunk.animated.clear();
+
+  std::unordered_map<const Surface*, size_t> batch_index;
+
+  const int right = std::min(m_width, (cx + 1) * CHUNK_SIZE);
+  const int bottom = std::min(m_height, (cy + 1) * CHUNK_SIZE);
+  for (int ty = cy * CHUNK_SIZE; ty < bottom; ++ty) {
+    for (int tx = cx * CHUNK_SIZE; tx < right; ++tx) {
+      const int index = ty * m_width + tx;
+      const uint32_t id = get_tile_id_unchecked(tx, ty);
+      if (id == 0) continue;
+
+      const Tile& tile = m_tileset->get(id);
+      if (tile.get_images().size() > 1) {
+        chunk.animated.push_back(index);
+        continue;
+      }
+
+      const SurfacePtr surface = tile.get_current_surface();
+      if (!surface) continue;
+
+      auto it = batch_index.find(surface.get());
+      if (it == batch_index.end()) {
+        it = batch_index.emplace(surface.get(), chunk.batches.size()).first;
+        chunk.batches.emplace_back();
+        chunk.batches.back().surface = surface;
+      }
+
+      ChunkBatch& batch = chunk.batches[it->second];
+      batch.srcrects.emplace_back(surface->get_region());
+      batch.dstrects.emplace_back(Vector(static_cast<float>(tx * 32), static_cast<float>(ty * 32)),
+                                  Sizef(static_cast<float>(surface->get_width()),
+                                        static_cast<float>(surface->get_height())));
+    }
+  }
+
+  chunk.valid = true;
+  return chunk;
 }
 
 void
@@ -437,8 +851,11 @@ TileMap::set(int newwidth, int newheight, const std::vector<unsigned int>&newt,
   m_width  = newwidth;
   m_height = newheight;
 
-  m_tiles.resize(newt.size());
+  m_lazy_tiles.reset();
   m_tiles = newt;
+  m_revision += 1;
+  m_chunks.clear();
+  update_attribute_plane();
 
   if (new_z_pos > (LAYER_GUI - 100))
     m_z_pos = LAYER_GUI - 100;
@@ -448,7 +865,7 @@ TileMap::set(int newwidth, int newheight, const std::vector<unsigned int>&newt,
   update_effective_solid ();
 
   // make sure all tiles are loaded
-  for (const auto& tile : m_tiles)
+  for (const auto& tile : *m_tiles)
     m_tileset->get(tile);
 }
 
@@ -456,27 +873,30 @@ void
 TileMap::resize(int new_width, int new_height, int fill_id,
                 int xoffset, int yoffset)
 {
+  load_all_tiles();
+
+  Tiles& tiles = m_tiles.write();
   if (new_width < m_width) {
     // remap tiles for new width
     for (int y = 0; y < m_height && y < new_height; ++y) {
       for (int x = 0; x < new_width; ++x) {
-        m_tiles[y * new_width + x] = m_tiles[y * m_width + x];
+        tiles[y * new_width + x] = tiles[y * m_width + x];
       }
     }
   }
 
-  m_tiles.resize(new_width * new_height, fill_id);
+  tiles.resize(new_width * new_height, fill_id);
 
   if (new_width > m_width) {
     // remap tiles
     for (int y = std::min(m_height, new_height)-1; y >= 0; --y) {
       for (int x = new_width-1; x >= 0; --x) {
         if (x >= m_width) {
-          m_tiles[y * new_width + x] = fill_id;
+          tiles[y * new_width + x] = fill_id;
           continue;
         }
 
-        m_tiles[y * new_width + x] = m_tiles[y * m_width + x];
+        tiles[y * new_width + x] = tiles[y * m_width + x];
       }
     }
   }
@@ -492,13 +912,16 @@ TileMap::resize(int new_width, int new_height, int fill_id,
         int X = (xoffset < 0) ? x : (m_width - x - 1);
         if (Y - yoffset < 0 || Y - yoffset >= m_height ||
             X - xoffset < 0 || X - xoffset >= m_width) {
-          m_tiles[Y * new_width + X] = fill_id;
+          tiles[Y * new_width + X] = fill_id;
         } else {
-          m_tiles[Y * new_width + X] = m_tiles[(Y - yoffset) * m_width + X - xoffset];
+          tiles[Y * new_width + X] = tiles[(Y - yoffset) * m_width + X - xoffset];
         }
       }
     }
   }
+  m_revision += 1;
+  m_chunks.clear();
+  update_attribute_plane();
 }
 
 void TileMap::resize(const Size& newsize, const Size& resize_offset) {
@@ -521,6 +944,9 @@ TileMap::get_tiles_overlapping(const Rectf &rect) const
 void
 TileMap::set_solid(bool solid)
 {
+  if (solid) {
+    load_all_tiles();
+  }
   m_real_solid = solid;
   update_effective_solid ();
 }
@@ -538,7 +964,7 @@ TileMap::get_tile_id(int x, int y) const
     return 0;
   }
 
-  return m_tiles[y*m_width + x];
+  return get_tile_id_unchecked(x, y);
 }
 
 const Tile&
@@ -566,7 +992,10 @@ void
 TileMap::change(int x, int y, uint32_t newtile)
 {
   assert(x >= 0 && x < m_width && y >= 0 && y < m_height);
-  m_tiles[y*m_width + x] = newtile;
+  load_all_tiles();
+  m_tiles.write()[y*m_width + x] = newtile;
+  mark_dirty(x, y);
+  update_attribute_plane(x, y);
 }
 
 void
@@ -579,9 +1008,12 @@ TileMap::change_at(const Vector& pos, uint32_t newtile)
 void
 TileMap::change_all(uint32_t oldtile, uint32_t newtile)
 {
-  for (int x = 0; x < get_width(); x++) {
-    for (int y = 0; y < get_height(); y++) {
-      if (get_tile_id(x,y) != oldtile)
+  load_all_tiles();
+
+  // walk the tiles in memory order, only touched tiles update the caches
+  for (int y = 0; y < m_height; y++) {
+    for (int x = 0; x < m_width; x++) {
+      if ((*m_tiles)[y*m_width + x] != oldtile)
         continue;
 
       change(x,y,newtile);
@@ -589,12 +1021,73 @@ TileMap::change_all(uint32_t oldtile, uint32_t newtile)
   }
 }
 
+void
+TileMap::change_all(const std::vector<std::pair<uint32_t, uint32_t> >& changes)
+{
+  // combine the changes into one mapping, a change also applies to the
+  // tiles earlier changes have turned into its old tile
+  FlatHashMap<uint32_t, uint32_t> mapping;
+  mapping.reserve(changes.size());
+  std::vector<uint32_t> keys;
+  for (const auto& change : changes)
+  {
+    for (const auto key : keys) {
+      uint32_t* value = mapping.find(key);
+      if (*value == change.first) {
+        *value = change.second;
+      }
+    }
+    if (!mapping.find(change.first)) {
+      mapping.insert(change.first, change.second);
+      keys.push_back(change.first);
+    }
+  }
+
+  load_all_tiles();
+  for (int y = 0; y < m_height; y++) {
+    for (int x = 0; x < m_width; x++) {
+      const uint32_t* newtile = mapping.find((*m_tiles)[y*m_width + x]);
+      if (!newtile)
+        continue;
+
+      change(x, y, *newtile);
+    }
+  }
+}
+
+void
+TileMap::change_spans(const std::vector<Span>& spans, const std::vector<uint32_t>& tiles)
+{
+  load_all_tiles();
+  Tiles& new_tiles = m_tiles.write();
+  size_t i = 0;
+  for (const auto& span : spans)
+  {
+    assert(span.y >= 0 && span.y < m_height && span.left >= 0 && span.right <= m_width);
+
+    for (int x = span.left; x < span.right; ++x, ++i) {
+      new_tiles[span.y * m_width + x] = tiles[i];
+      update_attribute_plane(x, span.y);
+    }
+
+    // once per chunk is enough for the dirty region and the chunk cache
+    for (int x = span.left; x < span.right; x = (x / CHUNK_SIZE + 1) * CHUNK_SIZE) {
+      mark_dirty(x, span.y);
+    }
+    if (span.left < span.right) {
+      mark_dirty(span.right - 1, span.y);
+    }
+  }
+  assert(i == tiles.size());
+}
+
 void
 TileMap::autotile(int x, int y, uint32_t tile)
 {
   assert(x >= 0 && x < m_width && y >= 0 && y < m_height);
+  load_all_tiles();
 
-  uint32_t current_tile = m_tiles[y*m_width + x];
+  uint32_t current_tile = (*m_tiles)[y*m_width + x];
   AutotileSet* curr_set;
   if (current_tile == 0)
   {
@@ -632,7 +1125,9 @@ TileMap::autotile(int x, int y, uint32_t tile)
     curr_set->is_solid(get_tile_id(x+1, y+1)),
     x, y);
 
-  m_tiles[y*m_width + x] = realtile;
+  m_tiles.write()[y*m_width + x] = realtile;
+  mark_dirty(x, y);
+  update_attribute_plane(x, y);
 }
 
 void
@@ -673,6 +1168,7 @@ TileMap::move_by(const Vector& shift)
   }
   get_path()->move_by(shift);
   m_offset += shift;
+  m_revision += 1;
 }
 
 void
@@ -686,6 +1182,10 @@ TileMap::update_effective_solid()
   else if (!m_effective_solid && (m_current_alpha >= 0.75f))
     m_effective_solid = true;
   
+  if (old != m_effective_solid) {
+    m_revision += 1;
+  }
+
   if(Sector::current() != nullptr && old != m_effective_solid)  
   {
       Sector::get().update_solid(this);  
@@ -697,7 +1197,139 @@ TileMap::update_effective_solid()
 void
 TileMap::set_tileset(const TileSet* new_tileset)
 {
+  if (new_tileset) {
+    new_tileset->add_user();
+  }
+  if (m_tileset) {
+    m_tileset->remove_user();
+  }
   m_tileset = new_tileset;
+  m_revision += 1;
+  m_chunks.clear();
+  m_draw_batches.clear();
+  m_draw_batch_index.clear();
+  update_attribute_plane();
+}
+
+const std::vector<uint32_t>&
+TileMap::get_tiles()
+{
+  load_all_tiles();
+  return *m_tiles;
+}
+
+void
+TileMap::append_tile_ids(std::vector<uint32_t>& ids) const
+{
+  const Tiles& tiles = m_lazy_tiles ? m_lazy_tiles->used_ids : *m_tiles;
+  ids.insert(ids.end(), tiles.begin(), tiles.end());
+}
+
+const std::vector<uint32_t>&
+TileMap::get_lazy_chunk(int cx, int cy) const
+{
+  const int chunks_width = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+  const Tiles& tiles = m_lazy_tiles->chunks[cy * chunks_width + cx];
+  if (tiles.empty()) {
+    read_lazy_chunks(cx, cx + 1, cy);
+  }
+  return tiles;
+}
+
+void
+TileMap::read_lazy_chunks(int cx_begin, int cx_end, int cy) const
+{
+  LazyTiles& lazy = *m_lazy_tiles;
+  const int chunks_width = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
+  // tiles that can't be read stay empty
+  for (int cx = cx_begin; cx < cx_end; ++cx) {
+    lazy.chunks[cy * chunks_width + cx].assign(CHUNK_SIZE * CHUNK_SIZE, 0);
+  }
+
+  const int left = cx_begin * CHUNK_SIZE;
+  const int right = std::min(m_width, cx_end * CHUNK_SIZE);
+  const int top = cy * CHUNK_SIZE;
+  const int bottom = std::min(m_height, top + CHUNK_SIZE);
+
+  std::vector<char> data(static_cast<size_t>(right - left) * 4);
+  Tiles row(right - left);
+  for (int ty = top; ty < bottom; ++ty)
+  {
+    const size_t offset = lazy.blob.offset + (static_cast<size_t>(ty) * m_width + left) * 4;
+    if (!lazy.file->read(offset, data.data(), data.size()))
+      break;
+
+    BinaryDocument::decode_values(data.data(), row.size(), row.data());
+    for (int cx = cx_begin; cx < cx_end; ++cx) {
+      const int first = cx * CHUNK_SIZE - left;
+      const int count = std::min(CHUNK_SIZE, right - cx * CHUNK_SIZE);
+      std::copy(row.begin() + first, row.begin() + first + count,
+                lazy.chunks[cy * chunks_width + cx].begin() + (ty - top) * CHUNK_SIZE);
+    }
+  }
+}
+
+void
+TileMap::load_all_tiles()
+{
+  if (!m_lazy_tiles)
+    return;
+
+  const BinaryDocument::Blob& blob = m_lazy_tiles->blob;
+  Tiles tiles(blob.count, 0);
+  std::vector<char> data(std::min(blob.count, LAZY_TILES_PER_PIECE) * 4);
+  for (size_t first = 0; first < blob.count; first += LAZY_TILES_PER_PIECE) {
+    const size_t count = std::min(LAZY_TILES_PER_PIECE, blob.count - first);
+    if (!m_lazy_tiles->file->read(blob.offset + first * 4, data.data(), count * 4))
+      break;
+    BinaryDocument::decode_values(data.data(), count, &tiles[first]);
+  }
+
+  m_lazy_tiles.reset();
+  m_tiles = std::move(tiles);
+  update_attribute_plane();
+}
+
+void
+TileMap::update_attribute_plane()
+{
+  // only solid tilemaps take part in collisions, set_solid() reads the
+  // tiles of lazy ones
+  m_attribute_plane.resize(m_width, m_height);
+  if (m_lazy_tiles)
+    return;
+
+  for (int y = 0; y < m_height; ++y) {
+    for (int x = 0; x < m_width; ++x) {
+      update_attribute_plane(x, y);
+    }
+  }
+}
+
+void
+TileMap::update_attribute_plane(int x, int y)
+{
+  const Tile& tile = m_tileset->get((*m_tiles)[y * m_width + x]);
+  m_attribute_plane.set(x, y, tile.get_attributes(), tile.get_data());
+}
+
+void
+TileMap::mark_dirty(int x, int y)
+{
+  if (m_dirty_region.empty()) {
+    m_dirty_region = Rect(x, y, x + 1, y + 1);
+  } else {
+    m_dirty_region = Rect(std::min(m_dirty_region.left, x),
+                          std::min(m_dirty_region.top, y),
+                          std::max(m_dirty_region.right, x + 1),
+                          std::max(m_dirty_region.bottom, y + 1));
+  }
+
+  if (!m_chunks.empty()) {
+    const int chunks_width = (m_width + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    m_chunks[(y / CHUNK_SIZE) * chunks_width + x / CHUNK_SIZE].valid = false;
+  }
 }
 
 /* EOF */
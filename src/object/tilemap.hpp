@@ -18,7 +18,9 @@
 #define HEADER_SUPERTUX_OBJECT_TILEMAP_HPP
 
 #include <algorithm>
+#include <unordered_map>
 
+#include "collision/tile_attribute_plane.hpp"
 #include "math/rect.hpp"
 #include "math/rectf.hpp"
 #include "math/size.hpp"
@@ -27,10 +29,15 @@
 #include "squirrel/exposed_object.hpp"
 #include "scripting/tilemap.hpp"
 #include "supertux/game_object.hpp"
+#include "util/binary_document.hpp"
+#include "util/copy_on_write.hpp"
 #include "video/color.hpp"
+#include "video/surface_ptr.hpp"
 #include "video/flip.hpp"
 #include "video/drawing_target.hpp"
 
+
+class Canvas;
 class DrawingContext;
 class Tile;
 class TileSet;
@@ -53,12 +60,16 @@ public:
   virtual std::string get_display_name() const override { return _("Tilemap"); }
 
   virtual ObjectSettings get_settings() override;
+
+  /** The clone shares the tiles until one of the tilemaps changes */
+  virtual std::unique_ptr<GameObject> clone() override;
   virtual void after_editor_set() override;
 
   virtual void update(float dt_sec) override;
   virtual void draw(DrawingContext& context) override;
 
   virtual void editor_update() override;
+  virtual bool has_editor_update() const override { return true; }
 
   /** Move tilemap until at given node, then stop */
   void goto_node(int node_no);
@@ -82,7 +93,13 @@ public:
   int get_height() const { return m_height; }
   Size get_size() const { return Size(m_width, m_height); }
 
-  void set_offset(const Vector &offset_) { m_offset = offset_; }
+  void set_offset(const Vector &offset_)
+  {
+    if (offset_ != m_offset) {
+      m_offset = offset_;
+      m_revision += 1;
+    }
+  }
   Vector get_offset() const { return m_offset; }
 
   void move_by(const Vector& pos);
@@ -110,6 +127,17 @@ public:
                  get_tile_position(m_width, m_height));
   }
 
+  /** Cheap test that lets the collision code skip tilemaps far away
+      from rect, has a pixel of slack so it never rejects a rect that
+      get_tiles_overlapping() would find tiles for */
+  bool may_overlap(const Rectf& rect) const
+  {
+    const Rectf bbox = get_bbox();
+    return
+      rect.get_right() > bbox.get_left() - 1.0f && rect.get_left() < bbox.get_right() + 1.0f &&
+      rect.get_bottom() > bbox.get_top() - 1.0f && rect.get_top() < bbox.get_bottom() + 1.0f;
+  }
+
   Rectf get_tile_bbox(int x, int y) const {
     return Rectf(get_tile_position(x, y),
                  get_tile_position(x + 1, y + 1));
@@ -140,6 +168,22 @@ public:
   /** changes all tiles with the given ID */
   void change_all(uint32_t oldtile, uint32_t newtile);
 
+  /** Same as calling change_all() for each pair of old and new tile
+      in order, but walks the tiles only once */
+  void change_all(const std::vector<std::pair<uint32_t, uint32_t> >& changes);
+
+  /** A horizontal run of tiles from left to right (exclusive) */
+  struct Span
+  {
+    int y;
+    int left;
+    int right;
+  };
+
+  /** Changes all tiles covered by spans at once, tiles holds the new
+      tiles of all spans one after another */
+  void change_spans(const std::vector<Span>& spans, const std::vector<uint32_t>& tiles);
+
   /** Puts the correct autotile block at the given position */
   void autotile(int x, int y, uint32_t tile);
 
@@ -165,10 +209,109 @@ public:
 
   void set_tileset(const TileSet* new_tileset);
 
-  const std::vector<uint32_t>& get_tiles() const { return m_tiles; }
+  /** Reads all tiles of a lazily loaded tilemap into memory first */
+  const std::vector<uint32_t>& get_tiles();
+
+  /** Appends the IDs of the tiles the tilemap uses, possibly more than
+      once, without reading lazily loaded tiles */
+  void append_tile_ids(std::vector<uint32_t>& ids) const;
+
+  /** Incremented whenever size, position, tileset or solidity of the
+      tilemap change, lets the CollisionSystem notice that all resting
+      objects have to be woken up. Changes to single tiles only extend
+      the dirty region instead. */
+  uint32_t get_revision() const { return m_revision; }
+
+  /** Tiles changed since the last clear_dirty_region(), in tile
+      coordinates, right and bottom are exclusive */
+  const Rect& get_dirty_region() const { return m_dirty_region; }
+  void clear_dirty_region() { m_dirty_region = Rect(); }
+
+  /** Collision attributes of all tiles, kept in sync with the tiles */
+  const TileAttributePlane& get_attribute_plane() const { return m_attribute_plane; }
+
+  /** Builds a few missing chunks in rect, given in camera
+      coordinates, so that scrolling doesn't build them all at once */
+  void prebake_chunks(const Rectf& rect);
   
 private:
+  /** Static tiles are cached in square chunks of this many tiles */
+  static const int CHUNK_SIZE = 16;
+
+  struct ChunkBatch
+  {
+    ChunkBatch() : surface(), srcrects(), dstrects(), slot(NO_SLOT) {}
+
+    SurfacePtr surface;
+    std::vector<Rectf> srcrects;
+    std::vector<Rectf> dstrects;
+
+    /** Index into m_draw_batches for the surface, assigned on the
+        first draw of the chunk */
+    mutable size_t slot;
+  };
+
+  static const size_t NO_SLOT = static_cast<size_t>(-1);
+
+  /** The static tiles of a chunk presorted into one batch per
+      surface, destination rectangles are relative to m_offset.
+      Animated tiles change their surface over time, so only their
+      index is kept and they are looked up every frame. */
+  struct Chunk
+  {
+    Chunk() : valid(false), batches(), animated() {}
+
+    bool valid;
+    std::vector<ChunkBatch> batches;
+    std::vector<int> animated;
+  };
+
+private:
+  /** Draws the visible tiles one by one, used in the editor and for
+      the collision debug view */
+  void draw_tiles(DrawingContext& context, const Rect& t_draw_rect);
+
+  /** Draws the visible tiles from the chunk cache */
+  void draw_chunks(Canvas& canvas, const Rect& t_draw_rect);
+
+  /** Returns the chunk, rebuilding it if tiles in it changed */
+  const Chunk& get_chunk(int cx, int cy);
+
+  /** Returns the tile at x, y, which have to be inside the tilemap */
+  uint32_t get_tile_id_unchecked(int x, int y) const
+  {
+    return m_lazy_tiles ?
+      get_lazy_chunk(x / CHUNK_SIZE, y / CHUNK_SIZE)[(y % CHUNK_SIZE) * CHUNK_SIZE + x % CHUNK_SIZE] :
+      (*m_tiles)[y * m_width + x];
+  }
+
+  /** Returns the tiles of the chunk of a lazily loaded tilemap,
+      CHUNK_SIZE rows of CHUNK_SIZE tiles. prebake_chunks() reads them
+      ahead of the camera, anything else jumping ahead of it, e.g. a
+      script asking for a distant tile, reads them here. */
+  const std::vector<uint32_t>& get_lazy_chunk(int cx, int cy) const;
+
+  /** Reads the chunks cx_begin to cx_end (exclusive) of chunk row cy
+      of a lazily loaded tilemap, with one file read per tile row */
+  void read_lazy_chunks(int cx_begin, int cx_end, int cy) const;
+
+  /** Reads all tiles of a lazily loaded tilemap into m_tiles, needed
+      before changing them */
+  void load_all_tiles();
+
+  /** Releases a few built chunks outside of keep, given in chunk
+      coordinates, sweeping over the whole cache across steps */
+  void evict_chunks(const Rect& keep);
+
   void update_effective_solid();
+
+  /** Rebuilds m_attribute_plane from all tiles */
+  void update_attribute_plane();
+  void update_attribute_plane(int x, int y);
+
+  /** Adds the tile to m_dirty_region and invalidates its chunk */
+  void mark_dirty(int x, int y);
+
   void float_channel(float target, float &current, float remaining_time, float dt_sec);
 
 public:
@@ -177,8 +320,37 @@ public:
 private:
   const TileSet* m_tileset;
 
+  /** shared with clones until either side changes a tile */
   typedef std::vector<uint32_t> Tiles;
-  Tiles m_tiles;
+  CopyOnWrite<Tiles> m_tiles;
+
+  /** A binary level file, opened once for all lazily loaded tilemaps
+      of the level */
+  struct LazyFile;
+
+  /** Non-solid tilemaps of binary levels never hold all their tiles
+      while the game runs. Loading only scans the tile IDs in the level
+      data. Chunks are read from the level file ahead of the camera and
+      released along with the draw chunks, so long decoration layers
+      only occupy memory around the camera. */
+  struct LazyTiles
+  {
+    LazyTiles() : file(), blob(), chunks(), used_ids() {}
+
+    std::shared_ptr<LazyFile> file;
+    BinaryDocument::Blob blob;
+
+    /** by chunk index, empty if not read */
+    std::vector<Tiles> chunks;
+
+    /** every tile ID used, once */
+    std::vector<uint32_t> used_ids;
+
+  private:
+    LazyTiles(const LazyTiles&) = delete;
+    LazyTiles& operator=(const LazyTiles&) = delete;
+  };
+  std::unique_ptr<LazyTiles> m_lazy_tiles;
 
   /* read solid: In *general*, is this a solid layer? effective solid:
      is the layer *currently* solid? A generally solid layer may be
@@ -218,6 +390,24 @@ private:
   int m_new_offset_y;
   bool m_add_path;
 
+  uint32_t m_revision;
+  Rect m_dirty_region;
+
+  TileAttributePlane m_attribute_plane;
+
+  /** Chunk cache for drawing, row-major, empty until the first draw
+      and after changes to the size or tileset of the tilemap */
+  std::vector<Chunk> m_chunks;
+
+  /** Position of evict_chunks() in m_chunks */
+  int m_chunk_sweep;
+
+  /** One batch per surface that draw_chunks() merges the visible
+      chunks into. Kept from frame to frame along with their capacity,
+      only reset when the tileset changes. */
+  std::vector<ChunkBatch> m_draw_batches;
+  std::unordered_map<const Surface*, size_t> m_draw_batch_index;
+
 private:
   TileMap(const TileMap&) = delete;
   TileMap& operator=(const TileMap&) = delete;
@@ -21,8 +21,12 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "physfs/mapped_file.hpp"
+#include "supertux/load_stats.hpp"
+
 IFileStreambuf::IFileStreambuf(const std::string& filename) :
   file(),
+  mapped(),
   buf()
 {
   // check this as PHYSFS seems to be buggy and still returns a
@@ -30,6 +34,18 @@ IFileStreambuf::IFileStreambuf(const std::string& filename) :
   if (filename.empty()) {
     throw std::runtime_error("Couldn't open file: empty filename");
   }
+
+  g_load_stats.add_file(filename);
+
+  mapped = MappedFile::open(filename);
+  if (mapped)
+  {
+    // the get area is never written to, only the pointers move
+    char* data = const_cast<char*>(mapped->get_data());
+    setg(data, data, data + mapped->get_size());
+    return;
+  }
+
   file = PHYSFS_openRead(filename.c_str());
   if (file == nullptr) {
     std::stringstream msg;
@@ -41,13 +57,15 @@ IFileStreambuf::IFileStreambuf(const std::string& filename) :
 
 IFileStreambuf::~IFileStreambuf()
 {
-  PHYSFS_close(file);
+  if (file) {
+    PHYSFS_close(file);
+  }
 }
 
 int
 IFileStreambuf::underflow()
 {
-  if (PHYSFS_eof(file)) {
+  if (mapped || PHYSFS_eof(file)) {
     return traits_type::eof();
   }
 
@@ -63,6 +81,15 @@ IFileStreambuf::underflow()
 IFileStreambuf::pos_type
 IFileStreambuf::seekpos(pos_type pos, std::ios_base::openmode)
 {
+  if (mapped)
+  {
+    if (pos < 0 || static_cast<size_t>(pos) > mapped->get_size()) {
+      return pos_type(off_type(-1));
+    }
+    setg(eback(), eback() + static_cast<off_type>(pos), egptr());
+    return pos;
+  }
+
   if (PHYSFS_seek(file, static_cast<PHYSFS_uint64> (pos)) == 0) {
     return pos_type(off_type(-1));
   }
@@ -77,6 +104,25 @@ IFileStreambuf::seekoff(off_type off, std::ios_base::seekdir dir,
                         std::ios_base::openmode mode)
 {
   off_type pos = off;
+
+  if (mapped)
+  {
+    switch (dir) {
+      case std::ios_base::beg:
+        break;
+      case std::ios_base::cur:
+        pos += gptr() - eback();
+        break;
+      case std::ios_base::end:
+        pos += egptr() - eback();
+        break;
+      default:
+        assert(false);
+        return pos_type(off_type(-1));
+    }
+    return seekpos(static_cast<pos_type> (pos), mode);
+  }
+
   PHYSFS_sint64 ptell = PHYSFS_tell(file);
 
   switch (dir) {
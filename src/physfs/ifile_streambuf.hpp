@@ -17,12 +17,15 @@
 #ifndef HEADER_SUPERTUX_PHYSFS_IFILE_STREAMBUF_HPP
 #define HEADER_SUPERTUX_PHYSFS_IFILE_STREAMBUF_HPP
 
+#include <memory>
 #include <streambuf>
 
+class MappedFile;
 struct PHYSFS_File;
 
 /** This class implements a C++ streambuf object for physfs files.
- * So that you can use normal istream operations on them
+ * So that you can use normal istream operations on them. Files in
+ * plain directories are memory mapped and read without copying.
  */
 class IFileStreambuf final : public std::streambuf
 {
@@ -38,6 +41,7 @@ protected:
 
 private:
   PHYSFS_File* file;
+  std::unique_ptr<MappedFile> mapped;
   char buf[1024];
 
 private:
@@ -0,0 +1,132 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "physfs/mapped_file.hpp"
+
+#include <physfs.h>
+#include <string.h>
+
+#ifndef WIN32
+#  include <fcntl.h>
+#  include <sys/mman.h>
+#  include <sys/stat.h>
+#  include <unistd.h>
+#endif
+
+#include "util/log.hpp"
+
+namespace {
+
+/** Translates a PhysFS path into a path in the native filesystem,
+    returns an empty string if the file doesn't live in a directory */
+std::string
+get_native_path(const std::string& filename)
+{
+  const char* realdir = PHYSFS_getRealDir(filename.c_str());
+  if (!realdir)
+    return {};
+
+  // files in the userdir may get rewritten while mapped, truncating
+  // a mapped file kills the process with SIGBUS
+  const char* writedir = PHYSFS_getWriteDir();
+  if (writedir && strcmp(realdir, writedir) == 0)
+    return {};
+
+  PHYSFS_Stat stat;
+  if (!PHYSFS_stat(filename.c_str(), &stat) || stat.filetype != PHYSFS_FILETYPE_REGULAR)
+    return {};
+
+#ifndef WIN32
+  struct stat dir_stat;
+  if (::stat(realdir, &dir_stat) != 0 || !S_ISDIR(dir_stat.st_mode))
+    return {};
+#endif
+
+  // strip the mount point, addons are mounted below custom/
+  std::string path = filename;
+  const char* mountpoint = PHYSFS_getMountPoint(realdir);
+  if (mountpoint)
+  {
+    const std::string prefix = mountpoint;
+    if (prefix != "/" && path.compare(0, prefix.size(), prefix) == 0) {
+      path = path.substr(prefix.size());
+    }
+  }
+  while (!path.empty() && path[0] == '/') {
+    path.erase(0, 1);
+  }
+
+  std::string result = realdir;
+  if (!result.empty() && result.back() != '/') {
+    result += '/';
+  }
+  return result + path;
+}
+
+} // namespace
+
+std::unique_ptr<MappedFile>
+MappedFile::open(const std::string& filename)
+{
+#ifdef WIN32
+  (void) filename;
+  return {};
+#else
+  const std::string path = get_native_path(filename);
+  if (path.empty())
+    return {};
+
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0)
+    return {};
+
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0 || file_stat.st_size <= 0)
+  {
+    close(fd);
+    return {};
+  }
+
+  const size_t size = static_cast<size_t>(file_stat.st_size);
+  void* data = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // the mapping stays valid after closing the descriptor
+  close(fd);
+
+  if (data == MAP_FAILED)
+  {
+    log_debug << "couldn't map " << path << ", reading it instead" << std::endl;
+    return {};
+  }
+
+  return std::unique_ptr<MappedFile>(new MappedFile(data, size));
+#endif
+}
+
+MappedFile::MappedFile(void* data, size_t size) :
+  m_data(data),
+  m_size(size)
+{
+}
+
+MappedFile::~MappedFile()
+{
+#ifndef WIN32
+  munmap(m_data, m_size);
+#endif
+}
+
+/* EOF */
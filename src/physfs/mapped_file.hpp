@@ -0,0 +1,54 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_PHYSFS_MAPPED_FILE_HPP
+#define HEADER_SUPERTUX_PHYSFS_MAPPED_FILE_HPP
+
+#include <memory>
+#include <string>
+
+/** Read-only memory mapping of a file in the PhysFS search path.
+    Only files that live in a plain directory can be mapped, files
+    inside archives have to be read through PhysFS as usual. */
+class MappedFile final
+{
+public:
+  /** Returns nullptr when the file is inside an archive, empty, or
+      can't be mapped, callers then fall back to PHYSFS_readBytes() */
+  static std::unique_ptr<MappedFile> open(const std::string& filename);
+
+public:
+  ~MappedFile();
+
+  const char* get_data() const { return static_cast<const char*>(m_data); }
+  size_t get_size() const { return m_size; }
+
+private:
+  MappedFile(void* data, size_t size);
+
+private:
+  void* m_data;
+  size_t m_size;
+
+private:
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -20,6 +20,8 @@
 #include <sstream>
 #include <stdexcept>
 
+#include "physfs/util.hpp"
+
 OFileStreambuf::OFileStreambuf(const std::string& filename) :
   file()
 {
@@ -30,6 +32,7 @@ OFileStreambuf::OFileStreambuf(const std::string& filename) :
         << PHYSFS_getLastErrorCode();
     throw std::runtime_error(msg.str());
   }
+  physfsutil::invalidate_cache();
 
   setp(buf, buf+sizeof(buf));
 }
@@ -16,16 +16,88 @@
 
 #include "physfs/physfs_sdl.hpp"
 
+#include <algorithm>
 #include <physfs.h>
 #include <sstream>
 #include <stdexcept>
 #include <assert.h>
 #include <stdio.h>
+#include <string.h>
 
+#include "physfs/mapped_file.hpp"
+#include "physfs/util.hpp"
+#include "supertux/load_stats.hpp"
 #include "util/log.hpp"
 
 namespace {
 
+struct MappedStream
+{
+  std::unique_ptr<MappedFile> file;
+  size_t pos;
+};
+
+Sint64 funcMappedSize(struct SDL_RWops* context)
+{
+  auto stream = static_cast<MappedStream*>(context->hidden.unknown.data1);
+  return static_cast<Sint64>(stream->file->get_size());
+}
+
+Sint64 funcMappedSeek(struct SDL_RWops* context, Sint64 offset, int whence)
+{
+  auto stream = static_cast<MappedStream*>(context->hidden.unknown.data1);
+  const Sint64 size = static_cast<Sint64>(stream->file->get_size());
+
+  Sint64 pos;
+  switch (whence) {
+    case SEEK_SET:
+      pos = offset;
+      break;
+    case SEEK_CUR:
+      pos = static_cast<Sint64>(stream->pos) + offset;
+      break;
+    case SEEK_END:
+      pos = size + offset;
+      break;
+    default:
+      assert(false);
+      return -1;
+  }
+
+  if (pos < 0 || pos > size) {
+    log_warning << "Error seeking in mapped file" << std::endl;
+    return -1;
+  }
+
+  stream->pos = static_cast<size_t>(pos);
+  return pos;
+}
+
+size_t funcMappedRead(struct SDL_RWops* context, void* ptr, size_t size, size_t maxnum)
+{
+  auto stream = static_cast<MappedStream*>(context->hidden.unknown.data1);
+  if (size == 0)
+    return 0;
+
+  const size_t num = std::min(maxnum, (stream->file->get_size() - stream->pos) / size);
+  memcpy(ptr, stream->file->get_data() + stream->pos, num * size);
+  stream->pos += num * size;
+  return num;
+}
+
+size_t funcMappedWrite(struct SDL_RWops* /*context*/, const void* /*ptr*/, size_t /*size*/, size_t /*num*/)
+{
+  return 0;
+}
+
+int funcMappedClose(struct SDL_RWops* context)
+{
+  delete static_cast<MappedStream*>(context->hidden.unknown.data1);
+  delete context;
+
+  return 0;
+}
+
 Sint64 funcSize(struct SDL_RWops* context)
 {
   PHYSFS_file* file = static_cast<PHYSFS_file*>(context->hidden.unknown.data1);
@@ -109,6 +181,22 @@ SDL_RWops* get_physfs_SDLRWops(const std::string& filename)
     throw std::runtime_error("Couldn't open file: empty filename");
   }
 
+  g_load_stats.add_file(filename);
+
+  // files in plain directories are read straight from the page cache
+  if (auto mapped = MappedFile::open(filename))
+  {
+    SDL_RWops* ops = new SDL_RWops;
+    ops->size = funcMappedSize;
+    ops->seek = funcMappedSeek;
+    ops->read = funcMappedRead;
+    ops->write = funcMappedWrite;
+    ops->close = funcMappedClose;
+    ops->type = SDL_RWOPS_UNKNOWN;
+    ops->hidden.unknown.data1 = new MappedStream{std::move(mapped), 0};
+    return ops;
+  }
+
   PHYSFS_file* file = static_cast<PHYSFS_file*>(PHYSFS_openRead(filename.c_str()));
   if (!file) {
     std::stringstream msg;
@@ -144,6 +232,7 @@ SDL_RWops* get_writable_physfs_SDLRWops(const std::string& filename)
         << PHYSFS_getLastErrorCode();
     throw std::runtime_error(msg.str());
   }
+  physfsutil::invalidate_cache();
 
   SDL_RWops* ops = new SDL_RWops;
   ops->size = funcSize;
@@ -16,12 +16,59 @@
 
 #include "physfs/util.hpp"
 
+#include <mutex>
 #include <physfs.h>
+#include <stdint.h>
+#include <unordered_map>
 
 #include "util/file_system.hpp"
 
 namespace physfsutil {
 
+namespace {
+
+enum : uint8_t {
+  EXISTS_KNOWN = 1 << 0,
+  EXISTS = 1 << 1,
+  DIRECTORY_KNOWN = 1 << 2,
+  DIRECTORY = 1 << 3
+};
+
+std::mutex s_cache_mutex;
+std::unordered_map<std::string, uint8_t> s_cache;
+
+/** Counts invalidate_cache() calls, so a lookup that raced with one
+    doesn't store its outdated result */
+uint64_t s_cache_generation = 0;
+
+/** Returns the cached flag, calls lookup() and remembers the result
+    if it isn't known yet */
+template<typename F>
+bool lookup_cached(const std::string& path, uint8_t known, uint8_t flag, F lookup)
+{
+  uint64_t generation;
+  {
+    std::lock_guard<std::mutex> lock(s_cache_mutex);
+    auto it = s_cache.find(path);
+    if (it != s_cache.end() && (it->second & known)) {
+      return (it->second & flag) != 0;
+    }
+    generation = s_cache_generation;
+  }
+
+  // not done under the lock, is_directory() may have to go to the
+  // real filesystem
+  const bool result = lookup();
+
+  std::lock_guard<std::mutex> lock(s_cache_mutex);
+  if (generation == s_cache_generation) {
+    s_cache[path] |= static_cast<uint8_t>(known | (result ? flag : 0));
+  }
+  return result;
+}
+
+} // namespace
+
 std::string realpath(const std::string& path)
 {
   std::string result = FileSystem::normalize(path);
@@ -57,9 +104,31 @@ bool is_directory(const std::string& path)
 
 bool remove(const std::string& filename)
 {
+  invalidate_cache();
   return PHYSFS_delete(filename.c_str()) == 0;
 }
 
+bool exists_cached(const std::string& path)
+{
+  return lookup_cached(path, EXISTS_KNOWN, EXISTS, [&path]{
+      return PHYSFS_exists(path.c_str()) != 0;
+    });
+}
+
+bool is_directory_cached(const std::string& path)
+{
+  return lookup_cached(path, DIRECTORY_KNOWN, DIRECTORY, [&path]{
+      return is_directory(path);
+    });
+}
+
+void invalidate_cache()
+{
+  std::lock_guard<std::mutex> lock(s_cache_mutex);
+  s_cache.clear();
+  s_cache_generation += 1;
+}
+
 } // namespace physfsutil
 
 /* EOF */
@@ -31,6 +31,16 @@ bool is_directory(const std::string& path);
 
 bool remove(const std::string& filenam);
 
+/** Like PHYSFS_exists() and is_directory(), but the result is
+    remembered, so repeated lookups don't walk the whole search path
+    again. Can be called from any thread. */
+bool exists_cached(const std::string& path);
+bool is_directory_cached(const std::string& path);
+
+/** Has to be called when the search path changes or files are
+    written, deleted or created behind PhysFS's back */
+void invalidate_cache();
+
 } // namespace physfsutil
 
 #endif
@@ -16,9 +16,8 @@
 
 #include "scripting/background.hpp"
 
-#include <physfs.h>
-
 #include "object/background.hpp"
+#include "physfs/util.hpp"
 
 namespace scripting {
 
@@ -36,7 +35,7 @@ Background::set_image(const std::string& image)
   const std::string& default_dir = "images/background/";
   bool path_valid = true;
 
-  if (!PHYSFS_exists(image.c_str()))
+  if (!physfsutil::exists_cached(image))
     path_valid = false;
 
   object.set_image(path_valid ? image : default_dir + image);
@@ -57,13 +56,13 @@ Background::set_images(const std::string& top_image, const std::string& middle_i
   const std::string& default_dir = "images/background/";
   bool top_image_valid = true, middle_image_valid = true, bottom_image_valid = true;
 
-  if (!PHYSFS_exists(top_image.c_str()))
+  if (!physfsutil::exists_cached(top_image))
     top_image_valid = false;
 
-  if (!PHYSFS_exists(middle_image.c_str()))
+  if (!physfsutil::exists_cached(middle_image))
     middle_image_valid = false;
 
-  if (!PHYSFS_exists(bottom_image.c_str()))
+  if (!physfsutil::exists_cached(bottom_image))
     bottom_image_valid = false;
 
   object.set_images(top_image_valid ? top_image : default_dir + top_image,
@@ -16,6 +16,8 @@
 
 #include "scripting/functions.hpp"
 
+#include <iostream>
+
 #include "audio/sound_manager.hpp"
 #include "math/random.hpp"
 #include "object/camera.hpp"
@@ -27,12 +29,15 @@
 #include "supertux/game_session.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/level.hpp"
+#include "supertux/memory_stats.hpp"
+#include "supertux/object_stats.hpp"
 #include "supertux/screen_manager.hpp"
 #include "supertux/sector.hpp"
 #include "supertux/shrinkfade.hpp"
 #include "supertux/textscroller_screen.hpp"
 #include "supertux/tile.hpp"
 #include "video/renderer.hpp"
+#include "video/texture_manager.hpp"
 #include "video/video_system.hpp"
 #include "video/viewport.hpp"
 #include "worldmap/tux.hpp"
@@ -202,6 +207,42 @@ void debug_worldmap_ghost(bool enable)
   tux.set_ghost_mode(enable);
 }
 
+void debug_texture_stats()
+{
+  if (ConsoleBuffer::current()) {
+    TextureManager::current()->debug_print(ConsoleBuffer::output);
+  } else {
+    TextureManager::current()->debug_print(std::cout);
+  }
+}
+
+void debug_sound_stats()
+{
+  if (ConsoleBuffer::current()) {
+    SoundManager::current()->debug_print(ConsoleBuffer::output);
+  } else {
+    SoundManager::current()->debug_print(std::cout);
+  }
+}
+
+void debug_object_stats()
+{
+  std::ostream& out = ConsoleBuffer::current() ? ConsoleBuffer::output : std::cout;
+  if (!g_object_stats.is_enabled())
+  {
+    g_object_stats.set_enabled(true);
+    out << "object stats enabled, results are ready in a second" << std::endl;
+    return;
+  }
+  g_object_stats.write_report(out, 10);
+}
+
+void debug_memory_stats()
+{
+  std::ostream& out = ConsoleBuffer::current() ? ConsoleBuffer::output : std::cout;
+  MemoryStats::write_report(out);
+}
+
 void save_state()
 {
   auto worldmap = worldmap::WorldMap::current();
@@ -92,6 +92,20 @@ void debug_draw_editor_images(bool enable);
 /** enable/disable worldmap ghost mode */
 void debug_worldmap_ghost(bool enable);
 
+/** prints the textures and images in memory with their sizes */
+void debug_texture_stats();
+
+/** prints the sound effects in memory with their sizes */
+void debug_sound_stats();
+
+/** prints the object classes that took the most time to update and
+    draw during the last second, starts recording if it wasn't */
+void debug_object_stats();
+
+/** prints the live memory of textures, sounds, sprites, tilesets,
+    scripts and the objects of the current level */
+void debug_memory_stats();
+
 /** Changes music to musicfile */
 void play_music(const std::string& musicfile);
 
@@ -61,20 +61,47 @@ class GameObject
 {
 public:
   GameObject() :
-    m_uid()
+    m_uid(),
+    m_cached_object(nullptr),
+    m_cached_manager(nullptr),
+    m_cached_generation(0)
   {}
 
   GameObject(UID uid) :
-    m_uid(uid)
+    m_uid(uid),
+    m_cached_object(nullptr),
+    m_cached_manager(nullptr),
+    m_cached_generation(0)
   {}
 
   T* get_object_ptr() const
   {
-    return get_game_object_manager().get_object_by_uid<T>(m_uid);
+    // scripts call the same object every frame, skip the UID lookup
+    // as long as nothing got removed in the meantime
+    GameObjectManager& manager = get_game_object_manager();
+    if (!m_cached_object ||
+        m_cached_manager != &manager ||
+        m_cached_generation != GameObjectManager::get_removal_generation())
+    {
+      m_cached_object = manager.get_object_by_uid<T>(m_uid);
+      m_cached_manager = &manager;
+      m_cached_generation = GameObjectManager::get_removal_generation();
+    }
+
+    // whatever the script does, the object should notice it
+    if (m_cached_object && m_cached_object->is_suspended()) {
+      manager.resume(*m_cached_object);
+    }
+    return m_cached_object;
   }
 
 protected:
   UID m_uid;
+
+private:
+  mutable T* m_cached_object;
+  mutable const GameObjectManager* m_cached_manager;
+  mutable uint32_t m_cached_generation;
 };
 
 } // namespace scripting
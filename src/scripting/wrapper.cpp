@@ -6434,6 +6434,82 @@ static SQInteger debug_worldmap_ghost_wrapper(HSQUIRRELVM vm)
 
 }
 
+static SQInteger debug_texture_stats_wrapper(HSQUIRRELVM vm)
+{
+  (void) vm;
+
+  try {
+    scripting::debug_texture_stats();
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'debug_texture_stats'"));
+    return SQ_ERROR;
+  }
+
+}
+
+static SQInteger debug_sound_stats_wrapper(HSQUIRRELVM vm)
+{
+  (void) vm;
+
+  try {
+    scripting::debug_sound_stats();
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'debug_sound_stats'"));
+    return SQ_ERROR;
+  }
+
+}
+
+static SQInteger debug_object_stats_wrapper(HSQUIRRELVM vm)
+{
+  (void) vm;
+
+  try {
+    scripting::debug_object_stats();
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'debug_object_stats'"));
+    return SQ_ERROR;
+  }
+
+}
+
+static SQInteger debug_memory_stats_wrapper(HSQUIRRELVM vm)
+{
+  (void) vm;
+
+  try {
+    scripting::debug_memory_stats();
+
+    return 0;
+
+  } catch(std::exception& e) {
+    sq_throwerror(vm, e.what());
+    return SQ_ERROR;
+  } catch(...) {
+    sq_throwerror(vm, _SC("Unexpected exception while executing function 'debug_memory_stats'"));
+    return SQ_ERROR;
+  }
+
+}
+
 static SQInteger play_music_wrapper(HSQUIRRELVM vm)
 {
   const SQChar* arg0;
@@ -7820,6 +7896,34 @@ void register_supertux_wrapper(HSQUIRRELVM v)
     throw SquirrelError(v, "Couldn't register function 'debug_worldmap_ghost'");
   }
 
+  sq_pushstring(v, "debug_texture_stats", -1);
+  sq_newclosure(v, &debug_texture_stats_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|t");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'debug_texture_stats'");
+  }
+
+  sq_pushstring(v, "debug_sound_stats", -1);
+  sq_newclosure(v, &debug_sound_stats_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|t");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'debug_sound_stats'");
+  }
+
+  sq_pushstring(v, "debug_object_stats", -1);
+  sq_newclosure(v, &debug_object_stats_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|t");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'debug_object_stats'");
+  }
+
+  sq_pushstring(v, "debug_memory_stats", -1);
+  sq_newclosure(v, &debug_memory_stats_wrapper, 0);
+  sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|t");
+  if(SQ_FAILED(sq_createslot(v, -3))) {
+    throw SquirrelError(v, "Couldn't register function 'debug_memory_stats'");
+  }
+
   sq_pushstring(v, "play_music", -1);
   sq_newclosure(v, &play_music_wrapper, 0);
   sq_setparamscheck(v, SQ_MATCHTYPEMASKSTRING, "x|ts");
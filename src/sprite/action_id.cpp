@@ -0,0 +1,71 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "sprite/action_id.hpp"
+
+#include <deque>
+#include <mutex>
+#include <unordered_map>
+
+namespace {
+
+/** Sprites are parsed on worker threads too, so the table is locked */
+struct ActionTable
+{
+  std::mutex mutex;
+  std::unordered_map<std::string, int> ids;
+  /** deque keeps references to the names stable while growing */
+  std::deque<std::string> names;
+};
+
+ActionTable&
+get_table()
+{
+  static ActionTable table;
+  return table;
+}
+
+} // namespace
+
+ActionId::ActionId(const std::string& name) :
+  m_id()
+{
+  ActionTable& table = get_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+
+  auto it = table.ids.find(name);
+  if (it == table.ids.end())
+  {
+    it = table.ids.emplace(name, static_cast<int>(table.names.size())).first;
+    table.names.push_back(name);
+  }
+  m_id = it->second;
+}
+
+const std::string&
+ActionId::get_name() const
+{
+  static const std::string invalid;
+  if (m_id < 0)
+    return invalid;
+
+  ActionTable& table = get_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+  return table.names[m_id];
+}
+
+/* EOF */
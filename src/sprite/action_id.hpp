@@ -0,0 +1,50 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_SPRITE_ACTION_ID_HPP
+#define HEADER_SUPERTUX_SPRITE_ACTION_ID_HPP
+
+#include <string>
+
+/** Interned sprite action name. Constructing one looks the name up
+    in a global table once, after that comparing ids and looking them
+    up in a SpriteData is integer work only. Objects that switch
+    actions often should keep their ActionIds around instead of
+    passing strings to Sprite::set_action(). */
+class ActionId final
+{
+public:
+  ActionId() : m_id(-1) {}
+  explicit ActionId(const std::string& name);
+
+  bool is_valid() const { return m_id >= 0; }
+  int get_id() const { return m_id; }
+
+  /** The interned name, for log messages */
+  const std::string& get_name() const;
+
+  bool operator==(const ActionId& other) const { return m_id == other.m_id; }
+  bool operator!=(const ActionId& other) const { return m_id != other.m_id; }
+  bool operator<(const ActionId& other) const { return m_id < other.m_id; }
+
+private:
+  int m_id;
+};
+
+#endif
+
+/* EOF */
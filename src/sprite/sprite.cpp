@@ -16,7 +16,9 @@
 
 #include "sprite/sprite.hpp"
 
+#include <algorithm>
 #include <assert.h>
+#include <math.h>
 
 #include "supertux/globals.hpp"
 #include "util/log.hpp"
@@ -36,7 +38,7 @@ Sprite::Sprite(SpriteData& newdata) :
 {
   if (!m_action)
     m_action = m_data.actions.begin()->second.get();
-  m_last_ticks = g_game_time;
+  m_last_ticks = g_render_time;
 }
 
 Sprite::Sprite(const Sprite& other) :
@@ -44,7 +46,7 @@ Sprite::Sprite(const Sprite& other) :
   m_frame(other.m_frame),
   m_frameidx(other.m_frameidx),
   m_animation_loops(other.m_animation_loops),
-  m_last_ticks(g_game_time),
+  m_last_ticks(g_render_time),
   m_angle(0.0f), // FIXME: this can't be right
   m_alpha(1.0f),
   m_color(1.0f, 1.0f, 1.0f, 1.0f),
@@ -75,6 +77,27 @@ Sprite::set_action(const std::string& name, int loops)
     return;
   }
 
+  switch_action(newaction, loops);
+}
+
+void
+Sprite::set_action(const ActionId& id, int loops)
+{
+  if (m_action && m_action->id == id)
+    return;
+
+  const SpriteData::Action* newaction = m_data.get_action(id);
+  if (!newaction) {
+    log_debug << "Action '" << id.get_name() << "' not found." << std::endl;
+    return;
+  }
+
+  switch_action(newaction, loops);
+}
+
+void
+Sprite::switch_action(const SpriteData::Action* newaction, int loops)
+{
   m_action = newaction;
   // If the new action has a loops property,
   // we prefer that over the parameter.
@@ -99,6 +122,22 @@ Sprite::set_action_continued(const std::string& name)
   update();
 }
 
+void
+Sprite::set_action_continued(const ActionId& id)
+{
+  if (m_action && m_action->id == id)
+    return;
+
+  const SpriteData::Action* newaction = m_data.get_action(id);
+  if (!newaction) {
+    log_debug << "Action '" << id.get_name() << "' not found." << std::endl;
+    return;
+  }
+
+  m_action = newaction;
+  update();
+}
+
 bool
 Sprite::animation_done() const
 {
@@ -108,19 +147,29 @@ Sprite::animation_done() const
 void
 Sprite::update()
 {
-  float frame_inc = m_action->fps * (g_game_time - m_last_ticks);
-  m_last_ticks = g_game_time;
+  // sprites created during a logic step are ahead of interpolated
+  // frames, they wait for the render time to catch up
+  float frame_inc = m_action->fps * std::max(0.0f, g_render_time - m_last_ticks);
+  m_last_ticks = std::max(m_last_ticks, g_render_time);
 
   m_frame += frame_inc;
 
-  while (m_frame >= 1.0f) {
-    m_frame -= 1.0f;
-    m_frameidx++;
+  // sprites only advance when drawn, so after a long time off-screen
+  // there can be thousands of frames to skip, which is done in one go
+  // with the same result as stepping through them one by one
+  if (m_frame >= 1.0f) {
+    const float frames = floorf(m_frame);
+    m_frame -= frames;
+    m_frameidx += static_cast<int>(frames);
   }
 
-  while (m_frameidx >= get_frames() && !animation_done()) {
-    m_frameidx -= get_frames();
-    m_animation_loops--;
+  if (m_frameidx >= get_frames() && !animation_done()) {
+    int cycles = m_frameidx / get_frames();
+    if (m_animation_loops > 0) {
+      cycles = std::min(cycles, m_animation_loops);
+      m_animation_loops -= cycles;
+    }
+    m_frameidx -= cycles * get_frames();
   }
 
   if (animation_done()) {
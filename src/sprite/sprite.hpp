@@ -36,9 +36,11 @@ public:
 
   /** Set action (or state) */
   void set_action(const std::string& name, int loops = -1);
+  void set_action(const ActionId& id, int loops = -1);
 
   /** Set action (or state), but keep current frame number, loop counter, etc. */
   void set_action_continued(const std::string& name);
+  void set_action_continued(const ActionId& id);
 
   /** Set number of animation cycles until animation stops */
   void set_animation_loops(int loops = -1) { m_animation_loops = loops; }
@@ -60,6 +62,7 @@ public:
 
   /** Get current action name */
   const std::string& get_action() const { return m_action->name; }
+  const ActionId& get_action_id() const { return m_action->id; }
 
   int get_width() const;
   int get_height() const;
@@ -91,9 +94,11 @@ public:
   Blend get_blend() const;
 
   bool has_action (const std::string& name) const { return (m_data.get_action(name) != nullptr); }
+  bool has_action (const ActionId& id) const { return (m_data.get_action(id) != nullptr); }
 
 private:
   void update();
+  void switch_action(const SpriteData::Action* newaction, int loops);
 
   SpriteData& m_data;
 
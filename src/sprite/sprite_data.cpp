@@ -27,9 +27,11 @@
 #include "util/reader_mapping.hpp"
 #include "util/reader_object.hpp"
 #include "video/surface.hpp"
+#include "video/texture_manager.hpp"
 
 SpriteData::Action::Action() :
   name(),
+  id(),
   x_offset(0),
   y_offset(0),
   hitbox_w(0),
@@ -43,6 +45,7 @@ SpriteData::Action::Action() :
 
 SpriteData::SpriteData(const ReaderMapping& mapping) :
   actions(),
+  action_ids(),
   name()
 {
   auto iter = mapping.get_iter();
@@ -57,6 +60,34 @@ SpriteData::SpriteData(const ReaderMapping& mapping) :
   }
   if (actions.empty())
     throw std::runtime_error("Error: Sprite without actions.");
+
+  for (const auto& action : actions) {
+    action_ids.push_back(action.second.get());
+  }
+  std::sort(action_ids.begin(), action_ids.end(),
+            [](const Action* lhs, const Action* rhs) {
+              return lhs->id < rhs->id;
+            });
+
+  pack_surfaces();
+}
+
+void
+SpriteData::pack_surfaces()
+{
+  std::vector<SurfacePtr> surfaces;
+  for (const auto& action : actions) {
+    surfaces.insert(surfaces.end(), action.second->surfaces.begin(), action.second->surfaces.end());
+  }
+
+  TextureManager::current()->pack(surfaces);
+
+  auto it = surfaces.begin();
+  for (const auto& action : actions) {
+    const auto end = it + action.second->surfaces.size();
+    action.second->surfaces.assign(it, end);
+    it = end;
+  }
 }
 
 void
@@ -195,6 +226,7 @@ SpriteData::parse_action(const ReaderMapping& mapping)
       throw std::runtime_error(msg.str());
     }
   }
+  action->id = ActionId(action->name);
   actions[action->name] = std::move(action);
 }
 
@@ -208,4 +240,31 @@ SpriteData::get_action(const std::string& act) const
   return i->second.get();
 }
 
+const SpriteData::Action*
+SpriteData::get_action(const ActionId& id) const
+{
+  auto it = std::lower_bound(action_ids.begin(), action_ids.end(), id,
+                             [](const Action* action, const ActionId& rhs) {
+                               return action->id < rhs;
+                             });
+  if (it == action_ids.end() || (*it)->id != id) {
+    return nullptr;
+  }
+  return *it;
+}
+
+size_t
+SpriteData::get_memory_usage() const
+{
+  size_t bytes = sizeof(*this) + name.capacity() + action_ids.capacity() * sizeof(const Action*);
+  for (const auto& it : actions)
+  {
+    // the map node, its key and the action
+    bytes += sizeof(Actions::value_type) + 4 * sizeof(void*) + it.first.capacity();
+    bytes += sizeof(Action) + it.second->name.capacity();
+    bytes += it.second->surfaces.capacity() * sizeof(SurfacePtr);
+  }
+  return bytes;
+}
+
 /* EOF */
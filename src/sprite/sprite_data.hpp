@@ -21,6 +21,7 @@
 #include <string>
 #include <vector>
 
+#include "sprite/action_id.hpp"
 #include "video/surface_ptr.hpp"
 
 class ReaderMapping;
@@ -36,6 +37,9 @@ public:
     return name;
   }
 
+  /** Approximate bytes of CPU memory, not counting the textures */
+  size_t get_memory_usage() const;
+
 private:
   friend class Sprite;
 
@@ -44,6 +48,7 @@ private:
     Action();
 
     std::string name;
+    ActionId id;
 
     /** Position correction */
     float x_offset;
@@ -71,10 +76,16 @@ private:
   typedef std::map <std::string, std::unique_ptr<Action> > Actions;
 
   void parse_action(const ReaderMapping& mapping);
+
+  /** Moves the frames of all actions onto a shared atlas page */
+  void pack_surfaces();
   /** Get an action */
   const Action* get_action(const std::string& act) const;
+  const Action* get_action(const ActionId& id) const;
 
   Actions actions;
+  /** actions sorted by their ActionId, for get_action(ActionId) */
+  std::vector<const Action*> action_ids;
   std::string name;
 };
 
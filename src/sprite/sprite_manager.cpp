@@ -17,7 +17,10 @@
 #include "sprite/sprite_manager.hpp"
 
 #include "sprite/sprite.hpp"
+#include "supertux/asset_manifest.hpp"
+#include "supertux/load_stats.hpp"
 #include "util/file_system.hpp"
+#include "util/profiler.hpp"
 #include "util/reader_document.hpp"
 #include "util/reader_mapping.hpp"
 #include "util/string_util.hpp"
@@ -32,6 +35,10 @@ SpriteManager::SpriteManager() :
 SpritePtr
 SpriteManager::create(const std::string& name)
 {
+  if (auto manifest = AssetManifest::current()) {
+    manifest->record_sprite(name);
+  }
+
   Sprites::iterator i = sprites.find(name);
   SpriteData* data;
   if (i == sprites.end()) {
@@ -52,6 +59,9 @@ SpriteManager::create(const std::string& name)
 SpriteData*
 SpriteManager::load(const std::string& filename)
 {
+  Profiler::Scope profile_scope("load sprite");
+  LoadStats::Scope load_scope(LoadStats::SPRITES);
+
   ReaderDocument doc = [filename](){
     try {
       if (StringUtil::has_suffix(filename, ".sprite")) {
@@ -85,4 +95,14 @@ SpriteManager::load(const std::string& filename)
   }
 }
 
+size_t
+SpriteManager::get_memory_usage() const
+{
+  size_t bytes = 0;
+  for (const auto& it : sprites) {
+    bytes += it.first.capacity() + it.second->get_memory_usage();
+  }
+  return bytes;
+}
+
 /* EOF */
@@ -38,6 +38,11 @@ public:
   /** loads a sprite. */
   SpritePtr create(const std::string& filename);
 
+  size_t get_sprite_count() const { return sprites.size(); }
+
+  /** Approximate bytes of CPU memory taken by all loaded SpriteData */
+  size_t get_memory_usage() const;
+
 private:
   SpriteData* load(const std::string& filename);
 };
@@ -19,8 +19,11 @@
 #include <iostream>
 #include <sexp/value.hpp>
 #include <sexp/util.hpp>
+#include <sstream>
+#include <string.h>
 
 #include "squirrel/squirrel_error.hpp"
+#include "util/fnv_hash.hpp"
 #include "util/log.hpp"
 #include "util/reader_mapping.hpp"
 #include "util/writer.hpp"
@@ -86,7 +89,74 @@ void load_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, const ReaderMappin
   }
 }
 
-void save_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, Writer& writer)
+namespace {
+
+/** Nesting depth, counted from the table given to
+    save_squirrel_table(), at which subtables are cached */
+const int CACHED_DEPTH = 2;
+
+/** Hashes everything write_table() would write for the table */
+void hash_table(HSQUIRRELVM vm, SQInteger table_idx, FNVHash& hash)
+{
+  // offset because of sq_pushnull
+  if (table_idx < 0)
+    table_idx -= 1;
+
+  sq_pushnull(vm);
+  while (SQ_SUCCEEDED(sq_next(vm, table_idx))) {
+    if (sq_gettype(vm, -2) == OT_STRING) {
+      const SQChar* key;
+      sq_getstring(vm, -2, &key);
+      const size_t key_len = strlen(key);
+
+      const SQObjectType type = sq_gettype(vm, -1);
+      hash.add(type);
+      hash.add(key_len);
+      hash.add(key, key_len);
+
+      switch (type) {
+        case OT_INTEGER: {
+          SQInteger val;
+          sq_getinteger(vm, -1, &val);
+          hash.add(val);
+          break;
+        }
+        case OT_FLOAT: {
+          SQFloat val;
+          sq_getfloat(vm, -1, &val);
+          hash.add(val);
+          break;
+        }
+        case OT_BOOL: {
+          SQBool val = SQFalse;
+          sq_getbool(vm, -1, &val);
+          hash.add(val);
+          break;
+        }
+        case OT_STRING: {
+          const SQChar* str;
+          sq_getstring(vm, -1, &str);
+          const size_t len = strlen(str);
+          hash.add(len);
+          hash.add(str, len);
+          break;
+        }
+        case OT_TABLE:
+          hash_table(vm, -1, hash);
+          // end marker, so the next key can't be mistaken as part of the subtable
+          hash.add(OT_NULL);
+          break;
+        default:
+          break;
+      }
+    }
+    sq_pop(vm, 2);
+  }
+  sq_pop(vm, 1);
+}
+
+void write_table(HSQUIRRELVM vm, SQInteger table_idx, Writer& writer,
+                 SquirrelTableCache* cache, const std::string& path, int depth)
 {
   // offset because of sq_pushnull
   if (table_idx < 0)
@@ -97,6 +167,7 @@ void save_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, Writer& writer)
   while (SQ_SUCCEEDED(sq_next(vm, table_idx))) {
     if (sq_gettype(vm, -2) != OT_STRING) {
       std::cerr << "Table contains non-string key\n";
+      sq_pop(vm, 2);
       continue;
     }
     const SQChar* key;
@@ -128,9 +199,33 @@ void save_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, Writer& writer)
         break;
       }
       case OT_TABLE: {
-        writer.start_list(key, true);
-        save_squirrel_table(vm, -1, writer);
-        writer.end_list(key);
+        if (!cache) {
+          writer.start_list(key, true);
+          write_table(vm, -1, writer, nullptr, path, depth + 1);
+          writer.end_list(key);
+        } else {
+          // '\0' can't be part of a key, so paths are unambiguous
+          const std::string subpath = path.empty() ? std::string(key) : path + '\0' + key;
+          if (depth + 1 < CACHED_DEPTH) {
+            writer.start_list(key, true);
+            write_table(vm, -1, writer, cache, subpath, depth + 1);
+            writer.end_list(key);
+          } else {
+            FNVHash hash;
+            hash_table(vm, -1, hash);
+            if (const std::string* text = cache->find(subpath, hash.get())) {
+              writer.write_raw(*text);
+            } else {
+              std::ostringstream out;
+              Writer fragment(out, writer.get_indent_depth());
+              fragment.start_list(key, true);
+              write_table(vm, -1, fragment, nullptr, subpath, depth + 1);
+              fragment.end_list(key);
+              cache->store(subpath, hash.get(), out.str());
+              writer.write_raw(out.str());
+            }
+          }
+        }
         break;
       }
       case OT_CLOSURE:
@@ -146,4 +241,58 @@ void save_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, Writer& writer)
   sq_pop(vm, 1);
 }
 
+} // namespace
+
+SquirrelTableCache::SquirrelTableCache() :
+  m_fragments()
+{
+}
+
+const std::string*
+SquirrelTableCache::find(const std::string& path, uint64_t hash)
+{
+  auto it = m_fragments.find(path);
+  if (it == m_fragments.end() || it->second.hash != hash)
+    return nullptr;
+
+  it->second.used = true;
+  return &it->second.text;
+}
+
+void
+SquirrelTableCache::store(const std::string& path, uint64_t hash, const std::string& text)
+{
+  m_fragments[path] = Fragment{hash, text, true};
+}
+
+void
+SquirrelTableCache::prune()
+{
+  for (auto it = m_fragments.begin(); it != m_fragments.end();) {
+    if (it->second.used) {
+      it->second.used = false;
+      ++it;
+    } else {
+      it = m_fragments.erase(it);
+    }
+  }
+}
+
+void save_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, Writer& writer)
+{
+  write_table(vm, table_idx, writer, nullptr, std::string(), 0);
+}
+
+void save_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, Writer& writer, SquirrelTableCache& cache)
+{
+  write_table(vm, table_idx, writer, &cache, std::string(), 0);
+}
+
+uint64_t hash_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx)
+{
+  FNVHash hash;
+  hash_table(vm, table_idx, hash);
+  return hash.get();
+}
+
 /* EOF */
@@ -18,13 +18,59 @@
 #define HEADER_SUPERTUX_SQUIRREL_SERIALIZE_HPP
 
 #include <squirrel.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
 
 class ReaderMapping;
 class Writer;
 
+/** Keeps the serialized text of the tables two levels below the
+    table given to save_squirrel_table(), e.g. state.worlds["..."],
+    together with a hash of their content. Unchanged tables are then
+    only hashed instead of formatted again. */
+class SquirrelTableCache final
+{
+public:
+  SquirrelTableCache();
+
+  /** Returns the text stored for path if its hash matches, nullptr
+      otherwise */
+  const std::string* find(const std::string& path, uint64_t hash);
+  void store(const std::string& path, uint64_t hash, const std::string& text);
+
+  /** Drops every entry that wasn't found or stored since the last
+      call, i.e. tables that have been removed */
+  void prune();
+
+  void clear() { m_fragments.clear(); }
+
+private:
+  struct Fragment
+  {
+    uint64_t hash;
+    std::string text;
+    bool used;
+  };
+
+private:
+  std::unordered_map<std::string, Fragment> m_fragments;
+
+private:
+  SquirrelTableCache(const SquirrelTableCache&) = delete;
+  SquirrelTableCache& operator=(const SquirrelTableCache&) = delete;
+};
+
 void save_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, Writer& writer);
+
+/** Same output as above, but only formats subtables that aren't in
+    cache yet */
+void save_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, Writer& writer, SquirrelTableCache& cache);
 void load_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx, const ReaderMapping& mapping);
 
+/** Hash of everything save_squirrel_table() would write for the table */
+uint64_t hash_squirrel_table(HSQUIRRELVM vm, SQInteger table_idx);
+
 #endif
 
 /* EOF */
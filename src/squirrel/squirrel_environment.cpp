@@ -21,21 +21,42 @@
 #include "squirrel/script_interface.hpp"
 #include "squirrel/squirrel_error.hpp"
 #include "squirrel/squirrel_scheduler.hpp"
+#include "squirrel/squirrel_script_cache.hpp"
 #include "squirrel/squirrel_util.hpp"
 #include "squirrel/squirrel_virtual_machine.hpp"
 #include "supertux/game_object.hpp"
+#include "supertux/game_object_manager.hpp"
 #include "supertux/globals.hpp"
 #include "util/log.hpp"
 
+namespace {
+
+void collect_garbage(SquirrelVM& vm)
+{
+  // defer to the frame loop if this is the VM it takes care of
+  SquirrelVirtualMachine* vm_manager = SquirrelVirtualMachine::current();
+  if (vm_manager && &vm_manager->get_vm() == &vm) {
+    vm_manager->request_garbage_collection();
+  } else {
+    sq_collectgarbage(vm.get_vm());
+  }
+}
+
+} // namespace
+
 SquirrelEnvironment::SquirrelEnvironment(SquirrelVM& vm, const std::string& name) :
   m_vm(vm),
   m_table(),
   m_name(name),
   m_scripts(),
-  m_scheduler(std::make_unique<SquirrelScheduler>(m_vm))
+  m_scheduler(std::make_unique<SquirrelScheduler>(m_vm)),
+  m_object_manager(nullptr),
+  m_self_exposed(false),
+  m_exposed_objects(),
+  m_symbols()
 {
   // garbage collector has to be invoked manually
-  sq_collectgarbage(m_vm.get_vm());
+  collect_garbage(m_vm);
 
   sq_newtable(m_vm.get_vm());
   sq_pushroottable(m_vm.get_vm());
@@ -60,7 +81,11 @@ SquirrelEnvironment::~SquirrelEnvironment()
   m_scripts.clear();
   sq_release(m_vm.get_vm(), &m_table);
 
-  sq_collectgarbage(m_vm.get_vm());
+  if (m_self_exposed) {
+    m_vm.unregister_environment(m_name, this);
+  }
+
+  collect_garbage(m_vm);
 }
 
 void
@@ -69,6 +94,8 @@ SquirrelEnvironment::expose_self()
   sq_pushroottable(m_vm.get_vm());
   m_vm.store_object(m_name.c_str(), m_table);
   sq_pop(m_vm.get_vm(), 1);
+  m_self_exposed = true;
+  m_vm.register_environment(m_name, this);
 }
 
 void
@@ -77,38 +104,138 @@ SquirrelEnvironment::unexpose_self()
   sq_pushroottable(m_vm.get_vm());
   m_vm.delete_table_entry(m_name.c_str());
   sq_pop(m_vm.get_vm(), 1);
+  m_self_exposed = false;
+  m_vm.unregister_environment(m_name, this);
+}
+
+void
+SquirrelEnvironment::enable_lazy_exposure(const GameObjectManager& manager)
+{
+  HSQUIRRELVM vm = m_vm.get_vm();
+  m_object_manager = &manager;
+
+  // m_table -> delegate with _get -> roottable
+  sq_pushobject(vm, m_table);
+  sq_newtable(vm);
+  sq_pushroottable(vm);
+  if (SQ_FAILED(sq_setdelegate(vm, -2)))
+    throw SquirrelError(vm, "Couldn't set table delegate");
+
+  sq_pushstring(vm, "_get", -1);
+  sq_pushuserpointer(vm, this);
+  sq_newclosure(vm, &SquirrelEnvironment::lazy_get, 1);
+  if (SQ_FAILED(sq_createslot(vm, -3)))
+    throw SquirrelError(vm, "Couldn't register _get");
+
+  if (SQ_FAILED(sq_setdelegate(vm, -2)))
+    throw SquirrelError(vm, "Couldn't set table delegate");
+  sq_pop(vm, 1);
+}
+
+SQInteger
+SquirrelEnvironment::lazy_get(HSQUIRRELVM vm)
+{
+  SQUserPointer data;
+  const SQChar* name;
+  if (SQ_SUCCEEDED(sq_getuserpointer(vm, sq_gettop(vm), &data)) &&
+      SQ_SUCCEEDED(sq_getstring(vm, 2, &name)))
+  {
+    auto& env = *static_cast<SquirrelEnvironment*>(data);
+    GameObject* object = env.m_self_exposed ? env.m_object_manager->get_object_by_name<GameObject>(name) : nullptr;
+    auto script_object = dynamic_cast<ScriptInterface*>(object);
+    if (script_object && !env.m_exposed_objects.count(object))
+    {
+      // exceptions must not unwind through the VM
+      try {
+        env.expose_script_object(*object, *script_object);
+      } catch(const std::exception& e) {
+        log_warning << "Couldn't expose object '" << name << "': " << e.what() << std::endl;
+      }
+
+      sq_pushobject(vm, env.m_table);
+      sq_pushstring(vm, name, -1);
+      if (SQ_SUCCEEDED(sq_rawget(vm, -2)))
+        return 1;
+    }
+  }
+
+  // a null error tells the VM that the slot doesn't exist
+  sq_pushnull(vm);
+  return sq_throwobject(vm);
+}
+
+void
+SquirrelEnvironment::expose_script_object(GameObject& object, ScriptInterface& script_object)
+{
+  sq_pushobject(m_vm.get_vm(), m_table);
+  script_object.expose(m_vm.get_vm(), -1);
+  sq_pop(m_vm.get_vm(), 1);
+
+  if (m_object_manager) {
+    m_exposed_objects.insert(&object);
+  }
 }
 
 void
 SquirrelEnvironment::try_expose(GameObject& object)
 {
   auto script_object = dynamic_cast<ScriptInterface*>(&object);
-  if (script_object != nullptr) {
-    sq_pushobject(m_vm.get_vm(), m_table);
-    script_object->expose(m_vm.get_vm(), -1);
-    sq_pop(m_vm.get_vm(), 1);
+  if (script_object == nullptr)
+    return;
+
+  if (!object.get_name().empty()) {
+    m_symbols.add(object.get_name());
+  }
+
+  if (m_object_manager)
+  {
+    if (object.get_name().empty())
+      return;
+
+    // globals win over the lazy lookup, so only names that are
+    // already taken need an instance up front
+    HSQUIRRELVM vm = m_vm.get_vm();
+    sq_pushroottable(vm);
+    sq_pushstring(vm, object.get_name().c_str(), -1);
+    const bool shadows_global = SQ_SUCCEEDED(sq_rawget(vm, -2));
+    sq_pop(vm, shadows_global ? 2 : 1);
+
+    if (!shadows_global)
+      return;
   }
+
+  expose_script_object(object, *script_object);
 }
 
 void
 SquirrelEnvironment::try_unexpose(GameObject& object)
 {
   auto script_object = dynamic_cast<ScriptInterface*>(&object);
-  if (script_object != nullptr) {
-    SQInteger oldtop = sq_gettop(m_vm.get_vm());
-    sq_pushobject(m_vm.get_vm(), m_table);
-    try {
-      script_object->unexpose(m_vm.get_vm(), -1);
-    } catch(std::exception& e) {
-      log_warning << "Couldn't unregister object: " << e.what() << std::endl;
-    }
-    sq_settop(m_vm.get_vm(), oldtop);
+  if (script_object == nullptr)
+    return;
+
+  if (!object.get_name().empty()) {
+    m_symbols.remove(object.get_name());
+  }
+
+  if (m_object_manager && !m_exposed_objects.erase(&object))
+    return;
+
+  SQInteger oldtop = sq_gettop(m_vm.get_vm());
+  sq_pushobject(m_vm.get_vm(), m_table);
+  try {
+    script_object->unexpose(m_vm.get_vm(), -1);
+  } catch(std::exception& e) {
+    log_warning << "Couldn't unregister object: " << e.what() << std::endl;
   }
+  sq_settop(m_vm.get_vm(), oldtop);
 }
 
 void
 SquirrelEnvironment::unexpose(const std::string& name)
 {
+  m_symbols.remove(name);
+
   SQInteger oldtop = sq_gettop(m_vm.get_vm());
   sq_pushobject(m_vm.get_vm(), m_table);
   try {
@@ -124,8 +251,24 @@ SquirrelEnvironment::run_script(const std::string& script, const std::string& so
 {
   if (script.empty()) return;
 
-  std::istringstream stream(script);
-  run_script(stream, sourcename);
+  garbage_collect();
+
+  try
+  {
+    HSQUIRRELVM vm = prepare_thread();
+
+    if (SquirrelScriptCache::current()) {
+      SquirrelScriptCache::current()->push_closure(vm, script, sourcename);
+      run_compiled_script(vm);
+    } else {
+      std::istringstream stream(script);
+      compile_and_run(vm, stream, sourcename);
+    }
+  }
+  catch(const std::exception& e)
+  {
+    log_warning << "Error running script: " << e.what() << std::endl;
+  }
 }
 
 void
@@ -153,17 +296,7 @@ SquirrelEnvironment::run_script(std::istream& in, const std::string& sourcename)
 
   try
   {
-    HSQOBJECT object = m_vm.create_thread();
-    m_scripts.push_back(object);
-
-    HSQUIRRELVM vm = object_to_vm(object);
-
-    sq_setforeignptr(vm, this);
-
-    // set root table
-    sq_pushobject(vm, m_table);
-    sq_setroottable(vm);
-
+    HSQUIRRELVM vm = prepare_thread();
     compile_and_run(vm, in, sourcename);
   }
   catch(const std::exception& e)
@@ -172,6 +305,23 @@ SquirrelEnvironment::run_script(std::istream& in, const std::string& sourcename)
   }
 }
 
+HSQUIRRELVM
+SquirrelEnvironment::prepare_thread()
+{
+  HSQOBJECT object = m_vm.create_thread();
+  m_scripts.push_back(object);
+
+  HSQUIRRELVM vm = object_to_vm(object);
+
+  sq_setforeignptr(vm, this);
+
+  // set root table
+  sq_pushobject(vm, m_table);
+  sq_setroottable(vm);
+
+  return vm;
+}
+
 void
 SquirrelEnvironment::wait_for_seconds(HSQUIRRELVM vm, float seconds)
 {
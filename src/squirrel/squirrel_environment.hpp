@@ -19,13 +19,16 @@
 #define HEADER_SUPERTUX_SQUIRREL_SQUIRREL_ENVIRONMENT_HPP
 
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include <squirrel.h>
 
 #include "squirrel/squirrel_util.hpp"
+#include "squirrel/symbol_index.hpp"
 
 class GameObject;
+class GameObjectManager;
 class ScriptInterface;
 class SquirrelVM;
 
@@ -41,10 +44,21 @@ public:
 public:
   SquirrelVM& get_vm() const { return m_vm; }
 
+  /** Names of the objects reachable through the table of this
+      environment, including those that are exposed lazily */
+  const SymbolIndex& get_symbols() const { return m_symbols; }
+
   /** Expose this engine under 'name' */
   void expose_self();
   void unexpose_self();
 
+  /** Named objects of manager are exposed when a script first looks
+      them up, try_expose() then only handles names that would
+      otherwise be hidden by a global of the same name, e.g. the
+      'Camera' object and class. Lookups only succeed while the
+      environment is exposed. */
+  void enable_lazy_exposure(const GameObjectManager& manager);
+
   /** Expose the GameObject if it has a ScriptInterface, otherwise do
       nothing. */
   void try_expose(GameObject& object);
@@ -58,11 +72,12 @@ public:
     sq_pushobject(m_vm.get_vm(), m_table);
     expose_object(m_vm.get_vm(), -1, std::move(script_object), name.c_str());
     sq_pop(m_vm.get_vm(), 1);
+    m_symbols.add(name);
   }
   void unexpose(const std::string& name);
 
-  /** Convenience function that takes an std::string instead of an
-      std::istream& */
+  /** Like run_script(std::istream&, ...), but compiled scripts are
+      reused through the SquirrelScriptCache */
   void run_script(const std::string& script, const std::string& sourcename);
 
   /** Runs a script in the context of the SquirrelEnvironment (m_table will
@@ -77,6 +92,14 @@ public:
 private:
   void garbage_collect();
 
+  /** _get metamethod of the delegate of m_table in lazy mode */
+  static SQInteger lazy_get(HSQUIRRELVM vm);
+
+  void expose_script_object(GameObject& object, ScriptInterface& script_object);
+
+  /** Creates a new thread for a script, running in this environment */
+  HSQUIRRELVM prepare_thread();
+
 private:
   SquirrelVM& m_vm;
   HSQOBJECT m_table;
@@ -84,6 +107,14 @@ private:
   std::vector<HSQOBJECT> m_scripts;
   std::unique_ptr<SquirrelScheduler> m_scheduler;
 
+  const GameObjectManager* m_object_manager;
+  bool m_self_exposed;
+
+  /** Objects that got a squirrel instance, only tracked in lazy mode */
+  std::unordered_set<const GameObject*> m_exposed_objects;
+
+  SymbolIndex m_symbols;
+
 private:
   SquirrelEnvironment(const SquirrelEnvironment&) = delete;
   SquirrelEnvironment& operator=(const SquirrelEnvironment&) = delete;
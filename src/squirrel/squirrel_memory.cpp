@@ -0,0 +1,102 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "squirrel/squirrel_memory.hpp"
+
+#include <config.h>
+
+#include <atomic>
+#include <squirrel.h>
+#include <stdlib.h>
+
+namespace {
+
+std::atomic<size_t> s_bytes(0);
+std::atomic<size_t> s_peak_bytes(0);
+
+#ifdef SQUIRREL_MEMORY_TRACKING
+void add_bytes(size_t bytes)
+{
+  const size_t current = s_bytes.fetch_add(bytes, std::memory_order_relaxed) + bytes;
+  size_t peak = s_peak_bytes.load(std::memory_order_relaxed);
+  while (current > peak &&
+         !s_peak_bytes.compare_exchange_weak(peak, current, std::memory_order_relaxed)) {}
+}
+#endif
+
+} // namespace
+
+#ifdef SQUIRREL_MEMORY_TRACKING
+
+// squirrel is built with SQ_EXCLUDE_DEFAULT_MEMFUNCTIONS and calls
+// these instead of its own, the VM passes the size of every block
+
+void*
+sq_vm_malloc(SQUnsignedInteger size)
+{
+  void* p = malloc(size);
+  if (p) {
+    add_bytes(size);
+  }
+  return p;
+}
+
+void*
+sq_vm_realloc(void* p, SQUnsignedInteger oldsize, SQUnsignedInteger size)
+{
+  void* result = realloc(p, size);
+  if (result || size == 0)
+  {
+    s_bytes.fetch_sub(oldsize, std::memory_order_relaxed);
+    add_bytes(size);
+  }
+  return result;
+}
+
+void
+sq_vm_free(void* p, SQUnsignedInteger size)
+{
+  if (p) {
+    s_bytes.fetch_sub(size, std::memory_order_relaxed);
+  }
+  free(p);
+}
+
+#endif
+
+bool
+SquirrelMemory::is_available()
+{
+#ifdef SQUIRREL_MEMORY_TRACKING
+  return true;
+#else
+  return false;
+#endif
+}
+
+size_t
+SquirrelMemory::get_bytes()
+{
+  return s_bytes.load(std::memory_order_relaxed);
+}
+
+size_t
+SquirrelMemory::get_peak_bytes()
+{
+  return s_peak_bytes.load(std::memory_order_relaxed);
+}
+
+/* EOF */
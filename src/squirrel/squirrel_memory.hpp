@@ -0,0 +1,41 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_SQUIRREL_SQUIRREL_MEMORY_HPP
+#define HEADER_SUPERTUX_SQUIRREL_SQUIRREL_MEMORY_HPP
+
+#include <stddef.h>
+
+/** Bytes allocated by the Squirrel VM. Builds with
+    SQUIRREL_MEMORY_TRACKING provide the allocation functions of the
+    VM, otherwise nothing is counted. */
+class SquirrelMemory final
+{
+public:
+  /** True if the allocations of the VM are counted in this build */
+  static bool is_available();
+
+  /** Bytes currently allocated by the VM and the most it ever had */
+  static size_t get_bytes();
+  static size_t get_peak_bytes();
+
+private:
+  SquirrelMemory() = delete;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,175 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "squirrel/squirrel_profiler.hpp"
+
+#include <fstream>
+#include <sstream>
+
+#include "util/log.hpp"
+
+namespace {
+
+/** Guards against stacks that got out of sync, e.g. when an
+    exception unwound frames without return events */
+const size_t MAX_STACK_DEPTH = 512;
+
+std::string frame_name(const SQChar* funcname, const SQChar* sourcename, SQInteger line)
+{
+  std::ostringstream out;
+  out << (funcname ? funcname : "unknown")
+      << " (" << (sourcename ? sourcename : "?") << ":" << line << ")";
+  return out.str();
+}
+
+} // namespace
+
+SquirrelProfiler::Node*
+SquirrelProfiler::Node::get_child(const std::string& name)
+{
+  auto& child = children[name];
+  if (!child) {
+    child = std::make_unique<Node>();
+  }
+  return child.get();
+}
+
+SquirrelProfiler::SquirrelProfiler(HSQUIRRELVM vm, const std::string& filename) :
+  m_vm(vm),
+  m_filename(filename),
+  m_root(),
+  m_threads()
+{
+  // line events need debug info in the compiled scripts
+  sq_enabledebuginfo(m_vm, SQTrue);
+  sq_setnativedebughook(m_vm, &SquirrelProfiler::debug_hook);
+}
+
+SquirrelProfiler::~SquirrelProfiler()
+{
+  sq_setnativedebughook(m_vm, nullptr);
+
+  std::ofstream out(m_filename.c_str());
+  if (!out)
+  {
+    log_warning << "Couldn't write script profile '" << m_filename << "'" << std::endl;
+    return;
+  }
+  write(out);
+}
+
+void
+SquirrelProfiler::debug_hook(HSQUIRRELVM vm, SQInteger type, const SQChar* sourcename,
+                             SQInteger line, const SQChar* funcname)
+{
+  if (SquirrelProfiler::current()) {
+    SquirrelProfiler::current()->on_event(vm, type, sourcename, line, funcname);
+  }
+}
+
+void
+SquirrelProfiler::suspend(HSQUIRRELVM vm)
+{
+  auto it = m_threads.find(vm);
+  if (it == m_threads.end())
+    return;
+
+  ThreadState& state = it->second;
+  if (state.running && !state.stack.empty()) {
+    state.stack.back().leaf->self_time += Clock::now() - state.last_event;
+  }
+  state.running = false;
+}
+
+void
+SquirrelProfiler::on_event(HSQUIRRELVM vm, SQInteger type, const SQChar* sourcename,
+                           SQInteger line, const SQChar* funcname)
+{
+  const Clock::time_point now = Clock::now();
+  ThreadState& state = m_threads[vm];
+
+  // everything since the last event belongs to the previous position,
+  // unless the thread was suspended in between
+  if (state.running && !state.stack.empty()) {
+    state.stack.back().leaf->self_time += now - state.last_event;
+  }
+
+  switch (type)
+  {
+    case 'c':
+    {
+      if (state.stack.size() >= MAX_STACK_DEPTH) {
+        state.stack.clear();
+      }
+      Node* parent = state.stack.empty() ? &m_root : state.stack.back().function;
+      Node* function = parent->get_child(frame_name(funcname, sourcename, line));
+      state.stack.push_back(Frame{function, function});
+      break;
+    }
+
+    case 'r':
+      if (!state.stack.empty()) {
+        state.stack.pop_back();
+      }
+      break;
+
+    case 'l':
+      if (!state.stack.empty())
+      {
+        std::ostringstream name;
+        name << (sourcename ? sourcename : "?") << ":" << line;
+        state.stack.back().leaf = state.stack.back().function->get_child(name.str());
+      }
+      break;
+
+    default:
+      break;
+  }
+
+  if (state.stack.empty()) {
+    // the thread is done for now, drop it so recycled VM pointers
+    // start with a fresh state
+    m_threads.erase(vm);
+  } else {
+    state.running = true;
+    // don't count the time spent in the hook itself
+    state.last_event = Clock::now();
+  }
+}
+
+void
+SquirrelProfiler::write(std::ostream& out) const
+{
+  for (const auto& it : m_root.children) {
+    write(out, *it.second, it.first);
+  }
+}
+
+void
+SquirrelProfiler::write(std::ostream& out, const Node& node, const std::string& prefix) const
+{
+  const auto usec = std::chrono::duration_cast<std::chrono::microseconds>(node.self_time).count();
+  if (usec > 0) {
+    out << prefix << " " << usec << "\n";
+  }
+
+  for (const auto& it : node.children) {
+    write(out, *it.second, prefix + ";" + it.first);
+  }
+}
+
+/* EOF */
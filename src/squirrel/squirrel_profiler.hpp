@@ -0,0 +1,103 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_SQUIRREL_SQUIRREL_PROFILER_HPP
+#define HEADER_SUPERTUX_SQUIRREL_SQUIRREL_PROFILER_HPP
+
+#include <chrono>
+#include <memory>
+#include <ostream>
+#include <squirrel.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "util/currenton.hpp"
+
+/** Instrumenting profiler for scripts, driven by the native debug
+    hook of the VM. Time is attributed to the call stack of the
+    running thread and the current source line, the stacks of all
+    threads and SquirrelEnvironments go into one tree. The report is
+    in the folded format of flamegraph.pl, one line per stack with
+    its self time in microseconds. */
+class SquirrelProfiler final : public Currenton<SquirrelProfiler>
+{
+public:
+  /** Installs the hook on vm, threads created from it inherit it */
+  SquirrelProfiler(HSQUIRRELVM vm, const std::string& filename);
+
+  /** Writes the report and removes the hook */
+  ~SquirrelProfiler();
+
+  /** Called before vm is suspended, so the time until it is woken up
+      again doesn't end up in the profile */
+  void suspend(HSQUIRRELVM vm);
+
+  void write(std::ostream& out) const;
+
+private:
+  typedef std::chrono::steady_clock Clock;
+
+  struct Node
+  {
+    Node() : children(), self_time() {}
+
+    std::unordered_map<std::string, std::unique_ptr<Node>> children;
+    Clock::duration self_time;
+
+    Node* get_child(const std::string& name);
+  };
+
+  struct Frame
+  {
+    Node* function;
+    /** node of the current line, or function if there is no line info */
+    Node* leaf;
+  };
+
+  struct ThreadState
+  {
+    ThreadState() : stack(), last_event(), running(false) {}
+
+    std::vector<Frame> stack;
+    Clock::time_point last_event;
+    bool running;
+  };
+
+private:
+  static void debug_hook(HSQUIRRELVM vm, SQInteger type, const SQChar* sourcename,
+                         SQInteger line, const SQChar* funcname);
+
+  void on_event(HSQUIRRELVM vm, SQInteger type, const SQChar* sourcename,
+                SQInteger line, const SQChar* funcname);
+
+  void write(std::ostream& out, const Node& node, const std::string& prefix) const;
+
+private:
+  HSQUIRRELVM m_vm;
+  std::string m_filename;
+  Node m_root;
+  std::unordered_map<HSQUIRRELVM, ThreadState> m_threads;
+
+private:
+  SquirrelProfiler(const SquirrelProfiler&) = delete;
+  SquirrelProfiler& operator=(const SquirrelProfiler&) = delete;
+};
+
+#endif
+
+/* EOF */
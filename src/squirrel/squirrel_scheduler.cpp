@@ -16,73 +16,96 @@
 
 #include "squirrel/squirrel_scheduler.hpp"
 
-#include <algorithm>
+#include <sstream>
 
+#include "squirrel/squirrel_error.hpp"
+#include "squirrel/squirrel_profiler.hpp"
 #include "squirrel/squirrel_virtual_machine.hpp"
 #include "squirrel/squirrel_util.hpp"
+#include "supertux/constants.hpp"
 #include "util/log.hpp"
+#include "util/profiler.hpp"
 
 SquirrelScheduler::SquirrelScheduler(SquirrelVM& vm) :
   m_vm(vm),
-  schedule()
+  m_schedule(LOGICAL_FPS),
+  m_due()
 {
 }
 
+SquirrelScheduler::~SquirrelScheduler()
+{
+  m_schedule.for_each([this](const Schedule::Entry& entry) {
+      HSQOBJECT thread_ref = entry.value;
+      sq_release(m_vm.get_vm(), &thread_ref);
+    });
+}
+
 void
 SquirrelScheduler::update(float time)
 {
-  while (!schedule.empty() && schedule.front().wakeup_time < time) {
-    HSQOBJECT thread_ref = schedule.front().thread_ref;
-
-    sq_pushobject(m_vm.get_vm(), thread_ref);
-    sq_getweakrefval(m_vm.get_vm(), -1);
-
-    HSQUIRRELVM scheduled_vm;
-    if (sq_gettype(m_vm.get_vm(), -1) == OT_THREAD &&
-       SQ_SUCCEEDED(sq_getthread(m_vm.get_vm(), -1, &scheduled_vm))) {
-      if (SQ_FAILED(sq_wakeupvm(scheduled_vm, SQFalse, SQFalse, SQTrue, SQFalse))) {
-        std::ostringstream msg;
-        msg << "Error waking VM: ";
-        sq_getlasterror(scheduled_vm);
-        if (sq_gettype(scheduled_vm, -1) != OT_STRING) {
-          msg << "(no info)";
-        } else {
-          const char* lasterr;
-          sq_getstring(scheduled_vm, -1, &lasterr);
-          msg << lasterr;
-        }
-        log_warning << msg.str() << std::endl;
-        sq_pop(scheduled_vm, 1);
-      }
-    }
+  Profiler::Scope profile_scope("scheduler");
 
-    sq_release(m_vm.get_vm(), &thread_ref);
-    sq_pop(m_vm.get_vm(), 2);
+  m_schedule.collect(time, m_due);
+
+  // woken threads may schedule themselves again, which only touches
+  // the wheel, not m_due
+  for (const auto& entry : m_due) {
+    wakeup(entry.value);
+  }
+  m_due.clear();
+}
 
-    std::pop_heap(schedule.begin(), schedule.end());
-    schedule.pop_back();
+void
+SquirrelScheduler::wakeup(HSQOBJECT thread_ref)
+{
+  sq_pushobject(m_vm.get_vm(), thread_ref);
+  sq_getweakrefval(m_vm.get_vm(), -1);
+
+  HSQUIRRELVM scheduled_vm;
+  if (sq_gettype(m_vm.get_vm(), -1) == OT_THREAD &&
+     SQ_SUCCEEDED(sq_getthread(m_vm.get_vm(), -1, &scheduled_vm))) {
+    if (SQ_FAILED(sq_wakeupvm(scheduled_vm, SQFalse, SQFalse, SQTrue, SQFalse))) {
+      std::ostringstream msg;
+      msg << "Error waking VM: ";
+      sq_getlasterror(scheduled_vm);
+      if (sq_gettype(scheduled_vm, -1) != OT_STRING) {
+        msg << "(no info)";
+      } else {
+        const char* lasterr;
+        sq_getstring(scheduled_vm, -1, &lasterr);
+        msg << lasterr;
+      }
+      log_warning << msg.str() << std::endl;
+      sq_pop(scheduled_vm, 1);
+    }
   }
+
+  sq_release(m_vm.get_vm(), &thread_ref);
+  sq_pop(m_vm.get_vm(), 2);
 }
 
 void
 SquirrelScheduler::schedule_thread(HSQUIRRELVM scheduled_vm, float time)
 {
+  if (SquirrelProfiler::current()) {
+    SquirrelProfiler::current()->suspend(scheduled_vm);
+  }
+
   // create a weakref to the VM
   sq_pushthread(m_vm.get_vm(), scheduled_vm);
   sq_weakref(m_vm.get_vm(), -1);
 
-  ScheduleEntry entry;
-  if (SQ_FAILED(sq_getstackobj(m_vm.get_vm(), -1, & entry.thread_ref))) {
+  HSQOBJECT thread_ref;
+  if (SQ_FAILED(sq_getstackobj(m_vm.get_vm(), -1, &thread_ref))) {
     sq_pop(m_vm.get_vm(), 2);
     throw SquirrelError(m_vm.get_vm(), "Couldn't get thread weakref from vm");
   }
-  entry.wakeup_time = time;
 
-  sq_addref(m_vm.get_vm(), & entry.thread_ref);
+  sq_addref(m_vm.get_vm(), &thread_ref);
   sq_pop(m_vm.get_vm(), 2);
 
-  schedule.push_back(entry);
-  std::push_heap(schedule.begin(), schedule.end());
+  m_schedule.insert(thread_ref, time);
 }
 
 /* EOF */
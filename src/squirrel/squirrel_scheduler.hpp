@@ -21,38 +21,37 @@
 
 #include <squirrel.h>
 
+#include "util/timer_wheel.hpp"
+
 class SquirrelVM;
 
 /** This class keeps a list of squirrel threads that are scheduled for a certain
-    time. (the typical result of a wait() command in a squirrel script) */
+    time. (the typical result of a wait() command in a squirrel script)
+    Threads are kept in a timer wheel with one tick per logical frame
+    and all threads due in a frame are woken up in one batch. */
 class SquirrelScheduler final
 {
 public:
   SquirrelScheduler(SquirrelVM& vm);
+  ~SquirrelScheduler();
 
   /** time must be absolute time, not relative updates, i.e. g_game_time */
   void update(float time);
   void schedule_thread(HSQUIRRELVM vm, float time);
 
 private:
-  struct ScheduleEntry {
-    /// weak reference to the squirrel vm object
-    HSQOBJECT thread_ref;
-    /// time when the thread should be woken up
-    float wakeup_time;
+  /** weak references to the squirrel vm objects */
+  typedef TimerWheel<HSQOBJECT> Schedule;
 
-    bool operator<(const ScheduleEntry& other) const
-    {
-      // we need the smallest value on top
-      return wakeup_time > other.wakeup_time;
-    }
-  };
+private:
+  void wakeup(HSQOBJECT thread_ref);
 
 private:
   SquirrelVM& m_vm;
+  Schedule m_schedule;
 
-  typedef std::vector<ScheduleEntry> ScheduleHeap;
-  ScheduleHeap schedule;
+  /** Threads woken up in the current update() */
+  std::vector<Schedule::Entry> m_due;
 
 private:
   SquirrelScheduler(const SquirrelScheduler&) = delete;
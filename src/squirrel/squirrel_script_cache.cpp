@@ -0,0 +1,195 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "squirrel/squirrel_script_cache.hpp"
+
+#include <physfs.h>
+#include <stdio.h>
+
+#include "squirrel/squirrel_error.hpp"
+#include "supertux/gameconfig.hpp"
+#include "supertux/globals.hpp"
+#include "util/fnv_hash.hpp"
+#include "util/log.hpp"
+
+namespace {
+
+const char CACHE_DIRECTORY[] = "cache/squirrel";
+
+/** Scripts are tiny, this only guards against sessions that go
+    through a lot of add-on levels */
+const size_t MAX_ENTRIES = 4096;
+
+SQInteger read_func(SQUserPointer file, SQUserPointer buffer, SQInteger size)
+{
+  const PHYSFS_sint64 count = PHYSFS_readBytes(static_cast<PHYSFS_File*>(file), buffer,
+                                               static_cast<PHYSFS_uint64>(size));
+  // sq_readclosure() treats anything but a full read as an error
+  return count < 0 ? -1 : static_cast<SQInteger>(count);
+}
+
+SQInteger write_func(SQUserPointer file, SQUserPointer buffer, SQInteger size)
+{
+  const PHYSFS_sint64 count = PHYSFS_writeBytes(static_cast<PHYSFS_File*>(file), buffer,
+                                                static_cast<PHYSFS_uint64>(size));
+  return count < 0 ? -1 : static_cast<SQInteger>(count);
+}
+
+} // namespace
+
+SquirrelScriptCache::SquirrelScriptCache(HSQUIRRELVM vm) :
+  m_vm(vm),
+  m_entries()
+{
+}
+
+SquirrelScriptCache::~SquirrelScriptCache()
+{
+  clear();
+}
+
+void
+SquirrelScriptCache::clear()
+{
+  for (auto& it : m_entries) {
+    sq_release(m_vm, &it.second.closure);
+  }
+  m_entries.clear();
+}
+
+void
+SquirrelScriptCache::push_closure(HSQUIRRELVM vm, const std::string& source, const std::string& sourcename)
+{
+  FNVHash hash;
+  hash.add(SQUIRREL_VERSION_NUMBER);
+  hash.add(sourcename.data(), sourcename.size());
+  hash.add('\0');
+  hash.add(source.data(), source.size());
+  const uint64_t key = hash.get();
+
+  auto it = m_entries.find(key);
+  if (it != m_entries.end() &&
+      (it->second.source != source || it->second.sourcename != sourcename))
+  {
+    sq_release(m_vm, &it->second.closure);
+    m_entries.erase(it);
+    it = m_entries.end();
+  }
+
+  if (it != m_entries.end())
+  {
+    sq_pushobject(vm, it->second.closure);
+  }
+  else
+  {
+    char hex[17];
+    snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+    const std::string filename = std::string(CACHE_DIRECTORY) + "/" + hex + ".cnut";
+
+    const bool use_disk = g_config && g_config->script_bytecode_cache &&
+      !g_config->enable_script_debugger && g_config->script_profile_file.empty();
+    if (!use_disk || !load(vm, filename))
+    {
+      if (SQ_FAILED(sq_compilebuffer(vm, source.c_str(), static_cast<SQInteger>(source.size()),
+                                     sourcename.c_str(), SQTrue)))
+        throw SquirrelError(vm, "Couldn't parse script");
+
+      // demo benchmarks often run many at once, see SExpCache::set_read_only()
+      if (use_disk && !g_config->benchmark_demo) {
+        store(vm, filename);
+      }
+    }
+
+    if (m_entries.size() >= MAX_ENTRIES) {
+      clear();
+    }
+
+    Entry entry{source, sourcename, HSQOBJECT()};
+    sq_resetobject(&entry.closure);
+    sq_getstackobj(vm, -1, &entry.closure);
+    sq_addref(vm, &entry.closure);
+    m_entries.emplace(key, std::move(entry));
+  }
+
+  // the cached closure would still see the root table of whoever
+  // compiled it, run a copy bound to the current one instead
+  sq_pushroottable(vm);
+  if (SQ_FAILED(sq_bindenv(vm, -2))) {
+    sq_pop(vm, 2);
+    throw SquirrelError(vm, "Couldn't copy script closure");
+  }
+  sq_remove(vm, -2);
+
+  sq_pushroottable(vm);
+  if (SQ_FAILED(sq_setclosureroot(vm, -2))) {
+    sq_pop(vm, 2);
+    throw SquirrelError(vm, "Couldn't set script root table");
+  }
+}
+
+bool
+SquirrelScriptCache::load(HSQUIRRELVM vm, const std::string& filename)
+{
+  if (!PHYSFS_exists(filename.c_str()))
+    return false;
+
+  PHYSFS_File* file = PHYSFS_openRead(filename.c_str());
+  if (!file)
+    return false;
+
+  const SQInteger oldtop = sq_gettop(vm);
+  const bool success = SQ_SUCCEEDED(sq_readclosure(vm, read_func, file));
+  PHYSFS_close(file);
+
+  if (!success)
+  {
+    log_debug << "ignoring broken script cache entry '" << filename << "'" << std::endl;
+    sq_settop(vm, oldtop);
+    return false;
+  }
+  return true;
+}
+
+void
+SquirrelScriptCache::store(HSQUIRRELVM vm, const std::string& filename)
+{
+  if (!PHYSFS_exists(CACHE_DIRECTORY) && !PHYSFS_mkdir(CACHE_DIRECTORY))
+  {
+    log_warning << "couldn't create directory '" << CACHE_DIRECTORY << "': "
+                << PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()) << std::endl;
+    return;
+  }
+
+  PHYSFS_File* file = PHYSFS_openWrite(filename.c_str());
+  if (!file)
+  {
+    log_warning << "couldn't write '" << filename << "': "
+                << PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()) << std::endl;
+    return;
+  }
+
+  const bool success = SQ_SUCCEEDED(sq_writeclosure(vm, write_func, file));
+  PHYSFS_close(file);
+
+  if (!success)
+  {
+    // a truncated entry would be rejected on load, but don't keep it around
+    PHYSFS_delete(filename.c_str());
+  }
+}
+
+/* EOF */
@@ -0,0 +1,73 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_SQUIRREL_SQUIRREL_SCRIPT_CACHE_HPP
+#define HEADER_SUPERTUX_SQUIRREL_SQUIRREL_SCRIPT_CACHE_HPP
+
+#include <squirrel.h>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+
+#include "util/currenton.hpp"
+
+/** Compiles every distinct script only once per session. Scripts are
+    keyed by a hash of their source and name, the compiled closures
+    are copied for each run and bound to the root table of the thread
+    running them. With Config::script_bytecode_cache the bytecode is
+    also kept in the userdir for the next session. */
+class SquirrelScriptCache final : public Currenton<SquirrelScriptCache>
+{
+public:
+  SquirrelScriptCache(HSQUIRRELVM vm);
+  ~SquirrelScriptCache();
+
+  /** Pushes a closure running source onto the stack of vm, its root
+      table is the current root table of vm. Throws SquirrelError if
+      the script doesn't compile. */
+  void push_closure(HSQUIRRELVM vm, const std::string& source, const std::string& sourcename);
+
+  void clear();
+
+private:
+  struct Entry
+  {
+    std::string source;
+    std::string sourcename;
+    HSQOBJECT closure;
+  };
+
+private:
+  /** Pushes the closure stored in filename, returns false if there is
+      none or it doesn't fit this build */
+  bool load(HSQUIRRELVM vm, const std::string& filename);
+
+  /** Writes the closure on top of the stack to filename */
+  void store(HSQUIRRELVM vm, const std::string& filename);
+
+private:
+  HSQUIRRELVM m_vm;
+  std::unordered_map<uint64_t, Entry> m_entries;
+
+private:
+  SquirrelScriptCache(const SquirrelScriptCache&) = delete;
+  SquirrelScriptCache& operator=(const SquirrelScriptCache&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -16,6 +16,7 @@
 
 #include "squirrel/squirrel_thread_queue.hpp"
 
+#include "squirrel/squirrel_profiler.hpp"
 #include "squirrel/squirrel_virtual_machine.hpp"
 #include "squirrel/squirrel_util.hpp"
 #include "util/log.hpp"
@@ -29,6 +30,10 @@ SquirrelThreadQueue::SquirrelThreadQueue(SquirrelVM& vm) :
 void
 SquirrelThreadQueue::add(HSQUIRRELVM vm)
 {
+  if (SquirrelProfiler::current()) {
+    SquirrelProfiler::current()->suspend(vm);
+  }
+
   // create a weakref to the VM
   sq_pushthread(m_vm.get_vm(), vm);
   sq_weakref(m_vm.get_vm(), -1);
@@ -231,7 +231,11 @@ void compile_and_run(HSQUIRRELVM vm, std::istream& in,
                      const std::string& sourcename)
 {
   compile_script(vm, in, sourcename);
+  run_compiled_script(vm);
+}
 
+void run_compiled_script(HSQUIRRELVM vm)
+{
   SQInteger oldtop = sq_gettop(vm);
 
   try {
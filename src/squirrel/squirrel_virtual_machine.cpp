@@ -20,6 +20,7 @@
 #include <sqstdblob.h>
 #include <sqstdmath.h>
 #include <sqstdstring.h>
+#include <chrono>
 #include <cstring>
 #include <stdarg.h>
 #include <stdio.h>
@@ -27,12 +28,17 @@
 #include "physfs/ifile_stream.hpp"
 #include "scripting/wrapper.hpp"
 #include "squirrel/squirrel_error.hpp"
+#include "squirrel/squirrel_profiler.hpp"
 #include "squirrel/squirrel_thread_queue.hpp"
 #include "squirrel/squirrel_scheduler.hpp"
+#include "squirrel/squirrel_script_cache.hpp"
 #include "squirrel_util.hpp"
 #include "supertux/console.hpp"
+#include "supertux/gameconfig.hpp"
 #include "supertux/globals.hpp"
 #include "util/log.hpp"
+#include "util/profiler.hpp"
+#include "util/timelog.hpp"
 
 #ifdef ENABLE_SQDBG
 #  include "../../external/squirrel/sqdbg/sqrdbg.h"
@@ -43,6 +49,10 @@ HSQREMOTEDBG debugger = nullptr;
 
 namespace {
 
+/** Pending collections are forced after this many seconds, even if
+    no frame had enough slack for them */
+const float MAX_GC_DELAY = 2.0f;
+
 #ifdef __clang__
 __attribute__((__format__ (__printf__, 2, 0)))
 #endif
@@ -66,13 +76,23 @@ void printfunc(HSQUIRRELVM, const char* fmt, ...)
 
 SquirrelVirtualMachine::SquirrelVirtualMachine(bool enable_debugger) :
   m_vm(),
+  m_profiler(),
   m_screenswitch_queue(),
-  m_scheduler()
+  m_scheduler(),
+  m_script_cache(),
+  m_gc_pending(false),
+  m_gc_pending_since(0.0f),
+  m_gc_time(0.001f)
 {
   sq_setsharedforeignptr(m_vm.get_vm(), this);
 
   m_screenswitch_queue = std::make_unique<SquirrelThreadQueue>(m_vm);
   m_scheduler = std::make_unique<SquirrelScheduler>(m_vm);
+  m_script_cache = std::make_unique<SquirrelScriptCache>(m_vm.get_vm());
+
+  if (!g_config->script_profile_file.empty()) {
+    m_profiler = std::make_unique<SquirrelProfiler>(m_vm.get_vm(), g_config->script_profile_file);
+  }
 
   if (enable_debugger) {
 #ifdef ENABLE_SQDBG
@@ -165,4 +185,46 @@ SquirrelVirtualMachine::wakeup_screenswitch()
   m_screenswitch_queue->wakeup();
 }
 
+void
+SquirrelVirtualMachine::request_garbage_collection()
+{
+  if (!m_gc_pending) {
+    m_gc_pending = true;
+    m_gc_pending_since = g_real_time;
+  }
+}
+
+bool
+SquirrelVirtualMachine::collect_garbage(float budget)
+{
+  if (!m_gc_pending)
+    return false;
+
+  const bool overdue = g_real_time - m_gc_pending_since > MAX_GC_DELAY;
+  if (m_gc_time > budget && !overdue)
+    return false;
+
+  // spikes are what we are after, so only those go through the timelog
+  Timelog timelog;
+  if (overdue) {
+    timelog.log("squirrel garbage collection");
+  }
+
+  Profiler::Scope profile_scope("script gc");
+  const auto start = std::chrono::steady_clock::now();
+  const SQInteger freed = sq_collectgarbage(m_vm.get_vm());
+  const float duration = std::chrono::duration<float>(std::chrono::steady_clock::now() - start).count();
+
+  if (overdue) {
+    timelog.log();
+  }
+
+  m_gc_time = 0.8f * m_gc_time + 0.2f * duration;
+  m_gc_pending = false;
+
+  log_debug << "squirrel garbage collection freed " << freed << " objects in "
+            << duration * 1000.0f << " ms" << std::endl;
+  return true;
+}
+
 /* EOF */
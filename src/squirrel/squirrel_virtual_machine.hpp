@@ -24,8 +24,10 @@
 #include "squirrel/squirrel_vm.hpp"
 #include "util/currenton.hpp"
 
-class SquirrelThreadQueue;
+class SquirrelProfiler;
 class SquirrelScheduler;
+class SquirrelScriptCache;
+class SquirrelThreadQueue;
 
 class SquirrelVirtualMachine final : public Currenton<SquirrelVirtualMachine>
 {
@@ -44,14 +46,32 @@ public:
   /** wakes up threads waiting for a screen switch event */
   void wakeup_screenswitch();
 
+  /** Marks the VM as having garbage, the actual collection is done
+      by collect_garbage() */
+  void request_garbage_collection();
+
+  /** Runs a pending collection if it is expected to fit into budget
+      seconds or was put off for too long already, returns true if it
+      ran. Squirrel can't collect incrementally, so this only picks
+      the frame. */
+  bool collect_garbage(float budget);
+
 private:
     void update_debugger();
 
 private:
   SquirrelVM m_vm;
+  std::unique_ptr<SquirrelProfiler> m_profiler;
 
   std::unique_ptr<SquirrelThreadQueue> m_screenswitch_queue;
   std::unique_ptr<SquirrelScheduler> m_scheduler;
+  std::unique_ptr<SquirrelScriptCache> m_script_cache;
+
+  bool m_gc_pending;
+  float m_gc_pending_since;
+
+  /** moving average of the collection time in seconds */
+  float m_gc_time;
 
 private:
   SquirrelVirtualMachine(const SquirrelVirtualMachine&) = delete;
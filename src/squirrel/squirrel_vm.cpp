@@ -23,7 +23,8 @@
 #include "squirrel/squirrel_util.hpp"
 
 SquirrelVM::SquirrelVM() :
-  m_vm()
+  m_vm(),
+  m_environments()
 {
   m_vm = sq_open(64);
   if (m_vm == nullptr)
@@ -322,4 +323,27 @@ SquirrelVM::create_thread()
   return vm_object;
 }
 
+void
+SquirrelVM::register_environment(const std::string& name, const SquirrelEnvironment* environment)
+{
+  m_environments[name] = environment;
+}
+
+void
+SquirrelVM::unregister_environment(const std::string& name, const SquirrelEnvironment* environment)
+{
+  // another environment may have taken over the name in the meantime
+  auto it = m_environments.find(name);
+  if (it != m_environments.end() && it->second == environment) {
+    m_environments.erase(it);
+  }
+}
+
+const SquirrelEnvironment*
+SquirrelVM::get_environment(const std::string& name) const
+{
+  auto it = m_environments.find(name);
+  return it != m_environments.end() ? it->second : nullptr;
+}
+
 /* EOF */
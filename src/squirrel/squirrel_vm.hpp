@@ -19,10 +19,13 @@
 #define HEADER_SUPERTUX_SQUIRREL_SQUIRREL_VM_HPP
 
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <squirrel.h>
 
+class SquirrelEnvironment;
+
 /** Basic wrapper around HSQUIRRELVM with some utility functions, not
     to be confused with SquirrelVirtualMachine. The classes might be
     merged in the future. */
@@ -68,8 +71,16 @@ public:
 
   HSQOBJECT create_thread();
 
+  /** Keeps track of the environment that is exposed in the root
+      table under name, used by the console to complete the names
+      it provides */
+  void register_environment(const std::string& name, const SquirrelEnvironment* environment);
+  void unregister_environment(const std::string& name, const SquirrelEnvironment* environment);
+  const SquirrelEnvironment* get_environment(const std::string& name) const;
+
 private:
   HSQUIRRELVM m_vm;
+  std::unordered_map<std::string, const SquirrelEnvironment*> m_environments;
 
 private:
   SquirrelVM(const SquirrelVM&) = delete;
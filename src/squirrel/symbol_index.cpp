@@ -0,0 +1,61 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "squirrel/symbol_index.hpp"
+
+SymbolIndex::SymbolIndex() :
+  m_names()
+{
+}
+
+void
+SymbolIndex::add(const std::string& name)
+{
+  m_names[name] += 1;
+}
+
+void
+SymbolIndex::remove(const std::string& name)
+{
+  auto it = m_names.find(name);
+  if (it == m_names.end())
+    return;
+
+  it->second -= 1;
+  if (it->second <= 0) {
+    m_names.erase(it);
+  }
+}
+
+bool
+SymbolIndex::contains(const std::string& name) const
+{
+  return m_names.find(name) != m_names.end();
+}
+
+void
+SymbolIndex::find(const std::string& prefix, std::vector<std::string>& result) const
+{
+  // all names with the prefix follow it directly in sort order
+  for (auto it = m_names.lower_bound(prefix);
+       it != m_names.end() && it->first.compare(0, prefix.size(), prefix) == 0;
+       ++it)
+  {
+    result.push_back(it->first);
+  }
+}
+
+/* EOF */
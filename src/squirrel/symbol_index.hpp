@@ -0,0 +1,56 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_SQUIRREL_SYMBOL_INDEX_HPP
+#define HEADER_SUPERTUX_SQUIRREL_SYMBOL_INDEX_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+
+/** Sorted set of the names a SquirrelEnvironment provides, kept up
+    to date as objects come and go so the console can complete them
+    without walking the squirrel tables. Names are reference counted,
+    as several objects may share one. */
+class SymbolIndex final
+{
+public:
+  SymbolIndex();
+
+  void add(const std::string& name);
+
+  /** Does nothing if name isn't in the index */
+  void remove(const std::string& name);
+
+  bool contains(const std::string& name) const;
+
+  /** Appends all names starting with prefix to result, in
+      lexicographical order */
+  void find(const std::string& prefix, std::vector<std::string>& result) const;
+
+  size_t size() const { return m_names.size(); }
+
+private:
+  std::map<std::string, int> m_names;
+
+private:
+  SymbolIndex(const SymbolIndex&) = delete;
+  SymbolIndex& operator=(const SymbolIndex&) = delete;
+};
+
+#endif
+
+/* EOF */
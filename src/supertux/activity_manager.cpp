@@ -0,0 +1,147 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "supertux/activity_manager.hpp"
+
+#include <algorithm>
+#include <math.h>
+
+#include "math/vector.hpp"
+#include "supertux/game_object.hpp"
+
+namespace {
+
+/** Regions larger than this many chunks per axis are not walked
+    chunk by chunk, everything gets resumed instead */
+const float MAX_REGION_CHUNKS = 256.0f;
+
+} // namespace
+
+ActivityManager::ActivityManager(float chunk_size) :
+  m_chunk_size(chunk_size),
+  m_regions(),
+  m_chunks(),
+  m_chunk_of()
+{
+}
+
+void
+ActivityManager::set_active_regions(const std::vector<Rectf>& regions)
+{
+  m_regions = regions;
+
+  if (m_chunks.empty())
+    return;
+
+  for (const auto& region : m_regions)
+  {
+    const float left = floorf(region.get_left() / m_chunk_size);
+    const float top = floorf(region.get_top() / m_chunk_size);
+    const float right = floorf(region.get_right() / m_chunk_size);
+    const float bottom = floorf(region.get_bottom() / m_chunk_size);
+
+    // also catches NaN and infinity
+    if (!(right - left < MAX_REGION_CHUNKS) || !(bottom - top < MAX_REGION_CHUNKS) ||
+        !(fabsf(left) < 1.0e9f) || !(fabsf(top) < 1.0e9f))
+    {
+      clear();
+      return;
+    }
+
+    for (int y = static_cast<int>(top); y <= static_cast<int>(bottom); ++y) {
+      for (int x = static_cast<int>(left); x <= static_cast<int>(right); ++x) {
+        auto it = m_chunks.find(get_key(x, y));
+        if (it == m_chunks.end())
+          continue;
+
+        for (auto* object : it->second) {
+          object->m_suspended = false;
+          m_chunk_of.erase(object);
+        }
+        m_chunks.erase(it);
+      }
+    }
+  }
+}
+
+bool
+ActivityManager::is_active(int x, int y) const
+{
+  const Rectf chunk(static_cast<float>(x) * m_chunk_size, static_cast<float>(y) * m_chunk_size,
+                    static_cast<float>(x + 1) * m_chunk_size, static_cast<float>(y + 1) * m_chunk_size);
+
+  return std::any_of(m_regions.begin(), m_regions.end(),
+                     [&chunk](const Rectf& region) {
+                       return !(chunk.get_right() < region.get_left() || chunk.get_left() > region.get_right() ||
+                                chunk.get_bottom() < region.get_top() || chunk.get_top() > region.get_bottom());
+                     });
+}
+
+void
+ActivityManager::try_suspend(GameObject& object)
+{
+  Vector pos;
+  if (object.m_suspended || !object.is_dormant(pos))
+    return;
+
+  const float x = floorf(pos.x / m_chunk_size);
+  const float y = floorf(pos.y / m_chunk_size);
+  if (!(fabsf(x) < 1.0e9f) || !(fabsf(y) < 1.0e9f))
+    return;
+
+  const int chunk_x = static_cast<int>(x);
+  const int chunk_y = static_cast<int>(y);
+  if (is_active(chunk_x, chunk_y))
+    return;
+
+  const uint64_t key = get_key(chunk_x, chunk_y);
+  m_chunks[key].push_back(&object);
+  m_chunk_of[&object] = key;
+  object.m_suspended = true;
+}
+
+void
+ActivityManager::resume(GameObject& object)
+{
+  if (!object.m_suspended)
+    return;
+
+  auto it = m_chunk_of.find(&object);
+  if (it != m_chunk_of.end())
+  {
+    auto& chunk = m_chunks[it->second];
+    chunk.erase(std::find(chunk.begin(), chunk.end(), &object));
+    if (chunk.empty()) {
+      m_chunks.erase(it->second);
+    }
+    m_chunk_of.erase(it);
+  }
+
+  object.m_suspended = false;
+}
+
+void
+ActivityManager::clear()
+{
+  for (auto& it : m_chunk_of) {
+    it.first->m_suspended = false;
+  }
+  m_chunk_of.clear();
+  m_chunks.clear();
+}
+
+/* EOF */
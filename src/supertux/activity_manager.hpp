@@ -0,0 +1,76 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_ACTIVITY_MANAGER_HPP
+#define HEADER_SUPERTUX_SUPERTUX_ACTIVITY_MANAGER_HPP
+
+#include <stdint.h>
+#include <unordered_map>
+#include <vector>
+
+#include "math/rectf.hpp"
+
+class GameObject;
+
+/** Keeps dormant GameObjects that are far away from the camera and
+    the players out of the update loop. Suspended objects are bucketed
+    into square chunks by position and are resumed a whole chunk at a
+    time once the chunk touches one of the active regions, so the
+    per-step cost only depends on the area around the players. */
+class ActivityManager final
+{
+public:
+  ActivityManager(float chunk_size = 512.0f);
+
+  /** Sets the regions in which objects have to be updated and
+      resumes every chunk that touches one of them */
+  void set_active_regions(const std::vector<Rectf>& regions);
+
+  /** Suspends the object if it is dormant and its chunk is outside
+      of all active regions */
+  void try_suspend(GameObject& object);
+
+  /** Brings a suspended object back into the update loop, e.g.
+      because a script is about to touch it or it gets removed */
+  void resume(GameObject& object);
+
+  void clear();
+
+  size_t get_suspended_count() const { return m_chunk_of.size(); }
+
+private:
+  static uint64_t get_key(int x, int y)
+  {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(x)) << 32) | static_cast<uint32_t>(y);
+  }
+
+  bool is_active(int x, int y) const;
+
+private:
+  float m_chunk_size;
+  std::vector<Rectf> m_regions;
+  std::unordered_map<uint64_t, std::vector<GameObject*>> m_chunks;
+  std::unordered_map<GameObject*, uint64_t> m_chunk_of;
+
+private:
+  ActivityManager(const ActivityManager&) = delete;
+  ActivityManager& operator=(const ActivityManager&) = delete;
+};
+
+#endif
+
+/* EOF */
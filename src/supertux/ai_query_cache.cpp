@@ -0,0 +1,60 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "supertux/ai_query_cache.hpp"
+
+#include "util/fnv_hash.hpp"
+
+AIQueryCache::AIQueryCache() :
+  m_line_of_sight()
+{
+}
+
+void
+AIQueryCache::clear()
+{
+  m_line_of_sight.clear();
+}
+
+size_t
+AIQueryCache::KeyHash::operator()(const Key& key) const
+{
+  FNVHash hash;
+  hash.add(key.eye.x);
+  hash.add(key.eye.y);
+  hash.add(key.player);
+  return static_cast<size_t>(hash.get());
+}
+
+bool
+AIQueryCache::find_line_of_sight(const Vector& eye, const Player* player, bool& visible) const
+{
+  auto it = m_line_of_sight.find(Key{eye, player});
+  if (it == m_line_of_sight.end())
+    return false;
+
+  visible = it->second;
+  return true;
+}
+
+void
+AIQueryCache::add_line_of_sight(const Vector& eye, const Player* player, bool visible)
+{
+  m_line_of_sight[Key{eye, player}] = visible;
+}
+
+/* EOF */
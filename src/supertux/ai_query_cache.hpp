@@ -0,0 +1,76 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_AI_QUERY_CACHE_HPP
+#define HEADER_SUPERTUX_SUPERTUX_AI_QUERY_CACHE_HPP
+
+#include <stdint.h>
+#include <unordered_map>
+
+#include "math/vector.hpp"
+
+class Player;
+
+/** Line of sight results of Sector::can_see_player() for the current
+    step. Nothing moves while the objects update, so objects looking
+    from the same spot, or one object asking more than once per step,
+    only raycast once.
+
+    The keys are the exact positions, not cells, so the answers are
+    the same as without the cache and recorded demos stay valid. */
+class AIQueryCache final
+{
+public:
+  AIQueryCache();
+
+  /** Forgets everything, called whenever objects might have moved */
+  void clear();
+
+  /** Returns true and sets visible if the result is known */
+  bool find_line_of_sight(const Vector& eye, const Player* player, bool& visible) const;
+  void add_line_of_sight(const Vector& eye, const Player* player, bool visible);
+
+  size_t get_size() const { return m_line_of_sight.size(); }
+
+private:
+  struct Key
+  {
+    Vector eye;
+    const Player* player;
+
+    bool operator==(const Key& rhs) const
+    {
+      return eye.x == rhs.eye.x && eye.y == rhs.eye.y && player == rhs.player;
+    }
+  };
+
+  struct KeyHash
+  {
+    size_t operator()(const Key& key) const;
+  };
+
+private:
+  std::unordered_map<Key, bool, KeyHash> m_line_of_sight;
+
+private:
+  AIQueryCache(const AIQueryCache&) = delete;
+  AIQueryCache& operator=(const AIQueryCache&) = delete;
+};
+
+#endif
+
+/* EOF */
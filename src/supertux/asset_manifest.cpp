@@ -0,0 +1,211 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "supertux/asset_manifest.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <physfs.h>
+
+#include "addon/md5.hpp"
+#include "audio/sound_manager.hpp"
+#include "sprite/sprite.hpp"
+#include "sprite/sprite_manager.hpp"
+#include "util/log.hpp"
+#include "util/reader_document.hpp"
+#include "util/reader_mapping.hpp"
+#include "util/writer.hpp"
+#include "video/texture_manager.hpp"
+
+namespace {
+
+const char MANIFEST_DIRECTORY[] = "cache/manifest";
+
+/** Time preload_step() may spend per frame */
+const std::chrono::milliseconds PRELOAD_BUDGET(4);
+
+} // namespace
+
+AssetManifest::AssetManifest(const std::string& levelfile) :
+  m_levelfile(levelfile),
+  m_recording(false),
+  m_changed(false),
+  m_textures(),
+  m_sprites(),
+  m_sounds(),
+  m_pending_textures(),
+  m_pending_sprites(),
+  m_pending_sounds(),
+  m_loaded_textures()
+{
+}
+
+AssetManifest::~AssetManifest()
+{
+}
+
+std::string
+AssetManifest::get_filename() const
+{
+  MD5 md5;
+  // MD5 doesn't modify its input, it is merely missing the const
+  md5.update(reinterpret_cast<uint8_t*>(const_cast<char*>(m_levelfile.data())),
+             static_cast<unsigned int>(m_levelfile.size()));
+  return std::string(MANIFEST_DIRECTORY) + "/" + md5.hex_digest() + ".manifest";
+}
+
+void
+AssetManifest::prefetch()
+{
+  const std::string filename = get_filename();
+  if (!PHYSFS_exists(filename.c_str()))
+    return;
+
+  try
+  {
+    auto doc = ReaderDocument::from_file(filename);
+    auto root = doc.get_root();
+    if (root.get_name() != "supertux-asset-manifest")
+      throw std::runtime_error("file is not a supertux-asset-manifest file");
+
+    auto mapping = root.get_mapping();
+    mapping.get("textures", m_pending_textures);
+    mapping.get("sprites", m_pending_sprites);
+    mapping.get("sounds", m_pending_sounds);
+  }
+  catch(const std::exception& e)
+  {
+    log_warning << "couldn't read asset manifest '" << filename << "': " << e.what() << std::endl;
+    return;
+  }
+
+  m_textures.insert(m_pending_textures.begin(), m_pending_textures.end());
+  m_sprites.insert(m_pending_sprites.begin(), m_pending_sprites.end());
+  m_sounds.insert(m_pending_sounds.begin(), m_pending_sounds.end());
+
+  // sprites get their images decoded alongside when parsed by a worker
+  std::vector<std::string> files = m_pending_textures;
+  files.insert(files.end(), m_pending_sprites.begin(), m_pending_sprites.end());
+  TextureManager::current()->prefetch(files);
+
+  // preload_step() pops from the back
+  std::reverse(m_pending_textures.begin(), m_pending_textures.end());
+  std::reverse(m_pending_sprites.begin(), m_pending_sprites.end());
+  std::reverse(m_pending_sounds.begin(), m_pending_sounds.end());
+}
+
+void
+AssetManifest::preload_step()
+{
+  if (m_pending_textures.empty() && m_pending_sprites.empty() && m_pending_sounds.empty())
+    return;
+
+  const auto deadline = std::chrono::steady_clock::now() + PRELOAD_BUDGET;
+  while (std::chrono::steady_clock::now() < deadline)
+  {
+    try
+    {
+      if (!m_pending_textures.empty())
+      {
+        const std::string filename = m_pending_textures.back();
+        m_pending_textures.pop_back();
+        if (PHYSFS_exists(filename.c_str())) {
+          m_loaded_textures.push_back(TextureManager::current()->get(filename));
+        }
+      }
+      else if (!m_pending_sprites.empty())
+      {
+        const std::string filename = m_pending_sprites.back();
+        m_pending_sprites.pop_back();
+        if (PHYSFS_exists(filename.c_str())) {
+          SpriteManager::current()->create(filename);
+        }
+      }
+      else if (!m_pending_sounds.empty())
+      {
+        SoundManager::current()->preload(m_pending_sounds.back());
+        m_pending_sounds.pop_back();
+      }
+      else
+      {
+        break;
+      }
+    }
+    catch(const std::exception& e)
+    {
+      // the asset is reported again once the level really uses it
+      log_debug << "couldn't preload asset: " << e.what() << std::endl;
+    }
+  }
+}
+
+void
+AssetManifest::record_texture(const std::string& filename)
+{
+  if (m_recording && m_textures.insert(filename).second) {
+    m_changed = true;
+  }
+}
+
+void
+AssetManifest::record_sprite(const std::string& filename)
+{
+  if (m_recording && m_sprites.insert(filename).second) {
+    m_changed = true;
+  }
+}
+
+void
+AssetManifest::record_sound(const std::string& filename)
+{
+  if (m_recording && m_sounds.insert(filename).second) {
+    m_changed = true;
+  }
+}
+
+void
+AssetManifest::save()
+{
+  m_recording = false;
+  if (!m_changed)
+    return;
+
+  if (!PHYSFS_exists(MANIFEST_DIRECTORY) && !PHYSFS_mkdir(MANIFEST_DIRECTORY))
+  {
+    log_warning << "couldn't create directory '" << MANIFEST_DIRECTORY << "': "
+                << PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()) << std::endl;
+    return;
+  }
+
+  try
+  {
+    Writer writer(get_filename());
+    writer.start_list("supertux-asset-manifest");
+    writer.write("level", m_levelfile);
+    writer.write("textures", std::vector<std::string>(m_textures.begin(), m_textures.end()));
+    writer.write("sprites", std::vector<std::string>(m_sprites.begin(), m_sprites.end()));
+    writer.write("sounds", std::vector<std::string>(m_sounds.begin(), m_sounds.end()));
+    writer.end_list("supertux-asset-manifest");
+    m_changed = false;
+  }
+  catch(const std::exception& e)
+  {
+    log_warning << "couldn't write asset manifest: " << e.what() << std::endl;
+  }
+}
+
+/* EOF */
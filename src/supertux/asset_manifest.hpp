@@ -0,0 +1,89 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_ASSET_MANIFEST_HPP
+#define HEADER_SUPERTUX_SUPERTUX_ASSET_MANIFEST_HPP
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include "util/currenton.hpp"
+#include "video/texture_ptr.hpp"
+
+/** Remembers which textures, sprites and sounds a level used after
+    it was loaded, so the next time it is played they can be loaded
+    during the LevelIntro and the fade-in instead of the moment a
+    badguy first walks onto the screen. Manifests are stored per
+    level in the userdir. */
+class AssetManifest final : public Currenton<AssetManifest>
+{
+public:
+  AssetManifest(const std::string& levelfile);
+  ~AssetManifest();
+
+  /** Reads the manifest of the last session and starts decoding its
+      images on the texture workers */
+  void prefetch();
+
+  /** Loads prefetched assets on the main thread until a few
+      milliseconds have passed, does nothing once all are loaded */
+  void preload_step();
+
+  /** Called by the managers; only has an effect between
+      start_recording() and save() */
+  void record_texture(const std::string& filename);
+  void record_sprite(const std::string& filename);
+  void record_sound(const std::string& filename);
+
+  /** Assets used while the level was parsed get loaded anyway and
+      are not recorded */
+  void start_recording() { m_recording = true; }
+
+  /** Writes the manifest back to the userdir if anything new was
+      recorded */
+  void save();
+
+private:
+  std::string get_filename() const;
+
+private:
+  std::string m_levelfile;
+  bool m_recording;
+  bool m_changed;
+
+  std::set<std::string> m_textures;
+  std::set<std::string> m_sprites;
+  std::set<std::string> m_sounds;
+
+  /** Assets still to be loaded by preload_step() */
+  std::vector<std::string> m_pending_textures;
+  std::vector<std::string> m_pending_sprites;
+  std::vector<std::string> m_pending_sounds;
+
+  /** Keeps the preloaded textures alive for the session, the
+      TextureManager only holds weak references */
+  std::vector<TexturePtr> m_loaded_textures;
+
+private:
+  AssetManifest(const AssetManifest&) = delete;
+  AssetManifest& operator=(const AssetManifest&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -113,8 +113,28 @@ std::vector<AutotileSet*>* AutotileSet::m_autotilesets = new std::vector<Autotil
 AutotileSet::AutotileSet(std::vector<Autotile*> tiles, uint32_t default_tile, std::string name) :
   m_autotiles(tiles),
   m_default(default_tile),
-  m_name(name)
+  m_name(name),
+  m_lookup(),
+  m_members()
 {
+  m_lookup.fill(nullptr);
+
+  // earlier autotiles take precedence, just like in a linear scan
+  for (const auto& autotile : m_autotiles)
+  {
+    for (const auto& mask : autotile->get_masks())
+    {
+      const size_t index = mask->get_mask() + (mask->get_center() ? 0x100 : 0);
+      if (!m_lookup[index]) {
+        m_lookup[index] = autotile;
+      }
+    }
+
+    m_members.emplace(autotile->get_tile_id(), autotile->is_solid());
+    for (const auto& pair : autotile->get_all_tile_ids()) {
+      m_members.emplace(pair.first, autotile->is_solid());
+    }
+  }
 }
 
 /*
@@ -171,12 +191,10 @@ AutotileSet::get_autotile(uint32_t tile_id,
   if (top)          num_mask = static_cast<uint8_t>(num_mask + 0x40);
   if (top_left)     num_mask = static_cast<uint8_t>(num_mask + 0x80);
 
-  for (auto& autotile : m_autotiles)
+  const Autotile* autotile = m_lookup[num_mask + (center ? 0x100 : 0)];
+  if (autotile)
   {
-    if (autotile->matches(num_mask, center))
-    {
-      return autotile->pick_tile(x, y);
-    }
+    return autotile->pick_tile(x, y);
   }
 
   return center ? get_default_tile() : 0;
@@ -193,56 +211,18 @@ AutotileSet::get_default_tile() const
 bool
 AutotileSet::is_member(uint32_t tile_id) const
 {
-  for (auto& tile : m_autotiles)
-  {
-    if (tile->get_tile_id() == tile_id)
-    {
-      return true;
-    }
-    else
-    {
-      for (auto& pair : tile->get_all_tile_ids())
-      {
-        if (pair.first == tile_id)
-        {
-          return true;
-        }
-      }
-    }
-  }
   // m_default should *never* be 0 (always a valid solid tile,
   //   even if said tile isn't part of the tileset)
-  return tile_id == m_default && m_default != 0;
+  return m_members.count(tile_id) != 0 || (tile_id == m_default && m_default != 0);
 }
 
 bool
 AutotileSet::is_solid(uint32_t tile_id) const
 {
-  if (!is_member(tile_id))
-    return false;
-
-  for (auto& tile : m_autotiles)
-  {
-    if (tile->get_tile_id() == tile_id)
-    {
-      return tile->is_solid();
-    }
-    else
-    {
-      for (auto& pair : tile->get_all_tile_ids())
-      {
-        if (pair.first == tile_id)
-        {
-          return tile->is_solid();
-        }
-      }
-    }
-  }
-
-  //log_warning << "Called AutotileSet::is_solid() with a tile_id that isn't in the Autotileset, yet that returns is_member() = true." << std::endl;
+  auto it = m_members.find(tile_id);
+  if (it != m_members.end())
+    return it->second;
 
-  // m_default should *never* be 0 (always a valid solid tile,
-  //   even if said tile isn't part of the tileset)
   return tile_id == m_default && m_default != 0;
 }
 
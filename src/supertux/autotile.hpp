@@ -17,10 +17,12 @@
 #ifndef HEADER_SUPERTUX_SUPERTUX_AUTOTILE_HPP
 #define HEADER_SUPERTUX_SUPERTUX_AUTOTILE_HPP
 
+#include <array>
 #include <memory>
 #include <stdint.h>
 #include <string>
 #include <algorithm>
+#include <unordered_map>
 
 #include "math/rect.hpp"
 #include "math/rectf.hpp"
@@ -41,6 +43,9 @@ public:
 
   bool matches(uint8_t mask, bool center) const;
 
+  uint8_t get_mask() const { return m_mask; }
+  bool get_center() const { return m_center; }
+
 private:
   uint8_t m_mask;
   bool m_center; // m_center should *always* be the same as the m_solid of the corresponding Autotile
@@ -60,6 +65,8 @@ public:
 
   bool matches(uint8_t mask, bool center) const;
 
+  const std::vector<AutotileMask*>& get_masks() const { return m_masks; }
+
   /** @deprecated Returns the base tile ID. */
   uint32_t get_tile_id() const;
 
@@ -121,6 +128,13 @@ private:
   uint32_t m_default;
   std::string m_name;
 
+  /** The first Autotile matching each mask, indexed by the mask plus
+      0x100 for solid centers */
+  std::array<const Autotile*, 512> m_lookup;
+
+  /** Solidity of every member tile, alternatives included */
+  std::unordered_map<uint32_t, bool> m_members;
+
 private:
   AutotileSet(const AutotileSet&) = delete;
   AutotileSet& operator=(const AutotileSet&) = delete;
@@ -44,6 +44,14 @@ CommandLineArguments::CommandLineArguments() :
   enable_script_debugger(),
   start_demo(),
   record_demo(),
+  benchmark_demo(),
+  replay_demos(),
+  replay_jobs(),
+  render_stats_file(),
+  trace_file(),
+  capture_file(),
+  hitch_threshold_ms(),
+  script_profile_file(),
   tux_spawn_pos(),
   sector(),
   spawnpoint(),
@@ -51,7 +59,13 @@ CommandLineArguments::CommandLineArguments() :
   christmas_mode(),
   repository_url(),
   editor(),
-  resave()
+  resave(),
+  resave_binary(),
+  resave_rules(),
+  validate_levels(),
+  startup_profile(),
+  profile_load(),
+  generate_level()
 {
 }
 
@@ -94,7 +108,10 @@ CommandLineArguments::print_help(const char* arg0) const
     << "\n"
     << _("Game Options:") << "\n"
     << _("  --edit-level                 Open given level in editor") << "\n"
-    << _("  --resave                     Loads given level and saves it") << "\n"
+    << _("  --resave                     Loads given levels or level directories and saves them") << "\n"
+    << _("  --resave-binary              Loads given levels and saves them in the binary format") << "\n"
+    << _("  --resave-rules FILE          Resaves given levels, applying the substitutions in FILE") << "\n"
+    << _("  --validate-levels DIR        Loads all levels in DIR without saving them and reports errors") << "\n"
     << _("  --show-fps                   Display framerate in levels") << "\n"
     << _("  --no-show-fps                Do not display framerate in levels") << "\n"
     << _("  --show-pos                   Display player's current position") << "\n"
@@ -104,10 +121,20 @@ CommandLineArguments::print_help(const char* arg0) const
     << _("  --spawn-pos X,Y              Where in the level to spawn Tux. Only used if level is specified.") << "\n"
     << _("  --sector SECTOR              Spawn Tux in SECTOR\n") << "\n"
     << _("  --spawnpoint SPAWNPOINT      Spawn Tux at SPAWNPOINT\n") << "\n"
+    << _("  --render-stats FILE          Write draw calls and GPU time per layer to FILE as CSV") << "\n"
+    << _("  --trace FILE                 Write a Chrome trace of every frame to FILE") << "\n"
+    << _("  --capture FILE               Write every frame to FILE as raw RGB24 video") << "\n"
+    << _("  --hitch-threshold MS         Log what frames slower than MS milliseconds spent their time on") << "\n"
+    << _("  --profile-scripts FILE       Write time spent in scripts to FILE for flame graphs") << "\n"
+    << _("  --startup-profile            Print how long each startup step took") << "\n"
+    << _("  --profile-load LEVEL         Load LEVEL, print how long each step took and exit") << "\n"
     << "\n"
     << _("Demo Recording Options:") << "\n"
     << _("  --record-demo FILE LEVEL     Record a demo to FILE") << "\n"
     << _("  --play-demo FILE LEVEL       Play a recorded demo") << "\n"
+    << _("  --benchmark-demo FILE LEVEL  Play a demo as fast as possible and print step times") << "\n"
+    << _("  --replay-demos DIR           Benchmark all demos in DIR in parallel and check their checksums") << "\n"
+    << _("  --jobs N                     Number of demos --replay-demos plays at once, one per core by default") << "\n"
     << "\n"
     << _("Directory Options:") << "\n"
     << _("  --datadir DIR                Set the directory for the games datafiles") << "\n"
@@ -312,6 +339,40 @@ CommandLineArguments::parse_args(int argc, char** argv)
         start_demo = argv[++i];
       }
     }
+    else if (arg == "--benchmark-demo")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a demo filename");
+      }
+      else
+      {
+        start_demo = argv[++i];
+        benchmark_demo = true;
+      }
+    }
+    else if (arg == "--replay-demos")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a demo directory for --replay-demos");
+      }
+      else
+      {
+        replay_demos = argv[++i];
+      }
+    }
+    else if (arg == "--jobs")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a number for --jobs");
+      }
+      else
+      {
+        replay_jobs = std::stoi(argv[++i]);
+      }
+    }
     else if (arg == "--record-demo")
     {
       if (i + 1 >= argc)
@@ -323,6 +384,61 @@ CommandLineArguments::parse_args(int argc, char** argv)
         record_demo = argv[++i];
       }
     }
+    else if (arg == "--render-stats")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a filename for the render stats");
+      }
+      else
+      {
+        render_stats_file = argv[++i];
+      }
+    }
+    else if (arg == "--trace")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a filename for the trace");
+      }
+      else
+      {
+        trace_file = argv[++i];
+      }
+    }
+    else if (arg == "--capture")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a filename for the capture");
+      }
+      else
+      {
+        capture_file = argv[++i];
+      }
+    }
+    else if (arg == "--hitch-threshold")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify milliseconds for --hitch-threshold");
+      }
+      else
+      {
+        hitch_threshold_ms = std::stoi(argv[++i]);
+      }
+    }
+    else if (arg == "--profile-scripts")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a filename for the script profile");
+      }
+      else
+      {
+        script_profile_file = argv[++i];
+      }
+    }
     else if (arg == "--spawn-pos")
     {
       Vector spawn_pos;
@@ -377,6 +493,63 @@ CommandLineArguments::parse_args(int argc, char** argv)
     {
       resave = true;
     }
+    else if (arg == "--resave-binary")
+    {
+      resave = true;
+      resave_binary = true;
+    }
+    else if (arg == "--resave-rules")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a rules file for --resave-rules");
+      }
+      else
+      {
+        resave = true;
+        resave_rules = argv[++i];
+      }
+    }
+    else if (arg == "--validate-levels")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a level directory for --validate-levels");
+      }
+      else
+      {
+        validate_levels = true;
+        filenames.push_back(argv[++i]);
+      }
+    }
+    else if (arg == "--startup-profile")
+    {
+      startup_profile = true;
+    }
+    else if (arg == "--profile-load")
+    {
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify a level for --profile-load");
+      }
+      else
+      {
+        profile_load = true;
+        filenames.push_back(argv[++i]);
+      }
+    }
+    else if (arg == "--generate-level")
+    {
+      // not in the help, it's only meant for benchmark scripts
+      if (i + 1 >= argc)
+      {
+        throw std::runtime_error("Need to specify parameters for --generate-level, e.g. width=400,badguys=8");
+      }
+      else
+      {
+        generate_level = argv[++i];
+      }
+    }
     else if (arg[0] != '-')
     {
       filenames.push_back(arg);
@@ -388,7 +561,7 @@ CommandLineArguments::parse_args(int argc, char** argv)
   }
 
   // some final checks
-  if (filenames.size() > 1 && !(resave && *resave)) {
+  if (filenames.size() > 1 && !(resave && *resave) && !(validate_levels && *validate_levels)) {
     throw std::runtime_error("Only one filename allowed for the given options");
   }
 }
@@ -411,12 +584,32 @@ CommandLineArguments::merge_into(Config& config)
   merge_option(enable_script_debugger);
   merge_option(start_demo);
   merge_option(record_demo);
+  merge_option(benchmark_demo);
+  merge_option(render_stats_file);
+  merge_option(trace_file);
+  merge_option(capture_file);
+  merge_option(hitch_threshold_ms);
+  merge_option(script_profile_file);
   merge_option(tux_spawn_pos);
   merge_option(developer_mode);
   merge_option(christmas_mode);
   merge_option(repository_url);
 
 #undef merge_option
+
+  // benchmarks measure the logic, rendering and sound are opt-in
+  if (benchmark_demo && *benchmark_demo)
+  {
+    if (!video) {
+      config.video = VideoSystem::VIDEO_NULL;
+    }
+    if (!sound_enabled) {
+      config.sound_enabled = false;
+    }
+    if (!music_enabled) {
+      config.music_enabled = false;
+    }
+  }
 }
 
 /* EOF */
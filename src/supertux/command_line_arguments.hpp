@@ -68,6 +68,16 @@ public:
   boost::optional<bool> enable_script_debugger;
   boost::optional<std::string> start_demo;
   boost::optional<std::string> record_demo;
+  boost::optional<bool> benchmark_demo;
+
+  /** Directory of demos to play with one process per job */
+  boost::optional<std::string> replay_demos;
+  boost::optional<int> replay_jobs;
+  boost::optional<std::string> render_stats_file;
+  boost::optional<std::string> trace_file;
+  boost::optional<std::string> capture_file;
+  boost::optional<int> hitch_threshold_ms;
+  boost::optional<std::string> script_profile_file;
   boost::optional<Vector> tux_spawn_pos;
   boost::optional<std::string> sector;
   boost::optional<std::string> spawnpoint;
@@ -80,6 +90,14 @@ public:
 
   boost::optional<bool> editor;
   boost::optional<bool> resave;
+  boost::optional<bool> resave_binary;
+  boost::optional<std::string> resave_rules;
+  boost::optional<bool> validate_levels;
+  boost::optional<bool> startup_profile;
+  boost::optional<bool> profile_load;
+
+  /** LevelGenerator parameters, the level is written to the filename */
+  boost::optional<std::string> generate_level;
 
   // boost::optional<std::string> locale;
 
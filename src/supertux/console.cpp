@@ -16,14 +16,18 @@
 
 #include "supertux/console.hpp"
 
+#include <algorithm>
+
 #include "math/sizef.hpp"
 #include "physfs/ifile_stream.hpp"
+#include "squirrel/squirrel_environment.hpp"
 #include "squirrel/squirrel_virtual_machine.hpp"
 #include "squirrel/squirrel_util.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/globals.hpp"
 #include "supertux/resources.hpp"
 #include "util/log.hpp"
+#include "util/log_sink.hpp"
 #include "video/drawing_context.hpp"
 #include "video/surface.hpp"
 
@@ -31,9 +35,19 @@
 static const float FADE_SPEED = 1;
 
 ConsoleBuffer::ConsoleBuffer() :
-  m_lines(),
-  m_console(nullptr)
+  m_lines(CAPACITY),
+  m_next(0),
+  m_count(0),
+  m_console(nullptr),
+  m_owner(std::this_thread::get_id())
+{
+}
+
+const std::string&
+ConsoleBuffer::get_line(size_t n) const
 {
+  assert(n < m_count);
+  return m_lines[(m_next + CAPACITY - 1 - n) % CAPACITY];
 }
 
 void
@@ -57,30 +71,23 @@ ConsoleBuffer::addLines(const std::string& s)
 }
 
 void
-ConsoleBuffer::addLine(const std::string& s_)
+ConsoleBuffer::addLine(const std::string& s)
 {
-  std::string s = s_;
-
-  // output line to stderr
-  std::cerr << s << std::endl;
-
-  // wrap long lines
-  std::string overflow;
-  int line_count = 0;
-  do {
-    m_lines.push_front(Font::wrap_to_chars(s, 99, &overflow));
-    line_count += 1;
-    s = overflow;
-  } while (s.length() > 0);
-
-  // trim scrollback buffer
-  while (m_lines.size() >= 1000)
-  {
-    m_lines.pop_back();
+  // output line to stderr, without waiting for the terminal
+  LogSink::write(s);
+
+  // the oldest line gets overwritten once the buffer is full, assign()
+  // reuses its storage
+  m_lines[m_next].assign(s);
+  m_next = (m_next + 1) % CAPACITY;
+  if (m_count < CAPACITY) {
+    m_count += 1;
   }
 
   if (m_console)
   {
+    // estimate of the wrapped line count, only used to grow the console
+    const int line_count = std::max(1, static_cast<int>((s.length() + LINE_LENGTH - 1) / LINE_LENGTH));
     m_console->on_buffer_change(line_count);
   }
 }
@@ -119,7 +126,8 @@ Console::Console(ConsoleBuffer& buffer) :
   m_offset(0),
   m_focused(false),
   m_font(Resources::console_font),
-  m_stayOpen(0)
+  m_stayOpen(0),
+  m_wrapped()
 {
   m_buffer.set_console(this);
 }
@@ -290,6 +298,35 @@ namespace {
 
 void sq_insert_commands(std::list<std::string>& cmds, HSQUIRRELVM vm, const std::string& table_prefix, const std::string& search_prefix);
 
+/**
+ * Appends the names from the SymbolIndex of the environment whose table is on top of stack,
+ * this includes objects that only get exposed on their first lookup.
+ * If search_prefix goes beyond a name, that object is looked up, so sq_insert_commands finds its members.
+ */
+void
+sq_insert_symbols(std::list<std::string>& cmds, HSQUIRRELVM vm, const SymbolIndex& symbols, const std::string& table_prefix, const std::string& search_prefix)
+{
+  const std::string name_prefix = search_prefix.substr(table_prefix.length());
+  const std::string::size_type dot = name_prefix.find('.');
+  if (dot != std::string::npos)
+  {
+    const std::string name = name_prefix.substr(0, dot);
+    if (symbols.contains(name)) {
+      SQInteger oldtop = sq_gettop(vm);
+      sq_pushstring(vm, name.c_str(), -1);
+      sq_get(vm, -2);
+      sq_settop(vm, oldtop);
+    }
+    return;
+  }
+
+  std::vector<std::string> names;
+  symbols.find(name_prefix, names);
+  for (const auto& name : names) {
+    cmds.push_back(table_prefix + name + ".");
+  }
+}
+
 /**
  * Acts upon key,value on top of stack:
  * Appends key (plus type-dependent suffix) to cmds if table_prefix+key starts with search_prefix;
@@ -315,6 +352,12 @@ sq_insert_command(std::list<std::string>& cmds, HSQUIRRELVM vm, const std::strin
     case OT_CLASS:
       key_string+=".";
       if (search_prefix.substr(0, key_string.length()) == key_string) {
+        if (table_prefix.empty()) {
+          const SquirrelEnvironment* environment = SquirrelVirtualMachine::current()->get_vm().get_environment(key_chars);
+          if (environment) {
+            sq_insert_symbols(cmds, vm, environment->get_symbols(), key_string, search_prefix);
+          }
+        }
         sq_insert_commands(cmds, vm, key_string, search_prefix);
       }
       break;
@@ -381,6 +424,10 @@ Console::autocomplete()
   }
   sq_pop(m_vm, 1); // remove table
 
+  // the symbol index and the tables can both know a name
+  cmds.sort();
+  cmds.unique();
+
   // depending on number of hits, show matches or autocomplete
   if (cmds.empty())
   {
@@ -574,14 +621,31 @@ Console::draw(DrawingContext& context) const
     }
   }
 
+  // lines are wrapped here, newest first, until the top of the console
+  // is reached, so older lines never get touched
   int skipLines = -m_offset;
-  for (std::list<std::string>::iterator i = m_buffer.m_lines.begin(); i != m_buffer.m_lines.end(); ++i)
+  bool done = false;
+  for (size_t n = 0; n < m_buffer.get_line_count() && !done; ++n)
   {
-    if (skipLines-- > 0) continue;
-    lineNo++;
-    float py = static_cast<float>(m_height - 4.0f - static_cast<float>(lineNo) * m_font->get_height());
-    if (py < -m_font->get_height()) break;
-    context.color().draw_text(m_font, *i, Vector(4.0f, py), ALIGN_LEFT, layer);
+    m_wrapped.clear();
+    std::string s = m_buffer.get_line(n);
+    std::string overflow;
+    do {
+      m_wrapped.push_back(Font::wrap_to_chars(s, ConsoleBuffer::LINE_LENGTH, &overflow));
+      s = overflow;
+    } while (s.length() > 0);
+
+    for (auto i = m_wrapped.rbegin(); i != m_wrapped.rend(); ++i)
+    {
+      if (skipLines-- > 0) continue;
+      lineNo++;
+      float py = static_cast<float>(m_height - 4.0f - static_cast<float>(lineNo) * m_font->get_height());
+      if (py < -m_font->get_height()) {
+        done = true;
+        break;
+      }
+      context.color().draw_text(m_font, *i, Vector(4.0f, py), ALIGN_LEFT, layer);
+    }
   }
   context.pop_transform();
 }
@@ -20,6 +20,7 @@
 #include <list>
 #include <squirrel.h>
 #include <sstream>
+#include <thread>
 #include <vector>
 
 #include "util/currenton.hpp"
@@ -36,13 +37,25 @@ public:
   static std::ostream output; /**< stream of characters to output to the console. Do not forget to send std::endl or to flush the stream. */
   static ConsoleStreamBuffer s_outputBuffer; /**< stream buffer used by output stream */
 
-public:
-  std::list<std::string> m_lines; /**< backbuffer of lines sent to the console. New lines get added to front. */
-  Console* m_console;
+  /** number of lines kept in the scrollback buffer */
+  static const size_t CAPACITY = 1000;
+
+  /** width at which lines get wrapped when drawn */
+  static const int LINE_LENGTH = 99;
 
 public:
   ConsoleBuffer();
 
+  /** the thread that created the buffer, the only one allowed to
+      write to it */
+  std::thread::id get_owner() const { return m_owner; }
+
+  /** number of lines in the buffer, before wrapping */
+  size_t get_line_count() const { return m_count; }
+
+  /** returns the @c n th most recent line, 0 is the newest one */
+  const std::string& get_line(size_t n) const;
+
   void addLines(const std::string& s); /**< display a string of (potentially) multiple lines in the console */
   void addLine(const std::string& s); /**< display a line in the console */
 
@@ -50,6 +63,15 @@ public:
 
   void set_console(Console* console);
 
+private:
+  /** ring buffer of the lines sent to the console as they came in,
+      they are only wrapped when the console draws them */
+  std::vector<std::string> m_lines;
+  size_t m_next; /**< slot the next line goes into */
+  size_t m_count;
+  Console* m_console;
+  const std::thread::id m_owner;
+
 private:
   ConsoleBuffer(const ConsoleBuffer&) = delete;
   ConsoleBuffer& operator=(const ConsoleBuffer&) = delete;
@@ -106,6 +128,9 @@ private:
 
   float m_stayOpen;
 
+  /** scratch space for wrapping a line in draw() */
+  mutable std::vector<std::string> m_wrapped;
+
   void parse(const std::string& s); /**< react to a given command */
 
   /** ready a virtual machine instance, creating a new thread and loading default .nut files if needed */
@@ -25,6 +25,9 @@ Debug::Debug() :
   show_collision_rects(false),
   show_worldmap_path(false),
   draw_redundant_frames(false),
+  show_render_stats(false),
+  show_profiler(false),
+  show_memory_stats(false),
   m_use_bitmap_fonts(false),
   m_game_speed_multiplier(1.0f)
 {
@@ -39,6 +39,15 @@ public:
   // vaguely measure the impact of code changes which should increase the FPS
   bool draw_redundant_frames;
 
+  /** Show draw calls and GPU time per layer, see RenderStats */
+  bool show_render_stats;
+
+  /** Record frames with the Profiler and show the slowest recent one */
+  bool show_profiler;
+
+  /** Show the live memory by subsystem, see MemoryStats */
+  bool show_memory_stats;
+
 private:
   /** Use old bitmap fonts instead of TTF */
   bool m_use_bitmap_fonts;
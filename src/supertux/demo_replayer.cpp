@@ -0,0 +1,276 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "supertux/demo_replayer.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <boost/filesystem.hpp>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <stdexcept>
+#include <stdio.h>
+#include <stdlib.h>
+#include <thread>
+
+#include "util/log.hpp"
+#include "util/string_util.hpp"
+
+#ifdef _WIN32
+#  define popen _popen
+#  define pclose _pclose
+#endif
+
+namespace {
+
+std::string
+quote_argument(const std::string& arg)
+{
+#ifdef _WIN32
+  // the rules of CommandLineToArgvW() and the MSVC runtime:
+  // backslashes only escape when they precede a quote
+  std::string result = "\"";
+  size_t backslashes = 0;
+  for (const char c : arg) {
+    if (c == '\\') {
+      backslashes += 1;
+      continue;
+    }
+
+    if (c == '"') {
+      result.append(backslashes * 2 + 1, '\\');
+    } else {
+      result.append(backslashes, '\\');
+    }
+    backslashes = 0;
+    result += c;
+  }
+  result.append(backslashes * 2, '\\');
+  return result + "\"";
+#else
+  std::string result = "'";
+  for (const char c : arg) {
+    if (c == '\'') {
+      result += "'\\''";
+    } else {
+      result += c;
+    }
+  }
+  return result + "'";
+#endif
+}
+
+/** Runs command in a shell and returns what it printed, status is
+    set to its exit status */
+std::string
+run_process(const std::string& command, int& status)
+{
+  FILE* pipe = popen(command.c_str(), "r");
+  if (!pipe) {
+    status = -1;
+    return std::string();
+  }
+
+  std::string output;
+  char buffer[4096];
+  size_t count;
+  while ((count = fread(buffer, 1, sizeof(buffer), pipe)) > 0) {
+    output.append(buffer, count);
+  }
+  status = pclose(pipe);
+  return output;
+}
+
+} // namespace
+
+DemoReplayer::Result::Result() :
+  complete(false),
+  steps(0),
+  frame_p50_ms(0.0f),
+  frame_p99_ms(0.0f),
+  checksum("none"),
+  diverged_frame(0)
+{
+}
+
+DemoReplayer::Result
+DemoReplayer::parse_output(const std::string& output)
+{
+  Result result;
+
+  std::istringstream in(output);
+  std::string line;
+  while (std::getline(in, line))
+  {
+    std::istringstream words(line);
+    std::string first;
+    if (!(words >> first))
+      continue;
+
+    std::string second;
+    if (first == "frame")
+    {
+      float p95;
+      if (words >> result.frame_p50_ms >> p95 >> result.frame_p99_ms) {
+        result.complete = true;
+      }
+    }
+    else if (first == "checksum" && words >> second)
+    {
+      result.checksum = second;
+      if (second == "diverged") {
+        words >> result.diverged_frame;
+      }
+    }
+    else if (words >> second && second == "steps")
+    {
+      result.steps = std::atoi(first.c_str());
+    }
+  }
+
+  return result;
+}
+
+std::string
+DemoReplayer::read_level_filename(const std::string& demo_filename)
+{
+  std::ifstream in(demo_filename + ".level");
+  std::string level;
+  if (!std::getline(in, level))
+    return std::string();
+
+  // files edited on windows
+  while (!level.empty() && (level.back() == '\r' || level.back() == ' ')) {
+    level.pop_back();
+  }
+  return level;
+}
+
+void
+DemoReplayer::write_level_filename(const std::string& demo_filename, const std::string& level_filename)
+{
+  std::ofstream out(demo_filename + ".level");
+  out << level_filename << '\n';
+  if (!out) {
+    log_warning << "Couldn't write '" << demo_filename << ".level', --replay-demos can't play the demo"
+                << std::endl;
+  }
+}
+
+DemoReplayer::DemoReplayer(const std::string& executable, const std::vector<std::string>& args, int jobs) :
+  m_executable(executable),
+  m_args(args),
+  m_jobs(std::max(1, jobs))
+{
+}
+
+std::string
+DemoReplayer::get_command(const std::string& demo_filename, const std::string& level_filename) const
+{
+  std::string command = quote_argument(m_executable);
+  for (const auto& arg : m_args) {
+    command += " " + quote_argument(arg);
+  }
+  command += " --benchmark-demo " + quote_argument(demo_filename) + " " + quote_argument(level_filename);
+#ifdef _WIN32
+  // cmd.exe /c drops the first and the last quote of a command line
+  // that starts with one
+  return "\"" + command + " 2>&1\"";
+#else
+  return command + " 2>&1";
+#endif
+}
+
+void
+DemoReplayer::run(const std::string& directory)
+{
+  std::vector<std::string> demos;
+  for (const auto& entry : boost::filesystem::recursive_directory_iterator(directory))
+  {
+    const std::string path = entry.path().string();
+    if (StringUtil::has_suffix(path, ".demo")) {
+      demos.push_back(path);
+    }
+  }
+  std::sort(demos.begin(), demos.end());
+
+  std::vector<Result> results(demos.size());
+  std::vector<std::string> errors(demos.size());
+  std::atomic<size_t> next_demo(0);
+
+  auto play = [this, &demos, &results, &errors, &next_demo]
+  {
+    for (size_t i = next_demo++; i < demos.size(); i = next_demo++)
+    {
+      const std::string level = read_level_filename(demos[i]);
+      if (level.empty()) {
+        errors[i] = "no level file";
+        continue;
+      }
+
+      int status;
+      const std::string output = run_process(get_command(demos[i], level), status);
+      results[i] = parse_output(output);
+      if (status != 0) {
+        errors[i] = "exit status " + std::to_string(status);
+      } else if (!results[i].complete) {
+        errors[i] = "no step report";
+      }
+    }
+  };
+
+  log_info << "Replaying " << demos.size() << " demos with " << m_jobs << " processes" << std::endl;
+
+  std::vector<std::thread> threads;
+  for (int i = 0; i < m_jobs && static_cast<size_t>(i) < demos.size(); ++i) {
+    threads.emplace_back(play);
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  std::cout << "demo,status,steps,frame_p50_ms,frame_p99_ms,checksum,diverged_frame" << std::endl;
+
+  size_t failed = 0;
+  for (size_t i = 0; i < demos.size(); ++i)
+  {
+    const Result& result = results[i];
+    if (!errors[i].empty())
+    {
+      log_warning << demos[i] << ": " << errors[i] << std::endl;
+      std::cout << demos[i] << ",failed,,,,," << std::endl;
+      failed += 1;
+    }
+    else
+    {
+      const bool diverged = result.checksum == "diverged";
+      std::cout << demos[i] << "," << (diverged ? "diverged" : "ok") << "," << result.steps << ","
+                << result.frame_p50_ms << "," << result.frame_p99_ms << "," << result.checksum << ","
+                << (diverged ? std::to_string(result.diverged_frame) : std::string()) << std::endl;
+      if (diverged) {
+        failed += 1;
+      }
+    }
+  }
+
+  log_info << (demos.size() - failed) << " of " << demos.size() << " demos replayed" << std::endl;
+  if (failed > 0) {
+    throw std::runtime_error(std::to_string(failed) + " demos failed to play or diverged");
+  }
+}
+
+/* EOF */
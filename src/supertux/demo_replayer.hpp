@@ -0,0 +1,84 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_DEMO_REPLAYER_HPP
+#define HEADER_SUPERTUX_SUPERTUX_DEMO_REPLAYER_HPP
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/** Plays every demo of a directory with 'supertux2 --benchmark-demo'
+    and prints the step times and the checksum state of each as CSV.
+    The game only runs one session per process, so every demo gets a
+    process of its own, as many at once as there are jobs. The level
+    to play a demo with is read from the demo filename with ".level"
+    added, which --record-demo writes. */
+class DemoReplayer final
+{
+public:
+  struct Result
+  {
+    Result();
+
+    /** false if the process printed no step report */
+    bool complete;
+
+    int steps;
+    float frame_p50_ms;
+    float frame_p99_ms;
+
+    /** "ok", "diverged" or "none" if the demo has no checksum file */
+    std::string checksum;
+
+    /** first frame differing from the recording, if diverged */
+    uint32_t diverged_frame;
+  };
+
+public:
+  /** Parses what 'supertux2 --benchmark-demo' printed */
+  static Result parse_output(const std::string& output);
+
+  /** The level filename stored next to the demo, empty if there is
+      none */
+  static std::string read_level_filename(const std::string& demo_filename);
+  static void write_level_filename(const std::string& demo_filename, const std::string& level_filename);
+
+public:
+  /** executable is the supertux2 to run, args are passed to every
+      process in front of --benchmark-demo */
+  DemoReplayer(const std::string& executable, const std::vector<std::string>& args, int jobs);
+
+  /** Plays all demos in directory and its subdirectories, throws if
+      any of them failed to play or diverged */
+  void run(const std::string& directory);
+
+private:
+  std::string get_command(const std::string& demo_filename, const std::string& level_filename) const;
+
+private:
+  std::string m_executable;
+  std::vector<std::string> m_args;
+  int m_jobs;
+
+private:
+  DemoReplayer(const DemoReplayer&) = delete;
+  DemoReplayer& operator=(const DemoReplayer&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,408 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "supertux/demo_stream.hpp"
+
+#include <algorithm>
+#include <istream>
+#include <ostream>
+#include <stdio.h>
+#include <string.h>
+
+namespace {
+
+const char DEMO_MAGIC[] = "STDEMO2\n";
+const char INDEX_MAGIC[] = "STIX";
+const size_t DEMO_MAGIC_SIZE = 8;
+const size_t INDEX_MAGIC_SIZE = 4;
+
+const char CHECKSUM_MAGIC[] = "STHASH1\n";
+const size_t CHECKSUM_MAGIC_SIZE = 8;
+
+/** Run records: bits 0-5 are the controls, bit 6 says that the run
+    is longer than one frame and its length - 2 follows as varint */
+const uint8_t RUN_LONG = 0x40;
+const uint8_t RUN_CONTROLS = 0x3f;
+
+/** Ends the runs, the index follows */
+const uint8_t RUN_END = 0x80;
+
+} // namespace
+
+DemoWriter::DemoWriter(std::unique_ptr<std::ostream> out, int random_seed) :
+  m_out(std::move(out)),
+  m_offset(0),
+  m_frame(0),
+  m_run_controls(0),
+  m_run_length(0),
+  m_index(),
+  m_finished(false)
+{
+  for (size_t i = 0; i < DEMO_MAGIC_SIZE; ++i) {
+    write_byte(static_cast<uint8_t>(DEMO_MAGIC[i]));
+  }
+  write_uint32(static_cast<uint32_t>(random_seed));
+}
+
+DemoWriter::~DemoWriter()
+{
+  finish();
+}
+
+void
+DemoWriter::add_frame(uint8_t controls)
+{
+  if (m_finished)
+    return;
+
+  controls &= RUN_CONTROLS;
+
+  // index entries have to start a run of their own
+  if (m_frame % INDEX_INTERVAL == 0)
+  {
+    write_run();
+    m_run_length = 0;
+    m_index.emplace_back(m_frame, m_offset);
+  }
+
+  if (m_run_length > 0 && controls == m_run_controls)
+  {
+    m_run_length += 1;
+  }
+  else
+  {
+    write_run();
+    m_run_controls = controls;
+    m_run_length = 1;
+  }
+
+  m_frame += 1;
+}
+
+void
+DemoWriter::finish()
+{
+  if (m_finished)
+    return;
+
+  write_run();
+  write_byte(RUN_END);
+
+  const uint32_t index_offset = m_offset;
+  write_varint(static_cast<uint32_t>(m_index.size()));
+  for (const auto& entry : m_index) {
+    write_varint(entry.first);
+    write_varint(entry.second);
+  }
+  write_uint32(index_offset);
+  for (size_t i = 0; i < INDEX_MAGIC_SIZE; ++i) {
+    write_byte(static_cast<uint8_t>(INDEX_MAGIC[i]));
+  }
+
+  m_out->flush();
+  m_finished = true;
+}
+
+void
+DemoWriter::write_run()
+{
+  if (m_run_length == 0)
+    return;
+
+  if (m_run_length == 1) {
+    write_byte(m_run_controls);
+  } else {
+    write_byte(static_cast<uint8_t>(m_run_controls | RUN_LONG));
+    write_varint(m_run_length - 2);
+  }
+}
+
+void
+DemoWriter::write_byte(uint8_t value)
+{
+  m_out->put(static_cast<char>(value));
+  m_offset += 1;
+}
+
+void
+DemoWriter::write_varint(uint32_t value)
+{
+  while (value >= 0x80) {
+    write_byte(static_cast<uint8_t>(value | 0x80));
+    value >>= 7;
+  }
+  write_byte(static_cast<uint8_t>(value));
+}
+
+void
+DemoWriter::write_uint32(uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) {
+    write_byte(static_cast<uint8_t>(value >> (8 * i)));
+  }
+}
+
+DemoReader::DemoReader(std::unique_ptr<std::istream> in) :
+  m_in(std::move(in)),
+  m_compact(false),
+  m_random_seed(0),
+  m_data_start(0),
+  m_frame(0),
+  m_run_controls(0),
+  m_run_left(0),
+  m_end(false),
+  m_index()
+{
+  char magic[DEMO_MAGIC_SIZE];
+  m_in->read(magic, DEMO_MAGIC_SIZE);
+  if (m_in->gcount() == static_cast<std::streamsize>(DEMO_MAGIC_SIZE) &&
+      memcmp(magic, DEMO_MAGIC, DEMO_MAGIC_SIZE) == 0)
+  {
+    m_compact = true;
+
+    uint32_t seed = 0;
+    for (int i = 0; i < 4; ++i) {
+      seed |= static_cast<uint32_t>(m_in->get() & 0xff) << (8 * i);
+    }
+    m_random_seed = static_cast<int>(seed);
+    m_data_start = m_in->tellg();
+
+    read_index();
+  }
+  else
+  {
+    // the old format optionally starts with the seed as text
+    m_in->clear();
+    m_in->seekg(0);
+
+    char buf[30];
+    buf[29] = '\0';
+    for (int i = 0; i < 29 && (i == 0 || buf[i-1]); i++) {
+      buf[i] = static_cast<char>(m_in->get());
+    }
+
+    int seed;
+    if (sscanf(buf, "random_seed=%10d", &seed) == 1) {
+      m_random_seed = seed;
+      m_data_start = m_in->tellg();
+    } else {
+      m_in->clear();
+      m_in->seekg(0);
+      m_data_start = 0;
+    }
+  }
+}
+
+void
+DemoReader::read_index()
+{
+  m_index.clear();
+
+  m_in->seekg(-static_cast<std::streamoff>(4 + INDEX_MAGIC_SIZE), std::ios::end);
+  uint32_t index_offset = 0;
+  for (int i = 0; i < 4; ++i) {
+    index_offset |= static_cast<uint32_t>(m_in->get() & 0xff) << (8 * i);
+  }
+  char magic[INDEX_MAGIC_SIZE];
+  m_in->read(magic, INDEX_MAGIC_SIZE);
+
+  // without the index, e.g. when the game crashed while recording,
+  // seeking just reads from the beginning
+  if (m_in && memcmp(magic, INDEX_MAGIC, INDEX_MAGIC_SIZE) == 0)
+  {
+    m_in->seekg(index_offset);
+    uint32_t count;
+    if (read_varint(count))
+    {
+      for (uint32_t i = 0; i < count; ++i)
+      {
+        uint32_t frame, offset;
+        if (!read_varint(frame) || !read_varint(offset)) {
+          m_index.clear();
+          break;
+        }
+        m_index.emplace_back(frame, offset);
+      }
+    }
+  }
+
+  m_in->clear();
+  m_in->seekg(m_data_start);
+}
+
+bool
+DemoReader::read_varint(uint32_t& value)
+{
+  value = 0;
+  for (int shift = 0; shift < 32; shift += 7)
+  {
+    const int c = m_in->get();
+    if (c == std::char_traits<char>::eof())
+      return false;
+
+    value |= static_cast<uint32_t>(c & 0x7f) << shift;
+    if ((c & 0x80) == 0)
+      return true;
+  }
+  return false;
+}
+
+bool
+DemoReader::read_run()
+{
+  if (m_end)
+    return false;
+
+  const int c = m_in->get();
+  if (c == std::char_traits<char>::eof() || (c & RUN_END))
+  {
+    m_end = true;
+    return false;
+  }
+
+  m_run_controls = static_cast<uint8_t>(c & RUN_CONTROLS);
+  m_run_left = 1;
+  if (c & RUN_LONG)
+  {
+    uint32_t length;
+    if (!read_varint(length))
+    {
+      m_end = true;
+      return false;
+    }
+    m_run_left = length + 2;
+  }
+  return true;
+}
+
+bool
+DemoReader::next_frame(uint8_t& controls)
+{
+  if (m_compact)
+  {
+    if (m_run_left == 0 && !read_run())
+      return false;
+
+    m_run_left -= 1;
+    m_frame += 1;
+    controls = m_run_controls;
+    return true;
+  }
+  else
+  {
+    char raw[DEMO_CONTROL_COUNT];
+    m_in->read(raw, DEMO_CONTROL_COUNT);
+    if (m_in->gcount() != DEMO_CONTROL_COUNT)
+      return false;
+
+    controls = 0;
+    for (int i = 0; i < DEMO_CONTROL_COUNT; ++i) {
+      if (raw[i]) {
+        controls |= static_cast<uint8_t>(1 << i);
+      }
+    }
+    m_frame += 1;
+    return true;
+  }
+}
+
+void
+DemoReader::seek(uint32_t frame)
+{
+  m_in->clear();
+
+  if (!m_compact)
+  {
+    m_in->seekg(m_data_start + static_cast<std::streamoff>(frame) * DEMO_CONTROL_COUNT);
+    m_frame = frame;
+    return;
+  }
+
+  // the last index entry at or before frame
+  auto it = std::upper_bound(m_index.begin(), m_index.end(), frame,
+                             [](uint32_t lhs, const std::pair<uint32_t, uint32_t>& rhs) {
+                               return lhs < rhs.first;
+                             });
+  if (it != m_index.begin()) {
+    --it;
+    m_in->seekg(it->second);
+    m_frame = it->first;
+  } else {
+    m_in->seekg(m_data_start);
+    m_frame = 0;
+  }
+  m_run_left = 0;
+  m_end = false;
+
+  // skip whole runs where possible
+  while (m_frame < frame)
+  {
+    if (m_run_left == 0 && !read_run())
+      return;
+
+    const uint32_t skip = std::min(m_run_left, frame - m_frame);
+    m_run_left -= skip;
+    m_frame += skip;
+  }
+}
+
+DemoChecksumWriter::DemoChecksumWriter(std::unique_ptr<std::ostream> out) :
+  m_out(std::move(out))
+{
+  m_out->write(CHECKSUM_MAGIC, CHECKSUM_MAGIC_SIZE);
+}
+
+void
+DemoChecksumWriter::add_frame(uint64_t hash)
+{
+  char bytes[8];
+  for (int i = 0; i < 8; ++i) {
+    bytes[i] = static_cast<char>(hash >> (8 * i));
+  }
+  m_out->write(bytes, sizeof(bytes));
+}
+
+DemoChecksumReader::DemoChecksumReader(std::unique_ptr<std::istream> in) :
+  m_in(std::move(in)),
+  m_valid(false),
+  m_frame(0)
+{
+  char magic[CHECKSUM_MAGIC_SIZE];
+  m_in->read(magic, CHECKSUM_MAGIC_SIZE);
+  m_valid = m_in->gcount() == static_cast<std::streamsize>(CHECKSUM_MAGIC_SIZE) &&
+    memcmp(magic, CHECKSUM_MAGIC, CHECKSUM_MAGIC_SIZE) == 0;
+}
+
+bool
+DemoChecksumReader::next_frame(uint64_t& hash)
+{
+  if (!m_valid)
+    return false;
+
+  char bytes[8];
+  m_in->read(bytes, sizeof(bytes));
+  if (m_in->gcount() != static_cast<std::streamsize>(sizeof(bytes)))
+    return false;
+
+  hash = 0;
+  for (int i = 0; i < 8; ++i) {
+    hash |= static_cast<uint64_t>(static_cast<uint8_t>(bytes[i])) << (8 * i);
+  }
+  m_frame += 1;
+  return true;
+}
+
+/* EOF */
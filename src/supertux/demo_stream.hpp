@@ -0,0 +1,159 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_DEMO_STREAM_HPP
+#define HEADER_SUPERTUX_SUPERTUX_DEMO_STREAM_HPP
+
+#include <iosfwd>
+#include <memory>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/** The recorded controls of a demo are one bit per control and
+    logical frame, LEFT in bit 0 up to ACTION in bit 5. */
+static const int DEMO_CONTROL_COUNT = 6;
+
+/** Writes demos in the compact format: a header with the random
+    seed, then runs of frames with the same controls, then an index
+    of the run offsets every few seconds for seeking. */
+class DemoWriter final
+{
+public:
+  /** Frames between two index entries */
+  static const uint32_t INDEX_INTERVAL = 640;
+
+public:
+  DemoWriter(std::unique_ptr<std::ostream> out, int random_seed);
+  ~DemoWriter();
+
+  void add_frame(uint8_t controls);
+
+  /** Writes the last run and the index, called by the destructor.
+      No frames can be added afterwards. */
+  void finish();
+
+private:
+  void write_run();
+  void write_byte(uint8_t value);
+  void write_varint(uint32_t value);
+  void write_uint32(uint32_t value);
+
+private:
+  std::unique_ptr<std::ostream> m_out;
+  uint32_t m_offset;
+  uint32_t m_frame;
+  uint8_t m_run_controls;
+  uint32_t m_run_length;
+
+  /** pairs of frame and the offset of the run starting with it */
+  std::vector<std::pair<uint32_t, uint32_t> > m_index;
+  bool m_finished;
+
+private:
+  DemoWriter(const DemoWriter&) = delete;
+  DemoWriter& operator=(const DemoWriter&) = delete;
+};
+
+/** Reads compact demos as well as the old format of one byte per
+    control and frame. */
+class DemoReader final
+{
+public:
+  /** The stream has to be seekable */
+  DemoReader(std::unique_ptr<std::istream> in);
+
+  /** 0 if the demo doesn't contain a seed */
+  int get_random_seed() const { return m_random_seed; }
+
+  bool is_compact() const { return m_compact; }
+
+  /** Number of frames read or skipped so far */
+  uint32_t get_frame() const { return m_frame; }
+
+  /** Reads the controls of the next frame, returns false at the end */
+  bool next_frame(uint8_t& controls);
+
+  /** Continues reading at the given frame, compact demos jump to the
+      closest index entry in front of it */
+  void seek(uint32_t frame);
+
+private:
+  void read_index();
+  bool read_run();
+  bool read_varint(uint32_t& value);
+
+private:
+  std::unique_ptr<std::istream> m_in;
+  bool m_compact;
+  int m_random_seed;
+  std::streamoff m_data_start;
+  uint32_t m_frame;
+  uint8_t m_run_controls;
+  uint32_t m_run_left;
+  bool m_end;
+  std::vector<std::pair<uint32_t, uint32_t> > m_index;
+
+private:
+  DemoReader(const DemoReader&) = delete;
+  DemoReader& operator=(const DemoReader&) = delete;
+};
+
+/** Per frame hashes of the simulation state, written next to a
+    demo so that playback can tell the first frame that came out
+    differently: a magic, then one little endian uint64 per frame. */
+class DemoChecksumWriter final
+{
+public:
+  DemoChecksumWriter(std::unique_ptr<std::ostream> out);
+
+  void add_frame(uint64_t hash);
+
+private:
+  std::unique_ptr<std::ostream> m_out;
+
+private:
+  DemoChecksumWriter(const DemoChecksumWriter&) = delete;
+  DemoChecksumWriter& operator=(const DemoChecksumWriter&) = delete;
+};
+
+class DemoChecksumReader final
+{
+public:
+  DemoChecksumReader(std::unique_ptr<std::istream> in);
+
+  /** false if the stream isn't a checksum file */
+  bool is_valid() const { return m_valid; }
+
+  /** Number of frames read so far */
+  uint32_t get_frame() const { return m_frame; }
+
+  /** Reads the hash of the next frame, returns false at the end */
+  bool next_frame(uint64_t& hash);
+
+private:
+  std::unique_ptr<std::istream> m_in;
+  bool m_valid;
+  uint32_t m_frame;
+
+private:
+  DemoChecksumReader(const DemoChecksumReader&) = delete;
+  DemoChecksumReader& operator=(const DemoChecksumReader&) = delete;
+};
+
+#endif
+
+/* EOF */
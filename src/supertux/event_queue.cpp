@@ -0,0 +1,127 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "supertux/event_queue.hpp"
+
+#include <algorithm>
+
+namespace {
+
+/** Events older than this are stamped as if they were this old, SDL
+    timestamps of synthesized events may be off */
+const uint64_t MAX_EVENT_AGE_US = 1000000;
+
+/** Queued events coalesce() looks at, a few per axis of a gamepad */
+const size_t MAX_COALESCE_DISTANCE = 16;
+
+bool is_axis_event(const SDL_Event& event)
+{
+  return event.type == SDL_JOYAXISMOTION || event.type == SDL_CONTROLLERAXISMOTION;
+}
+
+bool is_same_axis(const SDL_Event& lhs, const SDL_Event& rhs)
+{
+  if (lhs.type != rhs.type)
+    return false;
+
+  if (lhs.type == SDL_JOYAXISMOTION) {
+    return lhs.jaxis.which == rhs.jaxis.which && lhs.jaxis.axis == rhs.jaxis.axis;
+  } else {
+    return lhs.caxis.which == rhs.caxis.which && lhs.caxis.axis == rhs.caxis.axis;
+  }
+}
+
+} // namespace
+
+EventQueue::EventQueue() :
+  m_entries(),
+  m_axis_zone()
+{
+}
+
+void
+EventQueue::poll(uint64_t now_us)
+{
+  SDL_PumpEvents();
+
+  const Uint32 ticks = SDL_GetTicks();
+  SDL_Event event;
+  while (SDL_PeepEvents(&event, 1, SDL_GETEVENT, SDL_FIRSTEVENT, SDL_LASTEVENT) > 0)
+  {
+    // SDL only has millisecond timestamps, which come from another
+    // clock, so only their age is taken over
+    const Uint32 age_ms = SDL_TICKS_PASSED(ticks, event.common.timestamp) ? ticks - event.common.timestamp : 0;
+    const uint64_t age_us = std::min(std::min(static_cast<uint64_t>(age_ms) * 1000, MAX_EVENT_AGE_US), now_us);
+    push(event, now_us - age_us);
+  }
+}
+
+bool
+EventQueue::coalesce(const SDL_Event& event)
+{
+  if (!m_axis_zone || !is_axis_event(event))
+    return false;
+
+  const size_t count = std::min(m_entries.size(), MAX_COALESCE_DISTANCE);
+  for (size_t i = 0; i < count; ++i)
+  {
+    Entry& entry = m_entries[m_entries.size() - 1 - i];
+
+    // moving an axis past a button would reorder them
+    if (!is_axis_event(entry.event))
+      return false;
+
+    if (is_same_axis(entry.event, event))
+    {
+      // a change of zone has to reach the managers, or short flicks
+      // of the stick get lost
+      if (m_axis_zone(entry.event) != m_axis_zone(event))
+        return false;
+
+      entry.event = event;
+      return true;
+    }
+  }
+  return false;
+}
+
+void
+EventQueue::push(const SDL_Event& event, uint64_t time_us)
+{
+  if (coalesce(event))
+    return;
+
+  // keep the order SDL reported the events in, even if the timestamps
+  // say otherwise
+  if (!m_entries.empty()) {
+    time_us = std::max(time_us, m_entries.back().time_us);
+  }
+
+  m_entries.push_back({ event, time_us });
+}
+
+bool
+EventQueue::pop(uint64_t until_us, Entry& entry)
+{
+  if (m_entries.empty() || m_entries.front().time_us > until_us)
+    return false;
+
+  entry = m_entries.front();
+  m_entries.pop_front();
+  return true;
+}
+
+/* EOF */
@@ -0,0 +1,79 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_EVENT_QUEUE_HPP
+#define HEADER_SUPERTUX_SUPERTUX_EVENT_QUEUE_HPP
+
+#include <SDL.h>
+#include <deque>
+#include <functional>
+#include <stdint.h>
+
+/** Holds the SDL events together with the time they arrived at, so
+    that the logic steps run in one frame each get the events of their
+    own time slot, instead of the first step getting them all. */
+class EventQueue final
+{
+public:
+  struct Entry
+  {
+    SDL_Event event;
+
+    /** in the clock of the caller, see poll() */
+    uint64_t time_us;
+  };
+
+  /** Classifies the value of an axis event, see set_axis_zone_func() */
+  typedef std::function<int (const SDL_Event& event)> AxisZoneFunc;
+
+public:
+  EventQueue();
+
+  /** Enables coalescing of joystick and controller axis events: an
+      axis event replaces the queued one of the same axis if func puts
+      both in the same zone and only axis events were queued since.
+      Cheap gamepads send thousands of them a second otherwise. */
+  void set_axis_zone_func(AxisZoneFunc func) { m_axis_zone = std::move(func); }
+
+  /** Moves the events SDL collected so far into the queue. now_us is
+      the current time of the caller's clock, the events are stamped
+      with it minus their age according to their SDL timestamp. */
+  void poll(uint64_t now_us);
+
+  void push(const SDL_Event& event, uint64_t time_us);
+
+  /** Takes the oldest event that arrived at or before until_us,
+      returns false if there is none */
+  bool pop(uint64_t until_us, Entry& entry);
+
+  bool empty() const { return m_entries.empty(); }
+
+private:
+  /** Returns true if event was merged into a queued one */
+  bool coalesce(const SDL_Event& event);
+
+private:
+  std::deque<Entry> m_entries;
+  AxisZoneFunc m_axis_zone;
+
+private:
+  EventQueue(const EventQueue&) = delete;
+  EventQueue& operator=(const EventQueue&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -39,14 +39,16 @@ GameManager::GameManager() :
 
 void
 GameManager::start_level(const World& world, const std::string& level_filename,
-                         const boost::optional<std::pair<std::string, Vector>>& start_pos)
+                         const boost::optional<std::pair<std::string, Vector>>& start_pos,
+                         std::unique_ptr<ReaderDocument> level_document)
 {
   m_savegame = Savegame::from_file(world.get_savegame_filename());
 
   auto screen = std::make_unique<LevelsetScreen>(world.get_basedir(),
                                                  level_filename,
                                                  *m_savegame,
-                                                 start_pos);
+                                                 start_pos,
+                                                 std::move(level_document));
   ScreenManager::current()->push_screen(std::move(screen));
 }
 
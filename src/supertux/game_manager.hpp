@@ -22,6 +22,7 @@
 #include <string>
 #include "math/vector.hpp"
 #include "util/currenton.hpp"
+#include "util/reader_document.hpp"
 
 class Savegame;
 class World;
@@ -32,8 +33,11 @@ public:
   GameManager();
 
   void start_worldmap(const World& world, const std::string& spawnpoint = "", const std::string& worldmap_filename = "");
+  /** Starts the level, level_document can hold the already loaded
+      level, then level_filename isn't read but only used for naming */
   void start_level(const World& world, const std::string& level_filename,
-                   const boost::optional<std::pair<std::string, Vector>>& start_pos = boost::none);
+                   const boost::optional<std::pair<std::string, Vector>>& start_pos = boost::none,
+                   std::unique_ptr<ReaderDocument> level_document = {});
 
   bool load_next_worldmap();
   void set_next_worldmap(const std::string& worldmap, const std::string &spawnpoint);
@@ -17,8 +17,13 @@
 #include "supertux/game_object.hpp"
 
 #include <algorithm>
+#include <sstream>
 
+#include "supertux/game_object_factory.hpp"
+#include "supertux/game_object_manager.hpp"
 #include "supertux/object_remove_listener.hpp"
+#include "util/log.hpp"
+#include "util/reader_document.hpp"
 #include "util/reader_mapping.hpp"
 #include "util/writer.hpp"
 #include "video/color.hpp"
@@ -27,6 +32,11 @@ GameObject::GameObject() :
   m_name(),
   m_uid(),
   m_scheduled_for_removal(false),
+  m_suspended(false),
+  m_batched_update(false),
+  m_manager(nullptr),
+  m_object_index(0),
+  m_type_index_pos(0),
   m_components(),
   m_remove_listeners()
 {
@@ -36,6 +46,11 @@ GameObject::GameObject(const std::string& name) :
   m_name(name),
   m_uid(),
   m_scheduled_for_removal(false),
+  m_suspended(false),
+  m_batched_update(false),
+  m_manager(nullptr),
+  m_object_index(0),
+  m_type_index_pos(0),
   m_components(),
   m_remove_listeners()
 {
@@ -55,6 +70,18 @@ GameObject::~GameObject()
   m_remove_listeners.clear();
 }
 
+void
+GameObject::remove_me()
+{
+  if (m_scheduled_for_removal)
+    return;
+
+  m_scheduled_for_removal = true;
+  if (m_manager) {
+    m_manager->m_removed_objects.push_back(this);
+  }
+}
+
 void
 GameObject::add_remove_listener(ObjectRemoveListener* listener)
 {
@@ -81,6 +108,33 @@ GameObject::save(Writer& writer)
   }
 }
 
+std::unique_ptr<GameObject>
+GameObject::clone()
+{
+  if (!is_saveable())
+    return {};
+
+  std::ostringstream out;
+  {
+    Writer writer(out);
+    writer.start_list(get_class());
+    save(writer);
+    writer.end_list(get_class());
+  }
+
+  try
+  {
+    std::istringstream in(out.str());
+    auto doc = ReaderDocument::from_stream(in, "<clone>");
+    return GameObjectFactory::instance().create(get_class(), doc.get_root().get_mapping());
+  }
+  catch(const std::exception& err)
+  {
+    log_warning << "couldn't clone '" << get_class() << "': " << err.what() << std::endl;
+    return {};
+  }
+}
+
 ObjectSettings
 GameObject::get_settings()
 {
@@ -27,8 +27,10 @@
 
 class DrawingContext;
 class GameObjectComponent;
+class GameObjectManager;
 class ObjectRemoveListener;
 class ReaderMapping;
+class Vector;
 class Writer;
 
 /**
@@ -45,6 +47,7 @@ class Writer;
 */
 class GameObject
 {
+  friend class ActivityManager;
   friend class GameObjectManager;
 
 public:
@@ -93,13 +96,28 @@ public:
   virtual bool has_settings() const { return is_saveable(); }
   virtual ObjectSettings get_settings();
 
+  /** Returns a new object in the state the object would be saved
+      with, for snapshots and test plays of a level. The default saves
+      and reloads the object through the GameObjectFactory, objects
+      with large state override it to share that state instead.
+      Returns nullptr for objects that can't be saved. */
+  virtual std::unique_ptr<GameObject> clone();
+
   virtual void after_editor_set() {}
 
+  /** Returns true if update() currently does nothing unless the
+      camera or a player comes close to pos, e.g. an inactive badguy.
+      Far away dormant objects are not updated by the Sector. */
+  virtual bool is_dormant(Vector& pos) const { (void)pos; return false; }
+
+  /** true while the Sector skips update() for this object */
+  bool is_suspended() const { return m_suspended; }
+
   /** returns true if the object is not scheduled to be removed yet */
   bool is_valid() const { return !m_scheduled_for_removal; }
 
   /** schedules this object to be removed at the end of the frame */
-  void remove_me() { m_scheduled_for_removal = true; }
+  void remove_me();
 
   /** registers a remove listener which will be called if the object
       gets removed/destroyed */
@@ -159,6 +177,10 @@ public:
       together (e.g. platform on a path) */
   virtual void editor_update() {}
 
+  /** Only objects returning true get editor_update() called, so
+      overriding editor_update() requires overriding this as well */
+  virtual bool has_editor_update() const { return false; }
+
 private:
   void set_uid(const UID& uid) { m_uid = uid; }
 
@@ -175,6 +197,23 @@ private:
   /** this flag indicates if the object should be removed at the end of the frame */
   bool m_scheduled_for_removal;
 
+  /** managed by the ActivityManager of the Sector */
+  bool m_suspended;
+
+  /** set by the GameObjectManager if the type is updated in a batch */
+  bool m_batched_update;
+
+  /** the manager holding this object in its object list, told about
+      remove_me() so it only has to look at the removed objects */
+  GameObjectManager* m_manager;
+
+  /** position in the object list of m_manager */
+  size_t m_object_index;
+
+  /** position in the type index of m_manager, only kept up to date
+      for batched types */
+  size_t m_type_index_pos;
+
   std::vector<std::unique_ptr<GameObjectComponent> > m_components;
 
   std::vector<ObjectRemoveListener*> m_remove_listeners;
@@ -18,20 +18,38 @@
 #include "supertux/game_object_manager.hpp"
 
 #include <algorithm>
+#include <chrono>
 
 #include "object/tilemap.hpp"
+#include "supertux/activity_manager.hpp"
+#include "supertux/object_stats.hpp"
+
+namespace {
+
+int64_t
+get_elapsed_ns(const std::chrono::steady_clock::time_point& start)
+{
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start).count();
+}
+
+} // namespace
 
 bool GameObjectManager::s_draw_solids_only = false;
+uint32_t GameObjectManager::s_removal_generation = 0;
 
 GameObjectManager::GameObjectManager() :
   m_uid_generator(),
   m_gameobjects(),
+  m_removed_objects(),
   m_gameobjects_new(),
   m_solid_tilemaps(),
+  m_solids_dirty(false),
   m_objects_by_name(),
   m_objects_by_uid(),
   m_objects_by_type_index(),
-  m_name_resolve_requests()
+  m_name_resolve_requests(),
+  m_activity_manager(nullptr),
+  m_update_batches()
 {
 }
 
@@ -94,10 +112,19 @@ GameObjectManager::add_object(std::unique_ptr<GameObject> object)
 #endif
 
   GameObject& tmp = *object;
+  m_objects_by_uid.insert(tmp.get_uid(), &tmp);
   m_gameobjects_new.push_back(std::move(object));
   return tmp;
 }
 
+void
+GameObjectManager::reserve_objects(size_t count)
+{
+  m_gameobjects_new.reserve(m_gameobjects_new.size() + count);
+  m_gameobjects.reserve(m_gameobjects.size() + m_gameobjects_new.size() + count);
+  m_objects_by_uid.reserve(m_objects_by_uid.size() + m_gameobjects_new.size() + count);
+}
+
 void
 GameObjectManager::clear_objects()
 {
@@ -105,19 +132,84 @@ GameObjectManager::clear_objects()
 
   for (const auto& obj: m_gameobjects) {
     before_object_remove(*obj);
+    obj->m_manager = nullptr;
   }
   m_gameobjects.clear();
+  m_removed_objects.clear();
+  m_objects_by_name.clear();
+  m_objects_by_uid.clear();
+  s_removal_generation += 1;
 }
 
 void
 GameObjectManager::update(float dt_sec)
 {
-  for (const auto& object : m_gameobjects)
+  const bool stats = g_object_stats.is_enabled();
+
+  const size_t count = m_gameobjects.size();
+  for (size_t i = 0; i < count;)
   {
-    if (!object->is_valid())
+    GameObject& object = *m_gameobjects[i];
+
+    if (object.m_batched_update)
+    {
+      // the run of objects of the same type starting here, so the
+      // update order doesn't change
+      const std::type_index type(typeid(object));
+      size_t end = i + 1;
+      while (end < count && m_gameobjects[end]->m_batched_update &&
+             std::type_index(typeid(*m_gameobjects[end])) == type) {
+        ++end;
+      }
+
+      const auto batch = std::find_if(m_update_batches.begin(), m_update_batches.end(),
+                                      [&type](const UpdateBatch& b) { return b.type == type; });
+      assert(batch != m_update_batches.end());
+      if (stats)
+      {
+        const auto start = std::chrono::steady_clock::now();
+        batch->update(*this, &m_gameobjects[i], end - i, dt_sec);
+        g_object_stats.add(ObjectStats::UPDATE, object, static_cast<int>(end - i), get_elapsed_ns(start));
+      }
+      else
+      {
+        batch->update(*this, &m_gameobjects[i], end - i, dt_sec);
+      }
+      i = end;
+      continue;
+    }
+
+    i += 1;
+    if (!object.is_valid() || object.is_suspended())
       continue;
 
-    object->update(dt_sec);
+    if (stats)
+    {
+      const auto start = std::chrono::steady_clock::now();
+      object.update(dt_sec);
+      g_object_stats.add(ObjectStats::UPDATE, object, 1, get_elapsed_ns(start));
+    }
+    else
+    {
+      object.update(dt_sec);
+    }
+    after_object_update(object);
+  }
+}
+
+void
+GameObjectManager::after_object_update(GameObject& object)
+{
+  if (m_activity_manager) {
+    m_activity_manager->try_suspend(object);
+  }
+}
+
+void
+GameObjectManager::resume(GameObject& object)
+{
+  if (m_activity_manager) {
+    m_activity_manager->resume(object);
   }
 }
 
@@ -136,27 +228,52 @@ GameObjectManager::draw(DrawingContext& context)
         continue;
     }
 
-    object->draw(context);
+    if (g_object_stats.is_enabled())
+    {
+      const auto start = std::chrono::steady_clock::now();
+      object->draw(context);
+      g_object_stats.add(ObjectStats::DRAW, *object, 1, get_elapsed_ns(start));
+    }
+    else
+    {
+      object->draw(context);
+    }
   }
 }
 
 void
 GameObjectManager::flush_game_objects()
 {
+  if (!m_removed_objects.empty())
   { // cleanup marked objects
-    m_gameobjects.erase(
-      std::remove_if(m_gameobjects.begin(), m_gameobjects.end(),
-                     [this](const std::unique_ptr<GameObject>& obj) {
-                       if (!obj->is_valid())
-                       {
-                         this_before_object_remove(*obj);
-                         before_object_remove(*obj);
-                         return true;
-                       } else {
-                         return false;
-                       }
-                     }),
-      m_gameobjects.end());
+    // the hooks might remove further objects, so don't use iterators
+    size_t first = m_gameobjects.size();
+    for (size_t i = 0; i < m_removed_objects.size(); ++i)
+    {
+      GameObject& object = *m_removed_objects[i];
+      first = std::min(first, object.m_object_index);
+      this_before_object_remove(object);
+      before_object_remove(object);
+    }
+    m_removed_objects.clear();
+
+    // the order matters for update() and draw(), so compact the list
+    // instead of swapping, nothing before the first removed object
+    // has to be touched. Destructors calling remove_me() on other
+    // objects are handled by the next flush.
+    size_t out = first;
+    for (size_t i = first; i < m_gameobjects.size(); ++i)
+    {
+      if (m_gameobjects[i]->m_manager)
+      {
+        m_gameobjects[i]->m_object_index = out;
+        if (i != out) {
+          m_gameobjects[out] = std::move(m_gameobjects[i]);
+        }
+        out += 1;
+      }
+    }
+    m_gameobjects.erase(m_gameobjects.begin() + static_cast<std::ptrdiff_t>(out), m_gameobjects.end());
   }
 
   { // add newly created objects
@@ -171,15 +288,23 @@ GameObjectManager::flush_game_objects()
           this_before_object_add(*object);
           m_gameobjects.push_back(std::move(object));
         }
+        else
+        {
+          m_objects_by_uid.erase(object->get_uid());
+        }
       }
     }
   }
-  update_solids();
+
+  if (m_solids_dirty) {
+    update_solids();
+  }
 }
 
 void
-GameObjectManager::update_solids() 
+GameObjectManager::update_solids()
 {
+  m_solids_dirty = false;
   m_solid_tilemaps.clear();
   for (auto tilemap : get_objects_by_type_index(typeid(TileMap)))
   {
@@ -188,8 +313,11 @@ GameObjectManager::update_solids()
   }
 }
 
-void 
+void
 GameObjectManager::update_solid(TileMap* tm) {
+  // keep the list usable right away, the next flush restores the order
+  m_solids_dirty = true;
+
   auto it = std::find(m_solid_tilemaps.begin(), m_solid_tilemaps.end(), tm);
   bool found = it != m_solid_tilemaps.end();
   if (tm->is_solid() && !found) {
@@ -204,24 +332,44 @@ GameObjectManager::this_before_object_add(GameObject& object)
   { // by_name
     if (!object.get_name().empty())
     {
-      m_objects_by_name[object.get_name()] = &object;
+      m_objects_by_name.insert(object.get_name(), &object);
     }
   }
 
   { // by_id
+    // already done by add_object()
     assert(object.get_uid());
-
-    m_objects_by_uid[object.get_uid()] = &object;
+    assert(m_objects_by_uid.find(object.get_uid()));
   }
 
   { // by_type_index
-    m_objects_by_type_index[std::type_index(typeid(object))].push_back(&object);
+    const std::type_index type(typeid(object));
+    auto& vec = m_objects_by_type_index[type];
+    object.m_type_index_pos = vec.size();
+    vec.push_back(&object);
+
+    object.m_batched_update =
+      std::any_of(m_update_batches.begin(), m_update_batches.end(),
+                  [&type](const UpdateBatch& batch) { return batch.type == type; });
+  }
+
+  object.m_manager = this;
+  object.m_object_index = m_gameobjects.size();
+  if (!object.is_valid()) {
+    // removed before it got added, drop it on the next flush
+    m_removed_objects.push_back(&object);
+  }
+
+  if (typeid(object) == typeid(TileMap)) {
+    m_solids_dirty = true;
   }
 }
 
 void
 GameObjectManager::this_before_object_remove(GameObject& object)
 {
+  s_removal_generation += 1;
+
   { // by_name
     const std::string& name = object.get_name();
     if (!name.empty())
@@ -236,9 +384,28 @@ GameObjectManager::this_before_object_remove(GameObject& object)
 
   { // by_type_index
     auto& vec = m_objects_by_type_index[std::type_index(typeid(object))];
-    auto it = std::find(vec.begin(), vec.end(), &object);
-    assert(it != vec.end());
-    vec.erase(it);
+    if (object.m_batched_update)
+    {
+      // nothing walks batched types in order, updates go by m_gameobjects
+      const size_t pos = object.m_type_index_pos;
+      assert(pos < vec.size() && vec[pos] == &object);
+      vec[pos] = vec.back();
+      vec[pos]->m_type_index_pos = pos;
+      vec.pop_back();
+    }
+    else
+    {
+      // others keep theirs, e.g. the first Player is the main one
+      auto it = std::find(vec.begin(), vec.end(), &object);
+      assert(it != vec.end());
+      vec.erase(it);
+    }
+  }
+
+  object.m_manager = nullptr;
+
+  if (typeid(object) == typeid(TileMap)) {
+    m_solids_dirty = true;
   }
 }
 
@@ -19,13 +19,16 @@
 #define HEADER_SUPERTUX_SUPERTUX_GAME_OBJECT_MANAGER_HPP
 
 #include <functional>
+#include <stdint.h>
 #include <typeindex>
 #include <unordered_map>
 #include <vector>
 
 #include "supertux/game_object.hpp"
+#include "util/flat_hash_map.hpp"
 #include "util/uid_generator.hpp"
 
+class ActivityManager;
 class DrawingContext;
 class TileMap;
 
@@ -33,9 +36,18 @@ template<class T> class GameObjectRange;
 
 class GameObjectManager
 {
+  friend class GameObject;
+
 public:
   static bool s_draw_solids_only;
 
+  /** Changes whenever any manager removes objects, so pointers looked
+      up by UID can be cached until then */
+  static uint32_t get_removal_generation() { return s_removal_generation; }
+
+private:
+  static uint32_t s_removal_generation;
+
 private:
   struct NameResolveRequest
   {
@@ -43,6 +55,13 @@ private:
     std::function<void (UID)> callback;
   };
 
+  struct UpdateBatch
+  {
+    std::type_index type;
+    void (*update)(GameObjectManager& manager, const std::unique_ptr<GameObject>* objects,
+                   size_t count, float dt_sec);
+  };
+
 public:
   GameObjectManager();
   virtual ~GameObjectManager();
@@ -51,6 +70,10 @@ public:
   GameObject& add_object(std::unique_ptr<GameObject> object);
   void clear_objects();
 
+  /** Makes room for count more objects, so loading a sector doesn't
+      regrow the containers over and over */
+  void reserve_objects(size_t count);
+
   template<typename T, typename... Args>
   T& add(Args&&... args)
   {
@@ -60,9 +83,24 @@ public:
     return obj_ref;
   }
 
+  /** Updates all objects that are not suspended, dormant objects are
+      handed to the ActivityManager afterwards if there is one */
   void update(float dt_sec);
   void draw(DrawingContext& context);
 
+  /** Makes sure a suspended object gets updated again */
+  void resume(GameObject& object);
+
+  /** Consecutive objects of exactly type T in the object list, e.g. a
+      row of coins, are updated in one loop with the update() call
+      resolved at compile time. They are still updated at their place
+      in the list. Has to be called before objects are added. */
+  template<class T>
+  void add_batched_update()
+  {
+    m_update_batches.push_back(UpdateBatch{std::type_index(typeid(T)), &update_batch<T>});
+  }
+
   const std::vector<std::unique_ptr<GameObject> >& get_objects() const;
 
   /** Commit the queued up additions and deletions to the object list */
@@ -114,27 +152,23 @@ public:
   template<class T>
   T* get_object_by_uid(const UID& uid) const
   {
-    auto it = m_objects_by_uid.find(uid);
-    if (it == m_objects_by_uid.end())
+    // FIXME: Is this a good idea? Should gameobjects be made
+    // accessible even when not fully inserted into the manager?
+    // Objects waiting in m_gameobjects_new are found as well.
+    GameObject* const* object = m_objects_by_uid.find(uid);
+    if (!object)
     {
-      // FIXME: Is this a good idea? Should gameobjects be made
-      // accessible even when not fully inserted into the manager?
-      for (auto&& itnew : m_gameobjects_new)
-      {
-        if (itnew->get_uid() == uid)
-          return static_cast<T*>(itnew.get());
-      }
       return nullptr;
     }
     else
     {
 #ifdef NDEBUG
-      return static_cast<T*>(it->second);
+      return static_cast<T*>(*object);
 #else
       // Since uids should be unique, there should be no need to guess
       // the type, thus we assert() when the object type is not what
       // we expected.
-      auto ptr = dynamic_cast<T*>(it->second);
+      auto ptr = dynamic_cast<T*>(*object);
       assert(ptr != nullptr);
       return ptr;
 #endif
@@ -150,14 +184,14 @@ public:
   template<class T>
   T* get_object_by_name(const std::string& name) const
   {
-    auto it = m_objects_by_name.find(name);
-    if (it == m_objects_by_name.end())
+    GameObject* const* object = m_objects_by_name.find(name);
+    if (!object)
     {
       return nullptr;
     }
     else
     {
-      return dynamic_cast<T*>(it->second);
+      return dynamic_cast<T*>(*object);
     }
   }
 
@@ -184,6 +218,8 @@ public:
 protected:
   void process_resolve_requests();
 
+  void set_activity_manager(ActivityManager* activity_manager) { m_activity_manager = activity_manager; }
+
   template<class T>
   T* get_object_by_type() const
   {
@@ -199,23 +235,55 @@ private:
   void this_before_object_add(GameObject& object);
   void this_before_object_remove(GameObject& object);
 
+  template<class T>
+  static void update_batch(GameObjectManager& manager, const std::unique_ptr<GameObject>* objects,
+                           size_t count, float dt_sec)
+  {
+    for (size_t i = 0; i < count; ++i)
+    {
+      GameObject& object = *objects[i];
+      if (!object.is_valid() || object.is_suspended())
+        continue;
+
+      static_cast<T&>(object).T::update(dt_sec);
+      manager.after_object_update(object);
+    }
+  }
+
+  void after_object_update(GameObject& object);
+
 private:
   UIDGenerator m_uid_generator;
 
   std::vector<std::unique_ptr<GameObject>> m_gameobjects;
 
+  /** objects in m_gameobjects that called remove_me() since the last
+      flush, so flushing doesn't have to check every object */
+  std::vector<GameObject*> m_removed_objects;
+
   /** container for newly created objects, they'll be added in flush_game_objects() */
   std::vector<std::unique_ptr<GameObject>> m_gameobjects_new;
 
   /** Fast access to solid tilemaps */
   std::vector<TileMap*> m_solid_tilemaps;
 
-  std::unordered_map<std::string, GameObject*> m_objects_by_name;
-  std::unordered_map<UID, GameObject*> m_objects_by_uid;
+  /** Set when tilemaps were added, removed or changed their
+      solidity, m_solid_tilemaps is rebuilt on the next flush */
+  bool m_solids_dirty;
+
+  FlatHashMap<std::string, GameObject*> m_objects_by_name;
+
+  /** includes the objects in m_gameobjects_new */
+  FlatHashMap<UID, GameObject*> m_objects_by_uid;
   std::unordered_map<std::type_index, std::vector<GameObject*> > m_objects_by_type_index;
 
   std::vector<NameResolveRequest> m_name_resolve_requests;
 
+  /** owned by the subclass, nullptr if all objects always get updated */
+  ActivityManager* m_activity_manager;
+
+  std::vector<UpdateBatch> m_update_batches;
+
 private:
   GameObjectManager(const GameObjectManager&) = delete;
   GameObjectManager& operator=(const GameObjectManager&) = delete;
@@ -26,28 +26,35 @@
 #include "object/level_time.hpp"
 #include "object/music_object.hpp"
 #include "object/player.hpp"
+#include "supertux/asset_manifest.hpp"
 #include "supertux/fadetoblack.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/level.hpp"
 #include "supertux/level_parser.hpp"
 #include "supertux/levelintro.hpp"
 #include "supertux/levelset_screen.hpp"
+#include "supertux/load_stats.hpp"
 #include "supertux/menu/menu_storage.hpp"
 #include "supertux/savegame.hpp"
 #include "supertux/screen_manager.hpp"
 #include "supertux/sector.hpp"
 #include "util/file_system.hpp"
+#include "util/profiler.hpp"
+#include "util/reader.hpp"
+#include "util/reader_document.hpp"
 #include "video/compositor.hpp"
 #include "video/drawing_context.hpp"
 #include "video/surface.hpp"
 #include "worldmap/worldmap.hpp"
 
-GameSession::GameSession(const std::string& levelfile_, Savegame& savegame, Statistics* statistics) :
+GameSession::GameSession(const std::string& levelfile_, Savegame& savegame, Statistics* statistics,
+                         std::unique_ptr<ReaderDocument> level_document) :
   GameSessionRecorder(),
   reset_button(false),
   reset_checkpoint_button(false),
   m_level(),
   m_old_level(),
+  m_level_document(std::move(level_document)),
   m_statistics_backdrop(Surface::from_file("images/engine/menu/score-backdrop.png")),
   m_scripts(),
   m_currentsector(nullptr),
@@ -74,10 +81,27 @@ GameSession::GameSession(const std::string& levelfile_, Savegame& savegame, Stat
   m_max_fire_bullets_at_start(),
   m_max_ice_bullets_at_start(),
   m_active(false),
-  m_end_seq_started(false)
+  m_end_seq_started(false),
+  m_asset_manifest(std::make_unique<AssetManifest>(levelfile_))
 {
+  if (m_level_document) {
+    register_translation_directory(m_levelfile);
+  }
+
   if (restart_level() != 0)
     throw std::runtime_error ("Initializing the level failed.");
+
+  // loaded during the LevelIntro and the fade-in, see update()
+  m_asset_manifest->prefetch();
+  m_asset_manifest->start_recording();
+}
+
+GameSession::~GameSession()
+{
+  // demo benchmarks only read the manifests, see SExpCache::set_read_only()
+  if (!g_config->benchmark_demo) {
+    m_asset_manifest->save();
+  }
 }
 
 void
@@ -118,9 +142,17 @@ GameSession::restart_level(bool after_death)
     m_levelfile = FileSystem::basename(m_levelfile);
   }
 
+  g_load_stats.begin(m_levelfile);
   try {
     m_old_level = std::move(m_level);
-    m_level = LevelParser::from_file(m_levelfile, false, false);
+    if (!m_level_document) {
+      LoadStats::Scope load_scope(LoadStats::READ);
+      register_translation_directory(m_levelfile);
+      m_level_document = std::make_unique<ReaderDocument>(ReaderDocument::from_file(m_levelfile));
+    }
+    m_level = LevelParser::from_document(*m_level_document, false, false);
+
+    LoadStats::Scope scripts_scope(LoadStats::SCRIPTS);
 
     if (!m_reset_sector.empty()) {
       m_currentsector = m_level->get_sector(m_reset_sector);
@@ -142,10 +174,12 @@ GameSession::restart_level(bool after_death)
       }
     }
   } catch(std::exception& e) {
+    g_load_stats.end();
     log_fatal << "Couldn't start level: " << e.what() << std::endl;
     ScreenManager::current()->pop_screen();
     return (-1);
   }
+  g_load_stats.end();
 
   auto& music_object = m_currentsector->get_singleton_by_type<MusicObject>();
   if (after_death == true) {
@@ -306,6 +340,10 @@ GameSession::leave()
 void
 GameSession::update(float dt_sec, const Controller& controller)
 {
+  Profiler::Scope profile_scope("game session");
+
+  m_asset_manifest->preload_step();
+
   // Set active flag
   if (!m_active)
   {
@@ -397,8 +435,10 @@ GameSession::update(float dt_sec, const Controller& controller)
   if (m_currentsector == nullptr)
     return;
 
+  check_state(*m_currentsector);
+
   // update sounds
-  SoundManager::current()->set_listener_position(m_currentsector->get_camera().get_center());
+  SoundManager::current()->set_listener_position(m_currentsector->get_camera().get_view_state().center);
 
   /* Handle music: */
   if (m_end_sequence)
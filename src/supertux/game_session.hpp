@@ -27,8 +27,10 @@
 #include "supertux/screen.hpp"
 #include "supertux/sequence.hpp"
 #include "util/currenton.hpp"
+#include "util/reader_document.hpp"
 #include "video/surface_ptr.hpp"
 
+class AssetManifest;
 class CodeController;
 class DrawingContext;
 class EndSequence;
@@ -43,7 +45,11 @@ class GameSession final : public Screen,
                           public Currenton<GameSession>
 {
 public:
-  GameSession(const std::string& levelfile, Savegame& savegame, Statistics* statistics = nullptr);
+  /** If level_document is given the level is parsed from it instead
+      of being read from levelfile, e.g. for the editor's test-play */
+  GameSession(const std::string& levelfile, Savegame& savegame, Statistics* statistics = nullptr,
+              std::unique_ptr<ReaderDocument> level_document = {});
+  ~GameSession() override;
 
   virtual void draw(Compositor& compositor) override;
   virtual void update(float dt_sec, const Controller& controller) override;
@@ -100,6 +106,10 @@ private:
 private:
   std::unique_ptr<Level> m_level;
   std::unique_ptr<Level> m_old_level;
+
+  /** The level file as parsed on the first start, restarts build the
+      level from it instead of loading the file again */
+  std::unique_ptr<ReaderDocument> m_level_document;
   SurfacePtr m_statistics_backdrop;
 
   // scripts
@@ -150,6 +160,8 @@ private:
 
   bool m_end_seq_started;
 
+  std::unique_ptr<AssetManifest> m_asset_manifest;
+
 private:
   GameSession(const GameSession&) = delete;
   GameSession& operator=(const GameSession&) = delete;
@@ -16,23 +16,34 @@
 
 #include "supertux/game_session_recorder.hpp"
 
+#include <config.h>
+
 #include <fstream>
+#include <iostream>
 
 #include "control/input_manager.hpp"
 #include "math/random.hpp"
 #include "object/player.hpp"
+#include "supertux/demo_stream.hpp"
 #include "supertux/game_session.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/globals.hpp"
+#include "supertux/screen_fade.hpp"
+#include "supertux/screen_manager.hpp"
 #include "supertux/sector.hpp"
+#include "util/fnv_hash.hpp"
 #include "util/log.hpp"
 
 GameSessionRecorder::GameSessionRecorder() :
   m_capture_file(),
-  m_capture_demo_stream(),
-  m_playback_demo_stream(),
+  m_demo_writer(),
+  m_demo_reader(),
   m_demo_controller(),
-  m_playing(false)
+  m_playing(false),
+  m_checksum_writer(),
+  m_checksum_reader(),
+  m_diverged(false),
+  m_diverged_frame(0)
 {
 }
 
@@ -57,36 +68,39 @@ GameSessionRecorder::start_recording()
 void
 GameSessionRecorder::record_demo(const std::string& filename)
 {
-  m_capture_demo_stream.reset(new std::ofstream(filename.c_str()));
-  if (!m_capture_demo_stream->good()) {
+  // finish the previous demo first, restarts record to the same file
+  m_demo_writer.reset();
+  m_checksum_writer.reset();
+
+  std::unique_ptr<std::ostream> stream(new std::ofstream(filename.c_str(), std::ios::binary));
+  if (!stream->good()) {
     std::stringstream msg;
     msg << "Couldn't open demo file '" << filename << "' for writing.";
     throw std::runtime_error(msg.str());
   }
   m_capture_file = filename;
 
-  char buf[30];                            // save the seed in the demo file
-  snprintf(buf, sizeof(buf), "random_seed=%10d", g_config->random_seed);
-  for (int i = 0; i == 0 || buf[i-1]; i++)
-    m_capture_demo_stream->put(buf[i]);
+  m_demo_writer.reset(new DemoWriter(std::move(stream), g_config->random_seed));
+
+  std::unique_ptr<std::ostream> checksum_stream(new std::ofstream((filename + ".hash").c_str(), std::ios::binary));
+  if (checksum_stream->good()) {
+    m_checksum_writer.reset(new DemoChecksumWriter(std::move(checksum_stream)));
+  } else {
+    log_warning << "Couldn't open '" << filename << ".hash', not recording state checksums" << std::endl;
+  }
 }
 
 int
 GameSessionRecorder::get_demo_random_seed(const std::string& filename) const
 {
-  std::unique_ptr<std::istream> test_stream(new std::ifstream(filename.c_str()));
+  std::unique_ptr<std::istream> test_stream(new std::ifstream(filename.c_str(), std::ios::binary));
   if (test_stream->good())
   {
-    char buf[30];                     // recall the seed from the demo file
-    int seed;
-
-    for (int i=0; i<30 && (i==0 || buf[i-1]); i++)
-      test_stream->get(buf[i]);
-
-    if (sscanf(buf, "random_seed=%10d", &seed) == 1)
+    DemoReader reader(std::move(test_stream));
+    if (reader.get_random_seed() != 0)
     {
-      log_info << "Random seed " << seed << " from demo file" << std::endl;
-      return seed;
+      log_info << "Random seed " << reader.get_random_seed() << " from demo file" << std::endl;
+      return reader.get_random_seed();
     }
     else
     {
@@ -101,26 +115,32 @@ GameSessionRecorder::play_demo(const std::string& filename)
 {
   m_playing = true;
 
-  m_playback_demo_stream.reset();
+  m_demo_reader.reset();
   m_demo_controller.reset();
 
-  m_playback_demo_stream.reset(new std::ifstream(filename.c_str()));
-  if (!m_playback_demo_stream->good()) {
+  std::unique_ptr<std::istream> stream(new std::ifstream(filename.c_str(), std::ios::binary));
+  if (!stream->good()) {
     std::stringstream msg;
     msg << "Couldn't open demo file '" << filename << "' for reading.";
     throw std::runtime_error(msg.str());
   }
+  m_demo_reader.reset(new DemoReader(std::move(stream)));
+
+  // demos recorded before the checksums were added play without
+  m_checksum_reader.reset();
+  m_diverged = false;
+  m_diverged_frame = 0;
+  std::unique_ptr<std::istream> checksum_stream(new std::ifstream((filename + ".hash").c_str(), std::ios::binary));
+  if (checksum_stream->good()) {
+    m_checksum_reader.reset(new DemoChecksumReader(std::move(checksum_stream)));
+    if (!m_checksum_reader->is_valid()) {
+      log_warning << "'" << filename << ".hash' is not a checksum file" << std::endl;
+      m_checksum_reader.reset();
+    }
+  }
 
   reset_demo_controller();
 
-  // skip over random seed, if it exists in the file
-  char buf[30];                            // ascii decimal seed
-  int seed;
-  for (int i=0; i<30 && (i==0 || buf[i-1]); i++)
-    m_playback_demo_stream->get(buf[i]);
-  if (sscanf(buf, "random_seed=%010d", &seed) != 1)
-    m_playback_demo_stream->seekg(0);     // old style w/o seed, restart at beg
-
   m_playing = false;
 }
 
@@ -140,38 +160,76 @@ void
 GameSessionRecorder::process_events()
 {
   // playback a demo?
-  if (m_playback_demo_stream != nullptr)
+  if (m_demo_reader != nullptr)
   {
     m_demo_controller->update();
 
-    char left, right, up, down, jump, action;
-
-    m_playback_demo_stream->get(left);
-    m_playback_demo_stream->get(right);
-    m_playback_demo_stream->get(up);
-    m_playback_demo_stream->get(down);
-    m_playback_demo_stream->get(jump);
-    m_playback_demo_stream->get(action);
-
-    m_demo_controller->press(Control::LEFT, left != 0);
-    m_demo_controller->press(Control::RIGHT, right != 0);
-    m_demo_controller->press(Control::UP, up != 0);
-    m_demo_controller->press(Control::DOWN,  down != 0);
-    m_demo_controller->press(Control::JUMP, jump != 0);
-    m_demo_controller->press(Control::ACTION,  action != 0);
+    uint8_t controls = 0;
+    if (!m_demo_reader->next_frame(controls) && g_config->benchmark_demo)
+    {
+      // the benchmark is over when the recorded input is, the result
+      // of the checksums is printed for --replay-demos
+      if (!m_checksum_reader) {
+        std::cout << "checksum none" << std::endl;
+      } else if (m_diverged) {
+        std::cout << "checksum diverged " << m_diverged_frame << std::endl;
+      } else {
+        std::cout << "checksum ok" << std::endl;
+      }
+
+      m_demo_reader.reset();
+      m_checksum_reader.reset();
+      ScreenManager::current()->quit();
+      return;
+    }
+
+    for (int i = 0; i < DEMO_CONTROL_COUNT; ++i) {
+      m_demo_controller->press(static_cast<Control>(i), (controls & (1 << i)) != 0);
+    }
   }
 
   // save input for demo?
-  if (m_capture_demo_stream != nullptr)
+  if (m_demo_writer != nullptr)
   {
     Controller& controller = InputManager::current()->get_controller();
 
-    m_capture_demo_stream->put(controller.hold(Control::LEFT));
-    m_capture_demo_stream->put(controller.hold(Control::RIGHT));
-    m_capture_demo_stream->put(controller.hold(Control::UP));
-    m_capture_demo_stream->put(controller.hold(Control::DOWN));
-    m_capture_demo_stream->put(controller.hold(Control::JUMP));
-    m_capture_demo_stream->put(controller.hold(Control::ACTION));
+    uint8_t controls = 0;
+    for (int i = 0; i < DEMO_CONTROL_COUNT; ++i) {
+      if (controller.hold(static_cast<Control>(i))) {
+        controls |= static_cast<uint8_t>(1 << i);
+      }
+    }
+    m_demo_writer->add_frame(controls);
+  }
+}
+
+void
+GameSessionRecorder::check_state(const Sector& sector)
+{
+  if (!m_checksum_writer && !m_checksum_reader)
+    return;
+
+  FNVHash hash;
+  hash.add(sector.get_state_hash());
+  hash.add(gameRandom.get_state_hash());
+
+  if (m_checksum_writer) {
+    m_checksum_writer->add_frame(hash.get());
+  }
+
+  uint64_t recorded;
+  if (m_checksum_reader && m_checksum_reader->next_frame(recorded) &&
+      recorded != hash.get() && !m_diverged)
+  {
+    // everything after the first difference differs as well
+    log_warning << "Demo playback diverged from the recording in frame "
+                << m_checksum_reader->get_frame() << std::endl;
+#ifndef ENABLE_DETERMINISTIC_FLOAT
+    log_warning << "Without ENABLE_DETERMINISTIC_FLOAT, demos only replay exactly on the "
+                << "platform and build they were recorded with" << std::endl;
+#endif
+    m_diverged = true;
+    m_diverged_frame = m_checksum_reader->get_frame();
   }
 }
 
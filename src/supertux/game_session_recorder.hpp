@@ -18,10 +18,17 @@
 #define HEADER_SUPERTUX_SUPERTUX_GAME_SESSION_RECORDER_HPP
 
 #include <memory>
+#include <stdint.h>
 #include <string>
 
 #include "control/codecontroller.hpp"
 
+class DemoChecksumReader;
+class DemoChecksumWriter;
+class DemoReader;
+class DemoWriter;
+class Sector;
+
 class GameSessionRecorder
 {
 public:
@@ -40,16 +47,27 @@ public:
 
   bool is_playing_demo() const { return m_playing; }
 
+  /** Records the state hash of the logical frame that just ended, or
+      compares it against the recorded one when playing a demo that
+      has a checksum file */
+  void check_state(const Sector& sector);
+
 private:
   void capture_demo_step();
 
 private:
   std::string m_capture_file;
-  std::unique_ptr<std::ostream> m_capture_demo_stream;
-  std::unique_ptr<std::istream> m_playback_demo_stream;
+  std::unique_ptr<DemoWriter> m_demo_writer;
+  std::unique_ptr<DemoReader> m_demo_reader;
   std::unique_ptr<CodeController> m_demo_controller;
   bool m_playing;
 
+  /** Written to and read from the demo filename with ".hash" added */
+  std::unique_ptr<DemoChecksumWriter> m_checksum_writer;
+  std::unique_ptr<DemoChecksumReader> m_checksum_reader;
+  bool m_diverged;
+  uint32_t m_diverged_frame;
+
 private:
   GameSessionRecorder(const GameSessionRecorder&) = delete;
   GameSessionRecorder& operator=(const GameSessionRecorder&) = delete;
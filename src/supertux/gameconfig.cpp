@@ -31,6 +31,18 @@ Config::Config() :
   window_resizable(true),
   aspect_size(0, 0), // auto detect
   magnification(0.0f),
+  texture_atlas(true),
+  power_saving(false),
+  texture_cache_budget(64),
+  texture_upload_budget(2048),
+  hitch_threshold_ms(0),
+  compressed_textures(true),
+  render_interpolation(false),
+  precise_frame_pacing(false),
+  deferred_flip(false),
+  lightmap_quality(1),
+  render_scale(1.0f),
+  dynamic_render_scale(false),
   use_fullscreen(false),
   video(VideoSystem::VIDEO_AUTO),
   try_vsync(true),
@@ -41,10 +53,17 @@ Config::Config() :
   music_enabled(true),
   sound_volume(100),
   music_volume(50),
+  sound_cache_budget(32),
   random_seed(0), // set by time(), by default (unless in config)
   enable_script_debugger(false),
+  script_bytecode_cache(true),
   start_demo(),
   record_demo(),
+  benchmark_demo(false),
+  render_stats_file(),
+  trace_file(),
+  capture_file(),
+  script_profile_file(),
   tux_spawn_pos(),
   locale(),
   keyboard_config(),
@@ -55,7 +74,8 @@ Config::Config() :
   transitions_enabled(true),
   confirmation_dialog(false),
   pause_on_focusloss(true),
-  repository_url()
+  repository_url(),
+  download_connections(4)
 {
 }
 
@@ -77,6 +97,7 @@ Config::load()
   config_mapping.get("developer", developer_mode);
   config_mapping.get("confirmation_dialog", confirmation_dialog);
   config_mapping.get("pause_on_focusloss", pause_on_focusloss);
+  config_mapping.get("script_bytecode_cache", script_bytecode_cache);
 
   EditorOverlayWidget::autotile_help = !developer_mode;
 
@@ -90,6 +111,7 @@ Config::load()
   config_mapping.get("locale", locale);
   config_mapping.get("random_seed", random_seed);
   config_mapping.get("repository_url", repository_url);
+  config_mapping.get("download_connections", download_connections);
 
   boost::optional<ReaderMapping> config_video_mapping;
   if (config_mapping.get("video", config_video_mapping))
@@ -119,6 +141,18 @@ Config::load()
     config_video_mapping->get("aspect_height", aspect_size.height);
 
     config_video_mapping->get("magnification", magnification);
+    config_video_mapping->get("texture_atlas", texture_atlas);
+    config_video_mapping->get("power_saving", power_saving);
+    config_video_mapping->get("texture_cache_budget", texture_cache_budget);
+    config_video_mapping->get("texture_upload_budget", texture_upload_budget);
+    config_video_mapping->get("compressed_textures", compressed_textures);
+    config_video_mapping->get("render_interpolation", render_interpolation);
+    config_video_mapping->get("precise_frame_pacing", precise_frame_pacing);
+    config_video_mapping->get("deferred_flip", deferred_flip);
+    config_video_mapping->get("hitch_threshold_ms", hitch_threshold_ms);
+    config_video_mapping->get("lightmap_quality", lightmap_quality);
+    config_video_mapping->get("render_scale", render_scale);
+    config_video_mapping->get("dynamic_render_scale", dynamic_render_scale);
   }
 
   boost::optional<ReaderMapping> config_audio_mapping;
@@ -128,6 +162,7 @@ Config::load()
     config_audio_mapping->get("music_enabled", music_enabled);
     config_audio_mapping->get("sound_volume", sound_volume);
     config_audio_mapping->get("music_volume", music_volume);
+    config_audio_mapping->get("sound_cache_budget", sound_cache_budget);
   }
 
   boost::optional<ReaderMapping> config_control_mapping;
@@ -185,12 +220,14 @@ Config::save()
   writer.write("developer", developer_mode);
   writer.write("confirmation_dialog", confirmation_dialog);
   writer.write("pause_on_focusloss", pause_on_focusloss);
+  writer.write("script_bytecode_cache", script_bytecode_cache);
   if (is_christmas()) {
     writer.write("christmas", christmas_mode);
   }
   writer.write("transitions_enabled", transitions_enabled);
   writer.write("locale", locale);
   writer.write("repository_url", repository_url);
+  writer.write("download_connections", download_connections);
 
   writer.start_list("video");
   writer.write("fullscreen", use_fullscreen);
@@ -215,6 +252,18 @@ Config::save()
   writer.write("aspect_height", aspect_size.height);
 
   writer.write("magnification", magnification);
+  writer.write("texture_atlas", texture_atlas);
+  writer.write("power_saving", power_saving);
+  writer.write("texture_cache_budget", texture_cache_budget);
+  writer.write("texture_upload_budget", texture_upload_budget);
+  writer.write("compressed_textures", compressed_textures);
+  writer.write("render_interpolation", render_interpolation);
+  writer.write("precise_frame_pacing", precise_frame_pacing);
+  writer.write("deferred_flip", deferred_flip);
+  writer.write("hitch_threshold_ms", hitch_threshold_ms);
+  writer.write("lightmap_quality", lightmap_quality);
+  writer.write("render_scale", render_scale);
+  writer.write("dynamic_render_scale", dynamic_render_scale);
 
   writer.end_list("video");
 
@@ -223,6 +272,7 @@ Config::save()
   writer.write("music_enabled", music_enabled);
   writer.write("sound_volume", sound_volume);
   writer.write("music_volume", music_volume);
+  writer.write("sound_cache_budget", sound_cache_budget);
   writer.end_list("audio");
 
   writer.start_list("control");
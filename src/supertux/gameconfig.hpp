@@ -54,6 +54,55 @@ public:
 
   float magnification;
 
+  /** Pack tiles and sprite frames onto shared atlas pages */
+  bool texture_atlas;
+
+  /** Skip rendering frames that are identical to the previous one
+      and wake up less often while nothing changes */
+  bool power_saving;
+
+  /** Megabytes of decoded images TextureManager keeps around to cut
+      textures from, least recently used ones are freed beyond that,
+      0 means no limit */
+  int texture_cache_budget;
+
+  /** Kilobytes of large textures uploaded per frame, textures above
+      that size appear once all their rows are uploaded, 0 uploads
+      everything right away */
+  int texture_upload_budget;
+
+  /** Frames taking longer than this many milliseconds get their
+      profiler zones and the files loaded meanwhile logged, 0 = off */
+  int hitch_threshold_ms;
+
+  /** Use precompressed .ktx files next to images when the GPU
+      supports their format */
+  bool compressed_textures;
+
+  /** Draw at the display rate and interpolate positions in between
+      the fixed logic steps */
+  bool render_interpolation;
+
+  /** Pace the main loop with the high resolution performance counter
+      and spin the last bit of each wait, instead of relying on
+      millisecond SDL_Delay() */
+  bool precise_frame_pacing;
+
+  /** Present a frame only right before the next one is drawn, so the
+      logic steps in between overlap with the GPU finishing it */
+  bool deferred_flip;
+
+  /** Resolution of the lightmap relative to the screen, 0 = low,
+      1 = medium, 2 = high */
+  int lightmap_quality;
+
+  /** Resolution the level gets drawn at relative to the screen, it is
+      upscaled when shown, the HUD stays at full resolution. OpenGL
+      only. With dynamic_render_scale, it is the upper bound of the
+      scale picked from the GPU time of the frames. */
+  float render_scale;
+  bool dynamic_render_scale;
+
   bool use_fullscreen;
   VideoSystem::Enum video;
   bool try_vsync;
@@ -65,13 +114,38 @@ public:
   int sound_volume;
   int music_volume;
 
+  /** Megabytes of decoded sound effects SoundManager keeps in
+      OpenAL buffers, least recently used ones are freed beyond that,
+      0 means no limit */
+  int sound_cache_budget;
+
   /** initial random seed.  0 ==> set from time() */
   int random_seed;
 
   bool enable_script_debugger;
+
+  /** Keep compiled level scripts as bytecode in the userdir */
+  bool script_bytecode_cache;
+
   std::string start_demo;
   std::string record_demo;
 
+  /** Play start_demo without pacing and report the step times of
+      the subsystems when done */
+  bool benchmark_demo;
+
+  /** Write RenderStats of every frame as CSV to this file */
+  std::string render_stats_file;
+
+  /** Write the Profiler zones of every frame to this file as Chrome trace */
+  std::string trace_file;
+
+  /** Stream every drawn frame to this file as raw RGB24 video */
+  std::string capture_file;
+
+  /** Write the time spent in scripts as folded stacks to this file on exit */
+  std::string script_profile_file;
+
   /** this variable is set if tux should spawn somewhere which isn't the "main" spawn point*/
   boost::optional<Vector> tux_spawn_pos;
 
@@ -98,6 +172,9 @@ public:
 
   std::string repository_url;
 
+  /** Parallel connections used for add-on downloads */
+  int download_connections;
+
   bool is_christmas() const {
     try
     {
@@ -22,5 +22,7 @@ std::unique_ptr<Config> g_config;
 
 float g_game_time = 0;
 float g_real_time = 0;
+float g_render_time = 0;
+float g_render_alpha = 1;
 
 /* EOF */
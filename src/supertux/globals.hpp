@@ -32,6 +32,14 @@ extern std::unique_ptr<Config> g_config;
 extern float g_game_time;
 extern float g_real_time;
 
+/** Game time of the frame being drawn, trails g_game_time by up to one
+    logic step with render interpolation, used for animations */
+extern float g_render_time;
+
+/** How far the frame being drawn is between the previous and the
+    current logic step, 1 without render interpolation */
+extern float g_render_alpha;
+
 #endif
 
 /* EOF */
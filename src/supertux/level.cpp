@@ -176,60 +176,39 @@ Level::get_sector(size_t num) const
   return m_sectors.at(num).get();
 }
 
-int
-Level::get_total_coins() const
+Level::Totals
+Level::count_totals() const
 {
-  int total_coins = 0;
-  for (auto const& sector : m_sectors) {
-    for (const auto& o: sector->get_objects()) {
-      auto coin = dynamic_cast<Coin*>(o.get());
-      if (coin)
+  Totals totals;
+  for (const auto& sector : m_sectors) {
+    for (const auto& o : sector->get_objects()) {
+      if (auto badguy = dynamic_cast<const BadGuy*>(o.get()))
       {
-        total_coins++;
-        continue;
+        if (badguy->m_countMe)
+          totals.badguys += 1;
+        if (dynamic_cast<const GoldBomb*>(badguy))
+          totals.coins += 10;
       }
-      auto block = dynamic_cast<BonusBlock*>(o.get());
-      if (block)
+      else if (dynamic_cast<const Coin*>(o.get()))
       {
-        if (block->get_contents() == BonusBlock::Content::COIN)
-        {
-          total_coins += block->get_hit_counter();
-          continue;
+        totals.coins += 1;
+      }
+      else if (auto block = dynamic_cast<const BonusBlock*>(o.get()))
+      {
+        if (block->get_contents() == BonusBlock::Content::COIN) {
+          totals.coins += block->get_hit_counter();
         } else if (block->get_contents() == BonusBlock::Content::RAIN ||
-                   block->get_contents() == BonusBlock::Content::EXPLODE)
-        {
-          total_coins += 10;
-          continue;
+                   block->get_contents() == BonusBlock::Content::EXPLODE) {
+          totals.coins += 10;
         }
       }
-      auto goldbomb = dynamic_cast<GoldBomb*>(o.get());
-      if (goldbomb)
-        total_coins += 10;
+      else if (dynamic_cast<const SecretAreaTrigger*>(o.get()))
+      {
+        totals.secrets += 1;
+      }
     }
   }
-  return total_coins;
-}
-
-int
-Level::get_total_badguys() const
-{
-  int total_badguys = 0;
-  for (auto const& sector : m_sectors) {
-    total_badguys += sector->get_object_count<BadGuy>([] (const BadGuy& badguy) {
-      return badguy.m_countMe;
-    });
-  }
-  return total_badguys;
-}
-
-int
-Level::get_total_secrets() const
-{
-  int total_secrets = 0;
-  for (auto const& sector : m_sectors) {
-    total_secrets += sector->get_object_count<SecretAreaTrigger>();
-  }
-  return total_secrets;
+  return totals;
 }
 
 void
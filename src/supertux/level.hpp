@@ -55,9 +55,18 @@ public:
 
   std::string get_tileset() const { return m_tileset; }
 
-  int get_total_coins() const;
-  int get_total_badguys() const;
-  int get_total_secrets() const;
+  struct Totals
+  {
+    Totals() : coins(0), badguys(0), secrets(0) {}
+
+    int coins;
+    int badguys;
+    int secrets;
+  };
+
+  /** Counts what the Statistics track in one pass over the objects of
+      all sectors, done once by the LevelParser */
+  Totals count_totals() const;
 
   void reactivate();
 
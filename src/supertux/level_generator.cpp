@@ -0,0 +1,236 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "supertux/level_generator.hpp"
+
+#include <algorithm>
+#include <stdexcept>
+
+#include "math/random.hpp"
+#include "object/tilemap.hpp"
+#include "supertux/game_object_factory.hpp"
+#include "supertux/level.hpp"
+#include "supertux/level_parser.hpp"
+#include "supertux/sector.hpp"
+#include "supertux/tile_manager.hpp"
+
+namespace {
+
+const struct
+{
+  const char* name;
+  int LevelGenerator::Params::*member;
+} PARAMS[] = {
+  { "width", &LevelGenerator::Params::width },
+  { "height", &LevelGenerator::Params::height },
+  { "layers", &LevelGenerator::Params::layers },
+  { "badguys", &LevelGenerator::Params::badguys },
+  { "coins", &LevelGenerator::Params::coins },
+  { "lights", &LevelGenerator::Params::lights },
+  { "particles", &LevelGenerator::Params::particles },
+  { "scripts", &LevelGenerator::Params::scripts },
+  { "seed", &LevelGenerator::Params::seed }
+};
+
+/** Snow ground of images/tiles.strf */
+const uint32_t TILE_GROUND = 14;
+const uint32_t TILE_FILL = 11;
+
+/** Non-solid snow decoration for the extra layers */
+const uint32_t TILE_DECORATION = 8;
+
+const char* const BADGUYS[] = { "snowball", "mriceblock", "spiky", "bouncingsnowball" };
+const char* const PARTICLES[] = { "particles-snow", "particles-rain", "particles-clouds", "particles-ghosts" };
+
+const float TILE_SIZE = 32.0f;
+
+} // namespace
+
+const int LevelGenerator::SCREEN_TILES;
+
+LevelGenerator::Params::Params() :
+  width(400),
+  height(35),
+  layers(0),
+  badguys(4),
+  coins(10),
+  lights(0),
+  particles(0),
+  scripts(0),
+  seed(1)
+{
+}
+
+LevelGenerator::Params
+LevelGenerator::parse_params(const std::string& text)
+{
+  Params params;
+
+  std::string::size_type start = 0;
+  while (start < text.size())
+  {
+    std::string::size_type end = text.find(',', start);
+    if (end == std::string::npos) {
+      end = text.size();
+    }
+
+    const std::string item = text.substr(start, end - start);
+    start = end + 1;
+
+    const std::string::size_type equal = item.find('=');
+    if (equal == std::string::npos)
+      throw std::runtime_error("Expected name=value, got '" + item + "'");
+
+    const std::string name = item.substr(0, equal);
+    int Params::*member = nullptr;
+    for (const auto& param : PARAMS) {
+      if (name == param.name) {
+        member = param.member;
+      }
+    }
+    if (!member)
+      throw std::runtime_error("Unknown level generator parameter '" + name + "'");
+
+    size_t pos = 0;
+    int value = 0;
+    try {
+      value = std::stoi(item.substr(equal + 1), &pos);
+    } catch(const std::exception&) {
+      pos = 0;
+    }
+    if (pos == 0 || pos != item.size() - equal - 1 || value < 0)
+      throw std::runtime_error("Bad value for level generator parameter '" + name + "'");
+
+    params.*member = value;
+  }
+
+  if (params.width < 1 || params.height < 10)
+    throw std::runtime_error("The generated level needs to be at least 1x10 tiles");
+
+  return params;
+}
+
+std::unique_ptr<Level>
+LevelGenerator::generate(const Params& params)
+{
+  Random rng;
+  rng.seed(params.seed);
+
+  auto level = LevelParser::from_nothing("");
+  level->m_name = "Synthetic " + std::to_string(params.width) + "x" + std::to_string(params.height);
+  level->m_author = "LevelGenerator";
+
+  Sector& sector = *level->get_sector(0);
+
+  // ground that goes up and down a bit, every column has its height
+  // so objects can be put on top
+  std::vector<int> ground(params.width);
+  int height = params.height - 5;
+  for (int x = 0; x < params.width; ++x)
+  {
+    if (x % 8 == 0) {
+      height = std::max(params.height / 2, std::min(params.height - 3, height + rng.rand(-2, 3)));
+    }
+    ground[x] = height;
+  }
+
+  auto tileset = TileManager::current()->get_tileset(level->get_tileset());
+  for (auto& tilemap : sector.get_objects_by_type<TileMap>())
+  {
+    tilemap.resize(params.width, params.height);
+    if (tilemap.is_solid())
+    {
+      for (int x = 0; x < params.width; ++x) {
+        tilemap.change(x, ground[x], TILE_GROUND);
+        for (int y = ground[x] + 1; y < params.height; ++y) {
+          tilemap.change(x, y, TILE_FILL);
+        }
+      }
+    }
+  }
+
+  for (int i = 0; i < params.layers; ++i)
+  {
+    auto& tilemap = sector.add<TileMap>(tileset);
+    tilemap.resize(params.width, params.height);
+    tilemap.set_layer(-50 + i);
+    tilemap.set_solid(false);
+    for (int x = 0; x < params.width; ++x) {
+      for (int y = 0; y < ground[x]; ++y) {
+        if (rng.rand(10) == 0) {
+          tilemap.change(x, y, TILE_DECORATION);
+        }
+      }
+    }
+  }
+
+  auto& factory = GameObjectFactory::instance();
+  auto add = [&sector, &factory](const std::string& name, const Vector& pos, const std::string& data) {
+    sector.add_object(factory.create(name, pos, Direction::AUTO, data));
+  };
+
+  // stay away from the spawnpoint at the start
+  const int screens = std::max(1, params.width / SCREEN_TILES);
+  auto random_column = [&rng, &params]() {
+    return std::min(params.width - 1, 4 + rng.rand(std::max(1, params.width - 4)));
+  };
+
+  for (int i = 0; i < params.badguys * screens; ++i)
+  {
+    const int x = random_column();
+    add(BADGUYS[i % 4], Vector(static_cast<float>(x) * TILE_SIZE,
+                               static_cast<float>(ground[x] - 1) * TILE_SIZE), "");
+  }
+
+  for (int i = 0; i < params.coins * screens; ++i)
+  {
+    const int x = random_column();
+    const int y = std::max(0, ground[x] - rng.rand(2, 6));
+    add("coin", Vector(static_cast<float>(x) * TILE_SIZE, static_cast<float>(y) * TILE_SIZE), "");
+  }
+
+  if (params.lights > 0)
+  {
+    // without darkness the lights aren't drawn at all
+    add("ambient-light", Vector(0.0f, 0.0f), " (color 0.2 0.2 0.3)");
+    for (int i = 0; i < params.lights * screens; ++i)
+    {
+      const int x = random_column();
+      const int y = rng.rand(std::max(1, ground[x]));
+      add("spotlight", Vector(static_cast<float>(x) * TILE_SIZE, static_cast<float>(y) * TILE_SIZE),
+          " (angle " + std::to_string(rng.rand(360)) + ")");
+    }
+  }
+
+  for (int i = 0; i < params.particles; ++i)
+  {
+    add(PARTICLES[i % 4], Vector(0.0f, 0.0f), "");
+  }
+
+  for (int i = 0; i < params.scripts; ++i)
+  {
+    const int x = random_column();
+    add("scriptedobject", Vector(static_cast<float>(x) * TILE_SIZE,
+                                 static_cast<float>(ground[x] - 1) * TILE_SIZE),
+        " (name \"scripted" + std::to_string(i) + "\")");
+  }
+
+  sector.flush_game_objects();
+  return level;
+}
+
+/* EOF */
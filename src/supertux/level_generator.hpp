@@ -0,0 +1,71 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_LEVEL_GENERATOR_HPP
+#define HEADER_SUPERTUX_SUPERTUX_LEVEL_GENERATOR_HPP
+
+#include <memory>
+#include <string>
+
+class Level;
+
+/** Creates synthetic levels with a given amount of everything, so
+    benchmarks can sweep the sizes and see how each subsystem scales.
+    Used by --generate-level, the parameters are given as
+    "width=400,badguys=8" with the names of the Params members. */
+class LevelGenerator final
+{
+public:
+  struct Params
+  {
+    Params();
+
+    /** Size of the tilemaps in tiles */
+    int width;
+    int height;
+
+    /** Decorative tilemaps in addition to background and foreground */
+    int layers;
+
+    /** Objects per screen of SCREEN_TILES columns */
+    int badguys;
+    int coins;
+    int lights;
+
+    /** Objects in the whole sector */
+    int particles;
+    int scripts;
+
+    int seed;
+  };
+
+  /** Columns of the level that count as one screen */
+  static const int SCREEN_TILES = 40;
+
+public:
+  /** Throws std::runtime_error on unknown names or bad values */
+  static Params parse_params(const std::string& text);
+
+  static std::unique_ptr<Level> generate(const Params& params);
+
+private:
+  LevelGenerator() = delete;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,302 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "supertux/level_index.hpp"
+
+#include <physfs.h>
+#include <sexp/value.hpp>
+#include <stdint.h>
+#include <unordered_map>
+
+#include "addon/md5.hpp"
+#include "util/gettext.hpp"
+#include "util/log.hpp"
+#include "util/reader.hpp"
+#include "util/reader_document.hpp"
+#include "util/reader_iterator.hpp"
+#include "util/reader_mapping.hpp"
+#include "util/writer.hpp"
+
+namespace {
+
+const char INDEX_DIRECTORY[] = "cache";
+const char INDEX_FILENAME[] = "cache/level-index";
+
+struct Entry
+{
+  Entry() : size(0), mtime(0), info(), translatable(false) {}
+
+  uint64_t size;
+  int64_t mtime;
+
+  /** name is stored untranslated, so the index survives changing
+      the language */
+  LevelIndex::Info info;
+  bool translatable;
+};
+
+std::unordered_map<std::string, Entry> s_entries;
+bool s_loaded = false;
+bool s_dirty = false;
+
+std::string get_md5(const std::string& data)
+{
+  MD5 md5;
+  md5.update(reinterpret_cast<uint8_t*>(const_cast<char*>(data.data())),
+             static_cast<unsigned int>(data.size()));
+  return md5.hex_digest();
+}
+
+bool stat_file(const std::string& filename, uint64_t& size, int64_t& mtime)
+{
+  PHYSFS_Stat statbuf;
+  if (!PHYSFS_stat(filename.c_str(), &statbuf) || statbuf.filesize < 0)
+    return false;
+
+  size = static_cast<uint64_t>(statbuf.filesize);
+  mtime = statbuf.modtime;
+  return true;
+}
+
+bool read_file(const std::string& filename, std::string& data)
+{
+  PHYSFS_File* file = PHYSFS_openRead(filename.c_str());
+  if (!file)
+    return false;
+
+  const PHYSFS_sint64 length = PHYSFS_fileLength(file);
+  bool success = false;
+  if (length >= 0)
+  {
+    data.resize(static_cast<size_t>(length));
+    success = length == 0 ||
+      PHYSFS_readBytes(file, &data[0], static_cast<PHYSFS_uint64>(length)) == length;
+  }
+  PHYSFS_close(file);
+  return success;
+}
+
+/** Reads (key "string") or (key (_ "string")) from the top level of
+    a document without translating it */
+bool get_raw_string(const sexp::Value& root, const char* key, std::string& value, bool& translatable)
+{
+  for (const auto& item : root.as_array())
+  {
+    if (!item.is_array() || item.as_array().size() != 2 ||
+        !item.as_array()[0].is_symbol() || item.as_array()[0].as_string() != key)
+      continue;
+
+    const sexp::Value& sx = item.as_array()[1];
+    if (sx.is_string()) {
+      value = sx.as_string();
+      translatable = false;
+      return true;
+    } else if (sx.is_array() && sx.as_array().size() == 2 &&
+               sx.as_array()[0].is_symbol() && sx.as_array()[0].as_string() == "_" &&
+               sx.as_array()[1].is_string()) {
+      value = sx.as_array()[1].as_string();
+      translatable = true;
+      return true;
+    }
+  }
+  return false;
+}
+
+void scan_level(const std::string& filename, Entry& entry)
+{
+  entry.info.name.clear();
+  entry.info.author.clear();
+  entry.info.sector_count = 0;
+  entry.translatable = false;
+
+  try
+  {
+    auto doc = ReaderDocument::from_file(filename);
+    auto root = doc.get_root();
+    if (root.get_name() != "supertux-level")
+      return;
+
+    const sexp::Value& sx = root.get_sexp();
+    bool author_translatable;
+    get_raw_string(sx, "name", entry.info.name, entry.translatable);
+    get_raw_string(sx, "author", entry.info.author, author_translatable);
+
+    auto mapping = root.get_mapping();
+    int version = 1;
+    mapping.get("version", version);
+    if (version == 1) {
+      entry.info.sector_count = 1;
+    } else {
+      auto iter = mapping.get_iter();
+      while (iter.next()) {
+        if (iter.get_key() == "sector") {
+          entry.info.sector_count += 1;
+        }
+      }
+    }
+  }
+  catch(const std::exception& e)
+  {
+    log_warning << "Problem getting name of '" << filename << "': "
+                << e.what() << std::endl;
+  }
+}
+
+void load_index()
+{
+  s_loaded = true;
+  if (!PHYSFS_exists(INDEX_FILENAME))
+    return;
+
+  try
+  {
+    auto doc = ReaderDocument::from_file(INDEX_FILENAME);
+    auto root = doc.get_root();
+    if (root.get_name() != "supertux-level-index")
+      return;
+
+    auto iter = root.get_mapping().get_iter();
+    while (iter.next())
+    {
+      if (iter.get_key() != "level")
+        continue;
+
+      auto mapping = iter.as_mapping();
+      std::string filename;
+      std::string size;
+      std::string mtime;
+      Entry entry;
+      if (!mapping.get("file", filename) ||
+          !mapping.get("size", size) ||
+          !mapping.get("mtime", mtime) ||
+          !mapping.get("md5", entry.info.md5))
+        continue;
+
+      // 64 bit values don't fit into sexp integers
+      entry.size = std::stoull(size);
+      entry.mtime = std::stoll(mtime);
+      mapping.get("name", entry.info.name);
+      mapping.get("translatable", entry.translatable);
+      mapping.get("author", entry.info.author);
+      mapping.get("sectors", entry.info.sector_count);
+      s_entries[filename] = entry;
+    }
+  }
+  catch(const std::exception& e)
+  {
+    log_warning << "couldn't read level index: " << e.what() << std::endl;
+    s_entries.clear();
+  }
+}
+
+} // namespace
+
+namespace LevelIndex {
+
+Info
+get(const std::string& filename)
+{
+  if (!s_loaded) {
+    load_index();
+  }
+
+  Entry& entry = s_entries[filename];
+
+  uint64_t size;
+  int64_t mtime;
+  if (!stat_file(filename, size, mtime))
+  {
+    log_warning << "Problem getting name of '" << filename << "': file not found" << std::endl;
+    s_entries.erase(filename);
+    return Info();
+  }
+
+  if (entry.info.md5.empty() || entry.size != size || entry.mtime != mtime)
+  {
+    std::string content;
+    if (read_file(filename, content))
+    {
+      // touched but unchanged files only need the new timestamp
+      const std::string md5 = get_md5(content);
+      if (md5 != entry.info.md5) {
+        scan_level(filename, entry);
+        entry.info.md5 = md5;
+      }
+      entry.size = size;
+      entry.mtime = mtime;
+      s_dirty = true;
+    }
+    else
+    {
+      scan_level(filename, entry);
+    }
+  }
+
+  Info info = entry.info;
+  if (entry.translatable) {
+    register_translation_directory(filename);
+    info.name = _(info.name);
+  }
+  return info;
+}
+
+void
+save()
+{
+  if (!s_dirty)
+    return;
+
+  s_dirty = false;
+
+  if (!PHYSFS_exists(INDEX_DIRECTORY) && !PHYSFS_mkdir(INDEX_DIRECTORY))
+  {
+    log_warning << "couldn't create directory '" << INDEX_DIRECTORY << "': "
+                << PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()) << std::endl;
+    return;
+  }
+
+  try
+  {
+    Writer writer(INDEX_FILENAME);
+    writer.start_list("supertux-level-index");
+    for (const auto& it : s_entries)
+    {
+      const Entry& entry = it.second;
+      if (entry.info.md5.empty())
+        continue;
+
+      writer.start_list("level");
+      writer.write("file", it.first);
+      writer.write("size", std::to_string(entry.size));
+      writer.write("mtime", std::to_string(entry.mtime));
+      writer.write("md5", entry.info.md5);
+      writer.write("name", entry.info.name);
+      writer.write("translatable", entry.translatable);
+      writer.write("author", entry.info.author);
+      writer.write("sectors", entry.info.sector_count);
+      writer.end_list("level");
+    }
+    writer.end_list("supertux-level-index");
+  }
+  catch(const std::exception& e)
+  {
+    log_warning << "couldn't write level index: " << e.what() << std::endl;
+  }
+}
+
+} // namespace LevelIndex
+
+/* EOF */
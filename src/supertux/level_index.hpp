@@ -0,0 +1,50 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_LEVEL_INDEX_HPP
+#define HEADER_SUPERTUX_SUPERTUX_LEVEL_INDEX_HPP
+
+#include <string>
+
+/** Persistent index of level metadata in the userdir, so menus can
+    list hundreds of levels without parsing each of them. Entries are
+    keyed by path and refreshed when the size or modification time of
+    a level changes and its content hash doesn't match anymore. */
+namespace LevelIndex {
+
+struct Info
+{
+  Info() : name(), author(), sector_count(0), md5() {}
+
+  /** Translated name, empty if the file isn't a level */
+  std::string name;
+  std::string author;
+  int sector_count;
+  std::string md5;
+};
+
+/** Returns the metadata of filename, scanning the level if the index
+    has no up to date entry for it */
+Info get(const std::string& filename);
+
+/** Writes the index back to the userdir if get() changed it */
+void save();
+
+} // namespace LevelIndex
+
+#endif
+
+/* EOF */
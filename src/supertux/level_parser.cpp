@@ -19,38 +19,24 @@
 #include <physfs.h>
 #include <sstream>
 
+#include "object/tilemap.hpp"
 #include "supertux/level.hpp"
+#include "supertux/level_index.hpp"
+#include "supertux/load_stats.hpp"
 #include "supertux/sector.hpp"
 #include "supertux/sector_parser.hpp"
+#include "supertux/tile_manager.hpp"
+#include "supertux/tile_set.hpp"
 #include "util/log.hpp"
 #include "util/reader.hpp"
 #include "util/reader_document.hpp"
 #include "util/reader_mapping.hpp"
+#include "video/texture_manager.hpp"
 
 std::string
 LevelParser::get_level_name(const std::string& filename)
 {
-  try
-  {
-    register_translation_directory(filename);
-    auto doc = ReaderDocument::from_file(filename);
-    auto root = doc.get_root();
-
-    if (root.get_name() != "supertux-level") {
-      return "";
-    } else {
-      auto mapping = root.get_mapping();
-      std::string name;
-      mapping.get("name", name);
-      return name;
-    }
-  }
-  catch(const std::exception& e)
-  {
-    log_warning << "Problem getting name of '" << filename << "': "
-                << e.what() << std::endl;
-    return "";
-  }
+  return LevelIndex::get(filename).name;
 }
 
 std::unique_ptr<Level>
@@ -71,6 +57,16 @@ LevelParser::from_file(const std::string& filename, bool worldmap, bool editable
   return level;
 }
 
+std::unique_ptr<Level>
+LevelParser::from_document(const ReaderDocument& doc, bool worldmap, bool editable)
+{
+  auto level = std::make_unique<Level>(worldmap);
+  LevelParser parser(*level, worldmap, editable);
+  level->m_filename = doc.get_filename();
+  parser.load(doc);
+  return level;
+}
+
 std::unique_ptr<Level>
 LevelParser::from_nothing(const std::string& basedir)
 {
@@ -137,6 +133,10 @@ LevelParser::load(const std::string& filepath)
     auto doc = ReaderDocument::from_file(filepath);
     load(doc);
   } catch(std::exception& e) {
+    if (TextureManager::current()) {
+      TextureManager::current()->drop_prefetched();
+    }
+
     std::stringstream msg;
     msg << "Problem when reading level '" << filepath << "': " << e.what();
     throw std::runtime_error(msg.str());
@@ -151,6 +151,11 @@ LevelParser::load(const ReaderDocument& doc)
   if (root.get_name() != "supertux-level")
     throw std::runtime_error("file is not a supertux-level file.");
 
+  // decode the images while the objects get constructed
+  if (TextureManager::current()) {
+    TextureManager::current()->prefetch(doc.get_sexp(), "");
+  }
+
   auto level = root.get_mapping();
 
   int version = 1;
@@ -187,6 +192,24 @@ LevelParser::load(const ReaderDocument& doc)
   }
 
   m_level.m_stats.init(m_level);
+
+  // load the tiles the level uses now instead of while playing, the
+  // rest of the tileset is only loaded if something draws it
+  std::vector<uint32_t> tile_ids;
+  for (size_t i = 0; i < m_level.get_sector_count(); ++i) {
+    for (const auto& tilemap : m_level.get_sector(i)->get_objects_by_type<TileMap>()) {
+      tilemap.append_tile_ids(tile_ids);
+    }
+  }
+  if (!tile_ids.empty() && TextureManager::current()) {
+    LoadStats::Scope load_scope(LoadStats::TILESET);
+    TileManager::current()->get_tileset(m_level.get_tileset())->load_images(tile_ids);
+  }
+
+  // whatever wasn't used by now was a false positive
+  if (TextureManager::current()) {
+    TextureManager::current()->drop_prefetched();
+  }
 }
 
 void
@@ -29,6 +29,10 @@ class LevelParser final
 public:
   static std::unique_ptr<Level> from_stream(std::istream& stream, const std::string& context, bool worldmap, bool editable);
   static std::unique_ptr<Level> from_file(const std::string& filename, bool worldmap, bool editable);
+
+  /** Builds the level from an already parsed document, e.g. to
+      restart a level without reading and decoding the file again */
+  static std::unique_ptr<Level> from_document(const ReaderDocument& doc, bool worldmap, bool editable);
   static std::unique_ptr<Level> from_nothing(const std::string& basedir);
   static std::unique_ptr<Level> from_nothing_worldmap(const std::string& basedir, const std::string& name);
 
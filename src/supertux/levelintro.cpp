@@ -20,9 +20,11 @@
 #include "math/random.hpp"
 #include "sprite/sprite.hpp"
 #include "sprite/sprite_manager.hpp"
+#include "supertux/asset_manifest.hpp"
 #include "supertux/fadetoblack.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/level.hpp"
+#include "supertux/load_stats.hpp"
 #include "supertux/player_status.hpp"
 #include "supertux/resources.hpp"
 #include "supertux/screen_manager.hpp"
@@ -70,6 +72,11 @@ LevelIntro::setup()
 void
 LevelIntro::update(float dt_sec, const Controller& controller)
 {
+  // use the time the intro is shown to load what the level needs
+  if (auto manifest = AssetManifest::current()) {
+    manifest->preload_step();
+  }
+
   auto bonus_prefix = m_player_status.get_bonus_prefix();
   if (m_player_status.bonus == FIRE_BONUS && g_config->christmas_mode)
   {
@@ -112,6 +119,33 @@ void LevelIntro::draw_stats_line(DrawingContext& context, int& py, const std::st
   py += static_cast<int>(Resources::normal_font->get_height());
 }
 
+void
+LevelIntro::draw_load_stats(DrawingContext& context)
+{
+  const LoadStats::Report& report = g_load_stats.get_report();
+  if (report.level.empty())
+    return;
+
+  std::vector<std::string> lines;
+  lines.push_back(str(boost::format("load %.1f ms, %d objects, %d files, %d KiB decoded")
+                      % (static_cast<double>(report.total_ns) / 1000000.0)
+                      % report.objects % report.files
+                      % static_cast<int>(report.bytes_decoded / 1024)));
+  for (int i = 0; i < LoadStats::NUM_PHASES; ++i) {
+    lines.push_back(str(boost::format("%s %.1f ms") % LoadStats::get_name(static_cast<LoadStats::Phase>(i))
+                        % (static_cast<double>(report.phase_ns[i]) / 1000000.0)));
+  }
+  lines.push_back(str(boost::format("other %.1f ms") % (static_cast<double>(report.get_other_ns()) / 1000000.0)));
+
+  const float line_height = Resources::small_font->get_height();
+  float y = static_cast<float>(context.get_height()) - 16.0f - line_height * static_cast<float>(lines.size());
+  for (const auto& line : lines)
+  {
+    context.color().draw_text(Resources::small_font, line, Vector(16.0f, y), ALIGN_LEFT, LAYER_FOREGROUND1, s_stat_color);
+    y += line_height;
+  }
+}
+
 void
 LevelIntro::draw(Compositor& compositor)
 {
@@ -182,6 +216,10 @@ LevelIntro::draw(Compositor& compositor)
                       Statistics::time_to_string(m_level.m_target_time), targetTimeBeaten);
     }
   }
+
+  if (g_config->developer_mode) {
+    draw_load_stats(context);
+  }
 }
 
 /* EOF */
@@ -48,6 +48,9 @@ public:
 private:
   void draw_stats_line(DrawingContext& context, int& py, const std::string& name, const std::string& stat, bool isPerfect);
 
+  /** Shows how long loading the level took, in developer mode */
+  void draw_load_stats(DrawingContext& context);
+
 private:
   const Level& m_level; /**< The level of which this is the intro screen */
   const Statistics* m_best_level_statistics; /**< Best level statistics of the level of which is the intro screen */
@@ -28,12 +28,14 @@
 
 LevelsetScreen::LevelsetScreen(const std::string& basedir, const std::string& level_filename,
                                Savegame& savegame,
-                               const boost::optional<std::pair<std::string, Vector>>& start_pos) :
+                               const boost::optional<std::pair<std::string, Vector>>& start_pos,
+                               std::unique_ptr<ReaderDocument> level_document) :
   m_basedir(basedir),
   m_level_filename(level_filename),
   m_savegame(savegame),
   m_level_started(false),
   m_solved(false),
+  m_level_document(std::move(level_document)),
   m_start_pos(start_pos)
 {
   Levelset levelset(basedir);
@@ -84,7 +86,7 @@ LevelsetScreen::setup()
       ScreenManager::current()->pop_screen();
     } else {
       auto screen = std::make_unique<GameSession>(FileSystem::join(m_basedir, m_level_filename),
-                                                  m_savegame);
+                                                  m_savegame, nullptr, std::move(m_level_document));
       if (m_start_pos) {
         screen->set_start_pos(m_start_pos->first, m_start_pos->second);
         screen->restart_level();
@@ -23,6 +23,7 @@
 #include "math/vector.hpp"
 #include "supertux/screen.hpp"
 #include "util/currenton.hpp"
+#include "util/reader_document.hpp"
 
 class Savegame;
 
@@ -36,9 +37,13 @@ private:
   bool m_level_started;
   bool m_solved;
 
+  /** Handed to the GameSession, see GameManager::start_level() */
+  std::unique_ptr<ReaderDocument> m_level_document;
+
 public:
   LevelsetScreen(const std::string& basedir, const std::string& level_filename, Savegame& savegame,
-                 const boost::optional<std::pair<std::string, Vector>>& start_pos);
+                 const boost::optional<std::pair<std::string, Vector>>& start_pos,
+                 std::unique_ptr<ReaderDocument> level_document = {});
 
   virtual void draw(Compositor& compositor) override;
   virtual void update(float dt_sec, const Controller& controller) override;
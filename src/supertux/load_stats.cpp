@@ -0,0 +1,213 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "supertux/load_stats.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+
+#include "util/log.hpp"
+#include "util/profiler.hpp"
+
+LoadStats g_load_stats;
+
+const size_t LoadStats::NUM_RECENT_FILES;
+
+namespace {
+
+const int NO_PHASE = -1;
+
+double to_ms(uint64_t ns)
+{
+  return static_cast<double>(ns) / 1000000.0;
+}
+
+} // namespace
+
+uint64_t
+LoadStats::Report::get_other_ns() const
+{
+  uint64_t sum = 0;
+  for (const auto& ns : phase_ns) {
+    sum += ns;
+  }
+  return (sum < total_ns) ? total_ns - sum : 0;
+}
+
+LoadStats::Scope::Scope(Phase phase) :
+  m_active(g_load_stats.m_recording && std::this_thread::get_id() == g_load_stats.m_thread),
+  m_previous(NO_PHASE)
+{
+  if (!m_active)
+    return;
+
+  m_previous = g_load_stats.m_phase;
+  g_load_stats.switch_phase(phase);
+}
+
+LoadStats::Scope::~Scope()
+{
+  if (!m_active)
+    return;
+
+  g_load_stats.switch_phase(m_previous);
+}
+
+LoadStats::LoadStats() :
+  m_recording(false),
+  m_depth(0),
+  m_thread(),
+  m_level(),
+  m_start_ns(0),
+  m_phase(NO_PHASE),
+  m_phase_start_ns(0),
+  m_phase_ns(),
+  m_objects(0),
+  m_files(0),
+  m_bytes_decoded(0),
+  m_report(),
+  m_recent_mutex(),
+  m_recent_files(),
+  m_recent_count(0)
+{
+}
+
+void
+LoadStats::begin(const std::string& level)
+{
+  m_depth += 1;
+  if (m_depth > 1)
+    return;
+
+  m_thread = std::this_thread::get_id();
+  m_level = level;
+  m_start_ns = Profiler::get_time_ns();
+  m_phase = NO_PHASE;
+  m_phase_ns.fill(0);
+  m_objects = 0;
+  m_files = 0;
+  m_bytes_decoded = 0;
+  m_recording = true;
+}
+
+void
+LoadStats::end()
+{
+  if (m_depth == 0)
+    return;
+
+  m_depth -= 1;
+  if (m_depth > 0)
+    return;
+
+  switch_phase(NO_PHASE);
+  m_recording = false;
+
+  m_report.level = m_level;
+  m_report.total_ns = Profiler::get_time_ns() - m_start_ns;
+  m_report.phase_ns = m_phase_ns;
+  m_report.objects = m_objects;
+  m_report.files = m_files;
+  m_report.bytes_decoded = m_bytes_decoded;
+
+  log_info << "loading '" << m_report.level << "' took " << to_ms(m_report.total_ns) << " ms, "
+           << m_report.objects << " objects, " << m_report.files << " files, "
+           << m_report.bytes_decoded / 1024 << " KiB decoded" << std::endl;
+  for (int i = 0; i < NUM_PHASES; ++i) {
+    log_debug << "  " << get_name(static_cast<Phase>(i)) << ": " << to_ms(m_report.phase_ns[i]) << " ms" << std::endl;
+  }
+}
+
+void
+LoadStats::add_file(const std::string& filename)
+{
+  if (m_recording) {
+    m_files += 1;
+  }
+
+  const uint64_t now = Profiler::get_time_ns();
+  std::lock_guard<std::mutex> lock(m_recent_mutex);
+  RecentFile& file = m_recent_files[m_recent_count % NUM_RECENT_FILES];
+  file.filename = filename;
+  file.time_ns = now;
+  m_recent_count += 1;
+}
+
+std::vector<LoadStats::RecentFile>
+LoadStats::get_recent_files(uint64_t since_ns) const
+{
+  std::lock_guard<std::mutex> lock(m_recent_mutex);
+
+  std::vector<RecentFile> files;
+  const size_t count = std::min(m_recent_count, NUM_RECENT_FILES);
+  for (size_t i = m_recent_count - count; i < m_recent_count; ++i)
+  {
+    const RecentFile& file = m_recent_files[i % NUM_RECENT_FILES];
+    if (file.time_ns >= since_ns) {
+      files.push_back(file);
+    }
+  }
+  return files;
+}
+
+void
+LoadStats::switch_phase(int phase)
+{
+  const uint64_t now = Profiler::get_time_ns();
+  if (m_phase != NO_PHASE) {
+    m_phase_ns[m_phase] += now - m_phase_start_ns;
+  }
+  m_phase = phase;
+  m_phase_start_ns = now;
+}
+
+void
+LoadStats::write_report(std::ostream& out) const
+{
+  char line[128];
+
+  snprintf(line, sizeof(line), "%-12s %10.2f ms\n", "total", to_ms(m_report.total_ns));
+  out << m_report.level << '\n' << line;
+  for (int i = 0; i < NUM_PHASES; ++i) {
+    snprintf(line, sizeof(line), "%-12s %10.2f ms\n", get_name(static_cast<Phase>(i)), to_ms(m_report.phase_ns[i]));
+    out << line;
+  }
+  snprintf(line, sizeof(line), "%-12s %10.2f ms\n", "other", to_ms(m_report.get_other_ns()));
+  out << line;
+
+  out << "objects created: " << m_report.objects << '\n'
+      << "files read:      " << m_report.files << '\n'
+      << "bytes decoded:   " << m_report.bytes_decoded << '\n';
+}
+
+const char*
+LoadStats::get_name(Phase phase)
+{
+  switch (phase)
+  {
+    case READ: return "read";
+    case SECTORS: return "sectors";
+    case OBJECTS: return "objects";
+    case TILESET: return "tileset";
+    case TEXTURES: return "textures";
+    case SPRITES: return "sprites";
+    case FINISH: return "finish";
+    case SCRIPTS: return "scripts";
+    default: return "unknown";
+  }
+}
+
+/* EOF */
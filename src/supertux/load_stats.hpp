@@ -0,0 +1,158 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_LOAD_STATS_HPP
+#define HEADER_SUPERTUX_SUPERTUX_LOAD_STATS_HPP
+
+#include <array>
+#include <atomic>
+#include <mutex>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+/** Breaks the time it takes to load a level down into phases and
+    counts the objects, files and decoded bytes on the way. Phases
+    nest, an outer phase doesn't count the time of inner ones, and
+    only the thread that started the load is timed. Counters are
+    taken from every thread. The most recently opened files are
+    remembered at all times, to tell what caused a hitch. */
+class LoadStats final
+{
+public:
+  static const size_t NUM_RECENT_FILES = 32;
+
+  enum Phase {
+    READ,
+    SECTORS,
+    OBJECTS,
+    TILESET,
+    TEXTURES,
+    SPRITES,
+    FINISH,
+    SCRIPTS,
+    NUM_PHASES
+  };
+
+  struct Report
+  {
+    Report() : level(), total_ns(0), phase_ns(), objects(0), files(0), bytes_decoded(0) {}
+
+    std::string level;
+    uint64_t total_ns;
+    std::array<uint64_t, NUM_PHASES> phase_ns;
+    int objects;
+    int files;
+    uint64_t bytes_decoded;
+
+    /** Time that wasn't spent in any of the phases */
+    uint64_t get_other_ns() const;
+  };
+
+  struct RecentFile
+  {
+    RecentFile() : filename(), time_ns(0) {}
+
+    std::string filename;
+
+    /** Profiler::get_time_ns() when the file was opened */
+    uint64_t time_ns;
+  };
+
+  /** Times the enclosed code as the given phase while a load is
+      recorded */
+  class Scope final
+  {
+  public:
+    Scope(Phase phase);
+    ~Scope();
+
+  private:
+    bool m_active;
+    int m_previous;
+
+  private:
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+public:
+  LoadStats();
+
+  /** Starts recording the load of level, recording already in
+      progress just continues */
+  void begin(const std::string& level);
+
+  /** Finishes the recording started by the matching begin() and logs
+      the report */
+  void end();
+
+  bool is_recording() const { return m_recording; }
+
+  void add_object() { if (m_recording) m_objects += 1; }
+  /** Remembers filename as opened just now, can be called from any
+      thread */
+  void add_file(const std::string& filename);
+  void add_bytes_decoded(uint64_t bytes) { if (m_recording) m_bytes_decoded += bytes; }
+
+  /** The last finished load, level is empty if there was none */
+  const Report& get_report() const { return m_report; }
+
+  /** Writes the last report, one phase per line */
+  void write_report(std::ostream& out) const;
+
+  /** Files opened at or after since_ns, oldest first */
+  std::vector<RecentFile> get_recent_files(uint64_t since_ns) const;
+
+  static const char* get_name(Phase phase);
+
+private:
+  void switch_phase(int phase);
+
+private:
+  std::atomic<bool> m_recording;
+  int m_depth;
+  std::thread::id m_thread;
+  std::string m_level;
+  uint64_t m_start_ns;
+
+  /** -1 outside of any phase */
+  int m_phase;
+  uint64_t m_phase_start_ns;
+  std::array<uint64_t, NUM_PHASES> m_phase_ns;
+
+  std::atomic<int> m_objects;
+  std::atomic<int> m_files;
+  std::atomic<uint64_t> m_bytes_decoded;
+
+  Report m_report;
+
+  mutable std::mutex m_recent_mutex;
+  std::array<RecentFile, NUM_RECENT_FILES> m_recent_files;
+  size_t m_recent_count;
+
+private:
+  LoadStats(const LoadStats&) = delete;
+  LoadStats& operator=(const LoadStats&) = delete;
+};
+
+extern LoadStats g_load_stats;
+
+#endif
+
+/* EOF */
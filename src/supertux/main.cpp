@@ -18,6 +18,7 @@
 
 #include <config.h>
 #include <version.h>
+#include <algorithm>
 #include <fstream>
 
 #include <SDL_image.h>
@@ -25,6 +26,9 @@
 #include <boost/filesystem.hpp>
 #include <boost/locale.hpp>
 #include <physfs.h>
+#include <sexp/parser.hpp>
+#include <sstream>
+#include <thread>
 #include <tinygettext/log.hpp>
 extern "C" {
 #include <findlocale.h>
@@ -48,16 +52,21 @@ extern "C" {
 #include "object/spawnpoint.hpp"
 #include "physfs/physfs_file_system.hpp"
 #include "physfs/physfs_sdl.hpp"
+#include "physfs/util.hpp"
 #include "sprite/sprite_data.hpp"
 #include "sprite/sprite_manager.hpp"
 #include "supertux/command_line_arguments.hpp"
 #include "supertux/console.hpp"
+#include "supertux/demo_replayer.hpp"
 #include "supertux/game_manager.hpp"
 #include "supertux/game_session.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/globals.hpp"
 #include "supertux/level.hpp"
+#include "supertux/level_generator.hpp"
 #include "supertux/level_parser.hpp"
+#include "supertux/load_stats.hpp"
+#include "supertux/resave_rules.hpp"
 #include "supertux/player_status.hpp"
 #include "supertux/resources.hpp"
 #include "supertux/savegame.hpp"
@@ -68,9 +77,16 @@ extern "C" {
 #include "supertux/tile_manager.hpp"
 #include "supertux/title_screen.hpp"
 #include "supertux/world.hpp"
+#include "util/binary_document.hpp"
 #include "util/file_system.hpp"
 #include "util/gettext.hpp"
+#include "util/job_system.hpp"
+#include "util/log_sink.hpp"
+#include "util/profiler.hpp"
+#include "util/reader_document.hpp"
+#include "util/sexp_cache.hpp"
 #include "util/string_util.hpp"
+#include "util/task_graph.hpp"
 #include "util/timelog.hpp"
 #include "util/string_util.hpp"
 #include "video/sdl_surface.hpp"
@@ -104,7 +120,9 @@ public:
 
   ~ConfigSubsystem()
   {
-    if (g_config)
+    // demo benchmarks run with the null video system and often many
+    // at once, none of that belongs into the user's config
+    if (g_config && !g_config->benchmark_demo)
     {
       try
       {
@@ -147,6 +165,8 @@ Main::init_tinygettext()
     FL_FreeLocale(&locale);
     g_dictionary_manager->set_language(language);
   }
+
+  invalidate_translations();
 }
 
 class PhysfsSubsystem final
@@ -175,6 +195,7 @@ public:
 
       find_userdir();
       find_datadir();
+      physfsutil::invalidate_cache();
     }
   }
 
@@ -370,71 +391,389 @@ Main::init_video()
            << " Area: "       << g_config->aspect_size << std::endl;
 }
 
-void
-Main::resave(const std::string& input_filename, const std::string& output_filename)
+/** Returns the given levels, directories are replaced by all levels
+    found in them, sorted by name */
+static std::vector<std::string>
+find_levels(const std::vector<std::string>& filenames)
 {
-  Editor::s_resaving_in_progress = true;
-  std::ifstream in(input_filename);
+  std::vector<std::string> levels;
+  for (const auto& filename : filenames)
+  {
+    if (boost::filesystem::is_directory(filename))
+    {
+      std::vector<std::string> found;
+      for (const auto& entry : boost::filesystem::recursive_directory_iterator(filename))
+      {
+        const std::string path = entry.path().string();
+        if (StringUtil::has_suffix(path, ".stl") || StringUtil::has_suffix(path, ".stwm")) {
+          found.push_back(path);
+        }
+      }
+      std::sort(found.begin(), found.end());
+      levels.insert(levels.end(), found.begin(), found.end());
+    }
+    else
+    {
+      levels.push_back(filename);
+    }
+  }
+  return levels;
+}
+
+/** Reads and parses a text or binary level, doesn't touch any game
+    state, so it's safe to call from a JobSystem job. Returns the
+    number of substitutions the rules made. */
+static size_t
+read_level_document(const std::string& filename, const ResaveRules& rules,
+                    std::unique_ptr<ReaderDocument>& doc)
+{
+  std::ifstream in(filename, std::ios::binary);
   if (!in) {
-    log_fatal << input_filename << ": couldn't open file for reading" << std::endl;
-  } else {
-    log_info << "loading level: " << input_filename << std::endl;
-    auto level = LevelParser::from_stream(in, input_filename, StringUtil::has_suffix(input_filename, ".stwm"), true);
-    in.close();
-
-    std::ofstream out(output_filename);
-    if (!out) {
-      log_fatal << output_filename << ": couldn't open file for writing" << std::endl;
-    } else {
-      log_info << "saving level: " << output_filename << std::endl;
-      level->save(out);
+    throw std::runtime_error("couldn't open file for reading");
+  }
+  const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+  if (BinaryDocument::is_binary(content))
+  {
+    if (!rules.empty()) {
+      throw std::runtime_error("resave rules can't be applied to binary levels");
     }
+    doc = std::make_unique<ReaderDocument>(ReaderDocument::from_binary(filename, content));
+    return 0;
+  }
+  else
+  {
+    std::istringstream stream(content);
+    sexp::Value sx = sexp::Parser::from_stream(stream, sexp::Parser::USE_ARRAYS);
+    const size_t changes = rules.apply(sx);
+    doc = std::make_unique<ReaderDocument>(filename, std::move(sx));
+    return changes;
   }
-  Editor::s_resaving_in_progress = false;
 }
 
 void
-Main::launch_game(const CommandLineArguments& args)
+Main::resave(const std::vector<std::string>& filenames, const std::string& rules_filename, bool binary)
 {
-  SDLSubsystem sdl_subsystem;
-  ConsoleBuffer console_buffer;
+  ResaveRules rules;
+  if (!rules_filename.empty()) {
+    rules = ResaveRules::from_file(rules_filename);
+  }
+
+  const std::vector<std::string> levels = find_levels(filenames);
+
+  // Reading, parsing and the rules don't touch any game state and run
+  // on the JobSystem, creating the GameObjects and saving them has to
+  // happen on the main thread. Only a few levels are parsed ahead, so
+  // a large batch doesn't have to fit into memory at once.
+  struct Item
+  {
+    std::unique_ptr<ReaderDocument> doc;
+    size_t changes = 0;
+    std::string error;
+  };
+
+  std::vector<Item> items(levels.size());
+  std::vector<JobSystem::Handle> jobs(levels.size());
+  const size_t parse_ahead = 2 * static_cast<size_t>(JobSystem::get_default_size()) + 1;
+
+  auto parse = [&levels, &items, &rules](size_t i)
+  {
+    Item& item = items[i];
+    try
+    {
+      item.changes = read_level_document(levels[i], rules, item.doc);
+    }
+    catch(const std::exception& err)
+    {
+      item.error = err.what();
+    }
+  };
 
-  s_timelog.log("controller");
-  InputManager input_manager(g_config->keyboard_config, g_config->joystick_config);
+  size_t scheduled = 0;
+  size_t failed = 0;
+  for (size_t i = 0; i < levels.size(); ++i)
+  {
+    for (; scheduled < levels.size() && scheduled < i + parse_ahead; ++scheduled) {
+      jobs[scheduled] = JobSystem::current()->schedule([&parse, scheduled]{ parse(scheduled); });
+    }
+    JobSystem::current()->wait(jobs[i]);
+
+    Item& item = items[i];
+    const std::string& filename = levels[i];
+    if (!item.error.empty())
+    {
+      log_warning << filename << ": " << item.error << std::endl;
+      failed += 1;
+      continue;
+    }
+
+    log_info << "loading level: " << filename
+             << (rules.empty() ? "" : " (" + std::to_string(item.changes) + " substitutions)") << std::endl;
+
+    const std::string dir = FileSystem::dirname(filename);
+    PHYSFS_mount(dir.c_str(), nullptr, true);
+    physfsutil::invalidate_cache();
+
+    Editor::s_resaving_in_progress = true;
+    try
+    {
+      const bool worldmap = StringUtil::has_suffix(filename, ".stwm");
+      auto level = LevelParser::from_document(*item.doc, worldmap, true);
+      item.doc.reset();
+
+      std::ofstream out(filename, std::ios::binary);
+      if (!out) {
+        throw std::runtime_error("couldn't open file for writing");
+      } else if (binary) {
+        log_info << "saving binary level: " << filename << std::endl;
+        std::stringstream text;
+        level->save(text);
+        out << BinaryDocument::encode(sexp::Parser::from_stream(text, sexp::Parser::USE_ARRAYS));
+      } else {
+        log_info << "saving level: " << filename << std::endl;
+        level->save(out);
+      }
+    }
+    catch(const std::exception& err)
+    {
+      log_warning << filename << ": " << err.what() << std::endl;
+      failed += 1;
+    }
+    Editor::s_resaving_in_progress = false;
+  }
+
+  if (levels.size() > 1) {
+    log_info << "resaved " << (levels.size() - failed) << " of " << levels.size() << " levels" << std::endl;
+  }
+}
 
-  s_timelog.log("commandline");
+void
+Main::validate_levels(const std::vector<std::string>& filenames)
+{
+  const std::vector<std::string> levels = find_levels(filenames);
+
+  // Same split as in resave(): the files are read and parsed on the
+  // JobSystem, constructing the sectors needs the main thread
+  struct Item
+  {
+    std::unique_ptr<ReaderDocument> doc;
+    uint64_t parse_ns = 0;
+    std::string error;
+  };
+
+  std::vector<Item> items(levels.size());
+  std::vector<JobSystem::Handle> jobs(levels.size());
+  const size_t parse_ahead = 2 * static_cast<size_t>(JobSystem::get_default_size()) + 1;
+  const ResaveRules no_rules;
+
+  auto parse = [&levels, &items, &no_rules](size_t i)
+  {
+    Item& item = items[i];
+    const uint64_t start_ns = Profiler::get_time_ns();
+    try
+    {
+      read_level_document(levels[i], no_rules, item.doc);
+    }
+    catch(const std::exception& err)
+    {
+      item.error = err.what();
+    }
+    item.parse_ns = Profiler::get_time_ns() - start_ns;
+  };
+
+  auto to_ms = [](uint64_t ns) { return static_cast<double>(ns) / 1.0e6; };
+
+  std::cout << "level,status,parse_ms,load_ms,objects,files,decoded_kib" << std::endl;
+
+  size_t scheduled = 0;
+  size_t failed = 0;
+  for (size_t i = 0; i < levels.size(); ++i)
+  {
+    for (; scheduled < levels.size() && scheduled < i + parse_ahead; ++scheduled) {
+      jobs[scheduled] = JobSystem::current()->schedule([&parse, scheduled]{ parse(scheduled); });
+    }
+    JobSystem::current()->wait(jobs[i]);
+
+    Item& item = items[i];
+    const std::string& filename = levels[i];
+    if (item.error.empty())
+    {
+      const std::string dir = FileSystem::dirname(filename);
+      PHYSFS_mount(dir.c_str(), nullptr, true);
+      physfsutil::invalidate_cache();
+
+      g_load_stats.begin(filename);
+      try
+      {
+        const bool worldmap = StringUtil::has_suffix(filename, ".stwm");
+        LevelParser::from_document(*item.doc, worldmap, false);
+      }
+      catch(const std::exception& err)
+      {
+        item.error = err.what();
+      }
+      g_load_stats.end();
+      item.doc.reset();
+    }
+
+    const LoadStats::Report& report = g_load_stats.get_report();
+    if (!item.error.empty())
+    {
+      log_warning << filename << ": " << item.error << std::endl;
+      std::cout << filename << ",failed," << to_ms(item.parse_ns) << ",,,," << std::endl;
+      failed += 1;
+    }
+    else
+    {
+      std::cout << filename << ",ok," << to_ms(item.parse_ns) << ","
+                << to_ms(report.total_ns) << "," << report.objects << ","
+                << report.files << "," << report.bytes_decoded / 1024 << std::endl;
+    }
+  }
+
+  log_info << (levels.size() - failed) << " of " << levels.size() << " levels loaded" << std::endl;
+  if (failed > 0) {
+    throw std::runtime_error(std::to_string(failed) + " levels failed to load");
+  }
+}
+
+void
+Main::replay_demos(const std::string& executable, const CommandLineArguments& args)
+{
+  // the processes share the data and user directories with this one
+  std::vector<std::string> child_args;
+  if (args.datadir) {
+    child_args.push_back("--datadir");
+    child_args.push_back(*args.datadir);
+  }
+  if (args.userdir) {
+    child_args.push_back("--userdir");
+    child_args.push_back(*args.userdir);
+  }
+
+  const int jobs = args.replay_jobs.get_value_or(static_cast<int>(std::thread::hardware_concurrency()));
+  DemoReplayer replayer(executable, child_args, jobs);
+  replayer.run(*args.replay_demos);
+}
+
+/** Mounts the directory of a level given on the command line, which
+    is a normal path and not a physfs one, returns the filename */
+static std::string
+mount_start_level(const std::string& start_level)
+{
+  std::string dir = FileSystem::dirname(start_level);
+  const std::string filename = FileSystem::basename(start_level);
+  const std::string fileProtocol = "file://";
+  const std::string::size_type position = dir.find(fileProtocol);
+  if (position != std::string::npos) {
+    dir = dir.replace(position, fileProtocol.length(), "");
+  }
+  log_debug << "Adding dir: " << dir << std::endl;
+  PHYSFS_mount(dir.c_str(), nullptr, true);
+  physfsutil::invalidate_cache();
+  return filename;
+}
+
+void
+Main::profile_load(const std::string& filename, Savegame& savegame)
+{
+  const std::string level = mount_start_level(filename);
+
+  GameSession session(level, savegame);
+  g_load_stats.write_report(std::cout);
+}
+
+void
+Main::generate_level(const std::string& filename, const std::string& params)
+{
+  auto level = LevelGenerator::generate(LevelGenerator::parse_params(params));
+
+  std::ofstream out(filename, std::ios::binary);
+  if (!out) {
+    throw std::runtime_error("Couldn't open '" + filename + "' for writing");
+  }
+  log_info << "saving generated level: " << filename << std::endl;
+  level->save(out);
+}
+
+void
+Main::launch_game(const CommandLineArguments& args)
+{
+  ConsoleBuffer console_buffer;
 
   auto video = g_config->video;
-  if (args.resave && *args.resave) {
+  if ((args.resave && *args.resave) || (args.validate_levels && *args.validate_levels) ||
+      args.generate_level) {
     if (args.video) {
       video = *args.video;
     } else {
       video = VideoSystem::VIDEO_NULL;
     }
   }
-  s_timelog.log("video");
-  std::unique_ptr<VideoSystem> video_system = VideoSystem::create(video);
-  init_video();
-
-  TTFSurfaceManager ttf_surface_manager;
-
-  s_timelog.log("audio");
-  SoundManager sound_manager;
-  sound_manager.enable_sound(g_config->sound_enabled);
-  sound_manager.enable_music(g_config->music_enabled);
-  sound_manager.set_sound_volume(g_config->sound_volume);
-  sound_manager.set_music_volume(g_config->music_volume);
-
-  s_timelog.log("scripting");
-  SquirrelVirtualMachine scripting(g_config->enable_script_debugger);
-
-  s_timelog.log("resources");
-  TileManager tile_manager;
-  SpriteManager sprite_manager;
-  Resources resources;
 
-  s_timelog.log("addons");
-  AddonManager addon_manager("addons", g_config->addons);
+  // declared in the order they have to be destroyed in
+  JobSystem job_system(JobSystem::get_default_size());
+  std::unique_ptr<SDLSubsystem> sdl_subsystem;
+  std::unique_ptr<InputManager> input_manager;
+  std::unique_ptr<VideoSystem> video_system;
+  std::unique_ptr<TTFSurfaceManager> ttf_surface_manager;
+  std::unique_ptr<SoundManager> sound_manager;
+  std::unique_ptr<SquirrelVirtualMachine> scripting;
+  std::unique_ptr<TileManager> tile_manager;
+  std::unique_ptr<SpriteManager> sprite_manager;
+  std::unique_ptr<Resources> resources;
+  std::unique_ptr<AddonManager> addon_manager;
+
+  s_timelog.log("startup");
+  {
+    // SDL video and everything creating textures has to stay on the
+    // main thread, OpenAL, Squirrel and the addon scan don't care
+    TaskGraph startup;
+
+    startup.add_main_task("sdl", {}, [&sdl_subsystem]{
+        sdl_subsystem = std::make_unique<SDLSubsystem>();
+      });
+
+    startup.add_main_task("controller", {"sdl"}, [&input_manager]{
+        input_manager = std::make_unique<InputManager>(g_config->keyboard_config, g_config->joystick_config);
+      });
+
+    startup.add_main_task("video", {"sdl"}, [this, &video_system, &ttf_surface_manager, video]{
+        video_system = VideoSystem::create(video);
+        init_video();
+        ttf_surface_manager = std::make_unique<TTFSurfaceManager>();
+      });
+
+    startup.add_task("audio", {}, [&sound_manager]{
+        sound_manager = std::make_unique<SoundManager>();
+        sound_manager->enable_sound(g_config->sound_enabled);
+        sound_manager->enable_music(g_config->music_enabled);
+        sound_manager->set_sound_volume(g_config->sound_volume);
+        sound_manager->set_music_volume(g_config->music_volume);
+      });
+
+    startup.add_task("scripting", {}, [&scripting]{
+        scripting = std::make_unique<SquirrelVirtualMachine>(g_config->enable_script_debugger);
+      });
+
+    startup.add_main_task("resources", {"video"}, [&tile_manager, &sprite_manager, &resources]{
+        tile_manager = std::make_unique<TileManager>();
+        sprite_manager = std::make_unique<SpriteManager>();
+        resources = std::make_unique<Resources>();
+      });
+
+    // addons are appended to the search path, so files of the base
+    // game still win no matter when resources are looked up
+    startup.add_task("addons", {}, [&addon_manager]{
+        addon_manager = std::make_unique<AddonManager>("addons", g_config->addons);
+      });
+
+    startup.run(job_system);
+
+    if (args.startup_profile && *args.startup_profile) {
+      startup.print_profile(std::cout);
+    }
+  }
 
   Console console(console_buffer);
 
@@ -443,29 +782,35 @@ Main::launch_game(const CommandLineArguments& args)
   const auto default_savegame = std::make_unique<Savegame>(std::string());
 
   GameManager game_manager;
-  ScreenManager screen_manager(*video_system, input_manager);
+  ScreenManager screen_manager(*video_system, *input_manager);
 
-  if (!args.filenames.empty())
+  if (args.resave && *args.resave)
+  {
+    resave(args.filenames, args.resave_rules.get_value_or(""),
+           args.resave_binary && *args.resave_binary);
+  }
+  else if (args.validate_levels && *args.validate_levels)
+  {
+    validate_levels(args.filenames);
+  }
+  else if (args.profile_load && *args.profile_load)
+  {
+    profile_load(args.filenames.front(), *default_savegame);
+  }
+  else if (args.generate_level)
+  {
+    if (args.filenames.empty()) {
+      throw std::runtime_error("Need to specify a filename for the generated level");
+    }
+    generate_level(args.filenames.front(), *args.generate_level);
+  }
+  else if (!args.filenames.empty())
   {
     for(const auto& start_level : args.filenames)
     {
-      // we have a normal path specified at commandline, not a physfs path.
-      // So we simply mount that path here...
-      std::string dir = FileSystem::dirname(start_level);
-      const std::string filename = FileSystem::basename(start_level);
-      const std::string fileProtocol = "file://";
-      const std::string::size_type position = dir.find(fileProtocol);
-      if (position != std::string::npos) {
-        dir = dir.replace(position, fileProtocol.length(), "");
-      }
-      log_debug << "Adding dir: " << dir << std::endl;
-      PHYSFS_mount(dir.c_str(), nullptr, true);
+      const std::string filename = mount_start_level(start_level);
 
-      if (args.resave && *args.resave)
-      {
-        resave(start_level, start_level);
-      }
-      else if (args.editor)
+      if (args.editor)
       {
         if (PHYSFS_exists(start_level.c_str())) {
           auto editor = std::make_unique<Editor>();
@@ -474,7 +819,7 @@ Main::launch_game(const CommandLineArguments& args)
           editor->update(0, Controller());
           screen_manager.push_screen(std::move(editor));
           MenuManager::instance().clear_menu_stack();
-          sound_manager.stop_music(0.5);
+          sound_manager->stop_music(0.5);
         } else {
           log_warning << "Level " << start_level << " doesn't exist." << std::endl;
         }
@@ -514,8 +859,10 @@ Main::launch_game(const CommandLineArguments& args)
         if (!g_config->start_demo.empty())
           session->play_demo(g_config->start_demo);
 
-        if (!g_config->record_demo.empty())
+        if (!g_config->record_demo.empty()) {
           session->record_demo(g_config->record_demo);
+          DemoReplayer::write_level_filename(g_config->record_demo, start_level);
+        }
         screen_manager.push_screen(std::move(session));
       }
     }
@@ -560,6 +907,9 @@ Main::run(int argc, char** argv)
   // Make boost.filesystem use it
   boost::filesystem::path::imbue(std::locale());
 
+  // writes everything still queued when run() returns
+  LogSink log_sink(std::cerr);
+
   int result = 0;
 
   try
@@ -584,6 +934,12 @@ Main::run(int argc, char** argv)
     ConfigSubsystem config_subsystem;
     args.merge_into(*g_config);
 
+    // --replay-demos runs many demo benchmarks at once, all of them
+    // writing the same cache entries would clobber each other
+    if (g_config->benchmark_demo) {
+      SExpCache::set_read_only(true);
+    }
+
     s_timelog.log("tinygettext");
     init_tinygettext();
 
@@ -602,7 +958,11 @@ Main::run(int argc, char** argv)
         return 0;
 
       default:
-        launch_game(args);
+        if (args.replay_demos) {
+          replay_demos(argv[0], args);
+        } else {
+          launch_game(args);
+        }
         break;
     }
   }
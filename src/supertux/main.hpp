@@ -18,8 +18,10 @@
 #define HEADER_SUPERTUX_SUPERTUX_MAIN_HPP
 
 #include <string>
+#include <vector>
 
 class CommandLineArguments;
+class Savegame;
 
 class Main final
 {
@@ -35,7 +37,26 @@ private:
   void init_video();
 
   void launch_game(const CommandLineArguments& args);
-  void resave(const std::string& input_filename, const std::string& output_filename);
+  /** Loads and saves the given levels and all levels in the given
+      directories, applying the rules in rules_filename if not empty */
+  void resave(const std::vector<std::string>& filenames, const std::string& rules_filename, bool binary);
+
+  /** Loads the given levels and all levels in the given directories
+      without saving them, prints the load time and size of each as
+      CSV and throws if any of them failed */
+  void validate_levels(const std::vector<std::string>& filenames);
+
+  /** Loads the given level the same way playing it would, prints how
+      long each phase of the load took and returns */
+  void profile_load(const std::string& filename, Savegame& savegame);
+
+  /** Writes a LevelGenerator level with the given parameters to
+      filename, a normal path and not a physfs one */
+  void generate_level(const std::string& filename, const std::string& params);
+
+  /** Runs 'executable --benchmark-demo' for every demo in the
+      --replay-demos directory and throws if any failed or diverged */
+  void replay_demos(const std::string& executable, const CommandLineArguments& args);
 
 private:
   Main(const Main&) = delete;
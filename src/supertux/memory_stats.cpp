@@ -0,0 +1,119 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "supertux/memory_stats.hpp"
+
+#include <stdio.h>
+
+#include "audio/sound_manager.hpp"
+#include "editor/editor.hpp"
+#include "editor/undo_manager.hpp"
+#include "sprite/sprite_manager.hpp"
+#include "squirrel/squirrel_memory.hpp"
+#include "supertux/level.hpp"
+#include "supertux/sector.hpp"
+#include "supertux/tile_manager.hpp"
+#include "video/compositor.hpp"
+#include "video/texture_manager.hpp"
+
+const size_t MemoryStats::NO_BYTES;
+
+std::vector<MemoryStats::Entry>
+MemoryStats::collect()
+{
+  std::vector<Entry> entries;
+
+  if (auto texture_manager = TextureManager::current())
+  {
+    entries.emplace_back("textures", texture_manager->get_texture_bytes(),
+                         texture_manager->get_texture_count(), "textures");
+    entries.emplace_back("image cache", texture_manager->get_surface_bytes(),
+                         texture_manager->get_surface_count(), "images");
+  }
+
+  if (auto sound_manager = SoundManager::current())
+  {
+    entries.emplace_back("sound buffers", sound_manager->get_buffer_bytes(),
+                         sound_manager->get_buffer_count(), "sounds");
+  }
+
+  if (auto sprite_manager = SpriteManager::current())
+  {
+    entries.emplace_back("sprites", sprite_manager->get_memory_usage(),
+                         sprite_manager->get_sprite_count(), "sprites");
+  }
+
+  if (auto tile_manager = TileManager::current())
+  {
+    entries.emplace_back("tilesets", tile_manager->get_memory_usage(),
+                         tile_manager->get_tileset_count(), "tilesets");
+    entries.emplace_back("tilesets (unused)", tile_manager->get_unused_memory_usage(),
+                         tile_manager->get_evicted_count(), "evicted");
+  }
+
+  if (SquirrelMemory::is_available())
+  {
+    entries.emplace_back("squirrel heap", SquirrelMemory::get_bytes(),
+                         SquirrelMemory::get_peak_bytes() / 1024, "KiB peak");
+  }
+
+  if (Editor::is_active() && Editor::current()->get_undo_manager())
+  {
+    entries.emplace_back("undo history", Editor::current()->get_undo_manager()->get_memory_usage(), 0, "");
+  }
+
+  entries.emplace_back("draw requests (peak)", Compositor::get_obstack_high_water(), 0, "");
+  entries.emplace_back("draw request arena", Compositor::get_arena_capacity(), 0, "");
+
+  if (auto sector = Sector::current())
+  {
+    const Level& level = sector->get_level();
+    for (size_t i = 0; i < level.get_sector_count(); ++i)
+    {
+      const Sector* level_sector = level.get_sector(i);
+      entries.emplace_back("sector " + level_sector->get_name(), NO_BYTES,
+                           level_sector->get_objects().size(), "objects");
+    }
+  }
+
+  return entries;
+}
+
+void
+MemoryStats::write_report(std::ostream& out)
+{
+  char line[160];
+  size_t total = 0;
+  for (const auto& entry : collect())
+  {
+    if (entry.bytes == NO_BYTES) {
+      snprintf(line, sizeof(line), "%-24s %13s", entry.name.c_str(), "");
+    } else {
+      total += entry.bytes;
+      snprintf(line, sizeof(line), "%-24s %9zu KiB", entry.name.c_str(), entry.bytes / 1024);
+    }
+    out << line;
+    if (!entry.unit.empty()) {
+      out << "  " << entry.count << ' ' << entry.unit;
+    }
+    out << '\n';
+  }
+
+  snprintf(line, sizeof(line), "%-24s %9zu KiB\n", "total", total / 1024);
+  out << line;
+}
+
+/* EOF */
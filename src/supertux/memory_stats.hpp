@@ -0,0 +1,60 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_MEMORY_STATS_HPP
+#define HEADER_SUPERTUX_SUPERTUX_MEMORY_STATS_HPP
+
+#include <ostream>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+/** Live memory by subsystem, collected from whatever managers exist
+    at the time of the call. GPU and audio buffers are exact, the
+    CPU side of sprites and tiles is estimated from the sizes of
+    their members. */
+class MemoryStats final
+{
+public:
+  /** bytes of entries that only have a count */
+  static const size_t NO_BYTES = static_cast<size_t>(-1);
+
+  struct Entry
+  {
+    Entry(const std::string& name_, size_t bytes_, size_t count_, const std::string& unit_) :
+      name(name_), bytes(bytes_), count(count_), unit(unit_) {}
+
+    std::string name;
+    size_t bytes;
+    size_t count;
+
+    /** What count counts, e.g. "textures" */
+    std::string unit;
+  };
+
+public:
+  static std::vector<Entry> collect();
+
+  /** Writes one line per entry */
+  static void write_report(std::ostream& out);
+
+private:
+  MemoryStats() = delete;
+};
+
+#endif
+
+/* EOF */
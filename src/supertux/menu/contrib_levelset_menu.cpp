@@ -22,6 +22,7 @@
 #include "audio/sound_manager.hpp"
 #include "gui/item_action.hpp"
 #include "supertux/game_manager.hpp"
+#include "supertux/level_index.hpp"
 #include "supertux/level_parser.hpp"
 #include "supertux/levelset.hpp"
 #include "supertux/player_status.hpp"
@@ -62,6 +63,7 @@ ContribLevelsetMenu::ContribLevelsetMenu(std::unique_ptr<World> world) :
     }
     add_entry(i, out.str());
   }
+  LevelIndex::save();
 
   add_hl();
   add_back(_("Back"));
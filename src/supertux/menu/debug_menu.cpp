@@ -23,6 +23,7 @@
 #include "supertux/debug.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/globals.hpp"
+#include "supertux/object_stats.hpp"
 #include "util/gettext.hpp"
 #include "video/texture_manager.hpp"
 
@@ -64,6 +65,12 @@ DebugMenu::DebugMenu() :
   add_toggle(-1, _("Show Worldmap Path"), &g_debug.show_worldmap_path);
   add_toggle(-1, _("Show Controller"), &g_config->show_controller);
   add_toggle(-1, _("Show Framerate"), &g_config->show_fps);
+  add_toggle(-1, _("Show Render Stats"), &g_debug.show_render_stats);
+  add_toggle(-1, _("Show Profiler"), &g_debug.show_profiler);
+  add_toggle(-1, _("Show Memory Usage"), &g_debug.show_memory_stats);
+  add_toggle(-1, _("Show Object Stats"),
+             []{ return g_object_stats.is_enabled(); },
+             [](bool value){ g_object_stats.set_enabled(value); });
   add_toggle(-1, _("Draw Redundant Frames"), &g_debug.draw_redundant_frames);
   add_toggle(-1, _("Show Player Position"), &g_config->show_player_pos);
   add_toggle(-1, _("Use Bitmap Fonts"),
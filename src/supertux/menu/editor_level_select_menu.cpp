@@ -23,6 +23,7 @@
 #include "gui/menu_item.hpp"
 #include "supertux/game_manager.hpp"
 #include "supertux/level.hpp"
+#include "supertux/level_index.hpp"
 #include "supertux/level_parser.hpp"
 #include "supertux/levelset.hpp"
 #include "supertux/menu/editor_levelset_menu.hpp"
@@ -66,6 +67,7 @@ void EditorLevelSelectMenu::initialize() {
       std::string title = LevelParser::get_level_name(full_filename);
       add_entry(i, title);
     }
+    LevelIndex::save();
   }
 
   add_hl();
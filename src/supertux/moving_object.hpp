@@ -81,7 +81,7 @@ public:
 
   CollisionGroup get_group() const
   {
-    return m_col.m_group;
+    return m_col.get_group();
   }
 
   CollisionObject* get_collision_object() {
@@ -100,7 +100,7 @@ public:
 protected:
   void set_group(CollisionGroup group)
   {
-    m_col.m_group = group;
+    m_col.set_group(group);
   }
 
 protected:
@@ -19,9 +19,10 @@
 #define HEADER_SUPERTUX_SUPERTUX_OBJECT_FACTORY_HPP
 
 #include <assert.h>
-#include <map>
-#include <memory>
 #include <functional>
+#include <memory>
+#include <string>
+#include <unordered_map>
 
 #include "supertux/direction.hpp"
 
@@ -33,7 +34,9 @@ class ObjectFactory
 {
 private:
   typedef std::function<std::unique_ptr<GameObject> (const ReaderMapping&)> FactoryFunction;
-  typedef std::map<std::string, FactoryFunction> Factories;
+  /** looked up for every object of every level, the order doesn't
+      matter */
+  typedef std::unordered_map<std::string, FactoryFunction> Factories;
   Factories factories;
 
 public:
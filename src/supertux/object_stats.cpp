@@ -0,0 +1,149 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "supertux/object_stats.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+
+#include "supertux/game_object.hpp"
+
+ObjectStats g_object_stats;
+
+ObjectStats::ObjectStats() :
+  m_enabled(false),
+  m_indices(),
+  m_current(),
+  m_complete(),
+  m_window_start(),
+  m_current_frames(0),
+  m_frames(0)
+{
+}
+
+void
+ObjectStats::set_enabled(bool enabled)
+{
+  if (enabled && !m_enabled)
+  {
+    m_indices.clear();
+    m_current.clear();
+    m_complete.clear();
+    m_window_start = std::chrono::steady_clock::now();
+    m_current_frames = 0;
+    m_frames = 0;
+  }
+  m_enabled = enabled;
+}
+
+void
+ObjectStats::begin_frame()
+{
+  if (!m_enabled)
+    return;
+
+  const auto now = std::chrono::steady_clock::now();
+  if (now - m_window_start >= std::chrono::seconds(1))
+  {
+    m_complete = m_current;
+    m_frames = m_current_frames;
+
+    for (auto& entry : m_current) {
+      entry.ms.fill(0.0f);
+      entry.calls.fill(0);
+    }
+    m_window_start = now;
+    m_current_frames = 0;
+  }
+
+  m_current_frames += 1;
+}
+
+void
+ObjectStats::add(Phase phase, const GameObject& object, int calls, int64_t ns)
+{
+  const std::type_info* type = &typeid(object);
+  auto it = m_indices.find(type);
+  if (it == m_indices.end())
+  {
+    // get_class() allocates, so it only runs once per class
+    it = m_indices.emplace(type, m_current.size()).first;
+    m_current.emplace_back(object.get_class());
+  }
+
+  Entry& entry = m_current[it->second];
+  entry.ms[phase] += static_cast<float>(ns) / 1000000.0f;
+  entry.calls[phase] += calls;
+}
+
+std::vector<const ObjectStats::Entry*>
+ObjectStats::get_top(Phase phase, size_t count) const
+{
+  std::vector<const Entry*> result;
+  for (const auto& entry : m_complete) {
+    if (entry.calls[phase] > 0) {
+      result.push_back(&entry);
+    }
+  }
+
+  count = std::min(count, result.size());
+  std::partial_sort(result.begin(), result.begin() + count, result.end(),
+                    [phase](const Entry* lhs, const Entry* rhs) {
+                      return lhs->ms[phase] > rhs->ms[phase];
+                    });
+  result.resize(count);
+  return result;
+}
+
+void
+ObjectStats::write_report(std::ostream& out, size_t count) const
+{
+  if (m_frames == 0)
+  {
+    out << "no complete window of object stats yet" << std::endl;
+    return;
+  }
+
+  char line[120];
+  for (int i = 0; i < NUM_PHASES; ++i)
+  {
+    const auto phase = static_cast<Phase>(i);
+    snprintf(line, sizeof(line), "%-24s %10s %10s", get_name(phase), "ms/frame", "calls/frame");
+    out << line << std::endl;
+
+    for (const auto* entry : get_top(phase, count))
+    {
+      snprintf(line, sizeof(line), "%-24s %10.3f %10.1f", entry->name.c_str(),
+               static_cast<double>(entry->ms[phase]) / m_frames,
+               static_cast<double>(entry->calls[phase]) / m_frames);
+      out << line << std::endl;
+    }
+  }
+}
+
+const char*
+ObjectStats::get_name(Phase phase)
+{
+  switch (phase)
+  {
+    case UPDATE: return "update";
+    case DRAW: return "draw";
+    default: return "unknown";
+  }
+}
+
+/* EOF */
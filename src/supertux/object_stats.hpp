@@ -0,0 +1,103 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_OBJECT_STATS_HPP
+#define HEADER_SUPERTUX_SUPERTUX_OBJECT_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <stdint.h>
+#include <string>
+#include <typeinfo>
+#include <unordered_map>
+#include <vector>
+
+class GameObject;
+
+/** Time and number of calls of GameObject::update() and draw(),
+    summed up per object class over windows of a second. Recording
+    only happens while enabled, otherwise GameObjectManager doesn't
+    even look at the clock. */
+class ObjectStats final
+{
+public:
+  enum Phase {
+    UPDATE,
+    DRAW,
+    NUM_PHASES
+  };
+
+  struct Entry
+  {
+    Entry(const std::string& name_) : name(name_), ms(), calls() {}
+
+    std::string name;
+    std::array<float, NUM_PHASES> ms;
+    std::array<int, NUM_PHASES> calls;
+  };
+
+public:
+  ObjectStats();
+
+  void set_enabled(bool enabled);
+  bool is_enabled() const { return m_enabled; }
+
+  /** Counts a frame, completes the window once it lasted a second */
+  void begin_frame();
+
+  /** Adds calls calls of the given phase that took ns in total to
+      the class of object */
+  void add(Phase phase, const GameObject& object, int calls, int64_t ns);
+
+  /** Entries of the last complete window with the biggest time in
+      phase, at most count of them */
+  std::vector<const Entry*> get_top(Phase phase, size_t count) const;
+
+  /** Number of frames of the last complete window */
+  int get_frame_count() const { return m_frames; }
+
+  /** Writes the top count classes per phase, in ms per frame */
+  void write_report(std::ostream& out, size_t count) const;
+
+  static const char* get_name(Phase phase);
+
+private:
+  bool m_enabled;
+
+  /** The type_info objects are unique within the program, so their
+      addresses are cheaper keys than std::type_index */
+  std::unordered_map<const std::type_info*, size_t> m_indices;
+
+  /** Current window and the last complete one, same indices */
+  std::vector<Entry> m_current;
+  std::vector<Entry> m_complete;
+
+  std::chrono::steady_clock::time_point m_window_start;
+  int m_current_frames;
+  int m_frames;
+
+private:
+  ObjectStats(const ObjectStats&) = delete;
+  ObjectStats& operator=(const ObjectStats&) = delete;
+};
+
+extern ObjectStats g_object_stats;
+
+#endif
+
+/* EOF */
@@ -16,8 +16,6 @@
 
 #include "supertux/player_status_hud.hpp"
 
-#include <sstream>
-
 #include "supertux/game_object.hpp"
 #include "supertux/player_status.hpp"
 #include "supertux/resources.hpp"
@@ -32,7 +30,9 @@ PlayerStatusHUD::PlayerStatusHUD(PlayerStatus& player_status) :
   displayed_coins_frame(0),
   coin_surface(Surface::from_file("images/engine/hud/coins-0.png")),
   fire_surface(Surface::from_file("images/objects/bullets/fire-hud.png")),
-  ice_surface(Surface::from_file("images/objects/bullets/ice-hud.png"))
+  ice_surface(Surface::from_file("images/objects/bullets/ice-hud.png")),
+  m_coins_text(),
+  m_ammo_text()
 {
 }
 
@@ -64,96 +64,62 @@ PlayerStatusHUD::draw(DrawingContext& context)
   }
   displayed_coins = std::min(std::max(displayed_coins, 0), m_player_status.get_max_coins());
 
-  std::ostringstream ss;
-  ss << displayed_coins;
-  std::string coins_text = ss.str();
+  m_coins_text.set(Resources::fixed_font, displayed_coins);
 
   context.push_transform();
   context.set_translation(Vector(0, 0));
 
+  const float width = static_cast<float>(context.get_width());
+  const float coins_y = BORDER_Y + (m_coins_text.get_height() + 5.0f) * static_cast<float>(player_id);
+
   if (coin_surface)
   {
     context.color().draw_surface(coin_surface,
-                                 Vector(static_cast<float>(context.get_width()) - BORDER_X - static_cast<float>(coin_surface->get_width()) - Resources::fixed_font->get_text_width(coins_text),
-                                        BORDER_Y + 1.0f + (Resources::fixed_font->get_text_height(coins_text) + 5) * static_cast<float>(player_id)),
+                                 Vector(width - BORDER_X - static_cast<float>(coin_surface->get_width()) - m_coins_text.get_width(),
+                                        coins_y + 1.0f),
                                  LAYER_HUD);
   }
 
   context.color().draw_text(Resources::fixed_font,
-                            coins_text,
-                            Vector(static_cast<float>(context.get_width()) - BORDER_X - Resources::fixed_font->get_text_width(coins_text),
-                                   BORDER_Y + (Resources::fixed_font->get_text_height(coins_text) + 5.0f) * static_cast<float>(player_id)),
+                            m_coins_text.get_text(),
+                            Vector(width - BORDER_X - m_coins_text.get_width(), coins_y),
                             ALIGN_LEFT,
                             LAYER_HUD,
                             PlayerStatusHUD::text_color);
 
-  std::string ammo_text;
-
+  SurfacePtr ammo_surface;
+  bool show_ammo = true;
   if (m_player_status.bonus == FIRE_BONUS) {
-
-    ammo_text = std::to_string(m_player_status.max_fire_bullets);
-
-    if (fire_surface) {
-      context.color().draw_surface(fire_surface,
-                                   Vector(static_cast<float>(context.get_width())
-                                              - BORDER_X
-                                              - static_cast<float>(fire_surface->get_width())
-                                              - Resources::fixed_font->get_text_width(ammo_text),
-                                          BORDER_Y
-                                              + 1.0f
-                                              + (Resources::fixed_font->get_text_height(coins_text) + 5)
-                                              + (Resources::fixed_font->get_text_height(ammo_text) + 5)
-                                              * static_cast<float>(player_id)),
-                                   LAYER_HUD);
-    }
-
-    context.color().draw_text(Resources::fixed_font,
-                              ammo_text,
-                              Vector(static_cast<float>(context.get_width())
-                                         - BORDER_X
-                                         - Resources::fixed_font->get_text_width(ammo_text),
-                                     BORDER_Y
-                                         + (Resources::fixed_font->get_text_height(coins_text) + 5.0f)
-                                         + (Resources::fixed_font->get_text_height(ammo_text) + 5.0f)
-                                         * static_cast<float>(player_id)),
-                              ALIGN_LEFT,
-                              LAYER_HUD,
-                              PlayerStatusHUD::text_color);
+    m_ammo_text.set(Resources::fixed_font, m_player_status.max_fire_bullets);
+    ammo_surface = fire_surface;
+  } else if (m_player_status.bonus == ICE_BONUS) {
+    m_ammo_text.set(Resources::fixed_font, m_player_status.max_ice_bullets);
+    ammo_surface = ice_surface;
+  } else {
+    show_ammo = false;
   }
 
-  if (m_player_status.bonus == ICE_BONUS) {
-
-    ammo_text = std::to_string(m_player_status.max_ice_bullets);
-
-    if (ice_surface) {
-      context.color().draw_surface(ice_surface,
-                                   Vector(static_cast<float>(context.get_width())
-                                              - BORDER_X
-                                              - static_cast<float>(ice_surface->get_width())
-                                              - Resources::fixed_font->get_text_width(ammo_text),
-                                          BORDER_Y
-                                              + 1.0f
-                                              + (Resources::fixed_font->get_text_height(coins_text) + 5)
-                                              + (Resources::fixed_font->get_text_height(ammo_text) + 5)
-                                              * static_cast<float>(player_id)),
+  if (show_ammo)
+  {
+    const float ammo_y = BORDER_Y
+      + (m_coins_text.get_height() + 5.0f)
+      + (m_ammo_text.get_height() + 5.0f) * static_cast<float>(player_id);
+
+    if (ammo_surface) {
+      context.color().draw_surface(ammo_surface,
+                                   Vector(width - BORDER_X - static_cast<float>(ammo_surface->get_width()) - m_ammo_text.get_width(),
+                                          ammo_y + 1.0f),
                                    LAYER_HUD);
     }
 
     context.color().draw_text(Resources::fixed_font,
-                              ammo_text,
-                              Vector(static_cast<float>(context.get_width())
-                                         - BORDER_X
-                                         - Resources::fixed_font->get_text_width(ammo_text),
-                                     BORDER_Y
-                                         + (Resources::fixed_font->get_text_height(coins_text) + 5.0f)
-                                         + (Resources::fixed_font->get_text_height(ammo_text) + 5.0f)
-                                         * static_cast<float>(player_id)),
+                              m_ammo_text.get_text(),
+                              Vector(width - BORDER_X - m_ammo_text.get_width(), ammo_y),
                               ALIGN_LEFT,
                               LAYER_HUD,
                               PlayerStatusHUD::text_color);
   }
 
-
   context.pop_transform();
 }
 
@@ -22,6 +22,7 @@
 #include "supertux/game_object.hpp"
 
 #include "video/color.hpp"
+#include "video/number_text.hpp"
 #include "video/surface_ptr.hpp"
 
 class DrawingContext;
@@ -50,6 +51,8 @@ private:
   SurfacePtr coin_surface;
   SurfacePtr fire_surface;
   SurfacePtr ice_surface;
+  NumberText m_coins_text;
+  NumberText m_ammo_text;
 
 private:
   PlayerStatusHUD(const PlayerStatusHUD&) = delete;
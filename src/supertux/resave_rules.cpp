@@ -0,0 +1,148 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "supertux/resave_rules.hpp"
+
+#include <fstream>
+#include <sexp/value.hpp>
+#include <sstream>
+#include <stdexcept>
+
+#include "util/reader_collection.hpp"
+#include "util/reader_document.hpp"
+#include "util/reader_mapping.hpp"
+#include "util/reader_object.hpp"
+
+ResaveRules
+ResaveRules::from_file(const std::string& filename)
+{
+  // given on the command line, so not a PhysFS path
+  std::ifstream in(filename);
+  if (!in) {
+    throw std::runtime_error(filename + ": couldn't open file for reading");
+  }
+
+  auto doc = ReaderDocument::from_stream(in, filename);
+  auto root = doc.get_root();
+  if (root.get_name() != "supertux-resave-rules") {
+    throw std::runtime_error(filename + ": file is not a supertux-resave-rules file");
+  }
+
+  ResaveRules rules;
+  rules.parse(root.get_collection());
+  return rules;
+}
+
+ResaveRules::ResaveRules() :
+  m_tiles(),
+  m_strings()
+{
+}
+
+void
+ResaveRules::parse(const ReaderCollection& collection)
+{
+  for (const auto& rule : collection.get_objects())
+  {
+    auto mapping = rule.get_mapping();
+    if (rule.get_name() == "tile")
+    {
+      uint32_t from, to;
+      if (!mapping.get("from", from) || !mapping.get("to", to)) {
+        throw std::runtime_error("tile rule needs 'from' and 'to'");
+      }
+      add_tile_rule(from, to);
+    }
+    else if (rule.get_name() == "string")
+    {
+      std::string key, from, to;
+      mapping.get("key", key);
+      if (!mapping.get("from", from) || !mapping.get("to", to)) {
+        throw std::runtime_error("string rule needs 'from' and 'to'");
+      }
+      add_string_rule(key, from, to);
+    }
+    else
+    {
+      throw std::runtime_error("unknown resave rule '" + rule.get_name() + "'");
+    }
+  }
+}
+
+void
+ResaveRules::add_tile_rule(uint32_t from, uint32_t to)
+{
+  m_tiles[from] = to;
+}
+
+void
+ResaveRules::add_string_rule(const std::string& key, const std::string& from, const std::string& to)
+{
+  m_strings.push_back({key, from, to});
+}
+
+size_t
+ResaveRules::apply(sexp::Value& sx) const
+{
+  if (!sx.is_array())
+    return 0;
+
+  size_t changes = 0;
+  auto& arr = sx.as_array();
+  if (!arr.empty() && arr[0].is_symbol())
+  {
+    const std::string& key = arr[0].as_string();
+
+    if (key == "tiles" && !m_tiles.empty())
+    {
+      for (size_t i = 1; i < arr.size(); ++i)
+      {
+        if (!arr[i].is_integer())
+          continue;
+
+        auto it = m_tiles.find(static_cast<uint32_t>(arr[i].as_int()));
+        if (it != m_tiles.end()) {
+          arr[i] = sexp::Value::integer(static_cast<int>(it->second));
+          changes += 1;
+        }
+      }
+    }
+
+    for (size_t i = 1; i < arr.size(); ++i)
+    {
+      if (!arr[i].is_string())
+        continue;
+
+      for (const auto& rule : m_strings)
+      {
+        if ((rule.key.empty() || rule.key == key) && arr[i].as_string() == rule.from) {
+          arr[i] = sexp::Value::string(rule.to);
+          changes += 1;
+          break;
+        }
+      }
+    }
+  }
+
+  for (auto& value : arr) {
+    changes += apply(value);
+  }
+
+  return changes;
+}
+
+/* EOF */
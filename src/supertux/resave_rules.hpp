@@ -0,0 +1,77 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_RESAVE_RULES_HPP
+#define HEADER_SUPERTUX_SUPERTUX_RESAVE_RULES_HPP
+
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace sexp {
+class Value;
+} // namespace sexp
+
+class ReaderCollection;
+
+/** Substitutions applied by --resave-rules to every level of a batch
+    resave. The rules work on the parsed S-Expressions before any
+    GameObject gets created, so they can run on worker threads.
+
+    (supertux-resave-rules
+      (tile (from 12) (to 34))
+      (string (key "sprite") (from "images/old.sprite") (to "images/new.sprite")))
+
+    Tile rules replace ids in (tiles ...), string rules replace string
+    values, either of any entry or only of entries named key. */
+class ResaveRules final
+{
+private:
+  struct StringRule
+  {
+    std::string key;
+    std::string from;
+    std::string to;
+  };
+
+public:
+  static ResaveRules from_file(const std::string& filename);
+
+public:
+  ResaveRules();
+
+  void add_tile_rule(uint32_t from, uint32_t to);
+  void add_string_rule(const std::string& key, const std::string& from, const std::string& to);
+
+  bool empty() const { return m_tiles.empty() && m_strings.empty(); }
+
+  /** Applies all rules to the tree below sx, returns the number of
+      values that got replaced */
+  size_t apply(sexp::Value& sx) const;
+
+private:
+  void parse(const ReaderCollection& collection);
+
+private:
+  std::unordered_map<uint32_t, uint32_t> m_tiles;
+  std::vector<StringRule> m_strings;
+};
+
+#endif
+
+/* EOF */
@@ -68,10 +68,15 @@ Resources::load()
     if(font != current_font)
     {
       current_font = font;
-      fixed_font.reset(new TTFFont(font, 18, 1.25f, 2, 1));
+      auto make_font = [&font](int size) {
+        auto ttf_font = std::make_shared<TTFFont>(font, size, 1.25f, 2, 1);
+        ttf_font->enable_glyph_atlas();
+        return ttf_font;
+      };
+      fixed_font = make_font(18);
       normal_font = fixed_font;
-      small_font.reset(new TTFFont(font, 10, 1.25f, 2, 1));
-      big_font.reset(new TTFFont(font, 22, 1.25f, 2, 1));
+      small_font = make_font(10);
+      big_font = make_font(22);
     }
   }
 
@@ -18,6 +18,7 @@
 #include "supertux/savegame.hpp"
 
 #include <algorithm>
+#include <fstream>
 #include <physfs.h>
 
 #include "physfs/physfs_file_system.hpp"
@@ -27,6 +28,7 @@
 #include "squirrel/squirrel_virtual_machine.hpp"
 #include "supertux/player_status.hpp"
 #include "util/file_system.hpp"
+#include "util/job_system.hpp"
 #include "util/log.hpp"
 #include "util/reader_document.hpp"
 #include "util/reader_mapping.hpp"
@@ -35,6 +37,39 @@
 
 namespace {
 
+/** The newest savegame write, each write waits for the one before */
+JobSystem::Handle s_pending_save;
+
+void wait_for_pending_save()
+{
+  if (JobSystem::current()) {
+    JobSystem::current()->wait(s_pending_save);
+  }
+}
+
+/** Writes data to a temporary file next to path and moves it over
+    path, so a crash never leaves a half written savegame behind */
+void write_atomically(const std::string& path, const std::string& data)
+{
+  const std::string tmp_path = path + ".tmp";
+  {
+    std::ofstream out(tmp_path, std::ios::binary | std::ios::trunc);
+    out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    out.close();
+    if (!out)
+    {
+      log_warning << "Couldn't write savegame '" << tmp_path << "'" << std::endl;
+      FileSystem::remove(tmp_path);
+      return;
+    }
+  }
+
+  if (!FileSystem::rename(tmp_path, path))
+  {
+    log_warning << "Couldn't replace savegame '" << path << "'" << std::endl;
+  }
+}
+
 std::vector<LevelState> get_level_states(SquirrelVM& vm)
 {
   std::vector<LevelState> results;
@@ -118,7 +153,12 @@ Savegame::from_file(const std::string& filename)
 
 Savegame::Savegame(const std::string& filename) :
   m_filename(filename),
-  m_player_status(new PlayerStatus)
+  m_player_status(new PlayerStatus),
+  m_state_cache(new SquirrelTableCache)
+{
+}
+
+Savegame::~Savegame()
 {
 }
 
@@ -140,6 +180,9 @@ Savegame::load()
 
   clear_state_table();
 
+  // a save to the same file may still be on its way to disk
+  wait_for_pending_save();
+
   if (!PHYSFS_exists(m_filename.c_str()))
   {
     log_info << m_filename << " doesn't exist, not loading state" << std::endl;
@@ -219,6 +262,8 @@ Savegame::clear_state_table()
     vm.create_empty_table("state");
   }
   sq_pop(vm.get_vm(), 1);
+
+  m_state_cache->clear();
 }
 
 void
@@ -255,7 +300,10 @@ Savegame::save()
 
   SquirrelVM& vm = SquirrelVirtualMachine::current()->get_vm();
 
-  Writer writer(m_filename);
+  // the state is captured here, only the file access happens on a
+  // worker thread
+  std::ostringstream out;
+  Writer writer(out);
 
   writer.start_list("supertux-savegame");
   writer.write("version", 1);
@@ -280,8 +328,9 @@ Savegame::save()
   try
   {
     vm.get_table_entry("state"); // Push "state"
-    save_squirrel_table(vm.get_vm(), -1, writer);
+    save_squirrel_table(vm.get_vm(), -1, writer, *m_state_cache);
     sq_pop(vm.get_vm(), 1); // Pop "state"
+    m_state_cache->prune();
   }
   catch(const std::exception&)
   {
@@ -290,6 +339,23 @@ Savegame::save()
   writer.end_list("state");
 
   writer.end_list("supertux-savegame");
+
+  const char* write_dir = PHYSFS_getWriteDir();
+  if (!write_dir)
+  {
+    log_warning << "no write directory, skipping save" << std::endl;
+    return;
+  }
+
+  auto job = [path = FileSystem::join(write_dir, m_filename), data = out.str()] {
+    write_atomically(path, data);
+  };
+
+  if (JobSystem::current()) {
+    s_pending_save = JobSystem::current()->schedule(std::move(job), { s_pending_save });
+  } else {
+    job();
+  }
 }
 
 std::vector<std::string>
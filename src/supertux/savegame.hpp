@@ -23,6 +23,7 @@
 #include <vector>
 
 class PlayerStatus;
+class SquirrelTableCache;
 
 struct LevelState
 {
@@ -70,6 +71,7 @@ public:
 
 public:
   Savegame(const std::string& filename);
+  ~Savegame();
 
   /** Returns content of (tux ...) entry */
   PlayerStatus& get_player_status() const { return *m_player_status; }
@@ -97,6 +99,9 @@ private:
   std::string m_filename;
   std::unique_ptr<PlayerStatus> m_player_status;
 
+  /** Serialized worlds and levelsets of the previous save() */
+  std::unique_ptr<SquirrelTableCache> m_state_cache;
+
 private:
   Savegame(const Savegame&) = delete;
   Savegame& operator=(const Savegame&) = delete;
@@ -18,6 +18,7 @@
 #include "supertux/screen_manager.hpp"
 
 #include "audio/sound_manager.hpp"
+#include "control/input_manager.hpp"
 #include "editor/editor.hpp"
 #include "gui/menu_manager.hpp"
 #include "object/player.hpp"
@@ -30,17 +31,71 @@
 #include "supertux/gameconfig.hpp"
 #include "supertux/globals.hpp"
 #include "supertux/level.hpp"
+#include "supertux/load_stats.hpp"
 #include "supertux/menu/menu_storage.hpp"
+#include "supertux/memory_stats.hpp"
+#include "supertux/object_stats.hpp"
 #include "supertux/resources.hpp"
 #include "supertux/screen_fade.hpp"
 #include "supertux/sector.hpp"
+#include "supertux/step_stats.hpp"
+#include "util/allocation_tracker.hpp"
+#include "util/job_system.hpp"
 #include "util/log.hpp"
+#include "util/profiler.hpp"
 #include "video/compositor.hpp"
+#include "video/frame_capture.hpp"
 #include "video/drawing_context.hpp"
+#include "video/render_stats.hpp"
+#include "video/texture_manager.hpp"
 
+#include <algorithm>
 #include <stdio.h>
 #include <chrono>
+#include <limits>
+#include <functional>
+#include <iostream>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+namespace {
+
+/** In power saving mode, unchanged frames in a row after which the
+    main loop only wakes up every IDLE_STEPS logical steps */
+const int IDLE_FRAMES = 32;
+const int IDLE_STEPS = 4;
+
+/** Unchanged frames are still drawn every now and then, in case a
+    texture got replaced by another one at the same address */
+const int MAX_SKIPPED_FRAMES = 64;
+
+/** In precise pacing mode, the last part of a wait that is spun
+    instead of slept, as SDL_Delay() isn't accurate enough for it */
+const Sint64 SPIN_US = 2000;
+
+/** Frame times the 1% and 0.1% lows and the histogram are taken from */
+const size_t HISTORY_FRAMES = 1000;
+
+/** Width of a histogram bin, the last bin collects everything past
+    HISTOGRAM_BINS - 1 bins */
+const int HISTOGRAM_BIN_US = 2000;
+const int HISTOGRAM_BINS = 17;
+
+/** Microseconds since startup, from the performance counter in
+    precise pacing mode, from SDL_GetTicks() otherwise */
+Uint64 get_time_us(bool precise)
+{
+  if (!precise)
+    return static_cast<Uint64>(SDL_GetTicks()) * 1000;
+
+  static const Uint64 frequency = SDL_GetPerformanceFrequency();
+  const Uint64 counter = SDL_GetPerformanceCounter();
+  // split up to not overflow on high frequency counters
+  return counter / frequency * 1000000 + counter % frequency * 1000000 / frequency;
+}
 
+} // namespace
 
 ScreenManager::ScreenManager(VideoSystem& video_system, InputManager& input_manager) :
   m_video_system(video_system),
@@ -48,11 +103,21 @@ ScreenManager::ScreenManager(VideoSystem& video_system, InputManager& input_mana
   m_menu_storage(new MenuStorage),
   m_menu_manager(new MenuManager),
   m_controller_hud(new ControllerHUD),
+  m_event_queue(),
+  m_frame_arena(),
   m_speed(1.0),
   m_actions(),
   m_screen_fade(),
-  m_screen_stack()
+  m_screen_stack(),
+  m_frame_hash(0),
+  m_unchanged_frames(0),
+  m_force_redraw(true),
+  m_memory_stats(),
+  m_memory_stats_time(0.0f)
 {
+  m_event_queue.set_axis_zone_func([this](const SDL_Event& event) {
+      return m_input_manager.get_axis_zone(event);
+    });
 }
 
 ScreenManager::~ScreenManager()
@@ -123,12 +188,23 @@ struct ScreenManager::FPS_Stats
     last_fps(0),
     last_fps_min(0),
     last_fps_max(0),
+    frame_us(),
+    acc_present_us(0),
+    last_frame_ms{},
+    last_present_ms(0),
+    input_latency_ms(0),
+    history_us(),
+    history_pos(0),
+    last_low_fps{},
+    histogram{},
+    last_us(0),
     // Use chrono instead of SDL_GetTicks for more precise FPS measurement
     time_prev(std::chrono::steady_clock::now())
   {
   }
 
-  void report_frame()
+  /** present_us is the time drawing and presenting the frame took */
+  void report_frame(int present_us)
   {
     auto time_now = std::chrono::steady_clock::now();
     int dtime_us = static_cast<int>(std::chrono::duration_cast<
@@ -137,8 +213,18 @@ struct ScreenManager::FPS_Stats
     if (dtime_us == 0)
       return;
     time_prev = time_now;
+    last_us = dtime_us;
+
+    if (history_us.size() < HISTORY_FRAMES) {
+      history_us.push_back(dtime_us);
+    } else {
+      history_us[history_pos] = dtime_us;
+      history_pos = (history_pos + 1) % HISTORY_FRAMES;
+    }
 
     acc_us += dtime_us;
+    acc_present_us += present_us;
+    frame_us.push_back(dtime_us);
     ++measurements_cnt;
     if (min_us > dtime_us)
       min_us = dtime_us;
@@ -158,16 +244,65 @@ struct ScreenManager::FPS_Stats
     assert(min_us > 0);  // initialization to 1000000 and dtime_us > 0.
     last_fps_max = 1000000.0f / static_cast<float>(min_us);
     assert(last_fps_max > 0);  // min_us > 0.
+
+    // spikes are hidden in the averages, percentiles show them
+    std::sort(frame_us.begin(), frame_us.end());
+    const float percentiles[] = { 0.5f, 0.95f, 0.99f };
+    for (int i = 0; i < 3; ++i) {
+      const size_t idx = std::min(frame_us.size() - 1,
+                                  static_cast<size_t>(percentiles[i] * static_cast<float>(frame_us.size())));
+      last_frame_ms[i] = static_cast<float>(frame_us[idx]) / 1000.0f;
+    }
+    last_present_ms = static_cast<float>(acc_present_us) / 1000.0f / static_cast<float>(measurements_cnt);
+    frame_us.clear();
+
+    // the lows need more frames than one interval has, so they come
+    // from the longer history
+    std::fill(std::begin(histogram), std::end(histogram), 0);
+    for (int us : history_us) {
+      histogram[std::min(us / HISTOGRAM_BIN_US, HISTOGRAM_BINS - 1)] += 1;
+    }
+    std::vector<int> sorted_us = history_us;
+    std::sort(sorted_us.begin(), sorted_us.end(), std::greater<int>());
+    const size_t lows[] = { sorted_us.size() / 100, sorted_us.size() / 1000 };
+    for (int i = 0; i < 2; ++i) {
+      last_low_fps[i] = 1000000.0f / static_cast<float>(sorted_us[lows[i]]);
+    }
+    acc_present_us = 0;
+
     measurements_cnt = 0;
     acc_us = 0;
     min_us = 1000000;
     max_us = 0;
   }
 
+  /** us is the time from a key press until the frame showing its
+      effect was presented */
+  void report_input_latency(int us)
+  {
+    const float ms = static_cast<float>(us) / 1000.0f;
+    input_latency_ms = (input_latency_ms == 0.0f) ? ms : input_latency_ms * 0.9f + ms * 0.1f;
+  }
+
   float get_fps() const { return last_fps; }
   float get_fps_min() const { return last_fps_min; }
   float get_fps_max() const { return last_fps_max; }
 
+  /** Frame time percentiles 50%, 95% and 99% in ms */
+  float get_frame_ms(int percentile) const { return last_frame_ms[percentile]; }
+  float get_present_ms() const { return last_present_ms; }
+  float get_input_latency_ms() const { return input_latency_ms; }
+
+  /** FPS at the 1% (low = 0) and 0.1% (low = 1) slowest frame of the
+      last HISTORY_FRAMES frames */
+  float get_low_fps(int low) const { return last_low_fps[low]; }
+
+  /** Frames of the history per HISTOGRAM_BIN_US wide bin */
+  const int* get_histogram() const { return histogram; }
+
+  /** Time between the last two frames */
+  int get_last_frame_us() const { return last_us; }
+
   // This returns the highest measured delay between two frames from the
   // previous and current 0.5 s measuring intervals
   float get_highest_max_ms() const
@@ -188,6 +323,16 @@ private:
   float last_fps;
   float last_fps_min;
   float last_fps_max;
+  std::vector<int> frame_us;
+  int acc_present_us;
+  float last_frame_ms[3];
+  float last_present_ms;
+  float input_latency_ms;
+  std::vector<int> history_us;
+  size_t history_pos;
+  float last_low_fps[2];
+  int histogram[HISTOGRAM_BINS];
+  int last_us;
   std::chrono::steady_clock::time_point time_prev;
 };
 
@@ -219,6 +364,194 @@ ScreenManager::draw_fps(DrawingContext& context, FPS_Stats& fps_statistics)
   pos.x -= w2;
   context.color().draw_text(Resources::small_font, str1,
     pos, ALIGN_RIGHT, LAYER_HUD);
+
+  char str4[80];
+  snprintf(str4, sizeof(str4), "frame ms %.1f / %.1f / %.1f  present %.1f  input %.1f",
+    static_cast<double>(fps_statistics.get_frame_ms(0)),
+    static_cast<double>(fps_statistics.get_frame_ms(1)),
+    static_cast<double>(fps_statistics.get_frame_ms(2)),
+    static_cast<double>(fps_statistics.get_present_ms()),
+    static_cast<double>(fps_statistics.get_input_latency_ms()));
+  pos.x = static_cast<float>(context.get_width()) - BORDER_X;
+  pos.y += 15;
+  context.color().draw_text(Resources::small_font, str4,
+    pos, ALIGN_RIGHT, LAYER_HUD);
+
+  // a steady frame rate is a single bar, hitches show up on the right
+  const int* histogram = fps_statistics.get_histogram();
+  const int highest = *std::max_element(histogram, histogram + HISTOGRAM_BINS);
+  if (highest > 0)
+  {
+    const float bar_width = 4.0f;
+    const float bar_height = 40.0f;
+    const float left = static_cast<float>(context.get_width()) - BORDER_X - 260.0f - bar_width * HISTOGRAM_BINS;
+    const float bottom = BORDER_Y + 90.0f;
+    for (int i = 0; i < HISTOGRAM_BINS; ++i)
+    {
+      if (histogram[i] == 0)
+        continue;
+
+      // at least a pixel, a single hitch is worth seeing
+      const float height = std::max(1.0f, bar_height * static_cast<float>(histogram[i]) / static_cast<float>(highest));
+      const float x = left + bar_width * static_cast<float>(i);
+      context.color().draw_filled_rect(Rectf(x, bottom - height, x + bar_width - 1.0f, bottom),
+                                       i == HISTOGRAM_BINS - 1 ? Color(1.0f, 0.3f, 0.3f) : Color(0.8f, 0.8f, 0.8f),
+                                       LAYER_HUD);
+    }
+
+    char str5[80];
+    snprintf(str5, sizeof(str5), "1%% low %.1f  0.1%% low %.1f",
+      static_cast<double>(fps_statistics.get_low_fps(0)),
+      static_cast<double>(fps_statistics.get_low_fps(1)));
+    context.color().draw_text(Resources::small_font, str5,
+      Vector(left, bottom + 2.0f), ALIGN_LEFT, LAYER_HUD);
+  }
+}
+
+void
+ScreenManager::log_hitch(int frame_us)
+{
+  const Profiler::Frame* frame = g_profiler.get_frame(0);
+
+  std::ostringstream out;
+  out << "hitch: frame took " << static_cast<float>(frame_us) / 1000.0f << " ms" << std::endl;
+  if (frame)
+  {
+    for (const auto& node : Profiler::get_tree(*frame)) {
+      out << "  " << std::string(node.depth * 2, ' ') << node.name
+          << "  " << node.calls << "x  " << node.ms << " ms" << std::endl;
+    }
+
+    for (const auto& file : g_load_stats.get_recent_files(frame->start_ns)) {
+      out << "  loaded " << file.filename << std::endl;
+    }
+  }
+  log_warning << out.str() << std::flush;
+}
+
+void
+ScreenManager::draw_render_stats(DrawingContext& context)
+{
+  const RenderStats::Frame* frame = g_render_stats.get_complete_frame();
+  if (!frame)
+    return;
+
+  auto sections = frame->sections;
+  std::sort(sections.begin(), sections.end(),
+            [](const RenderStats::Section& lhs, const RenderStats::Section& rhs) {
+              return std::make_tuple(lhs.target, lhs.layer) < std::make_tuple(rhs.target, rhs.layer);
+            });
+
+  Vector pos(static_cast<float>(context.get_width()) - BORDER_X, BORDER_Y + 105);
+  char str[160];
+  auto draw_line = [&context, &pos, &str](const char* name, const RenderStats::Counters& c) {
+    snprintf(str, sizeof(str), "%s  %d req  %d calls  %d verts  %d binds  %d state  %d elided  %.2f ms",
+             name, c.requests, c.draw_calls, c.vertices, c.texture_binds, c.state_changes,
+             c.elided_calls, static_cast<double>(c.gpu_ms));
+    context.color().draw_text(Resources::small_font, str, pos, ALIGN_RIGHT, LAYER_HUD);
+    pos.y += 15;
+  };
+
+  draw_line("total", frame->totals);
+  for (const auto& section : sections)
+  {
+    char name[40];
+    snprintf(name, sizeof(name), "%s %d", to_string(section.target).c_str(), section.layer);
+    draw_line(name, section.counters);
+  }
+}
+
+void
+ScreenManager::draw_profiler(DrawingContext& context)
+{
+  const Profiler::Frame* frame = g_profiler.get_slowest_frame();
+  if (!frame)
+    return;
+
+  // allocation counts are only there in builds with allocation tracking
+  const bool allocations = AllocationTracker::is_available();
+
+  Vector pos(BORDER_X, BORDER_Y + 60);
+  char str[160];
+  snprintf(str, sizeof(str), "slowest of %d frames  %.2f ms",
+           static_cast<int>(g_profiler.get_frame_count()),
+           static_cast<double>(frame->get_duration_ns()) / 1000000.0);
+  context.color().draw_text(Resources::small_font, str, pos, ALIGN_LEFT, LAYER_HUD);
+  pos.y += 15;
+
+  if (allocations)
+  {
+    const Profiler::Frame* latest = g_profiler.get_frame(0);
+    snprintf(str, sizeof(str), "last frame %d allocs  %d KiB  in flight %d KiB",
+             static_cast<int>(latest->allocations),
+             static_cast<int>(latest->allocated_bytes / 1024),
+             static_cast<int>(AllocationTracker::get_bytes_in_flight() / 1024));
+    context.color().draw_text(Resources::small_font, str, pos, ALIGN_LEFT, LAYER_HUD);
+    pos.y += 15;
+  }
+
+  for (const auto& node : Profiler::get_tree(*frame))
+  {
+    if (allocations) {
+      snprintf(str, sizeof(str), "%*s%s  %dx  %.2f ms  %d allocs", node.depth * 2, "",
+               node.name, node.calls, static_cast<double>(node.ms),
+               static_cast<int>(node.allocations));
+    } else {
+      snprintf(str, sizeof(str), "%*s%s  %dx  %.2f ms", node.depth * 2, "",
+               node.name, node.calls, static_cast<double>(node.ms));
+    }
+    context.color().draw_text(Resources::small_font, str, pos, ALIGN_LEFT, LAYER_HUD);
+    pos.y += 15;
+  }
+}
+
+void
+ScreenManager::draw_object_stats(DrawingContext& context)
+{
+  const int frames = g_object_stats.get_frame_count();
+  if (frames == 0)
+    return;
+
+  Vector pos(BORDER_X, static_cast<float>(context.get_height()) / 2.0f);
+  char str[120];
+  for (int i = 0; i < ObjectStats::NUM_PHASES; ++i)
+  {
+    const auto phase = static_cast<ObjectStats::Phase>(i);
+    snprintf(str, sizeof(str), "%s  ms/frame  calls/frame", ObjectStats::get_name(phase));
+    context.color().draw_text(Resources::small_font, str, pos, ALIGN_LEFT, LAYER_HUD);
+    pos.y += 15;
+
+    for (const auto* entry : g_object_stats.get_top(phase, 5))
+    {
+      snprintf(str, sizeof(str), "  %s  %.3f  %.1f", entry->name.c_str(),
+               static_cast<double>(entry->ms[phase]) / frames,
+               static_cast<double>(entry->calls[phase]) / frames);
+      context.color().draw_text(Resources::small_font, str, pos, ALIGN_LEFT, LAYER_HUD);
+      pos.y += 15;
+    }
+  }
+}
+
+void
+ScreenManager::draw_memory_stats(DrawingContext& context)
+{
+  // collecting walks the texture cache, once a second is plenty
+  if (m_memory_stats.empty() || g_real_time - m_memory_stats_time >= 1.0f)
+  {
+    std::ostringstream out;
+    MemoryStats::write_report(out);
+    m_memory_stats = out.str();
+    m_memory_stats_time = g_real_time;
+  }
+
+  Vector pos(static_cast<float>(context.get_width()) - BORDER_X - 320.0f, BORDER_Y + 60.0f);
+  std::istringstream in(m_memory_stats);
+  std::string line;
+  while (std::getline(in, line))
+  {
+    context.color().draw_text(Resources::small_font, line, pos, ALIGN_LEFT, LAYER_HUD);
+    pos.y += 15;
+  }
 }
 
 void
@@ -237,13 +570,16 @@ ScreenManager::draw_player_pos(DrawingContext& context)
   }
 }
 
-void
+bool
 ScreenManager::draw(Compositor& compositor, FPS_Stats& fps_statistics)
 {
   assert(!m_screen_stack.empty());
 
   // draw the actual screen
-  m_screen_stack.back()->draw(compositor);
+  {
+    Profiler::Scope profile_scope("screen");
+    m_screen_stack.back()->draw(compositor);
+  }
 
   // draw effects and hud
   auto& context = compositor.make_context(true);
@@ -258,6 +594,18 @@ ScreenManager::draw(Compositor& compositor, FPS_Stats& fps_statistics)
   if (g_config->show_fps)
     draw_fps(context, fps_statistics);
 
+  if (g_debug.show_render_stats)
+    draw_render_stats(context);
+
+  if (g_debug.show_profiler)
+    draw_profiler(context);
+
+  if (g_object_stats.is_enabled())
+    draw_object_stats(context);
+
+  if (g_debug.show_memory_stats)
+    draw_memory_stats(context);
+
   if (g_config->show_controller) {
     m_controller_hud->draw(context);
   }
@@ -266,19 +614,43 @@ ScreenManager::draw(Compositor& compositor, FPS_Stats& fps_statistics)
     draw_player_pos(context);
   }
 
+  if (g_config->power_saving)
+  {
+    const uint64_t hash = compositor.get_hash();
+    if (hash == m_frame_hash && !m_force_redraw && m_unchanged_frames % MAX_SKIPPED_FRAMES != 0)
+    {
+      // the previous frame is still on screen, skip rendering and flip
+      m_unchanged_frames += 1;
+      return false;
+    }
+
+    m_unchanged_frames = (hash == m_frame_hash) ? m_unchanged_frames + 1 : 0;
+    m_frame_hash = hash;
+    m_force_redraw = false;
+  }
+
   // render everything
-  compositor.render();
+  compositor.render(!g_config->deferred_flip);
+  return true;
 }
 
 void
 ScreenManager::update_gamelogic(float dt_sec)
 {
+  StepStats::Scope stats_scope(g_step_stats, StepStats::UPDATE);
+  Profiler::Scope profile_scope("update");
+
   const Controller& controller = m_input_manager.get_controller();
 
-  SquirrelVirtualMachine::current()->update(g_game_time);
+  {
+    StepStats::Scope scripting_scope(g_step_stats, StepStats::SCRIPTING);
+    Profiler::Scope scripts_scope("scripts");
+    SquirrelVirtualMachine::current()->update(g_game_time);
+  }
 
   if (!m_screen_stack.empty())
   {
+    Profiler::Scope screen_scope("screen");
     m_screen_stack.back()->update(dt_sec, controller);
   }
 
@@ -292,14 +664,32 @@ ScreenManager::update_gamelogic(float dt_sec)
   Console::current()->update(dt_sec);
 }
 
-void
-ScreenManager::process_events()
+uint64_t
+ScreenManager::process_events(uint64_t until_us)
 {
   m_input_manager.update();
-  SDL_Event event;
+  uint64_t press_us = 0;
+  EventQueue::Entry entry;
   auto session = GameSession::current();
-  while (SDL_PollEvent(&event))
+  while (m_event_queue.pop(until_us, entry))
   {
+    const SDL_Event& event = entry.event;
+
+    if (!m_input_manager.filter_event(event))
+      continue;
+
+    switch (event.type)
+    {
+      case SDL_KEYDOWN:
+      case SDL_MOUSEBUTTONDOWN:
+      case SDL_JOYBUTTONDOWN:
+      case SDL_CONTROLLERBUTTONDOWN:
+        if (press_us == 0) {
+          press_us = entry.time_us;
+        }
+        break;
+    }
+
     m_input_manager.process_event(event);
 
     m_menu_manager->event(event);
@@ -315,6 +705,9 @@ ScreenManager::process_events()
         break;
 
       case SDL_WINDOWEVENT:
+        // the window content may have been lost
+        m_force_redraw = true;
+
         switch (event.window.event)
         {
           case SDL_WINDOWEVENT_RESIZED:
@@ -338,7 +731,12 @@ ScreenManager::process_events()
         break;
 
       case SDL_KEYDOWN:
-        if (event.key.keysym.sym == SDLK_F10)
+        if (event.key.keysym.sym == SDLK_F10 &&
+            event.key.keysym.mod & KMOD_CTRL)
+        {
+          g_debug.show_render_stats = !g_debug.show_render_stats;
+        }
+        else if (event.key.keysym.sym == SDLK_F10)
         {
           g_config->show_fps = !g_config->show_fps;
         }
@@ -354,6 +752,9 @@ ScreenManager::process_events()
                  event.key.keysym.sym == SDLK_F12)
         {
           m_video_system.do_take_screenshot();
+
+          // the screenshot is read when the next frame is shown
+          m_force_redraw = true;
         }
         else if (event.key.keysym.sym == SDLK_F2 &&
                  event.key.keysym.mod & KMOD_CTRL)
@@ -373,6 +774,8 @@ ScreenManager::process_events()
         break;
     }
   }
+
+  return press_us;
 }
 
 bool
@@ -453,36 +856,152 @@ ScreenManager::handle_screen_switch()
 void
 ScreenManager::run()
 {
-  Uint32 last_ticks = 0;
-  Uint32 elapsed_ticks = 0;
+  // the precise mode keeps the step length of the millisecond mode,
+  // so both simulate exactly the same
+  const bool precise = g_config->precise_frame_pacing;
   const Uint32 ms_per_step = static_cast<Uint32>(1000.0f / LOGICAL_FPS);
+  const Sint64 us_per_step = static_cast<Sint64>(ms_per_step) * 1000;
   const float seconds_per_step = static_cast<float>(ms_per_step) / 1000.0f;
+  Uint64 last_time = 0;
+  Uint64 last_draw_time = 0;
+  Sint64 elapsed_us = 0;
+  Sint64 present_us = 0;
   FPS_Stats fps_statistics;
+  int hitch_us = 0;
+
+  // arrival of the oldest key press handled since the last drawn
+  // frame and of the one the frame waiting to be presented shows
+  uint64_t press_us = 0;
+  uint64_t shown_press_us = 0;
+  auto report_latency = [&fps_statistics, precise](uint64_t time_us) {
+    if (time_us != 0) {
+      const uint64_t latency_us = get_time_us(precise) - time_us;
+      fps_statistics.report_input_latency(static_cast<int>(latency_us));
+      g_profiler.add_counter("input latency ms", static_cast<float>(latency_us) / 1000.0f);
+    }
+  };
+
+  // with deferred flipping the last drawn frame is presented only
+  // before sleeping or drawing the next one
+  bool flip_pending = false;
+  auto present = [this, &flip_pending, &shown_press_us, &report_latency] {
+    if (flip_pending) {
+      Profiler::Scope flip_scope("flip");
+      m_video_system.flip();
+      flip_pending = false;
+
+      report_latency(shown_press_us);
+      shown_press_us = 0;
+    }
+  };
+
+  if (!g_config->render_stats_file.empty()) {
+    g_render_stats.open_csv(g_config->render_stats_file);
+  }
+
+  Profiler::set_thread_name("main");
+  if (!g_config->trace_file.empty()) {
+    g_profiler.open_trace(g_config->trace_file);
+  }
+
+  std::unique_ptr<FrameCapture> capture;
+  if (!g_config->capture_file.empty()) {
+    capture.reset(new FrameCapture(g_config->capture_file));
+  }
+
+  // run one step per iteration, as fast as possible
+  const bool benchmark = g_config->benchmark_demo;
+  g_step_stats.set_enabled(benchmark);
 
   handle_screen_switch();
   while (!m_screen_stack.empty()) {
-    Uint32 ticks = SDL_GetTicks();
-    elapsed_ticks += ticks - last_ticks;
-    last_ticks = ticks;
+    if (JobSystem::current()) {
+      JobSystem::current()->process_main_thread();
+    }
 
-    if (elapsed_ticks > ms_per_step * 8) {
+    const Uint64 now = get_time_us(precise);
+    elapsed_us += static_cast<Sint64>(now - last_time);
+    last_time = now;
+
+    if (elapsed_us > us_per_step * 8) {
       // when the game loads up or levels are switched the
-      // elapsed_ticks grows extremely large, so we just ignore those
+      // elapsed_us grows extremely large, so we just ignore those
       // large time jumps
-      elapsed_ticks = 0;
+      elapsed_us = 0;
+    }
+
+    if (benchmark) {
+      elapsed_us = us_per_step;
     }
 
-    if (elapsed_ticks < ms_per_step && !g_debug.draw_redundant_frames) {
+    // with vsync the swap blocks until the next refresh, so start
+    // drawing early by the time presenting usually takes, the frame
+    // then reaches the display at the time of its step
+    const Sint64 lead_us = (precise && m_video_system.get_vsync() != 0) ?
+      std::min(present_us, us_per_step / 2) : 0;
+    const Sint64 due_us = elapsed_us + lead_us;
+
+    // with render interpolation every frame shows a different blend
+    // of the last two steps, so draw instead of sleeping
+    const bool interpolate = g_config->render_interpolation && !g_config->power_saving;
+
+    if (interpolate && due_us < us_per_step && now - last_draw_time < 1000) {
+      present();
+      SDL_Delay(1);
+      continue;
+    }
+
+    if (due_us < us_per_step && !g_debug.draw_redundant_frames && !interpolate) {
+      present();
+      const Sint64 remaining_us = us_per_step - due_us;
+
+      // spend the slack before the next step on script garbage, if the
+      // collection fits in there
+      if (SquirrelVirtualMachine::current()->collect_garbage(
+            static_cast<float>(remaining_us) / 1000000.0f)) {
+        continue;
+      }
+
       // Sleep a bit because not enough time has passed since the previous
       // logical game step
-      SDL_Delay(ms_per_step - elapsed_ticks);
+      if (g_config->power_saving && m_unchanged_frames >= IDLE_FRAMES) {
+        // nothing changed on screen for a while, sleep until input
+        // arrives or a few steps have passed
+        SDL_WaitEventTimeout(nullptr, static_cast<int>((us_per_step * IDLE_STEPS - due_us) / 1000));
+      } else if (!precise) {
+        SDL_Delay(static_cast<Uint32>(remaining_us / 1000));
+      } else if (remaining_us > SPIN_US) {
+        // SDL_Delay() may oversleep by a millisecond or two, leave
+        // the rest of the wait to the spinning below
+        SDL_Delay(static_cast<Uint32>((remaining_us - SPIN_US) / 1000));
+      } else {
+        // spin, but let other threads have the core
+        std::this_thread::yield();
+      }
       continue;
     }
 
-    g_real_time = static_cast<float>(ticks) / 1000.0f;
+    g_real_time = static_cast<float>(now) / 1000000.0f;
+
+    if (g_config->developer_mode && TextureManager::current()) {
+      TextureManager::current()->reload_changed_images(g_real_time);
+    }
+
+    // a frame lasts until the next one starts, so it includes the
+    // sleeping before the next step as well
+    g_profiler.set_enabled(g_debug.show_profiler || g_profiler.is_tracing() ||
+                           g_config->hitch_threshold_ms > 0);
+    g_profiler.begin_frame();
+    g_object_stats.begin_frame();
+
+    // the zones of the slow frame are complete only now
+    if (hitch_us > 0) {
+      log_hitch(hitch_us);
+      hitch_us = 0;
+    }
 
     float speed_multiplier = 1.0f / g_debug.get_game_speed_multiplier();
-    int steps = elapsed_ticks / ms_per_step;
+    int steps = static_cast<int>(std::max<Sint64>(due_us, 0) / us_per_step);
 
     // Do not calculate more than a few steps at once
     // The maximum number of steps executed before drawing a frame is
@@ -514,23 +1033,89 @@ ScreenManager::run()
       // end sequence and debugging, dtime can be changed.
       float dtime = seconds_per_step * m_speed * speed_multiplier;
       g_game_time += dtime;
-      process_events();
+      g_render_time = g_game_time;
+      g_step_stats.begin_step();
+      {
+        Profiler::Scope profile_scope("events");
+
+        // catching up steps get the input of their own time slot, the
+        // last one everything, so no input waits for the next frame
+        m_event_queue.poll(get_time_us(precise));
+        const uint64_t until_us = (i + 1 < steps) ?
+          static_cast<uint64_t>(static_cast<Sint64>(now) - elapsed_us + us_per_step) :
+          std::numeric_limits<uint64_t>::max();
+
+        const uint64_t step_press_us = process_events(until_us);
+        if (press_us == 0) {
+          press_us = step_press_us;
+        }
+      }
       update_gamelogic(dtime);
-      elapsed_ticks -= ms_per_step;
+      elapsed_us -= us_per_step;
     }
 
-    if ((steps > 0 && !m_screen_stack.empty())
+    if (((steps > 0 || interpolate) && !m_screen_stack.empty())
         || g_debug.draw_redundant_frames) {
-      // Draw a frame
-      Compositor compositor(m_video_system);
-      draw(compositor, fps_statistics);
-      fps_statistics.report_frame();
+      if (interpolate) {
+        // draw between the previous and the latest step, the time
+        // since that step decides how far
+        g_render_alpha = std::min(static_cast<float>(std::max<Sint64>(elapsed_us + lead_us, 0)) /
+                                  static_cast<float>(us_per_step), 1.0f);
+        g_render_time = g_game_time - (1.0f - g_render_alpha) * seconds_per_step * m_speed * speed_multiplier;
+      } else {
+        g_render_alpha = 1.0f;
+        g_render_time = g_game_time;
+      }
+      last_draw_time = now;
+
+      // Draw a frame, the previous one has to reach the screen first
+      present();
+      const Uint64 draw_start = get_time_us(precise);
+      Compositor compositor(m_video_system, m_frame_arena);
+      StepStats::Scope stats_scope(g_step_stats, StepStats::DRAW);
+      Profiler::Scope profile_scope("draw");
+      if (capture) {
+        // one captured frame per drawn frame, so nothing gets skipped
+        capture->add_frame(m_video_system);
+        m_force_redraw = true;
+      }
+
+      if (draw(compositor, fps_statistics)) {
+        flip_pending = g_config->deferred_flip;
+        if (flip_pending) {
+          shown_press_us = press_us;
+        } else {
+          report_latency(press_us);
+        }
+
+        // includes the time the swap blocked for vsync, unless deferred
+        const Sint64 draw_us = static_cast<Sint64>(get_time_us(precise) - draw_start);
+        present_us = (present_us * 7 + draw_us) / 8;
+        fps_statistics.report_frame(static_cast<int>(draw_us));
+
+        if (g_config->hitch_threshold_ms > 0 &&
+            fps_statistics.get_last_frame_us() > g_config->hitch_threshold_ms * 1000) {
+          hitch_us = fps_statistics.get_last_frame_us();
+        }
+      }
+      // a press changing nothing on screen has no latency to measure
+      press_us = 0;
     }
 
-    SoundManager::current()->update();
+    {
+      Profiler::Scope profile_scope("sound");
+      SoundManager::current()->update();
+    }
 
     handle_screen_switch();
   }
+  present();
+
+  if (benchmark) {
+    g_step_stats.write_report(std::cout);
+  }
+
+  g_profiler.close_trace();
 }
 
 /* EOF */
@@ -19,10 +19,14 @@
 #define HEADER_SUPERTUX_SUPERTUX_SCREEN_MANAGER_HPP
 
 #include <memory>
+#include <stdint.h>
+#include <string>
 
 #include "squirrel/squirrel_thread_queue.hpp"
+#include "supertux/event_queue.hpp"
 #include "supertux/screen.hpp"
 #include "util/currenton.hpp"
+#include "video/frame_arena.hpp"
 
 class Compositor;
 class ControllerHUD;
@@ -56,10 +60,22 @@ public:
 private:
   struct FPS_Stats;
   void draw_fps(DrawingContext& context, FPS_Stats& fps_statistics);
+  void draw_render_stats(DrawingContext& context);
+  void draw_profiler(DrawingContext& context);
+  void draw_object_stats(DrawingContext& context);
+  void draw_memory_stats(DrawingContext& context);
   void draw_player_pos(DrawingContext& context);
-  void draw(Compositor& compositor, FPS_Stats& fps_statistics);
+  /** Logs the zones of the previous profiler frame and the files
+      loaded during it, see Config::hitch_threshold_ms */
+  void log_hitch(int frame_us);
+  /** Returns false if the frame was identical to the previous one
+      and power saving skipped rendering it */
+  bool draw(Compositor& compositor, FPS_Stats& fps_statistics);
   void update_gamelogic(float dt_sec);
-  void process_events();
+  /** Handles the queued events that arrived until until_us, returns
+      the arrival time of the oldest key or button press among them,
+      0 if there was none */
+  uint64_t process_events(uint64_t until_us);
   void handle_screen_switch();
 
 private:
@@ -68,6 +84,10 @@ private:
   std::unique_ptr<MenuStorage> m_menu_storage;
   std::unique_ptr<MenuManager> m_menu_manager;
   std::unique_ptr<ControllerHUD> m_controller_hud;
+  EventQueue m_event_queue;
+
+  /** Request memory of the frames, kept from one to the next */
+  FrameArena m_frame_arena;
 
   float m_speed;
   struct Action
@@ -87,6 +107,15 @@ private:
 
   std::unique_ptr<ScreenFade> m_screen_fade;
   std::vector<std::unique_ptr<Screen> > m_screen_stack;
+
+  /** Power saving mode, see Config::power_saving */
+  uint64_t m_frame_hash;
+  int m_unchanged_frames;
+  bool m_force_redraw;
+
+  /** Report of MemoryStats and the g_real_time it was collected at */
+  std::string m_memory_stats;
+  float m_memory_stats_time;
 };
 
 #endif
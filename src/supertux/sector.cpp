@@ -28,16 +28,22 @@
 #include "math/rect.hpp"
 #include "object/ambient_light.hpp"
 #include "object/background.hpp"
+#include "object/bouncy_coin_system.hpp"
 #include "object/bullet.hpp"
 #include "object/camera.hpp"
+#include "object/coin.hpp"
 #include "object/display_effect.hpp"
 #include "object/gradient.hpp"
 #include "object/music_object.hpp"
+#include "object/particles.hpp"
+#include "object/particlesystem.hpp"
+#include "object/particlesystem_interactive.hpp"
 #include "object/player.hpp"
 #include "object/portable.hpp"
 #include "object/pulsing_light.hpp"
 #include "object/smoke_cloud.hpp"
 #include "object/spawnpoint.hpp"
+#include "object/sprite_particle.hpp"
 #include "object/text_array_object.hpp"
 #include "object/text_object.hpp"
 #include "object/tilemap.hpp"
@@ -45,15 +51,23 @@
 #include "physfs/ifile_stream.hpp"
 #include "scripting/sector.hpp"
 #include "squirrel/squirrel_environment.hpp"
+#include "supertux/activity_manager.hpp"
 #include "supertux/constants.hpp"
 #include "supertux/debug.hpp"
 #include "supertux/game_object_factory.hpp"
 #include "supertux/game_session.hpp"
+#include "supertux/gameconfig.hpp"
+#include "supertux/globals.hpp"
 #include "supertux/level.hpp"
+#include "supertux/load_stats.hpp"
 #include "supertux/player_status_hud.hpp"
 #include "supertux/savegame.hpp"
+#include "supertux/step_stats.hpp"
 #include "supertux/tile.hpp"
 #include "util/file_system.hpp"
+#include "util/fnv_hash.hpp"
+#include "util/job_system.hpp"
+#include "util/profiler.hpp"
 #include "util/writer.hpp"
 #include "video/video_system.hpp"
 #include "video/viewport.hpp"
@@ -64,6 +78,10 @@ namespace {
 
 PlayerStatus dummy_player_status;
 
+/** BadGuy::is_offscreen() activates badguys within 1280x800 of the camera
+    center or a player, plus slack for what moves during one step */
+const Vector ACTIVE_DISTANCE(1280.0f + 128.0f, 800.0f + 128.0f);
+
 } // namespace
 
 Sector::Sector(Level& parent) :
@@ -74,8 +92,24 @@ Sector::Sector(Level& parent) :
   m_foremost_layer(),
   m_squirrel_environment(new SquirrelEnvironment(SquirrelVirtualMachine::current()->get_vm(), "sector")),
   m_collision_system(new CollisionSystem(*this)),
+  m_activity(new ActivityManager),
+  m_ai_queries(),
+  m_particle_systems(),
+  m_last_update_time(-1.0f),
   m_gravity(10.0)
 {
+  set_activity_manager(m_activity.get());
+
+  // most named objects are never used by a script, so they only get a
+  // squirrel instance on their first lookup
+  m_squirrel_environment->enable_lazy_exposure(*this);
+
+  // plentiful objects whose update doesn't depend on anything else
+  add_batched_update<Coin>();
+  add_batched_update<Particles>();
+  add_batched_update<SmokeCloud>();
+  add_batched_update<SpriteParticle>();
+
   Savegame* savegame = (Editor::current() && Editor::is_active()) ?
     Editor::current()->m_savegame.get() :
     GameSession::current() ? &GameSession::current()->get_savegame() : nullptr;
@@ -86,6 +120,7 @@ Sector::Sector(Level& parent) :
   }
   add<Player>(player_status, "Tux");
   add<DisplayEffect>("Effect");
+  add<BouncyCoinSystem>();
   add<TextObject>("Text");
   add<TextArrayObject>("TextArray");
 
@@ -109,6 +144,8 @@ Sector::~Sector()
 void
 Sector::finish_construction(bool editable)
 {
+  LoadStats::Scope load_scope(LoadStats::FINISH);
+
   flush_game_objects();
 
   if (!editable) {
@@ -170,14 +207,7 @@ Sector::get_level() const
 void
 Sector::activate(const std::string& spawnpoint)
 {
-  SpawnPointMarker* sp = nullptr;
-  for (auto& spawn_point : get_objects_by_type<SpawnPointMarker>()) {
-    if (spawn_point.get_name() == spawnpoint) {
-      sp = &spawn_point;
-      break;
-    }
-  }
-
+  SpawnPointMarker* sp = get_spawnpoint(spawnpoint);
   if (!sp) {
     log_warning << "Spawnpoint '" << spawnpoint << "' not found." << std::endl;
     if (spawnpoint != "main") {
@@ -190,6 +220,39 @@ Sector::activate(const std::string& spawnpoint)
   }
 }
 
+SpawnPointMarker*
+Sector::get_spawnpoint(const std::string& name)
+{
+  for (auto& spawn_point : get_objects_by_type<SpawnPointMarker>()) {
+    if (spawn_point.get_name() == name) {
+      return &spawn_point;
+    }
+  }
+  return nullptr;
+}
+
+void
+Sector::prepare_activation(const std::string& spawnpoint)
+{
+  if (s_current == this)
+    return;
+
+  SpawnPointMarker* sp = get_spawnpoint(spawnpoint);
+  if (!sp)
+    sp = get_spawnpoint("main");
+  if (!sp)
+    return;
+
+  // about where the camera will end up, the chunks are only a cache
+  const Sizef view(static_cast<float>(SCREEN_WIDTH), static_cast<float>(SCREEN_HEIGHT));
+  const Rectf rect(sp->get_pos() - Vector(view.width / 2.0f, view.height / 2.0f), view);
+  for (auto& tilemap : get_objects_by_type<TileMap>()) {
+    if (tilemap.get_alpha() != 0.0f) {
+      tilemap.prebake_chunks(rect);
+    }
+  }
+}
+
 void
 Sector::activate(const Vector& player_pos)
 {
@@ -283,11 +346,11 @@ Sector::deactivate()
 Rectf
 Sector::get_active_region() const
 {
-  Camera& camera = get_camera();
+  const Vector& translation = get_camera().get_view_state().translation;
   return Rectf(
-    camera.get_translation() - Vector(1600, 1200),
-    camera.get_translation() + Vector(1600, 1200) + Vector(static_cast<float>(SCREEN_WIDTH),
-                                                           static_cast<float>(SCREEN_HEIGHT)));
+    translation - Vector(1600, 1200),
+    translation + Vector(1600, 1200) + Vector(static_cast<float>(SCREEN_WIDTH),
+                                              static_cast<float>(SCREEN_HEIGHT)));
 }
 
 int
@@ -324,13 +387,87 @@ Sector::update(float dt_sec)
   assert(m_fully_constructed);
 
   BIND_SECTOR(*this);
+  Profiler::Scope profile_scope("sector");
 
-  m_squirrel_environment->update(dt_sec);
+  if (g_config->render_interpolation) {
+    m_collision_system->store_previous_positions();
+  }
+  m_last_update_time = g_game_time;
+
+  {
+    StepStats::Scope stats_scope(g_step_stats, StepStats::SCRIPTING);
+    Profiler::Scope scripts_scope("scripts");
+    m_squirrel_environment->update(dt_sec);
+  }
+
+  { // dormant objects only need updates near the camera and the players
+    std::vector<Rectf> regions;
+    const Vector& camera_center = get_camera().get_view_state().center;
+    regions.push_back(Rectf(camera_center - ACTIVE_DISTANCE,
+                            camera_center + ACTIVE_DISTANCE));
+    for (const auto& player : get_objects_by_type<Player>()) {
+      const Vector center = player.get_bbox().get_middle();
+      regions.push_back(Rectf(center - ACTIVE_DISTANCE, center + ACTIVE_DISTANCE));
+    }
+    m_activity->set_active_regions(regions);
+  }
+
+  {
+    Profiler::Scope objects_scope("objects");
+    m_ai_queries.clear();
+    GameObjectManager::update(dt_sec);
+    m_ai_queries.clear();
+  }
+
+  { // particle systems only move their own particles, so they don't
+    // have to wait for the collisions, without a JobSystem draw()
+    // runs them
+    JobSystem* job_system = JobSystem::current();
+    std::vector<JobSystem::Handle> simulations;
+    if (job_system) {
+      for (auto* particle_system : m_particle_systems) {
+        // interactive ones read the solid tilemaps, which collision
+        // callbacks may change, they are started after the collisions
+        if (dynamic_cast<ParticleSystem_Interactive*>(particle_system))
+          continue;
+
+        simulations.push_back(job_system->schedule([particle_system] {
+              particle_system->run_simulation();
+            }));
+      }
+    }
+
+    try
+    {
+      /* Handle all possible collisions. */
+      StepStats::Scope stats_scope(g_step_stats, StepStats::COLLISION);
+      m_collision_system->update();
+    }
+    catch(...)
+    {
+      for (const auto& simulation : simulations) {
+        try { job_system->wait(simulation); } catch(...) {}
+      }
+      throw;
+    }
 
-  GameObjectManager::update(dt_sec);
+    if (job_system) {
+      for (auto* particle_system : m_particle_systems) {
+        if (!dynamic_cast<ParticleSystem_Interactive*>(particle_system))
+          continue;
+
+        simulations.push_back(job_system->schedule([particle_system] {
+              particle_system->run_simulation();
+            }));
+      }
+    }
+
+    // join before anything gets removed or drawn
+    for (const auto& simulation : simulations) {
+      job_system->wait(simulation);
+    }
+  }
 
-  /* Handle all possible collisions. */
-  m_collision_system->update();
   flush_game_objects();
 }
 
@@ -353,6 +490,12 @@ Sector::before_object_add(GameObject& object)
     m_collision_system->add(movingobject->get_collision_object());
   }
 
+  auto particle_system = dynamic_cast<ParticleSystem*>(&object);
+  if (particle_system)
+  {
+    m_particle_systems.push_back(particle_system);
+  }
+
   if (s_current == this) {
     m_squirrel_environment->try_expose(object);
   }
@@ -369,11 +512,18 @@ Sector::before_object_add(GameObject& object)
 void
 Sector::before_object_remove(GameObject& object)
 {
+  m_activity->resume(object);
+
   auto moving_object = dynamic_cast<MovingObject*>(&object);
   if (moving_object) {
     m_collision_system->remove(moving_object->get_collision_object());
   }
 
+  auto particle_system = dynamic_cast<ParticleSystem*>(&object);
+  if (particle_system) {
+    m_particle_systems.erase(std::find(m_particle_systems.begin(), m_particle_systems.end(), particle_system));
+  }
+
   if (s_current == this)
     m_squirrel_environment->try_unexpose(object);
 }
@@ -385,8 +535,18 @@ Sector::draw(DrawingContext& context)
 
   Camera& camera = get_camera();
 
+  // a paused or inactive sector is drawn as it is
+  const bool interpolate = g_render_alpha < 1.0f &&
+                           m_last_update_time == g_game_time &&
+                           !Editor::is_active();
+
   context.push_transform();
-  context.set_translation(camera.get_translation());
+  if (interpolate) {
+    context.set_translation(camera.get_interpolated_translation(g_render_alpha));
+    m_collision_system->begin_interpolation(g_render_alpha);
+  } else {
+    context.set_translation(camera.get_translation());
+  }
 
   GameObjectManager::draw(context);
 
@@ -394,6 +554,10 @@ Sector::draw(DrawingContext& context)
     m_collision_system->draw(context);
   }
 
+  if (interpolate) {
+    m_collision_system->end_interpolation();
+  }
+
   context.pop_transform();
 }
 
@@ -430,12 +594,23 @@ Sector::can_see_player(const Vector& eye) const
 {
   for (auto player_ptr : get_objects_by_type_index(typeid(Player))) {
     Player& player = *static_cast<Player*>(player_ptr);
-    // test for free line of sight to any of all four corners and the middle of the player's bounding box
-    if (free_line_of_sight(eye, player.get_bbox().p1(), &player)) return true;
-    if (free_line_of_sight(eye, Vector(player.get_bbox().get_right(), player.get_bbox().get_top()), &player)) return true;
-    if (free_line_of_sight(eye, player.get_bbox().p2(), &player)) return true;
-    if (free_line_of_sight(eye, Vector(player.get_bbox().get_left(), player.get_bbox().get_bottom()), &player)) return true;
-    if (free_line_of_sight(eye, player.get_bbox().get_middle(), &player)) return true;
+
+    bool visible;
+    if (!m_ai_queries.find_line_of_sight(eye, &player, visible))
+    {
+      // test for free line of sight to any of all four corners and the middle of the player's bounding box
+      const Rectf& bbox = player.get_bbox();
+      visible =
+        free_line_of_sight(eye, bbox.p1(), &player) ||
+        free_line_of_sight(eye, Vector(bbox.get_right(), bbox.get_top()), &player) ||
+        free_line_of_sight(eye, bbox.p2(), &player) ||
+        free_line_of_sight(eye, Vector(bbox.get_left(), bbox.get_bottom()), &player) ||
+        free_line_of_sight(eye, bbox.get_middle(), &player);
+      m_ai_queries.add_line_of_sight(eye, &player, visible);
+    }
+
+    if (visible)
+      return true;
   }
   return false;
 }
@@ -504,6 +679,14 @@ Sector::change_solid_tiles(uint32_t old_tile_id, uint32_t new_tile_id)
   }
 }
 
+void
+Sector::change_solid_tiles(const std::vector<std::pair<uint32_t, uint32_t> >& changes)
+{
+  for (auto& solids: get_solid_tilemaps()) {
+    solids->change_all(changes);
+  }
+}
+
 void
 Sector::set_gravity(float gravity)
 {
@@ -524,10 +707,19 @@ Sector::get_gravity() const
 Player*
 Sector::get_nearest_player (const Vector& pos) const
 {
+  const auto& players = get_objects_by_type_index(typeid(Player));
+
+  // the usual case, no distances needed
+  if (players.size() == 1)
+  {
+    Player* player = static_cast<Player*>(players.front());
+    return (player->is_dying() || player->is_dead()) ? nullptr : player;
+  }
+
   Player *nearest_player = nullptr;
   float nearest_dist = std::numeric_limits<float>::max();
 
-  for (auto player_ptr : get_objects_by_type_index(typeid(Player)))
+  for (auto player_ptr : players)
   {
     Player& player = *static_cast<Player*>(player_ptr);
     if (player.is_dying() || player.is_dead())
@@ -691,10 +883,44 @@ Sector::get_player() const
   return *static_cast<Player*>(get_objects_by_type_index(typeid(Player)).at(0));
 }
 
+BouncyCoinSystem&
+Sector::get_bouncy_coins() const
+{
+  return get_singleton_by_type<BouncyCoinSystem>();
+}
+
 DisplayEffect&
 Sector::get_effect() const
 {
   return get_singleton_by_type<DisplayEffect>();
 }
 
+uint64_t
+Sector::get_state_hash() const
+{
+  FNVHash hash;
+  for (const auto& object : get_objects())
+  {
+    const auto moving_object = dynamic_cast<const MovingObject*>(object.get());
+    if (!moving_object || !moving_object->is_valid())
+      continue;
+
+    const Rectf& bbox = moving_object->get_bbox();
+    hash.add(bbox.get_left());
+    hash.add(bbox.get_top());
+    hash.add(bbox.get_right());
+    hash.add(bbox.get_bottom());
+    hash.add(moving_object->get_movement().x);
+    hash.add(moving_object->get_movement().y);
+  }
+
+  const Physic& physic = get_player().get_physic();
+  hash.add(physic.get_velocity_x());
+  hash.add(physic.get_velocity_y());
+  hash.add(physic.get_acceleration_x());
+  hash.add(physic.get_acceleration_y());
+  hash.add(physic.gravity_enabled());
+  return hash.get();
+}
+
 /* EOF */
@@ -22,6 +22,7 @@
 
 #include "math/anchor_point.hpp"
 #include "squirrel/squirrel_environment.hpp"
+#include "supertux/ai_query_cache.hpp"
 #include "supertux/d_scope.hpp"
 #include "supertux/game_object_manager.hpp"
 #include "video/color.hpp"
@@ -30,16 +31,20 @@ namespace collision {
 class Constraints;
 }
 
+class ActivityManager;
+class BouncyCoinSystem;
 class Camera;
 class CollisionSystem;
 class DisplayEffect;
 class DrawingContext;
 class Level;
 class MovingObject;
+class ParticleSystem;
 class Player;
 class ReaderMapping;
 class Rectf;
 class Size;
+class SpawnPointMarker;
 class TileMap;
 class Vector;
 class Writer;
@@ -75,6 +80,12 @@ public:
   void activate(const Vector& player_pos);
   void deactivate();
 
+  /** Warms up the static tile cache of the view around the spawnpoint
+      a little, to be called every frame while a transition into this
+      sector is running, so the first frame after activate() doesn't
+      have to build it all at once */
+  void prepare_activation(const std::string& spawnpoint);
+
   void update(float dt_sec);
 
   void draw(DrawingContext& context);
@@ -133,6 +144,9 @@ public:
   /** globally changes solid tilemaps' tile ids */
   void change_solid_tiles(uint32_t old_tile_id, uint32_t new_tile_id);
 
+  /** Applies several changes in order, see TileMap::change_all() */
+  void change_solid_tiles(const std::vector<std::pair<uint32_t, uint32_t> >& changes);
+
   /** set gravity throughout sector */
   void set_gravity(float gravity);
   float get_gravity() const;
@@ -146,6 +160,14 @@ public:
   Camera& get_camera() const;
   Player& get_player() const;
   DisplayEffect& get_effect() const;
+  BouncyCoinSystem& get_bouncy_coins() const;
+
+  /** Hash over the bboxes and movement of all MovingObjects and the
+      physics of the player, demo playback compares it against the
+      recording to find where the simulation diverged */
+  uint64_t get_state_hash() const;
+
+  CollisionSystem& get_collision_system() const { return *m_collision_system; }
 
 private:
   uint32_t collision_tile_attributes(const Rectf& dest, const Vector& mov) const;
@@ -155,6 +177,8 @@ private:
 
   int calculate_foremost_layer() const;
 
+  SpawnPointMarker* get_spawnpoint(const std::string& name);
+
   /** Convert tiles into their corresponding GameObjects (e.g.
       bonusblocks, add light to lava tiles) */
   void convert_tiles2gameobject();
@@ -173,6 +197,17 @@ private:
 
   std::unique_ptr<SquirrelEnvironment> m_squirrel_environment;
   std::unique_ptr<CollisionSystem> m_collision_system;
+  std::unique_ptr<ActivityManager> m_activity;
+
+  /** Only valid while the objects update, see AIQueryCache */
+  mutable AIQueryCache m_ai_queries;
+
+  /** simulated on worker threads while collisions are handled */
+  std::vector<ParticleSystem*> m_particle_systems;
+
+  /** g_game_time of the last update(), positions are only
+      interpolated if that was the most recent logic step */
+  float m_last_update_time;
 
   float m_gravity;
 
@@ -17,7 +17,6 @@
 #include "supertux/sector_parser.hpp"
 
 #include <iostream>
-#include <physfs.h>
 #include <sexp/value.hpp>
 
 #include "badguy/jumpy.hpp"
@@ -33,8 +32,10 @@
 #include "object/snow_particle_system.hpp"
 #include "object/spawnpoint.hpp"
 #include "object/tilemap.hpp"
+#include "physfs/util.hpp"
 #include "supertux/game_object_factory.hpp"
 #include "supertux/level.hpp"
+#include "supertux/load_stats.hpp"
 #include "supertux/sector.hpp"
 #include "supertux/tile.hpp"
 #include "supertux/tile_manager.hpp"
@@ -85,6 +86,8 @@ SectorParser::parse_object(const std::string& name_, const ReaderMapping& reader
   if (name_ == "money") { // for compatibility with old maps
     return std::make_unique<Jumpy>(reader);
   } else {
+    LoadStats::Scope load_scope(LoadStats::OBJECTS);
+    g_load_stats.add_object();
     try {
       return GameObjectFactory::instance().create(name_, reader);
     } catch(std::exception& e) {
@@ -97,6 +100,18 @@ SectorParser::parse_object(const std::string& name_, const ReaderMapping& reader
 void
 SectorParser::parse(const ReaderMapping& sector)
 {
+  LoadStats::Scope load_scope(LoadStats::SECTORS);
+
+  // TODO: objects are all created up front, unlike the decoration
+  // tiles of binary levels, see TileMap::LazyTiles. Streaming them by
+  // chunk around the camera needs their records split by position in
+  // the container and objects with state saved when their chunk
+  // unloads, without breaking names and UIDs scripts refer to.
+
+  // nearly every entry of the sector becomes an object
+  const auto& entries = sector.get_sexp().as_array();
+  m_sector.reserve_objects(entries.empty() ? 0 : entries.size() - 1);
+
   auto iter = sector.get_iter();
   while (iter.next()) {
     if (iter.get_key() == "name") {
@@ -164,7 +179,7 @@ SectorParser::parse_old_format(const ReaderMapping& reader)
     if (backgroundimage == "arctis2.jpg") backgroundimage = "arctis.jpg";
     if (backgroundimage == "ocean.png") backgroundimage = "ocean.jpg";
     backgroundimage = "images/background/" + backgroundimage;
-    if (!PHYSFS_exists(backgroundimage.c_str())) {
+    if (!physfsutil::exists_cached(backgroundimage)) {
       log_warning << "Background image \"" << backgroundimage << "\" not found. Ignoring." << std::endl;
       backgroundimage = "";
     }
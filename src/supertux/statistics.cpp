@@ -306,9 +306,10 @@ Statistics::init(const Level& level)
   m_badguys = 0;
   m_secrets = 0;
 
-  m_total_coins = level.get_total_coins();
-  m_total_badguys = level.get_total_badguys();
-  m_total_secrets = level.get_total_secrets();
+  const Level::Totals totals = level.count_totals();
+  m_total_coins = totals.coins;
+  m_total_badguys = totals.badguys;
+  m_total_secrets = totals.secrets;
 }
 
 void
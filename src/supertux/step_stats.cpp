@@ -0,0 +1,147 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "supertux/step_stats.hpp"
+
+#include <algorithm>
+#include <stdio.h>
+
+StepStats g_step_stats;
+
+StepStats::Scope::Scope(StepStats& stats, Subsystem subsystem) :
+  m_stats(stats),
+  m_subsystem(subsystem),
+  m_start()
+{
+  if (m_stats.is_enabled()) {
+    m_start = std::chrono::steady_clock::now();
+  }
+}
+
+StepStats::Scope::~Scope()
+{
+  if (m_stats.is_enabled()) {
+    const auto duration = std::chrono::steady_clock::now() - m_start;
+    m_stats.add(m_subsystem, std::chrono::duration<float, std::milli>(duration).count());
+  }
+}
+
+StepStats::StepStats() :
+  m_enabled(false),
+  m_steps()
+{
+}
+
+void
+StepStats::begin_step()
+{
+  if (!m_enabled)
+    return;
+
+  m_steps.emplace_back();
+  m_steps.back().fill(0.0f);
+}
+
+void
+StepStats::add(Subsystem subsystem, float ms)
+{
+  if (!m_enabled || m_steps.empty())
+    return;
+
+  m_steps.back()[subsystem] += ms;
+}
+
+float
+StepStats::get_percentile(Subsystem subsystem, float percentile) const
+{
+  if (m_steps.empty())
+    return 0.0f;
+
+  std::vector<float> times;
+  times.reserve(m_steps.size());
+  for (const auto& step : m_steps) {
+    times.push_back(step[subsystem]);
+  }
+  return percentile_of(times, percentile);
+}
+
+float
+StepStats::get_frame_percentile(float percentile) const
+{
+  if (m_steps.empty())
+    return 0.0f;
+
+  // collision and scripting are measured within the update
+  std::vector<float> times;
+  times.reserve(m_steps.size());
+  for (const auto& step : m_steps) {
+    times.push_back(step[UPDATE] + step[DRAW]);
+  }
+  return percentile_of(times, percentile);
+}
+
+float
+StepStats::percentile_of(std::vector<float>& times, float percentile)
+{
+  const size_t idx = std::min(times.size() - 1,
+                              static_cast<size_t>(percentile * static_cast<float>(times.size())));
+  std::nth_element(times.begin(), times.begin() + idx, times.end());
+  return times[idx];
+}
+
+void
+StepStats::write_report(std::ostream& out) const
+{
+  char line[120];
+  snprintf(line, sizeof(line), "%zu steps\n%-10s %8s %8s %8s %8s  (ms)\n",
+           m_steps.size(), "", "50%", "95%", "99%", "max");
+  out << line;
+
+  snprintf(line, sizeof(line), "%-10s %8.3f %8.3f %8.3f %8.3f\n",
+           "frame",
+           static_cast<double>(get_frame_percentile(0.5f)),
+           static_cast<double>(get_frame_percentile(0.95f)),
+           static_cast<double>(get_frame_percentile(0.99f)),
+           static_cast<double>(get_frame_percentile(1.0f)));
+  out << line;
+
+  for (int i = 0; i < NUM_SUBSYSTEMS; ++i)
+  {
+    const auto subsystem = static_cast<Subsystem>(i);
+    snprintf(line, sizeof(line), "%-10s %8.3f %8.3f %8.3f %8.3f\n",
+             get_name(subsystem),
+             static_cast<double>(get_percentile(subsystem, 0.5f)),
+             static_cast<double>(get_percentile(subsystem, 0.95f)),
+             static_cast<double>(get_percentile(subsystem, 0.99f)),
+             static_cast<double>(get_percentile(subsystem, 1.0f)));
+    out << line;
+  }
+}
+
+const char*
+StepStats::get_name(Subsystem subsystem)
+{
+  switch (subsystem)
+  {
+    case UPDATE: return "update";
+    case COLLISION: return "collision";
+    case SCRIPTING: return "scripting";
+    case DRAW: return "draw";
+    default: return "unknown";
+  }
+}
+
+/* EOF */
@@ -0,0 +1,99 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_SUPERTUX_STEP_STATS_HPP
+#define HEADER_SUPERTUX_SUPERTUX_STEP_STATS_HPP
+
+#include <array>
+#include <chrono>
+#include <ostream>
+#include <vector>
+
+/** Time spent per subsystem in every logical step, recorded for
+    demo benchmarks. Recording only happens while enabled, otherwise
+    all calls return right away. */
+class StepStats final
+{
+public:
+  enum Subsystem {
+    UPDATE,
+    COLLISION,
+    SCRIPTING,
+    DRAW,
+    NUM_SUBSYSTEMS
+  };
+
+  /** Adds the lifetime of the scope to the current step */
+  class Scope final
+  {
+  public:
+    Scope(StepStats& stats, Subsystem subsystem);
+    ~Scope();
+
+  private:
+    StepStats& m_stats;
+    Subsystem m_subsystem;
+    std::chrono::steady_clock::time_point m_start;
+
+  private:
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+public:
+  StepStats();
+
+  void set_enabled(bool enabled) { m_enabled = enabled; }
+  bool is_enabled() const { return m_enabled; }
+
+  /** Starts recording a new step */
+  void begin_step();
+
+  void add(Subsystem subsystem, float ms);
+
+  size_t get_step_count() const { return m_steps.size(); }
+
+  /** Returns the given percentile (0 to 1) of the step times of the
+      subsystem, in ms */
+  float get_percentile(Subsystem subsystem, float percentile) const;
+
+  /** Like get_percentile(), but for the whole step, the update plus
+      the draw */
+  float get_frame_percentile(float percentile) const;
+
+  /** Writes a table of percentiles for the whole step and per
+      subsystem */
+  void write_report(std::ostream& out) const;
+
+  static const char* get_name(Subsystem subsystem);
+
+private:
+  static float percentile_of(std::vector<float>& times, float percentile);
+
+private:
+  bool m_enabled;
+  std::vector<std::array<float, NUM_SUBSYSTEMS> > m_steps;
+
+private:
+  StepStats(const StepStats&) = delete;
+  StepStats& operator=(const StepStats&) = delete;
+};
+
+extern StepStats g_step_stats;
+
+#endif
+
+/* EOF */
@@ -42,9 +42,26 @@ bool is_below_line (float l_x, float l_y, float m,
   return !is_above_line (l_x, l_y, m, p_x, p_y);
 }
 
+std::vector<SurfacePtr> load_specs(const std::vector<Tile::ImageSpec>& specs)
+{
+  std::vector<SurfacePtr> surfaces;
+  surfaces.reserve(specs.size());
+  for (const auto& spec : specs)
+  {
+    SurfacePtr surface = spec.surface ? spec.surface : Surface::from_file(spec.file, spec.rect);
+    if (spec.region) {
+      surface = surface->region(*spec.region);
+    }
+    surfaces.push_back(surface);
+  }
+  return surfaces;
+}
+
 } // namespace
 
 Tile::Tile() :
+  m_image_specs(),
+  m_editor_image_specs(),
   m_images(),
   m_editor_images(),
   m_attributes(0),
@@ -56,14 +73,16 @@ Tile::Tile() :
 {
 }
 
-Tile::Tile(const std::vector<SurfacePtr>& images,
-           const std::vector<SurfacePtr>& editor_images,
+Tile::Tile(const std::vector<ImageSpec>& images,
+           const std::vector<ImageSpec>& editor_images,
            uint32_t attributes, uint32_t data, float fps,
            const std::string& obj_name,
            const std::string& obj_data,
            bool deprecated) :
-  m_images(images),
-  m_editor_images(editor_images),
+  m_image_specs(images),
+  m_editor_image_specs(editor_images),
+  m_images(),
+  m_editor_images(),
   m_attributes(attributes),
   m_data(data),
   m_fps(fps),
@@ -73,9 +92,38 @@ Tile::Tile(const std::vector<SurfacePtr>& images,
 {
 }
 
+void
+Tile::load_images() const
+{
+  if (is_loaded())
+    return;
+
+  m_images = load_specs(m_image_specs);
+  m_editor_images = load_specs(m_editor_image_specs);
+
+  m_image_specs.clear();
+  m_image_specs.shrink_to_fit();
+  m_editor_image_specs.clear();
+  m_editor_image_specs.shrink_to_fit();
+}
+
+void
+Tile::get_image_files(std::vector<std::string>& files) const
+{
+  for (const auto* specs : { &m_image_specs, &m_editor_image_specs }) {
+    for (const auto& spec : *specs) {
+      if (!spec.surface) {
+        files.push_back(spec.file);
+      }
+    }
+  }
+}
+
 void
 Tile::draw(Canvas& canvas, const Vector& pos, int z_pos, const Color& color) const
 {
+  load_images();
+
   if (draw_editor_images) {
     if (m_editor_images.size() > 1) {
       size_t frame = size_t(g_game_time * m_fps) % m_editor_images.size();
@@ -205,9 +253,21 @@ Tile::draw_debug(Canvas& canvas, const Vector& pos, int z_pos, const Color& colo
   }
 }
 
+size_t
+Tile::get_memory_usage() const
+{
+  size_t bytes = sizeof(*this);
+  bytes += (m_image_specs.capacity() + m_editor_image_specs.capacity()) * sizeof(ImageSpec);
+  bytes += (m_images.capacity() + m_editor_images.capacity()) * sizeof(SurfacePtr);
+  bytes += m_object_name.capacity() + m_object_data.capacity();
+  return bytes;
+}
+
 SurfacePtr
 Tile::get_current_surface() const
 {
+  load_images();
+
   if (m_images.size() > 1) {
     size_t frame = size_t(g_game_time * m_fps) % m_images.size();
     return m_images[frame];
@@ -221,6 +281,8 @@ Tile::get_current_surface() const
 SurfacePtr
 Tile::get_current_editor_surface() const
 {
+  load_images();
+
   if (m_editor_images.size() > 1) {
     size_t frame = size_t(g_game_time * m_fps) % m_editor_images.size();
     return m_editor_images[frame];
@@ -19,9 +19,12 @@
 #ifndef HEADER_SUPERTUX_SUPERTUX_TILE_HPP
 #define HEADER_SUPERTUX_SUPERTUX_TILE_HPP
 
+#include <string>
 #include <vector>
 #include <stdint.h>
+#include <boost/optional.hpp>
 
+#include "math/rect.hpp"
 #include "math/rectf.hpp"
 #include "video/color.hpp"
 #include "video/surface_ptr.hpp"
@@ -95,10 +98,27 @@ public:
     UNI_DIR_MASK  = 3
   };
 
+  /** A tile image that hasn't been loaded yet */
+  struct ImageSpec
+  {
+    ImageSpec() : file(), rect(), region(), surface() {}
+
+    /** The image file, the part given by rect or all of it */
+    std::string file;
+    boost::optional<Rect> rect;
+
+    /** Part of the above the tile shows, used by shared surfaces so
+        all their tiles use a single texture */
+    boost::optional<Rect> region;
+
+    /** Used instead of the above for images loaded right away */
+    SurfacePtr surface;
+  };
+
 public:
   Tile();
-  Tile(const std::vector<SurfacePtr>& images,
-       const std::vector<SurfacePtr>& editor_images,
+  Tile(const std::vector<ImageSpec>& images,
+       const std::vector<ImageSpec>& editor_images,
        uint32_t attributes, uint32_t data, float fps,
        const std::string& obj_name = "", const std::string& obj_data = "",
        bool deprecated = false);
@@ -108,8 +128,21 @@ public:
   void draw_debug(Canvas& canvas, const Vector& pos, int z_pos, const Color& color = Color(1.0f, 0.f, 1.0f, 0.5f)) const;
 
   SurfacePtr get_current_surface() const;
+
+  /** Loads the images on first use */
+  const std::vector<SurfacePtr>& get_images() const { load_images(); return m_images; }
+  void set_images(const std::vector<SurfacePtr>& images) { load_images(); m_images = images; }
   SurfacePtr get_current_editor_surface() const;
 
+  /** Approximate bytes of CPU memory, not counting the textures */
+  size_t get_memory_usage() const;
+
+  /** Returns true once the images have been loaded */
+  bool is_loaded() const { return m_image_specs.empty() && m_editor_image_specs.empty(); }
+
+  /** Files that load_images() is going to read */
+  void get_image_files(std::vector<std::string>& files) const;
+
   uint32_t get_attributes() const { return m_attributes; }
   int get_data() const { return m_data; }
 
@@ -144,6 +177,8 @@ public:
   const std::string& get_object_data() const { return m_object_data; }
 
 private:
+  void load_images() const;
+
   /** Returns zero if a unisolid tile is non-solid due to the movement
       direction, non-zero if the tile is solid due to direction. */
   bool check_movement_unisolid (const Vector& movement) const;
@@ -154,8 +189,12 @@ private:
                                 const Rectf& tile_bbox) const;
 
 private:
-  std::vector<SurfacePtr> m_images;
-  std::vector<SurfacePtr> m_editor_images;
+  /** Resolved into m_images and m_editor_images on first use */
+  mutable std::vector<ImageSpec> m_image_specs;
+  mutable std::vector<ImageSpec> m_editor_image_specs;
+
+  mutable std::vector<SurfacePtr> m_images;
+  mutable std::vector<SurfacePtr> m_editor_images;
 
   /** tile attributes */
   uint32_t m_attributes;
@@ -17,11 +17,14 @@
 
 #include "supertux/tile_manager.hpp"
 
+#include "supertux/load_stats.hpp"
+#include "util/log.hpp"
 #include "supertux/tile.hpp"
 #include "supertux/tile_set.hpp"
 
 TileManager::TileManager() :
-  m_tilesets()
+  m_tilesets(),
+  m_evicted_count(0)
 {
 }
 
@@ -35,6 +38,11 @@ TileManager::get_tileset(const std::string &filename)
   }
   else
   {
+    // make room before loading, a level switching tilesets doesn't
+    // need both in memory
+    evict_unused();
+
+    LoadStats::Scope load_scope(LoadStats::TILESET);
     auto tileset = TileSet::from_file(filename);
     TileSet* result = tileset.get();
     m_tilesets[filename] = std::move(tileset);
@@ -42,4 +50,44 @@ TileManager::get_tileset(const std::string &filename)
   }
 }
 
+void
+TileManager::evict_unused()
+{
+  for (auto it = m_tilesets.begin(); it != m_tilesets.end(); )
+  {
+    if (it->second->get_user_count() > 0)
+    {
+      ++it;
+    }
+    else
+    {
+      log_debug << "freeing unused tileset " << it->first << std::endl;
+      it = m_tilesets.erase(it);
+      m_evicted_count += 1;
+    }
+  }
+}
+
+size_t
+TileManager::get_memory_usage() const
+{
+  size_t bytes = 0;
+  for (const auto& it : m_tilesets) {
+    bytes += it.second->get_memory_usage();
+  }
+  return bytes;
+}
+
+size_t
+TileManager::get_unused_memory_usage() const
+{
+  size_t bytes = 0;
+  for (const auto& it : m_tilesets) {
+    if (it.second->get_user_count() == 0) {
+      bytes += it.second->get_memory_usage();
+    }
+  }
+  return bytes;
+}
+
 /* EOF */
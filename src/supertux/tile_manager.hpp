@@ -29,11 +29,29 @@ class TileManager final : public Currenton<TileManager>
 {
 private:
   std::map<std::string, std::unique_ptr<TileSet> > m_tilesets;
+  size_t m_evicted_count;
 
 public:
   TileManager();
 
+  /** Returns the cached tileset or loads it. Loading frees the
+      tilesets no TileMap uses anymore, so pointers to them must not
+      be kept around without a TileMap or TileSet::add_user(). */
   TileSet* get_tileset(const std::string &filename);
+
+  /** Frees all tilesets without users */
+  void evict_unused();
+
+  size_t get_tileset_count() const { return m_tilesets.size(); }
+
+  /** Approximate bytes of CPU memory taken by all loaded tilesets */
+  size_t get_memory_usage() const;
+
+  /** Bytes taken by tilesets without users, which go away with the
+      next load */
+  size_t get_unused_memory_usage() const;
+
+  size_t get_evicted_count() const { return m_evicted_count; }
 };
 
 #endif
@@ -16,8 +16,11 @@
 
 #include "supertux/tile_set.hpp"
 
+#include <algorithm>
+
 #include "editor/editor.hpp"
 #include "supertux/autotile_parser.hpp"
+#include "supertux/globals.hpp"
 #include "supertux/resources.hpp"
 #include "supertux/tile.hpp"
 #include "supertux/tile_set_parser.hpp"
@@ -25,6 +28,7 @@
 #include "util/log.hpp"
 #include "video/drawing_context.hpp"
 #include "video/surface.hpp"
+#include "video/texture_manager.hpp"
 
 Tilegroup::Tilegroup() :
   developers_group(),
@@ -49,7 +53,11 @@ TileSet::from_file(const std::string& filename)
 TileSet::TileSet() :
   m_autotilesets(),
   m_tiles(1),
-  m_tilegroups()
+  m_tilegroups(),
+  m_animation_time(-1.0f),
+  m_animation_clock(1),
+  m_animation_frames(),
+  m_users(0)
 {
   m_tiles[0] = std::make_unique<Tile>();
   m_autotilesets = new std::vector<AutotileSet*>();
@@ -92,6 +100,39 @@ TileSet::get(const uint32_t id) const
   }
 }
 
+const SurfacePtr&
+TileSet::get_current_surface(uint32_t id) const
+{
+  if (m_animation_time != g_game_time) {
+    m_animation_time = g_game_time;
+    m_animation_clock += 1;
+  }
+
+  if (m_animation_frames.size() != m_tiles.size()) {
+    m_animation_frames.resize(m_tiles.size());
+  }
+
+  AnimationFrame& frame = m_animation_frames[id < m_tiles.size() ? id : 0];
+  if (frame.clock != m_animation_clock) {
+    frame.surface = get(id).get_current_surface();
+    frame.clock = m_animation_clock;
+  }
+  return frame.surface;
+}
+
+size_t
+TileSet::get_memory_usage() const
+{
+  size_t bytes = sizeof(*this) + m_tiles.capacity() * sizeof(std::unique_ptr<Tile>);
+  bytes += m_animation_frames.capacity() * sizeof(AnimationFrame);
+  for (const auto& tile : m_tiles) {
+    if (tile) {
+      bytes += tile->get_memory_usage();
+    }
+  }
+  return bytes;
+}
+
 AutotileSet*
 TileSet::get_autotileset_from_tile(uint32_t tile_id) const
 {
@@ -154,6 +195,45 @@ TileSet::add_tilegroup(const Tilegroup& tilegroup)
   m_tilegroups.push_back(tilegroup);
 }
 
+void
+TileSet::load_images(const std::vector<uint32_t>& tile_ids)
+{
+  std::vector<Tile*> tiles;
+  std::vector<std::string> files;
+  std::vector<bool> seen(m_tiles.size());
+  for (const auto id : tile_ids)
+  {
+    if (id >= m_tiles.size() || seen[id] || !m_tiles[id] || m_tiles[id]->is_loaded())
+      continue;
+
+    seen[id] = true;
+    tiles.push_back(m_tiles[id].get());
+    tiles.back()->get_image_files(files);
+  }
+
+  if (tiles.empty())
+    return;
+
+  // decode the distinct images in parallel, the tiles share most of them
+  std::sort(files.begin(), files.end());
+  files.erase(std::unique(files.begin(), files.end()), files.end());
+  TextureManager::current()->prefetch(files);
+
+  std::vector<SurfacePtr> surfaces;
+  for (const auto* tile : tiles) {
+    surfaces.insert(surfaces.end(), tile->get_images().begin(), tile->get_images().end());
+  }
+
+  TextureManager::current()->pack(surfaces);
+
+  auto it = surfaces.begin();
+  for (auto* tile : tiles) {
+    const auto end = it + tile->get_images().size();
+    tile->set_images(std::vector<SurfacePtr>(it, end));
+    it = end;
+  }
+}
+
 void
 TileSet::print_debug_info(const std::string& filename)
 {
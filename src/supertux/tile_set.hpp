@@ -17,9 +17,11 @@
 #ifndef HEADER_SUPERTUX_SUPERTUX_TILE_SET_HPP
 #define HEADER_SUPERTUX_SUPERTUX_TILE_SET_HPP
 
+#include <assert.h>
 #include <memory>
 #include <stdint.h>
 #include <string>
+#include <vector>
 
 #include "supertux/autotile.hpp"
 #include "video/color.hpp"
@@ -58,6 +60,11 @@ public:
   void add_tilegroup(const Tilegroup& tilegroup);
 
   const Tile& get(const uint32_t id) const;
+
+  /** Same as get(id).get_current_surface(), but the frame of each
+      tile is only picked once per game time and then shared by every
+      tilemap and every cell drawing it */
+  const SurfacePtr& get_current_surface(uint32_t id) const;
   
   AutotileSet* get_autotileset_from_tile(uint32_t tile_id) const;
 
@@ -65,20 +72,52 @@ public:
     return static_cast<uint32_t>(m_tiles.size());
   }
 
+  /** Approximate bytes of CPU memory taken by the tiles */
+  size_t get_memory_usage() const;
+
   const std::vector<Tilegroup>& get_tilegroups() const {
     return m_tilegroups;
   }
 
   void print_debug_info(const std::string& filename);
-  
+
+  /** Tiles load their images when first drawn, this loads the images
+      of the given tiles right away, e.g. the ones used by a level, and
+      moves them onto shared atlas pages */
+  void load_images(const std::vector<uint32_t>& tile_ids);
+
+  /** Counts the TileMaps drawing with this tileset, the TileManager
+      frees tilesets nobody uses anymore when it loads another one */
+  void add_user() const { m_users += 1; }
+  void remove_user() const { assert(m_users > 0); m_users -= 1; }
+  int get_user_count() const { return m_users; }
+
 public:
   // Must be public because of tile_set_parser.cpp
   std::vector<AutotileSet*>* m_autotilesets;
 
+private:
+  struct AnimationFrame
+  {
+    AnimationFrame() : clock(0), surface() {}
+
+    /** Value of m_animation_clock when surface was picked */
+    uint32_t clock;
+    SurfacePtr surface;
+  };
+
 private:
   std::vector<std::unique_ptr<Tile> > m_tiles;
   std::vector<Tilegroup> m_tilegroups;
 
+  /** Ticks whenever g_game_time changed since the last lookup, which
+      makes all entries of m_animation_frames stale at once */
+  mutable float m_animation_time;
+  mutable uint32_t m_animation_clock;
+  mutable std::vector<AnimationFrame> m_animation_frames;
+
+  mutable int m_users;
+
 private:
   TileSet(const TileSet&) = delete;
   TileSet& operator=(const TileSet&) = delete;
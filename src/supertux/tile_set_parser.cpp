@@ -158,13 +158,13 @@ TileSetParser::parse_tile(const ReaderMapping& reader)
     attributes |= Tile::SOLID | Tile::SLOPE;
   }
 
-  std::vector<SurfacePtr> editor_surfaces;
+  std::vector<Tile::ImageSpec> editor_surfaces;
   boost::optional<ReaderMapping> editor_images_mapping;
   if (reader.get("editor-images", editor_images_mapping)) {
     editor_surfaces = parse_imagespecs(*editor_images_mapping);
   }
 
-  std::vector<SurfacePtr> surfaces;
+  std::vector<Tile::ImageSpec> surfaces;
   boost::optional<ReaderMapping> images_mapping;
   if (reader.get("images", images_mapping)) {
     surfaces = parse_imagespecs(*images_mapping);
@@ -254,13 +254,13 @@ TileSetParser::parse_tiles(const ReaderMapping& reader)
   {
     if (shared_surface)
     {
-      std::vector<SurfacePtr> editor_surfaces;
+      std::vector<Tile::ImageSpec> editor_surfaces;
       boost::optional<ReaderMapping> editor_surfaces_mapping;
       if (reader.get("editor-images", editor_surfaces_mapping)) {
         editor_surfaces = parse_imagespecs(*editor_surfaces_mapping);
       }
 
-      std::vector<SurfacePtr> surfaces;
+      std::vector<Tile::ImageSpec> surfaces;
       boost::optional<ReaderMapping> surfaces_mapping;
       if (reader.get("image", surfaces_mapping) ||
          reader.get("images", surfaces_mapping)) {
@@ -274,19 +274,16 @@ TileSetParser::parse_tiles(const ReaderMapping& reader)
           const int x = static_cast<int>(32 * (i % width));
           const int y = static_cast<int>(32 * (i / width));
 
-          std::vector<SurfacePtr> regions;
-          regions.reserve(surfaces.size());
-          std::transform(surfaces.begin(), surfaces.end(), std::back_inserter(regions),
-              [x, y] (const SurfacePtr& surface) { 
-                return surface->region(Rect(x, y, Size(32, 32)));
-              });
+          // all tiles refer to the same image, so they end up sharing its texture
+          std::vector<Tile::ImageSpec> regions = surfaces;
+          for (auto& spec : regions) {
+            spec.region = Rect(x, y, Size(32, 32));
+          }
 
-          std::vector<SurfacePtr> editor_regions;
-          editor_regions.reserve(editor_surfaces.size());
-          std::transform(editor_surfaces.begin(), editor_surfaces.end(), std::back_inserter(editor_regions),
-              [x, y] (const SurfacePtr& surface) { 
-                return surface->region(Rect(x, y, Size(32, 32)));
-              });
+          std::vector<Tile::ImageSpec> editor_regions = editor_surfaces;
+          for (auto& spec : editor_regions) {
+            spec.region = Rect(x, y, Size(32, 32));
+          }
 
           auto tile = std::make_unique<Tile>(regions,
                                              editor_regions,
@@ -307,14 +304,14 @@ TileSetParser::parse_tiles(const ReaderMapping& reader)
           int x = static_cast<int>(32 * (i % width));
           int y = static_cast<int>(32 * (i / width));
 
-          std::vector<SurfacePtr> surfaces;
+          std::vector<Tile::ImageSpec> surfaces;
           boost::optional<ReaderMapping> surfaces_mapping;
           if (reader.get("image", surfaces_mapping) ||
              reader.get("images", surfaces_mapping)) {
             surfaces = parse_imagespecs(*surfaces_mapping, Rect(x, y, Size(32, 32)));
           }
 
-          std::vector<SurfacePtr> editor_surfaces;
+          std::vector<Tile::ImageSpec> editor_surfaces;
           boost::optional<ReaderMapping> editor_surfaces_mapping;
           if (reader.get("editor-images", editor_surfaces_mapping)) {
             editor_surfaces = parse_imagespecs(*editor_surfaces_mapping, Rect(x, y, Size(32, 32)));
@@ -333,11 +330,11 @@ TileSetParser::parse_tiles(const ReaderMapping& reader)
   }
 }
 
-std::vector<SurfacePtr>
+std::vector<Tile::ImageSpec>
   TileSetParser::parse_imagespecs(const ReaderMapping& images_mapping,
                                   const boost::optional<Rect>& surface_region) const
 {
-  std::vector<SurfacePtr> surfaces;
+  std::vector<Tile::ImageSpec> surfaces;
 
   // (images "foo.png" "foo.bar" ...)
   // (images (region "foo.png" 0 0 32 32))
@@ -347,11 +344,17 @@ std::vector<SurfacePtr>
     if (iter.is_string())
     {
       std::string file = iter.as_string_item();
-      surfaces.push_back(Surface::from_file(FileSystem::join(m_tiles_path, file), surface_region));
+      Tile::ImageSpec spec;
+      spec.file = FileSystem::join(m_tiles_path, file);
+      spec.rect = surface_region;
+      surfaces.push_back(spec);
     }
     else if (iter.is_pair() && iter.get_key() == "surface")
     {
-      surfaces.push_back(Surface::from_reader(iter.as_mapping(), surface_region));
+      // needs the document, which is gone by the time the tile is drawn
+      Tile::ImageSpec spec;
+      spec.surface = Surface::from_reader(iter.as_mapping(), surface_region);
+      surfaces.push_back(spec);
     }
     else if (iter.is_pair() && iter.get_key() == "region")
     {
@@ -380,8 +383,10 @@ std::vector<SurfacePtr>
           rect.bottom = rect.top + surface_region->get_height();
         }
 
-        surfaces.push_back(Surface::from_file(FileSystem::join(m_tiles_path, file),
-                                              rect));
+        Tile::ImageSpec spec;
+        spec.file = FileSystem::join(m_tiles_path, file);
+        spec.rect = rect;
+        surfaces.push_back(spec);
       }
     }
     else
@@ -43,8 +43,8 @@ public:
 private:
   void parse_tile(const ReaderMapping& reader);
   void parse_tiles(const ReaderMapping& reader);
-  std::vector<SurfacePtr> parse_imagespecs(const ReaderMapping& cur,
-                                           const boost::optional<Rect>& region = boost::none) const;
+  std::vector<Tile::ImageSpec> parse_imagespecs(const ReaderMapping& cur,
+                                                const boost::optional<Rect>& region = boost::none) const;
 
 private:
   TileSetParser(const TileSetParser&) = delete;
@@ -101,6 +101,17 @@ Climbable::update(float /*dt_sec*/)
   }
 }
 
+bool
+Climbable::is_dormant(Vector& pos) const
+{
+  // update() has to keep an eye on the climbing player
+  if (climbed_by)
+    return false;
+
+  pos = m_col.m_bbox.get_middle();
+  return true;
+}
+
 void
 Climbable::draw(DrawingContext& context)
 {
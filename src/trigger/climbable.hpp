@@ -42,6 +42,7 @@ public:
 
   virtual void event(Player& player, EventType type) override;
   virtual void update(float dt_sec) override;
+  virtual bool is_dormant(Vector& pos) const override;
   virtual void draw(DrawingContext& context) override;
 
   /** returns true if the player is within bounds of the Climbable */
@@ -17,11 +17,13 @@
 #include "trigger/door.hpp"
 
 #include "audio/sound_manager.hpp"
+#include "object/music_object.hpp"
 #include "object/player.hpp"
 #include "sprite/sprite.hpp"
 #include "sprite/sprite_manager.hpp"
 #include "supertux/fadetoblack.hpp"
 #include "supertux/game_session.hpp"
+#include "supertux/level.hpp"
 #include "supertux/screen_manager.hpp"
 #include "supertux/sector.hpp"
 #include "util/reader_mapping.hpp"
@@ -90,6 +92,8 @@ Door::update(float )
     case CLOSED:
       break;
     case OPENING:
+      prepare_target_sector();
+
       // if door has finished opening, start timer and keep door open
       if (sprite->animation_done()) {
         state = OPEN;
@@ -98,6 +102,8 @@ Door::update(float )
       }
       break;
     case OPEN:
+      prepare_target_sector();
+
       // if door was open long enough, start closing it
       if (stay_open_timer.check()) {
         state = CLOSING;
@@ -114,6 +120,29 @@ Door::update(float )
   }
 }
 
+void
+Door::prepare_target_sector()
+{
+  if (target_sector.empty() || !GameSession::current())
+    return;
+
+  if (auto sector = GameSession::current()->get_current_level().get_sector(target_sector)) {
+    sector->prepare_activation(target_spawnpoint);
+  }
+}
+
+bool
+Door::is_dormant(Vector& pos) const
+{
+  // opening and closing is driven by update(), which doesn't touch
+  // the TriggerBase bookkeeping
+  if (state != CLOSED)
+    return false;
+
+  pos = m_col.m_bbox.get_middle();
+  return true;
+}
+
 void
 Door::draw(DrawingContext& context)
 {
@@ -131,6 +160,13 @@ Door::event(Player& , EventType type)
         SoundManager::current()->play("sounds/door.wav");
         sprite->set_action("opening", 1);
         ScreenManager::current()->set_screen_fade(std::make_unique<FadeToBlack>(FadeToBlack::FADEOUT, 1));
+
+        // decode the music of the target sector while the door opens
+        if (!target_sector.empty() && GameSession::current()) {
+          if (auto sector = GameSession::current()->get_current_level().get_sector(target_sector)) {
+            SoundManager::current()->prepare_music(sector->get_singleton_by_type<MusicObject>().get_music());
+          }
+        }
       }
       break;
     case OPENING:
@@ -36,6 +36,7 @@ public:
   virtual ObjectSettings get_settings() override;
 
   virtual void update(float dt_sec) override;
+  virtual bool is_dormant(Vector& pos) const override;
   virtual void draw(DrawingContext& context) override;
   virtual void event(Player& player, EventType type) override;
   virtual HitResponse collision(GameObject& other, const CollisionHit& hit) override;
@@ -48,6 +49,10 @@ private:
     CLOSING
   };
 
+private:
+  /** Lets the target sector build its caches while the door is open */
+  void prepare_target_sector();
+
 private:
   DoorState state; /**< current state of the door */
   std::string target_sector; /**< target sector to teleport to */
@@ -109,6 +109,17 @@ Switch::update(float )
   }
 }
 
+bool
+Switch::is_dormant(Vector& pos) const
+{
+  // the animation and the scripts are driven by update()
+  if (state != OFF)
+    return false;
+
+  pos = m_col.m_bbox.get_middle();
+  return true;
+}
+
 void
 Switch::draw(DrawingContext& context)
 {
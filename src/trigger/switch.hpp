@@ -36,6 +36,7 @@ public:
   virtual void after_editor_set() override;
 
   virtual void update(float dt_sec) override;
+  virtual bool is_dormant(Vector& pos) const override;
   virtual void draw(DrawingContext& context) override;
   virtual void event(Player& player, EventType type) override;
 
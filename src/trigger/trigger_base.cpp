@@ -18,6 +18,7 @@
 
 #include "object/player.hpp"
 #include "sprite/sprite.hpp"
+#include "supertux/sector.hpp"
 
 TriggerBase::TriggerBase(const ReaderMapping& mapping) :
   MovingObject(mapping),
@@ -77,6 +78,12 @@ TriggerBase::collision(GameObject& other, const CollisionHit& )
   if (player) {
     m_hit = true;
     if (!m_lasthit) {
+      // large triggers can be touched while their middle is far away,
+      // update() has to run to notice the player leaving again
+      if (is_suspended()) {
+        Sector::get().resume(*this);
+      }
+
       m_losetouch_listeners.push_back(player);
       player->add_remove_listener(this);
       event(*player, EVENT_TOUCH);
@@ -86,6 +93,16 @@ TriggerBase::collision(GameObject& other, const CollisionHit& )
   return ABORT_MOVE;
 }
 
+bool
+TriggerBase::is_dormant(Vector& pos) const
+{
+  if (m_hit || m_lasthit || !m_losetouch_listeners.empty())
+    return false;
+
+  pos = m_col.m_bbox.get_middle();
+  return true;
+}
+
 void
 TriggerBase::object_removed(GameObject* object)
 {
@@ -47,6 +47,11 @@ public:
   virtual void draw(DrawingContext& context) override;
   virtual HitResponse collision(GameObject& other, const CollisionHit& hit) override;
 
+  /** Idle triggers only react to collisions, which are still
+      reported while suspended, so update() can be skipped until a
+      player touches them */
+  virtual bool is_dormant(Vector& pos) const override;
+
   /** Receive trigger events */
   virtual void event(Player& player, EventType type) = 0;
 
@@ -0,0 +1,166 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "util/allocation_tracker.hpp"
+
+#include <config.h>
+
+#ifdef ENABLE_ALLOCATION_TRACKING
+
+#include <atomic>
+#include <cstddef>
+#include <new>
+#include <stdlib.h>
+
+namespace {
+
+/** Size of the block is stored in front of it, padded so the block
+    keeps the alignment malloc() guarantees */
+const size_t HEADER_SIZE = alignof(std::max_align_t) > sizeof(size_t) ?
+  alignof(std::max_align_t) : sizeof(size_t);
+
+std::atomic<uint64_t> s_allocation_count(0);
+std::atomic<int64_t> s_bytes_in_flight(0);
+
+// plain integers, so nothing has to be constructed before the first
+// allocation of a thread
+thread_local uint64_t t_allocation_count = 0;
+thread_local uint64_t t_allocated_bytes = 0;
+
+void*
+allocate(size_t size)
+{
+  char* block = static_cast<char*>(malloc(size + HEADER_SIZE));
+  if (!block)
+    return nullptr;
+
+  *reinterpret_cast<size_t*>(block) = size;
+
+  s_allocation_count.fetch_add(1, std::memory_order_relaxed);
+  s_bytes_in_flight.fetch_add(static_cast<int64_t>(size), std::memory_order_relaxed);
+  t_allocation_count += 1;
+  t_allocated_bytes += size;
+
+  return block + HEADER_SIZE;
+}
+
+void
+deallocate(void* ptr)
+{
+  if (!ptr)
+    return;
+
+  char* block = static_cast<char*>(ptr) - HEADER_SIZE;
+  const size_t size = *reinterpret_cast<size_t*>(block);
+  s_bytes_in_flight.fetch_sub(static_cast<int64_t>(size), std::memory_order_relaxed);
+  free(block);
+}
+
+void*
+allocate_or_throw(size_t size)
+{
+  void* ptr = allocate(size);
+  while (!ptr)
+  {
+    std::new_handler handler = std::get_new_handler();
+    if (!handler)
+      throw std::bad_alloc();
+    handler();
+    ptr = allocate(size);
+  }
+  return ptr;
+}
+
+} // namespace
+
+void* operator new(size_t size) { return allocate_or_throw(size); }
+void* operator new[](size_t size) { return allocate_or_throw(size); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+
+void operator delete(void* ptr) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, size_t) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, size_t) noexcept { deallocate(ptr); }
+void operator delete(void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+void operator delete[](void* ptr, const std::nothrow_t&) noexcept { deallocate(ptr); }
+
+bool
+AllocationTracker::is_available()
+{
+  return true;
+}
+
+uint64_t
+AllocationTracker::get_allocation_count()
+{
+  return s_allocation_count.load(std::memory_order_relaxed);
+}
+
+int64_t
+AllocationTracker::get_bytes_in_flight()
+{
+  return s_bytes_in_flight.load(std::memory_order_relaxed);
+}
+
+uint64_t
+AllocationTracker::get_thread_allocation_count()
+{
+  return t_allocation_count;
+}
+
+uint64_t
+AllocationTracker::get_thread_allocated_bytes()
+{
+  return t_allocated_bytes;
+}
+
+#else
+
+bool
+AllocationTracker::is_available()
+{
+  return false;
+}
+
+uint64_t
+AllocationTracker::get_allocation_count()
+{
+  return 0;
+}
+
+int64_t
+AllocationTracker::get_bytes_in_flight()
+{
+  return 0;
+}
+
+uint64_t
+AllocationTracker::get_thread_allocation_count()
+{
+  return 0;
+}
+
+uint64_t
+AllocationTracker::get_thread_allocated_bytes()
+{
+  return 0;
+}
+
+#endif
+
+/* EOF */
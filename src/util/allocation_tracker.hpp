@@ -0,0 +1,48 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_UTIL_ALLOCATION_TRACKER_HPP
+#define HEADER_SUPERTUX_UTIL_ALLOCATION_TRACKER_HPP
+
+#include <stdint.h>
+
+/** Counts heap allocations made through the global operator new.
+    Only builds configured with ENABLE_ALLOCATION_TRACKING replace
+    operator new, otherwise all counters stay at zero. */
+class AllocationTracker final
+{
+public:
+  /** True if operator new is replaced in this build */
+  static bool is_available();
+
+  /** Blocks allocated by the whole program */
+  static uint64_t get_allocation_count();
+
+  /** Bytes allocated and not yet freed by the whole program */
+  static int64_t get_bytes_in_flight();
+
+  /** Blocks and bytes allocated by the calling thread */
+  static uint64_t get_thread_allocation_count();
+  static uint64_t get_thread_allocated_bytes();
+
+private:
+  AllocationTracker() = delete;
+};
+
+#endif
+
+/* EOF */
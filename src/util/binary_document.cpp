@@ -0,0 +1,341 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "util/binary_document.hpp"
+
+#include <sexp/value.hpp>
+#include <string.h>
+
+#include "util/sexp_cache.hpp"
+
+namespace {
+
+/** Changes whenever the container layout changes */
+const char MAGIC[] = "STLB1\0\0\0";
+const size_t MAGIC_LENGTH = 8;
+const size_t BLOB_ALIGNMENT = 16;
+
+/** Shorter arrays stay in the document */
+const size_t MIN_BLOB_SIZE = 64;
+
+void write_uint32(std::string& out, uint32_t value)
+{
+  for (int i = 0; i < 4; ++i) {
+    out += static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+void write_uint64(std::string& out, uint64_t value)
+{
+  for (int i = 0; i < 8; ++i) {
+    out += static_cast<char>((value >> (8 * i)) & 0xff);
+  }
+}
+
+uint64_t read_uint(const std::string& data, size_t pos, int bytes)
+{
+  uint64_t value = 0;
+  for (int i = 0; i < bytes; ++i) {
+    value |= static_cast<uint64_t>(static_cast<uint8_t>(data[pos + i])) << (8 * i);
+  }
+  return value;
+}
+
+bool is_tile_array(const sexp::Value& sx)
+{
+  if (!sx.is_array())
+    return false;
+
+  const auto& items = sx.as_array();
+  if (items.size() < MIN_BLOB_SIZE + 1 ||
+      !items[0].is_symbol() || items[0].as_string() != "tiles")
+    return false;
+
+  for (size_t i = 1; i < items.size(); ++i) {
+    if (!items[i].is_integer() || items[i].as_int() < 0)
+      return false;
+  }
+  return true;
+}
+
+bool is_space(char c)
+{
+  return c == ' ' || c == '\t' || c == '\n' || c == '\r';
+}
+
+/** Parses the integers of a tiles array starting at pos, which is
+    right behind the "(tiles" symbol. On success pos is moved behind
+    the closing parenthesis. */
+bool parse_tile_array(const std::string& text, size_t& pos, std::vector<uint32_t>& values)
+{
+  values.clear();
+  size_t i = pos;
+  while (i < text.size())
+  {
+    const char c = text[i];
+    if (is_space(c))
+    {
+      ++i;
+    }
+    else if (c == ')')
+    {
+      pos = i + 1;
+      return true;
+    }
+    else if (c >= '0' && c <= '9')
+    {
+      uint64_t value = 0;
+      for (; i < text.size() && text[i] >= '0' && text[i] <= '9'; ++i)
+      {
+        value = value * 10 + static_cast<uint64_t>(text[i] - '0');
+        // same range as sexp::Value::as_int()
+        if (value > 0x7fffffff)
+          return false;
+      }
+
+      // things like "12.5" or "12abc" are not integers
+      if (i < text.size() && !is_space(text[i]) && text[i] != ')')
+        return false;
+
+      values.push_back(static_cast<uint32_t>(value));
+    }
+    else
+    {
+      // signs, floats, comments, nested lists, ... go through the parser
+      return false;
+    }
+  }
+  return false;
+}
+
+/** Copies sx with the tile arrays replaced by blob references */
+sexp::Value extract_blobs(const sexp::Value& sx, std::vector<std::vector<uint32_t> >& blobs)
+{
+  if (is_tile_array(sx))
+  {
+    const auto& items = sx.as_array();
+    std::vector<uint32_t> values;
+    values.reserve(items.size() - 1);
+    for (size_t i = 1; i < items.size(); ++i) {
+      values.push_back(static_cast<uint32_t>(items[i].as_int()));
+    }
+
+    std::vector<sexp::Value> ref;
+    ref.push_back(sexp::Value::symbol("blob"));
+    ref.push_back(sexp::Value::integer(static_cast<int>(blobs.size())));
+    blobs.push_back(std::move(values));
+
+    std::vector<sexp::Value> result;
+    result.push_back(items[0]);
+    result.push_back(sexp::Value::array(std::move(ref)));
+    sexp::Value value = sexp::Value::array(std::move(result));
+    value.set_line(sx.get_line());
+    return value;
+  }
+  else if (sx.is_array())
+  {
+    std::vector<sexp::Value> result;
+    result.reserve(sx.as_array().size());
+    for (const auto& item : sx.as_array()) {
+      result.push_back(extract_blobs(item, blobs));
+    }
+    sexp::Value value = sexp::Value::array(std::move(result));
+    value.set_line(sx.get_line());
+    return value;
+  }
+  else
+  {
+    return sx;
+  }
+}
+
+} // namespace
+
+namespace BinaryDocument {
+
+bool
+is_binary(const std::string& data)
+{
+  return data.size() >= MAGIC_LENGTH && memcmp(data.data(), MAGIC, MAGIC_LENGTH) == 0;
+}
+
+std::string
+encode(const sexp::Value& sx)
+{
+  std::vector<std::vector<uint32_t> > blobs;
+  const std::string document = SExpCache::serialize(extract_blobs(sx, blobs));
+
+  // magic, document size, blob count, blob table, document, blobs
+  const size_t header_size = MAGIC_LENGTH + 8 + blobs.size() * 16;
+  size_t offset = header_size + document.size();
+
+  std::string out(MAGIC, MAGIC_LENGTH);
+  write_uint32(out, static_cast<uint32_t>(document.size()));
+  write_uint32(out, static_cast<uint32_t>(blobs.size()));
+  for (const auto& blob : blobs)
+  {
+    offset = (offset + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT;
+    write_uint64(out, offset);
+    write_uint64(out, blob.size());
+    offset += blob.size() * 4;
+  }
+  out += document;
+
+  for (const auto& blob : blobs)
+  {
+    out.resize((out.size() + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT, '\0');
+    for (const auto value : blob) {
+      write_uint32(out, value);
+    }
+  }
+  return out;
+}
+
+bool
+decode(const std::string& data, sexp::Value& sx, std::vector<Blob>& blobs)
+{
+  if (!is_binary(data) || data.size() < MAGIC_LENGTH + 8)
+    return false;
+
+  const uint64_t document_size = read_uint(data, MAGIC_LENGTH, 4);
+  const uint64_t blob_count = read_uint(data, MAGIC_LENGTH + 4, 4);
+  const uint64_t header_size = MAGIC_LENGTH + 8 + blob_count * 16;
+  if (header_size + document_size > data.size())
+    return false;
+
+  blobs.clear();
+  for (uint64_t i = 0; i < blob_count; ++i)
+  {
+    const size_t pos = MAGIC_LENGTH + 8 + static_cast<size_t>(i) * 16;
+    const uint64_t offset = read_uint(data, pos, 8);
+    const uint64_t count = read_uint(data, pos + 8, 8);
+    if (offset > data.size() || count > (data.size() - offset) / 4)
+      return false;
+
+    blobs.push_back({ static_cast<size_t>(offset), static_cast<size_t>(count) });
+  }
+
+  return SExpCache::deserialize(data.substr(static_cast<size_t>(header_size),
+                                            static_cast<size_t>(document_size)), sx);
+}
+
+int
+get_blob_index(const sexp::Value& sx)
+{
+  if (!sx.is_array())
+    return -1;
+
+  const auto& items = sx.as_array();
+  if (items.size() != 2 || !items[0].is_symbol() || items[0].as_string() != "blob" ||
+      !items[1].is_integer())
+    return -1;
+
+  return items[1].as_int();
+}
+
+std::string
+extract_text_blobs(const std::string& text, std::string& data, std::vector<Blob>& blobs)
+{
+  static const char TILES[] = "(tiles";
+  const size_t tiles_length = sizeof(TILES) - 1;
+
+  std::string result;
+  std::vector<uint32_t> values;
+  size_t copied = 0;
+  size_t pos = 0;
+  while (pos < text.size())
+  {
+    const char c = text[pos];
+    if (c == '"')
+    {
+      // skip string literals, a "(tiles" inside them is just text
+      for (++pos; pos < text.size() && text[pos] != '"'; ++pos) {
+        if (text[pos] == '\\') ++pos;
+      }
+      ++pos;
+    }
+    else if (c == ';')
+    {
+      pos = text.find('\n', pos);
+      if (pos == std::string::npos) break;
+    }
+    else if (c == '(' && text.compare(pos, tiles_length, TILES) == 0 &&
+             pos + tiles_length < text.size() && is_space(text[pos + tiles_length]))
+    {
+      size_t end = pos + tiles_length;
+      if (!parse_tile_array(text, end, values) || values.size() < MIN_BLOB_SIZE)
+      {
+        pos += tiles_length;
+        continue;
+      }
+
+      result.append(text, copied, pos - copied);
+      result += "(tiles (blob " + std::to_string(blobs.size()) + ")";
+      for (size_t i = pos; i < end; ++i) {
+        if (text[i] == '\n') result += '\n';
+      }
+      result += ')';
+      copied = end;
+      pos = end;
+
+      data.resize((data.size() + BLOB_ALIGNMENT - 1) / BLOB_ALIGNMENT * BLOB_ALIGNMENT, '\0');
+      blobs.push_back({ data.size(), values.size() });
+      data.reserve(data.size() + values.size() * 4);
+      for (const auto value : values) {
+        write_uint32(data, value);
+      }
+    }
+    else
+    {
+      ++pos;
+    }
+  }
+
+  if (copied == 0)
+    return text;
+
+  result.append(text, copied, std::string::npos);
+  return result;
+}
+
+void
+read_blob(const std::string& data, const Blob& blob, std::vector<unsigned int>& value)
+{
+  value.resize(blob.count);
+  decode_values(data.data() + blob.offset, blob.count, value.data());
+}
+
+void
+decode_values(const char* src, size_t count, unsigned int* value)
+{
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_LITTLE_ENDIAN__
+  if (sizeof(unsigned int) == 4) {
+    memcpy(value, src, count * 4);
+    return;
+  }
+#endif
+  const unsigned char* bytes = reinterpret_cast<const unsigned char*>(src);
+  for (size_t i = 0; i < count; ++i, bytes += 4) {
+    value[i] = static_cast<unsigned int>(bytes[0]) |
+      (static_cast<unsigned int>(bytes[1]) << 8) |
+      (static_cast<unsigned int>(bytes[2]) << 16) |
+      (static_cast<unsigned int>(bytes[3]) << 24);
+  }
+}
+
+} // namespace BinaryDocument
+
+/* EOF */
@@ -0,0 +1,74 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_UTIL_BINARY_DOCUMENT_HPP
+#define HEADER_SUPERTUX_UTIL_BINARY_DOCUMENT_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+namespace sexp {
+class Value;
+} // namespace sexp
+
+/** Binary container for documents with large integer arrays, i.e.
+    levels. The document itself is stored in the SExpCache encoding,
+    but "tiles" arrays are moved out of it into raw little endian
+    uint32 arrays, aligned to 16 bytes so they can be copied or mapped
+    as they are. In the document such an array is replaced by a
+    reference (tiles (blob INDEX)). */
+namespace BinaryDocument {
+
+struct Blob
+{
+  /** offset in the container and number of uint32 values */
+  size_t offset;
+  size_t count;
+};
+
+/** Checks the magic at the start of data */
+bool is_binary(const std::string& data);
+
+std::string encode(const sexp::Value& sx);
+
+/** Decodes the document part and the blob table of data, returns
+    false if data is truncated or otherwise broken */
+bool decode(const std::string& data, sexp::Value& sx, std::vector<Blob>& blobs);
+
+/** Returns the index of the blob if sx is a blob reference, -1
+    otherwise */
+int get_blob_index(const sexp::Value& sx);
+
+/** Moves the "tiles" arrays of the text document text into blobs
+    appended to data without going through the sexp parser, arrays
+    holding anything but plain non-negative integers are left to it.
+    Returns text with the arrays replaced by blob references, line
+    breaks are kept so line numbers in error messages don't change. */
+std::string extract_text_blobs(const std::string& text, std::string& data, std::vector<Blob>& blobs);
+
+/** Copies the values of blob out of data */
+void read_blob(const std::string& data, const Blob& blob, std::vector<unsigned int>& value);
+
+/** Decodes count values as they are stored in blobs */
+void decode_values(const char* src, size_t count, unsigned int* value);
+
+} // namespace BinaryDocument
+
+#endif
+
+/* EOF */
@@ -0,0 +1,52 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_UTIL_COPY_ON_WRITE_HPP
+#define HEADER_SUPERTUX_UTIL_COPY_ON_WRITE_HPP
+
+#include <memory>
+
+/** Value that copies share until one of them gets written to through
+    write(), which copies it first if it is still shared. Copies are
+    only meant to be made and written on one thread. */
+template<typename T>
+class CopyOnWrite final
+{
+public:
+  CopyOnWrite() : m_value(std::make_shared<T>()) {}
+  CopyOnWrite(T value) : m_value(std::make_shared<T>(std::move(value))) {}
+
+  const T& get() const { return *m_value; }
+  const T& operator*() const { return *m_value; }
+  const T* operator->() const { return m_value.get(); }
+
+  T& write()
+  {
+    if (m_value.use_count() > 1) {
+      m_value = std::make_shared<T>(*m_value);
+    }
+    return *m_value;
+  }
+
+  bool is_shared() const { return m_value.use_count() > 1; }
+
+private:
+  std::shared_ptr<T> m_value;
+};
+
+#endif
+
+/* EOF */
@@ -25,6 +25,10 @@
  *   singleton, but without handling the object construction itself or
  *   in other words its a glorified global variable that points to the
  *   current instance of a class.
+ *
+ *   The current instance is shared by all threads. Code running on
+ *   worker threads, e.g. JobSystem jobs, may only use it for read-only
+ *   access to the shared assets.
  */
 template<class C>
 class Currenton
@@ -218,6 +218,13 @@ bool remove(const std::string& path)
   return fs::remove(location);
 }
 
+bool rename(const std::string& from, const std::string& to)
+{
+  boost::system::error_code ec;
+  fs::rename(fs::path(from), fs::path(to), ec);
+  return !ec;
+}
+
 void open_path(const std::string& path)
 {
 #if defined(_WIN32) || defined (_WIN64)
@@ -54,6 +54,10 @@ std::string join(const std::string& lhs, const std::string& rhs);
     @return true when successfully removed, false otherwise */
  bool remove(const std::string& path);
 
+/** Moves a file, replacing an existing file at to
+    @return true when successfully moved, false otherwise */
+ bool rename(const std::string& from, const std::string& to);
+
 /** Opens a file path or an address outside of SuperTux
  * @param path path or URL to open
  */
@@ -0,0 +1,201 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_UTIL_FLAT_HASH_MAP_HPP
+#define HEADER_SUPERTUX_UTIL_FLAT_HASH_MAP_HPP
+
+#include <functional>
+#include <stddef.h>
+#include <stdint.h>
+#include <utility>
+#include <vector>
+
+/** Open addressing hash map with linear probing, all entries live in
+    one array, so a lookup usually touches a single cache line instead
+    of chasing the node pointers of std::unordered_map. Erasing shifts
+    the following entries back, so no tombstones pile up. Pointers to
+    values are invalidated by insert() and erase(). */
+template<typename K, typename V, typename Hash = std::hash<K> >
+class FlatHashMap final
+{
+private:
+  struct Slot
+  {
+    Slot() : used(false), key(), value() {}
+
+    bool used;
+    K key;
+    V value;
+  };
+
+public:
+  FlatHashMap() :
+    m_slots(),
+    m_size(0),
+    m_shift(64)
+  {
+  }
+
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+  /** Makes room for count entries without rehashing */
+  void reserve(size_t count)
+  {
+    size_t capacity = 8;
+    while (capacity * 3 / 4 < count) {
+      capacity *= 2;
+    }
+    if (capacity > m_slots.size()) {
+      rehash(capacity);
+    }
+  }
+
+  V* find(const K& key)
+  {
+    const size_t index = find_index(key);
+    return index == NOT_FOUND ? nullptr : &m_slots[index].value;
+  }
+
+  const V* find(const K& key) const
+  {
+    const size_t index = find_index(key);
+    return index == NOT_FOUND ? nullptr : &m_slots[index].value;
+  }
+
+  /** Adds key or replaces its value */
+  void insert(const K& key, V value)
+  {
+    if ((m_size + 1) * 4 > m_slots.size() * 3) {
+      rehash(m_slots.empty() ? 8 : m_slots.size() * 2);
+    }
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = get_home(key); ; i = (i + 1) & mask)
+    {
+      Slot& slot = m_slots[i];
+      if (!slot.used)
+      {
+        slot.used = true;
+        slot.key = key;
+        slot.value = std::move(value);
+        m_size += 1;
+        return;
+      }
+      else if (slot.key == key)
+      {
+        slot.value = std::move(value);
+        return;
+      }
+    }
+  }
+
+  /** Returns false if key wasn't in the map */
+  bool erase(const K& key)
+  {
+    size_t hole = find_index(key);
+    if (hole == NOT_FOUND)
+      return false;
+
+    // move entries of the same probe sequence into the hole until
+    // a free slot or an entry sitting at its home slot shows up
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = (hole + 1) & mask; m_slots[i].used; i = (i + 1) & mask)
+    {
+      const size_t home = get_home(m_slots[i].key);
+      if (((i - home) & mask) >= ((i - hole) & mask))
+      {
+        m_slots[hole] = std::move(m_slots[i]);
+        hole = i;
+      }
+    }
+
+    m_slots[hole] = Slot();
+    m_size -= 1;
+    return true;
+  }
+
+  /** Removes all entries, but keeps the memory */
+  void clear()
+  {
+    if (m_size == 0)
+      return;
+
+    for (auto& slot : m_slots) {
+      slot = Slot();
+    }
+    m_size = 0;
+  }
+
+private:
+  static const size_t NOT_FOUND = static_cast<size_t>(-1);
+
+  /** Fibonacci hashing, so keys that only differ in their high or
+      low bits, like UIDs, still spread over the whole table */
+  size_t get_home(const K& key) const
+  {
+    return static_cast<size_t>((static_cast<uint64_t>(Hash()(key)) * 0x9E3779B97F4A7C15ull) >> m_shift);
+  }
+
+  size_t find_index(const K& key) const
+  {
+    if (m_size == 0)
+      return NOT_FOUND;
+
+    const size_t mask = m_slots.size() - 1;
+    for (size_t i = get_home(key); m_slots[i].used; i = (i + 1) & mask)
+    {
+      if (m_slots[i].key == key)
+        return i;
+    }
+    return NOT_FOUND;
+  }
+
+  void rehash(size_t capacity)
+  {
+    std::vector<Slot> old_slots(capacity);
+    old_slots.swap(m_slots);
+
+    m_shift = 64;
+    for (size_t i = capacity; i > 1; i /= 2) {
+      m_shift -= 1;
+    }
+
+    const size_t mask = capacity - 1;
+    for (auto& old_slot : old_slots)
+    {
+      if (!old_slot.used)
+        continue;
+
+      size_t i = get_home(old_slot.key);
+      while (m_slots[i].used) {
+        i = (i + 1) & mask;
+      }
+      m_slots[i] = std::move(old_slot);
+    }
+  }
+
+private:
+  std::vector<Slot> m_slots;
+  size_t m_size;
+
+  /** 64 - log2(capacity) */
+  int m_shift;
+};
+
+#endif
+
+/* EOF */
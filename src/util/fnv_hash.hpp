@@ -0,0 +1,58 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_UTIL_FNV_HASH_HPP
+#define HEADER_SUPERTUX_UTIL_FNV_HASH_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <type_traits>
+
+/** Incremental 64 bit FNV-1a hash, cheap enough to run over a whole
+    frame worth of drawing requests */
+class FNVHash final
+{
+public:
+  FNVHash() : m_hash(14695981039346656037ULL) {}
+
+  void add(const void* data, size_t len)
+  {
+    const uint8_t* bytes = static_cast<const uint8_t*>(data);
+    for (size_t i = 0; i < len; ++i)
+    {
+      m_hash ^= bytes[i];
+      m_hash *= 1099511628211ULL;
+    }
+  }
+
+  /** Only for types without padding bytes */
+  template<typename T>
+  void add(const T& value)
+  {
+    static_assert(std::is_arithmetic<T>::value || std::is_enum<T>::value || std::is_pointer<T>::value,
+                  "FNVHash::add() needs a scalar type");
+    add(&value, sizeof(value));
+  }
+
+  uint64_t get() const { return m_hash; }
+
+private:
+  uint64_t m_hash;
+};
+
+#endif
+
+/* EOF */
@@ -16,6 +16,50 @@
 
 #include "util/gettext.hpp"
 
+#include <atomic>
+#include <unordered_map>
+
 std::unique_ptr<tinygettext::DictionaryManager> g_dictionary_manager = nullptr;
 
+namespace {
+
+std::atomic<int> s_translations_generation(0);
+
+struct LiteralTranslations
+{
+  /** s_translations_generation the translations belong to */
+  int generation = -1;
+  std::unordered_map<const char*, std::string> translations;
+};
+
+// one table per thread, so lookups don't need a lock
+thread_local LiteralTranslations t_literal_translations;
+
+} // namespace
+
+void
+invalidate_translations()
+{
+  s_translations_generation += 1;
+}
+
+const std::string&
+translate_literal(const char* message)
+{
+  LiteralTranslations& cache = t_literal_translations;
+
+  const int generation = s_translations_generation;
+  if (cache.generation != generation)
+  {
+    cache.translations.clear();
+    cache.generation = generation;
+  }
+
+  auto it = cache.translations.find(message);
+  if (it == cache.translations.end()) {
+    it = cache.translations.emplace(message, _(std::string(message))).first;
+  }
+  return it->second;
+}
+
 /* EOF */
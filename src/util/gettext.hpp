@@ -19,9 +19,22 @@
 
 #include <tinygettext/tinygettext.hpp>
 #include <memory>
+#include <stddef.h>
+#include <string>
 
 extern std::unique_ptr<tinygettext::DictionaryManager> g_dictionary_manager;
 
+/** Has to be called whenever the language or the directories of
+    g_dictionary_manager change, so the translations remembered for
+    string literals are looked up again */
+void invalidate_translations();
+
+/** Translation of a string literal, keyed by its address. Each
+    literal is looked up only once per language and thread, which
+    makes it cheap enough for text drawn every frame. The reference
+    stays valid until the first call after invalidate_translations(). */
+const std::string& translate_literal(const char* message);
+
 /*
  * If you need to do a nontrivial substitution of values into a pattern, use
  * boost::format rather than an ad-hoc concatenation.  That way, translators can
@@ -65,6 +78,13 @@ static inline std::string _(const std::string& message)
   }
 }
 
+/** Picked for string literals, _(std::string) for everything else */
+template<size_t N>
+static inline const std::string& _(const char (&message)[N])
+{
+  return translate_literal(message);
+}
+
 static inline std::string __(const std::string& message,
     const std::string& message_plural, int num)
 {
@@ -0,0 +1,107 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "util/interned_string.hpp"
+
+#include <deque>
+#include <mutex>
+#include <ostream>
+#include <string.h>
+#include <unordered_map>
+
+#include "util/fnv_hash.hpp"
+
+namespace {
+
+/** Points into a string of the table, or at the text looked up */
+struct Key
+{
+  const char* text;
+  size_t length;
+
+  bool operator==(const Key& other) const
+  {
+    return length == other.length && memcmp(text, other.text, length) == 0;
+  }
+};
+
+struct KeyHash
+{
+  size_t operator()(const Key& key) const
+  {
+    FNVHash hash;
+    hash.add(key.text, key.length);
+    return static_cast<size_t>(hash.get());
+  }
+};
+
+/** Strings are interned on worker threads too, so the table is locked */
+struct StringTable
+{
+  std::mutex mutex;
+  std::unordered_map<Key, const std::string*, KeyHash> strings;
+  /** deque keeps the strings in place while growing */
+  std::deque<std::string> storage;
+};
+
+StringTable&
+get_table()
+{
+  static StringTable table;
+  return table;
+}
+
+} // namespace
+
+const std::string*
+InternedString::intern(const char* text, size_t length)
+{
+  StringTable& table = get_table();
+  std::lock_guard<std::mutex> lock(table.mutex);
+
+  auto it = table.strings.find(Key{text, length});
+  if (it != table.strings.end())
+    return it->second;
+
+  table.storage.emplace_back(text, length);
+  const std::string* str = &table.storage.back();
+  table.strings.emplace(Key{str->data(), str->size()}, str);
+  return str;
+}
+
+InternedString::InternedString() :
+  m_str()
+{
+  static const std::string* const empty = intern("", 0);
+  m_str = empty;
+}
+
+InternedString::InternedString(const char* text) :
+  m_str(intern(text, strlen(text)))
+{
+}
+
+InternedString::InternedString(const std::string& text) :
+  m_str(intern(text.data(), text.size()))
+{
+}
+
+std::ostream& operator<<(std::ostream& os, const InternedString& text)
+{
+  return os << text.str();
+}
+
+/* EOF */
@@ -0,0 +1,70 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_UTIL_INTERNED_STRING_HPP
+#define HEADER_SUPERTUX_UTIL_INTERNED_STRING_HPP
+
+#include <functional>
+#include <iosfwd>
+#include <stddef.h>
+#include <string>
+
+/** String stored once in a global table that is never cleared.
+    Constructing one costs a hash lookup without allocating unless
+    the string is new, after that copying, comparing and hashing only
+    touch a pointer. Like ActionId, but for names that are used as
+    strings too, such as sound files. */
+class InternedString final
+{
+public:
+  InternedString();
+  InternedString(const char* text);
+  InternedString(const std::string& text);
+
+  const std::string& str() const { return *m_str; }
+  const char* c_str() const { return m_str->c_str(); }
+  bool empty() const { return m_str->empty(); }
+
+  bool operator==(const InternedString& other) const { return m_str == other.m_str; }
+  bool operator!=(const InternedString& other) const { return m_str != other.m_str; }
+
+  /** Orders by address, not alphabetically */
+  bool operator<(const InternedString& other) const { return std::less<const std::string*>()(m_str, other.m_str); }
+
+  size_t get_hash() const { return std::hash<const std::string*>()(m_str); }
+
+private:
+  static const std::string* intern(const char* text, size_t length);
+
+private:
+  const std::string* m_str;
+};
+
+std::ostream& operator<<(std::ostream& os, const InternedString& text);
+
+namespace std {
+
+template<>
+struct hash<InternedString>
+{
+  size_t operator()(const InternedString& text) const { return text.get_hash(); }
+};
+
+} // namespace std
+
+#endif
+
+/* EOF */
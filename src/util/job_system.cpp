@@ -0,0 +1,391 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "util/job_system.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+
+#include "util/profiler.hpp"
+
+namespace {
+
+/** set for the worker threads, so jobs they schedule go to their own queue */
+thread_local const JobSystem* t_job_system = nullptr;
+thread_local int t_worker_index = -1;
+
+} // namespace
+
+unsigned int
+JobSystem::get_default_size()
+{
+  // hardware_concurrency() returns 0 when it doesn't know
+  const unsigned int cores = std::thread::hardware_concurrency();
+  return std::max(1u, std::min(4u, cores > 1 ? cores - 1 : 1u));
+}
+
+bool
+JobSystem::Handle::is_done() const
+{
+  if (!m_job)
+    return true;
+
+  std::lock_guard<std::mutex> lock(m_job->mutex);
+  return m_job->done;
+}
+
+JobSystem::JobSystem(unsigned int num_threads) :
+  m_workers(),
+  m_main_thread(std::this_thread::get_id()),
+  m_mutex(),
+  m_condition(),
+  m_queued(0),
+  m_quit(false),
+  m_next_worker(0),
+  m_main_mutex(),
+  m_main_jobs()
+{
+  // all queues have to exist before the first worker starts stealing
+  for (unsigned int i = 0; i < std::max(1u, num_threads); ++i) {
+    m_workers.push_back(std::make_unique<Worker>());
+  }
+
+  for (size_t i = 0; i < m_workers.size(); ++i) {
+    m_workers[i]->thread = std::thread([this, i]{ run(static_cast<int>(i)); });
+  }
+}
+
+JobSystem::~JobSystem()
+{
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_quit = true;
+  }
+  m_condition.notify_all();
+
+  for (auto& worker : m_workers) {
+    worker->thread.join();
+  }
+}
+
+JobSystem::Handle
+JobSystem::schedule(std::function<void ()> func, const std::vector<Handle>& depends)
+{
+  return add(std::move(func), depends, false);
+}
+
+JobSystem::Handle
+JobSystem::schedule_on_main_thread(std::function<void ()> func, const std::vector<Handle>& depends)
+{
+  return add(std::move(func), depends, true);
+}
+
+JobSystem::Handle
+JobSystem::add(std::function<void ()> func, const std::vector<Handle>& depends, bool main_thread)
+{
+  auto job = std::make_shared<Job>(std::move(func), main_thread);
+
+  for (const auto& depend : depends)
+  {
+    if (!depend.m_job)
+      continue;
+
+    std::lock_guard<std::mutex> lock(depend.m_job->mutex);
+    if (depend.m_job->done)
+    {
+      if (depend.m_job->error) {
+        std::lock_guard<std::mutex> job_lock(job->mutex);
+        job->error = depend.m_job->error;
+      }
+    }
+    else
+    {
+      job->pending += 1;
+      depend.m_job->dependents.push_back(job);
+      job->depends.push_back(depend.m_job);
+    }
+  }
+
+  Handle handle(job);
+  if (job->pending.fetch_sub(1) == 1) {
+    enqueue(std::move(job));
+  }
+  return handle;
+}
+
+void
+JobSystem::enqueue(std::shared_ptr<Job> job)
+{
+  if (job->main_thread)
+  {
+    std::lock_guard<std::mutex> lock(m_main_mutex);
+    m_main_jobs.push_back(std::move(job));
+    return;
+  }
+
+  const size_t index = (t_job_system == this) ?
+    static_cast<size_t>(t_worker_index) :
+    m_next_worker++ % m_workers.size();
+
+  {
+    std::lock_guard<std::mutex> lock(m_workers[index]->mutex);
+    m_workers[index]->jobs.push_back(std::move(job));
+  }
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queued += 1;
+  }
+  m_condition.notify_one();
+}
+
+std::shared_ptr<JobSystem::Job>
+JobSystem::take(int index)
+{
+  std::shared_ptr<Job> job;
+
+  if (index >= 0)
+  {
+    // newest first, its data is most likely still in the cache
+    Worker& worker = *m_workers[index];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!worker.jobs.empty()) {
+      job = std::move(worker.jobs.back());
+      worker.jobs.pop_back();
+    }
+  }
+
+  // steal the oldest job of another worker
+  const size_t count = m_workers.size();
+  const size_t start = index >= 0 ? static_cast<size_t>(index) + 1 : 0;
+  for (size_t i = 0; !job && i < count; ++i)
+  {
+    const size_t victim = (start + i) % count;
+    if (static_cast<int>(victim) == index)
+      continue;
+
+    Worker& worker = *m_workers[victim];
+    std::lock_guard<std::mutex> lock(worker.mutex);
+    if (!worker.jobs.empty()) {
+      job = std::move(worker.jobs.front());
+      worker.jobs.pop_front();
+    }
+  }
+
+  if (job) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queued -= 1;
+  }
+  return job;
+}
+
+bool
+JobSystem::claim(const std::shared_ptr<Job>& job)
+{
+  if (job->main_thread)
+  {
+    std::lock_guard<std::mutex> lock(m_main_mutex);
+    auto it = std::find(m_main_jobs.begin(), m_main_jobs.end(), job);
+    if (it == m_main_jobs.end())
+      return false;
+
+    m_main_jobs.erase(it);
+    return true;
+  }
+
+  for (auto& worker : m_workers)
+  {
+    {
+      std::lock_guard<std::mutex> lock(worker->mutex);
+      auto it = std::find(worker->jobs.begin(), worker->jobs.end(), job);
+      if (it == worker->jobs.end())
+        continue;
+
+      worker->jobs.erase(it);
+    }
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_queued -= 1;
+    return true;
+  }
+  return false;
+}
+
+bool
+JobSystem::help(const std::shared_ptr<Job>& job, bool main_thread)
+{
+  std::vector<std::shared_ptr<Job> > depends;
+  {
+    std::lock_guard<std::mutex> lock(job->mutex);
+    if (job->done)
+      return false;
+
+    for (const auto& depend : job->depends) {
+      if (auto locked = depend.lock()) {
+        depends.push_back(std::move(locked));
+      }
+    }
+  }
+
+  // no pending dependencies means it is queued or already running
+  if (job->pending == 0)
+  {
+    if ((main_thread || !job->main_thread) && claim(job)) {
+      execute(job);
+      return true;
+    }
+    return false;
+  }
+
+  for (const auto& depend : depends) {
+    if (help(depend, main_thread))
+      return true;
+  }
+  return false;
+}
+
+void
+JobSystem::execute(const std::shared_ptr<Job>& job)
+{
+  Profiler::Scope profile_scope("job");
+
+  std::exception_ptr error;
+  {
+    // set if a dependency failed
+    std::lock_guard<std::mutex> lock(job->mutex);
+    error = job->error;
+  }
+
+  if (!error)
+  {
+    try
+    {
+      job->func();
+    }
+    catch(...)
+    {
+      error = std::current_exception();
+    }
+  }
+
+  // release whatever the function captured
+  job->func = nullptr;
+
+  finish(job, error);
+}
+
+void
+JobSystem::finish(const std::shared_ptr<Job>& job, std::exception_ptr error)
+{
+  std::vector<std::shared_ptr<Job> > dependents;
+  {
+    std::lock_guard<std::mutex> lock(job->mutex);
+    job->done = true;
+    job->error = error;
+    dependents.swap(job->dependents);
+  }
+  job->condition.notify_all();
+
+  for (auto& dependent : dependents)
+  {
+    if (error) {
+      std::lock_guard<std::mutex> lock(dependent->mutex);
+      if (!dependent->error) {
+        dependent->error = error;
+      }
+    }
+
+    if (dependent->pending.fetch_sub(1) == 1) {
+      enqueue(std::move(dependent));
+    }
+  }
+}
+
+void
+JobSystem::wait(const Handle& handle)
+{
+  if (!handle.m_job)
+    return;
+
+  Job& job = *handle.m_job;
+  const bool main_thread = std::this_thread::get_id() == m_main_thread;
+
+  while (true)
+  {
+    {
+      std::lock_guard<std::mutex> lock(job.mutex);
+      if (job.done)
+        break;
+    }
+
+    if (help(handle.m_job, main_thread))
+      continue;
+
+    // the rest runs elsewhere, but a dependency finishing can queue
+    // the job for this thread to run, so don't sleep for long
+    std::unique_lock<std::mutex> lock(job.mutex);
+    job.condition.wait_for(lock, std::chrono::milliseconds(1), [&job]{ return job.done; });
+  }
+
+  std::lock_guard<std::mutex> lock(job.mutex);
+  if (job.error) {
+    std::rethrow_exception(job.error);
+  }
+}
+
+int
+JobSystem::process_main_thread()
+{
+  assert(std::this_thread::get_id() == m_main_thread);
+
+  std::vector<std::shared_ptr<Job> > jobs;
+  {
+    std::lock_guard<std::mutex> lock(m_main_mutex);
+    jobs.swap(m_main_jobs);
+  }
+
+  for (const auto& job : jobs) {
+    execute(job);
+  }
+  return static_cast<int>(jobs.size());
+}
+
+void
+JobSystem::run(int index)
+{
+  t_job_system = this;
+  t_worker_index = index;
+  Profiler::set_thread_name("job worker");
+
+  while (true)
+  {
+    auto job = take(index);
+    if (job)
+    {
+      execute(job);
+    }
+    else
+    {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      m_condition.wait(lock, [this]{ return m_quit || m_queued > 0; });
+      if (m_quit)
+        return;
+    }
+  }
+}
+
+/* EOF */
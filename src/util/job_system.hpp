@@ -0,0 +1,195 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_UTIL_JOB_SYSTEM_HPP
+#define HEADER_SUPERTUX_UTIL_JOB_SYSTEM_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "util/currenton.hpp"
+
+/** Engine wide worker threads, owned by Main. Every worker has a
+    queue of its own and steals from the others when it runs dry, so
+    jobs scheduling more jobs mostly stay on the same thread. Jobs can
+    depend on other jobs and can be marked to run on the main thread,
+    which happens in process_main_thread(), called once per frame by
+    the ScreenManager. Worker jobs still queued on destruction are
+    run, main thread jobs are dropped. */
+class JobSystem final : public Currenton<JobSystem>
+{
+private:
+  struct Job;
+
+public:
+  /** Refers to a scheduled job, default constructed handles count as
+      done */
+  class Handle final
+  {
+    friend class JobSystem;
+
+  public:
+    Handle() : m_job() {}
+
+    bool is_done() const;
+
+  private:
+    Handle(std::shared_ptr<Job> job) : m_job(std::move(job)) {}
+
+  private:
+    std::shared_ptr<Job> m_job;
+  };
+
+public:
+  /** Default number of threads, leaves one core for the main thread */
+  static unsigned int get_default_size();
+
+  /** Runs func on a worker thread of the current JobSystem and
+      returns a future of its result, or runs func right away when
+      there is none, e.g. in tools and benchmarks */
+  template<typename F>
+  static std::future<typename std::result_of<F()>::type> async(F func);
+
+public:
+  JobSystem(unsigned int num_threads);
+  ~JobSystem() override;
+
+  /** Runs func on a worker thread once all depends are done. If one
+      of them threw, func is skipped and the job fails the same way. */
+  Handle schedule(std::function<void ()> func, const std::vector<Handle>& depends = {});
+
+  /** Like schedule(), but func runs on the main thread */
+  Handle schedule_on_main_thread(std::function<void ()> func, const std::vector<Handle>& depends = {});
+
+  /** Blocks until job is done and rethrows what the job threw. If
+      job or one of its dependencies is still queued, the calling
+      thread runs it instead of waiting, other jobs are left alone so
+      they don't eat into the caller's frame. Main thread jobs are only
+      run when called from the main thread. */
+  void wait(const Handle& job);
+
+  /** Runs the main thread jobs that are ready, returns how many ran */
+  int process_main_thread();
+
+  int get_thread_count() const { return static_cast<int>(m_workers.size()); }
+
+private:
+  struct Job
+  {
+    Job(std::function<void ()> func_, bool main_thread_) :
+      func(std::move(func_)), main_thread(main_thread_), pending(1),
+      mutex(), condition(), done(false), depends(), dependents(), error()
+    {}
+
+    std::function<void ()> func;
+    bool main_thread;
+
+    /** unfinished dependencies, plus one while being scheduled */
+    std::atomic<int> pending;
+
+    std::mutex mutex;
+    std::condition_variable condition;
+    bool done;
+
+    /** the dependencies that weren't done when it was scheduled, for
+        wait() to find them */
+    std::vector<std::weak_ptr<Job> > depends;
+    std::vector<std::shared_ptr<Job> > dependents;
+    std::exception_ptr error;
+  };
+
+  struct Worker
+  {
+    Worker() : thread(), mutex(), jobs() {}
+
+    std::thread thread;
+    std::mutex mutex;
+    std::deque<std::shared_ptr<Job> > jobs;
+  };
+
+private:
+  Handle add(std::function<void ()> func, const std::vector<Handle>& depends, bool main_thread);
+
+  /** Called once the last dependency of job finished */
+  void enqueue(std::shared_ptr<Job> job);
+
+  /** Takes a job from the queue of worker index, or steals one from
+      the others, index may be -1 when not called by a worker */
+  std::shared_ptr<Job> take(int index);
+
+  /** Removes job from the queue it is in, false if it isn't in one */
+  bool claim(const std::shared_ptr<Job>& job);
+
+  /** Runs job if it is queued and may run on this thread, otherwise
+      does the same for its unfinished dependencies, returns false if
+      none of them could be run */
+  bool help(const std::shared_ptr<Job>& job, bool main_thread);
+
+  void execute(const std::shared_ptr<Job>& job);
+  void finish(const std::shared_ptr<Job>& job, std::exception_ptr error);
+
+  void run(int index);
+
+private:
+  std::vector<std::unique_ptr<Worker> > m_workers;
+  std::thread::id m_main_thread;
+
+  /** guards m_queued and m_quit for sleeping workers */
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  int m_queued;
+  bool m_quit;
+
+  /** used to spread jobs scheduled from outside the workers */
+  std::atomic<unsigned int> m_next_worker;
+
+  std::mutex m_main_mutex;
+  std::vector<std::shared_ptr<Job> > m_main_jobs;
+
+private:
+  JobSystem(const JobSystem&) = delete;
+  JobSystem& operator=(const JobSystem&) = delete;
+};
+
+template<typename F>
+std::future<typename std::result_of<F()>::type>
+JobSystem::async(F func)
+{
+  typedef typename std::result_of<F()>::type Result;
+
+  // std::function needs a copyable target, packaged_task isn't
+  auto task = std::make_shared<std::packaged_task<Result ()> >(std::move(func));
+  std::future<Result> future = task->get_future();
+
+  if (JobSystem* job_system = current()) {
+    job_system->schedule([task]{ (*task)(); });
+  } else {
+    (*task)();
+  }
+  return future;
+}
+
+#endif
+
+/* EOF */
@@ -17,27 +17,116 @@
 
 #include "util/log.hpp"
 
-#include <iostream>
+#include <chrono>
+#include <sstream>
+#include <stdint.h>
+#include <thread>
+#include <unordered_map>
 
 #include "math/rectf.hpp"
 #include "supertux/console.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/globals.hpp"
+#include "util/log_sink.hpp"
 
 LogLevel g_log_level = LOG_WARNING;
 
+namespace {
+
+/** Messages from a single file:line beyond this many per second are
+    suppressed, e.g. a warning in an update() that fires every frame */
+const int MAX_MESSAGES_PER_SECOND = 10;
+
+/** Hands complete lines to the LogSink */
+class LogStreamBuffer final : public std::stringbuf
+{
+public:
+  virtual int sync() override
+  {
+    int result = std::stringbuf::sync();
+
+    std::string s = str();
+    if (!s.empty() && (s.back() == '\n' || s.back() == '\r'))
+    {
+      while (!s.empty() && (s.back() == '\n' || s.back() == '\r')) {
+        s.pop_back();
+      }
+      LogSink::write(s);
+      str(std::string());
+    }
+    return result;
+  }
+};
+
+struct RateLimit
+{
+  std::chrono::steady_clock::time_point window_start;
+  int count;
+  int suppressed;
+};
+
+// streams are per thread, so lines logged by jobs don't interleave
+thread_local LogStreamBuffer s_log_buffer;
+thread_local std::ostream s_log_stream(&s_log_buffer);
+
+// has no buffer and thus skips all formatting
+thread_local std::ostream s_null_stream(nullptr);
+
+thread_local std::unordered_map<uint64_t, RateLimit> s_rate_limits;
+
+/** Returns the number of messages that were suppressed since the
+    last one from this location got through, or -1 if this one should
+    be suppressed too */
+int
+check_rate_limit(const char* file, int line)
+{
+  // file is a string literal, so its address combined with the line
+  // identifies the call site
+  const uint64_t key = (static_cast<uint64_t>(reinterpret_cast<uintptr_t>(file)) << 20) ^
+    static_cast<uint64_t>(line);
+  const auto now = std::chrono::steady_clock::now();
+
+  RateLimit& limit = s_rate_limits.emplace(key, RateLimit{now, 0, 0}).first->second;
+  if (now - limit.window_start >= std::chrono::seconds(1))
+  {
+    limit.window_start = now;
+    limit.count = 0;
+  }
+
+  if (limit.count >= MAX_MESSAGES_PER_SECOND)
+  {
+    limit.suppressed += 1;
+    return -1;
+  }
+
+  limit.count += 1;
+  const int suppressed = limit.suppressed;
+  limit.suppressed = 0;
+  return suppressed;
+}
+
+} // namespace
+
 static std::ostream& get_logging_instance (bool use_console_buffer = true)
 {
-  if (ConsoleBuffer::current() && use_console_buffer)
+  if (ConsoleBuffer::current() && use_console_buffer &&
+      std::this_thread::get_id() == ConsoleBuffer::current()->get_owner())
     return (ConsoleBuffer::output);
   else
-    return (std::cerr);
+    return (s_log_stream);
 }
 
 static std::ostream& log_generic_f (const char *prefix, const char* file, int line, bool use_console_buffer = true)
 {
-  get_logging_instance (use_console_buffer) << prefix << " " << file << ":" << line << " ";
-  return (get_logging_instance (use_console_buffer));
+  const int suppressed = check_rate_limit(file, line);
+  if (suppressed < 0)
+    return s_null_stream;
+
+  std::ostream& out = get_logging_instance (use_console_buffer);
+  out << prefix << " " << file << ":" << line << " ";
+  if (suppressed > 0)
+    out << "(" << suppressed << " similar messages suppressed) ";
+  return out;
 }
 
 std::ostream& log_debug_f(const char* file, int line, bool use_console_buffer = true)
@@ -0,0 +1,117 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "util/log_sink.hpp"
+
+#include <chrono>
+#include <iostream>
+
+namespace {
+
+/** Lines are collected for this long before the writer wakes up, a
+    burst of logging thus costs a single flush of the stream */
+const std::chrono::milliseconds WRITE_INTERVAL(20);
+
+} // namespace
+
+void
+LogSink::write(const std::string& line)
+{
+  LogSink* sink = current();
+  if (sink && std::this_thread::get_id() == sink->m_owner)
+  {
+    sink->push(line);
+  }
+  else
+  {
+    std::cerr << line << std::endl;
+  }
+}
+
+LogSink::LogSink(std::ostream& out) :
+  m_out(out),
+  m_owner(std::this_thread::get_id()),
+  m_mutex(),
+  m_condition(),
+  m_lines(),
+  m_dropped(0),
+  m_quit(false),
+  m_thread()
+{
+  m_thread = std::thread([this]{ run(); });
+}
+
+LogSink::~LogSink()
+{
+  m_quit = true;
+  m_condition.notify_one();
+  m_thread.join();
+
+  // lines pushed after the writer left the loop
+  write_pending();
+}
+
+void
+LogSink::push(const std::string& line)
+{
+  if (!m_lines.push(line)) {
+    m_dropped += 1;
+  }
+}
+
+void
+LogSink::flush()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+  write_pending();
+}
+
+void
+LogSink::write_pending()
+{
+  std::string line;
+  bool written = false;
+  while (m_lines.pop(line))
+  {
+    m_out << line << '\n';
+    written = true;
+  }
+
+  const int dropped = m_dropped.exchange(0);
+  if (dropped > 0)
+  {
+    m_out << "[WARNING] " << dropped << " log lines dropped\n";
+    written = true;
+  }
+
+  if (written) {
+    m_out.flush();
+  }
+}
+
+void
+LogSink::run()
+{
+  std::unique_lock<std::mutex> lock(m_mutex);
+  while (!m_quit)
+  {
+    write_pending();
+    m_condition.wait_for(lock, WRITE_INTERVAL, [this]{ return m_quit.load(); });
+  }
+}
+
+/* EOF */
@@ -0,0 +1,75 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_UTIL_LOG_SINK_HPP
+#define HEADER_SUPERTUX_UTIL_LOG_SINK_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+#include "util/currenton.hpp"
+#include "util/spsc_queue.hpp"
+
+/** Writes log lines to an ostream from a thread of its own, so a slow
+    terminal doesn't stall the frame that logged. Lines are handed over
+    through a lock-free queue by the thread that created the sink, other
+    threads and lines written while no sink exists go straight to
+    std::cerr. If the writer falls behind, lines are dropped and the
+    number of dropped lines is reported instead of blocking. */
+class LogSink final : public Currenton<LogSink>
+{
+public:
+  /** Writes line followed by a newline to the current sink, or
+      synchronously to std::cerr if there is none */
+  static void write(const std::string& line);
+
+public:
+  LogSink(std::ostream& out);
+  ~LogSink();
+
+  /** Blocks until every queued line has been written */
+  void flush();
+
+private:
+  void push(const std::string& line);
+  void run();
+
+  /** Needs m_mutex to be held */
+  void write_pending();
+
+private:
+  std::ostream& m_out;
+  const std::thread::id m_owner;
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  SPSCQueue<std::string, 1024> m_lines;
+  std::atomic<int> m_dropped;
+  std::atomic<bool> m_quit;
+  std::thread m_thread;
+
+private:
+  LogSink(const LogSink&) = delete;
+  LogSink& operator=(const LogSink&) = delete;
+};
+
+#endif
+
+/* EOF */
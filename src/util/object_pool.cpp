@@ -0,0 +1,72 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "util/object_pool.hpp"
+
+#include <algorithm>
+
+ObjectPool::ObjectPool(size_t size, size_t alignment, size_t slots_per_block) :
+  m_slot_size(),
+  m_slots_per_block(slots_per_block),
+  m_blocks(),
+  m_free_list(nullptr),
+  m_mutex()
+{
+  // slots have to be able to hold the free list link and keep the
+  // alignment of the objects, blocks come from new[] which is aligned
+  // for any fundamental type
+  alignment = std::max(alignment, alignof(void*));
+  size = std::max(size, sizeof(void*));
+  m_slot_size = (size + alignment - 1) / alignment * alignment;
+}
+
+void*
+ObjectPool::allocate()
+{
+  std::lock_guard<std::mutex> lock(m_mutex);
+
+  if (!m_free_list)
+  {
+    m_blocks.emplace_back(new char[m_slot_size * m_slots_per_block]);
+    char* block = m_blocks.back().get();
+
+    // link the slots in address order, so they are handed out that way
+    for (size_t i = m_slots_per_block; i-- > 0;)
+    {
+      void* slot = block + i * m_slot_size;
+      *static_cast<void**>(slot) = m_free_list;
+      m_free_list = slot;
+    }
+  }
+
+  void* slot = m_free_list;
+  m_free_list = *static_cast<void**>(slot);
+  return slot;
+}
+
+void
+ObjectPool::deallocate(void* ptr)
+{
+  if (!ptr)
+    return;
+
+  std::lock_guard<std::mutex> lock(m_mutex);
+  *static_cast<void**>(ptr) = m_free_list;
+  m_free_list = ptr;
+}
+
+/* EOF */
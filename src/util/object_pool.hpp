@@ -0,0 +1,90 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_UTIL_OBJECT_POOL_HPP
+#define HEADER_SUPERTUX_UTIL_OBJECT_POOL_HPP
+
+#include <memory>
+#include <mutex>
+#include <new>
+#include <stddef.h>
+#include <vector>
+
+/** Fixed size allocator that hands out slots from large blocks, so
+    objects of the same type end up next to each other in memory and
+    freed slots are reused right away. Blocks are never returned to
+    the system. */
+class ObjectPool final
+{
+public:
+  ObjectPool(size_t size, size_t alignment, size_t slots_per_block = 256);
+
+  void* allocate();
+  void deallocate(void* ptr);
+
+  size_t get_block_count() const { return m_blocks.size(); }
+
+private:
+  size_t m_slot_size;
+  size_t m_slots_per_block;
+  std::vector<std::unique_ptr<char[]>> m_blocks;
+
+  /** singly linked through the first bytes of each free slot */
+  void* m_free_list;
+
+  std::mutex m_mutex;
+
+private:
+  ObjectPool(const ObjectPool&) = delete;
+  ObjectPool& operator=(const ObjectPool&) = delete;
+};
+
+/** Inherit from this to allocate all instances of T from an
+    ObjectPool, T should be final. */
+template<typename T>
+class PooledObject
+{
+public:
+  static void* operator new(size_t size)
+  {
+    if (size != sizeof(T))
+      return ::operator new(size);
+    return get_pool().allocate();
+  }
+
+  static void operator delete(void* ptr, size_t size)
+  {
+    if (size != sizeof(T)) {
+      ::operator delete(ptr);
+    } else {
+      get_pool().deallocate(ptr);
+    }
+  }
+
+private:
+  static ObjectPool& get_pool()
+  {
+    // leaked on purpose, objects may still be destroyed after static
+    // destructors ran
+    static ObjectPool* pool = new ObjectPool(sizeof(T), alignof(T));
+    return *pool;
+  }
+};
+
+#endif
+
+/* EOF */
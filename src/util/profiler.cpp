@@ -0,0 +1,387 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "util/profiler.hpp"
+
+#include <algorithm>
+#include <assert.h>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#include "util/allocation_tracker.hpp"
+#include "util/log.hpp"
+
+namespace {
+
+std::atomic<int> s_next_thread_index(0);
+thread_local int t_thread_index = -1;
+
+/** Zones entered on a thread other than the profiled one, while a
+    trace is written */
+thread_local std::vector<std::pair<const char*, uint64_t> > t_open_zones;
+
+std::mutex s_thread_names_mutex;
+std::vector<std::pair<int, const char*> > s_thread_names;
+
+void
+write_json_string(std::ostream& out, const char* text)
+{
+  out << '"';
+  for (const char* c = text; *c; ++c)
+  {
+    if (*c == '"' || *c == '\\') {
+      out << '\\' << *c;
+    } else if (static_cast<unsigned char>(*c) >= 0x20) {
+      out << *c;
+    }
+  }
+  out << '"';
+}
+
+} // namespace
+
+const size_t Profiler::NUM_FRAMES;
+const int Profiler::NO_ZONE;
+
+Profiler g_profiler;
+
+uint64_t
+Profiler::get_time_ns()
+{
+  return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+    std::chrono::steady_clock::now().time_since_epoch()).count());
+}
+
+int
+Profiler::get_thread_index()
+{
+  if (t_thread_index < 0) {
+    t_thread_index = s_next_thread_index++;
+  }
+  return t_thread_index;
+}
+
+void
+Profiler::set_thread_name(const char* name)
+{
+  std::lock_guard<std::mutex> lock(s_thread_names_mutex);
+  s_thread_names.emplace_back(get_thread_index(), name);
+}
+
+std::vector<Profiler::Node>
+Profiler::get_tree(const Frame& frame)
+{
+  struct TreeNode
+  {
+    const char* name;
+    int calls;
+    float ms;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+    std::vector<size_t> children;
+  };
+
+  // tree[0] is the root, zone_nodes maps every zone to its node, the
+  // zones come in preorder, so a parent is always mapped before its
+  // children
+  std::vector<TreeNode> tree(1);
+  std::vector<size_t> zone_nodes(frame.zones.size());
+
+  for (size_t i = 0; i < frame.zones.size(); ++i)
+  {
+    const Zone& zone = frame.zones[i];
+    const size_t parent = (zone.parent == NO_ZONE) ? 0 : zone_nodes[zone.parent];
+
+    // siblings are merged into the first node of that name
+    size_t node = 0;
+    for (size_t child : tree[parent].children) {
+      if (strcmp(tree[child].name, zone.name) == 0) {
+        node = child;
+        break;
+      }
+    }
+
+    if (node == 0)
+    {
+      node = tree.size();
+      tree.push_back(TreeNode{zone.name, 0, 0.0f, 0, 0, {}});
+      tree[parent].children.push_back(node);
+    }
+
+    tree[node].calls += 1;
+    tree[node].ms += static_cast<float>(zone.end_ns - zone.start_ns) / 1000000.0f;
+    tree[node].allocations += zone.allocations;
+    tree[node].allocated_bytes += zone.allocated_bytes;
+    zone_nodes[i] = node;
+  }
+
+  // flatten in preorder
+  std::vector<Node> nodes;
+  std::vector<std::pair<size_t, int> > stack;
+  for (auto it = tree[0].children.rbegin(); it != tree[0].children.rend(); ++it) {
+    stack.emplace_back(*it, 0);
+  }
+  while (!stack.empty())
+  {
+    const size_t node = stack.back().first;
+    const int depth = stack.back().second;
+    stack.pop_back();
+
+    nodes.push_back(Node{tree[node].name, depth, tree[node].calls, tree[node].ms,
+                         tree[node].allocations, tree[node].allocated_bytes});
+    for (auto it = tree[node].children.rbegin(); it != tree[node].children.rend(); ++it) {
+      stack.emplace_back(*it, depth + 1);
+    }
+  }
+
+  return nodes;
+}
+
+Profiler::Profiler() :
+  m_enabled(false),
+  m_requested(false),
+  m_thread(),
+  m_frames(),
+  m_frame_id(0),
+  m_frame_count(0),
+  m_current_zone(NO_ZONE),
+  m_tracing(false),
+  m_trace(),
+  m_trace_start_ns(0),
+  m_trace_mutex(),
+  m_trace_events()
+{
+}
+
+void
+Profiler::open_trace(const std::string& filename)
+{
+  close_trace();
+
+  m_trace.open(filename);
+  if (!m_trace)
+  {
+    log_warning << "Couldn't open trace file '" << filename << "'" << std::endl;
+    return;
+  }
+
+  m_trace << "{\"traceEvents\":[\n";
+  m_trace << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"args\":{\"name\":\"SuperTux\"}}";
+  m_trace_start_ns = get_time_ns();
+  m_tracing = true;
+}
+
+void
+Profiler::close_trace()
+{
+  if (!m_tracing)
+    return;
+
+  // zones of other threads that finished after the last frame
+  write_trace(Frame());
+
+  {
+    std::lock_guard<std::mutex> lock(s_thread_names_mutex);
+    for (const auto& thread : s_thread_names)
+    {
+      m_trace << ",\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << thread.first
+              << ",\"args\":{\"name\":";
+      write_json_string(m_trace, thread.second);
+      m_trace << "}}";
+    }
+  }
+
+  m_trace << "\n]}\n";
+  m_trace.close();
+  m_tracing = false;
+}
+
+void
+Profiler::write_trace_event(const char* name, uint64_t start_ns, uint64_t end_ns, int thread)
+{
+  // timestamps are in microseconds
+  char times[64];
+  snprintf(times, sizeof(times), "\"ts\":%.3f,\"dur\":%.3f",
+           static_cast<double>(start_ns - m_trace_start_ns) / 1000.0,
+           static_cast<double>(end_ns - start_ns) / 1000.0);
+
+  m_trace << ",\n{\"name\":";
+  write_json_string(m_trace, name);
+  m_trace << ",\"ph\":\"X\",\"pid\":1,\"tid\":" << thread << "," << times << "}";
+}
+
+void
+Profiler::add_counter(const char* name, float value)
+{
+  if (!m_tracing || std::this_thread::get_id() != m_thread)
+    return;
+
+  char args[64];
+  snprintf(args, sizeof(args), "\"ts\":%.3f,\"args\":{\"value\":%.3f}",
+           static_cast<double>(get_time_ns() - m_trace_start_ns) / 1000.0,
+           static_cast<double>(value));
+
+  m_trace << ",\n{\"name\":";
+  write_json_string(m_trace, name);
+  m_trace << ",\"ph\":\"C\",\"pid\":1," << args << "}";
+}
+
+void
+Profiler::write_trace(const Frame& frame)
+{
+  const int thread = get_thread_index();
+
+  // zones that started before the trace was opened are left out
+  if (frame.start_ns >= m_trace_start_ns && frame.end_ns > frame.start_ns)
+  {
+    write_trace_event("frame", frame.start_ns, frame.end_ns, thread);
+    for (const auto& zone : frame.zones) {
+      write_trace_event(zone.name, zone.start_ns, zone.end_ns, thread);
+    }
+  }
+
+  std::vector<TraceEvent> events;
+  {
+    std::lock_guard<std::mutex> lock(m_trace_mutex);
+    events.swap(m_trace_events);
+  }
+
+  for (const auto& event : events) {
+    if (event.start_ns >= m_trace_start_ns) {
+      write_trace_event(event.name, event.start_ns, event.end_ns, event.thread);
+    }
+  }
+}
+
+void
+Profiler::set_enabled(bool enabled)
+{
+  if (enabled && !m_requested) {
+    m_thread = std::this_thread::get_id();
+  }
+  m_requested = enabled;
+}
+
+void
+Profiler::begin_frame()
+{
+  assert(m_current_zone == NO_ZONE);
+
+  const uint64_t now = get_time_ns();
+
+  if (m_enabled)
+  {
+    Frame& frame = current();
+    frame.end_ns = now;
+    frame.allocations = AllocationTracker::get_thread_allocation_count() - frame.allocations;
+    frame.allocated_bytes = AllocationTracker::get_thread_allocated_bytes() - frame.allocated_bytes;
+    if (m_tracing) {
+      write_trace(current());
+    }
+    m_frame_id += 1;
+    m_frame_count = std::min(m_frame_count + 1, NUM_FRAMES);
+  }
+  else if (m_requested)
+  {
+    // old frames would have a gap before the first new one
+    m_frame_count = 0;
+  }
+
+  m_enabled = m_requested;
+
+  if (m_enabled)
+  {
+    Frame& frame = current();
+    frame.id = m_frame_id;
+    frame.start_ns = now;
+    frame.end_ns = now;
+    frame.allocations = AllocationTracker::get_thread_allocation_count();
+    frame.allocated_bytes = AllocationTracker::get_thread_allocated_bytes();
+    frame.zones.clear();
+  }
+}
+
+const Profiler::Frame*
+Profiler::get_frame(size_t n) const
+{
+  if (n >= m_frame_count)
+    return nullptr;
+
+  return &m_frames[(m_frame_id - 1 - n) % m_frames.size()];
+}
+
+const Profiler::Frame*
+Profiler::get_slowest_frame() const
+{
+  const Frame* slowest = nullptr;
+  for (size_t i = 0; i < m_frame_count; ++i)
+  {
+    const Frame* frame = get_frame(i);
+    if (!slowest || frame->get_duration_ns() > slowest->get_duration_ns()) {
+      slowest = frame;
+    }
+  }
+  return slowest;
+}
+
+int
+Profiler::begin_zone(const char* name)
+{
+  if (std::this_thread::get_id() != m_thread)
+  {
+    if (!m_tracing)
+      return NO_ZONE;
+
+    t_open_zones.emplace_back(name, get_time_ns());
+    return static_cast<int>(t_open_zones.size()) - 1;
+  }
+
+  auto& zones = current().zones;
+  const int zone = static_cast<int>(zones.size());
+  // the counters are stored now and turned into differences when the
+  // zone ends
+  zones.push_back(Zone{name, get_time_ns(), 0, m_current_zone,
+                       AllocationTracker::get_thread_allocation_count(),
+                       AllocationTracker::get_thread_allocated_bytes()});
+  m_current_zone = zone;
+  return zone;
+}
+
+void
+Profiler::end_zone(int zone)
+{
+  if (std::this_thread::get_id() != m_thread)
+  {
+    // zones of a thread close in reverse order
+    assert(zone == static_cast<int>(t_open_zones.size()) - 1);
+    const auto entry = t_open_zones.back();
+    t_open_zones.pop_back();
+
+    std::lock_guard<std::mutex> lock(m_trace_mutex);
+    m_trace_events.push_back(TraceEvent{entry.first, entry.second, get_time_ns(), get_thread_index()});
+    return;
+  }
+
+  auto& zones = current().zones;
+  zones[zone].end_ns = get_time_ns();
+  zones[zone].allocations = AllocationTracker::get_thread_allocation_count() - zones[zone].allocations;
+  zones[zone].allocated_bytes = AllocationTracker::get_thread_allocated_bytes() - zones[zone].allocated_bytes;
+  m_current_zone = zones[zone].parent;
+}
+
+/* EOF */
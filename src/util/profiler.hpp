@@ -0,0 +1,204 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_UTIL_PROFILER_HPP
+#define HEADER_SUPERTUX_UTIL_PROFILER_HPP
+
+#include <array>
+#include <atomic>
+#include <fstream>
+#include <mutex>
+#include <stdint.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+class Profiler;
+extern Profiler g_profiler;
+
+/** Records a tree of named zones per frame and keeps the last
+    NUM_FRAMES frames around. Zones are only recorded on the thread
+    that enabled the profiler, unless a trace is written, which gets
+    the zones of all threads. While disabled a Scope costs a single
+    check of a flag. */
+class Profiler final
+{
+public:
+  static const size_t NUM_FRAMES = 120;
+  static const int NO_ZONE = -1;
+
+  struct Zone
+  {
+    /** must outlive the profiler, a string literal usually */
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int parent;
+
+    /** heap allocations made within the zone, including its children,
+        see AllocationTracker */
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+  };
+
+  struct Frame
+  {
+    Frame() : id(0), start_ns(0), end_ns(0), allocations(0), allocated_bytes(0), zones() {}
+
+    uint64_t get_duration_ns() const { return end_ns - start_ns; }
+
+    uint32_t id;
+    uint64_t start_ns;
+    uint64_t end_ns;
+
+    /** heap allocations of the profiled thread during the frame */
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+
+    /** in the order the zones were entered, parents come first */
+    std::vector<Zone> zones;
+  };
+
+  /** Zones of a frame with siblings of the same name merged, e.g. all
+      logical steps of a frame end up in one "update" node */
+  struct Node
+  {
+    const char* name;
+    int depth;
+    int calls;
+    float ms;
+    uint64_t allocations;
+    uint64_t allocated_bytes;
+  };
+
+  /** Records its lifetime as a zone in the current frame */
+  class Scope final
+  {
+  public:
+    Scope(const char* name) :
+      m_zone(g_profiler.is_enabled() ? g_profiler.begin_zone(name) : NO_ZONE)
+    {}
+
+    ~Scope()
+    {
+      if (m_zone != NO_ZONE) {
+        g_profiler.end_zone(m_zone);
+      }
+    }
+
+  private:
+    int m_zone;
+
+  private:
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+  };
+
+public:
+  /** Nanoseconds of a monotonic clock */
+  static uint64_t get_time_ns();
+
+  /** Names the calling thread in traces, name has to outlive the
+      profiler */
+  static void set_thread_name(const char* name);
+
+  static std::vector<Node> get_tree(const Frame& frame);
+
+public:
+  Profiler();
+
+  /** Enables or disables recording for the calling thread, takes
+      effect with the next frame */
+  void set_enabled(bool enabled);
+  bool is_enabled() const { return m_enabled.load(std::memory_order_relaxed); }
+
+  /** Writes the zones of all threads to filename as Chrome Trace
+      Event JSON until close_trace(), the file can be loaded into
+      chrome://tracing or Perfetto. Frames have to be recorded
+      meanwhile, see set_enabled(). */
+  void open_trace(const std::string& filename);
+  void close_trace();
+  bool is_tracing() const { return m_tracing.load(std::memory_order_relaxed); }
+
+  /** Finishes the current frame and starts a new one, has to be
+      called while no zone is open */
+  void begin_frame();
+
+  /** Returns the nth most recent complete frame, 0 is the latest,
+      or nullptr if there is no such frame */
+  const Frame* get_frame(size_t n) const;
+
+  /** The complete frame that took longest, or nullptr */
+  const Frame* get_slowest_frame() const;
+
+  size_t get_frame_count() const { return m_frame_count; }
+
+  /** Returns NO_ZONE when called from another thread while no
+      trace is written */
+  int begin_zone(const char* name);
+  void end_zone(int zone);
+
+  /** Writes a sample of a value to the trace, shown as a graph next
+      to the zones. Only the profiled thread may call this, name has
+      to outlive the profiler. */
+  void add_counter(const char* name, float value);
+
+private:
+  /** A zone of a thread other than the profiled one */
+  struct TraceEvent
+  {
+    const char* name;
+    uint64_t start_ns;
+    uint64_t end_ns;
+    int thread;
+  };
+
+private:
+  /** Small number identifying the calling thread in traces */
+  static int get_thread_index();
+
+  Frame& current() { return m_frames[m_frame_id % m_frames.size()]; }
+
+  /** Writes frame and the zones other threads finished meanwhile */
+  void write_trace(const Frame& frame);
+  void write_trace_event(const char* name, uint64_t start_ns, uint64_t end_ns, int thread);
+
+private:
+  std::atomic<bool> m_enabled;
+  bool m_requested;
+  std::thread::id m_thread;
+  std::array<Frame, NUM_FRAMES + 1> m_frames;
+  uint32_t m_frame_id;
+  size_t m_frame_count;
+  int m_current_zone;
+
+  std::atomic<bool> m_tracing;
+  std::ofstream m_trace;
+  uint64_t m_trace_start_ns;
+
+  /** Protects m_trace_events */
+  std::mutex m_trace_mutex;
+  std::vector<TraceEvent> m_trace_events;
+
+private:
+  Profiler(const Profiler&) = delete;
+  Profiler& operator=(const Profiler&) = delete;
+};
+
+#endif
+
+/* EOF */
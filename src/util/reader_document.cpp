@@ -16,12 +16,37 @@
 
 #include "util/reader_document.hpp"
 
+#include <assert.h>
+#include <iterator>
 #include <sexp/parser.hpp>
 #include <sstream>
 
 #include "physfs/ifile_stream.hpp"
 #include "util/file_system.hpp"
+#include "util/job_system.hpp"
 #include "util/log.hpp"
+#include "util/sexp_cache.hpp"
+
+namespace {
+
+/** Trees with more entries than this two levels below the root, e.g.
+    the objects of the sectors of a level, are freed by a worker, as
+    walking millions of nodes would stall the main thread */
+const size_t MIN_RELEASED_IN_BACKGROUND = 256;
+
+size_t count_entries(const sexp::Value& sx)
+{
+  if (!sx.is_array())
+    return 0;
+
+  size_t count = 0;
+  for (const auto& child : sx.as_array()) {
+    count += child.is_array() ? child.as_array().size() : 1;
+  }
+  return count;
+}
+
+} // namespace
 
 ReaderDocument
 ReaderDocument::from_stream(std::istream& stream, const std::string& filename)
@@ -35,26 +60,126 @@ ReaderDocument::from_file(const std::string& filename)
 {
   log_debug << "ReaderDocument::parse: " << filename << std::endl;
 
+  sexp::Value sx;
+  if (SExpCache::load(filename, sx)) {
+    return ReaderDocument(filename, std::move(sx));
+  }
+
   IFileStream in(filename);
   if (!in.good()) {
     std::stringstream msg;
     msg << "Parser problem: Couldn't open file '" << filename << "'.";
     throw std::runtime_error(msg.str());
   } else {
-    return from_stream(in, filename);
+    const std::string content((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    if (BinaryDocument::is_binary(content)) {
+      ReaderDocument doc = from_binary(filename, content);
+      doc.m_data_is_file = true;
+      return doc;
+    }
+
+    if (SExpCache::load(filename, content, sx)) {
+      return ReaderDocument(filename, std::move(sx));
+    }
+
+    // the tile arrays make up most of a level, reading them directly
+    // saves creating a node per tile
+    auto data = std::make_shared<std::string>();
+    std::vector<BinaryDocument::Blob> blobs;
+    std::istringstream stream(BinaryDocument::extract_text_blobs(content, *data, blobs));
+    sx = sexp::Parser::from_stream(stream, sexp::Parser::USE_ARRAYS);
+    if (blobs.empty()) {
+      SExpCache::store(filename, content, sx);
+      return ReaderDocument(filename, std::move(sx));
+    }
+
+    // the cache can't hold the blobs, and parsing what's left is cheap
+    ReaderDocument doc(filename, std::move(sx));
+    doc.m_data = std::move(data);
+    doc.m_blobs = std::move(blobs);
+    return doc;
+  }
+}
+
+ReaderDocument
+ReaderDocument::from_binary(const std::string& filename, const std::string& content)
+{
+  auto data = std::make_shared<const std::string>(content);
+  sexp::Value sx;
+  std::vector<BinaryDocument::Blob> blobs;
+  if (!BinaryDocument::decode(*data, sx, blobs)) {
+    std::stringstream msg;
+    msg << "Parser problem: '" << filename << "' is not a valid binary document.";
+    throw std::runtime_error(msg.str());
   }
+
+  ReaderDocument doc(filename, std::move(sx));
+  doc.m_data = std::move(data);
+  doc.m_blobs = std::move(blobs);
+  return doc;
+}
+
+void
+ReaderDocument::release(sexp::Value* sx)
+{
+  JobSystem* job_system = JobSystem::current();
+  if (!job_system || count_entries(*sx) < MIN_RELEASED_IN_BACKGROUND)
+  {
+    delete sx;
+    return;
+  }
+
+  // nothing else refers to the tree anymore, so the worker owns it
+  job_system->schedule([sx] { delete sx; });
 }
 
 ReaderDocument::ReaderDocument(const std::string& filename, sexp::Value sx) :
   m_filename(filename),
-  m_sx(std::move(sx))
+  m_sx(new sexp::Value(std::move(sx)), &ReaderDocument::release),
+  m_data(),
+  m_blobs(),
+  m_data_is_file(false)
+{
+}
+
+bool
+ReaderDocument::get_blob(int index, std::vector<unsigned int>& value) const
+{
+  if (!m_data || index < 0 || static_cast<size_t>(index) >= m_blobs.size())
+    return false;
+
+  BinaryDocument::read_blob(*m_data, m_blobs[index], value);
+  return true;
+}
+
+bool
+ReaderDocument::get_file_blob(int index, BinaryDocument::Blob& blob) const
+{
+  if (!m_data_is_file || index < 0 || static_cast<size_t>(index) >= m_blobs.size())
+    return false;
+
+  blob = m_blobs[index];
+  return true;
+}
+
+void
+ReaderDocument::read_file_blob(const BinaryDocument::Blob& blob, size_t first, size_t count,
+                               unsigned int* value) const
+{
+  assert(m_data_is_file && first + count <= blob.count);
+  BinaryDocument::decode_values(m_data->data() + blob.offset + first * 4, count, value);
+}
+
+size_t
+ReaderDocument::get_file_size() const
 {
+  return m_data_is_file ? m_data->size() : 0;
 }
 
 ReaderObject
 ReaderDocument::get_root() const
 {
-  return ReaderObject(*this, m_sx);
+  return ReaderObject(*this, *m_sx);
 }
 
 std::string
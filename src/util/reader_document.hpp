@@ -18,18 +18,28 @@
 #define HEADER_SUPERTUX_UTIL_READER_DOCUMENT_HPP
 
 #include <istream>
+#include <memory>
 #include <sexp/value.hpp>
+#include <vector>
+
+#include "util/binary_document.hpp"
 
 #include "util/reader_object.hpp"
 
 /** The ReaderDocument holds a parsed document in memory, access to
-    it's content is provided by get_root() */
+    it's content is provided by get_root(). Copies share the tree,
+    which large documents free on a worker thread once the last copy
+    is gone. */
 class ReaderDocument final
 {
 public:
   static ReaderDocument from_stream(std::istream& stream, const std::string& filename = "<stream>");
   static ReaderDocument from_file(const std::string& filename);
 
+  /** Creates a document from the content of a binary level, see
+      BinaryDocument */
+  static ReaderDocument from_binary(const std::string& filename, const std::string& content);
+
 public:
   ReaderDocument(const std::string& filename, sexp::Value sx);
 
@@ -42,11 +52,39 @@ public:
   /** Returns the directory of the document */
   std::string get_directory() const;
 
-  const sexp::Value& get_sexp() const { return m_sx; }
+  const sexp::Value& get_sexp() const { return *m_sx; }
+
+  /** Copies the array referenced by (blob INDEX), returns false if there is no such blob */
+  bool get_blob(int index, std::vector<unsigned int>& value) const;
+
+  /** Returns the blob if the document was read from a binary file by
+      from_file(), its offset is where the array starts in the file */
+  bool get_file_blob(int index, BinaryDocument::Blob& blob) const;
+
+  /** Decodes count values of a blob returned by get_file_blob(),
+      starting at value first, without copying the rest */
+  void read_file_blob(const BinaryDocument::Blob& blob, size_t first, size_t count,
+                      unsigned int* value) const;
+
+  /** Size of the file get_file_blob() refers to */
+  size_t get_file_size() const;
+
+private:
+  /** Deleter of m_sx */
+  static void release(sexp::Value* sx);
 
 private:
   std::string m_filename;
-  sexp::Value m_sx;
+  std::shared_ptr<const sexp::Value> m_sx;
+
+  /** Content and blob table of binary documents and of the tile
+      arrays of text documents, shared as
+      ReaderDocument gets copied around */
+  std::shared_ptr<const std::string> m_data;
+  std::vector<BinaryDocument::Blob> m_blobs;
+
+  /** m_data is the whole content of the file m_filename */
+  bool m_data_is_file;
 };
 
 #endif
@@ -16,6 +16,7 @@
 
 #include "util/reader_mapping.hpp"
 
+#include <algorithm>
 #include <boost/ref.hpp>
 #include <boost/utility/typed_in_place_factory.hpp>
 #include <sexp/io.hpp>
@@ -27,12 +28,28 @@
 #include "util/reader_document.hpp"
 #include "util/reader_error.hpp"
 
+namespace {
+
+/** Mappings with more entries than this get an index, below a linear
+    scan is faster than building it */
+const size_t MIN_INDEXED_ITEMS = 8;
+
+/** Key of an entry already checked by get_key() */
+const std::string& checked_key(const sexp::Value& pair)
+{
+  return pair.as_array()[0].as_string();
+}
+
+} // namespace
+
 bool ReaderMapping::s_translations_enabled = true;
 
 ReaderMapping::ReaderMapping(const ReaderDocument& doc, const sexp::Value& sx) :
   m_doc(doc),
   m_sx(sx),
-  m_arr([this]() -> decltype(m_arr){ assert_is_array(m_doc, m_sx); return m_sx.as_array();}())
+  m_arr([this]() -> decltype(m_arr){ assert_is_array(m_doc, m_sx); return m_sx.as_array();}()),
+  m_index(),
+  m_used()
 {
 }
 
@@ -44,27 +61,86 @@ ReaderMapping::get_iter() const
   return ReaderIterator(m_doc, m_sx);
 }
 
-const sexp::Value*
-ReaderMapping::get_item(const char* key) const
+const std::string&
+ReaderMapping::get_key(size_t index) const
 {
+  auto const& pair = m_arr[index];
+
+  // size should be >=2 not >=1, but we have to allow smaller once
+  // due to get_iter(), e.g. (particles-snow)
+  assert_array_size_ge(m_doc, pair, 1);
+
+  assert_is_symbol(m_doc, pair.as_array()[0]);
+
+  return pair.as_array()[0].as_string();
+}
+
+void
+ReaderMapping::build_index() const
+{
+  m_index.reserve(m_arr.size() - 1);
   for (size_t i = 1; i < m_arr.size(); ++i)
   {
-    auto const& pair = m_arr[i];
+    get_key(i); // validates the entry
+    m_index.push_back(static_cast<uint32_t>(i));
+  }
 
-    // size should be >=2 not >=1, but we have to allow smaller once
-    // due to get_iter(), e.g. (particles-snow)
-    assert_array_size_ge(m_doc, pair, 1);
+  // stable, so duplicate keys resolve to the first one like in a scan
+  std::stable_sort(m_index.begin(), m_index.end(),
+                   [this](uint32_t lhs, uint32_t rhs) {
+                     return checked_key(m_arr[lhs]) < checked_key(m_arr[rhs]);
+                   });
+}
 
-    assert_is_symbol(m_doc, pair.as_array()[0]);
+const sexp::Value*
+ReaderMapping::get_item(const char* key) const
+{
+  if (m_used.empty()) {
+    m_used.resize(m_arr.size());
+  }
+
+  if (m_arr.size() > MIN_INDEXED_ITEMS)
+  {
+    if (m_index.empty()) {
+      build_index();
+    }
 
-    if (pair.as_array()[0].as_string() == key)
+    auto it = std::lower_bound(m_index.begin(), m_index.end(), key,
+                               [this](uint32_t index, const char* k) {
+                                 return checked_key(m_arr[index]).compare(k) < 0;
+                               });
+    if (it != m_index.end() && checked_key(m_arr[*it]) == key)
     {
-      return &pair;
+      m_used[*it] = true;
+      return &m_arr[*it];
+    }
+    return nullptr;
+  }
+
+  for (size_t i = 1; i < m_arr.size(); ++i)
+  {
+    if (get_key(i) == key)
+    {
+      m_used[i] = true;
+      return &m_arr[i];
     }
   }
   return nullptr;
 }
 
+std::vector<std::string>
+ReaderMapping::get_unused_keys() const
+{
+  std::vector<std::string> keys;
+  for (size_t i = 1; i < m_arr.size(); ++i)
+  {
+    if (m_used.empty() || !m_used[i]) {
+      keys.push_back(get_key(i));
+    }
+  }
+  return keys;
+}
+
 #define GET_VALUE_MACRO(type, checker, getter)                          \
   auto const sx = get_item(key);                                        \
   if (!sx) {                                                            \
@@ -146,6 +222,7 @@ ReaderMapping::get(const char* key, std::string& value, const boost::optional<co
   } else {                                                              \
     assert_is_array(m_doc, *sx);                                        \
     auto const& item = sx->as_array();                                  \
+    value.reserve(value.size() + item.size());                          \
     for (size_t i = 1; i < item.size(); ++i)                             \
     {                                                                   \
       assert_##checker(m_doc, item[i]);                                 \
@@ -187,11 +264,27 @@ bool
 ReaderMapping::get(const char* key, std::vector<unsigned int>& value) const
 {
   value.clear();
+
+  // binary documents keep large arrays out of the sexp tree
+  auto const blob = get_item(key);
+  if (blob && blob->is_array() && blob->as_array().size() == 2 &&
+      m_doc.get_blob(BinaryDocument::get_blob_index(blob->as_array()[1]), value)) {
+    return true;
+  }
+
   GET_VALUES_MACRO("unsigned int", is_integer, as_int);
 }
 
 #undef GET_VALUES_MACRO
 
+bool
+ReaderMapping::get_file_blob(const char* key, BinaryDocument::Blob& blob) const
+{
+  auto const sx = get_item(key);
+  return sx && sx->is_array() && sx->as_array().size() == 2 &&
+    m_doc.get_file_blob(BinaryDocument::get_blob_index(sx->as_array()[1]), blob);
+}
+
 bool
 ReaderMapping::get(const char* key, boost::optional<ReaderMapping>& value) const
 {
@@ -18,6 +18,9 @@
 #define HEADER_SUPERTUX_UTIL_READER_MAPPING_HPP
 
 #include <boost/optional.hpp>
+#include <stdint.h>
+#include <string>
+#include <vector>
 
 #include "util/reader_iterator.hpp"
 
@@ -25,6 +28,10 @@ namespace sexp {
 class Value;
 } // namespace sexp
 
+namespace BinaryDocument {
+struct Blob;
+} // namespace BinaryDocument
+
 class ReaderDocument;
 class ReaderCollection;
 
@@ -56,6 +63,10 @@ public:
 
   bool get(const char* key, sexp::Value& value) const;
 
+  /** Like ReaderDocument::get_file_blob() for the array at key, false
+      if it isn't a blob of a binary file */
+  bool get_file_blob(const char* key, BinaryDocument::Blob& blob) const;
+
   /** Read a custom data format, such an as enum. The data is stored
       as string and converted to the custom type using the supplied
       `from_string` convert function. Example:
@@ -82,14 +93,30 @@ public:
   const sexp::Value& get_sexp() const { return m_sx; }
   const ReaderDocument& get_doc() const { return m_doc; }
 
+  /** Keys no get() of this mapping asked for so far, in the order of
+      the file, e.g. to point out misspelled properties. Keys read
+      through get_iter() count as unused. */
+  std::vector<std::string> get_unused_keys() const;
+
 private:
   /** Returns pointer to (key value) */
   const sexp::Value* get_item(const char* key) const;
 
+  const std::string& get_key(size_t index) const;
+  void build_index() const;
+
 private:
   const ReaderDocument& m_doc;
   const sexp::Value& m_sx;
   const std::vector<sexp::Value>& m_arr;
+
+  /** Indices into m_arr sorted by key, built on the first lookup in
+      mappings too large to be scanned quickly */
+  mutable std::vector<uint32_t> m_index;
+
+  /** Per entry of m_arr, whether get_item() returned it, empty until
+      the first lookup */
+  mutable std::vector<bool> m_used;
 };
 
 #endif
@@ -0,0 +1,496 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "util/sexp_cache.hpp"
+
+#include <atomic>
+#include <mutex>
+#include <physfs.h>
+#include <sexp/value.hpp>
+#include <stdint.h>
+#include <string.h>
+
+#include "addon/md5.hpp"
+#include "supertux/load_stats.hpp"
+#include "util/log.hpp"
+
+namespace {
+
+const char CACHE_DIRECTORY[] = "cache/sexp";
+
+/** Changes whenever the encoding changes */
+const char MAGIC[] = "STSX1";
+const size_t MAGIC_LENGTH = sizeof(MAGIC) - 1;
+
+/** Serializes writers, the sprite prefetcher parses on worker threads */
+std::mutex s_store_mutex;
+
+std::atomic<bool> s_read_only(false);
+
+class Encoder final
+{
+public:
+  Encoder(std::string& out) : m_out(out) {}
+
+  void write_uint(uint64_t value)
+  {
+    // LEB128
+    while (value >= 0x80) {
+      m_out += static_cast<char>((value & 0x7f) | 0x80);
+      value >>= 7;
+    }
+    m_out += static_cast<char>(value);
+  }
+
+  void write_int(int64_t value)
+  {
+    // zigzag, so small negative numbers stay small
+    write_uint((static_cast<uint64_t>(value) << 1) ^ static_cast<uint64_t>(value >> 63));
+  }
+
+  void write_string(const std::string& value)
+  {
+    write_uint(value.size());
+    m_out += value;
+  }
+
+  void write_value(const sexp::Value& sx)
+  {
+    m_out += static_cast<char>(sx.get_type());
+    write_int(sx.get_line());
+
+    switch (sx.get_type())
+    {
+      case sexp::Value::Type::NIL:
+        break;
+
+      case sexp::Value::Type::BOOLEAN:
+        m_out += static_cast<char>(sx.as_bool() ? 1 : 0);
+        break;
+
+      case sexp::Value::Type::INTEGER:
+        write_int(sx.as_int());
+        break;
+
+      case sexp::Value::Type::REAL:
+      {
+        const float value = sx.as_float();
+        uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        for (int i = 0; i < 4; ++i) {
+          m_out += static_cast<char>((bits >> (8 * i)) & 0xff);
+        }
+        break;
+      }
+
+      case sexp::Value::Type::STRING:
+      case sexp::Value::Type::SYMBOL:
+        write_string(sx.as_string());
+        break;
+
+      case sexp::Value::Type::CONS:
+        write_value(sx.get_car());
+        write_value(sx.get_cdr());
+        break;
+
+      case sexp::Value::Type::ARRAY:
+        write_uint(sx.as_array().size());
+        for (const auto& item : sx.as_array()) {
+          write_value(item);
+        }
+        break;
+    }
+  }
+
+private:
+  std::string& m_out;
+
+private:
+  Encoder(const Encoder&) = delete;
+  Encoder& operator=(const Encoder&) = delete;
+};
+
+class Decoder final
+{
+public:
+  Decoder(const std::string& data) : m_data(data), m_pos(0) {}
+
+  bool at_end() const { return m_pos == m_data.size(); }
+
+  bool read_byte(uint8_t& value)
+  {
+    if (m_pos >= m_data.size())
+      return false;
+
+    value = static_cast<uint8_t>(m_data[m_pos++]);
+    return true;
+  }
+
+  bool read_uint(uint64_t& value)
+  {
+    value = 0;
+    for (int shift = 0; shift < 64; shift += 7)
+    {
+      uint8_t byte;
+      if (!read_byte(byte))
+        return false;
+
+      value |= static_cast<uint64_t>(byte & 0x7f) << shift;
+      if (!(byte & 0x80))
+        return true;
+    }
+    return false;
+  }
+
+  bool read_int(int64_t& value)
+  {
+    uint64_t zigzag;
+    if (!read_uint(zigzag))
+      return false;
+
+    value = static_cast<int64_t>(zigzag >> 1) ^ -static_cast<int64_t>(zigzag & 1);
+    return true;
+  }
+
+  bool read_string(std::string& value)
+  {
+    uint64_t size;
+    if (!read_uint(size) || size > m_data.size() - m_pos)
+      return false;
+
+    value.assign(m_data, m_pos, static_cast<size_t>(size));
+    m_pos += static_cast<size_t>(size);
+    return true;
+  }
+
+  bool read_magic()
+  {
+    if (m_data.compare(0, MAGIC_LENGTH, MAGIC) != 0)
+      return false;
+
+    m_pos = MAGIC_LENGTH;
+    return true;
+  }
+
+  bool read_value(sexp::Value& sx)
+  {
+    uint8_t type;
+    int64_t line;
+    if (!read_byte(type) || !read_int(line))
+      return false;
+
+    switch (static_cast<sexp::Value::Type>(type))
+    {
+      case sexp::Value::Type::NIL:
+        sx = sexp::Value::nil();
+        break;
+
+      case sexp::Value::Type::BOOLEAN:
+      {
+        uint8_t value;
+        if (!read_byte(value))
+          return false;
+        sx = sexp::Value::boolean(value != 0);
+        break;
+      }
+
+      case sexp::Value::Type::INTEGER:
+      {
+        int64_t value;
+        if (!read_int(value))
+          return false;
+        sx = sexp::Value::integer(static_cast<int>(value));
+        break;
+      }
+
+      case sexp::Value::Type::REAL:
+      {
+        uint32_t bits = 0;
+        for (int i = 0; i < 4; ++i)
+        {
+          uint8_t byte;
+          if (!read_byte(byte))
+            return false;
+          bits |= static_cast<uint32_t>(byte) << (8 * i);
+        }
+        float value;
+        memcpy(&value, &bits, sizeof(value));
+        sx = sexp::Value::real(value);
+        break;
+      }
+
+      case sexp::Value::Type::STRING:
+      case sexp::Value::Type::SYMBOL:
+      {
+        std::string value;
+        if (!read_string(value))
+          return false;
+        sx = (static_cast<sexp::Value::Type>(type) == sexp::Value::Type::STRING) ?
+          sexp::Value::string(value) : sexp::Value::symbol(value);
+        break;
+      }
+
+      case sexp::Value::Type::CONS:
+      {
+        sexp::Value car;
+        sexp::Value cdr;
+        if (!read_value(car) || !read_value(cdr))
+          return false;
+        sx = sexp::Value::cons(std::move(car), std::move(cdr));
+        break;
+      }
+
+      case sexp::Value::Type::ARRAY:
+      {
+        uint64_t size;
+        // every item takes at least two bytes
+        if (!read_uint(size) || size > (m_data.size() - m_pos) / 2)
+          return false;
+
+        std::vector<sexp::Value> items(static_cast<size_t>(size));
+        for (auto& item : items) {
+          if (!read_value(item))
+            return false;
+        }
+        sx = sexp::Value::array(std::move(items));
+        break;
+      }
+
+      default:
+        return false;
+    }
+
+    sx.set_line(static_cast<int>(line));
+    return true;
+  }
+
+private:
+  const std::string& m_data;
+  size_t m_pos;
+
+private:
+  Decoder(const Decoder&) = delete;
+  Decoder& operator=(const Decoder&) = delete;
+};
+
+/** What the cache entry was made from */
+struct Header
+{
+  uint64_t size;
+  int64_t mtime;
+  std::string md5;
+};
+
+std::string get_md5(const std::string& data)
+{
+  MD5 md5;
+  // MD5 doesn't modify its input, it is merely missing the const
+  md5.update(reinterpret_cast<uint8_t*>(const_cast<char*>(data.data())),
+             static_cast<unsigned int>(data.size()));
+  return md5.hex_digest();
+}
+
+std::string get_cache_filename(const std::string& filename)
+{
+  return std::string(CACHE_DIRECTORY) + "/" + get_md5(filename) + ".bin";
+}
+
+/** Only files from the data directory and add-ons are worth caching,
+    ones from the userdir change all the time, e.g. savegames */
+bool is_cacheable(const std::string& filename)
+{
+  if (!PHYSFS_isInit())
+    return false;
+
+  const char* writedir = PHYSFS_getWriteDir();
+  const char* realdir = PHYSFS_getRealDir(filename.c_str());
+  return writedir && realdir && strcmp(writedir, realdir) != 0;
+}
+
+bool stat_file(const std::string& filename, uint64_t& size, int64_t& mtime)
+{
+  PHYSFS_Stat statbuf;
+  if (!PHYSFS_stat(filename.c_str(), &statbuf) || statbuf.filesize < 0)
+    return false;
+
+  size = static_cast<uint64_t>(statbuf.filesize);
+  mtime = statbuf.modtime;
+  return true;
+}
+
+bool read_file(const std::string& filename, std::string& data)
+{
+  PHYSFS_File* file = PHYSFS_openRead(filename.c_str());
+  if (!file)
+    return false;
+
+  g_load_stats.add_file(filename);
+
+  const PHYSFS_sint64 length = PHYSFS_fileLength(file);
+  bool success = false;
+  if (length > 0)
+  {
+    data.resize(static_cast<size_t>(length));
+    success = PHYSFS_readBytes(file, &data[0], static_cast<PHYSFS_uint64>(length)) == length;
+  }
+  PHYSFS_close(file);
+  return success;
+}
+
+/** Reads the header and, if accept(header) agrees, the document */
+template<typename F>
+bool load_entry(const std::string& filename, sexp::Value& sx, F accept)
+{
+  if (!is_cacheable(filename))
+    return false;
+
+  std::string data;
+  if (!read_file(get_cache_filename(filename), data))
+    return false;
+
+  Decoder decoder(data);
+  Header header;
+  std::string source;
+  if (!decoder.read_magic() ||
+      !decoder.read_string(source) ||
+      !decoder.read_uint(header.size) ||
+      !decoder.read_int(header.mtime) ||
+      !decoder.read_string(header.md5))
+  {
+    return false;
+  }
+
+  // guards against hash collisions in the cache filename
+  if (source != filename || !accept(header))
+    return false;
+
+  sexp::Value result;
+  if (!decoder.read_value(result) || !decoder.at_end())
+  {
+    log_warning << "ignoring broken cache entry for '" << filename << "'" << std::endl;
+    return false;
+  }
+
+  sx = std::move(result);
+  return true;
+}
+
+} // namespace
+
+namespace SExpCache {
+
+bool
+load(const std::string& filename, sexp::Value& sx)
+{
+  uint64_t size;
+  int64_t mtime;
+  if (!stat_file(filename, size, mtime))
+    return false;
+
+  return load_entry(filename, sx, [size, mtime](const Header& header) {
+      return header.size == size && header.mtime == mtime;
+    });
+}
+
+bool
+load(const std::string& filename, const std::string& content, sexp::Value& sx)
+{
+  const std::string md5 = get_md5(content);
+  if (!load_entry(filename, sx, [&md5](const Header& header) { return header.md5 == md5; }))
+    return false;
+
+  // refresh the timestamp so the next start doesn't need the content
+  store(filename, content, sx);
+  return true;
+}
+
+void
+store(const std::string& filename, const std::string& content, const sexp::Value& sx)
+{
+  if (s_read_only || !is_cacheable(filename))
+    return;
+
+  uint64_t size;
+  int64_t mtime;
+  if (!stat_file(filename, size, mtime))
+    return;
+
+  std::string data = MAGIC;
+  Encoder encoder(data);
+  encoder.write_string(filename);
+  encoder.write_uint(size);
+  encoder.write_int(mtime);
+  encoder.write_string(get_md5(content));
+  encoder.write_value(sx);
+
+  std::lock_guard<std::mutex> lock(s_store_mutex);
+
+  if (!PHYSFS_exists(CACHE_DIRECTORY) && !PHYSFS_mkdir(CACHE_DIRECTORY))
+  {
+    log_warning << "couldn't create directory '" << CACHE_DIRECTORY << "': "
+                << PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()) << std::endl;
+    return;
+  }
+
+  const std::string cache_filename = get_cache_filename(filename);
+  PHYSFS_File* file = PHYSFS_openWrite(cache_filename.c_str());
+  if (!file)
+  {
+    log_warning << "couldn't write '" << cache_filename << "': "
+                << PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()) << std::endl;
+    return;
+  }
+
+  const bool success = PHYSFS_writeBytes(file, data.data(), data.size()) == static_cast<PHYSFS_sint64>(data.size());
+  PHYSFS_close(file);
+
+  if (!success)
+  {
+    // a truncated entry would be rejected on load, but don't keep it around
+    PHYSFS_delete(cache_filename.c_str());
+  }
+}
+
+void
+set_read_only(bool read_only)
+{
+  s_read_only = read_only;
+}
+
+std::string
+serialize(const sexp::Value& sx)
+{
+  std::string data;
+  Encoder encoder(data);
+  encoder.write_value(sx);
+  return data;
+}
+
+bool
+deserialize(const std::string& data, sexp::Value& sx)
+{
+  Decoder decoder(data);
+  sexp::Value result;
+  if (!decoder.read_value(result) || !decoder.at_end())
+    return false;
+
+  sx = std::move(result);
+  return true;
+}
+
+} // namespace SExpCache
+
+/* EOF */
@@ -0,0 +1,60 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_UTIL_SEXP_CACHE_HPP
+#define HEADER_SUPERTUX_UTIL_SEXP_CACHE_HPP
+
+#include <string>
+
+namespace sexp {
+class Value;
+} // namespace sexp
+
+/** Keeps parsed sexp documents from the data directory in a compact
+    binary form in the userdir, so large documents like the tileset
+    don't have to be parsed as text on every start. Entries are keyed
+    by path and checked against the modification time, size and MD5
+    of the source file. */
+namespace SExpCache {
+
+/** Loads the cached document for filename if the cache is still
+    valid for the file as it is on disk, without reading the file */
+bool load(const std::string& filename, sexp::Value& sx);
+
+/** Like load(), but also accepts a cache entry whose timestamp is
+    outdated if it was made from the same content */
+bool load(const std::string& filename, const std::string& content, sexp::Value& sx);
+
+/** Writes sx, parsed from content, to the cache, errors are only
+    logged */
+void store(const std::string& filename, const std::string& content, const sexp::Value& sx);
+
+/** Makes store() do nothing, for processes that run alongside others
+    using the same userdir */
+void set_read_only(bool read_only);
+
+/** Encodes sx and everything below it */
+std::string serialize(const sexp::Value& sx);
+
+/** Decodes the output of serialize(), returns false if data is
+    truncated or otherwise broken */
+bool deserialize(const std::string& data, sexp::Value& sx);
+
+} // namespace SExpCache
+
+#endif
+
+/* EOF */
@@ -0,0 +1,81 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_UTIL_SPSC_QUEUE_HPP
+#define HEADER_SUPERTUX_UTIL_SPSC_QUEUE_HPP
+
+#include <array>
+#include <atomic>
+#include <stddef.h>
+
+/** Bounded lock-free queue for exactly one producer and one consumer
+    thread. Holds up to N - 1 items, N has to be a power of two. */
+template<typename T, size_t N>
+class SPSCQueue final
+{
+  static_assert(N >= 2 && (N & (N - 1)) == 0, "N has to be a power of two");
+
+public:
+  SPSCQueue() :
+    m_items(),
+    m_head(0),
+    m_tail(0)
+  {}
+
+  /** Producer side, returns false if the queue is full */
+  bool push(const T& item)
+  {
+    const size_t tail = m_tail.load(std::memory_order_relaxed);
+    const size_t next = (tail + 1) & (N - 1);
+    if (next == m_head.load(std::memory_order_acquire))
+      return false;
+
+    m_items[tail] = item;
+    m_tail.store(next, std::memory_order_release);
+    return true;
+  }
+
+  /** Consumer side, returns false if the queue is empty */
+  bool pop(T& item)
+  {
+    const size_t head = m_head.load(std::memory_order_relaxed);
+    if (head == m_tail.load(std::memory_order_acquire))
+      return false;
+
+    item = m_items[head];
+    m_head.store((head + 1) & (N - 1), std::memory_order_release);
+    return true;
+  }
+
+  bool empty() const
+  {
+    return m_head.load(std::memory_order_acquire) == m_tail.load(std::memory_order_acquire);
+  }
+
+private:
+  std::array<T, N> m_items;
+  std::atomic<size_t> m_head;
+  std::atomic<size_t> m_tail;
+
+private:
+  SPSCQueue(const SPSCQueue&) = delete;
+  SPSCQueue& operator=(const SPSCQueue&) = delete;
+};
+
+#endif
+
+/* EOF */
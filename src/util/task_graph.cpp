@@ -0,0 +1,202 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "util/task_graph.hpp"
+
+#include <algorithm>
+#include <iomanip>
+#include <stdexcept>
+
+#include "util/job_system.hpp"
+
+namespace {
+
+double
+to_msec(const std::chrono::steady_clock::duration& duration)
+{
+  return std::chrono::duration<double, std::milli>(duration).count();
+}
+
+} // namespace
+
+TaskGraph::TaskGraph() :
+  m_tasks(),
+  m_start(),
+  m_mutex(),
+  m_condition(),
+  m_main_queue(),
+  m_running(0),
+  m_error()
+{
+}
+
+void
+TaskGraph::add_task(const std::string& name, const std::vector<std::string>& depends,
+                    std::function<void ()> func)
+{
+  add(name, depends, std::move(func), false);
+}
+
+void
+TaskGraph::add_main_task(const std::string& name, const std::vector<std::string>& depends,
+                         std::function<void ()> func)
+{
+  add(name, depends, std::move(func), true);
+}
+
+void
+TaskGraph::add(const std::string& name, const std::vector<std::string>& depends,
+               std::function<void ()> func, bool main_thread)
+{
+  const size_t index = m_tasks.size();
+
+  Task task;
+  task.name = name;
+  task.func = std::move(func);
+  task.main_thread = main_thread;
+  task.pending = 0;
+
+  // dependencies must already exist, which also rules out cycles
+  for (const auto& depend : depends)
+  {
+    auto it = std::find_if(m_tasks.begin(), m_tasks.end(),
+                           [&depend](const Task& other) { return other.name == depend; });
+    if (it == m_tasks.end()) {
+      throw std::runtime_error("task '" + name + "' depends on unknown task '" + depend + "'");
+    }
+    it->dependents.push_back(index);
+    task.pending += 1;
+  }
+
+  m_tasks.push_back(std::move(task));
+}
+
+void
+TaskGraph::run(JobSystem& job_system)
+{
+  m_start = std::chrono::steady_clock::now();
+
+  std::unique_lock<std::mutex> lock(m_mutex);
+  m_running = 0;
+  m_error = nullptr;
+
+  for (size_t i = 0; i < m_tasks.size(); ++i) {
+    if (m_tasks[i].pending == 0) {
+      schedule(i, job_system);
+    }
+  }
+
+  while (m_running > 0 || !m_main_queue.empty())
+  {
+    if (!m_main_queue.empty())
+    {
+      const size_t index = m_main_queue.back();
+      m_main_queue.pop_back();
+
+      lock.unlock();
+      execute(index, job_system);
+      lock.lock();
+    }
+    else
+    {
+      m_condition.wait(lock);
+    }
+  }
+
+  if (m_error) {
+    std::rethrow_exception(m_error);
+  }
+}
+
+void
+TaskGraph::schedule(size_t index, JobSystem& job_system)
+{
+  if (m_error)
+    return;
+
+  m_running += 1;
+  if (m_tasks[index].main_thread) {
+    m_main_queue.push_back(index);
+  } else {
+    job_system.schedule([this, index, &job_system]{ execute(index, job_system); });
+  }
+}
+
+void
+TaskGraph::execute(size_t index, JobSystem& job_system)
+{
+  Task& task = m_tasks[index];
+
+  std::exception_ptr error;
+  task.start = std::chrono::steady_clock::now() - m_start;
+  try
+  {
+    task.func();
+  }
+  catch(...)
+  {
+    error = std::current_exception();
+  }
+  task.end = std::chrono::steady_clock::now() - m_start;
+
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (error && !m_error) {
+      m_error = error;
+    }
+
+    for (const size_t dependent : task.dependents) {
+      m_tasks[dependent].pending -= 1;
+      if (m_tasks[dependent].pending == 0) {
+        schedule(dependent, job_system);
+      }
+    }
+
+    m_running -= 1;
+  }
+  m_condition.notify_all();
+}
+
+void
+TaskGraph::print_profile(std::ostream& out) const
+{
+  const int width = 40;
+
+  std::chrono::steady_clock::duration total{};
+  size_t name_width = 0;
+  for (const auto& task : m_tasks) {
+    total = std::max(total, task.end);
+    name_width = std::max(name_width, task.name.size());
+  }
+  const double total_msec = std::max(to_msec(total), 1.0);
+
+  out << "Startup profile (" << std::fixed << std::setprecision(1) << to_msec(total) << " ms):\n";
+  for (const auto& task : m_tasks)
+  {
+    const int begin = static_cast<int>(to_msec(task.start) / total_msec * width);
+    const int end = std::max(begin + 1, static_cast<int>(to_msec(task.end) / total_msec * width));
+
+    out << "  " << std::left << std::setw(static_cast<int>(name_width)) << task.name << std::right
+        << (task.main_thread ? "  main   " : "  worker ")
+        << std::setw(8) << to_msec(task.start) << " - " << std::setw(8) << to_msec(task.end) << " ms  |"
+        << std::string(begin, ' ') << std::string(end - begin, '#') << std::string(std::max(0, width - end), ' ')
+        << "|\n";
+  }
+  out << std::flush;
+}
+
+/* EOF */
@@ -0,0 +1,99 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_UTIL_TASK_GRAPH_HPP
+#define HEADER_SUPERTUX_UTIL_TASK_GRAPH_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <vector>
+
+class JobSystem;
+
+/** Runs a set of named tasks with explicit dependencies, each task
+    starts as soon as all the tasks it depends on are done. Tasks
+    that touch SDL video or OpenGL are marked as main thread tasks
+    and are run by the thread calling run(), everything else goes to
+    the JobSystem. */
+class TaskGraph final
+{
+public:
+  TaskGraph();
+
+  /** Adds a task that runs on a worker thread, dependencies have to
+      be added before the tasks depending on them */
+  void add_task(const std::string& name, const std::vector<std::string>& depends,
+                std::function<void ()> func);
+
+  /** Adds a task that runs on the thread calling run() */
+  void add_main_task(const std::string& name, const std::vector<std::string>& depends,
+                     std::function<void ()> func);
+
+  /** Runs all tasks and returns once they are done. If a task throws,
+      no further tasks are started and the first exception is
+      rethrown after the running ones finished. */
+  void run(JobSystem& job_system);
+
+  /** Prints when each task started and finished, relative to the
+      start of run() */
+  void print_profile(std::ostream& out) const;
+
+private:
+  struct Task
+  {
+    std::string name;
+    std::function<void ()> func;
+    bool main_thread;
+    std::vector<size_t> dependents;
+    int pending;
+    std::chrono::steady_clock::duration start;
+    std::chrono::steady_clock::duration end;
+  };
+
+  void add(const std::string& name, const std::vector<std::string>& depends,
+           std::function<void ()> func, bool main_thread);
+
+  /** Runs the task and schedules its dependents, called without the
+      lock being held */
+  void execute(size_t index, JobSystem& job_system);
+
+  /** Called with m_mutex being held */
+  void schedule(size_t index, JobSystem& job_system);
+
+private:
+  std::vector<Task> m_tasks;
+  std::chrono::steady_clock::time_point m_start;
+
+  std::mutex m_mutex;
+  std::condition_variable m_condition;
+  std::vector<size_t> m_main_queue;
+  size_t m_running;
+  std::exception_ptr m_error;
+
+private:
+  TaskGraph(const TaskGraph&) = delete;
+  TaskGraph& operator=(const TaskGraph&) = delete;
+};
+
+#endif
+
+/* EOF */
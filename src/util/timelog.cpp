@@ -20,9 +20,10 @@
 #include <iostream>
 
 #include "util/log.hpp"
+#include "util/profiler.hpp"
 
 Timelog::Timelog() :
-  m_last_ticks(0),
+  m_last_ns(0),
   m_last_component(nullptr)
 {
 }
@@ -30,15 +31,15 @@ Timelog::Timelog() :
 void
 Timelog::log(const char* component)
 {
-  Uint32 current_ticks = SDL_GetTicks();
+  const uint64_t current_ns = Profiler::get_time_ns();
 
   if (m_last_component != nullptr) {
     log_info << "Component '" << m_last_component <<  "' finished after "
-             << (current_ticks - m_last_ticks) / 1000.0 << " seconds"
+             << static_cast<double>(current_ns - m_last_ns) / 1.0e9 << " seconds"
              << std::endl;
   }
 
-  m_last_ticks = current_ticks;
+  m_last_ns = current_ns;
   m_last_component = component;
 }
 
@@ -17,8 +17,10 @@
 #ifndef HEADER_SUPERTUX_UTIL_TIMELOG_HPP
 #define HEADER_SUPERTUX_UTIL_TIMELOG_HPP
 
-#include <SDL.h>
+#include <stdint.h>
 
+/** Logs how long named startup phases took, frames are measured by
+    the Profiler */
 class Timelog
 {
 public:
@@ -27,7 +29,7 @@ public:
   void log(const char* component = nullptr);
 
 private:
-  Uint32 m_last_ticks;
+  uint64_t m_last_ns;
   const char* m_last_component = nullptr;
 
 private:
@@ -0,0 +1,220 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_UTIL_TIMER_WHEEL_HPP
+#define HEADER_SUPERTUX_UTIL_TIMER_WHEEL_HPP
+
+#include <algorithm>
+#include <array>
+#include <math.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+/** Hierarchical timer wheel for values that are due at a given
+    absolute time. The first level has one slot per tick for the next
+    256 ticks, the second level one slot per 256 ticks, everything
+    further away waits in an overflow list. Insertion is O(1) and each
+    entry is moved at most twice before it becomes due. */
+template<typename T>
+class TimerWheel final
+{
+public:
+  struct Entry
+  {
+    T value;
+    float time;
+  };
+
+public:
+  TimerWheel(float ticks_per_second) :
+    m_ticks_per_second(ticks_per_second),
+    m_level0(),
+    m_level1(),
+    m_overflow(),
+    m_scratch(),
+    m_tick(0),
+    m_size(0)
+  {}
+
+  void insert(const T& value, float time)
+  {
+    insert(Entry{value, time});
+  }
+
+  /** Appends every entry with a time before now to due, ordered by
+      time, and removes them from the wheel */
+  void collect(float now, std::vector<Entry>& due)
+  {
+    const size_t first = due.size();
+    const int64_t target = to_tick(now);
+
+    if (m_size == 0)
+    {
+      m_tick = std::max(m_tick, target);
+      return;
+    }
+
+    while (m_tick < target)
+    {
+      take_due(m_level0[m_tick & LEVEL0_MASK], now, due);
+
+      m_tick += 1;
+      if ((m_tick & LEVEL0_MASK) == 0) {
+        cascade();
+      }
+
+      if (m_size == 0) {
+        m_tick = target;
+        break;
+      }
+    }
+
+    // only part of the current tick might be due
+    take_due(m_level0[m_tick & LEVEL0_MASK], now, due);
+
+    // entries that are exactly at now stay around, move them to the
+    // current tick in case they were in one that is done already
+    if (!m_scratch.empty())
+    {
+      std::vector<Entry> carry;
+      carry.swap(m_scratch);
+      for (auto& entry : carry) {
+        insert(entry);
+      }
+      carry.clear();
+      carry.swap(m_scratch);
+    }
+
+    std::stable_sort(due.begin() + first, due.end(),
+                     [](const Entry& lhs, const Entry& rhs) {
+                       return lhs.time < rhs.time;
+                     });
+  }
+
+  template<typename F>
+  void for_each(F func) const
+  {
+    for (const auto& slot : m_level0) {
+      for (const auto& entry : slot) func(entry);
+    }
+    for (const auto& slot : m_level1) {
+      for (const auto& entry : slot) func(entry);
+    }
+    for (const auto& entry : m_overflow) func(entry);
+  }
+
+  size_t size() const { return m_size; }
+  bool empty() const { return m_size == 0; }
+
+private:
+  static const int LEVEL0_BITS = 8;
+  static const int LEVEL1_BITS = 6;
+  static const int64_t LEVEL0_SIZE = int64_t(1) << LEVEL0_BITS;
+  static const int64_t LEVEL1_SIZE = int64_t(1) << LEVEL1_BITS;
+  static const int64_t LEVEL0_MASK = LEVEL0_SIZE - 1;
+  static const int64_t LEVEL1_MASK = LEVEL1_SIZE - 1;
+
+  /** Ticks too far away to be representable never become due, like
+      a time of infinity or NaN */
+  static const int64_t MAX_TICK = int64_t(1) << 60;
+
+private:
+  int64_t to_tick(float time) const
+  {
+    const double tick = floor(static_cast<double>(time) * m_ticks_per_second);
+    if (!(tick < static_cast<double>(MAX_TICK)))
+      return MAX_TICK;
+    if (tick < 0.0)
+      return 0;
+    return static_cast<int64_t>(tick);
+  }
+
+  void insert(const Entry& entry)
+  {
+    m_size += 1;
+
+    // entries in the past land in the current tick
+    const int64_t tick = std::max(to_tick(entry.time), m_tick);
+    if (tick - m_tick < LEVEL0_SIZE) {
+      m_level0[tick & LEVEL0_MASK].push_back(entry);
+    } else if ((tick >> LEVEL0_BITS) - (m_tick >> LEVEL0_BITS) < LEVEL1_SIZE) {
+      m_level1[(tick >> LEVEL0_BITS) & LEVEL1_MASK].push_back(entry);
+    } else {
+      m_overflow.push_back(entry);
+    }
+  }
+
+  /** Moves the due entries of slot to due, the rest to m_scratch */
+  void take_due(std::vector<Entry>& slot, float now, std::vector<Entry>& due)
+  {
+    for (auto& entry : slot)
+    {
+      if (entry.time < now) {
+        due.push_back(entry);
+      } else {
+        m_scratch.push_back(entry);
+      }
+    }
+    m_size -= slot.size();
+    slot.clear();
+  }
+
+  /** Called whenever m_tick enters a new block of LEVEL0_SIZE ticks */
+  void cascade()
+  {
+    std::vector<Entry> entries;
+
+    if (((m_tick >> LEVEL0_BITS) & LEVEL1_MASK) == 0)
+    {
+      entries.swap(m_overflow);
+      m_size -= entries.size();
+      for (const auto& entry : entries) {
+        insert(entry);
+      }
+      entries.clear();
+    }
+
+    auto& slot = m_level1[(m_tick >> LEVEL0_BITS) & LEVEL1_MASK];
+    entries.swap(slot);
+    m_size -= entries.size();
+    for (const auto& entry : entries) {
+      insert(entry);
+    }
+  }
+
+private:
+  double m_ticks_per_second;
+  std::array<std::vector<Entry>, LEVEL0_SIZE> m_level0;
+  std::array<std::vector<Entry>, LEVEL1_SIZE> m_level1;
+  std::vector<Entry> m_overflow;
+
+  /** Entries of collected slots that were not due yet */
+  std::vector<Entry> m_scratch;
+
+  /** The tick that is currently being processed */
+  int64_t m_tick;
+  size_t m_size;
+
+private:
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+};
+
+#endif
+
+/* EOF */
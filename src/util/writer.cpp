@@ -22,6 +22,26 @@
 #include "physfs/ofile_stream.hpp"
 #include "util/log.hpp"
 
+namespace {
+
+/** Appends value in decimal, tile arrays are too large to format
+    them through std::ostream one by one */
+void append_uint(std::string& buf, unsigned int value)
+{
+  char digits[10];
+  int n = 0;
+  do {
+    digits[n++] = static_cast<char>('0' + value % 10);
+    value /= 10;
+  } while (value != 0);
+
+  while (n > 0) {
+    buf.push_back(digits[--n]);
+  }
+}
+
+} // namespace
+
 Writer::Writer(const std::string& filename) :
   m_filename(filename),
   out(new OFileStream(filename)),
@@ -32,11 +52,11 @@ Writer::Writer(const std::string& filename) :
   out->precision(7);
 }
 
-Writer::Writer(std::ostream& newout) :
+Writer::Writer(std::ostream& newout, int indent_depth_) :
   m_filename("<stream>"),
   out(&newout),
   out_owned(false),
-  indent_depth(0),
+  indent_depth(indent_depth_),
   lists()
 {
   out->precision(7);
@@ -155,28 +175,40 @@ Writer::write(const std::string& name,
 {
   indent();
   *out << '(' << name;
+
+  // rows are formatted into line and written in one go
+  std::string line;
   if (!width)
   {
-    for (const auto& i : value)
-      *out << " " << i;
+    line.reserve(value.size() * 4);
+    for (const auto& i : value) {
+      line.push_back(' ');
+      append_uint(line, i);
+    }
   }
   else
   {
     *out << "\n";
     indent();
+
+    const std::string indentation(indent_depth, ' ');
+    line.reserve(static_cast<size_t>(width) * 11 + indentation.size() + 1);
     int count = 0;
     for (const auto& i : value) {
-      *out << i;
+      append_uint(line, i);
       count += 1;
       if (count >= width) {
-        *out << "\n";
-        indent();
+        line.push_back('\n');
+        line += indentation;
+        out->write(line.data(), static_cast<std::streamsize>(line.size()));
+        line.clear();
         count = 0;
       } else {
-        *out << " ";
+        line.push_back(' ');
       }
     }
   }
+  out->write(line.data(), static_cast<std::streamsize>(line.size()));
   *out << ")\n";
 }
 
@@ -241,6 +273,12 @@ Writer::write(const std::string& name, const sexp::Value& value)
   *out << ")\n";
 }
 
+void
+Writer::write_raw(const std::string& text)
+{
+  *out << text;
+}
+
 void
 Writer::write_escaped_string(const std::string& str)
 {
@@ -28,7 +28,9 @@ class Writer final
 {
 public:
   Writer(const std::string& filename);
-  Writer(std::ostream& out);
+  /** indent_depth allows to write a fragment that is later pasted
+      into another Writer at that depth with write_raw() */
+  Writer(std::ostream& out, int indent_depth = 0);
   ~Writer();
 
   void write_comment(const std::string& comment);
@@ -47,6 +49,12 @@ public:
   void write(const std::string& name, const sexp::Value& value);
   // add more write-functions when needed...
 
+  /** Writes text as is, it has to be complete and indented
+      expressions, e.g. the output of another Writer */
+  void write_raw(const std::string& text);
+
+  int get_indent_depth() const { return indent_depth; }
+
   void end_list(const std::string& listname);
 
 private:
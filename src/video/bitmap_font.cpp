@@ -62,7 +62,8 @@ BitmapFont::BitmapFont(GlyphWidth glyph_width_,
   shadowsize(shadowsize_),
   border(0),
   rtl(false),
-  glyphs(65536)
+  glyphs(65536),
+  width_cache()
 {
   for (unsigned int i=0; i<65536;i++) glyphs[i].surface_idx = -1;
 
@@ -263,6 +264,10 @@ BitmapFont::~BitmapFont()
 float
 BitmapFont::get_text_width(const std::string& text) const
 {
+  float cached_width;
+  if (width_cache.get(text, cached_width))
+    return cached_width;
+
   float curr_width = 0;
   float last_width = 0;
 
@@ -282,7 +287,9 @@ BitmapFont::get_text_width(const std::string& text) const
     }
   }
 
-  return std::max(curr_width, last_width);
+  const float width = std::max(curr_width, last_width);
+  width_cache.set(text, width);
+  return width;
 }
 
 float
@@ -307,55 +314,6 @@ BitmapFont::get_height() const
   return static_cast<float>(char_height);
 }
 
-std::string
-BitmapFont::wrap_to_width(const std::string& s_, float width, std::string* overflow)
-{
-  std::string s = s_;
-
-  // if text is already smaller, return full text
-  if (get_text_width(s) <= width) {
-    if (overflow) *overflow = "";
-    return s;
-  }
-
-  // if we can find a whitespace character to break at, return text up to this character
-  for (int i = static_cast<int>(s.length()) - 1; i >= 0; i--) {
-    std::string s2 = s.substr(0,i);
-    if (s[i] != ' ') continue;
-    if (get_text_width(s2) <= width) {
-      if (overflow) *overflow = s.substr(i+1);
-      return s.substr(0, i);
-    }
-  }
-
-  // hard-wrap at width, taking care of multibyte characters
-  unsigned int char_bytes = 1;
-  for (int i = 0; i < static_cast<int>(s.length()); i += char_bytes) {
-
-    // calculate the number of bytes in the character
-    char_bytes = 1;
-    auto iter = s.begin() + i + 1; // iter points to next byte
-    while ( iter != s.end() && (*iter & 128) && !(*iter & 64) ) {
-      // this is a "continuation" byte in the form 10xxxxxx
-      ++iter;
-      ++char_bytes;
-    }
-
-    // check whether text now goes over allowed width, and if so
-    // return everything up to the character and put the rest in the overflow
-    std::string s2 = s.substr(0,i+char_bytes);
-    if (get_text_width(s2) > width) {
-      if (i == 0) i += char_bytes; // edge case when even one char is too wide
-      if (overflow) *overflow = s.substr(i);
-      return s.substr(0, i);
-    }
-  }
-
-  // should in theory never reach here
-  if (overflow) *overflow = "";
-  return s;
-}
-
 
 void
 BitmapFont::draw_text(Canvas& canvas, const std::string& text,
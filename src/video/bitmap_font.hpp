@@ -67,11 +67,6 @@ public:
    */
   virtual float get_height() const override;
 
-  /**
-   * returns the given string, truncated (preferably at whitespace) to be at most "width" pixels wide
-   */
-  virtual std::string wrap_to_width(const std::string& text, float width, std::string* overflow) override;
-
   virtual void draw_text(Canvas& canvas, const std::string& text,
                          const Vector& pos, FontAlignment alignment, int layer, const Color& color) override;
 
@@ -125,6 +120,8 @@ private:
 
   /** 65536 of glyphs */
   std::vector<Glyph> glyphs;
+
+  mutable TextWidthCache width_cache;
 };
 
 #endif
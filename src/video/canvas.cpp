@@ -17,20 +17,120 @@
 #include "video/canvas.hpp"
 
 #include <algorithm>
+#include <math.h>
 
 #include "supertux/globals.hpp"
+#include "util/fnv_hash.hpp"
 #include "util/log.hpp"
 #include "util/obstackpp.hpp"
+#include "util/profiler.hpp"
 #include "video/drawing_request.hpp"
 #include "video/painter.hpp"
+#include "video/render_stats.hpp"
 #include "video/renderer.hpp"
 #include "video/surface.hpp"
 #include "video/video_system.hpp"
 
-Canvas::Canvas(DrawingContext& context, obstack& obst) :
+namespace {
+
+/** Number of preceding requests batch_requests() looks at, runs of
+    added up requests are searched completely */
+const size_t MAX_BATCH_LOOKBACK = 16;
+
+/** Rotated rects turn around their center and stay within the
+    circumcircle */
+Rectf
+get_rotated_bounds(const Rectf& rect, float angle)
+{
+  if (angle == 0.0f)
+    return rect;
+
+  const float radius = hypotf(rect.get_width(), rect.get_height()) / 2.0f;
+  const Vector center = rect.get_middle();
+  return Rectf(center.x - radius, center.y - radius, center.x + radius, center.y + radius);
+}
+
+Rectf
+get_bounds(const TextureRequest& request)
+{
+  float left = INFINITY;
+  float top = INFINITY;
+  float right = -INFINITY;
+  float bottom = -INFINITY;
+  for (size_t i = 0; i < request.dstrects.size(); ++i)
+  {
+    const Rectf rect = get_rotated_bounds(request.dstrects[i], request.angles[i]);
+    left = std::min(left, rect.get_left());
+    top = std::min(top, rect.get_top());
+    right = std::max(right, rect.get_right());
+    bottom = std::max(bottom, rect.get_bottom());
+  }
+  return Rectf(left, top, right, bottom);
+}
+
+bool
+overlaps(const Rectf& lhs, const Rectf& rhs)
+{
+  return
+    lhs.get_right() > rhs.get_left() && lhs.get_left() < rhs.get_right() &&
+    lhs.get_bottom() > rhs.get_top() && lhs.get_top() < rhs.get_bottom();
+}
+
+Rectf
+merge(const Rectf& lhs, const Rectf& rhs)
+{
+  return Rectf(std::min(lhs.get_left(), rhs.get_left()),
+               std::min(lhs.get_top(), rhs.get_top()),
+               std::max(lhs.get_right(), rhs.get_right()),
+               std::max(lhs.get_bottom(), rhs.get_bottom()));
+}
+
+bool
+can_merge(const TextureRequest& lhs, const TextureRequest& rhs)
+{
+  return
+    lhs.texture == rhs.texture &&
+    lhs.displacement_texture == rhs.displacement_texture &&
+    lhs.blend == rhs.blend &&
+    lhs.flip == rhs.flip;
+}
+
+void
+hash_value(FNVHash& hash, const Vector& value)
+{
+  hash.add(value.x);
+  hash.add(value.y);
+}
+
+void
+hash_value(FNVHash& hash, const Rectf& value)
+{
+  hash.add(value.get_left());
+  hash.add(value.get_top());
+  hash.add(value.get_right());
+  hash.add(value.get_bottom());
+}
+
+void
+hash_value(FNVHash& hash, const Color& value)
+{
+  hash.add(value.red);
+  hash.add(value.green);
+  hash.add(value.blue);
+  hash.add(value.alpha);
+}
+
+} // namespace
+
+Canvas::Canvas(DrawingContext& context, obstack& obst, DrawingTarget target) :
   m_context(context),
   m_obst(obst),
-  m_requests()
+  m_target(target),
+  m_layers(),
+  m_current_layer(0),
+  m_texture_pool(),
+  m_texture_pool_used(0),
+  m_batch_bounds()
 {
 }
 
@@ -42,64 +142,347 @@ Canvas::~Canvas()
 void
 Canvas::clear()
 {
-  for (auto& request : m_requests)
+  // buckets that got no requests this frame are dropped, the others
+  // keep their storage for the next frame
+  auto out = m_layers.begin();
+  for (auto& layer : m_layers)
   {
-    request->~DrawingRequest();
+    if (layer.requests.empty())
+      continue;
+
+    // texture requests belong to the pool and everything else but
+    // GetPixelRequest is trivially destructible
+    for (auto& request : layer.requests)
+    {
+      if (request->type == GETPIXEL) {
+        static_cast<GetPixelRequest*>(request)->~GetPixelRequest();
+      }
+    }
+    layer.requests.clear();
+    layer.batched = false;
+    if (&*out != &layer) {
+      *out = std::move(layer);
+    }
+    ++out;
   }
-  m_requests.clear();
+  m_layers.erase(out, m_layers.end());
+  m_current_layer = 0;
+  m_texture_pool_used = 0;
+}
+
+TextureRequest*
+Canvas::new_texture_request()
+{
+  if (m_texture_pool_used == m_texture_pool.size()) {
+    m_texture_pool.push_back(std::make_unique<TextureRequest>());
+  }
+
+  TextureRequest* request = m_texture_pool[m_texture_pool_used].get();
+  m_texture_pool_used += 1;
+  request->reset();
+  return request;
+}
+
+void
+Canvas::add_request(DrawingRequest* request)
+{
+  // most requests go to the same layer as the previous one
+  if (m_current_layer < m_layers.size() &&
+      m_layers[m_current_layer].layer == request->layer)
+  {
+    m_layers[m_current_layer].requests.push_back(request);
+    return;
+  }
+
+  auto it = std::lower_bound(m_layers.begin(), m_layers.end(), request->layer,
+                             [](const Layer& lhs, int layer) {
+                               return lhs.layer < layer;
+                             });
+  if (it == m_layers.end() || it->layer != request->layer) {
+    it = m_layers.insert(it, Layer(request->layer));
+  }
+  it->requests.push_back(request);
+  m_current_layer = static_cast<size_t>(it - m_layers.begin());
 }
 
 void
 Canvas::render(Renderer& renderer, Filter filter)
 {
-  // On a regular level, each frame has around 50-250 requests (before
-  // batching it was 1000-3000), the sort comparator function is
-  // called approximatly 3-7 times for each request.
-  std::stable_sort(m_requests.begin(), m_requests.end(),
-                   [](const DrawingRequest* r1, const DrawingRequest* r2){
-                     return r1->layer < r2->layer;
-                   });
+  Profiler::Scope profile_scope("canvas");
+
+  auto begin = m_layers.begin();
+  auto end = m_layers.end();
+  if (filter == BELOW_LIGHTMAP) {
+    end = std::lower_bound(begin, end, static_cast<int>(LAYER_LIGHTMAP),
+                           [](const Layer& lhs, int layer) { return lhs.layer < layer; });
+  } else if (filter == ABOVE_LIGHTMAP) {
+    begin = std::upper_bound(begin, end, static_cast<int>(LAYER_LIGHTMAP),
+                             [](int layer, const Layer& rhs) { return layer < rhs.layer; });
+  }
+
+  if (m_target == DrawingTarget::LIGHTMAP && filter == ALL) {
+    resolve_unlit_pixels();
+  }
 
   Painter& painter = renderer.get_painter();
 
-  for (const auto& i : m_requests) {
-    const DrawingRequest& request = *i;
+  for (auto layer = begin; layer != end; ++layer)
+  {
+    if (!layer->batched) {
+      batch_requests(layer->requests);
+      layer->batched = true;
+    }
 
-    if (filter == BELOW_LIGHTMAP && request.layer >= LAYER_LIGHTMAP)
-      continue;
-    else if (filter == ABOVE_LIGHTMAP && request.layer <= LAYER_LIGHTMAP)
-      continue;
+    const size_t section = g_render_stats.begin_section(m_target, layer->layer,
+                                                        static_cast<int>(layer->requests.size()));
+    if (section != RenderStats::NO_SECTION) {
+      painter.begin_stats_section(section);
+    }
+
+    {
+      Profiler::Scope painter_scope("painter");
+      painter.draw_requests(layer->requests);
+    }
+
+    if (section != RenderStats::NO_SECTION) {
+      painter.end_stats_section();
+      g_render_stats.end_section();
+    }
+  }
+}
 
-    switch (request.type) {
-      case TEXTURE:
-        painter.draw_texture(static_cast<const TextureRequest&>(request));
-        break;
+void
+Canvas::hash(FNVHash& hash) const
+{
+  for (const auto& layer : m_layers)
+  {
+    hash.add(layer.layer);
+    for (const auto* request : layer.requests)
+    {
+      hash.add(request->type);
+      hash.add(request->flip);
+      hash.add(request->alpha);
+      hash.add(request->blend);
+
+      switch (request->type) {
+        case TEXTURE: {
+          const auto& texture_request = static_cast<const TextureRequest&>(*request);
+          hash.add(texture_request.texture);
+          hash.add(texture_request.displacement_texture);
+          for (const auto& rect : texture_request.srcrects) hash_value(hash, rect);
+          for (const auto& rect : texture_request.dstrects) hash_value(hash, rect);
+          for (const auto& angle : texture_request.angles) hash.add(angle);
+          hash_value(hash, texture_request.color);
+          for (const auto& color : texture_request.colors) hash_value(hash, color);
+          break;
+        }
+
+        case GRADIENT: {
+          const auto& gradient_request = static_cast<const GradientRequest&>(*request);
+          hash_value(hash, gradient_request.pos);
+          hash_value(hash, gradient_request.size);
+          hash_value(hash, gradient_request.top);
+          hash_value(hash, gradient_request.bottom);
+          hash.add(gradient_request.direction);
+          hash_value(hash, gradient_request.region);
+          break;
+        }
+
+        case FILLRECT: {
+          const auto& fillrect_request = static_cast<const FillRectRequest&>(*request);
+          hash_value(hash, fillrect_request.rect);
+          hash_value(hash, fillrect_request.color);
+          hash.add(fillrect_request.radius);
+          break;
+        }
+
+        case INVERSEELLIPSE: {
+          const auto& ellipse_request = static_cast<const InverseEllipseRequest&>(*request);
+          hash_value(hash, ellipse_request.pos);
+          hash_value(hash, ellipse_request.size);
+          hash_value(hash, ellipse_request.color);
+          break;
+        }
+
+        case LINE: {
+          const auto& line_request = static_cast<const LineRequest&>(*request);
+          hash_value(hash, line_request.pos);
+          hash_value(hash, line_request.dest_pos);
+          hash_value(hash, line_request.color);
+          break;
+        }
+
+        case LINES: {
+          const auto& lines_request = static_cast<const LinesRequest&>(*request);
+          for (size_t i = 0; i < lines_request.count; ++i) {
+            hash_value(hash, lines_request.points[i]);
+          }
+          hash_value(hash, lines_request.color);
+          break;
+        }
+
+        case TRIANGLE: {
+          const auto& triangle_request = static_cast<const TriangleRequest&>(*request);
+          hash_value(hash, triangle_request.pos1);
+          hash_value(hash, triangle_request.pos2);
+          hash_value(hash, triangle_request.pos3);
+          hash_value(hash, triangle_request.color);
+          break;
+        }
+
+        case GETPIXEL:
+          hash_value(hash, static_cast<const GetPixelRequest&>(*request).pos);
+          break;
+      }
+    }
+  }
+}
 
-      case GRADIENT:
-        painter.draw_gradient(static_cast<const GradientRequest&>(request));
-        break;
+void
+Canvas::resolve_unlit_pixels()
+{
+  if (m_layers.empty() || m_layers.back().layer != LAYER_GETPIXEL)
+    return;
 
-      case FILLRECT:
-        painter.draw_filled_rect(static_cast<const FillRectRequest&>(request));
-        break;
+  // the area every light covers, anything that isn't a plain sprite or
+  // rectangle could touch any pixel and everything goes to the GPU
+  m_batch_bounds.clear();
+  for (const auto& layer : m_layers)
+  {
+    for (const auto* request : layer.requests)
+    {
+      switch (request->type)
+      {
+        case TEXTURE:
+          m_batch_bounds.push_back(get_bounds(static_cast<const TextureRequest&>(*request)));
+          break;
+
+        case FILLRECT:
+          m_batch_bounds.push_back(static_cast<const FillRectRequest&>(*request).rect);
+          break;
+
+        case GETPIXEL:
+          break;
+
+        default:
+          return;
+      }
+    }
+  }
 
-      case INVERSEELLIPSE:
-        painter.draw_inverse_ellipse(static_cast<const InverseEllipseRequest&>(request));
-        break;
+  // the lightmap is cleared to the ambient color and stores 8 bits
+  // per channel, which is what a readback would return
+  const Color ambient = m_context.get_ambient_color();
+  const Color unlit = Color::from_rgb888(static_cast<uint8_t>(ambient.red * 255.0f + 0.5f),
+                                         static_cast<uint8_t>(ambient.green * 255.0f + 0.5f),
+                                         static_cast<uint8_t>(ambient.blue * 255.0f + 0.5f));
 
-      case LINE:
-        painter.draw_line(static_cast<const LineRequest&>(request));
-        break;
+  auto& requests = m_layers.back().requests;
+  auto out = requests.begin();
+  for (auto* request : requests)
+  {
+    if (request->type == GETPIXEL)
+    {
+      auto pixel_request = static_cast<GetPixelRequest*>(request);
+
+      // one pixel of slack for filtering and rounding at the edges
+      const Rectf pixel(pixel_request->pos.x - 1.0f, pixel_request->pos.y - 1.0f,
+                        pixel_request->pos.x + 2.0f, pixel_request->pos.y + 2.0f);
+      const bool lit = std::any_of(m_batch_bounds.begin(), m_batch_bounds.end(),
+                                   [&pixel](const Rectf& bounds) {
+                                     return overlaps(bounds, pixel);
+                                   });
+      if (!lit)
+      {
+        *(pixel_request->color_ptr) = unlit;
+        pixel_request->~GetPixelRequest();
+        continue;
+      }
+    }
+    *out++ = request;
+  }
+  requests.erase(out, requests.end());
+}
 
-      case TRIANGLE:
-        painter.draw_triangle(static_cast<const TriangleRequest&>(request));
-        break;
+void
+Canvas::batch_requests(std::vector<DrawingRequest*>& requests)
+{
+  m_batch_bounds.resize(requests.size());
 
-      case GETPIXEL:
-        painter.get_pixel(static_cast<const GetPixelRequest&>(request));
-        break;
+  size_t out = 0;
+  for (size_t i = 0; i < requests.size(); ++i)
+  {
+    DrawingRequest* request = requests[i];
+    if (request->type == TEXTURE)
+    {
+      auto& texture_request = static_cast<TextureRequest&>(*request);
+      const Rectf bounds = get_bounds(texture_request);
+
+      const size_t index = find_batch(requests, out, texture_request, bounds);
+      if (index != out)
+      {
+        auto batch = static_cast<TextureRequest*>(requests[index]);
+
+        // the tint becomes per quad, so differently tinted sprites and
+        // tiles still end up in one draw call
+        if (batch->colors.empty() &&
+            (batch->color != texture_request.color || batch->alpha != texture_request.alpha))
+        {
+          batch->colors.assign(batch->srcrects.size(), batch->get_color(0));
+        }
+        if (!batch->colors.empty())
+        {
+          for (size_t j = 0; j < texture_request.srcrects.size(); ++j) {
+            batch->colors.push_back(texture_request.get_color(j));
+          }
+        }
+
+        batch->srcrects.insert(batch->srcrects.end(), texture_request.srcrects.begin(), texture_request.srcrects.end());
+        batch->dstrects.insert(batch->dstrects.end(), texture_request.dstrects.begin(), texture_request.dstrects.end());
+        batch->angles.insert(batch->angles.end(), texture_request.angles.begin(), texture_request.angles.end());
+        m_batch_bounds[index] = merge(m_batch_bounds[index], bounds);
+
+        // the request stays in the texture pool until clear()
+        continue;
+      }
+
+      m_batch_bounds[out] = bounds;
     }
+
+    requests[out] = request;
+    out += 1;
+  }
+  requests.resize(out);
+}
+
+size_t
+Canvas::find_batch(const std::vector<DrawingRequest*>& requests, size_t end,
+                   const TextureRequest& request, const Rectf& bounds) const
+{
+  for (size_t i = end; i > 0; --i)
+  {
+    DrawingRequest* other = requests[i - 1];
+    if (other->type != TEXTURE)
+      return end;
+
+    // a run of added up requests holds at most one batch per texture,
+    // so it can be searched completely, which collects the light
+    // sprites of all objects of a layer no matter in which order they
+    // got drawn
+    const bool added_up = other->blend == Blend::ADD && request.blend == Blend::ADD;
+    if (!added_up && end - i >= MAX_BATCH_LOOKBACK)
+      return end;
+
+    if (can_merge(static_cast<const TextureRequest&>(*other), request))
+      return i - 1;
+
+    // request would be drawn before this one, which is only fine if
+    // they don't overlap or if both are added up, as the order doesn't
+    // matter then, this lets overlapping lights end up in one batch
+    if (overlaps(m_batch_bounds[i - 1], bounds) && !added_up)
+      return end;
   }
+  return end;
 }
 
 void
@@ -111,16 +494,19 @@ Canvas::draw_surface(const SurfacePtr& surface,
 
   const auto& cliprect = m_context.get_cliprect();
 
-  // discard clipped surface
-  if (position.x > cliprect.get_right() ||
-     position.y > cliprect.get_bottom() ||
-     position.x + static_cast<float>(surface->get_width()) < cliprect.get_left() ||
-     position.y + static_cast<float>(surface->get_height()) < cliprect.get_top())
+  // discard clipped surface, rotated ones are tested with their
+  // rotated extent so e.g. spotlight cones don't pop in or out
+  const Rectf bounds = get_rotated_bounds(Rectf(position, Sizef(static_cast<float>(surface->get_width()),
+                                                                static_cast<float>(surface->get_height()))),
+                                          angle);
+  if (bounds.get_left() > cliprect.get_right() ||
+      bounds.get_top() > cliprect.get_bottom() ||
+      bounds.get_right() < cliprect.get_left() ||
+      bounds.get_bottom() < cliprect.get_top())
     return;
 
-  auto request = new(m_obst) TextureRequest();
+  auto request = new_texture_request();
 
-  request->type = TEXTURE;
   request->layer = layer;
   request->flip = m_context.transform().flip ^ surface->get_flip();
   request->alpha = m_context.transform().alpha;
@@ -133,7 +519,7 @@ Canvas::draw_surface(const SurfacePtr& surface,
   request->displacement_texture = surface->get_displacement_texture().get();
   request->color = color;
 
-  m_requests.push_back(request);
+  add_request(request);
 }
 
 void
@@ -156,9 +542,8 @@ Canvas::draw_surface_part(const SurfacePtr& surface, const Rectf& srcrect, const
 {
   if (!surface) return;
 
-  auto request = new(m_obst) TextureRequest();
+  auto request = new_texture_request();
 
-  request->type = TEXTURE;
   request->layer = layer;
   request->flip = m_context.transform().flip ^ surface->get_flip();
   request->alpha = m_context.transform().alpha * style.get_alpha();
@@ -171,7 +556,7 @@ Canvas::draw_surface_part(const SurfacePtr& surface, const Rectf& srcrect, const
   request->displacement_texture = surface->get_displacement_texture().get();
   request->color = style.get_color();
 
-  m_requests.push_back(request);
+  add_request(request);
 }
 
 void
@@ -199,9 +584,8 @@ Canvas::draw_surface_batch(const SurfacePtr& surface,
 {
   if (!surface) return;
 
-  auto request = new(m_obst) TextureRequest();
+  auto request = new_texture_request();
 
-  request->type = TEXTURE;
   request->layer = layer;
   request->flip = m_context.transform().flip ^ surface->get_flip();
   request->alpha = m_context.transform().alpha;
@@ -211,15 +595,42 @@ Canvas::draw_surface_batch(const SurfacePtr& surface,
   request->dstrects = std::move(dstrects);
   request->angles = std::move(angles);
 
-  for (auto& dstrect : request->dstrects)
-  {
-    dstrect = Rectf(apply_translate(dstrect.p1()), dstrect.get_size());
-  }
+  apply_translate(request->dstrects.data(), request->dstrects.size());
+
+  request->texture = surface->get_texture().get();
+  request->displacement_texture = surface->get_displacement_texture().get();
+
+  add_request(request);
+}
+
+void
+Canvas::draw_surface_batch(const SurfacePtr& surface,
+                           const Rectf* srcrects,
+                           const Rectf* dstrects,
+                           size_t count,
+                           const Color& color,
+                           int layer)
+{
+  if (!surface || count == 0) return;
+
+  auto request = new_texture_request();
+
+  request->layer = layer;
+  request->flip = m_context.transform().flip ^ surface->get_flip();
+  request->alpha = m_context.transform().alpha;
+  request->color = color;
+
+  // the pooled request keeps its capacity, so this doesn't allocate
+  // once the vectors have grown to the usual batch size
+  request->srcrects.assign(srcrects, srcrects + count);
+  request->angles.assign(count, 0.0f);
+  request->dstrects.assign(dstrects, dstrects + count);
+  apply_translate(request->dstrects.data(), count);
 
   request->texture = surface->get_texture().get();
   request->displacement_texture = surface->get_displacement_texture().get();
 
-  m_requests.push_back(request);
+  add_request(request);
 }
 
 void
@@ -257,7 +668,7 @@ Canvas::draw_gradient(const Color& top, const Color& bottom, int layer,
   request->region = Rectf(apply_translate(region.p1()),
                           apply_translate(region.p2()));
 
-  m_requests.push_back(request);
+  add_request(request);
 }
 
 void
@@ -284,7 +695,7 @@ Canvas::draw_filled_rect(const Rectf& rect, const Color& color, float radius, in
   request->color.alpha = color.alpha * m_context.transform().alpha;
   request->radius = radius;
 
-  m_requests.push_back(request);
+  add_request(request);
 }
 
 void
@@ -303,7 +714,7 @@ Canvas::draw_inverse_ellipse(const Vector& pos, const Vector& size, const Color&
   request->color.alpha  = color.alpha * m_context.transform().alpha;
   request->size         = size;
 
-  m_requests.push_back(request);
+  add_request(request);
 }
 
 void
@@ -322,7 +733,35 @@ Canvas::draw_line(const Vector& pos1, const Vector& pos2, const Color& color, in
   request->color.alpha  = color.alpha * m_context.transform().alpha;
   request->dest_pos     = apply_translate(pos2);
 
-  m_requests.push_back(request);
+  add_request(request);
+}
+
+void
+Canvas::draw_lines(const std::vector<Vector>& points, const Color& color, int layer)
+{
+  if (points.size() < 2)
+    return;
+
+  auto request = new(m_obst) LinesRequest;
+
+  request->type   = LINES;
+  request->layer  = layer;
+
+  request->flip = m_context.transform().flip;
+  request->alpha = m_context.transform().alpha;
+
+  const size_t count = points.size() & ~size_t(1);
+  auto out = static_cast<Vector*>(obstack_alloc(&m_obst, static_cast<int>(sizeof(Vector) * count)));
+  for (size_t i = 0; i < count; ++i) {
+    new (out + i) Vector(apply_translate(points[i]));
+  }
+
+  request->points       = out;
+  request->count        = count;
+  request->color        = color;
+  request->color.alpha  = color.alpha * m_context.transform().alpha;
+
+  add_request(request);
 }
 
 void
@@ -342,7 +781,7 @@ Canvas::draw_triangle(const Vector& pos1, const Vector& pos2, const Vector& pos3
   request->color = color;
   request->color.alpha = color.alpha * m_context.transform().alpha;
 
-  m_requests.push_back(request);
+  add_request(request);
 }
 
 void
@@ -368,7 +807,7 @@ Canvas::get_pixel(const Vector& position, const std::shared_ptr<Color>& color_ou
   request->pos = pos;
   request->color_ptr = color_out;
 
-  m_requests.push_back(request);
+  add_request(request);
 }
 
 Vector
@@ -379,4 +818,15 @@ Canvas::apply_translate(const Vector& pos) const
                                       static_cast<float>(m_context.get_viewport().top));
 }
 
+void
+Canvas::apply_translate(Rectf* rects, size_t count) const
+{
+  const Vector translation = m_context.transform().translation;
+  const Vector viewport(static_cast<float>(m_context.get_viewport().left),
+                        static_cast<float>(m_context.get_viewport().top));
+  for (size_t i = 0; i < count; ++i) {
+    rects[i] = Rectf((rects[i].p1() - translation) + viewport, rects[i].get_size());
+  }
+}
+
 /* EOF */
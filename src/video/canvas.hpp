@@ -36,9 +36,12 @@
 #include "video/paint_style.hpp"
 
 class DrawingContext;
+class FNVHash;
+class Painter;
 class Renderer;
 class VideoSystem;
 struct DrawingRequest;
+struct TextureRequest;
 
 class Canvas final
 {
@@ -46,7 +49,7 @@ public:
   enum Filter { BELOW_LIGHTMAP, ABOVE_LIGHTMAP, ALL };
 
 public:
-  Canvas(DrawingContext& context, obstack& obst);
+  Canvas(DrawingContext& context, obstack& obst, DrawingTarget target);
   ~Canvas();
 
   void draw_surface(const SurfacePtr& surface, const Vector& position, int layer);
@@ -67,6 +70,14 @@ public:
                           std::vector<float> angles,
                           const Color& color,
                           int layer);
+  /** Copies count rectangles into a recycled request, for callers
+      that keep their own buffers from frame to frame */
+  void draw_surface_batch(const SurfacePtr& surface,
+                          const Rectf* srcrects,
+                          const Rectf* dstrects,
+                          size_t count,
+                          const Color& color,
+                          int layer);
   void draw_text(const FontPtr& font, const std::string& text,
                  const Vector& position, FontAlignment alignment, int layer, const Color& color = Color(1.0,1.0,1.0));
   /** Draw text to the center of the screen */
@@ -80,6 +91,9 @@ public:
   void draw_inverse_ellipse(const Vector& pos, const Vector& size, const Color& color, int layer);
 
   void draw_line(const Vector& pos1, const Vector& pos2, const Color& color, int layer);
+
+  /** Draws a line between each pair of points as a single request */
+  void draw_lines(const std::vector<Vector>& points, const Color& color, int layer);
   void draw_triangle(const Vector& pos1, const Vector& pos2, const Vector& pos3, const Color& color, int layer);
 
   /** on next update, set color to lightmap's color at position */
@@ -88,15 +102,76 @@ public:
   void clear();
   void render(Renderer& renderer, Filter filter);
 
+  /** Adds everything that affects the rendered image to hash, used
+      to detect frames that are identical to the previous one */
+  void hash(FNVHash& hash) const;
+
   DrawingContext& get_context() { return m_context; }
 
 private:
   Vector apply_translate(const Vector& pos) const;
 
+  /** Translates the top left corner of count rectangles in place,
+      the transform is only looked up once for the whole batch */
+  void apply_translate(Rectf* rects, size_t count) const;
+
+  /** Returns a reset TextureRequest from m_texture_pool */
+  TextureRequest* new_texture_request();
+
+  /** Puts the request into the bucket of its layer */
+  void add_request(DrawingRequest* request);
+
+  /** Merges texture requests of a layer that only differ in their
+      rectangles, so they end up in a single draw call. Requests may
+      be moved in front of others they don't overlap. */
+  void batch_requests(std::vector<DrawingRequest*>& requests);
+
+  /** Searches the first end requests backwards for a batch that
+      request can be appended to without changing the result, returns
+      its index or end if there is none */
+  size_t find_batch(const std::vector<DrawingRequest*>& requests, size_t end,
+                    const TextureRequest& request, const Rectf& bounds) const;
+
+  /** Answers the GetPixelRequests of the lightmap that no light
+      touches with the ambient color, so only the pixels that are
+      actually lit have to be read back from the GPU */
+  void resolve_unlit_pixels();
+
+private:
+  /** The requests of one layer in submission order */
+  struct Layer
+  {
+    Layer(int layer_) : layer(layer_), requests(), batched(false) {}
+
+    int layer;
+    std::vector<DrawingRequest*> requests;
+
+    /** batch_requests() already ran, render() gets called once per
+        lightmap filter */
+    bool batched;
+  };
+
 private:
   DrawingContext& m_context;
   obstack& m_obst;
-  std::vector<DrawingRequest*> m_requests;
+  DrawingTarget m_target;
+
+  /** Request buckets sorted by layer, so render() doesn't have to
+      sort the requests */
+  std::vector<Layer> m_layers;
+
+  /** Index of the bucket the last request went to */
+  size_t m_current_layer;
+
+  /** TextureRequests are recycled from frame to frame instead of
+      being placed on the obstack, so their vectors keep their
+      capacity and drawing a surface doesn't allocate */
+  std::vector<std::unique_ptr<TextureRequest> > m_texture_pool;
+  size_t m_texture_pool_used;
+
+  /** Screen area covered by each batched texture request, scratch
+      space for batch_requests() and resolve_unlit_pixels() */
+  std::vector<Rectf> m_batch_bounds;
 
 private:
   Canvas(const Canvas&) = delete;
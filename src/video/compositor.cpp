@@ -17,38 +17,92 @@
 
 #include "video/compositor.hpp"
 
+#include <algorithm>
+
 #include "math/rect.hpp"
+#include "supertux/debug.hpp"
+#include "supertux/globals.hpp"
+#include "util/fnv_hash.hpp"
+#include "util/profiler.hpp"
 #include "video/drawing_request.hpp"
+#include "video/frame_arena.hpp"
 #include "video/painter.hpp"
+#include "video/render_stats.hpp"
 #include "video/renderer.hpp"
 #include "video/video_system.hpp"
 
+namespace {
+
+/** Seconds without lighting after which the lightmap texture is freed */
+const float LIGHTMAP_RELEASE_DELAY = 10.0f;
+
+} // namespace
+
 bool Compositor::s_render_lighting = true;
+float Compositor::s_lightmap_last_used = 0.0f;
+size_t Compositor::s_obstack_high_water = 0;
+size_t Compositor::s_arena_capacity = 0;
 
-Compositor::Compositor(VideoSystem& video_system) :
+Compositor::Compositor(VideoSystem& video_system, FrameArena& arena) :
   m_video_system(video_system),
-  m_obst(),
+  m_arena(arena),
   m_drawing_contexts()
 {
-  obstack_init(&m_obst);
 }
 
 Compositor::~Compositor()
 {
   m_drawing_contexts.clear();
-  obstack_free(&m_obst, nullptr);
+  // render() already took care of it if the frame got rendered
+  if (m_arena.get_used() > 0) {
+    m_arena.reset();
+  }
+  s_arena_capacity = m_arena.get_capacity();
 }
 
 DrawingContext&
 Compositor::make_context(bool overlay)
 {
-  m_drawing_contexts.emplace_back(new DrawingContext(m_video_system, m_obst, overlay));
+  m_drawing_contexts.emplace_back(new DrawingContext(m_video_system, m_arena.get(), overlay));
   return *m_drawing_contexts.back();
 }
 
+uint64_t
+Compositor::get_hash() const
+{
+  FNVHash hash;
+  for (const auto& ctx : m_drawing_contexts)
+  {
+    const Rect& viewport = ctx->get_viewport();
+    hash.add(viewport.left);
+    hash.add(viewport.top);
+    hash.add(viewport.right);
+    hash.add(viewport.bottom);
+
+    const Color ambient_color = ctx->get_ambient_color();
+    hash.add(ambient_color.red);
+    hash.add(ambient_color.green);
+    hash.add(ambient_color.blue);
+    hash.add(ambient_color.alpha);
+
+    hash.add(ctx->use_lightmap());
+
+    ctx->color().hash(hash);
+    if (!ctx->is_overlay()) {
+      ctx->light().hash(hash);
+    }
+  }
+  hash.add(s_render_lighting);
+  return hash.get();
+}
+
 void
-Compositor::render()
+Compositor::render(bool flip)
 {
+  Profiler::Scope profile_scope("render");
+  g_render_stats.begin_frame(g_debug.show_render_stats);
+  m_video_system.begin_frame();
+
   auto& lightmap = m_video_system.get_lightmap();
 
   bool use_lightmap = std::any_of(m_drawing_contexts.begin(), m_drawing_contexts.end(),
@@ -61,6 +115,8 @@ Compositor::render()
   // prepare lightmap
   if (use_lightmap)
   {
+    s_lightmap_last_used = g_real_time;
+
     lightmap.start_draw();
     Painter& painter = lightmap.get_painter();
 
@@ -78,6 +134,11 @@ Compositor::render()
     }
     lightmap.end_draw();
   }
+  else if (g_real_time - s_lightmap_last_used > LIGHTMAP_RELEASE_DELAY)
+  {
+    // levels without lighting don't need to keep the texture around
+    lightmap.release_texture();
+  }
 
   auto back_renderer = m_video_system.get_back_renderer();
   if (back_renderer)
@@ -135,6 +196,8 @@ Compositor::render()
       }
     }
 
+    renderer.end_scene();
+
     // Render overlay elements
     for (auto& ctx : m_drawing_contexts)
     {
@@ -151,10 +214,20 @@ Compositor::render()
   {
     ctx->clear();
   }
-  m_video_system.flip();
 
-  obstack_free(&m_obst, nullptr);
-  obstack_init(&m_obst);
+  if (flip)
+  {
+    // includes waiting for vsync
+    Profiler::Scope flip_scope("flip");
+    m_video_system.flip();
+  }
+  else
+  {
+    m_video_system.flush();
+  }
+
+  s_obstack_high_water = std::max(s_obstack_high_water, m_arena.get_used());
+  m_arena.reset();
 }
 
 /* EOF */
@@ -17,12 +17,12 @@
 #ifndef HEADER_SUPERTUX_VIDEO_COMPOSITOR_HPP
 #define HEADER_SUPERTUX_VIDEO_COMPOSITOR_HPP
 
+#include <stdint.h>
 #include <vector>
 #include <memory>
 
-#include "util/obstackpp.hpp"
-
 class DrawingContext;
+class FrameArena;
 class Rect;
 class VideoSystem;
 
@@ -32,11 +32,30 @@ public:
   /** Debug flag to disable lighting, used in the editor */
   static bool s_render_lighting;
 
+private:
+  /** g_real_time of the last frame that rendered the lightmap, the
+      lightmap texture is freed when it stays unused for a while */
+  static float s_lightmap_last_used;
+
+  /** Largest amount of request memory a frame needed so far */
+  static size_t s_obstack_high_water;
+
+  /** Memory the FrameArena of the last frame kept */
+  static size_t s_arena_capacity;
+
 public:
-  Compositor(VideoSystem& video_system);
+  /** The requests are allocated from arena, which is reset once the
+      frame is rendered */
+  Compositor(VideoSystem& video_system, FrameArena& arena);
   ~Compositor();
 
-  void render();
+  /** Renders all contexts, if flip is false the frame is only
+      flushed and the caller has to call VideoSystem::flip() */
+  void render(bool flip = true);
+
+  /** Hash over all requests and contexts, frames with the same hash
+      render to the same image */
+  uint64_t get_hash() const;
 
   /** Create a DrawingContext, if overlay is true the context will not
       feature light rendering. This is required for contexts that
@@ -44,11 +63,14 @@ public:
       otherwise their lighting would get messed up. */
   DrawingContext& make_context(bool overlay = false);
 
+  static size_t get_obstack_high_water() { return s_obstack_high_water; }
+  static size_t get_arena_capacity() { return s_arena_capacity; }
+
 private:
   VideoSystem& m_video_system;
 
-  /* obstack holding the memory of the drawing requests */
-  obstack m_obst;
+  /* holds the memory of the drawing requests */
+  FrameArena& m_arena;
 
   std::vector<std::unique_ptr<DrawingContext> > m_drawing_contexts;
 
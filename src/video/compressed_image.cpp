@@ -0,0 +1,158 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/compressed_image.hpp"
+
+#include <physfs.h>
+#include <sstream>
+#include <stdexcept>
+#include <string.h>
+
+#include "physfs/mapped_file.hpp"
+
+namespace {
+
+const unsigned char KTX_IDENTIFIER[12] = {
+  0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+};
+
+const uint32_t KTX_ENDIANNESS = 0x04030201;
+
+/** Header fields following the identifier */
+enum {
+  KTX_ENDIAN,
+  KTX_GL_TYPE,
+  KTX_GL_TYPE_SIZE,
+  KTX_GL_FORMAT,
+  KTX_GL_INTERNAL_FORMAT,
+  KTX_GL_BASE_INTERNAL_FORMAT,
+  KTX_PIXEL_WIDTH,
+  KTX_PIXEL_HEIGHT,
+  KTX_PIXEL_DEPTH,
+  KTX_NUMBER_OF_ARRAY_ELEMENTS,
+  KTX_NUMBER_OF_FACES,
+  KTX_NUMBER_OF_MIPMAP_LEVELS,
+  KTX_BYTES_OF_KEY_VALUE_DATA,
+  KTX_HEADER_FIELDS
+};
+
+uint32_t read_uint32(const char* data, size_t pos, bool swap)
+{
+  uint32_t value;
+  memcpy(&value, data + pos, sizeof(value));
+  if (swap) {
+    value = ((value & 0x000000ff) << 24) | ((value & 0x0000ff00) << 8) |
+            ((value & 0x00ff0000) >> 8)  | ((value & 0xff000000) >> 24);
+  }
+  return value;
+}
+
+[[noreturn]] void fail(const std::string& filename, const std::string& what)
+{
+  std::ostringstream msg;
+  msg << "Couldn't load compressed image '" << filename << "': " << what;
+  throw std::runtime_error(msg.str());
+}
+
+} // namespace
+
+std::unique_ptr<CompressedImage>
+CompressedImage::from_file(const std::string& filename)
+{
+  if (auto mapped = MappedFile::open(filename)) {
+    return from_data(mapped->get_data(), mapped->get_size(), filename);
+  }
+
+  PHYSFS_File* file = PHYSFS_openRead(filename.c_str());
+  if (!file)
+    fail(filename, PHYSFS_getErrorByCode(PHYSFS_getLastErrorCode()));
+
+  std::string data;
+  const PHYSFS_sint64 length = PHYSFS_fileLength(file);
+  if (length > 0)
+  {
+    data.resize(static_cast<size_t>(length));
+    if (PHYSFS_readBytes(file, &data[0], static_cast<PHYSFS_uint64>(length)) != length)
+    {
+      PHYSFS_close(file);
+      fail(filename, "read error");
+    }
+  }
+  PHYSFS_close(file);
+
+  return from_data(data, filename);
+}
+
+std::unique_ptr<CompressedImage>
+CompressedImage::from_data(const std::string& data, const std::string& filename)
+{
+  return from_data(data.data(), data.size(), filename);
+}
+
+std::unique_ptr<CompressedImage>
+CompressedImage::from_data(const char* data, size_t size, const std::string& filename)
+{
+  const size_t header_size = sizeof(KTX_IDENTIFIER) + 4 * KTX_HEADER_FIELDS;
+  if (size < header_size ||
+      memcmp(data, KTX_IDENTIFIER, sizeof(KTX_IDENTIFIER)) != 0)
+  {
+    fail(filename, "not a KTX file");
+  }
+
+  // files are written in the byte order of the machine that made them
+  const bool swap = read_uint32(data, sizeof(KTX_IDENTIFIER), false) != KTX_ENDIANNESS;
+  auto field = [&data, swap](int index) {
+    return read_uint32(data, sizeof(KTX_IDENTIFIER) + 4 * index, swap);
+  };
+
+  if (field(KTX_ENDIAN) != KTX_ENDIANNESS)
+    fail(filename, "bad endianness marker");
+
+  if (field(KTX_GL_TYPE) != 0 || field(KTX_GL_FORMAT) != 0)
+    fail(filename, "image isn't compressed");
+
+  if (field(KTX_PIXEL_DEPTH) > 1 || field(KTX_NUMBER_OF_ARRAY_ELEMENTS) > 1 ||
+      field(KTX_NUMBER_OF_FACES) != 1)
+    fail(filename, "only 2D textures are supported");
+
+  const uint32_t width = field(KTX_PIXEL_WIDTH);
+  const uint32_t height = field(KTX_PIXEL_HEIGHT);
+  if (width == 0 || height == 0 || width > 16384 || height > 16384)
+    fail(filename, "bad image size");
+
+  // skip the key/value pairs, the first mipmap level follows
+  const size_t level_pos = header_size + field(KTX_BYTES_OF_KEY_VALUE_DATA);
+  if (level_pos + 4 > size)
+    fail(filename, "file truncated");
+
+  const uint32_t image_size = read_uint32(data, level_pos, swap);
+  if (image_size == 0 || image_size > size - level_pos - 4)
+    fail(filename, "file truncated");
+
+  return std::make_unique<CompressedImage>(field(KTX_GL_INTERNAL_FORMAT),
+                                           static_cast<int>(width), static_cast<int>(height),
+                                           std::string(data + level_pos + 4, image_size));
+}
+
+CompressedImage::CompressedImage(uint32_t internal_format, int width, int height, std::string data) :
+  m_internal_format(internal_format),
+  m_width(width),
+  m_height(height),
+  m_data(std::move(data))
+{
+}
+
+/* EOF */
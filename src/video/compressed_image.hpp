@@ -0,0 +1,60 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_COMPRESSED_IMAGE_HPP
+#define HEADER_SUPERTUX_VIDEO_COMPRESSED_IMAGE_HPP
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+
+/** An image in a GPU compressed format (ETC2, BC, ASTC, ...) as
+    stored in a KTX file, only the first mipmap level is kept */
+class CompressedImage final
+{
+public:
+  /** Loads a KTX (version 1) file, throws on error */
+  static std::unique_ptr<CompressedImage> from_file(const std::string& filename);
+
+  /** Parses the content of a KTX file, throws on error */
+  static std::unique_ptr<CompressedImage> from_data(const std::string& data, const std::string& filename = "<data>");
+  static std::unique_ptr<CompressedImage> from_data(const char* data, size_t size, const std::string& filename);
+
+public:
+  CompressedImage(uint32_t internal_format, int width, int height, std::string data);
+
+  /** The GL internal format, e.g. GL_COMPRESSED_RGBA8_ETC2_EAC */
+  uint32_t get_internal_format() const { return m_internal_format; }
+
+  int get_width() const { return m_width; }
+  int get_height() const { return m_height; }
+
+  const std::string& get_data() const { return m_data; }
+
+private:
+  uint32_t m_internal_format;
+  int m_width;
+  int m_height;
+  std::string m_data;
+
+private:
+  CompressedImage(const CompressedImage&) = delete;
+  CompressedImage& operator=(const CompressedImage&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -31,7 +31,7 @@ class Surface;
 
 enum RequestType
 {
-  TEXTURE, GRADIENT, FILLRECT, INVERSEELLIPSE, GETPIXEL, LINE, TRIANGLE
+  TEXTURE, GRADIENT, FILLRECT, INVERSEELLIPSE, GETPIXEL, LINE, LINES, TRIANGLE
 };
 
 struct DrawingRequest
@@ -51,7 +51,6 @@ struct DrawingRequest
     alpha(),
     blend()
   {}
-  virtual ~DrawingRequest() {}
 };
 
 struct TextureRequest : public DrawingRequest
@@ -63,9 +62,35 @@ struct TextureRequest : public DrawingRequest
     srcrects(),
     dstrects(),
     angles(),
-    color(1.0f, 1.0f, 1.0f)
+    color(1.0f, 1.0f, 1.0f),
+    colors()
   {}
 
+  /** Restores the freshly constructed state while keeping the
+      capacity of the vectors, see Canvas::new_texture_request() */
+  void reset()
+  {
+    layer = 0;
+    flip = Flip();
+    alpha = 0.0f;
+    blend = Blend();
+    texture = nullptr;
+    displacement_texture = nullptr;
+    srcrects.clear();
+    dstrects.clear();
+    angles.clear();
+    color = Color(1.0f, 1.0f, 1.0f);
+    colors.clear();
+  }
+
+  /** Color of the ith quad, with alpha applied */
+  Color get_color(size_t i) const
+  {
+    return colors.empty() ?
+      Color(color.red, color.green, color.blue, color.alpha * alpha) :
+      colors[i];
+  }
+
   const Texture* texture;
   const Texture* displacement_texture;
   std::vector<Rectf> srcrects;
@@ -73,6 +98,11 @@ struct TextureRequest : public DrawingRequest
   std::vector<float> angles;
   Color color;
 
+  /** Colors per quad, alpha included, once Canvas merged requests of
+      different colors into this one. While empty all quads are drawn
+      with color and alpha. */
+  std::vector<Color> colors;
+
 private:
   TextureRequest(const TextureRequest&) = delete;
   TextureRequest& operator=(const TextureRequest&) = delete;
@@ -140,6 +170,22 @@ struct LineRequest : public DrawingRequest
   Color color;
 };
 
+/** Many lines of one color drawn at once, e.g. the editor grid */
+struct LinesRequest : public DrawingRequest
+{
+  LinesRequest() :
+    DrawingRequest(LINES),
+    points(),
+    count(),
+    color()
+  {}
+
+  /** Start and end point of each line, allocated on the obstack */
+  const Vector* points;
+  size_t count;
+  Color color;
+};
+
 struct TriangleRequest : public DrawingRequest
 {
   TriangleRequest() :
@@ -0,0 +1,78 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/dynamic_resolution.hpp"
+
+#include <algorithm>
+#include <math.h>
+
+namespace {
+
+/** Weight of the latest frame in the running average */
+const float AVERAGE_WEIGHT = 0.1f;
+
+/** Scale back up only when there is this much headroom, pixels cost
+    the square of the scale, so one step up adds more than a step */
+const float HEADROOM = 0.75f;
+
+} // namespace
+
+const float DynamicResolution::STEP = 0.05f;
+
+DynamicResolution::DynamicResolution() :
+  m_scale(1.0f),
+  m_average_ms(0.0f),
+  m_cooldown(0)
+{
+}
+
+void
+DynamicResolution::update(float gpu_ms, float target_ms, float min_scale, float max_scale)
+{
+  m_scale = std::max(std::min(m_scale, max_scale), min_scale);
+
+  m_average_ms = (m_average_ms == 0.0f) ? gpu_ms :
+    m_average_ms * (1.0f - AVERAGE_WEIGHT) + gpu_ms * AVERAGE_WEIGHT;
+
+  if (m_cooldown > 0)
+  {
+    m_cooldown -= 1;
+    return;
+  }
+
+  float scale = m_scale;
+  if (m_average_ms > target_ms)
+  {
+    // GPU time is about proportional to the number of pixels
+    const float wanted = m_scale * sqrtf(target_ms / m_average_ms);
+    scale = std::min(floorf(wanted / STEP) * STEP, m_scale - STEP);
+  }
+  else if (m_average_ms < target_ms * HEADROOM)
+  {
+    scale = m_scale + STEP;
+  }
+  scale = std::max(std::min(scale, max_scale), min_scale);
+
+  if (scale != m_scale)
+  {
+    // estimate the time at the new scale until it is measured
+    m_average_ms *= (scale * scale) / (m_scale * m_scale);
+    m_scale = scale;
+    m_cooldown = COOLDOWN_FRAMES;
+  }
+}
+
+/* EOF */
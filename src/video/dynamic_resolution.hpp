@@ -0,0 +1,56 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_DYNAMIC_RESOLUTION_HPP
+#define HEADER_SUPERTUX_VIDEO_DYNAMIC_RESOLUTION_HPP
+
+/** Picks the render scale from the measured GPU time of the frames.
+    The scale moves in fixed steps and waits a few frames after each
+    change, so render targets aren't reallocated every frame and the
+    new scale gets measured before the next decision. */
+class DynamicResolution final
+{
+public:
+  /** Granularity of the scale */
+  static const float STEP;
+
+  /** Frames to wait after a change */
+  static const int COOLDOWN_FRAMES = 30;
+
+public:
+  DynamicResolution();
+
+  /** Feeds the GPU time of a frame, the scale stays within min_scale
+      and max_scale */
+  void update(float gpu_ms, float target_ms, float min_scale, float max_scale);
+
+  float get_scale() const { return m_scale; }
+
+private:
+  float m_scale;
+
+  /** running average of the GPU time, 0 until the first frame */
+  float m_average_ms;
+  int m_cooldown;
+
+private:
+  DynamicResolution(const DynamicResolution&) = delete;
+  DynamicResolution& operator=(const DynamicResolution&) = delete;
+};
+
+#endif
+
+/* EOF */
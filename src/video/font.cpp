@@ -17,6 +17,39 @@
 
 #include "video/font.hpp"
 
+#include <vector>
+
+namespace {
+
+const size_t MAX_CACHED_WIDTHS = 1024;
+
+} // namespace
+
+TextWidthCache::TextWidthCache() :
+  m_widths()
+{
+}
+
+bool
+TextWidthCache::get(const std::string& text, float& width) const
+{
+  auto it = m_widths.find(text);
+  if (it == m_widths.end())
+    return false;
+
+  width = it->second;
+  return true;
+}
+
+void
+TextWidthCache::set(const std::string& text, float width)
+{
+  if (m_widths.size() >= MAX_CACHED_WIDTHS) {
+    m_widths.clear();
+  }
+  m_widths[text] = width;
+}
+
 std::string
 Font::wrap_to_chars(const std::string& s, int line_length, std::string* overflow)
 {
@@ -39,4 +72,52 @@ Font::wrap_to_chars(const std::string& s, int line_length, std::string* overflow
   return s;
 }
 
+std::string
+Font::wrap_to_width(const std::string& s, float width, std::string* overflow)
+{
+  // if text is already smaller, return full text
+  if (s.empty() || get_text_width(s) <= width) {
+    if (overflow) *overflow = "";
+    return s;
+  }
+
+  // byte offsets of the character boundaries, multibyte characters
+  // are never split
+  std::vector<size_t> bounds;
+  for (size_t i = 0; i < s.length(); ++i) {
+    // skip "continuation" bytes in the form 10xxxxxx
+    if ((s[i] & 0xC0) != 0x80) {
+      bounds.push_back(i);
+    }
+  }
+  bounds.push_back(s.length());
+
+  // binary search for the longest prefix that still fits, the full
+  // text doesn't, so the answer is below bounds.size() - 1
+  size_t lo = 0;
+  size_t hi = bounds.size() - 1;
+  while (hi - lo > 1)
+  {
+    const size_t mid = lo + (hi - lo) / 2;
+    if (get_text_width(s.substr(0, bounds[mid])) <= width) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  const size_t fit = bounds[lo];
+
+  // if we can find a whitespace character to break at, return text up to this character
+  const size_t space = s.rfind(' ', fit);
+  if (space != std::string::npos) {
+    if (overflow) *overflow = s.substr(space + 1);
+    return s.substr(0, space);
+  }
+
+  // hard-wrap at width, edge case when even one char is too wide
+  const size_t cut = (lo == 0) ? bounds[1] : fit;
+  if (overflow) *overflow = s.substr(cut);
+  return s.substr(0, cut);
+}
+
 /* EOF */
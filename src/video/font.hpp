@@ -19,6 +19,7 @@
 #define HEADER_SUPERTUX_VIDEO_FONT_HPP
 
 #include <string>
+#include <unordered_map>
 
 #include "math/rectf.hpp"
 #include "math/vector.hpp"
@@ -34,6 +35,27 @@ enum FontAlignment {
   ALIGN_RIGHT
 };
 
+/** Widths of recently measured strings, menus, the console and the
+    credits measure the same text every frame. The cache is simply
+    emptied once it holds too many strings. */
+class TextWidthCache final
+{
+public:
+  TextWidthCache();
+
+  /** Returns false if text isn't cached */
+  bool get(const std::string& text, float& width) const;
+  void set(const std::string& text, float width);
+  void clear() { m_widths.clear(); }
+
+private:
+  std::unordered_map<std::string, float> m_widths;
+
+private:
+  TextWidthCache(const TextWidthCache&) = delete;
+  TextWidthCache& operator=(const TextWidthCache&) = delete;
+};
+
 class Font
 {
 public:
@@ -50,7 +72,11 @@ public:
   virtual float get_text_width(const std::string& text) const = 0;
   virtual float get_text_height(const std::string& text) const = 0;
 
-  virtual std::string wrap_to_width(const std::string& text, float width, std::string* overflow) = 0;
+  /** returns the given string, truncated (preferably at whitespace)
+      to fit into width, the remainder goes into overflow. Needs
+      O(log n) calls to get_text_width(), assuming that the width of a
+      prefix never exceeds the width of a longer prefix. */
+  virtual std::string wrap_to_width(const std::string& text, float width, std::string* overflow);
 
   virtual void draw_text(Canvas& canvas, const std::string& text,
                          const Vector& pos, FontAlignment alignment, int layer, const Color& color) = 0;
@@ -0,0 +1,108 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/frame_arena.hpp"
+
+#include <algorithm>
+
+namespace {
+
+const size_t MIN_CHUNK_SIZE = 64 * 1024;
+
+/** Frames that have to use less than a quarter of the chunk before
+    it shrinks, about ten seconds */
+const int SHRINK_FRAMES = 600;
+
+size_t round_up_chunk_size(size_t bytes)
+{
+  size_t size = MIN_CHUNK_SIZE;
+  while (size < bytes) {
+    size *= 2;
+  }
+  return size;
+}
+
+} // namespace
+
+FrameArena::FrameArena() :
+  m_obst(),
+  m_base(nullptr),
+  m_chunk_size(0),
+  m_low_peak(0),
+  m_low_frames(0)
+{
+  init(MIN_CHUNK_SIZE);
+}
+
+FrameArena::~FrameArena()
+{
+  obstack_free(&m_obst, nullptr);
+}
+
+void
+FrameArena::init(size_t chunk_size)
+{
+  m_chunk_size = chunk_size;
+  obstack_begin(&m_obst, static_cast<int>(chunk_size));
+  m_base = obstack_alloc(&m_obst, 0);
+  m_low_peak = 0;
+  m_low_frames = 0;
+}
+
+size_t
+FrameArena::get_used() const
+{
+  obstack* obst = const_cast<obstack*>(&m_obst);
+  const size_t memory = static_cast<size_t>(obstack_memory_used(obst));
+  if (memory > m_chunk_size)
+    return memory;
+
+  return static_cast<size_t>(static_cast<char*>(obstack_next_free(obst)) - static_cast<char*>(m_base));
+}
+
+void
+FrameArena::reset()
+{
+  const size_t used = get_used();
+
+  if (used > m_chunk_size)
+  {
+    // the frame needed further chunks, make the first one big enough
+    obstack_free(&m_obst, nullptr);
+    init(round_up_chunk_size(used + used / 4));
+    return;
+  }
+
+  obstack_free(&m_obst, m_base);
+
+  if (m_chunk_size > MIN_CHUNK_SIZE && used < m_chunk_size / 4)
+  {
+    m_low_peak = std::max(m_low_peak, used);
+    m_low_frames += 1;
+    if (m_low_frames >= SHRINK_FRAMES)
+    {
+      obstack_free(&m_obst, nullptr);
+      init(round_up_chunk_size(m_low_peak * 2));
+    }
+  }
+  else
+  {
+    m_low_peak = 0;
+    m_low_frames = 0;
+  }
+}
+
+/* EOF */
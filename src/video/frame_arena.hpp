@@ -0,0 +1,69 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_FRAME_ARENA_HPP
+#define HEADER_SUPERTUX_VIDEO_FRAME_ARENA_HPP
+
+#include <stddef.h>
+
+#include "util/obstackpp.hpp"
+
+/** obstack for the drawing requests of a window that lives across
+    frames. reset() rewinds it to the start instead of freeing the
+    chunks, and the chunk size follows the frames' needs, so a frame
+    normally doesn't allocate at all. It only grows when a frame
+    spills over into further chunks and shrinks after a longer stretch
+    of frames using little of it. */
+class FrameArena final
+{
+public:
+  FrameArena();
+  ~FrameArena();
+
+  obstack& get() { return m_obst; }
+
+  /** Releases everything allocated since the last reset() */
+  void reset();
+
+  /** Bytes the requests of the current frame take up so far */
+  size_t get_used() const;
+
+  /** Size of the chunk the arena keeps between frames */
+  size_t get_capacity() const { return m_chunk_size; }
+
+private:
+  void init(size_t chunk_size);
+
+private:
+  obstack m_obst;
+
+  /** first object in the arena, reset() frees back to it */
+  void* m_base;
+
+  size_t m_chunk_size;
+
+  /** Largest use during the current stretch of low use */
+  size_t m_low_peak;
+  int m_low_frames;
+
+private:
+  FrameArena(const FrameArena&) = delete;
+  FrameArena& operator=(const FrameArena&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,105 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/frame_capture.hpp"
+
+#include "util/log.hpp"
+#include "video/sdl_surface_ptr.hpp"
+#include "video/video_system.hpp"
+
+FrameCapture::FrameCapture(const std::string& filename) :
+  m_output(std::make_shared<Output>())
+{
+  m_output->filename = filename;
+  m_output->stream.open(filename.c_str(), std::ios::binary);
+  if (!m_output->stream)
+  {
+    log_warning << "Couldn't open capture file '" << filename << "'" << std::endl;
+    m_output.reset();
+  }
+}
+
+FrameCapture::~FrameCapture()
+{
+  if (!m_output)
+    return;
+
+  if (JobSystem::current()) {
+    for (const auto& write : m_output->pending_writes) {
+      JobSystem::current()->wait(write);
+    }
+  }
+
+  log_info << "Captured " << m_output->frames << " frames of "
+           << m_output->size.width << "x" << m_output->size.height
+           << " to '" << m_output->filename << "'" << std::endl;
+}
+
+void
+FrameCapture::add_frame(VideoSystem& video_system)
+{
+  if (!m_output)
+    return;
+
+  video_system.read_screen([output = m_output](SDLSurfacePtr surface) {
+      if (!surface)
+        return;
+
+      // raw video can't change its size midway
+      const Size size(surface->w, surface->h);
+      if (output->frames == 0) {
+        output->size = size;
+      } else if (size != output->size) {
+        log_warning << "window size changed, frame not captured" << std::endl;
+        return;
+      }
+      output->frames += 1;
+
+      // std::function wants a copyable job
+      auto shared_surface = std::make_shared<SDLSurfacePtr>(std::move(surface));
+      auto job = [output, shared_surface] {
+        const SDL_Surface& frame = **shared_surface;
+        for (int y = 0; y < frame.h; ++y) {
+          output->stream.write(static_cast<const char*>(frame.pixels) + y * frame.pitch, 3 * frame.w);
+        }
+      };
+
+      if (!JobSystem::current())
+      {
+        job();
+        return;
+      }
+
+      auto& pending = output->pending_writes;
+      while (!pending.empty() && pending.front().is_done()) {
+        pending.pop_front();
+      }
+      if (pending.size() >= MAX_PENDING_WRITES)
+      {
+        JobSystem::current()->wait(pending.front());
+        pending.pop_front();
+      }
+
+      // writes go out in order
+      if (pending.empty()) {
+        pending.push_back(JobSystem::current()->schedule(std::move(job)));
+      } else {
+        pending.push_back(JobSystem::current()->schedule(std::move(job), { pending.back() }));
+      }
+    });
+}
+
+/* EOF */
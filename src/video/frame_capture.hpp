@@ -0,0 +1,70 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_FRAME_CAPTURE_HPP
+#define HEADER_SUPERTUX_VIDEO_FRAME_CAPTURE_HPP
+
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "math/size.hpp"
+#include "util/job_system.hpp"
+
+class VideoSystem;
+
+/** Streams frames to a file as headerless RGB24 video, e.g. for
+    "ffmpeg -f rawvideo -pixel_format rgb24 -video_size WxH". The
+    frames are read back asynchronously and written on the
+    JobSystem. */
+class FrameCapture final
+{
+public:
+  /** Writes queued before the capture waits for the oldest one */
+  static const size_t MAX_PENDING_WRITES = 8;
+
+public:
+  FrameCapture(const std::string& filename);
+  ~FrameCapture();
+
+  /** Captures the frame that is shown next */
+  void add_frame(VideoSystem& video_system);
+
+private:
+  /** Shared with the pending reads, which may outlive the capture */
+  struct Output
+  {
+    Output() : stream(), filename(), size(), frames(0), pending_writes() {}
+
+    std::ofstream stream;
+    std::string filename;
+    Size size;
+    int frames;
+    std::deque<JobSystem::Handle> pending_writes;
+  };
+
+private:
+  std::shared_ptr<Output> m_output;
+
+private:
+  FrameCapture(const FrameCapture&) = delete;
+  FrameCapture& operator=(const FrameCapture&) = delete;
+};
+
+#endif
+
+/* EOF */
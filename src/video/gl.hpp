@@ -21,7 +21,9 @@
 
 #ifdef HAVE_OPENGL
 
-#if defined(USE_OPENGLES2)
+#if defined(USE_OPENGLES3)
+#  include <GLES3/gl3.h>
+#elif defined(USE_OPENGLES2)
 #  include <SDL_opengles2.h>
 #elif defined(USE_OPENGLES1)
 #  include <SDL_opengles.h>
@@ -39,7 +41,9 @@
 #  define glOrtho glOrthof
 #endif
 
-#ifdef USE_OPENGLES2
+// USE_OPENGLES3 builds define USE_OPENGLES2 as well and only lift
+// the restrictions that GLES3 doesn't have
+#if defined(USE_OPENGLES2) && !defined(USE_OPENGLES3)
 // These are required for OpenGL3.3Core, but not availabel en GLES2,
 // simple no-op replacement looks prettier than #ifdef
 inline void glGenVertexArrays(GLsizei n, GLuint *arrays) {}
@@ -16,14 +16,18 @@
 
 #include "video/gl/gl20_context.hpp"
 
+#include <assert.h>
+
 #include "supertux/globals.hpp"
 #include "video/glutil.hpp"
 #include "video/color.hpp"
 #include "video/gl/gl_texture.hpp"
+#include "video/render_stats.hpp"
 
 #ifndef USE_OPENGLES2
 
-GL20Context::GL20Context()
+GL20Context::GL20Context() :
+  m_state()
 {
   assert_gl();
 }
@@ -37,6 +41,8 @@ GL20Context::bind()
 {
   assert_gl();
 
+  m_state.invalidate();
+
   glDisable(GL_DEPTH_TEST);
   glDisable(GL_CULL_FACE);
   glEnable(GL_BLEND);
@@ -74,9 +80,13 @@ GL20Context::ortho(float width, float height, bool vflip)
 void
 GL20Context::blend_func(GLenum src, GLenum dst)
 {
+  if (!m_state.set_blend_func(src, dst))
+    return;
+
   assert_gl();
 
   glBlendFunc(src, dst);
+  g_render_stats.add_state_change();
 
   assert_gl();
 }
@@ -99,6 +109,7 @@ GL20Context::set_texcoords(const float* data, size_t size)
 
   glEnableClientState(GL_TEXTURE_COORD_ARRAY);
   glTexCoordPointer(2, GL_FLOAT, 0, data);
+  m_state.invalidate_value(GLStateCache::TEXCOORD);
 
   assert_gl();
 }
@@ -106,6 +117,10 @@ GL20Context::set_texcoords(const float* data, size_t size)
 void
 GL20Context::set_texcoord(float u, float v)
 {
+  // only disables the array, so the value is the same for every call
+  if (!m_state.set_value(GLStateCache::TEXCOORD, 0.0f, 0.0f))
+    return;
+
   assert_gl();
 
   glDisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -120,6 +135,7 @@ GL20Context::set_colors(const float* data, size_t size)
 
   glEnableClientState(GL_COLOR_ARRAY);
   glColorPointer(4, GL_FLOAT, 0, data);
+  m_state.invalidate_color();
 
   assert_gl();
 }
@@ -127,6 +143,9 @@ GL20Context::set_colors(const float* data, size_t size)
 void
 GL20Context::set_color(const Color& color)
 {
+  if (!m_state.set_color(color))
+    return;
+
   assert_gl();
 
   glDisableClientState(GL_COLOR_ARRAY);
@@ -140,28 +159,35 @@ GL20Context::bind_texture(const Texture& texture, const Texture* displacement_te
 {
   assert_gl();
 
-  glEnable(GL_TEXTURE_2D);
-  glBindTexture(GL_TEXTURE_2D, static_cast<const GLTexture&>(texture).get_handle());
+  g_render_stats.add_texture_bind();
+
+  if (m_state.set_texturing(true)) {
+    glEnable(GL_TEXTURE_2D);
+  }
+  const GLuint handle = static_cast<const GLTexture&>(texture).get_handle();
+  if (m_state.set_texture(0, handle)) {
+    glBindTexture(GL_TEXTURE_2D, handle);
+  }
 
   assert_gl();
 
+  // the texture matrix is shadowed by its translation, zero for identity
   Vector animate = static_cast<const GLTexture&>(texture).get_sampler().get_animate();
-  if (animate.x == 0.0f && animate.y == 0.0f)
-  {
-    glMatrixMode(GL_TEXTURE);
-    glLoadIdentity();
-    glMatrixMode(GL_MODELVIEW);
-  }
-  else
+  if (animate.x != 0.0f || animate.y != 0.0f)
   {
     animate.x /= static_cast<float>(texture.get_image_width());
     animate.y /= static_cast<float>(texture.get_image_height());
 
     animate *= g_game_time;
+  }
 
+  if (m_state.set_value(GLStateCache::TEXTURE_MATRIX, animate.x, animate.y))
+  {
     glMatrixMode(GL_TEXTURE);
     glLoadIdentity();
-    glTranslatef(animate.x, animate.y, 0.0f);
+    if (animate.x != 0.0f || animate.y != 0.0f) {
+      glTranslatef(animate.x, animate.y, 0.0f);
+    }
     glMatrixMode(GL_MODELVIEW);
   }
 
@@ -173,7 +199,11 @@ GL20Context::bind_no_texture()
 {
   assert_gl();
 
-  glDisable(GL_TEXTURE_2D);
+  g_render_stats.add_texture_bind();
+
+  if (m_state.set_texturing(false)) {
+    glDisable(GL_TEXTURE_2D);
+  }
 
   assert_gl();
 }
@@ -184,10 +214,17 @@ GL20Context::draw_arrays(GLenum type, GLint first, GLsizei count)
   assert_gl();
 
   glDrawArrays(type, first, count);
+  g_render_stats.add_draw_call(count);
 
   assert_gl();
 }
 
+void
+GL20Context::draw_quads(const GLQuad* quads, size_t count)
+{
+  assert(false && "GL20Context doesn't support draw_quads()");
+}
+
 #endif
 
 /* EOF */
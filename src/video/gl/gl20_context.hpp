@@ -18,6 +18,7 @@
 #define HEADER_SUPERTUX_VIDEO_GL_GL20_CONTEXT_HPP
 
 #include "video/gl/gl_context.hpp"
+#include "video/gl/gl_state_cache.hpp"
 
 #ifndef USE_OPENGLES2
 
@@ -48,8 +49,14 @@ public:
 
   virtual void draw_arrays(GLenum type, GLint first, GLsizei count) override;
 
+  virtual void draw_quads(const GLQuad* quads, size_t count) override;
+  virtual bool supports_quads() const override { return false; }
+
   virtual bool supports_framebuffer() const override { return false; }
 
+private:
+  GLStateCache m_state;
+
 private:
   GL20Context(const GL20Context&) = delete;
   GL20Context& operator=(const GL20Context&) = delete;
@@ -16,6 +16,7 @@
 
 #include "video/gl/gl33core_context.hpp"
 
+#include "math/rect.hpp"
 #include "supertux/globals.hpp"
 #include "video/color.hpp"
 #include "video/gl/gl_program.hpp"
@@ -24,6 +25,7 @@
 #include "video/gl/gl_vertex_arrays.hpp"
 #include "video/gl/gl_video_system.hpp"
 #include "video/glutil.hpp"
+#include "video/render_stats.hpp"
 
 GL33CoreContext::GL33CoreContext(GLVideoSystem& video_system) :
   m_video_system(video_system),
@@ -32,7 +34,8 @@ GL33CoreContext::GL33CoreContext(GLVideoSystem& video_system) :
   m_white_texture(),
   m_black_texture(),
   m_grey_texture(),
-  m_transparent_texture()
+  m_transparent_texture(),
+  m_state()
 {
   assert_gl();
 
@@ -55,6 +58,8 @@ GL33CoreContext::bind()
 {
   assert_gl();
 
+  m_state.invalidate();
+
   glDisable(GL_DEPTH_TEST);
   glDisable(GL_CULL_FACE);
   glEnable(GL_BLEND);
@@ -76,8 +81,7 @@ GL33CoreContext::bind()
     glUniform1f(m_program->get_uniform_location("backbuffer"), 1.0f);
   }
 
-  glActiveTexture(GL_TEXTURE2);
-  glBindTexture(GL_TEXTURE_2D, texture->get_handle());
+  bind_texture_unit(2, texture->get_handle());
 
   const float tsx =
     static_cast<float>(texture->get_image_width()) /
@@ -87,7 +91,8 @@ GL33CoreContext::bind()
     static_cast<float>(texture->get_image_height()) /
     static_cast<float>(texture->get_texture_height());
 
-  const Rect& rect = m_video_system.get_viewport().get_rect();
+  // the screen renderer may draw the level into a smaller texture
+  const Rect rect = m_video_system.get_renderer().get_rect();
 
   const float sx = tsx / static_cast<float>(rect.get_width());
   const float sy = tsy / static_cast<float>(rect.get_height());
@@ -137,9 +142,13 @@ GL33CoreContext::ortho(float width, float height, bool vflip)
 void
 GL33CoreContext::blend_func(GLenum src, GLenum dst)
 {
+  if (!m_state.set_blend_func(src, dst))
+    return;
+
   assert_gl();
 
   glBlendFunc(src, dst);
+  g_render_stats.add_state_change();
 
   assert_gl();
 }
@@ -154,24 +163,42 @@ void
 GL33CoreContext::set_texcoords(const float* data, size_t size)
 {
   m_vertex_arrays->set_texcoords(data, size);
+  m_state.invalidate_value(GLStateCache::TEXCOORD);
 }
 
 void
 GL33CoreContext::set_texcoord(float u, float v)
 {
-  m_vertex_arrays->set_texcoord(u, v);
+  if (m_state.set_value(GLStateCache::TEXCOORD, u, v)) {
+    m_vertex_arrays->set_texcoord(u, v);
+  }
 }
 
 void
 GL33CoreContext::set_colors(const float* data, size_t size)
 {
   m_vertex_arrays->set_colors(data, size);
+  m_state.invalidate_color();
 }
 
 void
 GL33CoreContext::set_color(const Color& color)
 {
-  m_vertex_arrays->set_color(color);
+  if (m_state.set_color(color)) {
+    m_vertex_arrays->set_color(color);
+  }
+}
+
+void
+GL33CoreContext::bind_texture_unit(int unit, GLuint handle)
+{
+  if (!m_state.set_texture(unit, handle))
+    return;
+
+  if (m_state.set_active_texture(unit)) {
+    glActiveTexture(GL_TEXTURE0 + static_cast<GLenum>(unit));
+  }
+  glBindTexture(GL_TEXTURE_2D, handle);
 }
 
 void
@@ -179,42 +206,44 @@ GL33CoreContext::bind_texture(const Texture& texture, const Texture* displacemen
 {
   assert_gl();
 
+  g_render_stats.add_texture_bind();
+
   GLTextureRenderer* back_renderer = static_cast<GLTextureRenderer*>(m_video_system.get_back_renderer());
 
   if (displacement_texture && back_renderer->is_rendering())
   {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, m_transparent_texture->get_handle());
+    bind_texture_unit(0, m_transparent_texture->get_handle());
   }
   else
   {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, static_cast<const GLTexture&>(texture).get_handle());
+    bind_texture_unit(0, static_cast<const GLTexture&>(texture).get_handle());
 
     Vector animate = static_cast<const GLTexture&>(texture).get_sampler().get_animate();
 
     animate.x /= static_cast<float>(texture.get_image_width());
     animate.y /= static_cast<float>(texture.get_image_height());
 
-    glUniform2f(m_program->get_uniform_location("animate"), animate.x, animate.y);
+    if (m_state.set_value(GLStateCache::ANIMATE, animate.x, animate.y)) {
+      glUniform2f(m_program->get_uniform_location("animate"), animate.x, animate.y);
+    }
   }
 
   if (displacement_texture)
   {
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, static_cast<const GLTexture&>(*displacement_texture).get_handle());
+    bind_texture_unit(1, static_cast<const GLTexture&>(*displacement_texture).get_handle());
 
     Vector animate = static_cast<const GLTexture&>(*displacement_texture).get_sampler().get_animate();
 
     animate.x /= static_cast<float>(displacement_texture->get_image_width());
     animate.y /= static_cast<float>(displacement_texture->get_image_height());
 
-    glUniform2f(m_program->get_uniform_location("displacement_animate"), animate.x, animate.y);
+    if (m_state.set_value(GLStateCache::DISPLACEMENT_ANIMATE, animate.x, animate.y)) {
+      glUniform2f(m_program->get_uniform_location("displacement_animate"), animate.x, animate.y);
+    }
   }
   else
   {
-    glActiveTexture(GL_TEXTURE1);
-    glBindTexture(GL_TEXTURE_2D, m_grey_texture->get_handle());
+    bind_texture_unit(1, m_grey_texture->get_handle());
   }
 
   assert_gl();
@@ -225,11 +254,10 @@ GL33CoreContext::bind_no_texture()
 {
   assert_gl();
 
-  glActiveTexture(GL_TEXTURE0);
-  glBindTexture(GL_TEXTURE_2D, m_white_texture->get_handle());
+  g_render_stats.add_texture_bind();
 
-  glActiveTexture(GL_TEXTURE1);
-  glBindTexture(GL_TEXTURE_2D, m_grey_texture->get_handle());
+  bind_texture_unit(0, m_white_texture->get_handle());
+  bind_texture_unit(1, m_grey_texture->get_handle());
 
   assert_gl();
 }
@@ -240,8 +268,40 @@ GL33CoreContext::draw_arrays(GLenum type, GLint first, GLsizei count)
   assert_gl();
 
   glDrawArrays(type, first, count);
+  g_render_stats.add_draw_call(count);
 
   assert_gl();
 }
 
+void
+GL33CoreContext::draw_quads(const GLQuad* quads, size_t count)
+{
+#if defined(USE_OPENGLES2) && !defined(USE_OPENGLES3)
+  assert(false && "GLES2 doesn't support instancing");
+#else
+  assert_gl();
+
+  const GLint quads_loc = m_program->get_uniform_location("quads");
+
+  m_vertex_arrays->set_quads(quads, count);
+  glUniform1i(quads_loc, 1);
+  glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, static_cast<GLsizei>(count));
+  g_render_stats.add_draw_call(4 * static_cast<int>(count));
+  glUniform1i(quads_loc, 0);
+  m_vertex_arrays->clear_quads();
+
+  assert_gl();
+#endif
+}
+
+bool
+GL33CoreContext::supports_quads() const
+{
+#if defined(USE_OPENGLES2) && !defined(USE_OPENGLES3)
+  return false;
+#else
+  return true;
+#endif
+}
+
 /* EOF */
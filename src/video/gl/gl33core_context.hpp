@@ -21,6 +21,8 @@
 
 #include <memory>
 
+#include "video/gl/gl_state_cache.hpp"
+
 class GLProgram;
 class GLTexture;
 class GLVertexArrays;
@@ -52,12 +54,18 @@ public:
   virtual void bind_no_texture() override;
   virtual void draw_arrays(GLenum type, GLint first, GLsizei count) override;
 
+  virtual void draw_quads(const GLQuad* quads, size_t count) override;
+  virtual bool supports_quads() const override;
+
   virtual bool supports_framebuffer() const override { return true; }
 
   GLProgram& get_program() const { return *m_program; }
   GLVertexArrays& get_vertex_arrays() const { return *m_vertex_arrays; }
   GLTexture& get_white_texture() const { return *m_white_texture; }
 
+private:
+  void bind_texture_unit(int unit, GLuint handle);
+
 private:
   GLVideoSystem& m_video_system;
   std::unique_ptr<GLProgram> m_program;
@@ -66,6 +74,7 @@ private:
   std::unique_ptr<GLTexture> m_black_texture;
   std::unique_ptr<GLTexture> m_grey_texture;
   std::unique_ptr<GLTexture> m_transparent_texture;
+  GLStateCache m_state;
 
 private:
   GL33CoreContext(const GL33CoreContext&) = delete;
@@ -26,6 +26,21 @@ class Color;
 class GLTexture;
 class Texture;
 
+/** One textured quad for GLContext::draw_quads() */
+struct GLQuad
+{
+  /** left, top, right, bottom in screen coordinates */
+  float dstrect[4];
+
+  /** left, top, right, bottom in texture coordinates */
+  float srcrect[4];
+
+  /** rotation around the center, in radians */
+  float angle;
+
+  float color[4];
+};
+
 class GLContext
 {
 public:
@@ -53,6 +68,11 @@ public:
 
   virtual void draw_arrays(GLenum type, GLint first, GLsizei count) = 0;
 
+  /** Draws count quads with the bound texture, the corners are
+      computed on the GPU. Only available if supports_quads(). */
+  virtual void draw_quads(const GLQuad* quads, size_t count) = 0;
+  virtual bool supports_quads() const = 0;
+
   virtual bool supports_framebuffer() const = 0;
 
 private:
@@ -17,6 +17,7 @@
 #include "video/gl/gl_painter.hpp"
 
 #include <algorithm>
+#include <iterator>
 #include <math.h>
 
 #include "math/util.hpp"
@@ -27,9 +28,11 @@
 #include "video/gl/gl_program.hpp"
 #include "video/gl/gl_renderer.hpp"
 #include "video/gl/gl_texture.hpp"
+#include "video/gl/gl_timer_queries.hpp"
 #include "video/gl/gl_vertex_arrays.hpp"
 #include "video/gl/gl_video_system.hpp"
 #include "video/glutil.hpp"
+#include "video/painter_dispatch.hpp"
 #include "video/video_system.hpp"
 #include "video/viewport.hpp"
 
@@ -61,8 +64,26 @@ inline GLenum dfactor(Blend blend)
 
 GLPainter::GLPainter(GLVideoSystem& video_system, GLRenderer& renderer) :
   m_video_system(video_system),
-  m_renderer(renderer)
+  m_renderer(renderer),
+  m_vertices(),
+  m_uvs(),
+  m_colors(),
+  m_quads(),
+  m_line_vertices()
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  , m_pixel_request()
+#endif
+{
+}
+
+GLPainter::~GLPainter()
+{
+}
+
+void
+GLPainter::draw_requests(const std::vector<DrawingRequest*>& requests)
 {
+  dispatch_requests(*this, requests);
 }
 
 void
@@ -75,8 +96,18 @@ GLPainter::draw_texture(const TextureRequest& request)
   assert(request.srcrects.size() == request.dstrects.size());
   assert(request.srcrects.size() == request.angles.size());
 
-  std::vector<float> vertices;
-  std::vector<float> uvs;
+  GLContext& context = m_video_system.get_context();
+  if (context.supports_quads())
+  {
+    draw_texture_quads(request);
+    return;
+  }
+
+  // reuse the scratch buffers, so drawing doesn't allocate once they are large enough
+  std::vector<float>& vertices = m_vertices;
+  std::vector<float>& uvs = m_uvs;
+  vertices.clear();
+  uvs.clear();
   for (size_t i = 0; i < request.srcrects.size(); ++i)
   {
     const float left = request.dstrects[i].get_left();
@@ -158,22 +189,79 @@ GLPainter::draw_texture(const TextureRequest& request)
     }
   }
 
-  GLContext& context = m_video_system.get_context();
-
   context.blend_func(sfactor(request.blend), dfactor(request.blend));
   context.bind_texture(texture, request.displacement_texture);
   context.set_texcoords(uvs.data(), sizeof(float) * uvs.size());
   context.set_positions(vertices.data(), sizeof(float) * vertices.size());
-  context.set_color(Color(request.color.red,
-                          request.color.green,
-                          request.color.blue,
-                          request.color.alpha * request.alpha));
+  if (request.colors.empty())
+  {
+    context.set_color(request.get_color(0));
+  }
+  else
+  {
+    m_colors.clear();
+    for (const auto& color : request.colors) {
+      // six vertices per quad
+      for (int v = 0; v < 6; ++v) {
+        m_colors.insert(m_colors.end(), { color.red, color.green, color.blue, color.alpha });
+      }
+    }
+    context.set_colors(m_colors.data(), sizeof(float) * m_colors.size());
+  }
 
   context.draw_arrays(GL_TRIANGLES, 0, static_cast<GLsizei>(request.srcrects.size() * 2 * 3));
 
   assert_gl();
 }
 
+void
+GLPainter::draw_texture_quads(const TextureRequest& request)
+{
+  assert_gl();
+
+  const auto& texture = static_cast<const GLTexture&>(*request.texture);
+  const float texture_width = static_cast<float>(texture.get_texture_width());
+  const float texture_height = static_cast<float>(texture.get_texture_height());
+
+  m_quads.resize(request.srcrects.size());
+  for (size_t i = 0; i < request.srcrects.size(); ++i)
+  {
+    GLQuad& quad = m_quads[i];
+
+    quad.dstrect[0] = request.dstrects[i].get_left();
+    quad.dstrect[1] = request.dstrects[i].get_top();
+    quad.dstrect[2] = request.dstrects[i].get_right();
+    quad.dstrect[3] = request.dstrects[i].get_bottom();
+
+    quad.srcrect[0] = request.srcrects[i].get_left() / texture_width;
+    quad.srcrect[1] = request.srcrects[i].get_top() / texture_height;
+    quad.srcrect[2] = request.srcrects[i].get_right() / texture_width;
+    quad.srcrect[3] = request.srcrects[i].get_bottom() / texture_height;
+
+    if (request.flip & HORIZONTAL_FLIP)
+      std::swap(quad.srcrect[0], quad.srcrect[2]);
+
+    if (request.flip & VERTICAL_FLIP)
+      std::swap(quad.srcrect[1], quad.srcrect[3]);
+
+    quad.angle = math::radians(request.angles[i]);
+
+    const Color color = request.get_color(i);
+    quad.color[0] = color.red;
+    quad.color[1] = color.green;
+    quad.color[2] = color.blue;
+    quad.color[3] = color.alpha;
+  }
+
+  GLContext& context = m_video_system.get_context();
+
+  context.blend_func(sfactor(request.blend), dfactor(request.blend));
+  context.bind_texture(texture, request.displacement_texture);
+  context.draw_quads(m_quads.data(), m_quads.size());
+
+  assert_gl();
+}
+
 void
 GLPainter::draw_gradient(const GradientRequest& request)
 {
@@ -253,7 +341,7 @@ GLPainter::draw_filled_rect(const FillRectRequest& request)
 
     const int n = 8;
     size_t p = 0;
-    std::vector<float> vertices((n+1) * 4 * 2);
+    float vertices[(n+1) * 4 * 2];
 
     for (int i = 0; i <= n; ++i)
     {
@@ -279,9 +367,9 @@ GLPainter::draw_filled_rect(const FillRectRequest& request)
       vertices[p++] = irect.get_bottom() + y;
     }
 
-    context.set_positions(vertices.data(), sizeof(float) * vertices.size());
+    context.set_positions(vertices, sizeof(vertices));
 
-    context.draw_arrays(GL_TRIANGLE_STRIP, 0,  static_cast<GLsizei>(vertices.size() / 2));
+    context.draw_arrays(GL_TRIANGLE_STRIP, 0,  static_cast<GLsizei>(p / 2));
   }
   else
   {
@@ -432,6 +520,56 @@ GLPainter::draw_line(const LineRequest& request)
   assert_gl();
 }
 
+void
+GLPainter::draw_lines(const LinesRequest& request)
+{
+  assert_gl();
+
+  // same quads as draw_line(), but as plain triangles, so that all
+  // lines go out with one draw call
+  m_line_vertices.clear();
+  for (size_t i = 0; i + 1 < request.count; i += 2)
+  {
+    const Vector& p1 = request.points[i];
+    const Vector& p2 = request.points[i + 1];
+
+    float x_step = (p2.y - p1.y);
+    float y_step = -(p2.x - p1.x);
+    const float step_norm = sqrtf(x_step * x_step + y_step * y_step);
+    if (step_norm == 0.0f)
+      continue;
+
+    x_step = x_step / step_norm * 0.5f;
+    y_step = y_step / step_norm * 0.5f;
+
+    const float quad[] = {
+      (p1.x - x_step), (p1.y - y_step),
+      (p2.x - x_step), (p2.y - y_step),
+      (p1.x + x_step), (p1.y + y_step),
+
+      (p2.x - x_step), (p2.y - y_step),
+      (p1.x + x_step), (p1.y + y_step),
+      (p2.x + x_step), (p2.y + y_step),
+    };
+    m_line_vertices.insert(m_line_vertices.end(), std::begin(quad), std::end(quad));
+  }
+
+  if (m_line_vertices.empty())
+    return;
+
+  GLContext& context = m_video_system.get_context();
+
+  context.blend_func(sfactor(request.blend), dfactor(request.blend));
+  context.bind_no_texture();
+  context.set_positions(m_line_vertices.data(), sizeof(float) * m_line_vertices.size());
+  context.set_texcoord(0.0f, 0.0f);
+  context.set_color(request.color);
+
+  context.draw_arrays(GL_TRIANGLES, 0, static_cast<GLsizei>(m_line_vertices.size() / 2));
+
+  assert_gl();
+}
+
 void
 GLPainter::draw_triangle(const TriangleRequest& request)
 {
@@ -481,29 +619,58 @@ GLPainter::get_pixel(const GetPixelRequest& request) const
   x += static_cast<float>(rect.left);
   y += static_cast<float>(rect.top);
 
-#if 0
-  // #ifndef USE_OPENGLES2
-  //
-  // FIXME: glFenceSync() causes crashes on Intel I965, so disable
-  // GLPixelRequest for now, it's not yet properly used anyway.
-  GLPixelRequest pixel_request(1, 1);
-  pixel_request.request(static_cast<int>(x), static_cast<int>(y));
-
-  *(request.color_ptr) = pixel_request.get_color();
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (!m_pixel_request && gl_supports_pixel_buffers()) {
+    m_pixel_request.reset(new GLPixelRequest);
+  }
 
-#else
-  float pixels[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
+  if (m_pixel_request &&
+      m_pixel_request->request(static_cast<int>(x), static_cast<int>(y), request.color_ptr))
+  {
+    return;
+  }
+#endif
 
   // OpenGLES2 does not have PBOs, only GLES3 has
+  float pixels[4] = { 0.0f, 0.0f, 0.0f, 0.0f };
   glReadPixels(static_cast<GLint>(x), static_cast<GLint>(y),
                1, 1, GL_RGB, GL_FLOAT, pixels);
 
   *(request.color_ptr) = Color(pixels[0], pixels[1], pixels[2]);
-#endif
 
   assert_gl();
 }
 
+void
+GLPainter::begin_stats_section(size_t section)
+{
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  if (GLTimerQueries* timer_queries = m_video_system.get_timer_queries()) {
+    timer_queries->begin(section);
+  }
+#endif
+}
+
+void
+GLPainter::end_stats_section()
+{
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  if (GLTimerQueries* timer_queries = m_video_system.get_timer_queries()) {
+    timer_queries->end();
+  }
+#endif
+}
+
+void
+GLPainter::flush_pixel_requests()
+{
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (m_pixel_request) {
+    m_pixel_request->flush();
+  }
+#endif
+}
+
 void
 GLPainter::set_clip_rect(const Rect& clip_rect)
 {
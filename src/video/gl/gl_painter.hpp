@@ -19,9 +19,14 @@
 
 #include "video/painter.hpp"
 
+#include <memory>
+#include <vector>
+
 #include "video/flip.hpp"
+#include "video/gl/gl_context.hpp"
 
 enum class Blend;
+class GLPixelRequest;
 class GLRenderer;
 class GLVideoSystem;
 
@@ -29,12 +34,15 @@ class GLPainter final : public Painter
 {
 public:
   GLPainter(GLVideoSystem& video_system, GLRenderer& renderer);
+  ~GLPainter();
 
+  virtual void draw_requests(const std::vector<DrawingRequest*>& requests) override;
   virtual void draw_texture(const TextureRequest& request) override;
   virtual void draw_gradient(const GradientRequest& request) override;
   virtual void draw_filled_rect(const FillRectRequest& request) override;
   virtual void draw_inverse_ellipse(const InverseEllipseRequest& request) override;
   virtual void draw_line(const LineRequest& request) override;
+  virtual void draw_lines(const LinesRequest& request) override;
   virtual void draw_triangle(const TriangleRequest& request) override;
 
   virtual void clear(const Color& color) override;
@@ -43,10 +51,35 @@ public:
   virtual void set_clip_rect(const Rect& rect) override;
   virtual void clear_clip_rect() override;
 
+  virtual void begin_stats_section(size_t section) override;
+  virtual void end_stats_section() override;
+
+  /** Delivers the colors of the get_pixel() requests of the last
+      frame, called when the renderer starts drawing */
+  void flush_pixel_requests();
+
+private:
+  /** Instanced variant of draw_texture(), see GLContext::draw_quads() */
+  void draw_texture_quads(const TextureRequest& request);
+
 private:
   GLVideoSystem& m_video_system;
   GLRenderer& m_renderer;
 
+  /** Scratch space for draw_texture() */
+  std::vector<float> m_vertices;
+  std::vector<float> m_uvs;
+  std::vector<float> m_colors;
+  std::vector<GLQuad> m_quads;
+
+  /** Scratch space for draw_lines() */
+  std::vector<float> m_line_vertices;
+
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  /** Created on the first get_pixel(), if PBOs are supported */
+  mutable std::unique_ptr<GLPixelRequest> m_pixel_request;
+#endif
+
 private:
   GLPainter(const GLPainter&) = delete;
   GLPainter& operator=(const GLPainter&) = delete;
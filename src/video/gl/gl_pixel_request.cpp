@@ -16,27 +16,26 @@
 
 #include "video/gl/gl_pixel_request.hpp"
 
-#include <iostream>
+#include <string.h>
 
-#include "util/log.hpp"
 #include "video/glutil.hpp"
 
-#ifndef USE_OPENGLES2
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
 
-GLPixelRequest::GLPixelRequest(int width, int height) :
+GLPixelRequest::GLPixelRequest() :
   m_buffer(),
-  m_width(width),
-  m_height(height),
-  m_offset(0),
-  m_sync()
+  m_targets(),
+  m_data()
 {
   assert_gl();
 
   glGenBuffers(1, &m_buffer);
   glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
-  glBufferData(GL_PIXEL_PACK_BUFFER, m_width * m_height * 4, nullptr, GL_DYNAMIC_READ);
+  glBufferData(GL_PIXEL_PACK_BUFFER, MAX_PIXELS * 4, nullptr, GL_STREAM_READ);
   glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
+  m_targets.reserve(MAX_PIXELS);
+
   assert_gl();
 }
 
@@ -45,70 +44,57 @@ GLPixelRequest::~GLPixelRequest()
   glDeleteBuffers(1, &m_buffer);
 }
 
-void
-GLPixelRequest::request(int x, int y)
+bool
+GLPixelRequest::request(int x, int y, const std::shared_ptr<Color>& color_out)
 {
+  if (m_targets.size() >= static_cast<size_t>(MAX_PIXELS))
+    return false;
+
   assert_gl();
 
+  // RGBA keeps every pixel 4 byte aligned, as GL_PACK_ALIGNMENT wants
   glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
-  glReadPixels(x, y, m_width, m_height, GL_RGB, GL_UNSIGNED_BYTE,
-               reinterpret_cast<GLvoid*>(m_offset));
-  m_sync = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, GL_NONE_BIT);
+  glReadPixels(x, y, 1, 1, GL_RGBA, GL_UNSIGNED_BYTE,
+               reinterpret_cast<GLvoid*>(m_targets.size() * 4));
   glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-  assert_gl();
-}
-
-bool
-GLPixelRequest::is_ready() const
-{
-  assert_gl();
-
-  GLenum ret = glClientWaitSync(m_sync, GL_NONE_BIT, 0);
-
-  if (ret == GL_CONDITION_SATISFIED ||
-      ret == GL_ALREADY_SIGNALED)
-  {
-    //std::cout << "fence ready: " << static_cast<int>(ret) << " " << GL_ALREADY_SIGNALED << std::endl;
-    return true;
-  }
-  else if (ret == GL_TIMEOUT_EXPIRED)
-
-  {
-    //std::cout << "timeout: " << static_cast<int>(ret) << std::endl;
-    return false;
-  }
-  else if (ret == GL_WAIT_FAILED)
-  {
-    return true;
-  }
-  else
-  {
-    log_warning << "unknown glClientWaitSync() return value: " << static_cast<int>(ret) << std::endl;
-    return true;
-  }
+  m_targets.push_back(color_out);
 
   assert_gl();
+  return true;
 }
 
 void
-GLPixelRequest::get(void* buffer, size_t length) const
+GLPixelRequest::flush()
 {
+  if (m_targets.empty())
+    return;
+
   assert_gl();
 
+  m_data.resize(m_targets.size() * 4);
   glBindBuffer(GL_PIXEL_PACK_BUFFER, m_buffer);
-  glGetBufferSubData(GL_PIXEL_PACK_BUFFER, m_offset, length, buffer);
+#ifdef USE_OPENGLES3
+  // GLES3 has no glGetBufferSubData()
+  const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, m_data.size(), GL_MAP_READ_BIT);
+  if (mapped) {
+    memcpy(m_data.data(), mapped, m_data.size());
+  }
+  glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+#else
+  glGetBufferSubData(GL_PIXEL_PACK_BUFFER, 0, m_data.size(), m_data.data());
+#endif
   glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
 
-  assert_gl();
-}
+  for (size_t i = 0; i < m_targets.size(); ++i)
+  {
+    *m_targets[i] = Color::from_rgb888(m_data[i * 4 + 0],
+                                       m_data[i * 4 + 1],
+                                       m_data[i * 4 + 2]);
+  }
+  m_targets.clear();
 
-Color
-GLPixelRequest::get_color() const
-{
-  uint8_t data[3];
-  get(data, sizeof(data));
-  return Color::from_rgb888(data[0], data[1], data[2]);
+  assert_gl();
 }
 
 #endif
@@ -17,32 +17,42 @@
 #ifndef HEADER_SUPERTUX_VIDEO_GL_GL_PIXEL_REQUEST_HPP
 #define HEADER_SUPERTUX_VIDEO_GL_GL_PIXEL_REQUEST_HPP
 
-#include <stddef.h>
+#include <memory>
+#include <stdint.h>
+#include <vector>
 
 #include "video/color.hpp"
 #include "video/gl.hpp"
 
-#ifndef USE_OPENGLES2
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
 
+/** Reads back single pixels through a pixel buffer object. All reads
+    of a frame go into the same buffer, so glReadPixels() returns
+    right away, and the colors are only fetched when flush() is called
+    at the start of the next frame, when the GPU is long done with
+    them. */
 class GLPixelRequest final
 {
 public:
-  GLPixelRequest(int width, int height);
+  /** Pixels that can be queued per frame */
+  static const int MAX_PIXELS = 256;
+
+public:
+  GLPixelRequest();
   ~GLPixelRequest();
 
-  void request(int x, int y);
-  bool is_ready() const;
-  Color get_color() const;
+  /** Queues a read of the pixel at x, y of the current framebuffer,
+      color_out gets set on the next flush(). Returns false when the
+      buffer is full. */
+  bool request(int x, int y, const std::shared_ptr<Color>& color_out);
 
-private:
-  void get(void* buffer, size_t length) const;
+  /** Delivers the colors of all queued reads */
+  void flush();
 
 private:
   GLuint m_buffer;
-  int m_width;
-  int m_height;
-  GLintptr m_offset;
-  GLsync m_sync;
+  std::vector<std::shared_ptr<Color> > m_targets;
+  std::vector<uint8_t> m_data;
 
 private:
   GLPixelRequest(const GLPixelRequest&) = delete;
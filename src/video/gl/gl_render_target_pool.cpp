@@ -0,0 +1,87 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/gl/gl_render_target_pool.hpp"
+
+#include <algorithm>
+
+#include "video/gl/gl_context.hpp"
+#include "video/gl/gl_framebuffer.hpp"
+#include "video/gl/gl_texture.hpp"
+#include "video/gl/gl_video_system.hpp"
+
+GLRenderTarget::GLRenderTarget() :
+  texture(),
+  framebuffer()
+{
+}
+
+GLRenderTarget::GLRenderTarget(GLRenderTarget&&) = default;
+GLRenderTarget& GLRenderTarget::operator=(GLRenderTarget&&) = default;
+
+GLRenderTarget::~GLRenderTarget()
+{
+}
+
+GLRenderTargetPool::GLRenderTargetPool(GLVideoSystem& video_system) :
+  m_video_system(video_system),
+  m_free()
+{
+}
+
+GLRenderTargetPool::~GLRenderTargetPool()
+{
+}
+
+GLRenderTarget
+GLRenderTargetPool::acquire(const Size& size)
+{
+  auto it = std::find_if(m_free.begin(), m_free.end(),
+                         [&size](const GLRenderTarget& target) {
+                           return (target.texture->get_image_width() == size.width &&
+                                   target.texture->get_image_height() == size.height);
+                         });
+  if (it != m_free.end())
+  {
+    GLRenderTarget target = std::move(*it);
+    m_free.erase(it);
+    return target;
+  }
+
+  GLRenderTarget target;
+  target.texture.reset(new GLTexture(size.width, size.height));
+  if (m_video_system.get_context().supports_framebuffer())
+  {
+    target.framebuffer = std::make_unique<GLFramebuffer>(static_cast<GLTexture&>(*target.texture));
+  }
+  return target;
+}
+
+void
+GLRenderTargetPool::release(GLRenderTarget target)
+{
+  if (target) {
+    m_free.push_back(std::move(target));
+  }
+}
+
+void
+GLRenderTargetPool::trim()
+{
+  m_free.clear();
+}
+
+/* EOF */
@@ -0,0 +1,76 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_GL_GL_RENDER_TARGET_POOL_HPP
+#define HEADER_SUPERTUX_VIDEO_GL_GL_RENDER_TARGET_POOL_HPP
+
+#include <memory>
+#include <vector>
+
+#include "math/size.hpp"
+#include "video/texture_ptr.hpp"
+
+class GLFramebuffer;
+class GLVideoSystem;
+
+/** A texture to render into, framebuffer is nullptr when the context
+    doesn't support framebuffers and the texture gets filled by
+    copying from the back buffer instead */
+struct GLRenderTarget
+{
+  GLRenderTarget();
+  GLRenderTarget(GLRenderTarget&&);
+  GLRenderTarget& operator=(GLRenderTarget&&);
+  ~GLRenderTarget();
+
+  explicit operator bool() const { return static_cast<bool>(texture); }
+
+  TexturePtr texture;
+  std::unique_ptr<GLFramebuffer> framebuffer;
+};
+
+/** Keeps render targets that were given back around until the end of
+    the frame, so renderers recreated by apply_config() reuse the
+    textures of the old ones instead of each allocating afresh. All
+    targets share the same RGBA format, so they are keyed by size. */
+class GLRenderTargetPool final
+{
+public:
+  GLRenderTargetPool(GLVideoSystem& video_system);
+  ~GLRenderTargetPool();
+
+  /** Hands out a free target of exactly the given size or creates one */
+  GLRenderTarget acquire(const Size& size);
+
+  /** Returns a target to the pool */
+  void release(GLRenderTarget target);
+
+  /** Frees all targets that weren't acquired again, called once per
+      frame */
+  void trim();
+
+private:
+  GLVideoSystem& m_video_system;
+  std::vector<GLRenderTarget> m_free;
+
+private:
+  GLRenderTargetPool(const GLRenderTargetPool&) = delete;
+  GLRenderTargetPool& operator=(const GLRenderTargetPool&) = delete;
+};
+
+#endif
+
+/* EOF */
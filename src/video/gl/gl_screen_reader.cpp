@@ -0,0 +1,141 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/gl/gl_screen_reader.hpp"
+
+#include <string.h>
+
+#include "video/glutil.hpp"
+#include "video/sdl_surface.hpp"
+#include "video/sdl_surface_ptr.hpp"
+
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+
+GLScreenReader::GLScreenReader() :
+  m_requests(),
+  m_reads(),
+  m_free_buffers()
+{
+}
+
+GLScreenReader::~GLScreenReader()
+{
+  // hand the pending reads out, the GPU has to finish them now
+  for (auto& read : m_reads) {
+    deliver(read);
+  }
+
+  for (GLuint buffer : m_free_buffers) {
+    glDeleteBuffers(1, &buffer);
+  }
+}
+
+void
+GLScreenReader::request(VideoSystem::ScreenCallback callback)
+{
+  m_requests.push_back(std::move(callback));
+}
+
+void
+GLScreenReader::read()
+{
+  if (m_requests.empty())
+    return;
+
+  assert_gl();
+
+  GLint viewport[4];
+  glGetIntegerv(GL_VIEWPORT, viewport);
+
+  const int width = viewport[2];
+  const int height = viewport[3];
+
+  // requests rarely come more than one per frame, so each simply
+  // gets its own read
+  for (auto& callback : m_requests)
+  {
+    GLuint buffer;
+    if (m_free_buffers.empty()) {
+      glGenBuffers(1, &buffer);
+    } else {
+      buffer = m_free_buffers.back();
+      m_free_buffers.pop_back();
+    }
+
+    // RGBA keeps the rows 4 byte aligned, as GL_PACK_ALIGNMENT wants
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, buffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, 4 * width * height, nullptr, GL_STREAM_READ);
+    glReadPixels(viewport[0], viewport[1], width, height, GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    m_reads.push_back(Read{ buffer, width, height, LATENCY, std::move(callback) });
+  }
+  m_requests.clear();
+
+  assert_gl();
+}
+
+void
+GLScreenReader::collect()
+{
+  for (auto& read : m_reads) {
+    read.swaps_left -= 1;
+  }
+
+  while (!m_reads.empty() && m_reads.front().swaps_left <= 0)
+  {
+    deliver(m_reads.front());
+    m_reads.erase(m_reads.begin());
+  }
+}
+
+void
+GLScreenReader::deliver(Read& read)
+{
+  assert_gl();
+
+  const size_t size = 4 * read.width * read.height;
+  SDLSurfacePtr surface = SDLSurface::create_rgb(read.width, read.height);
+
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, read.buffer);
+  const void* mapped = glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, size, GL_MAP_READ_BIT);
+  if (mapped)
+  {
+    // GL rows go bottom to top
+    SDL_LockSurface(surface.get());
+    for (int y = 0; y < read.height; ++y)
+    {
+      const uint8_t* src = static_cast<const uint8_t*>(mapped) + 4 * read.width * (read.height - y - 1);
+      uint8_t* dst = static_cast<uint8_t*>(surface->pixels) + y * surface->pitch;
+      for (int x = 0; x < read.width; ++x) {
+        memcpy(dst + 3 * x, src + 4 * x, 3);
+      }
+    }
+    SDL_UnlockSurface(surface.get());
+    glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+  }
+  glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+  m_free_buffers.push_back(read.buffer);
+
+  assert_gl();
+
+  read.callback(mapped ? std::move(surface) : SDLSurfacePtr());
+}
+
+#endif
+
+/* EOF */
@@ -0,0 +1,80 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_GL_GL_SCREEN_READER_HPP
+#define HEADER_SUPERTUX_VIDEO_GL_GL_SCREEN_READER_HPP
+
+#include <functional>
+#include <vector>
+
+#include "video/gl.hpp"
+#include "video/video_system.hpp"
+
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+
+/** Reads back whole frames through pixel buffer objects. The read is
+    issued right before the buffers are swapped and only mapped a few
+    frames later, so neither the GPU nor the game has to wait for the
+    other. */
+class GLScreenReader final
+{
+public:
+  /** Number of swaps between issuing a read and mapping it */
+  static const int LATENCY = 2;
+
+public:
+  GLScreenReader();
+  ~GLScreenReader();
+
+  /** callback gets the next completed frame */
+  void request(VideoSystem::ScreenCallback callback);
+
+  /** Reads the back buffer for all requests, call before the swap */
+  void read();
+
+  /** Delivers the reads that are old enough, call after the swap */
+  void collect();
+
+private:
+  struct Read
+  {
+    GLuint buffer;
+    int width;
+    int height;
+    int swaps_left;
+    VideoSystem::ScreenCallback callback;
+  };
+
+private:
+  void deliver(Read& read);
+
+private:
+  std::vector<VideoSystem::ScreenCallback> m_requests;
+  std::vector<Read> m_reads;
+
+  /** buffers of delivered reads, ready for reuse */
+  std::vector<GLuint> m_free_buffers;
+
+private:
+  GLScreenReader(const GLScreenReader&) = delete;
+  GLScreenReader& operator=(const GLScreenReader&) = delete;
+};
+
+#endif
+
+#endif
+
+/* EOF */
@@ -17,23 +17,43 @@
 
 #include "video/gl/gl_screen_renderer.hpp"
 
+#include <algorithm>
+#include <math.h>
+
 #include "math/rect.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/globals.hpp"
 #include "util/log.hpp"
+#include "video/drawing_request.hpp"
 #include "video/gl/gl_context.hpp"
+#include "video/gl/gl_framebuffer.hpp"
+#include "video/gl/gl_painter.hpp"
 #include "video/gl/gl_program.hpp"
+#include "video/gl/gl_state_cache.hpp"
+#include "video/gl/gl_texture.hpp"
 #include "video/gl/gl_vertex_arrays.hpp"
 #include "video/gl/gl_video_system.hpp"
 #include "video/glutil.hpp"
 
 GLScreenRenderer::GLScreenRenderer(GLVideoSystem& video_system) :
-  GLRenderer(video_system)
+  GLRenderer(video_system),
+  m_scene(),
+  m_in_scene(false)
 {
 }
 
 GLScreenRenderer::~GLScreenRenderer()
 {
+  // the pool is already gone when the video system destroys this
+}
+
+Size
+GLScreenRenderer::get_scene_size() const
+{
+  const Rect& rect = m_video_system.get_viewport().get_rect();
+  const float scale = m_video_system.get_render_scale();
+  return Size(std::max(1, static_cast<int>(roundf(static_cast<float>(rect.get_width()) * scale))),
+              std::max(1, static_cast<int>(roundf(static_cast<float>(rect.get_height()) * scale))));
 }
 
 void
@@ -41,35 +61,141 @@ GLScreenRenderer::start_draw()
 {
   assert_gl();
 
+  const Viewport& viewport = m_video_system.get_viewport();
+  const Rect& rect = viewport.get_rect();
+
+  if (m_video_system.get_render_scale() < 1.0f)
+  {
+    const Size size = get_scene_size();
+    if (!m_scene ||
+        m_scene.texture->get_image_width() != size.width ||
+        m_scene.texture->get_image_height() != size.height)
+    {
+      GLRenderTargetPool& pool = m_video_system.get_render_target_pool();
+      pool.release(std::move(m_scene));
+      m_scene = pool.acquire(size);
+    }
+    // before binding the context, which takes the rect for fragcoord2uv
+    m_in_scene = true;
+  }
+  else if (m_scene)
+  {
+    m_video_system.get_render_target_pool().release(std::move(m_scene));
+  }
+
   GLContext& context = m_video_system.get_context();
   context.bind();
 
+  m_painter.flush_pixel_requests();
+
   context.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+  if (m_in_scene)
+  {
+    if (m_scene.framebuffer)
+    {
+      glBindFramebuffer(GL_FRAMEBUFFER, m_scene.framebuffer->get_handle());
+    }
+    glViewport(0, 0, m_scene.texture->get_image_width(), m_scene.texture->get_image_height());
+  }
+  else
+  {
+    glViewport(rect.left, rect.top, rect.get_width(), rect.get_height());
+  }
+
+  context.ortho(static_cast<float>(viewport.get_screen_width()),
+                static_cast<float>(viewport.get_screen_height()),
+                true);
+
+  // clear the screen to get rid of lightmap remains
+  glClearColor(0, 0, 0, 1);
+  glClear(GL_COLOR_BUFFER_BIT);
+
+  assert_gl();
+}
+
+void
+GLScreenRenderer::end_scene()
+{
+  if (!m_in_scene)
+    return;
+
+  assert_gl();
+
+  GLTexture& texture = static_cast<GLTexture&>(*m_scene.texture);
+
+  if (m_scene.framebuffer)
+  {
+    glBindFramebuffer(GL_FRAMEBUFFER, 0);
+  }
+  else
+  {
+    glBindTexture(GL_TEXTURE_2D, texture.get_handle());
+    GLStateCache::texture_binding_changed();
+    glCopyTexSubImage2D(GL_TEXTURE_2D,
+                        0, // level
+                        0, 0, // offset
+                        0, 0, // x, y
+                        texture.get_image_width(),
+                        texture.get_image_height());
+  }
+
+  m_in_scene = false;
+
   const Viewport& viewport = m_video_system.get_viewport();
   const Rect& rect = viewport.get_rect();
 
-  glViewport(rect.left, rect.top, rect.get_width(), rect.get_height());
+  GLContext& context = m_video_system.get_context();
+  context.bind();
+  context.blend_func(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
 
+  glViewport(rect.left, rect.top, rect.get_width(), rect.get_height());
   context.ortho(static_cast<float>(viewport.get_screen_width()),
                 static_cast<float>(viewport.get_screen_height()),
                 true);
 
-  // clear the screen to get rid of lightmap remains
   glClearColor(0, 0, 0, 1);
   glClear(GL_COLOR_BUFFER_BIT);
 
+  // the texture was drawn with the same flipped projection as the screen
+  TextureRequest request;
+
+  request.type = TEXTURE;
+  request.flip = VERTICAL_FLIP;
+  request.alpha = 1.0f;
+  request.blend = Blend::NONE;
+
+  request.srcrects.emplace_back(0, 0,
+                                static_cast<float>(texture.get_image_width()),
+                                static_cast<float>(texture.get_image_height()));
+  request.dstrects.emplace_back(Vector(0, 0), get_logical_size());
+  request.angles.emplace_back(0.0f);
+
+  request.texture = &texture;
+  request.color = Color::WHITE;
+
+  m_painter.draw_texture(request);
+
   assert_gl();
 }
 
 void
 GLScreenRenderer::end_draw()
 {
+  // nothing was drawn above the level
+  end_scene();
 }
 
 Rect
 GLScreenRenderer::get_rect() const
 {
+  if (m_in_scene)
+  {
+    return Rect(0, 0,
+                Size(m_scene.texture->get_image_width(),
+                     m_scene.texture->get_image_height()));
+  }
+
   const Viewport& viewport = m_video_system.get_viewport();
   return viewport.get_rect();
 }
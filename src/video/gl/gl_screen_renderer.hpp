@@ -21,6 +21,7 @@
 #include <SDL.h>
 
 #include "math/vector.hpp"
+#include "video/gl/gl_render_target_pool.hpp"
 #include "video/gl/gl_renderer.hpp"
 
 class GLVideoSystem;
@@ -34,12 +35,22 @@ public:
 
   virtual void start_draw() override;
   virtual void end_draw() override;
+  virtual void end_scene() override;
 
   virtual Rect get_rect() const override;
   virtual Size get_logical_size() const override;
 
   virtual TexturePtr get_texture() const override { return {}; }
 
+private:
+  /** Size of the level image at the current render scale */
+  Size get_scene_size() const;
+
+private:
+  /** the level gets drawn in here when the render scale is below 1 */
+  GLRenderTarget m_scene;
+  bool m_in_scene;
+
 private:
   GLScreenRenderer(const GLScreenRenderer&) = delete;
   GLScreenRenderer& operator=(const GLScreenRenderer&) = delete;
@@ -0,0 +1,166 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "video/gl/gl_state_cache.hpp"
+
+#include <assert.h>
+
+#include "video/render_stats.hpp"
+
+uint32_t GLStateCache::s_texture_serial = 0;
+
+const int GLStateCache::NUM_TEXTURE_UNITS;
+
+GLStateCache::GLStateCache() :
+  m_blend_valid(),
+  m_blend_src(),
+  m_blend_dst(),
+  m_active_texture(),
+  m_texture_serial(),
+  m_texture_valid(),
+  m_texture(),
+  m_texturing_valid(),
+  m_texturing(),
+  m_value_valid(),
+  m_value(),
+  m_color_valid(),
+  m_color()
+{
+  invalidate();
+}
+
+void
+GLStateCache::invalidate()
+{
+  m_blend_valid = false;
+  m_active_texture = -1;
+  m_texture_serial = s_texture_serial;
+  for (int i = 0; i < NUM_TEXTURE_UNITS; ++i) {
+    m_texture_valid[i] = false;
+  }
+  m_texturing_valid = false;
+  for (int i = 0; i < NUM_VALUES; ++i) {
+    m_value_valid[i] = false;
+  }
+  m_color_valid = false;
+}
+
+void
+GLStateCache::check_texture_serial()
+{
+  // the active unit stays, only its binding is unknown now
+  if (m_texture_serial != s_texture_serial) {
+    m_texture_serial = s_texture_serial;
+    for (int i = 0; i < NUM_TEXTURE_UNITS; ++i) {
+      m_texture_valid[i] = false;
+    }
+  }
+}
+
+bool
+GLStateCache::elide()
+{
+  g_render_stats.add_elided_call();
+  return false;
+}
+
+bool
+GLStateCache::set_blend_func(GLenum src, GLenum dst)
+{
+  if (m_blend_valid && m_blend_src == src && m_blend_dst == dst)
+    return elide();
+
+  m_blend_valid = true;
+  m_blend_src = src;
+  m_blend_dst = dst;
+  return true;
+}
+
+bool
+GLStateCache::set_texture(int unit, GLuint handle)
+{
+  assert(unit >= 0 && unit < NUM_TEXTURE_UNITS);
+
+  check_texture_serial();
+
+  if (m_texture_valid[unit] && m_texture[unit] == handle)
+    return elide();
+
+  m_texture_valid[unit] = true;
+  m_texture[unit] = handle;
+  return true;
+}
+
+bool
+GLStateCache::set_active_texture(int unit)
+{
+  assert(unit >= 0 && unit < NUM_TEXTURE_UNITS);
+
+  if (m_active_texture == unit)
+    return elide();
+
+  m_active_texture = unit;
+  return true;
+}
+
+bool
+GLStateCache::set_texturing(bool enabled)
+{
+  if (m_texturing_valid && m_texturing == enabled)
+    return elide();
+
+  m_texturing_valid = true;
+  m_texturing = enabled;
+  return true;
+}
+
+bool
+GLStateCache::set_value(Value value, float x, float y)
+{
+  if (m_value_valid[value] && m_value[value][0] == x && m_value[value][1] == y)
+    return elide();
+
+  m_value_valid[value] = true;
+  m_value[value][0] = x;
+  m_value[value][1] = y;
+  return true;
+}
+
+void
+GLStateCache::invalidate_value(Value value)
+{
+  m_value_valid[value] = false;
+}
+
+bool
+GLStateCache::set_color(const Color& color)
+{
+  if (m_color_valid && m_color == color)
+    return elide();
+
+  m_color_valid = true;
+  m_color = color;
+  return true;
+}
+
+void
+GLStateCache::invalidate_color()
+{
+  m_color_valid = false;
+}
+
+/* EOF */
@@ -0,0 +1,108 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_VIDEO_GL_GL_STATE_CACHE_HPP
+#define HEADER_SUPERTUX_VIDEO_GL_GL_STATE_CACHE_HPP
+
+#include <stdint.h>
+
+#include "video/color.hpp"
+#include "video/gl.hpp"
+
+/** Shadow copy of the GL state that the GLContexts set before every
+    draw call. Each set_*() returns false if the state is already in
+    place, so the caller can skip the GL call, and records the new
+    state otherwise. Skipped calls are counted in g_render_stats.
+    Textures also get bound behind the contexts' back while they are
+    created, updated or deleted, so those places call
+    texture_binding_changed(), which drops the texture part of every
+    cache. */
+class GLStateCache final
+{
+public:
+  static const int NUM_TEXTURE_UNITS = 3;
+
+  /** Uniforms and other float pairs a context wants to shadow */
+  enum Value {
+    ANIMATE,
+    DISPLACEMENT_ANIMATE,
+    TEXTURE_MATRIX,
+    TEXCOORD,
+    NUM_VALUES
+  };
+
+public:
+  static void texture_binding_changed() { s_texture_serial += 1; }
+
+public:
+  GLStateCache();
+
+  /** Forgets everything, e.g. when the context gets bound again */
+  void invalidate();
+
+  bool set_blend_func(GLenum src, GLenum dst);
+
+  /** Texture bound to the given unit, if this returns true the caller
+      has to make the unit active with set_active_texture() first */
+  bool set_texture(int unit, GLuint handle);
+  bool set_active_texture(int unit);
+
+  /** GL_TEXTURE_2D enabled or not, only used by the fixed pipeline */
+  bool set_texturing(bool enabled);
+
+  bool set_value(Value value, float x, float y);
+  void invalidate_value(Value value);
+
+  bool set_color(const Color& color);
+  void invalidate_color();
+
+private:
+  void check_texture_serial();
+  bool elide();
+
+private:
+  static uint32_t s_texture_serial;
+
+private:
+  bool m_blend_valid;
+  GLenum m_blend_src;
+  GLenum m_blend_dst;
+
+  /** -1 if unknown */
+  int m_active_texture;
+
+  uint32_t m_texture_serial;
+  bool m_texture_valid[NUM_TEXTURE_UNITS];
+  GLuint m_texture[NUM_TEXTURE_UNITS];
+
+  bool m_texturing_valid;
+  bool m_texturing;
+
+  bool m_value_valid[NUM_VALUES];
+  float m_value[NUM_VALUES][2];
+
+  bool m_color_valid;
+  Color m_color;
+
+private:
+  GLStateCache(const GLStateCache&) = delete;
+  GLStateCache& operator=(const GLStateCache&) = delete;
+};
+
+#endif
+
+/* EOF */
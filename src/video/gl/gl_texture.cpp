@@ -18,6 +18,9 @@
 
 #include <assert.h>
 
+#include "video/compressed_image.hpp"
+#include "video/gl/gl_state_cache.hpp"
+#include "video/gl/gl_texture_uploader.hpp"
 #include "video/glutil.hpp"
 #include "video/sampler.hpp"
 #include "video/sdl_surface.hpp"
@@ -28,7 +31,10 @@ GLTexture::GLTexture(int width, int height, boost::optional<Color> fill_color) :
   m_texture_width(),
   m_texture_height(),
   m_image_width(),
-  m_image_height()
+  m_image_height(),
+  m_compressed(false),
+  m_uploader(),
+  m_pending_handle()
 {
 #ifdef GL_VERSION_ES_CM_1_0
   assert(is_power_of_2(width));
@@ -45,6 +51,7 @@ GLTexture::GLTexture(int width, int height, boost::optional<Color> fill_color) :
 
   try {
     glBindTexture(GL_TEXTURE_2D, m_handle);
+    GLStateCache::texture_binding_changed();
 
     if (fill_color)
     {
@@ -67,13 +74,16 @@ GLTexture::GLTexture(int width, int height, boost::optional<Color> fill_color) :
   assert_gl();
 }
 
-GLTexture::GLTexture(const SDL_Surface& image, const Sampler& sampler) :
+GLTexture::GLTexture(const SDL_Surface& image, const Sampler& sampler, GLTextureUploader* uploader) :
   m_handle(),
   m_sampler(sampler),
   m_texture_width(),
   m_texture_height(),
   m_image_width(),
-  m_image_height()
+  m_image_height(),
+  m_compressed(false),
+  m_uploader(),
+  m_pending_handle()
 {
   assert_gl();
 
@@ -151,6 +161,7 @@ GLTexture::GLTexture(const SDL_Surface& image, const Sampler& sampler) :
     }
 
     glBindTexture(GL_TEXTURE_2D, m_handle);
+    GLStateCache::texture_binding_changed();
     glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 #if defined(GL_UNPACK_ROW_LENGTH) || defined(USE_GLBINDING)
     glPixelStorei(GL_UNPACK_ROW_LENGTH, convert->pitch/convert->format->BytesPerPixel);
@@ -160,22 +171,76 @@ GLTexture::GLTexture(const SDL_Surface& image, const Sampler& sampler) :
     assert(convert->pitch == static_cast<int>(m_texture_width * convert->format->BytesPerPixel));
 #endif
 
-    if (SDL_MUSTLOCK(convert)) {
-      SDL_LockSurface(convert.get());
+    const size_t bytes = static_cast<size_t>(convert->pitch) * static_cast<size_t>(m_texture_height);
+    if (uploader && sdl_format == GL_RGBA && uploader->should_stream(bytes))
+    {
+      // only allocate the storage, the rows follow over the next frames
+      glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(GL_RGBA),
+                   m_texture_width, m_texture_height, 0, sdl_format,
+                   GL_UNSIGNED_BYTE, nullptr);
     }
+    else
+    {
+      if (SDL_MUSTLOCK(convert)) {
+        SDL_LockSurface(convert.get());
+      }
 
-    glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(GL_RGBA),
-                 m_texture_width, m_texture_height, 0, sdl_format,
-                 GL_UNSIGNED_BYTE, convert->pixels);
+      glTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLint>(GL_RGBA),
+                   m_texture_width, m_texture_height, 0, sdl_format,
+                   GL_UNSIGNED_BYTE, convert->pixels);
 
-    // no not use mipmaps
+      // no not use mipmaps
 #if 0
-    glGenerateMipmap(GL_TEXTURE_2D);
+      glGenerateMipmap(GL_TEXTURE_2D);
 #endif
 
-    if (SDL_MUSTLOCK(convert.get())) {
-      SDL_UnlockSurface(convert.get());
+      if (SDL_MUSTLOCK(convert.get())) {
+        SDL_UnlockSurface(convert.get());
+      }
+
+      uploader = nullptr;
+    }
+
+    assert_gl();
+
+    set_texture_params();
+
+    if (uploader)
+    {
+      uploader->queue(*this, std::move(convert));
+      m_uploader = uploader;
+      m_pending_handle = m_handle;
+      m_handle = uploader->get_placeholder();
     }
+  } catch(...) {
+    glDeleteTextures(1, &m_handle);
+    throw;
+  }
+
+  assert_gl();
+}
+
+GLTexture::GLTexture(const CompressedImage& image, const Sampler& sampler) :
+  m_handle(),
+  m_sampler(sampler),
+  m_texture_width(image.get_width()),
+  m_texture_height(image.get_height()),
+  m_image_width(image.get_width()),
+  m_image_height(image.get_height()),
+  m_compressed(true),
+  m_uploader(),
+  m_pending_handle()
+{
+  assert_gl();
+
+  glGenTextures(1, &m_handle);
+
+  try {
+    glBindTexture(GL_TEXTURE_2D, m_handle);
+    GLStateCache::texture_binding_changed();
+    glCompressedTexImage2D(GL_TEXTURE_2D, 0, static_cast<GLenum>(image.get_internal_format()),
+                           m_texture_width, m_texture_height, 0,
+                           static_cast<GLsizei>(image.get_data().size()), image.get_data().data());
 
     assert_gl();
 
@@ -190,7 +255,67 @@ GLTexture::GLTexture(const SDL_Surface& image, const Sampler& sampler) :
 
 GLTexture::~GLTexture()
 {
-  glDeleteTextures(1, &m_handle);
+  if (m_pending_handle)
+  {
+    m_uploader->cancel(*this);
+    glDeleteTextures(1, &m_pending_handle);
+  }
+  else
+  {
+    glDeleteTextures(1, &m_handle);
+  }
+  GLStateCache::texture_binding_changed();
+}
+
+void
+GLTexture::finish_upload()
+{
+  assert(m_pending_handle);
+
+  m_handle = m_pending_handle;
+  m_pending_handle = 0;
+  GLStateCache::texture_binding_changed();
+}
+
+void
+GLTexture::update(const SDL_Surface& image, const Rect& rect)
+{
+  assert(!m_compressed);
+  if (rect.empty())
+    return;
+
+  if (m_pending_handle) {
+    m_uploader->finish(*this);
+  }
+
+  // copy the rect into a tightly packed RGBA surface, so it works
+  // without GL_UNPACK_ROW_LENGTH and whatever format image is in
+  SDLSurfacePtr convert = SDLSurface::create_rgba(rect.get_width(), rect.get_height());
+  SDL_Rect srcrect = rect.to_sdl();
+  SDL_SetSurfaceBlendMode(const_cast<SDL_Surface*>(&image), SDL_BLENDMODE_NONE);
+  SDL_BlitSurface(const_cast<SDL_Surface*>(&image), &srcrect, convert.get(), nullptr);
+
+  assert_gl();
+
+  glBindTexture(GL_TEXTURE_2D, m_handle);
+  GLStateCache::texture_binding_changed();
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+#if defined(GL_UNPACK_ROW_LENGTH) || defined(USE_GLBINDING)
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, convert->pitch / convert->format->BytesPerPixel);
+#endif
+
+  if (SDL_MUSTLOCK(convert)) {
+    SDL_LockSurface(convert.get());
+  }
+
+  glTexSubImage2D(GL_TEXTURE_2D, 0, rect.left, rect.top, rect.get_width(), rect.get_height(),
+                  GL_RGBA, GL_UNSIGNED_BYTE, convert->pixels);
+
+  if (SDL_MUSTLOCK(convert)) {
+    SDL_UnlockSurface(convert.get());
+  }
+
+  assert_gl();
 }
 
 void
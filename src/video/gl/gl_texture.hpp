@@ -24,6 +24,8 @@
 #include "video/sampler.hpp"
 #include "video/texture.hpp"
 
+class CompressedImage;
+class GLTextureUploader;
 class Sampler;
 
 /** This class is a wrapper around a texture handle. It stores the
@@ -33,15 +35,22 @@ class GLTexture final : public Texture
 {
 public:
   GLTexture(int width, int height, boost::optional<Color> fill_color = boost::none);
-  GLTexture(const SDL_Surface& image, const Sampler& sampler);
+  /** Large images are queued on uploader if given, the texture shows
+      a placeholder until they are uploaded */
+  GLTexture(const SDL_Surface& image, const Sampler& sampler, GLTextureUploader* uploader = nullptr);
+  GLTexture(const CompressedImage& image, const Sampler& sampler);
   ~GLTexture();
 
+  virtual bool is_compressed() const override { return m_compressed; }
+
   virtual int get_texture_width() const override { return m_texture_width; }
   virtual int get_texture_height() const override { return m_texture_height; }
 
   virtual int get_image_width() const override { return m_image_width; }
   virtual int get_image_height() const override { return m_image_height; }
 
+  virtual void update(const SDL_Surface& image, const Rect& rect) override;
+
   void set_handle(GLuint handle) { m_handle = handle; }
   const GLuint &get_handle() const { return m_handle; }
 
@@ -50,6 +59,13 @@ public:
   void set_image_width(int width) { m_image_width = width; }
   void set_image_height(int height) { m_image_height = height; }
 
+  /** The handle the pixels go to, differs from get_handle() while
+      the upload is queued */
+  GLuint get_upload_handle() const { return m_pending_handle ? m_pending_handle : m_handle; }
+
+  /** Called by GLTextureUploader once all rows are uploaded */
+  void finish_upload();
+
 private:
   void set_texture_params();
 
@@ -60,6 +76,12 @@ private:
   int m_texture_height;
   int m_image_width;
   int m_image_height;
+  bool m_compressed;
+
+  GLTextureUploader* m_uploader;
+
+  /** the real texture while the upload is queued, 0 otherwise */
+  GLuint m_pending_handle;
 
 private:
   GLTexture(const GLTexture&) = delete;
@@ -25,6 +25,7 @@
 #include "video/gl/gl_framebuffer.hpp"
 #include "video/gl/gl_painter.hpp"
 #include "video/gl/gl_program.hpp"
+#include "video/gl/gl_state_cache.hpp"
 #include "video/gl/gl_texture.hpp"
 #include "video/gl/gl_vertex_arrays.hpp"
 #include "video/gl/gl_video_system.hpp"
@@ -34,28 +35,24 @@ GLTextureRenderer::GLTextureRenderer(GLVideoSystem& video_system, const Size& si
   GLRenderer(video_system),
   m_size(size),
   m_downscale(downscale),
-  m_texture(),
-  m_framebuffer(),
+  m_target(),
   m_rendering(false)
 {
 }
 
 GLTextureRenderer::~GLTextureRenderer()
 {
+  // a renderer replacing this one may reuse the texture
+  m_video_system.get_render_target_pool().release(std::move(m_target));
 }
 
 void
 GLTextureRenderer::prepare()
 {
-  if (!m_texture)
+  if (!m_target)
   {
-    m_texture.reset(new GLTexture(m_size.width / m_downscale,
-                                  m_size.height / m_downscale));
-
-    if (m_video_system.get_context().supports_framebuffer())
-    {
-      m_framebuffer = std::make_unique<GLFramebuffer>(static_cast<GLTexture&>(*m_texture));
-    }
+    m_target = m_video_system.get_render_target_pool().acquire(Size(m_size.width / m_downscale,
+                                                                    m_size.height / m_downscale));
   }
 }
 
@@ -77,12 +74,14 @@ GLTextureRenderer::start_draw()
   GLContext& context = m_video_system.get_context();
   context.bind();
 
-  if (m_framebuffer)
+  m_painter.flush_pixel_requests();
+
+  if (m_target.framebuffer)
   {
-    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer->get_handle());
+    glBindFramebuffer(GL_FRAMEBUFFER, m_target.framebuffer->get_handle());
   }
 
-  glViewport(0, 0, m_texture->get_image_width(), m_texture->get_image_height());
+  glViewport(0, 0, m_target.texture->get_image_width(), m_target.texture->get_image_height());
 
   context.ortho(static_cast<float>(m_size.width),
                 static_cast<float>(m_size.height),
@@ -99,20 +98,21 @@ GLTextureRenderer::end_draw()
 {
   assert_gl();
 
-  if (m_framebuffer)
+  if (m_target.framebuffer)
   {
     glBindFramebuffer(GL_FRAMEBUFFER, 0);
   }
   else
   {
     assert_gl();
-    glBindTexture(GL_TEXTURE_2D, static_cast<GLTexture&>(*m_texture).get_handle());
+    glBindTexture(GL_TEXTURE_2D, static_cast<GLTexture&>(*m_target.texture).get_handle());
+    GLStateCache::texture_binding_changed();
     glCopyTexSubImage2D(GL_TEXTURE_2D,
                         0, // level
                         0, 0, // offset
                         0, 0, // x, y
-                        m_texture->get_image_width(),
-                        m_texture->get_image_height());
+                        m_target.texture->get_image_width(),
+                        m_target.texture->get_image_height());
   }
 
   assert_gl();
@@ -130,9 +130,18 @@ GLTextureRenderer::get_logical_size() const
 Rect
 GLTextureRenderer::get_rect() const
 {
+  // same size prepare() creates the texture with, valid while released
   return Rect(0, 0,
-              Size(m_texture->get_image_width(),
-                   m_texture->get_image_height()));
+              Size(m_size.width / m_downscale,
+                   m_size.height / m_downscale));
+}
+
+void
+GLTextureRenderer::release_texture()
+{
+  assert(!m_rendering);
+
+  m_target = GLRenderTarget();
 }
 
 /* EOF */
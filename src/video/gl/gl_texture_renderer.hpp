@@ -21,10 +21,10 @@
 #include <memory>
 
 #include "video/gl.hpp"
+#include "video/gl/gl_render_target_pool.hpp"
 #include "video/gl/gl_renderer.hpp"
 #include "video/texture_ptr.hpp"
 
-class GLFramebuffer;
 class GLTexture;
 class GLVideoSystem;
 class Rect;
@@ -43,7 +43,8 @@ public:
   virtual Rect get_rect() const override;
   virtual Size get_logical_size() const override;
 
-  virtual TexturePtr get_texture() const override { return m_texture; }
+  virtual TexturePtr get_texture() const override { return m_target.texture; }
+  virtual void release_texture() override;
 
   bool is_rendering() const;
 
@@ -53,8 +54,7 @@ private:
 private:
   Size m_size;
   int m_downscale;
-  TexturePtr m_texture;
-  std::unique_ptr<GLFramebuffer> m_framebuffer;
+  GLRenderTarget m_target;
   bool m_rendering;
 
 private:
@@ -0,0 +1,180 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/gl/gl_texture_uploader.hpp"
+
+#include <algorithm>
+#include <assert.h>
+
+#include "supertux/gameconfig.hpp"
+#include "supertux/globals.hpp"
+#include "video/gl/gl_state_cache.hpp"
+#include "video/gl/gl_texture.hpp"
+#include "video/glutil.hpp"
+
+GLTextureUploader::GLTextureUploader() :
+  m_placeholder(new GLTexture(1, 1, Color(0.0f, 0.0f, 0.0f, 0.0f))),
+  m_uploads(),
+  m_staging_buffer()
+{
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (gl_supports_pixel_buffers()) {
+    glGenBuffers(1, &m_staging_buffer);
+  }
+#endif
+
+  assert_gl();
+}
+
+GLTextureUploader::~GLTextureUploader()
+{
+  // textures may outlive the uploader, so they can't be left waiting
+  while (!m_uploads.empty())
+  {
+    Upload& upload = m_uploads.front();
+    upload_rows(upload, upload.pixels->h);
+    upload.texture->finish_upload();
+    m_uploads.pop_front();
+  }
+
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (m_staging_buffer) {
+    glDeleteBuffers(1, &m_staging_buffer);
+  }
+#endif
+}
+
+bool
+GLTextureUploader::should_stream(size_t bytes) const
+{
+  return g_config->texture_upload_budget > 0 && bytes >= MIN_STREAMED_BYTES;
+}
+
+GLuint
+GLTextureUploader::get_placeholder() const
+{
+  return m_placeholder->get_handle();
+}
+
+void
+GLTextureUploader::queue(GLTexture& texture, SDLSurfacePtr pixels)
+{
+  assert(pixels->format->BytesPerPixel == 4);
+  m_uploads.push_back(Upload{ &texture, std::move(pixels), 0 });
+}
+
+std::deque<GLTextureUploader::Upload>::iterator
+GLTextureUploader::find(GLTexture& texture)
+{
+  return std::find_if(m_uploads.begin(), m_uploads.end(),
+                      [&texture](const Upload& upload) {
+                        return upload.texture == &texture;
+                      });
+}
+
+void
+GLTextureUploader::cancel(GLTexture& texture)
+{
+  auto it = find(texture);
+  if (it != m_uploads.end()) {
+    m_uploads.erase(it);
+  }
+}
+
+void
+GLTextureUploader::finish(GLTexture& texture)
+{
+  auto it = find(texture);
+  if (it == m_uploads.end())
+    return;
+
+  upload_rows(*it, it->pixels->h);
+  texture.finish_upload();
+  m_uploads.erase(it);
+}
+
+void
+GLTextureUploader::process()
+{
+  size_t budget = static_cast<size_t>(std::max(g_config->texture_upload_budget, 0)) * 1024;
+  while (!m_uploads.empty() && budget > 0)
+  {
+    Upload& upload = m_uploads.front();
+    const size_t pitch = static_cast<size_t>(upload.pixels->pitch);
+    const int rows = static_cast<int>(std::max<size_t>(budget / pitch, 1));
+
+    budget -= std::min(budget, pitch * static_cast<size_t>(rows));
+    if (upload_rows(upload, rows))
+    {
+      upload.texture->finish_upload();
+      m_uploads.pop_front();
+    }
+  }
+}
+
+bool
+GLTextureUploader::upload_rows(Upload& upload, int rows)
+{
+  SDL_Surface& pixels = *upload.pixels;
+  rows = std::min(rows, pixels.h - upload.next_row);
+
+  assert_gl();
+
+  glBindTexture(GL_TEXTURE_2D, upload.texture->get_upload_handle());
+  GLStateCache::texture_binding_changed();
+  glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+#if defined(GL_UNPACK_ROW_LENGTH) || defined(USE_GLBINDING)
+  glPixelStorei(GL_UNPACK_ROW_LENGTH, pixels.pitch / 4);
+#endif
+
+  if (SDL_MUSTLOCK(&pixels)) {
+    SDL_LockSurface(&pixels);
+  }
+
+  const uint8_t* data = static_cast<const uint8_t*>(pixels.pixels) + upload.next_row * pixels.pitch;
+
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (m_staging_buffer)
+  {
+    // orphan the buffer, so the copy doesn't wait for the last upload
+    const GLsizeiptr size = static_cast<GLsizeiptr>(rows) * pixels.pitch;
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_staging_buffer);
+    glBufferData(GL_PIXEL_UNPACK_BUFFER, size, nullptr, GL_STREAM_DRAW);
+    glBufferSubData(GL_PIXEL_UNPACK_BUFFER, 0, size, data);
+    data = nullptr;
+  }
+#endif
+
+  glTexSubImage2D(GL_TEXTURE_2D, 0, 0, upload.next_row, pixels.w, rows,
+                  GL_RGBA, GL_UNSIGNED_BYTE, data);
+
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (m_staging_buffer) {
+    glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+  }
+#endif
+
+  if (SDL_MUSTLOCK(&pixels)) {
+    SDL_UnlockSurface(&pixels);
+  }
+
+  assert_gl();
+
+  upload.next_row += rows;
+  return upload.next_row >= pixels.h;
+}
+
+/* EOF */
@@ -0,0 +1,87 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_GL_GL_TEXTURE_UPLOADER_HPP
+#define HEADER_SUPERTUX_VIDEO_GL_GL_TEXTURE_UPLOADER_HPP
+
+#include <deque>
+#include <memory>
+#include <stddef.h>
+
+#include "video/gl.hpp"
+#include "video/sdl_surface_ptr.hpp"
+
+class GLTexture;
+
+/** Spreads the upload of large textures over several frames. Queued
+    textures show a transparent placeholder until process() has
+    uploaded all of their rows, which goes through a staging pixel
+    buffer where supported so glTexSubImage2D() doesn't block. */
+class GLTextureUploader final
+{
+public:
+  /** Textures smaller than this are always uploaded right away */
+  static const size_t MIN_STREAMED_BYTES = 512 * 1024;
+
+public:
+  GLTextureUploader();
+  ~GLTextureUploader();
+
+  /** Whether a texture of the given size should be queued */
+  bool should_stream(size_t bytes) const;
+
+  GLuint get_placeholder() const;
+
+  /** pixels have to be tightly packed RGBA the size of the texture */
+  void queue(GLTexture& texture, SDLSurfacePtr pixels);
+
+  /** Drops the upload of a texture that gets destroyed */
+  void cancel(GLTexture& texture);
+
+  /** Uploads the rest of texture right away */
+  void finish(GLTexture& texture);
+
+  /** Uploads rows within the budget from the config, call once per
+      frame */
+  void process();
+
+private:
+  struct Upload
+  {
+    GLTexture* texture;
+    SDLSurfacePtr pixels;
+    int next_row;
+  };
+
+private:
+  std::deque<Upload>::iterator find(GLTexture& texture);
+
+  /** Returns true when the last row of upload is done */
+  bool upload_rows(Upload& upload, int rows);
+
+private:
+  std::unique_ptr<GLTexture> m_placeholder;
+  std::deque<Upload> m_uploads;
+  GLuint m_staging_buffer;
+
+private:
+  GLTextureUploader(const GLTextureUploader&) = delete;
+  GLTextureUploader& operator=(const GLTextureUploader&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -0,0 +1,183 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/gl/gl_timer_queries.hpp"
+
+#include <assert.h>
+
+#include "video/glutil.hpp"
+#include "video/render_stats.hpp"
+
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+
+GLTimerQueries::GLTimerQueries() :
+  m_current(),
+  m_previous(),
+  m_free(),
+  m_active(false),
+  m_frame_begin(),
+  m_frame_end(),
+  m_previous_frame_begin(),
+  m_previous_frame_end(),
+  m_frame_ms(-1.0f)
+{
+}
+
+GLTimerQueries::~GLTimerQueries()
+{
+  for (const auto& query : m_current) {
+    glDeleteQueries(1, &query.handle);
+  }
+  for (const auto& query : m_previous) {
+    glDeleteQueries(1, &query.handle);
+  }
+  for (GLuint handle : { m_frame_begin, m_frame_end, m_previous_frame_begin, m_previous_frame_end }) {
+    if (handle) {
+      glDeleteQueries(1, &handle);
+    }
+  }
+  if (!m_free.empty()) {
+    glDeleteQueries(static_cast<GLsizei>(m_free.size()), m_free.data());
+  }
+}
+
+GLuint
+GLTimerQueries::new_query()
+{
+  if (m_free.empty())
+  {
+    GLuint handle;
+    glGenQueries(1, &handle);
+    return handle;
+  }
+  else
+  {
+    const GLuint handle = m_free.back();
+    m_free.pop_back();
+    return handle;
+  }
+}
+
+void
+GLTimerQueries::begin(size_t section)
+{
+  assert_gl();
+
+  // GL_TIME_ELAPSED queries can't be nested
+  assert(!m_active);
+
+  Query query;
+  query.handle = new_query();
+  query.frame_id = g_render_stats.get_frame_id();
+  query.section = section;
+  m_current.push_back(query);
+
+  glBeginQuery(GL_TIME_ELAPSED, query.handle);
+  m_active = true;
+
+  assert_gl();
+}
+
+void
+GLTimerQueries::end()
+{
+  assert_gl();
+  assert(m_active);
+
+  glEndQuery(GL_TIME_ELAPSED);
+  m_active = false;
+
+  assert_gl();
+}
+
+void
+GLTimerQueries::begin_frame()
+{
+  if (m_frame_begin)
+    return;
+
+  assert_gl();
+
+  m_frame_begin = new_query();
+  glQueryCounter(m_frame_begin, GL_TIMESTAMP);
+
+  assert_gl();
+}
+
+void
+GLTimerQueries::end_frame()
+{
+  if (!m_frame_begin || m_frame_end)
+    return;
+
+  assert_gl();
+
+  m_frame_end = new_query();
+  glQueryCounter(m_frame_end, GL_TIMESTAMP);
+
+  assert_gl();
+}
+
+void
+GLTimerQueries::collect()
+{
+  assert_gl();
+
+  if (m_previous_frame_end)
+  {
+    GLuint64 begin = 0;
+    GLuint64 end = 0;
+    glGetQueryObjectui64v(m_previous_frame_begin, GL_QUERY_RESULT, &begin);
+    glGetQueryObjectui64v(m_previous_frame_end, GL_QUERY_RESULT, &end);
+    m_frame_ms = static_cast<float>(static_cast<double>(end - begin) / 1.0e6);
+  }
+  for (GLuint handle : { m_previous_frame_begin, m_previous_frame_end }) {
+    if (handle) {
+      m_free.push_back(handle);
+    }
+  }
+
+  // a frame that never ended is dropped
+  if (m_frame_end) {
+    m_previous_frame_begin = m_frame_begin;
+    m_previous_frame_end = m_frame_end;
+  } else {
+    if (m_frame_begin) {
+      m_free.push_back(m_frame_begin);
+    }
+    m_previous_frame_begin = 0;
+    m_previous_frame_end = 0;
+  }
+  m_frame_begin = 0;
+  m_frame_end = 0;
+
+  for (const auto& query : m_previous)
+  {
+    GLuint64 nanoseconds = 0;
+    glGetQueryObjectui64v(query.handle, GL_QUERY_RESULT, &nanoseconds);
+    g_render_stats.add_gpu_time(query.frame_id, query.section,
+                                static_cast<float>(static_cast<double>(nanoseconds) / 1.0e6));
+    m_free.push_back(query.handle);
+  }
+  m_previous.clear();
+  m_previous.swap(m_current);
+
+  assert_gl();
+}
+
+#endif
+
+/* EOF */
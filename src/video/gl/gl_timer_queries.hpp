@@ -0,0 +1,85 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_GL_GL_TIMER_QUERIES_HPP
+#define HEADER_SUPERTUX_VIDEO_GL_GL_TIMER_QUERIES_HPP
+
+#include <stddef.h>
+#include <stdint.h>
+#include <vector>
+
+#include "video/gl.hpp"
+
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+
+/** Measures the GPU time of RenderStats sections with GL_TIME_ELAPSED
+    queries. The results of a frame are collected after the following
+    frame was flipped, so reading them doesn't stall. */
+class GLTimerQueries final
+{
+public:
+  GLTimerQueries();
+  ~GLTimerQueries();
+
+  void begin(size_t section);
+  void end();
+
+  /** Bracket the GPU work of a whole frame with timestamps, these
+      work regardless of the sections and of RenderStats */
+  void begin_frame();
+  void end_frame();
+
+  /** Hands the results of the previous frame to g_render_stats, to be
+      called once per frame after the buffer swap */
+  void collect();
+
+  /** GPU time of the last collected frame, negative if unknown yet */
+  float get_frame_ms() const { return m_frame_ms; }
+
+private:
+  struct Query
+  {
+    GLuint handle;
+    uint32_t frame_id;
+    size_t section;
+  };
+
+private:
+  GLuint new_query();
+
+private:
+  std::vector<Query> m_current;
+  std::vector<Query> m_previous;
+  std::vector<GLuint> m_free;
+  bool m_active;
+
+  /** timestamp queries of begin_frame() and end_frame(), 0 if unset */
+  GLuint m_frame_begin;
+  GLuint m_frame_end;
+  GLuint m_previous_frame_begin;
+  GLuint m_previous_frame_end;
+  float m_frame_ms;
+
+private:
+  GLTimerQueries(const GLTimerQueries&) = delete;
+  GLTimerQueries& operator=(const GLTimerQueries&) = delete;
+};
+
+#endif
+
+#endif
+
+/* EOF */
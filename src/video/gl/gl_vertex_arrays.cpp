@@ -16,34 +16,47 @@
 
 #include "video/gl/gl_vertex_arrays.hpp"
 
+#include <algorithm>
+
 #include "video/color.hpp"
+#include "video/gl/gl_context.hpp"
 #include "video/gl/gl33core_context.hpp"
 #include "video/gl/gl_program.hpp"
 #include "video/gl/gl_video_system.hpp"
 #include "video/glutil.hpp"
 
+namespace {
+
+/** Initial size of each stream, enough for a few thousand quads */
+const size_t STREAM_BUFFER_SIZE = 256 * 1024;
+
+} // namespace
+
 GLVertexArrays::GLVertexArrays(GL33CoreContext& context) :
   m_context(context),
   m_vao(),
   m_positions_buffer(),
   m_texcoords_buffer(),
-  m_color_buffer()
+  m_color_buffer(),
+  m_quads_buffer()
 {
   assert_gl();
 
   glGenVertexArrays(1, &m_vao);
-  glGenBuffers(1, &m_positions_buffer);
-  glGenBuffers(1, &m_texcoords_buffer);
-  glGenBuffers(1, &m_color_buffer);
+  glGenBuffers(1, &m_positions_buffer.handle);
+  glGenBuffers(1, &m_texcoords_buffer.handle);
+  glGenBuffers(1, &m_color_buffer.handle);
+  glGenBuffers(1, &m_quads_buffer.handle);
 
   assert_gl();
 }
 
 GLVertexArrays::~GLVertexArrays()
 {
-  glDeleteBuffers(1, &m_positions_buffer);
-  glDeleteBuffers(1, &m_texcoords_buffer);
-  glDeleteBuffers(1, &m_color_buffer);
+  glDeleteBuffers(1, &m_positions_buffer.handle);
+  glDeleteBuffers(1, &m_texcoords_buffer.handle);
+  glDeleteBuffers(1, &m_color_buffer.handle);
+  glDeleteBuffers(1, &m_quads_buffer.handle);
   glDeleteVertexArrays(1, &m_vao);
 }
 
@@ -57,16 +70,41 @@ GLVertexArrays::bind()
   assert_gl();
 }
 
+size_t
+GLVertexArrays::upload(StreamBuffer& stream, const void* data, size_t size)
+{
+  glBindBuffer(GL_ARRAY_BUFFER, stream.handle);
+
+  // keep attributes aligned for the driver
+  const size_t offset = (stream.offset + 15) & ~static_cast<size_t>(15);
+  if (offset + size > stream.capacity)
+  {
+    // orphan the old storage, draws still using it keep their copy
+    stream.capacity = std::max(std::max(stream.capacity, STREAM_BUFFER_SIZE), size);
+    glBufferData(GL_ARRAY_BUFFER, stream.capacity, nullptr, GL_STREAM_DRAW);
+    stream.offset = 0;
+  }
+  else
+  {
+    stream.offset = offset;
+  }
+
+  glBufferSubData(GL_ARRAY_BUFFER, stream.offset, size, data);
+
+  const size_t result = stream.offset;
+  stream.offset += size;
+  return result;
+}
+
 void
 GLVertexArrays::set_positions(const float* data, size_t size)
 {
   assert_gl();
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_positions_buffer);
-  glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
+  const size_t offset = upload(m_positions_buffer, data, size);
 
   int loc = m_context.get_program().get_attrib_location("position");
-  glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const void*>(offset));
   glEnableVertexAttribArray(loc);
 
   assert_gl();
@@ -77,11 +115,10 @@ GLVertexArrays::set_texcoords(const float* data, size_t size)
 {
   assert_gl();
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_texcoords_buffer);
-  glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
+  const size_t offset = upload(m_texcoords_buffer, data, size);
 
   int loc = m_context.get_program().get_attrib_location("texcoord");
-  glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glVertexAttribPointer(loc, 2, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const void*>(offset));
   glEnableVertexAttribArray(loc);
 
   assert_gl();
@@ -104,11 +141,10 @@ GLVertexArrays::set_colors(const float* data, size_t size)
 {
   assert_gl();
 
-  glBindBuffer(GL_ARRAY_BUFFER, m_texcoords_buffer);
-  glBufferData(GL_ARRAY_BUFFER, size, data, GL_DYNAMIC_DRAW);
+  const size_t offset = upload(m_color_buffer, data, size);
 
   int loc = m_context.get_program().get_attrib_location("diffuse");
-  glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, 0, nullptr);
+  glVertexAttribPointer(loc, 4, GL_FLOAT, GL_FALSE, 0, reinterpret_cast<const void*>(offset));
   glEnableVertexAttribArray(loc);
 
   assert_gl();
@@ -126,4 +162,44 @@ GLVertexArrays::set_color(const Color& color)
   assert_gl();
 }
 
+void
+GLVertexArrays::set_quads(const GLQuad* quads, size_t count)
+{
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  assert_gl();
+
+  const size_t offset = upload(m_quads_buffer, quads, sizeof(GLQuad) * count);
+
+  const GLProgram& program = m_context.get_program();
+  auto attrib = [&program, offset](const char* name, GLint size, size_t member) {
+    const GLint loc = program.get_attrib_location(name);
+    glVertexAttribPointer(loc, size, GL_FLOAT, GL_FALSE, sizeof(GLQuad),
+                          reinterpret_cast<const void*>(offset + member));
+    glVertexAttribDivisor(loc, 1);
+    glEnableVertexAttribArray(loc);
+  };
+  attrib("quad_dstrect", 4, offsetof(GLQuad, dstrect));
+  attrib("quad_srcrect", 4, offsetof(GLQuad, srcrect));
+  attrib("quad_angle", 1, offsetof(GLQuad, angle));
+  attrib("quad_color", 4, offsetof(GLQuad, color));
+
+  assert_gl();
+#endif
+}
+
+void
+GLVertexArrays::clear_quads()
+{
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  assert_gl();
+
+  const GLProgram& program = m_context.get_program();
+  for (const char* name : { "quad_dstrect", "quad_srcrect", "quad_angle", "quad_color" }) {
+    glDisableVertexAttribArray(program.get_attrib_location(name));
+  }
+
+  assert_gl();
+#endif
+}
+
 /* EOF */
@@ -23,6 +23,7 @@
 
 class Color;
 class GL33CoreContext;
+struct GLQuad;
 
 class GLVertexArrays final
 {
@@ -41,12 +42,36 @@ public:
   void set_colors(const float* data, size_t size);
   void set_color(const Color& color);
 
+  /** Sets up the per instance attributes for an instanced draw of
+      count quads, clear_quads() disables them again */
+  void set_quads(const GLQuad* quads, size_t count);
+  void clear_quads();
+
+private:
+  /** A vertex buffer that is filled front to back, the storage gets
+      orphaned once it is full, so the driver never has to wait for
+      draws still using the old data */
+  struct StreamBuffer
+  {
+    StreamBuffer() : handle(), capacity(0), offset(0) {}
+
+    GLuint handle;
+    size_t capacity;
+    size_t offset;
+  };
+
+private:
+  /** Copies data into the stream, returns the byte offset to use with
+      glVertexAttribPointer(), leaves the buffer bound */
+  size_t upload(StreamBuffer& stream, const void* data, size_t size);
+
 private:
   GL33CoreContext& m_context;
   GLuint m_vao;
-  GLuint m_positions_buffer;
-  GLuint m_texcoords_buffer;
-  GLuint m_color_buffer;
+  StreamBuffer m_positions_buffer;
+  StreamBuffer m_texcoords_buffer;
+  StreamBuffer m_color_buffer;
+  StreamBuffer m_quads_buffer;
 
 private:
   GLVertexArrays(const GLVertexArrays&) = delete;
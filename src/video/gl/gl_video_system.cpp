@@ -16,18 +16,25 @@
 
 #include "video/gl/gl_video_system.hpp"
 
+#include <algorithm>
+#include <math.h>
+
 #include "math/rect.hpp"
 #include "supertux/gameconfig.hpp"
 #include "supertux/globals.hpp"
 #include "util/log.hpp"
+#include "video/compressed_image.hpp"
 #include "video/gl/gl20_context.hpp"
 #include "video/gl/gl33core_context.hpp"
 #include "video/gl/gl_context.hpp"
 #include "video/gl/gl_program.hpp"
+#include "video/gl/gl_render_target_pool.hpp"
+#include "video/gl/gl_screen_reader.hpp"
 #include "video/gl/gl_screen_renderer.hpp"
 #include "video/gl/gl_texture.hpp"
 #include "video/gl/gl_texture_renderer.hpp"
-#include "video/gl/gl_texture_renderer.hpp"
+#include "video/gl/gl_texture_uploader.hpp"
+#include "video/gl/gl_timer_queries.hpp"
 #include "video/gl/gl_vertex_arrays.hpp"
 #include "video/glutil.hpp"
 #include "video/sdl_surface.hpp"
@@ -40,15 +47,47 @@
 #  include <glbinding/callbacks.h>
 #endif
 
+namespace {
+
+/** Bounds of the render scale */
+const float MIN_RENDER_SCALE = 0.25f;
+const float MIN_DYNAMIC_RENDER_SCALE = 0.5f;
+
+/** Share of the refresh interval the GPU may take, the rest is slack
+    for the driver and the compositor */
+const float FRAME_BUDGET_SHARE = 0.9f;
+
+/** Frame budget when the refresh rate is unknown */
+const float DEFAULT_FRAME_BUDGET_MS = 15.0f;
+
+float config_render_scale()
+{
+  const float scale = std::max(std::min(g_config->render_scale, 1.0f), MIN_RENDER_SCALE);
+  // also catches NaN from a broken config
+  return (scale >= MIN_RENDER_SCALE) ? scale : 1.0f;
+}
+
+} // namespace
+
 GLVideoSystem::GLVideoSystem(bool use_opengl33core) :
   m_use_opengl33core(use_opengl33core),
+  m_texture_uploader(),
   m_texture_manager(),
   m_renderer(),
+  m_render_target_pool(),
   m_lightmap(),
   m_back_renderer(),
   m_context(),
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  m_timer_queries(),
+#endif
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  m_screen_reader(),
+#endif
+  m_dynamic_resolution(),
   m_glcontext(),
-  m_viewport()
+  m_viewport(),
+  m_compressed_formats()
 {
   create_gl_window();
 
@@ -73,11 +112,37 @@ GLVideoSystem::GLVideoSystem(bool use_opengl33core) :
 
   assert_gl();
 
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  if (gl_supports_timer_queries()) {
+    m_timer_queries.reset(new GLTimerQueries);
+  }
+#endif
+
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (gl_supports_pixel_buffers()) {
+    m_screen_reader.reset(new GLScreenReader);
+  }
+#endif
+
+  GLint num_formats = 0;
+  glGetIntegerv(GL_NUM_COMPRESSED_TEXTURE_FORMATS, &num_formats);
+  if (num_formats > 0)
+  {
+    std::vector<GLint> formats(static_cast<size_t>(num_formats));
+    glGetIntegerv(GL_COMPRESSED_TEXTURE_FORMATS, formats.data());
+    for (const auto format : formats) {
+      m_compressed_formats.push_back(static_cast<GLenum>(format));
+    }
+    std::sort(m_compressed_formats.begin(), m_compressed_formats.end());
+  }
+
+  m_texture_uploader.reset(new GLTextureUploader);
   m_texture_manager.reset(new TextureManager);
 
   assert_gl();
 
   m_renderer.reset(new GLScreenRenderer(*this));
+  m_render_target_pool.reset(new GLRenderTargetPool(*this));
 
   assert_gl();
 
@@ -86,6 +151,12 @@ GLVideoSystem::GLVideoSystem(bool use_opengl33core) :
 
 GLVideoSystem::~GLVideoSystem()
 {
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  // needs the context for its buffers
+  m_screen_reader.reset();
+#endif
+  // completes the queued uploads, while the context is still there
+  m_texture_uploader.reset();
   SDL_GL_DeleteContext(m_glcontext);
 }
 
@@ -119,7 +190,15 @@ GLVideoSystem::create_gl_window()
   SDL_GL_SetAttribute(SDL_GL_GREEN_SIZE, 5);
   SDL_GL_SetAttribute(SDL_GL_BLUE_SIZE,  5);
 
-#if defined(USE_OPENGLES2)
+#if defined(USE_OPENGLES3)
+  log_info << "Requesting OpenGLES3 context" << std::endl;
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 3);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
+  SDL_GL_SetAttribute(SDL_GL_CONTEXT_PROFILE_MASK, SDL_GL_CONTEXT_PROFILE_ES);
+
+  SDL_GL_SetAttribute(SDL_GL_DOUBLEBUFFER, 1);
+  SDL_GL_SetAttribute(SDL_GL_DEPTH_SIZE, 24);
+#elif defined(USE_OPENGLES2)
   log_info << "Requesting OpenGLES2 context" << std::endl;
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MAJOR_VERSION, 2);
   SDL_GL_SetAttribute(SDL_GL_CONTEXT_MINOR_VERSION, 0);
@@ -255,7 +334,8 @@ GLVideoSystem::apply_config()
 
   m_viewport = Viewport::from_size(target_size, m_desktop_size);
 
-  m_lightmap.reset(new GLTextureRenderer(*this, m_viewport.get_screen_size(), 5));
+  m_lightmap.reset(new GLTextureRenderer(*this, m_viewport.get_screen_size(),
+                                         get_lightmap_downscale(m_viewport.get_screen_size())));
   if (m_use_opengl33core)
   {
     m_back_renderer.reset(new GLTextureRenderer(*this, m_viewport.get_screen_size(), 1));
@@ -283,14 +363,115 @@ GLVideoSystem::get_back_renderer() const
 TexturePtr
 GLVideoSystem::new_texture(const SDL_Surface& image, const Sampler& sampler)
 {
+  return TexturePtr(new GLTexture(image, sampler, m_texture_uploader.get()));
+}
+
+TexturePtr
+GLVideoSystem::new_compressed_texture(const CompressedImage& image, const Sampler& sampler)
+{
+  const GLenum format = static_cast<GLenum>(image.get_internal_format());
+  if (!std::binary_search(m_compressed_formats.begin(), m_compressed_formats.end(), format))
+    return {};
+
+  // compressed images can't be padded to a power of two
+  if (gl_needs_power_of_two() &&
+      (!is_power_of_2(image.get_width()) || !is_power_of_2(image.get_height())))
+    return {};
+
   return TexturePtr(new GLTexture(image, sampler));
 }
 
+void
+GLVideoSystem::begin_frame()
+{
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  if (m_timer_queries) {
+    m_timer_queries->begin_frame();
+  }
+#endif
+}
+
 void
 GLVideoSystem::flip()
 {
   assert_gl();
+
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  if (m_timer_queries) {
+    m_timer_queries->end_frame();
+  }
+#endif
+
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (m_screen_reader) {
+    m_screen_reader->read();
+  }
+#endif
+
   SDL_GL_SwapWindow(m_sdl_window.get());
+
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (m_screen_reader) {
+    m_screen_reader->collect();
+  }
+#endif
+
+  m_render_target_pool->trim();
+  m_texture_uploader->process();
+
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  if (m_timer_queries) {
+    m_timer_queries->collect();
+
+    const float gpu_ms = m_timer_queries->get_frame_ms();
+    if (g_config->dynamic_render_scale && gpu_ms >= 0.0f)
+    {
+      const float max_scale = config_render_scale();
+      m_dynamic_resolution.update(gpu_ms, get_frame_budget_ms(),
+                                  std::min(MIN_DYNAMIC_RENDER_SCALE, max_scale), max_scale);
+    }
+  }
+#endif
+}
+
+void
+GLVideoSystem::flush()
+{
+  assert_gl();
+  glFlush();
+}
+
+float
+GLVideoSystem::get_render_scale() const
+{
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  if (g_config->dynamic_render_scale && m_timer_queries) {
+    return m_dynamic_resolution.get_scale();
+  }
+#endif
+
+  return config_render_scale();
+}
+
+float
+GLVideoSystem::get_frame_budget_ms() const
+{
+  SDL_DisplayMode mode;
+  if (SDL_GetWindowDisplayMode(m_sdl_window.get(), &mode) != 0 || mode.refresh_rate <= 0) {
+    return DEFAULT_FRAME_BUDGET_MS;
+  }
+
+  return 1000.0f / static_cast<float>(mode.refresh_rate) * FRAME_BUDGET_SHARE;
+}
+
+GLTimerQueries*
+GLVideoSystem::get_timer_queries() const
+{
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  return m_timer_queries.get();
+#else
+  return nullptr;
+#endif
 }
 
 void
@@ -346,4 +527,18 @@ GLVideoSystem::make_screenshot()
   return surface;
 }
 
+void
+GLVideoSystem::read_screen(ScreenCallback callback)
+{
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  if (m_screen_reader)
+  {
+    m_screen_reader->request(std::move(callback));
+    return;
+  }
+#endif
+
+  VideoSystem::read_screen(std::move(callback));
+}
+
 /* EOF */
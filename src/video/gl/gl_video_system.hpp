@@ -19,17 +19,23 @@
 
 #include <memory>
 #include <SDL.h>
+#include <vector>
 
 #include "math/size.hpp"
+#include "video/dynamic_resolution.hpp"
 #include "video/sdlbase_video_system.hpp"
 #include "video/viewport.hpp"
 
 class GLContext;
 class GLLightmap;
 class GLProgram;
+class GLRenderTargetPool;
+class GLScreenReader;
 class GLScreenRenderer;
 class GLTexture;
 class GLTextureRenderer;
+class GLTextureUploader;
+class GLTimerQueries;
 class GLVertexArrays;
 class Rect;
 class TextureManager;
@@ -48,33 +54,65 @@ public:
   virtual Renderer& get_lightmap() const override;
 
   virtual TexturePtr new_texture(const SDL_Surface& image, const Sampler& sampler) override;
+  virtual TexturePtr new_compressed_texture(const CompressedImage& image, const Sampler& sampler) override;
 
   virtual const Viewport& get_viewport() const override { return m_viewport; }
   virtual void apply_config() override;
+  virtual void begin_frame() override;
   virtual void flip() override;
+  virtual void flush() override;
 
   virtual void set_vsync(int mode) override;
   virtual int get_vsync() const override;
 
   virtual SDLSurfacePtr make_screenshot() override;
+  virtual void read_screen(ScreenCallback callback) override;
 
   GLContext& get_context() const { return *m_context; }
+  GLRenderTargetPool& get_render_target_pool() const { return *m_render_target_pool; }
+
+  /** nullptr if timer queries aren't supported */
+  GLTimerQueries* get_timer_queries() const;
+
+  /** Resolution of the level relative to the screen, from the config
+      or, with dynamic_render_scale, from the GPU time of the frames */
+  float get_render_scale() const;
 
 private:
   void create_gl_window();
   void create_gl_context();
 
+  /** Milliseconds of GPU time per frame dynamic resolution aims for */
+  float get_frame_budget_ms() const;
+
 private:
   bool m_use_opengl33core;
+  std::unique_ptr<GLTextureUploader> m_texture_uploader;
   std::unique_ptr<TextureManager> m_texture_manager;
   std::unique_ptr<GLScreenRenderer> m_renderer;
+
+  /** declared before the texture renderers, which give their targets
+      back to it on destruction */
+  std::unique_ptr<GLRenderTargetPool> m_render_target_pool;
   std::unique_ptr<GLTextureRenderer> m_lightmap;
   std::unique_ptr<GLTextureRenderer> m_back_renderer;
   std::unique_ptr<GLContext> m_context;
+#if !defined(USE_OPENGLES2) && !defined(USE_OPENGLES1)
+  std::unique_ptr<GLTimerQueries> m_timer_queries;
+#endif
+#if !defined(USE_OPENGLES2) || defined(USE_OPENGLES3)
+  /** nullptr if pixel buffers aren't supported */
+  std::unique_ptr<GLScreenReader> m_screen_reader;
+#endif
+
+  DynamicResolution m_dynamic_resolution;
 
   SDL_GLContext m_glcontext;
   Viewport m_viewport;
 
+  /** GL_COMPRESSED_TEXTURE_FORMATS, sorted */
+  std::vector<GLenum> m_compressed_formats;
+
 private:
   GLVideoSystem(const GLVideoSystem&) = delete;
   GLVideoSystem& operator=(const GLVideoSystem&) = delete;
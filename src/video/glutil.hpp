@@ -90,6 +90,42 @@ inline bool gl_needs_power_of_two()
 #endif
 }
 
+inline bool gl_supports_pixel_buffers()
+{
+#if defined(USE_OPENGLES3)
+  return true;
+#elif defined(USE_OPENGLES2)
+  return false;
+#elif defined(USE_OPENGLES1)
+  return false;
+#else
+#  ifdef USE_GLBINDING
+  static auto extensions = glbinding::ContextInfo::extensions();
+  return glbinding::ContextInfo::version() >= glbinding::Version(2, 1) ||
+    extensions.find(GLextension::GL_ARB_pixel_buffer_object) != extensions.end();
+#  else
+  return GLEW_VERSION_2_1 || GLEW_ARB_pixel_buffer_object;
+#  endif
+#endif
+}
+
+inline bool gl_supports_timer_queries()
+{
+#if defined(USE_OPENGLES2)
+  return false;
+#elif defined(USE_OPENGLES1)
+  return false;
+#else
+#  ifdef USE_GLBINDING
+  static auto extensions = glbinding::ContextInfo::extensions();
+  return glbinding::ContextInfo::version() >= glbinding::Version(3, 3) ||
+    extensions.find(GLextension::GL_ARB_timer_query) != extensions.end();
+#  else
+  return GLEW_VERSION_3_3 || GLEW_ARB_timer_query;
+#  endif
+#endif
+}
+
 inline bool is_power_of_2(int v)
 {
   return (v & (v-1)) == 0;
@@ -17,6 +17,7 @@
 #include "video/null/null_painter.hpp"
 
 #include "util/log.hpp"
+#include "video/painter_dispatch.hpp"
 
 NullPainter::NullPainter() :
   m_clip_rect()
@@ -27,6 +28,12 @@ NullPainter::~NullPainter()
 {
 }
 
+void
+NullPainter::draw_requests(const std::vector<DrawingRequest*>& requests)
+{
+  dispatch_requests(*this, requests);
+}
+
 void
 NullPainter::draw_texture(const TextureRequest& request)
 {
@@ -57,6 +64,12 @@ NullPainter::draw_line(const LineRequest& request)
   log_info << "NullPainter::draw_line()" << std::endl;
 }
 
+void
+NullPainter::draw_lines(const LinesRequest& request)
+{
+  log_info << "NullPainter::draw_lines()" << std::endl;
+}
+
 void
 NullPainter::draw_triangle(const TriangleRequest& request)
 {
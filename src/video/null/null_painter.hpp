@@ -21,17 +21,19 @@
 
 #include <boost/optional.hpp>
 
-class NullPainter : public Painter
+class NullPainter final : public Painter
 {
 public:
   NullPainter();
   virtual ~NullPainter();
 
+  virtual void draw_requests(const std::vector<DrawingRequest*>& requests) override;
   virtual void draw_texture(const TextureRequest& request) override;
   virtual void draw_gradient(const GradientRequest& request) override;
   virtual void draw_filled_rect(const FillRectRequest& request) override;
   virtual void draw_inverse_ellipse(const InverseEllipseRequest& request) override;
   virtual void draw_line(const LineRequest& request) override;
+  virtual void draw_lines(const LinesRequest& request) override;
   virtual void draw_triangle(const TriangleRequest& request) override;
 
   virtual void clear(const Color& color) override;
@@ -0,0 +1,43 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/number_text.hpp"
+
+#include "video/font.hpp"
+
+NumberText::NumberText() :
+  m_font(),
+  m_value(0),
+  m_text(),
+  m_width(0.0f),
+  m_height(0.0f)
+{
+}
+
+void
+NumberText::set(const FontPtr& font, int value)
+{
+  if (font == m_font && value == m_value && !m_text.empty())
+    return;
+
+  m_font = font;
+  m_value = value;
+  m_text = std::to_string(value);
+  m_width = font->get_text_width(m_text);
+  m_height = font->get_text_height(m_text);
+}
+
+/* EOF */
@@ -0,0 +1,53 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_NUMBER_TEXT_HPP
+#define HEADER_SUPERTUX_VIDEO_NUMBER_TEXT_HPP
+
+#include <string>
+
+#include "video/font_ptr.hpp"
+
+/** The text of an integer together with its size in a given font.
+    HUD counters query it every frame, it only formats and measures the
+    text again when the value or the font changed. */
+class NumberText final
+{
+public:
+  NumberText();
+
+  void set(const FontPtr& font, int value);
+
+  const std::string& get_text() const { return m_text; }
+  float get_width() const { return m_width; }
+  float get_height() const { return m_height; }
+
+private:
+  /** holds on to the font so a reloaded font can't reuse its address */
+  FontPtr m_font;
+  int m_value;
+  std::string m_text;
+  float m_width;
+  float m_height;
+
+private:
+  NumberText(const NumberText&) = delete;
+  NumberText& operator=(const NumberText&) = delete;
+};
+
+#endif
+
+/* EOF */
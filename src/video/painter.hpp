@@ -18,6 +18,9 @@
 #ifndef HEADER_SUPERTUX_VIDEO_PAINTER_HPP
 #define HEADER_SUPERTUX_VIDEO_PAINTER_HPP
 
+#include <stddef.h>
+#include <vector>
+
 #include "math/rect.hpp"
 #include "math/vector.hpp"
 #include "video/color.hpp"
@@ -29,6 +32,7 @@ struct GetPixelRequest;
 struct GradientRequest;
 struct InverseEllipseRequest;
 struct LineRequest;
+struct LinesRequest;
 struct TextureBatchRequest;
 struct TextureRequest;
 struct TriangleRequest;
@@ -39,11 +43,17 @@ public:
   Painter() {}
   virtual ~Painter() {}
 
+  /** Draws the requests of a layer in order, implementations hand
+      them to dispatch_requests() so the individual draw calls below
+      don't go through the vtable */
+  virtual void draw_requests(const std::vector<DrawingRequest*>& requests) = 0;
+
   virtual void draw_texture(const TextureRequest& request) = 0;
   virtual void draw_gradient(const GradientRequest& request) = 0;
   virtual void draw_filled_rect(const FillRectRequest& request) = 0;
   virtual void draw_inverse_ellipse(const InverseEllipseRequest& request) = 0;
   virtual void draw_line(const LineRequest& request) = 0;
+  virtual void draw_lines(const LinesRequest& request) = 0;
   virtual void draw_triangle(const TriangleRequest& request) = 0;
 
   virtual void clear(const Color& color) = 0;
@@ -52,6 +62,11 @@ public:
   virtual void set_clip_rect(const Rect& rect) = 0;
   virtual void clear_clip_rect() = 0;
 
+  /** Brackets the drawing of a RenderStats section, lets painters
+      measure its GPU time */
+  virtual void begin_stats_section(size_t /*section*/) {}
+  virtual void end_stats_section() {}
+
 private:
   Painter(const Painter&) = delete;
   Painter& operator=(const Painter&) = delete;
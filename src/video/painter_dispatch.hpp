@@ -0,0 +1,71 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_PAINTER_DISPATCH_HPP
+#define HEADER_SUPERTUX_VIDEO_PAINTER_DISPATCH_HPP
+
+#include <vector>
+
+#include "video/drawing_request.hpp"
+
+/** Hands each request to the matching draw function of painter. P is
+    the final painter class, so the calls are bound at compile time
+    and can be inlined, this is what Painter::draw_requests()
+    implementations are made of. */
+template<typename P>
+void dispatch_requests(P& painter, const std::vector<DrawingRequest*>& requests)
+{
+  for (const DrawingRequest* request : requests)
+  {
+    switch (request->type) {
+      case TEXTURE:
+        painter.P::draw_texture(static_cast<const TextureRequest&>(*request));
+        break;
+
+      case GRADIENT:
+        painter.P::draw_gradient(static_cast<const GradientRequest&>(*request));
+        break;
+
+      case FILLRECT:
+        painter.P::draw_filled_rect(static_cast<const FillRectRequest&>(*request));
+        break;
+
+      case INVERSEELLIPSE:
+        painter.P::draw_inverse_ellipse(static_cast<const InverseEllipseRequest&>(*request));
+        break;
+
+      case LINE:
+        painter.P::draw_line(static_cast<const LineRequest&>(*request));
+        break;
+
+      case LINES:
+        painter.P::draw_lines(static_cast<const LinesRequest&>(*request));
+        break;
+
+      case TRIANGLE:
+        painter.P::draw_triangle(static_cast<const TriangleRequest&>(*request));
+        break;
+
+      case GETPIXEL:
+        painter.P::get_pixel(static_cast<const GetPixelRequest&>(*request));
+        break;
+    }
+  }
+}
+
+#endif
+
+/* EOF */
@@ -0,0 +1,198 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/render_stats.hpp"
+
+#include "util/log.hpp"
+
+RenderStats g_render_stats;
+
+const size_t RenderStats::NO_SECTION;
+
+RenderStats::RenderStats() :
+  m_enabled(false),
+  m_frame_id(0),
+  m_frames(),
+  m_current_section(NO_SECTION),
+  m_csv()
+{
+}
+
+void
+RenderStats::open_csv(const std::string& filename)
+{
+  m_csv.open(filename.c_str());
+  if (!m_csv)
+  {
+    log_warning << "Couldn't open render stats file '" << filename << "'" << std::endl;
+    return;
+  }
+
+  m_csv << "frame,target,layer,requests,draw_calls,vertices,texture_binds,state_changes,elided_calls,gpu_ms\n";
+}
+
+void
+RenderStats::begin_frame(bool enabled)
+{
+  m_enabled = enabled || m_csv.is_open();
+  if (!m_enabled)
+    return;
+
+  m_frame_id += 1;
+  m_current_section = NO_SECTION;
+
+  // the GPU times of the frame before the last one came in with the
+  // last flip, so it's complete now
+  const Frame* complete = get_complete_frame();
+  if (complete && m_csv.is_open()) {
+    write_csv(*complete);
+  }
+
+  Frame& frame = current();
+  frame.id = m_frame_id;
+  frame.valid = true;
+  frame.totals = Counters();
+  frame.sections.clear();
+}
+
+size_t
+RenderStats::begin_section(DrawingTarget target, int layer, int requests)
+{
+  if (!m_enabled)
+    return NO_SECTION;
+
+  // several drawing contexts may render the same layer, they share
+  // the section
+  auto& sections = current().sections;
+  m_current_section = sections.size();
+  for (size_t i = 0; i < sections.size(); ++i)
+  {
+    if (sections[i].target == target && sections[i].layer == layer) {
+      m_current_section = i;
+      break;
+    }
+  }
+  if (m_current_section == sections.size()) {
+    sections.emplace_back(target, layer);
+  }
+
+  sections[m_current_section].counters.requests += requests;
+  current().totals.requests += requests;
+  return m_current_section;
+}
+
+void
+RenderStats::end_section()
+{
+  m_current_section = NO_SECTION;
+}
+
+RenderStats::Counters*
+RenderStats::current_counters()
+{
+  if (m_current_section == NO_SECTION)
+    return nullptr;
+  return &current().sections[m_current_section].counters;
+}
+
+void
+RenderStats::add_draw_call(int vertices)
+{
+  if (!m_enabled)
+    return;
+
+  current().totals.draw_calls += 1;
+  current().totals.vertices += vertices;
+  if (auto* counters = current_counters()) {
+    counters->draw_calls += 1;
+    counters->vertices += vertices;
+  }
+}
+
+void
+RenderStats::add_texture_bind()
+{
+  if (!m_enabled)
+    return;
+
+  current().totals.texture_binds += 1;
+  if (auto* counters = current_counters()) {
+    counters->texture_binds += 1;
+  }
+}
+
+void
+RenderStats::add_state_change()
+{
+  if (!m_enabled)
+    return;
+
+  current().totals.state_changes += 1;
+  if (auto* counters = current_counters()) {
+    counters->state_changes += 1;
+  }
+}
+
+void
+RenderStats::add_elided_call()
+{
+  if (!m_enabled)
+    return;
+
+  current().totals.elided_calls += 1;
+  if (auto* counters = current_counters()) {
+    counters->elided_calls += 1;
+  }
+}
+
+void
+RenderStats::add_gpu_time(uint32_t frame_id, size_t section, float ms)
+{
+  Frame& frame = m_frames[frame_id % NUM_FRAMES];
+  if (!frame.valid || frame.id != frame_id || section >= frame.sections.size())
+    return;
+
+  frame.sections[section].counters.gpu_ms += ms;
+  frame.totals.gpu_ms += ms;
+}
+
+const RenderStats::Frame*
+RenderStats::get_complete_frame() const
+{
+  if (m_frame_id < 2)
+    return nullptr;
+
+  const Frame& frame = m_frames[(m_frame_id - 2) % NUM_FRAMES];
+  if (!frame.valid || frame.id != m_frame_id - 2)
+    return nullptr;
+
+  return &frame;
+}
+
+void
+RenderStats::write_csv(const Frame& frame)
+{
+  for (const auto& section : frame.sections)
+  {
+    const Counters& c = section.counters;
+    m_csv << frame.id << ',' << to_string(section.target) << ',' << section.layer << ','
+          << c.requests << ',' << c.draw_calls << ',' << c.vertices << ','
+          << c.texture_binds << ',' << c.state_changes << ',' << c.elided_calls << ','
+          << c.gpu_ms << '\n';
+  }
+}
+
+/* EOF */
@@ -0,0 +1,124 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_RENDER_STATS_HPP
+#define HEADER_SUPERTUX_VIDEO_RENDER_STATS_HPP
+
+#include <fstream>
+#include <stddef.h>
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+#include "video/drawing_target.hpp"
+
+/** Per frame counters of the renderer, broken down by drawing target
+    and layer. GPU times are filled in by the video system once the
+    GPU is done with a frame, so complete frames lag two frames
+    behind. Recording only happens while enabled, otherwise all calls
+    return right away. */
+class RenderStats final
+{
+public:
+  static const size_t NO_SECTION = static_cast<size_t>(-1);
+
+  struct Counters
+  {
+    Counters() : requests(0), draw_calls(0), vertices(0), texture_binds(0), state_changes(0), elided_calls(0), gpu_ms(0.0f) {}
+
+    int requests;
+    int draw_calls;
+    int vertices;
+    int texture_binds;
+    int state_changes;
+
+    /** GL calls skipped because the state was already set */
+    int elided_calls;
+    float gpu_ms;
+  };
+
+  struct Section
+  {
+    Section(DrawingTarget target_, int layer_) : target(target_), layer(layer_), counters() {}
+
+    DrawingTarget target;
+    int layer;
+    Counters counters;
+  };
+
+  struct Frame
+  {
+    Frame() : id(0), valid(false), totals(), sections() {}
+
+    uint32_t id;
+    bool valid;
+    Counters totals;
+    std::vector<Section> sections;
+  };
+
+public:
+  RenderStats();
+
+  /** Writes every complete frame to filename as CSV, recording is
+      enabled as long as the file is open */
+  void open_csv(const std::string& filename);
+
+  /** Starts recording a new frame */
+  void begin_frame(bool enabled);
+
+  bool is_enabled() const { return m_enabled; }
+  uint32_t get_frame_id() const { return m_frame_id; }
+
+  /** Counters of the following calls go to the section of the given
+      target and layer, returns its index for add_gpu_time() */
+  size_t begin_section(DrawingTarget target, int layer, int requests);
+  void end_section();
+
+  void add_draw_call(int vertices);
+  void add_texture_bind();
+  void add_state_change();
+  void add_elided_call();
+
+  /** Adds GPU time measured for a section of an earlier frame */
+  void add_gpu_time(uint32_t frame_id, size_t section, float ms);
+
+  /** The latest frame that has all its GPU times, or nullptr */
+  const Frame* get_complete_frame() const;
+
+private:
+  static const int NUM_FRAMES = 3;
+
+  Frame& current() { return m_frames[m_frame_id % NUM_FRAMES]; }
+  Counters* current_counters();
+  void write_csv(const Frame& frame);
+
+private:
+  bool m_enabled;
+  uint32_t m_frame_id;
+  Frame m_frames[NUM_FRAMES];
+  size_t m_current_section;
+  std::ofstream m_csv;
+
+private:
+  RenderStats(const RenderStats&) = delete;
+  RenderStats& operator=(const RenderStats&) = delete;
+};
+
+extern RenderStats g_render_stats;
+
+#endif
+
+/* EOF */
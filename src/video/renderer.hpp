@@ -35,12 +35,21 @@ public:
   virtual void start_draw() = 0;
   virtual void end_draw() = 0;
 
+  /** Marks the end of the level between start_draw() and end_draw(),
+      what follows is HUD. Renderers drawing the level at a lower
+      resolution scale it up here. */
+  virtual void end_scene() {}
+
   virtual Painter& get_painter() = 0;
 
   virtual Rect get_rect() const = 0;
   virtual Size get_logical_size() const = 0;
 
   virtual TexturePtr get_texture() const = 0;
+
+  /** Frees the texture rendered into, if the renderer owns one, the
+      next start_draw() creates it again */
+  virtual void release_texture() {}
 };
 
 #endif
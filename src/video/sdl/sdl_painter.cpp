@@ -26,6 +26,8 @@
 #include "math/util.hpp"
 #include "util/log.hpp"
 #include "video/drawing_request.hpp"
+#include "video/painter_dispatch.hpp"
+#include "video/render_stats.hpp"
 #include "video/renderer.hpp"
 #include "video/sdl/sdl_texture.hpp"
 #include "video/sdl/sdl_video_system.hpp"
@@ -33,6 +35,10 @@
 
 namespace {
 
+/** Gradients of fading Gradient objects change every frame, so only
+    a few textures are kept around */
+const size_t MAX_GRADIENT_TEXTURES = 8;
+
 SDL_Rect to_sdl_rect(const Rectf& rect)
 {
   SDL_Rect sdl_rect;
@@ -218,9 +224,105 @@ SDLPainter::SDLPainter(SDLVideoSystem& video_system, Renderer& renderer, SDL_Ren
   m_video_system(video_system),
   m_renderer(renderer),
   m_sdl_renderer(sdl_renderer),
-  m_cliprect()
+  m_cliprect(),
+  m_gradient_textures()
+#if SDL_VERSION_ATLEAST(2,0,18)
+  ,
+  m_vertices(),
+  m_indices(),
+  m_batch_texture(nullptr),
+  m_batch_blend(SDL_BLENDMODE_NONE)
+#endif
 {}
 
+SDLPainter::~SDLPainter()
+{
+  for (const auto& gradient : m_gradient_textures) {
+    SDL_DestroyTexture(gradient.texture);
+  }
+}
+
+void
+SDLPainter::flush() const
+{
+#if SDL_VERSION_ATLEAST(2,0,18)
+  if (m_indices.empty())
+    return;
+
+  // the vertex colors replace the texture modulation
+  SDL_SetTextureColorMod(m_batch_texture, 255, 255, 255);
+  SDL_SetTextureAlphaMod(m_batch_texture, 255);
+  SDL_SetTextureBlendMode(m_batch_texture, m_batch_blend);
+
+  if (SDL_RenderGeometry(m_sdl_renderer, m_batch_texture,
+                         m_vertices.data(), static_cast<int>(m_vertices.size()),
+                         m_indices.data(), static_cast<int>(m_indices.size())) != 0)
+  {
+    log_warning << "SDLPainter::flush(): SDL_RenderGeometry() failed: " << SDL_GetError() << std::endl;
+  }
+  g_render_stats.add_texture_bind();
+  g_render_stats.add_draw_call(static_cast<int>(m_indices.size()));
+
+  m_vertices.clear();
+  m_indices.clear();
+  m_batch_texture = nullptr;
+#endif
+}
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+void
+SDLPainter::add_quad(const SDL_Rect& srcrect, const SDL_Rect& dstrect,
+                     float angle, int flip, const SDL_Color& color,
+                     float texture_width, float texture_height)
+{
+  float u1 = static_cast<float>(srcrect.x) / texture_width;
+  float v1 = static_cast<float>(srcrect.y) / texture_height;
+  float u2 = static_cast<float>(srcrect.x + srcrect.w) / texture_width;
+  float v2 = static_cast<float>(srcrect.y + srcrect.h) / texture_height;
+
+  if ((flip & HORIZONTAL_FLIP) != 0) {
+    std::swap(u1, u2);
+  }
+  if ((flip & VERTICAL_FLIP) != 0) {
+    std::swap(v1, v2);
+  }
+
+  // corners relative to the center, which SDL_RenderCopyEx() rotates around
+  const float hw = static_cast<float>(dstrect.w) / 2.0f;
+  const float hh = static_cast<float>(dstrect.h) / 2.0f;
+  const float cx = static_cast<float>(dstrect.x) + hw;
+  const float cy = static_cast<float>(dstrect.y) + hh;
+  std::array<SDL_FPoint, 4> corners = {{ { -hw, -hh }, { hw, -hh }, { hw, hh }, { -hw, hh } }};
+  if (angle != 0.0f)
+  {
+    const float rad = math::radians(angle);
+    const float c = cosf(rad);
+    const float s = sinf(rad);
+    for (auto& p : corners) {
+      p = SDL_FPoint{ p.x * c - p.y * s, p.x * s + p.y * c };
+    }
+  }
+
+  const std::array<SDL_FPoint, 4> tex_coords = {{ { u1, v1 }, { u2, v1 }, { u2, v2 }, { u1, v2 } }};
+
+  const int base = static_cast<int>(m_vertices.size());
+  for (size_t i = 0; i < 4; ++i) {
+    m_vertices.push_back(SDL_Vertex{ SDL_FPoint{ cx + corners[i].x, cy + corners[i].y },
+                                     color, tex_coords[i] });
+  }
+
+  for (int i : { 0, 1, 2, 0, 2, 3 }) {
+    m_indices.push_back(base + i);
+  }
+}
+#endif
+
+void
+SDLPainter::draw_requests(const std::vector<DrawingRequest*>& requests)
+{
+  dispatch_requests(*this, requests);
+}
+
 void
 SDLPainter::draw_texture(const TextureRequest& request)
 {
@@ -229,15 +331,65 @@ SDLPainter::draw_texture(const TextureRequest& request)
   assert(request.srcrects.size() == request.dstrects.size());
   assert(request.srcrects.size() == request.angles.size());
 
+#if SDL_VERSION_ATLEAST(2,0,18)
+  // animated textures have to be split when wrapping around, leave
+  // those to RenderCopyEx()
+  Vector animate = texture.get_sampler().get_animate();
+  if (animate.x != 0.0f || animate.y != 0.0f)
+  {
+    animate *= g_game_time;
+    if (math::positive_mod(static_cast<int>(animate.x), texture.get_texture_width()) == 0 &&
+        math::positive_mod(static_cast<int>(animate.y), texture.get_texture_height()) == 0)
+    {
+      animate = Vector(0.0f, 0.0f);
+    }
+  }
+
+  if (animate.x == 0.0f && animate.y == 0.0f)
+  {
+    const SDL_BlendMode blend = blend2sdl(request.blend);
+    if (texture.get_texture() != m_batch_texture || blend != m_batch_blend)
+    {
+      flush();
+      m_batch_texture = texture.get_texture();
+      m_batch_blend = blend;
+    }
+
+    const float texture_width = static_cast<float>(texture.get_texture_width());
+    const float texture_height = static_cast<float>(texture.get_texture_height());
+
+    m_vertices.reserve(m_vertices.size() + 4 * request.srcrects.size());
+    m_indices.reserve(m_indices.size() + 6 * request.srcrects.size());
+    for (size_t i = 0; i < request.srcrects.size(); ++i)
+    {
+      const Color tint = request.get_color(i);
+      const SDL_Color color = {
+        static_cast<Uint8>(tint.red * 255),
+        static_cast<Uint8>(tint.green * 255),
+        static_cast<Uint8>(tint.blue * 255),
+        static_cast<Uint8>(tint.alpha * 255)
+      };
+
+      add_quad(to_sdl_rect(request.srcrects[i]), to_sdl_rect(request.dstrects[i]),
+               request.angles[i], request.flip, color,
+               texture_width, texture_height);
+    }
+    return;
+  }
+
+  flush();
+#endif
+
   for (size_t i = 0; i < request.srcrects.size(); ++i)
   {
     const SDL_Rect& src_rect = to_sdl_rect(request.srcrects[i]);
     const SDL_Rect& dst_rect = to_sdl_rect(request.dstrects[i]);
 
-    Uint8 r = static_cast<Uint8>(request.color.red * 255);
-    Uint8 g = static_cast<Uint8>(request.color.green * 255);
-    Uint8 b = static_cast<Uint8>(request.color.blue * 255);
-    Uint8 a = static_cast<Uint8>(request.color.alpha * request.alpha * 255);
+    const Color color = request.get_color(i);
+    Uint8 r = static_cast<Uint8>(color.red * 255);
+    Uint8 g = static_cast<Uint8>(color.green * 255);
+    Uint8 b = static_cast<Uint8>(color.blue * 255);
+    Uint8 a = static_cast<Uint8>(color.alpha * 255);
 
     SDL_SetTextureColorMod(texture.get_texture(), r, g, b);
     SDL_SetTextureAlphaMod(texture.get_texture(), a);
@@ -264,63 +416,88 @@ SDLPainter::draw_texture(const TextureRequest& request)
 void
 SDLPainter::draw_gradient(const GradientRequest& request)
 {
+  flush();
+
   const Color& top = request.top;
   const Color& bottom = request.bottom;
   const GradientDirection& direction = request.direction;
   const Rectf& region = request.region;
 
-  // calculate the maximum number of steps needed for the gradient
+  const bool horizontal = (direction == HORIZONTAL || direction == HORIZONTAL_SECTOR);
+  SDL_Texture* texture = get_gradient_texture(top, bottom, horizontal);
+  if (!texture)
+    return;
+
+  // stretched over the region like the quad of the GL painter
+  const SDL_Rect dstrect = to_sdl_rect(region);
+  SDL_SetTextureBlendMode(texture, blend2sdl(request.blend));
+  SDL_RenderCopy(m_sdl_renderer, texture, nullptr, &dstrect);
+}
+
+SDL_Texture*
+SDLPainter::get_gradient_texture(const Color& top, const Color& bottom, bool horizontal)
+{
+  auto it = std::find_if(m_gradient_textures.begin(), m_gradient_textures.end(),
+                         [&top, &bottom, horizontal](const GradientTexture& gradient) {
+                           return gradient.horizontal == horizontal &&
+                             gradient.top == top && gradient.bottom == bottom;
+                         });
+  if (it != m_gradient_textures.end())
+  {
+    std::rotate(m_gradient_textures.begin(), it, it + 1);
+    return m_gradient_textures.front().texture;
+  }
+
+  // one texel per step of the largest channel difference, filtering
+  // smoothes out the rest when the texture gets stretched
   int n = static_cast<int>(std::max(std::max(fabsf(top.red - bottom.red),
                                              fabsf(top.green - bottom.green)),
                                     std::max(fabsf(top.blue - bottom.blue),
                                              fabsf(top.alpha - bottom.alpha))) * 255);
   n = std::max(n, 1);
-  for (int i = 0; i < n; ++i)
-  {
-    SDL_Rect rect;
-    if (direction == VERTICAL || direction == VERTICAL_SECTOR)
-    {
-      rect.x = static_cast<int>(region.get_left());
-      rect.y = static_cast<int>(region.get_bottom() * static_cast<float>(i) / static_cast<float>(n));
-      rect.w = static_cast<int>(region.get_right());
-      rect.h = static_cast<int>((region.get_bottom() * static_cast<float>(i+1) / static_cast<float>(n)) - static_cast<float>(rect.y));
-    }
-    else
-    {
-      rect.x = static_cast<int>(region.get_right() * static_cast<float>(i) / static_cast<float>(n));
-      rect.y = static_cast<int>(region.get_top());
-      rect.w = static_cast<int>((region.get_right() * static_cast<float>(i+1) / static_cast<float>(n)) - static_cast<float>(rect.x));
-      rect.h = static_cast<int>(region.get_bottom());
-    }
 
-    float p = static_cast<float>(i+1) / static_cast<float>(n);
-    Uint8 r, g, b, a;
+  const float top_channels[] = { top.red, top.green, top.blue, top.alpha };
+  const float bottom_channels[] = { bottom.red, bottom.green, bottom.blue, bottom.alpha };
 
-    if ( direction == HORIZONTAL_SECTOR || direction == VERTICAL_SECTOR)
-    {
-        float begin_percentage = region.get_left() * -1 / region.get_right();
-        r = static_cast<Uint8>(((1.0f - begin_percentage - p) * top.red + (p + begin_percentage) * bottom.red)  * 255);
-        g = static_cast<Uint8>(((1.0f - begin_percentage - p) * top.green + (p + begin_percentage) * bottom.green) * 255);
-        b = static_cast<Uint8>(((1.0f - begin_percentage - p) * top.blue + (p + begin_percentage) * bottom.blue) * 255);
-        a = static_cast<Uint8>(((1.0f - begin_percentage - p) * top.alpha + (p + begin_percentage) * bottom.alpha) * 255);
-    }
-    else
-    {
-        r = static_cast<Uint8>(((1.0f - p) * top.red + p * bottom.red)  * 255);
-        g = static_cast<Uint8>(((1.0f - p) * top.green + p * bottom.green) * 255);
-        b = static_cast<Uint8>(((1.0f - p) * top.blue + p * bottom.blue) * 255);
-        a = static_cast<Uint8>(((1.0f - p) * top.alpha + p * bottom.alpha) * 255);
+  std::vector<Uint32> pixels(n + 1);
+  for (int i = 0; i <= n; ++i)
+  {
+    const float p = static_cast<float>(i) / static_cast<float>(n);
+
+    // all four channels go through the same blend, which the
+    // compiler can do in one go
+    Uint32 channels[4];
+    for (int c = 0; c < 4; ++c) {
+      channels[c] = static_cast<Uint8>(((1.0f - p) * top_channels[c] + p * bottom_channels[c]) * 255);
     }
+    pixels[i] = (channels[3] << 24) | (channels[2] << 16) | (channels[1] << 8) | channels[0];
+  }
 
-    SDL_SetRenderDrawBlendMode(m_sdl_renderer, blend2sdl(request.blend));
-    SDL_SetRenderDrawColor(m_sdl_renderer, r, g, b, a);
-    SDL_RenderFillRect(m_sdl_renderer, &rect);
+  const int width = horizontal ? n + 1 : 1;
+  const int height = horizontal ? 1 : n + 1;
+  SDL_Texture* texture = SDL_CreateTexture(m_sdl_renderer, SDL_PIXELFORMAT_ABGR8888,
+                                           SDL_TEXTUREACCESS_STATIC, width, height);
+  if (!texture)
+  {
+    log_warning << "Couldn't create gradient texture: " << SDL_GetError() << std::endl;
+    return nullptr;
   }
+  SDL_UpdateTexture(texture, nullptr, pixels.data(), width * static_cast<int>(sizeof(Uint32)));
+
+  if (m_gradient_textures.size() >= MAX_GRADIENT_TEXTURES)
+  {
+    SDL_DestroyTexture(m_gradient_textures.back().texture);
+    m_gradient_textures.pop_back();
+  }
+  m_gradient_textures.insert(m_gradient_textures.begin(), { top, bottom, horizontal, texture });
+  return texture;
 }
 
 void
 SDLPainter::draw_filled_rect(const FillRectRequest& request)
 {
+  flush();
+
   SDL_Rect rect = to_sdl_rect(request.rect);
 
   Uint8 r = static_cast<Uint8>(request.color.red * 255);
@@ -391,6 +568,8 @@ SDLPainter::draw_filled_rect(const FillRectRequest& request)
 void
 SDLPainter::draw_inverse_ellipse(const InverseEllipseRequest& request)
 {
+  flush();
+
   float x = request.pos.x;
   float w = request.size.x;
   float h = request.size.y;
@@ -447,6 +626,8 @@ SDLPainter::draw_inverse_ellipse(const InverseEllipseRequest& request)
 void
 SDLPainter::draw_line(const LineRequest& request)
 {
+  flush();
+
   Uint8 r = static_cast<Uint8>(request.color.red * 255);
   Uint8 g = static_cast<Uint8>(request.color.green * 255);
   Uint8 b = static_cast<Uint8>(request.color.blue * 255);
@@ -462,6 +643,26 @@ SDLPainter::draw_line(const LineRequest& request)
   SDL_RenderDrawLine(m_sdl_renderer, x1, y1, x2, y2);
 }
 
+void
+SDLPainter::draw_lines(const LinesRequest& request)
+{
+  flush();
+
+  Uint8 r = static_cast<Uint8>(request.color.red * 255);
+  Uint8 g = static_cast<Uint8>(request.color.green * 255);
+  Uint8 b = static_cast<Uint8>(request.color.blue * 255);
+  Uint8 a = static_cast<Uint8>(request.color.alpha * 255);
+
+  SDL_SetRenderDrawBlendMode(m_sdl_renderer, SDL_BLENDMODE_BLEND);
+  SDL_SetRenderDrawColor(m_sdl_renderer, r, g, b, a);
+  for (size_t i = 0; i + 1 < request.count; i += 2)
+  {
+    SDL_RenderDrawLine(m_sdl_renderer,
+                       static_cast<int>(request.points[i].x), static_cast<int>(request.points[i].y),
+                       static_cast<int>(request.points[i + 1].x), static_cast<int>(request.points[i + 1].y));
+  }
+}
+
 namespace {
 
 using Edge = std::pair<Vector, Vector>;
@@ -517,6 +718,8 @@ draw_span_between_edges(SDL_Renderer* renderer, const Edge& e1, const Edge& e2)
 void
 SDLPainter::draw_triangle(const TriangleRequest& request)
 {
+  flush();
+
   Uint8 r = static_cast<Uint8>(request.color.red * 255);
   Uint8 g = static_cast<Uint8>(request.color.green * 255);
   Uint8 b = static_cast<Uint8>(request.color.blue * 255);
@@ -558,6 +761,8 @@ SDLPainter::draw_triangle(const TriangleRequest& request)
 void
 SDLPainter::clear(const Color& color)
 {
+  flush();
+
   SDL_SetRenderDrawColor(m_sdl_renderer, color.r8(), color.g8(), color.b8(), color.a8());
 
   if (m_cliprect)
@@ -575,6 +780,8 @@ SDLPainter::clear(const Color& color)
 void
 SDLPainter::set_clip_rect(const Rect& rect)
 {
+  flush();
+
   m_cliprect = SDL_Rect{ rect.left,
                          rect.top,
                          rect.get_width(),
@@ -590,6 +797,8 @@ SDLPainter::set_clip_rect(const Rect& rect)
 void
 SDLPainter::clear_clip_rect()
 {
+  flush();
+
   m_cliprect.reset();
 
   int ret = SDL_RenderSetClipRect(m_sdl_renderer, nullptr);
@@ -602,6 +811,8 @@ SDLPainter::clear_clip_rect()
 void
 SDLPainter::get_pixel(const GetPixelRequest& request) const
 {
+  flush();
+
   const Rect& rect = m_renderer.get_rect();
   const Size& logical_size = m_renderer.get_logical_size();
 
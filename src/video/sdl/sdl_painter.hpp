@@ -19,7 +19,9 @@
 
 #include "video/painter.hpp"
 
+#include <SDL.h>
 #include <boost/optional.hpp>
+#include <vector>
 
 class Renderer;
 class SDLScreenRenderer;
@@ -31,12 +33,15 @@ class SDLPainter final : public Painter
 {
 public:
   SDLPainter(SDLVideoSystem& video_system, Renderer& renderer, SDL_Renderer* sdl_renderer);
+  ~SDLPainter();
 
+  virtual void draw_requests(const std::vector<DrawingRequest*>& requests) override;
   virtual void draw_texture(const TextureRequest& request) override;
   virtual void draw_gradient(const GradientRequest& request) override;
   virtual void draw_filled_rect(const FillRectRequest& request) override;
   virtual void draw_inverse_ellipse(const InverseEllipseRequest& request) override;
   virtual void draw_line(const LineRequest& request) override;
+  virtual void draw_lines(const LinesRequest& request) override;
   virtual void draw_triangle(const TriangleRequest& request) override;
 
   virtual void clear(const Color& color) override;
@@ -45,12 +50,48 @@ public:
   virtual void set_clip_rect(const Rect& rect) override;
   virtual void clear_clip_rect() override;
 
+  /** Submits the textured quads collected by draw_texture(), needs
+      to be called before the render target changes */
+  void flush() const;
+
+private:
+  /** Returns a texture holding the gradient from top to bottom as a
+      single row or column, made on the first use of the colors */
+  SDL_Texture* get_gradient_texture(const Color& top, const Color& bottom, bool horizontal);
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+  void add_quad(const SDL_Rect& srcrect, const SDL_Rect& dstrect,
+                float angle, int flip, const SDL_Color& color,
+                float texture_width, float texture_height);
+#endif
+
 private:
   SDLVideoSystem& m_video_system;
   Renderer& m_renderer;
   SDL_Renderer* m_sdl_renderer;
   boost::optional<SDL_Rect> m_cliprect;
 
+  struct GradientTexture
+  {
+    Color top;
+    Color bottom;
+    bool horizontal;
+    SDL_Texture* texture;
+  };
+
+  /** Most recently used first */
+  std::vector<GradientTexture> m_gradient_textures;
+
+#if SDL_VERSION_ATLEAST(2,0,18)
+  /** Quads of adjacent TextureRequests sharing texture and blend mode,
+      drawn with a single SDL_RenderGeometry() call. Mutable as
+      get_pixel() has to flush them too. */
+  mutable std::vector<SDL_Vertex> m_vertices;
+  mutable std::vector<int> m_indices;
+  mutable SDL_Texture* m_batch_texture;
+  mutable SDL_BlendMode m_batch_blend;
+#endif
+
 private:
   SDLPainter(const SDLPainter&) = delete;
   SDLPainter& operator=(const SDLPainter&) = delete;
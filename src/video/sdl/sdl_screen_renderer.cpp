@@ -78,6 +78,7 @@ SDLScreenRenderer::start_draw()
 void
 SDLScreenRenderer::end_draw()
 {
+  m_painter.flush();
 }
 
 Rect
@@ -19,7 +19,10 @@
 #include <SDL.h>
 #include <sstream>
 
+#include "util/log.hpp"
 #include "video/sdl/sdl_screen_renderer.hpp"
+#include "video/sdl_surface.hpp"
+#include "video/sdl_surface_ptr.hpp"
 #include "video/video_system.hpp"
 
 SDLTexture::SDLTexture(SDL_Texture* texture, int width, int height, const Sampler& sampler) :
@@ -54,4 +57,36 @@ SDLTexture::~SDLTexture()
   SDL_DestroyTexture(m_texture);
 }
 
+void
+SDLTexture::update(const SDL_Surface& image, const Rect& rect)
+{
+  if (rect.empty())
+    return;
+
+  Uint32 format;
+  if (SDL_QueryTexture(m_texture, &format, nullptr, nullptr, nullptr) != 0)
+  {
+    log_warning << "couldn't query texture: " << SDL_GetError() << std::endl;
+    return;
+  }
+
+  // SDL_UpdateTexture() wants the pixels in the format of the texture
+  SDLSurfacePtr part = SDLSurface::create_rgba(rect.get_width(), rect.get_height());
+  SDL_Rect srcrect = rect.to_sdl();
+  SDL_SetSurfaceBlendMode(const_cast<SDL_Surface*>(&image), SDL_BLENDMODE_NONE);
+  SDL_BlitSurface(const_cast<SDL_Surface*>(&image), &srcrect, part.get(), nullptr);
+
+  SDLSurfacePtr convert(SDL_ConvertSurfaceFormat(part.get(), format, 0));
+  if (!convert)
+  {
+    log_warning << "couldn't convert texture update: " << SDL_GetError() << std::endl;
+    return;
+  }
+
+  if (SDL_UpdateTexture(m_texture, &srcrect, convert->pixels, convert->pitch) != 0)
+  {
+    log_warning << "couldn't update texture: " << SDL_GetError() << std::endl;
+  }
+}
+
 /* EOF */
@@ -77,6 +77,7 @@ SDLTextureRenderer::start_draw()
 void
 SDLTextureRenderer::end_draw()
 {
+  m_painter.flush();
   SDL_RenderSetScale(m_renderer, 1.0f, 1.0f);
   SDL_SetRenderTarget(m_renderer, nullptr);
 }
@@ -101,4 +102,10 @@ SDLTextureRenderer::get_texture() const
   return m_texture;
 }
 
+void
+SDLTextureRenderer::release_texture()
+{
+  m_texture.reset();
+}
+
 /* EOF */
@@ -46,6 +46,7 @@ public:
   virtual Size get_logical_size() const override;
 
   virtual TexturePtr get_texture() const override;
+  virtual void release_texture() override;
 
 private:
   SDL_Texture* get_sdl_texture() const;
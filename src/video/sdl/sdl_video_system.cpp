@@ -92,7 +92,8 @@ SDLVideoSystem::apply_config()
     m_viewport = Viewport::from_size(target_size, m_desktop_size);
   }
 
-  m_lightmap.reset(new SDLTextureRenderer(*this, m_sdl_renderer.get(), m_viewport.get_screen_size(), 5));
+  m_lightmap.reset(new SDLTextureRenderer(*this, m_sdl_renderer.get(), m_viewport.get_screen_size(),
+                                          get_lightmap_downscale(m_viewport.get_screen_size())));
 }
 
 Renderer&
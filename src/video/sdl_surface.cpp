@@ -23,6 +23,7 @@
 #include <savepng.h>
 
 #include "physfs/physfs_sdl.hpp"
+#include "supertux/load_stats.hpp"
 #include "util/log.hpp"
 
 SDLSurfacePtr
@@ -86,6 +87,7 @@ SDLSurface::from_file(const std::string& filename)
   }
   else
   {
+    g_load_stats.add_bytes_decoded(static_cast<uint64_t>(surface->h) * static_cast<uint64_t>(surface->pitch));
     return surface;
   }
 }
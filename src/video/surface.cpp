@@ -113,6 +113,12 @@ Surface::from_texture(const TexturePtr& texture)
   return SurfacePtr(new Surface(texture, TexturePtr(), NO_FLIP));
 }
 
+SurfacePtr
+Surface::from_texture(const TexturePtr& texture, const Rect& region, Flip flip)
+{
+  return SurfacePtr(new Surface(texture, TexturePtr(), region, flip));
+}
+
 Surface::~Surface()
 {
 }
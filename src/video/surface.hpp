@@ -36,6 +36,7 @@ class Surface final
 {
 public:
   static SurfacePtr from_texture(const TexturePtr& texture);
+  static SurfacePtr from_texture(const TexturePtr& texture, const Rect& region, Flip flip);
   static SurfacePtr from_file(const std::string& filename, const boost::optional<Rect>& rect = boost::none);
   static SurfacePtr from_reader(const ReaderMapping& mapping, const boost::optional<Rect>& rect = boost::none);
 
@@ -24,6 +24,8 @@
 #include "math/rect.hpp"
 #include "video/flip.hpp"
 
+struct SDL_Surface;
+
 /** This class is a wrapper around a texture handle. It stores the
     texture width and height and provides convenience functions for
     uploading SDL_Surfaces into the texture. */
@@ -47,9 +49,21 @@ public:
   virtual int get_image_width() const = 0;
   virtual int get_image_height() const = 0;
 
+  /** Compressed textures have no pixels to copy onto atlas pages */
+  virtual bool is_compressed() const { return false; }
+
+  /** Uploads the pixels of image inside rect to the same place in the
+      texture. image has to be the size of the texture's image, this
+      is for atlases that get filled while already in use. */
+  virtual void update(const SDL_Surface& image, const Rect& rect) = 0;
+
 private:
   boost::optional<Key> m_cache_key;
 
+  /** Set for plain images loaded with the default sampler, those can
+      be moved onto an atlas page, see TextureManager::pack() */
+  bool m_packable;
+
 private:
   Texture(const Texture&) = delete;
   Texture& operator=(const Texture&) = delete;
@@ -17,20 +17,34 @@
 #include "video/texture_manager.hpp"
 
 #include <SDL_image.h>
+#include <algorithm>
 #include <assert.h>
+#include <physfs.h>
+#include <set>
+#include <sexp/value.hpp>
 #include <sstream>
 
 #include "math/rect.hpp"
 #include "physfs/physfs_sdl.hpp"
+#include "physfs/util.hpp"
+#include "supertux/asset_manifest.hpp"
+#include "supertux/gameconfig.hpp"
+#include "supertux/globals.hpp"
+#include "supertux/load_stats.hpp"
 #include "util/file_system.hpp"
 #include "util/log.hpp"
+#include "util/profiler.hpp"
 #include "util/reader_document.hpp"
 #include "util/reader_mapping.hpp"
+#include "util/string_util.hpp"
 #include "video/color.hpp"
+#include "video/compressed_image.hpp"
 #include "video/gl.hpp"
 #include "video/sampler.hpp"
 #include "video/sdl_surface.hpp"
+#include "video/surface.hpp"
 #include "video/texture.hpp"
+#include "video/texture_packer.hpp"
 #include "video/video_system.hpp"
 
 namespace {
@@ -73,16 +87,141 @@ GLenum string2filter(const std::string& text)
   }
 }
 
+/** Largest atlas page pack() creates */
+const int MAX_PAGE_SIZE = 2048;
+
+/** Smallest atlas page pack() creates */
+const int MIN_PAGE_SIZE = 128;
+
+/** Pixels between images on an atlas page, so linear filtering
+    doesn't bleed neighbouring images into each other */
+const int PAGE_PADDING = 1;
+
+/** Seconds between two checks of reload_changed_images() */
+const float WATCH_INTERVAL = 1.0f;
+
+bool is_default_sampler(const Sampler& sampler)
+{
+  return
+    sampler.get_filter() == GL_LINEAR &&
+    sampler.get_wrap_s() == GL_CLAMP_TO_EDGE &&
+    sampler.get_wrap_t() == GL_CLAMP_TO_EDGE &&
+    sampler.get_animate() == Vector(0.0f, 0.0f);
+}
+
+void blit(SDL_Surface& src, const Rect& src_rect, SDL_Surface& dst, int x, int y)
+{
+  SDL_Rect src_sdl = { src_rect.left, src_rect.top, src_rect.get_width(), src_rect.get_height() };
+  SDL_Rect dst_sdl = { x, y, src_rect.get_width(), src_rect.get_height() };
+  if (SDL_BlitSurface(&src, &src_sdl, &dst, &dst_sdl) != 0)
+  {
+    std::ostringstream msg;
+    msg << "SDL_BlitSurface() call failed: " << SDL_GetError();
+    throw std::runtime_error(msg.str());
+  }
+}
+
+bool is_image_filename(const std::string& filename)
+{
+  return
+    StringUtil::has_suffix(filename, ".png") ||
+    StringUtil::has_suffix(filename, ".jpg");
+}
+
+/** Calls func for every string in sx, which are all the sexp
+    documents have to say about which files they use */
+template<typename F>
+void for_each_string(const sexp::Value& sx, F func)
+{
+  if (sx.is_string())
+  {
+    func(sx.as_string());
+  }
+  else if (sx.is_array())
+  {
+    for (const auto& item : sx.as_array()) {
+      for_each_string(item, func);
+    }
+  }
+  else if (sx.is_cons())
+  {
+    for_each_string(sx.get_car(), func);
+    for_each_string(sx.get_cdr(), func);
+  }
+}
+
+/** Returns an RGBA copy of surface if it has no color masks, e.g. a
+    palette image, otherwise nullptr */
+SDLSurfacePtr convert_maskless(const SDL_Surface& surface, const std::string& filename)
+{
+  if (surface.format->Rmask == 0 &&
+      surface.format->Gmask == 0 &&
+      surface.format->Bmask == 0 &&
+      surface.format->Amask == 0)
+  {
+    log_debug << "Wrong surface format for image " << filename << ". Compensating." << std::endl;
+    return SDLSurfacePtr(SDL_ConvertSurfaceFormat(const_cast<SDL_Surface*>(&surface), SDL_PIXELFORMAT_RGBA8888, 0));
+  }
+  return SDLSurfacePtr();
+}
+
+/** Returns a surface for rect of surface that shares its pixels */
+SDLSurfacePtr create_subimage(const SDL_Surface& surface, const Rect& rect)
+{
+  SDLSurfacePtr subimage(SDL_CreateRGBSurfaceFrom(static_cast<uint8_t*>(surface.pixels) +
+                                                  rect.top * surface.pitch +
+                                                  rect.left * surface.format->BytesPerPixel,
+                                                  rect.get_width(), rect.get_height(),
+                                                  surface.format->BitsPerPixel,
+                                                  surface.pitch,
+                                                  surface.format->Rmask,
+                                                  surface.format->Gmask,
+                                                  surface.format->Bmask,
+                                                  surface.format->Amask));
+  if (!subimage)
+  {
+    throw std::runtime_error("SDL_CreateRGBSurfaceFrom() call failed");
+  }
+  return subimage;
+}
+
+/** Textures are uploaded as RGBA, the driver may still pad them */
+size_t texture_bytes(const Texture& texture)
+{
+  return static_cast<size_t>(texture.get_texture_width()) * static_cast<size_t>(texture.get_texture_height()) * 4;
+}
+
 } // namespace
 
 TextureManager::TextureManager() :
   m_image_textures(),
-  m_surfaces()
+  m_surfaces(),
+  m_surfaces_bytes(0),
+  m_surfaces_clock(0),
+  m_atlas_pages(),
+  m_watched_mtimes(),
+  m_next_watch_time(0.0f),
+  m_prefetch_mutex(),
+  m_prefetched(),
+  m_prefetch_generation(0),
+  m_sprite_jobs()
 {
 }
 
 TextureManager::~TextureManager()
 {
+  // the sprite jobs add to m_prefetched, the image jobs only hold on
+  // to their filename
+  for (const auto& job : m_sprite_jobs) {
+    try {
+      JobSystem::current()->wait(job);
+    } catch (...) {
+      // they catch what they expect, nothing to report on shutdown
+    }
+  }
+  m_sprite_jobs.clear();
+  m_prefetched.clear();
+
   for (const auto& texture : m_image_textures)
   {
     if (!texture.second.expired())
@@ -92,6 +231,8 @@ TextureManager::~TextureManager()
   }
   m_image_textures.clear();
   m_surfaces.clear();
+  m_surfaces_bytes = 0;
+  m_atlas_pages.clear();
 }
 
 TexturePtr
@@ -184,6 +325,9 @@ TexturePtr
 TextureManager::get(const std::string& _filename)
 {
   std::string filename = FileSystem::normalize(_filename);
+  if (auto manifest = AssetManifest::current()) {
+    manifest->record_texture(filename);
+  }
   Texture::Key key(filename, Rect(0, 0, 0, 0));
   auto i = m_image_textures.find(key);
 
@@ -194,6 +338,7 @@ TextureManager::get(const std::string& _filename)
   if (!texture) {
     texture = create_image_texture(filename, Sampler());
     texture->m_cache_key = key;
+    texture->m_packable = !texture->is_compressed();
     m_image_textures[key] = texture;
   }
 
@@ -206,6 +351,9 @@ TextureManager::get(const std::string& _filename,
                     const Sampler& sampler)
 {
   std::string filename = FileSystem::normalize(_filename);
+  if (auto manifest = AssetManifest::current()) {
+    manifest->record_texture(filename);
+  }
   Texture::Key key;
   if (rect)
   {
@@ -232,12 +380,338 @@ TextureManager::get(const std::string& _filename,
       texture = create_image_texture(filename, sampler);
     }
     texture->m_cache_key = key;
+    texture->m_packable = is_default_sampler(sampler) && !texture->is_compressed();
     m_image_textures[key] = texture;
   }
 
   return texture;
 }
 
+void
+TextureManager::pack(std::vector<SurfacePtr>& surfaces)
+{
+  if (!g_config->texture_atlas)
+    return;
+
+  // collect the distinct textures that can be moved
+  std::vector<const Texture*> textures;
+  std::set<const Texture*> seen;
+  for (const auto& surface : surfaces)
+  {
+    if (!surface || surface->get_displacement_texture())
+      continue;
+
+    const Texture* texture = surface->get_texture().get();
+    if (!texture->m_packable || !texture->m_cache_key ||
+        texture->get_image_width() + 2 * PAGE_PADDING > MAX_PAGE_SIZE ||
+        texture->get_image_height() + 2 * PAGE_PADDING > MAX_PAGE_SIZE)
+      continue;
+
+    if (seen.insert(texture).second) {
+      textures.push_back(texture);
+    }
+  }
+
+  if (textures.size() < 2)
+    return;
+
+  // tallest first, so the rows of the packer stay tight
+  std::stable_sort(textures.begin(), textures.end(),
+                   [](const Texture* lhs, const Texture* rhs) {
+                     return lhs->get_image_height() > rhs->get_image_height();
+                   });
+
+  std::map<const Texture*, std::pair<TexturePtr, Rect> > placements;
+  size_t begin = 0;
+  while (begin < textures.size())
+  {
+    // make the page just large enough for the remaining images
+    int area = 0;
+    int min_size = MIN_PAGE_SIZE;
+    for (size_t i = begin; i < textures.size(); ++i)
+    {
+      const int width = textures[i]->get_image_width() + 2 * PAGE_PADDING;
+      const int height = textures[i]->get_image_height() + 2 * PAGE_PADDING;
+      area = std::min(area + width * height, MAX_PAGE_SIZE * MAX_PAGE_SIZE);
+      min_size = std::max(min_size, std::max(width, height));
+    }
+
+    int page_size = MIN_PAGE_SIZE;
+    while (page_size < MAX_PAGE_SIZE &&
+           (page_size < min_size || page_size * page_size < area + area / 4))
+    {
+      page_size *= 2;
+    }
+
+    TexturePacker packer(Size(page_size, page_size));
+    SDLSurfacePtr page = SDLSurface::create_rgba(page_size, page_size);
+
+    std::vector<std::pair<const Texture*, Rect> > placed;
+    size_t end = begin;
+    for (; end < textures.size(); ++end)
+    {
+      const Texture& texture = *textures[end];
+      const Size size(texture.get_image_width(), texture.get_image_height());
+
+      Rect cell;
+      if (!packer.insert(Size(size.width + 2 * PAGE_PADDING, size.height + 2 * PAGE_PADDING), cell))
+        break;
+
+      const Rect region(cell.left + PAGE_PADDING, cell.top + PAGE_PADDING, size);
+      try
+      {
+        copy_to_page(texture, *page, region);
+        placed.emplace_back(&texture, region);
+      }
+      catch (const std::exception& err)
+      {
+        log_warning << "Couldn't pack texture '" << std::get<0>(*texture.m_cache_key) << "': " << err.what() << std::endl;
+      }
+    }
+    assert(end > begin);
+    begin = end;
+
+    if (!placed.empty())
+    {
+      TexturePtr texture = VideoSystem::current()->new_texture(*page);
+      m_atlas_pages.push_back(texture);
+      for (const auto& placement : placed) {
+        placements[placement.first] = std::make_pair(texture, placement.second);
+      }
+    }
+  }
+
+  for (auto& surface : surfaces)
+  {
+    if (!surface)
+      continue;
+
+    auto it = placements.find(surface->get_texture().get());
+    if (it == placements.end())
+      continue;
+
+    const Rect& page_region = it->second.second;
+    const Rect region = surface->get_region();
+    surface = Surface::from_texture(it->second.first,
+                                    Rect(page_region.left + region.left,
+                                         page_region.top + region.top,
+                                         region.get_size()),
+                                    surface->get_flip());
+  }
+}
+
+void
+TextureManager::prefetch(const sexp::Value& sx, const std::string& basedir)
+{
+  std::set<std::string> filenames;
+  for_each_string(sx, [&filenames, &basedir](const std::string& text) {
+      if (is_image_filename(text) || StringUtil::has_suffix(text, ".sprite")) {
+        filenames.insert(FileSystem::join(basedir, text));
+      }
+    });
+
+  prefetch(std::vector<std::string>(filenames.begin(), filenames.end()));
+}
+
+void
+TextureManager::prefetch(const std::vector<std::string>& filenames)
+{
+  // only worth it when the decoding happens in the background
+  if (!JobSystem::current())
+    return;
+
+  m_sprite_jobs.erase(std::remove_if(m_sprite_jobs.begin(), m_sprite_jobs.end(),
+                                     [](const JobSystem::Handle& job) { return job.is_done(); }),
+                      m_sprite_jobs.end());
+
+  for (const auto& name : filenames)
+  {
+    const std::string filename = FileSystem::normalize(name);
+    if (m_surfaces.find(filename) != m_surfaces.end())
+      continue;
+
+    if (is_image_filename(filename)) {
+      prefetch_image(filename, m_prefetch_generation);
+    } else if (StringUtil::has_suffix(filename, ".sprite")) {
+      prefetch_sprite(filename);
+    }
+  }
+}
+
+void
+TextureManager::prefetch_image(const std::string& filename, int generation)
+{
+  std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+  if (generation != m_prefetch_generation ||
+      m_prefetched.find(filename) != m_prefetched.end())
+    return;
+
+  m_prefetched[filename] = JobSystem::async([filename]() -> SDLSurfacePtr {
+      // strings that merely look like filenames are common, no need to complain
+      if (!physfsutil::exists_cached(filename))
+        return SDLSurfacePtr();
+
+      try
+      {
+        return SDLSurface::from_file(filename);
+      }
+      catch (const std::exception&)
+      {
+        // the main thread loads it again and reports the error
+        return SDLSurfacePtr();
+      }
+    });
+}
+
+void
+TextureManager::prefetch_sprite(const std::string& filename)
+{
+  const int generation = m_prefetch_generation;
+  m_sprite_jobs.push_back(JobSystem::current()->schedule([this, filename, generation]{
+      if (!physfsutil::exists_cached(filename))
+        return;
+
+      try
+      {
+        const auto doc = ReaderDocument::from_file(filename);
+        const std::string basedir = doc.get_directory();
+        for_each_string(doc.get_sexp(), [this, &basedir, generation](const std::string& text) {
+            if (is_image_filename(text)) {
+              prefetch_image(FileSystem::normalize(FileSystem::join(basedir, text)), generation);
+            }
+          });
+      }
+      catch (const std::exception&)
+      {
+        // SpriteManager reports broken sprites when it loads them
+      }
+    }));
+}
+
+void
+TextureManager::drop_prefetched()
+{
+  std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+  m_prefetched.clear();
+  m_prefetch_generation += 1;
+}
+
+SDLSurfacePtr
+TextureManager::take_prefetched(const std::string& filename)
+{
+  std::future<SDLSurfacePtr> future;
+  {
+    std::lock_guard<std::mutex> lock(m_prefetch_mutex);
+    auto it = m_prefetched.find(filename);
+    if (it == m_prefetched.end())
+      return SDLSurfacePtr();
+
+    future = std::move(it->second);
+    m_prefetched.erase(it);
+  }
+
+  try
+  {
+    return future.get();
+  }
+  catch (const std::exception&)
+  {
+    // broken promise when the pool went away before the job ran
+    return SDLSurfacePtr();
+  }
+}
+
+SDLSurfacePtr
+TextureManager::load_surface(const std::string& filename)
+{
+  SDLSurfacePtr image = take_prefetched(filename);
+  if (image)
+    return image;
+
+  {
+    Profiler::Scope profile_scope("load image");
+    image = SDLSurface::from_file(filename);
+  }
+  if (!image)
+  {
+    std::ostringstream msg;
+    msg << "Couldn't load image '" << filename << "' :" << SDL_GetError();
+    throw std::runtime_error(msg.str());
+  }
+  return image;
+}
+
+void
+TextureManager::copy_to_page(const Texture& texture, SDL_Surface& page, const Rect& region)
+{
+  const std::string& filename = std::get<0>(*texture.m_cache_key);
+  Rect src_rect = std::get<1>(*texture.m_cache_key);
+
+  // whole images are not kept in m_surfaces, so load them on the fly
+  SDLSurfacePtr whole_image;
+  SDL_Surface* src;
+  if (src_rect.empty())
+  {
+    whole_image = SDLSurface::from_file(filename);
+    if (!whole_image)
+    {
+      std::ostringstream msg;
+      msg << "Couldn't load image '" << filename << "' :" << SDL_GetError();
+      throw std::runtime_error(msg.str());
+    }
+    src = whole_image.get();
+    src_rect = Rect(0, 0, src->w, src->h);
+  }
+  else
+  {
+    src = const_cast<SDL_Surface*>(&get_surface(filename));
+  }
+
+  if (src_rect.get_size() != region.get_size() ||
+      !Rect(0, 0, src->w, src->h).contains(src_rect))
+  {
+    throw std::runtime_error("image doesn't match its texture");
+  }
+
+  // copy the pixels as they are, alpha included
+  SDL_BlendMode blend_mode;
+  SDL_GetSurfaceBlendMode(src, &blend_mode);
+  SDL_SetSurfaceBlendMode(src, SDL_BLENDMODE_NONE);
+
+  const int x = region.left;
+  const int y = region.top;
+  const int w = src_rect.get_width();
+  const int h = src_rect.get_height();
+  const int l = src_rect.left;
+  const int t = src_rect.top;
+  const int r = src_rect.right - 1;
+  const int b = src_rect.bottom - 1;
+
+  try
+  {
+    blit(*src, src_rect, page, x, y);
+
+    // edges
+    blit(*src, Rect(l, t, l + 1, t + h), page, x - 1, y);
+    blit(*src, Rect(r, t, r + 1, t + h), page, x + w, y);
+    blit(*src, Rect(l, t, l + w, t + 1), page, x, y - 1);
+    blit(*src, Rect(l, b, l + w, b + 1), page, x, y + h);
+
+    // corners
+    blit(*src, Rect(l, t, l + 1, t + 1), page, x - 1, y - 1);
+    blit(*src, Rect(r, t, r + 1, t + 1), page, x + w, y - 1);
+    blit(*src, Rect(l, b, l + 1, b + 1), page, x - 1, y + h);
+    blit(*src, Rect(r, b, r + 1, b + 1), page, x + w, y + h);
+  }
+  catch (...)
+  {
+    SDL_SetSurfaceBlendMode(src, blend_mode);
+    throw;
+  }
+
+  SDL_SetSurfaceBlendMode(src, blend_mode);
+}
+
 void
 TextureManager::reap_cache_entry(const Texture::Key& key)
 {
@@ -270,57 +744,61 @@ TextureManager::create_image_texture(const std::string& filename, const Rect& re
 const SDL_Surface&
 TextureManager::get_surface(const std::string& filename)
 {
+  m_surfaces_clock += 1;
+
   auto i = m_surfaces.find(filename);
   if (i != m_surfaces.end())
   {
-    return *i->second;
+    i->second.last_use = m_surfaces_clock;
+    return *i->second.surface;
   }
   else
   {
-    SDLSurfacePtr image = SDLSurface::from_file(filename);
-    if (!image)
-    {
-      std::ostringstream msg;
-      msg << "Couldn't load image '" << filename << "' :" << SDL_GetError();
-      throw std::runtime_error(msg.str());
-    }
+    SDLSurfacePtr surface = load_surface(filename);
+    const size_t bytes = static_cast<size_t>(surface->pitch) * static_cast<size_t>(surface->h);
+    evict_surfaces(bytes);
 
-    return *(m_surfaces[filename] = std::move(image));
+    SurfaceEntry& entry = m_surfaces[filename];
+    entry.surface = std::move(surface);
+    entry.bytes = bytes;
+    entry.last_use = m_surfaces_clock;
+    m_surfaces_bytes += bytes;
+    return *entry.surface;
   }
 }
 
-TexturePtr
-TextureManager::create_image_texture_raw(const std::string& filename, const Rect& rect, const Sampler& sampler)
+void
+TextureManager::evict_surfaces(size_t extra_bytes)
 {
-  const SDL_Surface& src_surface = get_surface(filename);
+  if (g_config->texture_cache_budget <= 0)
+    return;
 
-  SDLSurfacePtr convert;
-  if (src_surface.format->Rmask == 0 &&
-      src_surface.format->Gmask == 0 &&
-      src_surface.format->Bmask == 0 &&
-      src_surface.format->Amask == 0)
+  const size_t budget = static_cast<size_t>(g_config->texture_cache_budget) * 1024 * 1024;
+  while (!m_surfaces.empty() && m_surfaces_bytes + extra_bytes > budget)
   {
-    log_debug << "Wrong surface format for image " << filename << ". Compensating." << std::endl;
-    convert.reset(SDL_ConvertSurfaceFormat(const_cast<SDL_Surface*>(&src_surface), SDL_PIXELFORMAT_RGBA8888, 0));
+    auto oldest = m_surfaces.begin();
+    for (auto it = m_surfaces.begin(); it != m_surfaces.end(); ++it) {
+      if (it->second.last_use < oldest->second.last_use) {
+        oldest = it;
+      }
+    }
+
+    log_debug << "evicting image '" << oldest->first << "' (" << oldest->second.bytes << " bytes)" << std::endl;
+    m_surfaces_bytes -= oldest->second.bytes;
+    m_surfaces.erase(oldest);
   }
+}
 
-  const SDL_Surface& surface = convert ? *convert : src_surface;
+TexturePtr
+TextureManager::create_image_texture_raw(const std::string& filename, const Rect& rect, const Sampler& sampler)
+{
+  LoadStats::Scope load_scope(LoadStats::TEXTURES);
 
-  SDLSurfacePtr subimage(SDL_CreateRGBSurfaceFrom(static_cast<uint8_t*>(surface.pixels) +
-                                                  rect.top * surface.pitch +
-                                                  rect.left * surface.format->BytesPerPixel,
-                                                  rect.get_width(), rect.get_height(),
-                                                  surface.format->BitsPerPixel,
-                                                  surface.pitch,
-                                                  surface.format->Rmask,
-                                                  surface.format->Gmask,
-                                                  surface.format->Bmask,
-                                                  surface.format->Amask));
-  if (!subimage)
-  {
-    throw std::runtime_error("SDL_CreateRGBSurfaceFrom() call failed");
-  }
+  const SDL_Surface& src_surface = get_surface(filename);
+  SDLSurfacePtr convert = convert_maskless(src_surface, filename);
+  const SDL_Surface& surface = convert ? *convert : src_surface;
 
+  SDLSurfacePtr subimage = create_subimage(surface, rect);
   return VideoSystem::current()->new_texture(*subimage, sampler);
 }
 
@@ -341,19 +819,46 @@ TextureManager::create_image_texture(const std::string& filename, const Sampler&
 TexturePtr
 TextureManager::create_image_texture_raw(const std::string& filename, const Sampler& sampler)
 {
-  SDLSurfacePtr image = SDLSurface::from_file(filename);
-  if (!image)
+  LoadStats::Scope load_scope(LoadStats::TEXTURES);
+
+  if (g_config->compressed_textures)
   {
-    std::ostringstream msg;
-    msg << "Couldn't load image '" << filename << "' :" << SDL_GetError();
-    throw std::runtime_error(msg.str());
+    TexturePtr texture = create_compressed_texture(filename, sampler);
+    if (texture)
+    {
+      // the decoded image isn't needed after all
+      take_prefetched(filename);
+      return texture;
+    }
   }
-  else
+
+  SDLSurfacePtr image = load_surface(filename);
+  TexturePtr texture = VideoSystem::current()->new_texture(*image, sampler);
+  image.reset(nullptr);
+  return texture;
+}
+
+TexturePtr
+TextureManager::create_compressed_texture(const std::string& filename, const Sampler& sampler)
+{
+  const std::string ktx_filename = FileSystem::strip_extension(filename) + ".ktx";
+  if (!physfsutil::exists_cached(ktx_filename))
+    return {};
+
+  try
   {
-    TexturePtr texture = VideoSystem::current()->new_texture(*image, sampler);
-    image.reset(nullptr);
+    auto image = CompressedImage::from_file(ktx_filename);
+    TexturePtr texture = VideoSystem::current()->new_compressed_texture(*image, sampler);
+    if (!texture) {
+      log_debug << "compressed format of '" << ktx_filename << "' not supported, using '" << filename << "'" << std::endl;
+    }
     return texture;
   }
+  catch (const std::exception& err)
+  {
+    log_warning << err.what() << std::endl;
+    return {};
+  }
 }
 
 TexturePtr
@@ -385,22 +890,134 @@ TextureManager::create_dummy_texture()
   }
 }
 
+size_t
+TextureManager::get_texture_bytes() const
+{
+  size_t bytes = 0;
+  for (const auto& it : m_image_textures) {
+    if (auto texture = it.second.lock()) {
+      bytes += texture_bytes(*texture);
+    }
+  }
+  for (const auto& page : m_atlas_pages) {
+    bytes += texture_bytes(*page);
+  }
+  return bytes;
+}
+
+size_t
+TextureManager::get_texture_count() const
+{
+  size_t count = m_atlas_pages.size();
+  for (const auto& it : m_image_textures) {
+    if (!it.second.expired()) {
+      count += 1;
+    }
+  }
+  return count;
+}
+
+void
+TextureManager::reload_changed_images(float time)
+{
+  if (time < m_next_watch_time)
+    return;
+  m_next_watch_time = time + WATCH_INTERVAL;
+
+  std::map<std::string, std::vector<TexturePtr> > textures;
+  for (const auto& it : m_image_textures)
+  {
+    TexturePtr texture = it.second.lock();
+    if (texture && !texture->is_compressed()) {
+      textures[std::get<0>(it.first)].push_back(std::move(texture));
+    }
+  }
+
+  std::map<std::string, int64_t> mtimes;
+  for (const auto& it : textures)
+  {
+    const std::string& filename = it.first;
+
+    PHYSFS_Stat statbuf;
+    if (!PHYSFS_stat(filename.c_str(), &statbuf))
+      continue;
+    mtimes[filename] = statbuf.modtime;
+
+    // files seen for the first time are only remembered
+    auto old = m_watched_mtimes.find(filename);
+    if (old != m_watched_mtimes.end() && old->second != statbuf.modtime) {
+      reload_image(filename, it.second);
+    }
+  }
+
+  // forgets the files nobody uses anymore
+  m_watched_mtimes = std::move(mtimes);
+}
+
+void
+TextureManager::reload_image(const std::string& filename, const std::vector<TexturePtr>& textures)
+{
+  SDLSurfacePtr image = SDLSurface::from_file(filename);
+  if (!image)
+  {
+    log_warning << "Couldn't reload image '" << filename << "': " << SDL_GetError() << std::endl;
+    return;
+  }
+
+  // textures cut from it later have to see the new image too
+  auto cached = m_surfaces.find(filename);
+  if (cached != m_surfaces.end())
+  {
+    m_surfaces_bytes -= cached->second.bytes;
+    m_surfaces.erase(cached);
+  }
+
+  SDLSurfacePtr convert = convert_maskless(*image, filename);
+  const SDL_Surface& surface = convert ? *convert : *image;
+
+  for (const auto& texture : textures)
+  {
+    Rect rect = std::get<1>(*texture->m_cache_key);
+    if (rect.empty()) {
+      rect = Rect(0, 0, surface.w, surface.h);
+    }
+
+    if (rect.get_width() != texture->get_image_width() ||
+        rect.get_height() != texture->get_image_height() ||
+        rect.right > surface.w || rect.bottom > surface.h)
+    {
+      log_warning << "Size of '" << filename << "' changed, restart to see the new image" << std::endl;
+      continue;
+    }
+
+    SDLSurfacePtr subimage = create_subimage(surface, rect);
+    texture->update(*subimage, Rect(0, 0, rect.get_width(), rect.get_height()));
+  }
+
+  log_info << "Reloaded image '" << filename << "'" << std::endl;
+}
+
 void
 TextureManager::debug_print(std::ostream& out) const
 {
   size_t total_texture_pixels = 0;
+  size_t total_texture_bytes = 0;
   out << "textures:begin" << std::endl;
   for(const auto& it : m_image_textures)
   {
     const auto& key = it.first;
 
-    if (it.second.lock()) {
+    size_t bytes = 0;
+    if (auto texture = it.second.lock()) {
       total_texture_pixels += std::get<1>(key).get_area();
+      bytes = texture_bytes(*texture);
+      total_texture_bytes += bytes;
     }
 
     out << "  texture "
         << " filename:" << std::get<0>(key) << " " << std::get<1>(key)
-        << " " << "use_count:" << it.second.use_count() << std::endl;
+        << " " << "use_count:" << it.second.use_count()
+        << " bytes:" << bytes << std::endl;
   }
   out << "textures:end" << std::endl;
 
@@ -409,18 +1026,31 @@ TextureManager::debug_print(std::ostream& out) const
   for(const auto& it : m_surfaces)
   {
     const auto& filename = it.first;
-    const auto& surface = it.second;
+    const auto& surface = it.second.surface;
 
     total_surface_pixels += surface->w * surface->h;
-    out << "  surface filename:" << filename << " " << surface->w << "x" << surface->h << std::endl;
+    out << "  surface filename:" << filename << " " << surface->w << "x" << surface->h
+        << " bytes:" << it.second.bytes
+        << " age:" << m_surfaces_clock - it.second.last_use << std::endl;
   }
   out << "surfaces:end" << std::endl;
 
+  size_t total_atlas_bytes = 0;
+  for (const auto& page : m_atlas_pages) {
+    total_atlas_bytes += texture_bytes(*page);
+  }
+
   out << "total texture count:" << m_image_textures.size() << std::endl;
   out << "total texture pixels:" << total_texture_pixels << std::endl;
+  out << "total texture bytes:" << total_texture_bytes << std::endl;
 
   out << "total surface count:" << m_surfaces.size() << std::endl;
   out << "total surface pixels:" << total_surface_pixels << std::endl;
+  out << "total surface bytes:" << m_surfaces_bytes
+      << " budget:" << g_config->texture_cache_budget << "MB" << std::endl;
+
+  out << "total atlas page count:" << m_atlas_pages.size() << std::endl;
+  out << "total atlas page bytes:" << total_atlas_bytes << std::endl;
 }
 
 /* EOF */
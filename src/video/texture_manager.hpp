@@ -18,18 +18,23 @@
 #define HEADER_SUPERTUX_VIDEO_TEXTURE_MANAGER_HPP
 
 #include <config.h>
+#include <future>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <ostream>
 #include <set>
+#include <stdint.h>
 #include <string>
 #include <vector>
 #include <boost/optional.hpp>
 
 #include "math/rect.hpp"
 #include "util/currenton.hpp"
+#include "util/job_system.hpp"
 #include "video/sampler.hpp"
 #include "video/sdl_surface_ptr.hpp"
+#include "video/surface_ptr.hpp"
 #include "video/texture.hpp"
 #include "video/texture_ptr.hpp"
 
@@ -37,6 +42,10 @@ class GLTexture;
 class ReaderMapping;
 struct SDL_Surface;
 
+namespace sexp {
+class Value;
+} // namespace sexp
+
 class TextureManager final : public Currenton<TextureManager>
 {
 public:
@@ -52,10 +61,66 @@ public:
                  const boost::optional<Rect>& rect,
                  const Sampler& sampler = Sampler());
 
+  /** Moves the images of the given surfaces onto a few shared atlas
+      pages and replaces the surfaces with ones pointing to the pages,
+      so they can be drawn without switching textures. Surfaces that
+      use a displacement texture, a custom sampler or that weren't
+      loaded from a file are left alone. Does nothing unless enabled
+      in the config. */
+  void pack(std::vector<SurfacePtr>& surfaces);
+
+  /** Starts decoding the images referenced by the given document on
+      worker threads, so the texture can later be created without
+      waiting for the disk and the decoder. Strings ending in an image
+      extension are taken as image files, ones ending in ".sprite" are
+      parsed on a worker and their images prefetched as well. Relative
+      names are resolved against basedir, sprite images against the
+      directory of their sprite. */
+  void prefetch(const sexp::Value& sx, const std::string& basedir);
+
+  /** Starts decoding the given image and sprite files */
+  void prefetch(const std::vector<std::string>& filenames);
+
+  /** Frees prefetched images nobody asked for */
+  void drop_prefetched();
+
+  /** Checks the files of the live textures for changes, at most once
+      per second of time, and uploads the new images into the
+      existing textures, so surfaces using them stay valid. Meant for
+      developer mode, textures that changed size, compressed textures
+      and images already moved onto atlas pages are not reloaded. */
+  void reload_changed_images(float time);
+
   void debug_print(std::ostream& out) const;
 
+  /** Bytes of video memory taken by live textures and atlas pages,
+      assuming RGBA */
+  size_t get_texture_bytes() const;
+  size_t get_texture_count() const;
+
+  /** Bytes of the whole images kept around to cut textures from */
+  size_t get_surface_bytes() const { return m_surfaces_bytes; }
+  size_t get_surface_count() const { return m_surfaces.size(); }
+
 private:
+  /** Can be called from any thread, requests from before the last
+      drop_prefetched() are ignored */
+  void prefetch_image(const std::string& filename, int generation);
+  void prefetch_sprite(const std::string& filename);
+
+  /** Returns the image decoded by a worker, waiting for it if it
+      isn't done yet, or nullptr if filename wasn't prefetched or
+      failed to load */
+  SDLSurfacePtr take_prefetched(const std::string& filename);
+
+  /** Loads the image, prefetched or not, throws on error */
+  SDLSurfacePtr load_surface(const std::string& filename);
+
   const SDL_Surface& get_surface(const std::string& filename);
+
+  /** Frees the least recently used surfaces until m_surfaces_bytes
+      plus extra_bytes fit into the budget from the config */
+  void evict_surfaces(size_t extra_bytes);
   void reap_cache_entry(const Texture::Key& key);
 
   TexturePtr create_image_texture(const std::string& filename, const Rect& rect, const Sampler& sampler);
@@ -67,11 +132,50 @@ private:
   TexturePtr create_image_texture_raw(const std::string& filename, const Sampler& sampler);
   TexturePtr create_image_texture_raw(const std::string& filename, const Rect& rect, const Sampler& sampler);
 
+  /** Returns nullptr unless there is a .ktx file next to filename
+      in a format the video system supports */
+  TexturePtr create_compressed_texture(const std::string& filename, const Sampler& sampler);
+
   TexturePtr create_dummy_texture();
 
+  void reload_image(const std::string& filename, const std::vector<TexturePtr>& textures);
+
+  /** Copies the image of texture to region on page, repeating its
+      edge pixels into the padding around it */
+  void copy_to_page(const Texture& texture, SDL_Surface& page, const Rect& region);
+
 private:
   std::map<Texture::Key, std::weak_ptr<Texture> > m_image_textures;
-  std::map<std::string, SDLSurfacePtr> m_surfaces;
+  struct SurfaceEntry
+  {
+    SDLSurfacePtr surface;
+    size_t bytes;
+
+    /** Value of m_surfaces_clock when last used */
+    uint64_t last_use;
+  };
+
+  /** Whole images that textures of parts of them are cut from */
+  std::map<std::string, SurfaceEntry> m_surfaces;
+  size_t m_surfaces_bytes;
+  uint64_t m_surfaces_clock;
+
+  /** Atlas pages created by pack() */
+  std::vector<TexturePtr> m_atlas_pages;
+
+  /** Modification times seen by reload_changed_images() */
+  std::map<std::string, int64_t> m_watched_mtimes;
+  float m_next_watch_time;
+
+  /** Images being decoded by or waiting for the JobSystem, the
+      workers add to it while the main thread takes from it */
+  std::mutex m_prefetch_mutex;
+  std::map<std::string, std::future<SDLSurfacePtr> > m_prefetched;
+  int m_prefetch_generation;
+
+  /** Jobs reading sprites for prefetch(), these use this manager
+      and are waited for on destruction */
+  std::vector<JobSystem::Handle> m_sprite_jobs;
 
 private:
   TextureManager(const TextureManager&) = delete;
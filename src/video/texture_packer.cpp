@@ -0,0 +1,52 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include "video/texture_packer.hpp"
+
+#include <algorithm>
+
+TexturePacker::TexturePacker(const Size& page_size) :
+  m_page_size(page_size),
+  m_x(0),
+  m_y(0),
+  m_row_height(0)
+{
+}
+
+bool
+TexturePacker::insert(const Size& size, Rect& region)
+{
+  if (size.width > m_page_size.width || size.height > m_page_size.height)
+    return false;
+
+  // start a new row when the current one is full
+  if (m_x + size.width > m_page_size.width)
+  {
+    m_x = 0;
+    m_y += m_row_height;
+    m_row_height = 0;
+  }
+
+  if (m_y + size.height > m_page_size.height)
+    return false;
+
+  region = Rect(m_x, m_y, size);
+  m_x += size.width;
+  m_row_height = std::max(m_row_height, size.height);
+  return true;
+}
+
+/* EOF */
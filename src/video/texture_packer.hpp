@@ -0,0 +1,53 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#ifndef HEADER_SUPERTUX_VIDEO_TEXTURE_PACKER_HPP
+#define HEADER_SUPERTUX_VIDEO_TEXTURE_PACKER_HPP
+
+#include "math/rect.hpp"
+#include "math/size.hpp"
+
+/** Places rectangles on an atlas page row by row. Works best when
+    the rectangles are inserted tallest first. */
+class TexturePacker final
+{
+public:
+  TexturePacker(const Size& page_size);
+
+  /** Finds a free spot for a rectangle of the given size, returns
+      false if the page is full */
+  bool insert(const Size& size, Rect& region);
+
+  const Size& get_page_size() const { return m_page_size; }
+
+private:
+  Size m_page_size;
+
+  /** Top left corner of the free space in the current row */
+  int m_x;
+  int m_y;
+
+  /** Height of the tallest rectangle in the current row */
+  int m_row_height;
+
+private:
+  TexturePacker(const TexturePacker&) = delete;
+  TexturePacker& operator=(const TexturePacker&) = delete;
+};
+
+#endif
+
+/* EOF */
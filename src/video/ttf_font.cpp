@@ -25,6 +25,7 @@
 #include "physfs/physfs_sdl.hpp"
 #include "video/canvas.hpp"
 #include "video/surface.hpp"
+#include "video/ttf_glyph_atlas.hpp"
 #include "video/ttf_surface_manager.hpp"
 
 TTFFont::TTFFont(const std::string& filename, int font_size, float line_spacing, int shadow_size, int border) :
@@ -33,7 +34,9 @@ TTFFont::TTFFont(const std::string& filename, int font_size, float line_spacing,
   m_font_size(font_size),
   m_line_spacing(line_spacing),
   m_shadow_size(shadow_size),
-  m_border(border)
+  m_border(border),
+  m_glyph_atlas(),
+  m_width_cache()
 {
   m_font = TTF_OpenFontRW(get_physfs_SDLRWops(m_filename), 1, font_size);
   if (!m_font)
@@ -49,12 +52,26 @@ TTFFont::~TTFFont()
   TTF_CloseFont(m_font);
 }
 
+void
+TTFFont::enable_glyph_atlas()
+{
+  if (!m_glyph_atlas) {
+    m_glyph_atlas.reset(new TTFGlyphAtlas(*this));
+    // atlas text is laid out without kerning
+    m_width_cache.clear();
+  }
+}
+
 float
 TTFFont::get_text_width(const std::string& text) const
 {
   if (text.empty())
     return 0.0f;
 
+  float cached_width;
+  if (m_width_cache.get(text, cached_width))
+    return cached_width;
+
   float max_width = 0.0f;
 
   LineIterator iter(text);
@@ -62,6 +79,12 @@ TTFFont::get_text_width(const std::string& text) const
   {
     const std::string& line = iter.get();
 
+    if (m_glyph_atlas)
+    {
+      max_width = std::max(max_width, static_cast<float>(m_glyph_atlas->get_line_width(line)));
+      continue;
+    }
+
     // Since get_cached_surface_width() takes a surface from the cache
     // instead of generating it from scratch,
     // it should be faster than doing a whole layout.
@@ -79,6 +102,7 @@ TTFFont::get_text_width(const std::string& text) const
     max_width = std::max(max_width, static_cast<float>(line_width));
   }
 
+  m_width_cache.set(text, max_width);
   return max_width;
 }
 
@@ -108,7 +132,22 @@ TTFFont::draw_text(Canvas& canvas, const std::string& text,
   {
     const std::string& line = iter.get();
 
-    if (!line.empty())
+    if (!line.empty() && m_glyph_atlas)
+    {
+      Vector new_pos(pos.x, last_y);
+
+      if (alignment == ALIGN_CENTER)
+      {
+        new_pos.x -= static_cast<float>(m_glyph_atlas->get_line_width(line)) / 2.0f;
+      }
+      else if (alignment == ALIGN_RIGHT)
+      {
+        new_pos.x -= static_cast<float>(m_glyph_atlas->get_line_width(line));
+      }
+
+      m_glyph_atlas->draw_line(canvas, line, new_pos.floor(), color, layer);
+    }
+    else if (!line.empty())
     {
       TTFSurfacePtr ttf_surface = TTFSurfaceManager::current()->create_surface(*this, line);
 
@@ -131,53 +170,4 @@ TTFFont::draw_text(Canvas& canvas, const std::string& text,
   }
 }
 
-std::string
-TTFFont::wrap_to_width(const std::string& text, float width, std::string* overflow)
-{
-  std::string s = text;
-
-  // if text is already smaller, return full text
-  if (get_text_width(s) <= width) {
-    if (overflow) *overflow = "";
-    return s;
-  }
-
-  // if we can find a whitespace character to break at, return text up to this character
-  for (int i = static_cast<int>(s.length()) - 1; i >= 0; i--) {
-    std::string s2 = s.substr(0,i);
-    if (s[i] != ' ') continue;
-    if (get_text_width(s2) <= width) {
-      if (overflow) *overflow = s.substr(i+1);
-      return s.substr(0, i);
-    }
-  }
-
-  // hard-wrap at width, taking care of multibyte characters
-  unsigned int char_bytes = 1;
-  for (int i = 0; i < static_cast<int>(s.length()); i += char_bytes) {
-
-    // calculate the number of bytes in the character
-    char_bytes = 1;
-    auto iter = s.begin() + i + 1; // iter points to next byte
-    while ( iter != s.end() && (*iter & 128) && !(*iter & 64) ) {
-      // this is a "continuation" byte in the form 10xxxxxx
-      ++iter;
-      ++char_bytes;
-    }
-
-    // check whether text now goes over allowed width, and if so
-    // return everything up to the character and put the rest in the overflow
-    std::string s2 = s.substr(0,i+char_bytes);
-    if (get_text_width(s2) > width) {
-      if (i == 0) i += char_bytes; // edge case when even one char is too wide
-      if (overflow) *overflow = s.substr(i);
-      return s.substr(0, i);
-    }
-  }
-
-  // should in theory never reach here
-  if (overflow) *overflow = "";
-  return s;
-}
-
 /* EOF */
@@ -20,11 +20,14 @@
 
 #include <SDL_ttf.h>
 
+#include <memory>
+
 #include "video/color.hpp"
 #include "video/font.hpp"
 
 class Canvas;
 class Painter;
+class TTFGlyphAtlas;
 class Vector;
 
 class TTFFont final : public Font
@@ -44,8 +47,6 @@ public:
   virtual float get_text_width(const std::string& text) const override;
   virtual float get_text_height(const std::string& text) const override;
 
-  virtual std::string wrap_to_width(const std::string& text, float width, std::string* overflow) override;
-
   virtual void draw_text(Canvas& canvas, const std::string& text,
                          const Vector& pos, FontAlignment alignment, int layer, const Color& color) override;
 
@@ -54,6 +55,11 @@ public:
 
   TTF_Font* get_ttf_font() const { return m_font; }
 
+  /** Draw text glyph by glyph from an atlas instead of caching a
+      surface for each string, use for fonts that show constantly
+      changing text */
+  void enable_glyph_atlas();
+
 private:
   TTF_Font* m_font;
   std::string m_filename;
@@ -61,6 +67,8 @@ private:
   float m_line_spacing;
   int m_shadow_size;
   int m_border;
+  std::unique_ptr<TTFGlyphAtlas> m_glyph_atlas;
+  mutable TextWidthCache m_width_cache;
 
 private:
   TTFFont(const TTFFont&) = delete;
@@ -0,0 +1,274 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include "video/ttf_glyph_atlas.hpp"
+
+#include <SDL_ttf.h>
+
+#include <algorithm>
+
+#include "util/log.hpp"
+#include "util/utf8_iterator.hpp"
+#include "video/canvas.hpp"
+#include "video/sdl_surface.hpp"
+#include "video/surface.hpp"
+#include "video/texture.hpp"
+#include "video/ttf_font.hpp"
+#include "video/ttf_surface.hpp"
+#include "video/video_system.hpp"
+
+namespace {
+
+const int PAGE_SIZE = 512;
+
+/** Keeps linear filtering from bleeding neighbouring glyphs in */
+const int PADDING = 1;
+
+std::string encode_utf8(uint32_t codepoint)
+{
+  std::string result;
+  if (codepoint < 0x80) {
+    result += static_cast<char>(codepoint);
+  } else if (codepoint < 0x800) {
+    result += static_cast<char>(0xC0 | (codepoint >> 6));
+    result += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else if (codepoint < 0x10000) {
+    result += static_cast<char>(0xE0 | (codepoint >> 12));
+    result += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    result += static_cast<char>(0x80 | (codepoint & 0x3F));
+  } else {
+    result += static_cast<char>(0xF0 | (codepoint >> 18));
+    result += static_cast<char>(0x80 | ((codepoint >> 12) & 0x3F));
+    result += static_cast<char>(0x80 | ((codepoint >> 6) & 0x3F));
+    result += static_cast<char>(0x80 | (codepoint & 0x3F));
+  }
+  return result;
+}
+
+void blit(SDL_Surface& src, SDL_Surface& dst, const Rect& rect)
+{
+  SDL_SetSurfaceBlendMode(&src, SDL_BLENDMODE_NONE);
+  SDL_Rect dstrect = rect.to_sdl();
+  SDL_BlitSurface(&src, nullptr, &dst, &dstrect);
+}
+
+Rect unite(const Rect& lhs, const Rect& rhs)
+{
+  if (lhs.empty())
+    return rhs;
+
+  return Rect(std::min(lhs.left, rhs.left), std::min(lhs.top, rhs.top),
+              std::max(lhs.right, rhs.right), std::max(lhs.bottom, rhs.bottom));
+}
+
+} // namespace
+
+TTFGlyphAtlas::TTFGlyphAtlas(const TTFFont& font) :
+  m_font(font),
+  m_pages(),
+  m_glyphs()
+{
+}
+
+TTFGlyphAtlas::~TTFGlyphAtlas()
+{
+}
+
+int
+TTFGlyphAtlas::get_line_width(const std::string& line)
+{
+  int width = 0;
+  for (UTF8Iterator it(line); !it.done(); ++it)
+  {
+    if (*it != 0) {
+      width += get_glyph(*it).advance;
+    }
+  }
+  return width;
+}
+
+void
+TTFGlyphAtlas::draw_line(Canvas& canvas, const std::string& line, const Vector& pos,
+                         const Color& color, int layer)
+{
+  struct Batch
+  {
+    std::vector<Rectf> srcrects;
+    std::vector<Rectf> dstrects;
+  };
+
+  std::vector<Batch> effects(m_pages.size());
+  std::vector<Batch> cores(m_pages.size());
+
+  float x = pos.x;
+  for (UTF8Iterator it(line); !it.done(); ++it)
+  {
+    if (*it == 0)
+      continue;
+
+    const Glyph& glyph = get_glyph(*it);
+    if (glyph.page >= 0)
+    {
+      // new glyphs may have added pages
+      if (static_cast<size_t>(glyph.page) >= effects.size()) {
+        effects.resize(m_pages.size());
+        cores.resize(m_pages.size());
+      }
+
+      const Vector origin(x, pos.y);
+
+      effects[glyph.page].srcrects.emplace_back(glyph.effects);
+      effects[glyph.page].dstrects.emplace_back(origin, Sizef(glyph.effects.get_size()));
+
+      cores[glyph.page].srcrects.emplace_back(glyph.core);
+      cores[glyph.page].dstrects.emplace_back(origin, Sizef(glyph.core.get_size()));
+    }
+    x += static_cast<float>(glyph.advance);
+  }
+
+  // all shadows and borders go below all cores, like in a TTFSurface
+  for (size_t i = 0; i < effects.size(); ++i) {
+    if (!effects[i].srcrects.empty()) {
+      canvas.draw_surface_batch(get_surface(*m_pages[i]),
+                                std::move(effects[i].srcrects), std::move(effects[i].dstrects),
+                                color, layer);
+    }
+  }
+  for (size_t i = 0; i < cores.size(); ++i) {
+    if (!cores[i].srcrects.empty()) {
+      canvas.draw_surface_batch(get_surface(*m_pages[i]),
+                                std::move(cores[i].srcrects), std::move(cores[i].dstrects),
+                                color, layer);
+    }
+  }
+}
+
+const TTFGlyphAtlas::Glyph&
+TTFGlyphAtlas::get_glyph(uint32_t codepoint)
+{
+  auto it = m_glyphs.find(codepoint);
+  if (it != m_glyphs.end())
+    return it->second;
+
+  return m_glyphs.emplace(codepoint, render_glyph(codepoint)).first->second;
+}
+
+TTFGlyphAtlas::Glyph
+TTFGlyphAtlas::render_glyph(uint32_t codepoint)
+{
+  Glyph glyph{-1, Rect(), Rect(), 0};
+
+  const std::string text = encode_utf8(codepoint);
+  SDLSurfacePtr core(TTF_RenderUTF8_Blended(m_font.get_ttf_font(), text.c_str(),
+                                            SDL_Color{255, 255, 255, 255}));
+  if (!core)
+  {
+    log_warning << "Couldn't render glyph " << codepoint << ": " << SDL_GetError() << std::endl;
+    return glyph;
+  }
+
+  int advance = core->w;
+  if (codepoint <= 0xFFFF)
+  {
+    int minx, maxx, miny, maxy;
+    if (TTF_GlyphMetrics(m_font.get_ttf_font(), static_cast<Uint16>(codepoint),
+                         &minx, &maxx, &miny, &maxy, &advance) < 0) {
+      advance = core->w;
+    }
+  }
+  glyph.advance = advance;
+
+  SDLSurfacePtr effects = TTFSurface::render_effects(m_font, *core, false);
+
+  // effects and core share one slot, so they are always on the same page
+  Rect slot;
+  if (!allocate(effects->w + PADDING + core->w, std::max(effects->h, core->h), glyph.page, slot))
+  {
+    log_warning << "Glyph " << codepoint << " doesn't fit on an atlas page" << std::endl;
+    return glyph;
+  }
+  glyph.effects = Rect(slot.left, slot.top, slot.left + effects->w, slot.top + effects->h);
+  glyph.core = Rect(glyph.effects.right + PADDING, slot.top,
+                    glyph.effects.right + PADDING + core->w, slot.top + core->h);
+
+  Page& page = *m_pages[glyph.page];
+  blit(*effects, *page.image, glyph.effects);
+  blit(*core, *page.image, glyph.core);
+  page.dirty = unite(page.dirty, slot);
+
+  return glyph;
+}
+
+bool
+TTFGlyphAtlas::allocate(int width, int height, int& page_index, Rect& rect)
+{
+  const int padded_width = width + PADDING;
+  const int padded_height = height + PADDING;
+
+  if (padded_width > PAGE_SIZE || padded_height > PAGE_SIZE)
+    return false;
+
+  if (!m_pages.empty())
+  {
+    Page& page = *m_pages.back();
+
+    if (page.x + padded_width > PAGE_SIZE)
+    {
+      page.x = 0;
+      page.y += page.shelf_height;
+      page.shelf_height = 0;
+    }
+
+    if (page.y + padded_height <= PAGE_SIZE)
+    {
+      page_index = static_cast<int>(m_pages.size()) - 1;
+      rect = Rect(page.x, page.y, page.x + width, page.y + height);
+      page.x += padded_width;
+      page.shelf_height = std::max(page.shelf_height, padded_height);
+      return true;
+    }
+  }
+
+  std::unique_ptr<Page> page(new Page{SDLSurface::create_rgba(PAGE_SIZE, PAGE_SIZE),
+                                      SurfacePtr(), Rect(), 0, 0, 0});
+  page->x = padded_width;
+  page->shelf_height = padded_height;
+  m_pages.push_back(std::move(page));
+
+  page_index = static_cast<int>(m_pages.size()) - 1;
+  rect = Rect(0, 0, width, height);
+  return true;
+}
+
+SurfacePtr
+TTFGlyphAtlas::get_surface(Page& page)
+{
+  if (!page.surface)
+  {
+    page.surface = Surface::from_texture(VideoSystem::current()->new_texture(*page.image));
+  }
+  else if (!page.dirty.empty())
+  {
+    // glyphs already drawn this frame keep their pixels, so the
+    // texture can be updated while draw requests still reference it
+    page.surface->get_texture()->update(*page.image, page.dirty);
+  }
+  page.dirty = Rect();
+  return page.surface;
+}
+
+/* EOF */
@@ -0,0 +1,97 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#ifndef HEADER_SUPERTUX_VIDEO_TTF_GLYPH_ATLAS_HPP
+#define HEADER_SUPERTUX_VIDEO_TTF_GLYPH_ATLAS_HPP
+
+#include <memory>
+#include <stdint.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "math/rect.hpp"
+#include "video/sdl_surface_ptr.hpp"
+#include "video/surface_ptr.hpp"
+
+class Canvas;
+class Color;
+class TTFFont;
+class Vector;
+
+/** Caches the glyphs of a TTFFont, including shadow and border, on a
+    few texture pages and draws text as one batch per page. Unlike the
+    TTFSurfaceManager this doesn't create a texture for every new
+    string, which makes it a good fit for text that changes each
+    frame, like the HUD. Glyphs are placed one after another without
+    kerning. */
+class TTFGlyphAtlas final
+{
+public:
+  TTFGlyphAtlas(const TTFFont& font);
+  ~TTFGlyphAtlas();
+
+  /** Width of a single line of text */
+  int get_line_width(const std::string& line);
+
+  /** Draws a single line of text with its top left corner at pos */
+  void draw_line(Canvas& canvas, const std::string& line, const Vector& pos,
+                 const Color& color, int layer);
+
+private:
+  struct Page
+  {
+    SDLSurfacePtr image;
+    SurfacePtr surface;
+
+    /** Area of image that hasn't been uploaded to surface yet */
+    Rect dirty;
+
+    /** Shelf packing state */
+    int x;
+    int y;
+    int shelf_height;
+  };
+
+  struct Glyph
+  {
+    /** -1 if the glyph has nothing to draw */
+    int page;
+    Rect effects;
+    Rect core;
+    int advance;
+  };
+
+private:
+  const Glyph& get_glyph(uint32_t codepoint);
+  Glyph render_glyph(uint32_t codepoint);
+  bool allocate(int width, int height, int& page, Rect& rect);
+  SurfacePtr get_surface(Page& page);
+
+private:
+  const TTFFont& m_font;
+  std::vector<std::unique_ptr<Page> > m_pages;
+  std::unordered_map<uint32_t, Glyph> m_glyphs;
+
+private:
+  TTFGlyphAtlas(const TTFGlyphAtlas&) = delete;
+  TTFGlyphAtlas& operator=(const TTFGlyphAtlas&) = delete;
+};
+
+#endif
+
+/* EOF */
@@ -21,6 +21,7 @@
 #include <string>
 
 #include "math/vector.hpp"
+#include "video/sdl_surface_ptr.hpp"
 #include "video/surface_ptr.hpp"
 
 class TTFFont;
@@ -34,6 +35,11 @@ class TTFSurface final
 public:
   static TTFSurfacePtr create(const TTFFont& font, const std::string& text);
 
+  /** Draws the shadow and border of the font around the rendered
+      text, and the text itself on top if with_core is set. The
+      result is bigger than text by the size of the effects. */
+  static SDLSurfacePtr render_effects(const TTFFont& font, SDL_Surface& text, bool with_core);
+
 public:
   TTFSurface(const SurfacePtr& surface, const Vector& offset);
 
@@ -20,10 +20,15 @@
 #include <boost/optional.hpp>
 #include <config.h>
 #include <iomanip>
+#include <memory>
 #include <physfs.h>
 #include <sstream>
 
+#include "math/util.hpp"
+#include "supertux/gameconfig.hpp"
+#include "supertux/globals.hpp"
 #include "util/file_system.hpp"
+#include "util/job_system.hpp"
 #include "util/log.hpp"
 #include "video/null/null_video_system.hpp"
 #include "video/sdl/sdl_video_system.hpp"
@@ -34,6 +39,16 @@
 #  include "video/gl/gl_video_system.hpp"
 #endif
 
+namespace {
+
+/** Lightmap height to aim for at each lightmap_quality, medium keeps
+    the old fixed downscale of 5 at the default window size */
+const int LIGHTMAP_TARGET_HEIGHT[] = { 100, 160, 320 };
+
+const int MAX_LIGHTMAP_DOWNSCALE = 16;
+
+} // namespace
+
 std::unique_ptr<VideoSystem>
 VideoSystem::create(VideoSystem::Enum video_system)
 {
@@ -147,15 +162,23 @@ VideoSystem::get_video_string(VideoSystem::Enum video)
   }
 }
 
+int
+VideoSystem::get_lightmap_downscale(const Size& screen_size)
+{
+  const int quality = math::clamp(g_config->lightmap_quality, 0, 2);
+  const int downscale = screen_size.height / LIGHTMAP_TARGET_HEIGHT[quality];
+  return math::clamp(downscale, 1, MAX_LIGHTMAP_DOWNSCALE);
+}
+
 void
-VideoSystem::do_take_screenshot()
+VideoSystem::read_screen(ScreenCallback callback)
 {
-  SDLSurfacePtr surface = make_screenshot();
-  if (!surface) {
-    log_warning << "Creating the screenshot has failed" << std::endl;
-    return;
-  }
+  callback(make_screenshot());
+}
 
+void
+VideoSystem::do_take_screenshot()
+{
   const std::string screenshots_dir = "/screenshots";
   if (!PHYSFS_exists(screenshots_dir.c_str())) {
     if (!PHYSFS_mkdir(screenshots_dir.c_str())) {
@@ -164,14 +187,18 @@ VideoSystem::do_take_screenshot()
     }
   }
 
+  // earlier screenshots may not be written yet, so continue after the
+  // last number handed out
+  static int s_next_num = 0;
   auto find_filename = [&]() -> boost::optional<std::string>
     {
-      for (int num = 0; num < 1000000; ++num)
+      for (int num = s_next_num; num < 1000000; ++num)
       {
         std::ostringstream oss;
         oss << "screenshot" << std::setw(6) << std::setfill('0') << num << ".png";
         const std::string screenshot_filename = FileSystem::join(screenshots_dir, oss.str());
         if (!PHYSFS_exists(screenshot_filename.c_str())) {
+          s_next_num = num + 1;
           return screenshot_filename;
         }
       }
@@ -182,13 +209,29 @@ VideoSystem::do_take_screenshot()
   if (!filename)
   {
     log_info << "Failed to find filename to save screenshot" << std::endl;
+    return;
   }
-  else
-  {
-    if (SDLSurface::save_png(*surface, *filename)) {
-      log_info << "Wrote screenshot to \"" << *filename << "\"" << std::endl;
-    }
-  }
+
+  read_screen([filename = *filename](SDLSurfacePtr surface) {
+      if (!surface) {
+        log_warning << "Creating the screenshot has failed" << std::endl;
+        return;
+      }
+
+      // std::function wants a copyable job
+      auto shared_surface = std::make_shared<SDLSurfacePtr>(std::move(surface));
+      auto job = [filename, shared_surface] {
+        if (SDLSurface::save_png(**shared_surface, filename)) {
+          log_info << "Wrote screenshot to \"" << filename << "\"" << std::endl;
+        }
+      };
+
+      if (JobSystem::current()) {
+        JobSystem::current()->schedule(std::move(job));
+      } else {
+        job();
+      }
+    });
 }
 
 /* EOF */
@@ -17,6 +17,7 @@
 #ifndef HEADER_SUPERTUX_VIDEO_VIDEO_SYSTEM_HPP
 #define HEADER_SUPERTUX_VIDEO_VIDEO_SYSTEM_HPP
 
+#include <functional>
 #include <string>
 #include <SDL.h>
 
@@ -25,6 +26,7 @@
 #include "video/sampler.hpp"
 #include "video/texture_ptr.hpp"
 
+class CompressedImage;
 class Rect;
 class Renderer;
 class SDLSurfacePtr;
@@ -36,6 +38,10 @@ class Viewport;
 class VideoSystem : public Currenton<VideoSystem>
 {
 public:
+  /** Receives a frame read by read_screen(), an empty surface if the
+      read failed */
+  using ScreenCallback = std::function<void (SDLSurfacePtr)>;
+
   enum Enum {
     VIDEO_AUTO,
     VIDEO_OPENGL33CORE,
@@ -49,6 +55,11 @@ public:
   static Enum get_video_system(const std::string &video);
   static std::string get_video_string(Enum video);
 
+  /** Factor the lightmap is scaled down by for the given screen size,
+      picked from g_config->lightmap_quality so the lightmap keeps
+      roughly the same resolution on large screens */
+  static int get_lightmap_downscale(const Size& screen_size);
+
 public:
   VideoSystem() {}
   virtual ~VideoSystem() {}
@@ -62,9 +73,21 @@ public:
 
   virtual TexturePtr new_texture(const SDL_Surface& image, const Sampler& sampler = Sampler()) = 0;
 
+  /** Returns nullptr if the format of image isn't supported, the
+      caller has to fall back to an uncompressed image then */
+  virtual TexturePtr new_compressed_texture(const CompressedImage& /*image*/, const Sampler& /*sampler*/) { return {}; }
+
   virtual const Viewport& get_viewport() const = 0;
   virtual void apply_config() = 0;
+
+  /** Called before anything of a frame gets drawn */
+  virtual void begin_frame() {}
   virtual void flip() = 0;
+
+  /** Hands the queued commands to the driver without presenting
+      them, a later flip() shows the frame */
+  virtual void flush() {}
+
   virtual void on_resize(int w, int h) = 0;
   virtual Size get_window_size() const = 0;
 
@@ -75,6 +98,12 @@ public:
   virtual void set_icon(const SDL_Surface& icon) = 0;
   virtual SDLSurfacePtr make_screenshot() = 0;
 
+  /** Hands the next frame that gets shown to callback, possibly only
+      a few frames later. Called on the main thread. The default reads
+      the screen right away through make_screenshot(). */
+  virtual void read_screen(ScreenCallback callback);
+
+  /** Saves the next frame as PNG, the encoding runs on the JobSystem */
   void do_take_screenshot();
 
 private:
@@ -17,8 +17,7 @@
 
 #include "worldmap/level_tile.hpp"
 
-#include <physfs.h>
-
+#include "physfs/util.hpp"
 #include "sprite/sprite.hpp"
 #include "sprite/sprite_manager.hpp"
 #include "util/file_system.hpp"
@@ -67,7 +66,7 @@ LevelTile::LevelTile(const std::string& basedir, const ReaderMapping& mapping) :
     m_basedir = "";
   }
 
-  if (!PHYSFS_exists(FileSystem::join(m_basedir, m_level_filename).c_str()))
+  if (!physfsutil::exists_cached(FileSystem::join(m_basedir, m_level_filename)))
   {
     log_warning << "level file '" << m_level_filename
                 << "' does not exist and will not be added to the worldmap" << std::endl;
@@ -17,6 +17,8 @@
 
 #include "worldmap/worldmap.hpp"
 
+#include <algorithm>
+#include <math.h>
 #include <physfs.h>
 
 #include "audio/sound_manager.hpp"
@@ -85,7 +87,18 @@ WorldMap::WorldMap(const std::string& filename, Savegame& savegame, const std::s
   m_main_is_default(true),
   m_initial_fade_tilemap(),
   m_fade_direction(),
-  m_in_level(false)
+  m_in_level(false),
+  m_saved_state_hash(0),
+  m_tile_data(),
+  m_tile_data_width(0),
+  m_tile_data_height(0),
+  m_tile_data_revisions(),
+  m_level_tiles(),
+  m_special_tiles(),
+  m_sprite_changes(),
+  m_teleporters(),
+  m_object_index_count(0),
+  m_object_index_generation(0)
 {
   m_tux = &add<Tux>(this);
   add<PlayerStatusHUD>(m_savegame.get_player_status());
@@ -121,6 +134,10 @@ WorldMap::finish_construction()
   }
 
   flush_game_objects();
+
+  // build the path graph and lookups up front instead of on the first step
+  update_tile_data();
+  update_object_index();
 }
 
 bool
@@ -416,11 +433,25 @@ WorldMap::update(float dt_sec)
 
 int
 WorldMap::tile_data_at(const Vector& p) const
+{
+  update_tile_data();
+
+  const int x = static_cast<int>(p.x);
+  const int y = static_cast<int>(p.y);
+  if (x < 0 || y < 0 || x >= m_tile_data_width || y >= m_tile_data_height) {
+    return compute_tile_data(x, y);
+  }
+
+  return m_tile_data[y * m_tile_data_width + x];
+}
+
+int
+WorldMap::compute_tile_data(int x, int y) const
 {
   int dirs = 0;
 
   for (const auto& tilemap : get_solid_tilemaps()) {
-    const Tile& tile = tilemap->get_tile(static_cast<int>(p.x), static_cast<int>(p.y));
+    const Tile& tile = tilemap->get_tile(x, y);
     int dirdata = tile.get_data();
     dirs |= dirdata;
   }
@@ -428,6 +459,94 @@ WorldMap::tile_data_at(const Vector& p) const
   return dirs;
 }
 
+void
+WorldMap::update_tile_data() const
+{
+  const auto& solids = get_solid_tilemaps();
+
+  bool valid = (solids.size() == m_tile_data_revisions.size());
+  for (size_t i = 0; valid && i < solids.size(); ++i) {
+    valid = (m_tile_data_revisions[i].first == solids[i] &&
+             m_tile_data_revisions[i].second == solids[i]->get_revision());
+  }
+
+  if (!valid)
+  {
+    m_tile_data_revisions.clear();
+    for (const auto& tilemap : solids) {
+      m_tile_data_revisions.emplace_back(tilemap, tilemap->get_revision());
+      // worldmaps have no CollisionSystem, so the dirty regions are ours
+      tilemap->clear_dirty_region();
+    }
+
+    m_tile_data_width = static_cast<int>(get_tiles_width());
+    m_tile_data_height = static_cast<int>(get_tiles_height());
+    m_tile_data.resize(m_tile_data_width * m_tile_data_height);
+    for (int y = 0; y < m_tile_data_height; ++y) {
+      for (int x = 0; x < m_tile_data_width; ++x) {
+        m_tile_data[y * m_tile_data_width + x] = compute_tile_data(x, y);
+      }
+    }
+    return;
+  }
+
+  // single tiles changed by scripts
+  for (const auto& tilemap : solids)
+  {
+    const Rect& dirty = tilemap->get_dirty_region();
+    if (dirty.empty())
+      continue;
+
+    for (int y = std::max(dirty.top, 0); y < std::min(dirty.bottom, m_tile_data_height); ++y) {
+      for (int x = std::max(dirty.left, 0); x < std::min(dirty.right, m_tile_data_width); ++x) {
+        m_tile_data[y * m_tile_data_width + x] = compute_tile_data(x, y);
+      }
+    }
+    tilemap->clear_dirty_region();
+  }
+}
+
+uint64_t
+WorldMap::get_tile_key(const Vector& pos)
+{
+  return
+    (static_cast<uint64_t>(static_cast<uint32_t>(static_cast<int>(pos.x))) << 32) |
+    static_cast<uint64_t>(static_cast<uint32_t>(static_cast<int>(pos.y)));
+}
+
+void
+WorldMap::update_object_index() const
+{
+  if (m_object_index_count == get_objects().size() &&
+      m_object_index_generation == get_removal_generation())
+    return;
+
+  m_object_index_count = get_objects().size();
+  m_object_index_generation = get_removal_generation();
+
+  // emplace() keeps the first object at a position, like the linear
+  // scans this replaces did
+  m_level_tiles.clear();
+  for (auto& level : get_objects_by_type<LevelTile>()) {
+    m_level_tiles.emplace(get_tile_key(level.get_pos()), &level);
+  }
+
+  m_special_tiles.clear();
+  for (auto& special_tile : get_objects_by_type<SpecialTile>()) {
+    m_special_tiles.emplace(get_tile_key(special_tile.get_pos()), &special_tile);
+  }
+
+  m_sprite_changes.clear();
+  for (auto& sprite_change : get_objects_by_type<SpriteChange>()) {
+    m_sprite_changes.emplace(get_tile_key(sprite_change.get_pos()), &sprite_change);
+  }
+
+  m_teleporters.clear();
+  for (auto& teleporter : get_objects_by_type<Teleporter>()) {
+    m_teleporters.emplace(get_tile_key(teleporter.get_pos()), &teleporter);
+  }
+}
+
 int
 WorldMap::available_directions_at(const Vector& p) const
 {
@@ -437,45 +556,37 @@ WorldMap::available_directions_at(const Vector& p) const
 LevelTile*
 WorldMap::at_level() const
 {
-  for (auto& level : get_objects_by_type<LevelTile>()) {
-    if (level.get_pos() == m_tux->get_tile_pos())
-      return &level;
-  }
+  update_object_index();
 
-  return nullptr;
+  auto it = m_level_tiles.find(get_tile_key(m_tux->get_tile_pos()));
+  return (it != m_level_tiles.end()) ? it->second : nullptr;
 }
 
 SpecialTile*
 WorldMap::at_special_tile() const
 {
-  for (auto& special_tile : get_objects_by_type<SpecialTile>()) {
-    if (special_tile.get_pos() == m_tux->get_tile_pos())
-      return &special_tile;
-  }
+  update_object_index();
 
-  return nullptr;
+  auto it = m_special_tiles.find(get_tile_key(m_tux->get_tile_pos()));
+  return (it != m_special_tiles.end()) ? it->second : nullptr;
 }
 
 SpriteChange*
 WorldMap::at_sprite_change(const Vector& pos) const
 {
-  for (auto& sprite_change : get_objects_by_type<SpriteChange>()) {
-    if (sprite_change.get_pos() == pos)
-      return &sprite_change;
-  }
+  update_object_index();
 
-  return nullptr;
+  auto it = m_sprite_changes.find(get_tile_key(pos));
+  return (it != m_sprite_changes.end()) ? it->second : nullptr;
 }
 
 Teleporter*
 WorldMap::at_teleporter(const Vector& pos) const
 {
-  for (auto& teleporter : get_objects_by_type<Teleporter>()) {
-    if (teleporter.get_pos() == pos)
-      return &teleporter;
-  }
+  update_object_index();
 
-  return nullptr;
+  auto it = m_teleporters.find(get_tile_key(pos));
+  return (it != m_teleporters.end()) ? it->second : nullptr;
 }
 
 void
@@ -497,8 +608,16 @@ WorldMap::draw(DrawingContext& context)
 
   if (g_debug.show_worldmap_path)
   {
-    for (int x = 0; x < static_cast<int>(get_tiles_width()); x++) {
-      for (int y = 0; y < static_cast<int>(get_tiles_height()); y++) {
+    // only the tiles on screen, the whole map easily has tens of
+    // thousands of them
+    const Rectf cliprect = context.get_cliprect();
+    const int start_x = std::max(0, static_cast<int>(floorf(cliprect.get_left() / 32.0f)));
+    const int start_y = std::max(0, static_cast<int>(floorf(cliprect.get_top() / 32.0f)));
+    const int end_x = std::min(static_cast<int>(get_tiles_width()), static_cast<int>(ceilf(cliprect.get_right() / 32.0f)));
+    const int end_y = std::min(static_cast<int>(get_tiles_height()), static_cast<int>(ceilf(cliprect.get_bottom() / 32.0f)));
+
+    for (int x = start_x; x < end_x; x++) {
+      for (int y = start_y; y < end_y; y++) {
         const int data = tile_data_at(Vector(static_cast<float>(x), static_cast<float>(y)));
         const int px = x * 32;
         const int py = y * 32;
@@ -597,7 +716,16 @@ WorldMap::setup()
   MenuManager::instance().clear_menu_stack();
   ScreenManager::current()->set_screen_fade(std::make_unique<FadeToBlack>(FadeToBlack::FADEIN, 1.0f));
 
-  load_state();
+  if (m_in_level && m_saved_state_hash != 0 &&
+      WorldMapState(*this).get_hash() == m_saved_state_hash)
+  {
+    // back from a level, nothing touched the state in the meantime
+    m_in_level = false;
+  }
+  else
+  {
+    load_state();
+  }
 
   // if force_spawnpoint was set, move Tux there, then clear force_spawnpoint
   if (!m_force_spawnpoint.empty()) {
@@ -646,8 +774,11 @@ WorldMap::setup()
 void
 WorldMap::leave()
 {
-  // save state of world and player
-  save_state();
+  // save state of world and player, entering a level has already
+  // done so right before
+  if (!m_in_level) {
+    save_state();
+  }
 
   // remove worldmap_table from roottable
   m_squirrel_environment->unexpose_self();
@@ -696,6 +827,7 @@ WorldMap::save_state()
 {
   WorldMapState state(*this);
   state.save_state();
+  m_saved_state_hash = state.get_hash();
 }
 
 void
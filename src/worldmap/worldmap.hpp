@@ -18,6 +18,7 @@
 #ifndef HEADER_SUPERTUX_WORLDMAP_WORLDMAP_HPP
 #define HEADER_SUPERTUX_WORLDMAP_WORLDMAP_HPP
 
+#include <unordered_map>
 #include <vector>
 
 #include "math/vector.hpp"
@@ -168,6 +169,18 @@ private:
   void load(const std::string& filename);
   void on_escape_press();
 
+  /** Brings m_tile_data up to date with the solid tilemaps, a full
+      rebuild happens when their size, offset or solidity changed,
+      otherwise only the tiles in their dirty regions are redone */
+  void update_tile_data() const;
+  int compute_tile_data(int x, int y) const;
+
+  /** Rebuilds the position lookups of the level tiles, special tiles,
+      sprite changes and teleporters when objects were added or removed */
+  void update_object_index() const;
+
+  static uint64_t get_tile_key(const Vector& pos);
+
 private:
   std::unique_ptr<SquirrelEnvironment> m_squirrel_environment;
   std::unique_ptr<Camera> m_camera;
@@ -199,6 +212,25 @@ private:
 
   bool m_in_level;
 
+  /** Hash of the state table written by the last save_state(), if
+      it is unchanged when coming back from a level, the objects
+      still match it and don't have to be loaded again */
+  uint64_t m_saved_state_hash;
+
+  /** Union of the tile data of all solid tilemaps for each tile, this
+      is the path graph Tux walks on */
+  mutable std::vector<int> m_tile_data;
+  mutable int m_tile_data_width;
+  mutable int m_tile_data_height;
+  mutable std::vector<std::pair<const TileMap*, uint32_t> > m_tile_data_revisions;
+
+  mutable std::unordered_map<uint64_t, LevelTile*> m_level_tiles;
+  mutable std::unordered_map<uint64_t, SpecialTile*> m_special_tiles;
+  mutable std::unordered_map<uint64_t, SpriteChange*> m_sprite_changes;
+  mutable std::unordered_map<uint64_t, Teleporter*> m_teleporters;
+  mutable size_t m_object_index_count;
+  mutable uint32_t m_object_index_generation;
+
 private:
   WorldMap(const WorldMap&) = delete;
   WorldMap& operator=(const WorldMap&) = delete;
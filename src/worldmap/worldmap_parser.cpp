@@ -16,8 +16,6 @@
 
 #include "worldmap/worldmap_parser.hpp"
 
-#include <physfs.h>
-
 #include "object/ambient_light.hpp"
 #include "object/background.hpp"
 #include "object/decal.hpp"
@@ -173,12 +171,12 @@ WorldMapParser::load_level_information(LevelTile& level)
     if (m_worldmap.m_levels_path == "./")
       filename = level.get_level_filename();
 
-    if (!PHYSFS_exists(filename.c_str()))
+    if (!physfsutil::exists_cached(filename))
     {
       log_warning << "Level file '" << filename << "' does not exist. Skipping." << std::endl;
       return;
     }
-    if (physfsutil::is_directory(filename))
+    if (physfsutil::is_directory_cached(filename))
     {
       log_warning << "Level file '" << filename << "' is a directory. Skipping." << std::endl;
       return;
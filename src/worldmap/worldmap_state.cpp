@@ -19,6 +19,7 @@
 
 #include "math/vector.hpp"
 #include "object/tilemap.hpp"
+#include "squirrel/serialize.hpp"
 #include "squirrel/squirrel_util.hpp"
 #include "supertux/savegame.hpp"
 #include "supertux/tile.hpp"
@@ -287,6 +288,27 @@ WorldMapState::save_state() const
   m_worldmap.m_savegame.save();
 }
 
+uint64_t
+WorldMapState::get_hash() const
+{
+  SquirrelVM& vm = SquirrelVirtualMachine::current()->get_vm();
+  SQInteger oldtop = sq_gettop(vm.get_vm());
+
+  uint64_t hash = 0;
+  try {
+    sq_pushroottable(vm.get_vm());
+    vm.get_table_entry("state");
+    vm.get_table_entry("worlds");
+    vm.get_table_entry(m_worldmap.m_map_filename);
+    hash = hash_squirrel_table(vm.get_vm(), -1);
+  } catch(std::exception&) {
+    // no state saved yet
+  }
+  sq_settop(vm.get_vm(), oldtop);
+
+  return hash;
+}
+
 } // namespace worldmap
 
 /* EOF */
@@ -18,6 +18,8 @@
 #ifndef HEADER_SUPERTUX_WORLDMAP_WORLDMAP_STATE_HPP
 #define HEADER_SUPERTUX_WORLDMAP_WORLDMAP_STATE_HPP
 
+#include <stdint.h>
+
 namespace worldmap {
 
 class WorldMap;
@@ -30,6 +32,9 @@ public:
   void load_state();
   void save_state() const;
 
+  /** Hash of the state table of this worldmap, 0 if there is none */
+  uint64_t get_hash() const;
+
 private:
   WorldMap& m_worldmap;
 
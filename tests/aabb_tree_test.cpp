@@ -0,0 +1,147 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <set>
+
+#include "collision/aabb_tree.hpp"
+#include "collision/collision.hpp"
+#include "math/random.hpp"
+
+namespace {
+
+// the tree never dereferences its payload, so fake pointers are fine
+CollisionObject* fake_object(size_t i)
+{
+  return reinterpret_cast<CollisionObject*>(i + 1);
+}
+
+size_t fake_index(CollisionObject* object)
+{
+  return reinterpret_cast<size_t>(object) - 1;
+}
+
+Rectf random_rect(Random& rng)
+{
+  const float x = rng.randf(-3000.0f, 3000.0f);
+  const float y = rng.randf(-3000.0f, 3000.0f);
+  return Rectf(x, y, x + rng.randf(1.0f, 200.0f), y + rng.randf(1.0f, 200.0f));
+}
+
+} // namespace
+
+TEST(AABBTreeTest, query_matches_linear_scan)
+{
+  Random rng;
+  rng.seed(42);
+
+  AABBTree tree;
+  std::vector<Rectf> rects;
+  std::vector<int> proxies;
+  for (size_t i = 0; i < 500; ++i)
+  {
+    rects.push_back(random_rect(rng));
+    proxies.push_back(tree.insert(fake_object(i), rects.back()));
+  }
+
+  // move some objects around, some within and some beyond the margin
+  for (size_t i = 0; i < rects.size(); i += 3)
+  {
+    rects[i] = rects[i].moved(Vector(rng.randf(-100.0f, 100.0f), rng.randf(-100.0f, 100.0f)));
+    tree.move(proxies[i], rects[i]);
+  }
+
+  // and remove a few
+  std::set<size_t> removed;
+  for (size_t i = 0; i < rects.size(); i += 7)
+  {
+    tree.remove(proxies[i]);
+    removed.insert(i);
+  }
+
+  EXPECT_LT(tree.get_height(), 30);
+
+  for (int q = 0; q < 100; ++q)
+  {
+    const Rectf query = random_rect(rng).grown(100.0f);
+
+    std::set<size_t> found;
+    tree.query(query, [&found](CollisionObject* object) {
+        found.insert(fake_index(object));
+        return true;
+      });
+
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+      if (removed.count(i)) {
+        ASSERT_EQ(0u, found.count(i));
+      } else if (collision::intersects(query, rects[i])) {
+        ASSERT_EQ(1u, found.count(i));
+      }
+    }
+  }
+}
+
+TEST(AABBTreeTest, raycast_matches_linear_scan)
+{
+  Random rng;
+  rng.seed(7);
+
+  AABBTree tree(0.0f);
+  std::vector<Rectf> rects;
+  for (size_t i = 0; i < 300; ++i)
+  {
+    rects.push_back(random_rect(rng));
+    tree.insert(fake_object(i), rects.back());
+  }
+
+  for (int q = 0; q < 100; ++q)
+  {
+    const Vector start(rng.randf(-3000.0f, 3000.0f), rng.randf(-3000.0f, 3000.0f));
+    const Vector end(rng.randf(-3000.0f, 3000.0f), rng.randf(-3000.0f, 3000.0f));
+
+    std::set<size_t> found;
+    tree.raycast(start, end, [&found](CollisionObject* object) {
+        found.insert(fake_index(object));
+        return true;
+      });
+
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+      if (collision::intersects_line(rects[i], start, end)) {
+        ASSERT_EQ(1u, found.count(i));
+      }
+    }
+  }
+}
+
+TEST(AABBTreeTest, early_exit)
+{
+  AABBTree tree;
+  for (size_t i = 0; i < 10; ++i) {
+    tree.insert(fake_object(i), Rectf(0.0f, 0.0f, 10.0f, 10.0f));
+  }
+
+  int calls = 0;
+  tree.query(Rectf(0.0f, 0.0f, 1.0f, 1.0f), [&calls](CollisionObject*) {
+      calls += 1;
+      return false;
+    });
+  ASSERT_EQ(1, calls);
+}
+
+/* EOF */
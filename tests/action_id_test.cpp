@@ -0,0 +1,36 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include "sprite/action_id.hpp"
+
+TEST(ActionIdTest, interning)
+{
+  const ActionId left("walk-left");
+  const ActionId right("walk-right");
+
+  ASSERT_TRUE(left.is_valid());
+  ASSERT_EQ(left, ActionId("walk-left"));
+  ASSERT_NE(left, right);
+  ASSERT_EQ("walk-right", right.get_name());
+
+  ASSERT_FALSE(ActionId().is_valid());
+  ASSERT_EQ("", ActionId().get_name());
+}
+
+/* EOF */
@@ -0,0 +1,48 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include "supertux/ai_query_cache.hpp"
+
+TEST(AIQueryCacheTest, line_of_sight)
+{
+  // the cache never dereferences the players
+  const Player* player1 = reinterpret_cast<const Player*>(1);
+  const Player* player2 = reinterpret_cast<const Player*>(2);
+
+  AIQueryCache cache;
+  bool visible = false;
+  ASSERT_FALSE(cache.find_line_of_sight(Vector(10.0f, 20.0f), player1, visible));
+
+  cache.add_line_of_sight(Vector(10.0f, 20.0f), player1, true);
+  cache.add_line_of_sight(Vector(10.0f, 20.0f), player2, false);
+
+  ASSERT_TRUE(cache.find_line_of_sight(Vector(10.0f, 20.0f), player1, visible));
+  ASSERT_TRUE(visible);
+  ASSERT_TRUE(cache.find_line_of_sight(Vector(10.0f, 20.0f), player2, visible));
+  ASSERT_FALSE(visible);
+
+  // exact positions only
+  ASSERT_FALSE(cache.find_line_of_sight(Vector(10.5f, 20.0f), player1, visible));
+
+  cache.clear();
+  ASSERT_EQ(0u, cache.get_size());
+  ASSERT_FALSE(cache.find_line_of_sight(Vector(10.0f, 20.0f), player1, visible));
+}
+
+/* EOF */
@@ -0,0 +1,45 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <vector>
+
+#include "util/allocation_tracker.hpp"
+
+TEST(AllocationTrackerTest, counts)
+{
+  if (!AllocationTracker::is_available())
+    return;
+
+  const uint64_t count = AllocationTracker::get_thread_allocation_count();
+  const uint64_t bytes = AllocationTracker::get_thread_allocated_bytes();
+  const int64_t in_flight = AllocationTracker::get_bytes_in_flight();
+
+  {
+    std::vector<char> data(1000, 'x');
+    ASSERT_EQ('x', data[999]);
+    ASSERT_EQ(count + 1, AllocationTracker::get_thread_allocation_count());
+    ASSERT_EQ(bytes + 1000, AllocationTracker::get_thread_allocated_bytes());
+    ASSERT_LE(in_flight + 1000, AllocationTracker::get_bytes_in_flight());
+  }
+
+  ASSERT_GE(AllocationTracker::get_allocation_count(), count + 1);
+}
+
+/* EOF */
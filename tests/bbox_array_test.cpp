@@ -0,0 +1,83 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "collision/bbox_array.hpp"
+#include "collision/collision.hpp"
+#include "math/random.hpp"
+#include "math/rectf.hpp"
+
+TEST(BBoxArrayTest, unset_boxes_never_intersect)
+{
+  BBoxArray boxes;
+  boxes.reset(6);
+  boxes.set(4, Rectf(0.0f, 0.0f, 10.0f, 10.0f));
+
+  std::vector<size_t> result;
+  boxes.query(Rectf(-1.0e6f, -1.0e6f, 1.0e6f, 1.0e6f), result);
+  ASSERT_EQ((std::vector<size_t>{4}), result);
+
+  // touching counts, like collision::intersects()
+  boxes.query(Rectf(10.0f, 10.0f, 20.0f, 20.0f), result);
+  ASSERT_EQ((std::vector<size_t>{4}), result);
+}
+
+TEST(BBoxArrayTest, matches_intersects)
+{
+  Random rng;
+  rng.seed(2020);
+
+  std::vector<Rectf> rects;
+  BBoxArray boxes;
+  boxes.reset(203);
+  for (size_t i = 0; i < boxes.size(); ++i)
+  {
+    const float x = rng.randf(-1000.0f, 1000.0f);
+    const float y = rng.randf(-1000.0f, 1000.0f);
+    rects.emplace_back(x, y, x + rng.randf(1.0f, 200.0f), y + rng.randf(1.0f, 200.0f));
+    boxes.set(i, rects.back());
+  }
+
+  std::vector<size_t> candidates;
+  for (size_t i = 0; i < rects.size(); i += 2) {
+    candidates.push_back(i);
+  }
+
+  std::vector<size_t> result;
+  for (const auto& rect : rects)
+  {
+    std::vector<size_t> expected;
+    for (size_t i = 0; i < rects.size(); ++i) {
+      if (collision::intersects(rect, rects[i])) {
+        expected.push_back(i);
+      }
+    }
+    boxes.query(rect, result);
+    ASSERT_EQ(expected, result);
+
+    expected.clear();
+    for (const auto& i : candidates) {
+      if (collision::intersects(rect, rects[i])) {
+        expected.push_back(i);
+      }
+    }
+    boxes.filter(rect, candidates, result);
+    ASSERT_EQ(expected, result);
+  }
+}
+
+/* EOF */
@@ -0,0 +1,135 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <sexp/parser.hpp>
+#include <sstream>
+
+#include "util/binary_document.hpp"
+#include "util/reader_document.hpp"
+#include "util/reader_mapping.hpp"
+
+namespace {
+
+std::string make_level(std::vector<unsigned int>& tiles)
+{
+  std::ostringstream out;
+  out << "(tilemap (name \"main\") (width 20) (tiles";
+  for (unsigned int i = 0; i < 400; ++i) {
+    tiles.push_back(i * 1000003u % 4096u);
+    out << ' ' << tiles.back();
+  }
+  out << ") (smalltiles 1 2 3))";
+  return out.str();
+}
+
+} // namespace
+
+TEST(BinaryDocumentTest, roundtrip)
+{
+  std::vector<unsigned int> tiles;
+  std::istringstream in(make_level(tiles));
+  const sexp::Value sx = sexp::Parser::from_stream(in, sexp::Parser::USE_ARRAYS);
+
+  const std::string data = BinaryDocument::encode(sx);
+  ASSERT_TRUE(BinaryDocument::is_binary(data));
+
+  auto doc = ReaderDocument::from_binary("<binary>", data);
+  auto root = doc.get_root();
+  ASSERT_EQ("tilemap", root.get_name());
+  auto mapping = root.get_mapping();
+
+  std::string name;
+  ASSERT_TRUE(mapping.get("name", name));
+  ASSERT_EQ("main", name);
+
+  std::vector<unsigned int> result;
+  ASSERT_TRUE(mapping.get("tiles", result));
+  ASSERT_EQ(tiles, result);
+
+  // short arrays stay in the document
+  ASSERT_TRUE(mapping.get("smalltiles", result));
+  ASSERT_EQ((std::vector<unsigned int>{1, 2, 3}), result);
+
+  // only documents read by from_file() refer to a file
+  BinaryDocument::Blob blob;
+  ASSERT_FALSE(mapping.get_file_blob("tiles", blob));
+
+  // parts of a blob decode like the whole
+  sexp::Value decoded;
+  std::vector<BinaryDocument::Blob> blobs;
+  ASSERT_TRUE(BinaryDocument::decode(data, decoded, blobs));
+  std::vector<unsigned int> part(10);
+  BinaryDocument::decode_values(data.data() + blobs[0].offset + 123 * 4, part.size(), part.data());
+  ASSERT_EQ(std::vector<unsigned int>(tiles.begin() + 123, tiles.begin() + 133), part);
+}
+
+TEST(BinaryDocumentTest, broken_data)
+{
+  std::vector<unsigned int> tiles;
+  std::istringstream in(make_level(tiles));
+  const std::string data = BinaryDocument::encode(sexp::Parser::from_stream(in, sexp::Parser::USE_ARRAYS));
+
+  sexp::Value sx;
+  std::vector<BinaryDocument::Blob> blobs;
+  ASSERT_TRUE(BinaryDocument::decode(data, sx, blobs));
+  ASSERT_EQ(1u, blobs.size());
+  ASSERT_EQ(0u, blobs[0].offset % 16);
+
+  for (size_t len = 0; len < data.size(); len += 7) {
+    ASSERT_FALSE(BinaryDocument::decode(data.substr(0, len), sx, blobs));
+  }
+  ASSERT_FALSE(BinaryDocument::is_binary("(tilemap)"));
+}
+
+TEST(BinaryDocumentTest, text_blobs)
+{
+  std::vector<unsigned int> tiles;
+  const std::string text = make_level(tiles);
+
+  std::string data;
+  std::vector<BinaryDocument::Blob> blobs;
+  const std::string result = BinaryDocument::extract_text_blobs(text, data, blobs);
+  ASSERT_EQ(1u, blobs.size());
+  ASSERT_EQ(0u, blobs[0].offset % 16);
+  ASSERT_EQ("(tilemap (name \"main\") (width 20) (tiles (blob 0)) (smalltiles 1 2 3))", result);
+
+  std::vector<unsigned int> values;
+  BinaryDocument::read_blob(data, blobs[0], values);
+  ASSERT_EQ(tiles, values);
+
+  // anything unusual is left to the parser
+  std::string odd = "(a \"(tiles 1 2)\" ; (tiles 3 4\n";
+  for (const char* array : { "(tiles 1 -2", "(tiles 1 2.5", "(tiles 1 ; comment\n 2", "(tiles 1 9999999999" }) {
+    odd += array;
+    for (int i = 0; i < 100; ++i) odd += " 7";
+    odd += ")\n";
+  }
+  odd += ")";
+  blobs.clear();
+  ASSERT_EQ(odd, BinaryDocument::extract_text_blobs(odd, data, blobs));
+  ASSERT_TRUE(blobs.empty());
+
+  // line breaks survive to keep the line numbers
+  std::string multiline = "(tiles";
+  for (int i = 0; i < 100; ++i) multiline += (i % 10 == 0) ? "\n 1" : " 1";
+  multiline += ")\n(x)";
+  ASSERT_EQ("(tiles (blob 0)\n\n\n\n\n\n\n\n\n\n)\n(x)",
+            BinaryDocument::extract_text_blobs(multiline, data, blobs));
+}
+
+/* EOF */
@@ -0,0 +1,96 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "collision/collision.hpp"
+#include "collision/collision_grid.hpp"
+#include "math/random.hpp"
+#include "math/rectf.hpp"
+
+TEST(CollisionGridTest, query_sorted)
+{
+  CollisionGrid grid(32.0f);
+  grid.insert(5, Rectf(0.0f, 0.0f, 10.0f, 10.0f));
+  grid.insert(2, Rectf(5.0f, 5.0f, 40.0f, 40.0f));
+  grid.insert(9, Rectf(500.0f, 500.0f, 510.0f, 510.0f));
+
+  std::vector<size_t> result;
+  grid.query(Rectf(0.0f, 0.0f, 20.0f, 20.0f), result);
+  ASSERT_EQ((std::vector<size_t>{2, 5}), result);
+
+  grid.update(9, Rectf(8.0f, 8.0f, 12.0f, 12.0f));
+  grid.query(Rectf(0.0f, 0.0f, 20.0f, 20.0f), result);
+  ASSERT_EQ((std::vector<size_t>{2, 5, 9}), result);
+
+  grid.clear();
+  grid.query(Rectf(0.0f, 0.0f, 20.0f, 20.0f), result);
+  ASSERT_TRUE(result.empty());
+}
+
+TEST(CollisionGridTest, touching_on_cell_border)
+{
+  CollisionGrid grid(32.0f);
+  grid.insert(0, Rectf(32.0f, 0.0f, 64.0f, 32.0f));
+
+  std::vector<size_t> result;
+  grid.query(Rectf(0.0f, 0.0f, 32.0f, 32.0f), result);
+  ASSERT_EQ(1u, result.size());
+}
+
+TEST(CollisionGridTest, oversized)
+{
+  CollisionGrid grid(32.0f);
+  grid.insert(0, Rectf(-100000.0f, 0.0f, 100000.0f, 32.0f));
+  grid.insert(1, Rectf(0.0f, 0.0f, 1.0f, 1.0f));
+
+  std::vector<size_t> result;
+  grid.query(Rectf(5000.0f, 10.0f, 5001.0f, 11.0f), result);
+  ASSERT_EQ((std::vector<size_t>{0}), result);
+
+  grid.query(Rectf(-1.0e6f, -1.0e6f, 1.0e6f, 1.0e6f), result);
+  ASSERT_EQ((std::vector<size_t>{0, 1}), result);
+}
+
+TEST(CollisionGridTest, matches_linear_scan)
+{
+  Random rng;
+  rng.seed(1234);
+
+  std::vector<Rectf> rects;
+  CollisionGrid grid;
+  for (size_t i = 0; i < 200; ++i)
+  {
+    const float x = rng.randf(-2000.0f, 2000.0f);
+    const float y = rng.randf(-2000.0f, 2000.0f);
+    rects.emplace_back(x, y, x + rng.randf(1.0f, 300.0f), y + rng.randf(1.0f, 300.0f));
+    grid.insert(i, rects.back());
+  }
+
+  std::vector<size_t> result;
+  for (const auto& rect : rects)
+  {
+    grid.query(rect, result);
+    for (size_t i = 0; i < rects.size(); ++i)
+    {
+      if (collision::intersects(rect, rects[i])) {
+        ASSERT_TRUE(std::binary_search(result.begin(), result.end(), i));
+      }
+    }
+  }
+}
+
+/* EOF */
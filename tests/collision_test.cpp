@@ -17,7 +17,9 @@
 #include <gtest/gtest.h>
 
 #include "collision/collision.hpp"
+#include "math/aatriangle.hpp"
 #include "math/rectf.hpp"
+#include "math/vector.hpp"
 
 TEST(collisionTest, intersects_test)
 {
@@ -47,4 +49,63 @@ TEST(collisionTest, intersects_test)
     ASSERT_EQ(true, collision::intersects(r9, r10));
 }
 
+TEST(collisionTest, sweep_test)
+{
+  const Rectf rect(0.0f, 0.0f, 10.0f, 10.0f);
+  const Rectf wall(100.0f, -5.0f, 110.0f, 50.0f);
+  float time = -1.0f;
+
+  // a movement far beyond the wall still hits it
+  ASSERT_TRUE(collision::sweep(rect, Vector(1000.0f, 0.0f), wall, time));
+  ASSERT_FLOAT_EQ(0.09f, time);
+
+  // not reaching the wall
+  ASSERT_FALSE(collision::sweep(rect, Vector(50.0f, 0.0f), wall, time));
+
+  // moving away from it
+  ASSERT_FALSE(collision::sweep(rect, Vector(-1000.0f, 0.0f), wall, time));
+
+  // passing above
+  ASSERT_FALSE(collision::sweep(rect, Vector(1000.0f, 0.0f), wall.moved(Vector(0.0f, 20.0f)), time));
+
+  // diagonal, the later axis decides
+  ASSERT_TRUE(collision::sweep(rect, Vector(200.0f, 100.0f), Rectf(100.0f, 40.0f, 200.0f, 140.0f), time));
+  ASSERT_FLOAT_EQ(0.45f, time);
+
+  // overlapping at the start is left to the regular solver
+  ASSERT_FALSE(collision::sweep(rect, Vector(1000.0f, 0.0f), Rectf(5.0f, 5.0f, 20.0f, 20.0f), time));
+}
+
+TEST(collisionTest, rectangle_aatriangle_test)
+{
+  const float s = sqrtf(0.5f);
+
+  // a 32x32 tile uses the precomputed plane, the others compute it
+  for (const Rectf& bbox : { Rectf(64.0f, 0.0f, 96.0f, 32.0f),
+                             Rectf(64.5f, 0.25f, 96.5f, 32.25f),
+                             Rectf(64.0f, 0.0f, 128.0f, 64.0f) })
+  {
+    const Vector middle = bbox.get_middle();
+
+    collision::Constraints constraints;
+    ASSERT_TRUE(collision::rectangle_aatriangle(&constraints, Rectf(middle, Sizef(8.0f, 8.0f)),
+                                                AATriangle(bbox, AATriangle::SOUTHWEST)));
+    EXPECT_FLOAT_EQ(s, constraints.hit.slope_normal.x);
+    EXPECT_FLOAT_EQ(-s, constraints.hit.slope_normal.y);
+    EXPECT_TRUE(constraints.hit.bottom);
+
+    constraints = collision::Constraints();
+    ASSERT_TRUE(collision::rectangle_aatriangle(&constraints, Rectf(middle - Vector(8.0f, 8.0f), Sizef(8.0f, 8.0f)),
+                                                AATriangle(bbox, AATriangle::NORTHWEST)));
+    EXPECT_FLOAT_EQ(s, constraints.hit.slope_normal.x);
+    EXPECT_FLOAT_EQ(s, constraints.hit.slope_normal.y);
+    EXPECT_TRUE(constraints.hit.top);
+
+    // the upper half of a bottom-deformed slope is free
+    constraints = collision::Constraints();
+    EXPECT_FALSE(collision::rectangle_aatriangle(&constraints, Rectf(bbox.p1(), Sizef(4.0f, 4.0f)),
+                                                 AATriangle(bbox, AATriangle::SOUTHWEST | AATriangle::DEFORM_BOTTOM)));
+  }
+}
+
 /* EOF */
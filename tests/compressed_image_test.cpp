@@ -0,0 +1,79 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <stdint.h>
+
+#include "video/compressed_image.hpp"
+
+namespace {
+
+void append_uint32(std::string& data, uint32_t value)
+{
+  data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+std::string make_ktx(uint32_t width, uint32_t height, const std::string& pixels)
+{
+  const unsigned char identifier[12] = {
+    0xAB, 0x4B, 0x54, 0x58, 0x20, 0x31, 0x31, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A
+  };
+
+  std::string data(reinterpret_cast<const char*>(identifier), sizeof(identifier));
+  append_uint32(data, 0x04030201); // endianness
+  append_uint32(data, 0); // glType
+  append_uint32(data, 1); // glTypeSize
+  append_uint32(data, 0); // glFormat
+  append_uint32(data, 0x9278); // glInternalFormat, GL_COMPRESSED_RGBA8_ETC2_EAC
+  append_uint32(data, 0x1908); // glBaseInternalFormat, GL_RGBA
+  append_uint32(data, width);
+  append_uint32(data, height);
+  append_uint32(data, 0); // pixelDepth
+  append_uint32(data, 0); // numberOfArrayElements
+  append_uint32(data, 1); // numberOfFaces
+  append_uint32(data, 1); // numberOfMipmapLevels
+  append_uint32(data, 8); // bytesOfKeyValueData
+  data.append(8, '\0');
+  append_uint32(data, static_cast<uint32_t>(pixels.size()));
+  data += pixels;
+  return data;
+}
+
+} // namespace
+
+TEST(CompressedImageTest, from_data)
+{
+  const std::string pixels(16 * 4, 'x');
+  auto image = CompressedImage::from_data(make_ktx(8, 8, pixels));
+
+  ASSERT_EQ(0x9278u, image->get_internal_format());
+  ASSERT_EQ(8, image->get_width());
+  ASSERT_EQ(8, image->get_height());
+  ASSERT_EQ(pixels, image->get_data());
+}
+
+TEST(CompressedImageTest, broken_data)
+{
+  const std::string data = make_ktx(8, 8, std::string(64, 'x'));
+
+  ASSERT_THROW(CompressedImage::from_data(data.substr(0, data.size() - 1)), std::runtime_error);
+  ASSERT_THROW(CompressedImage::from_data(data.substr(0, 40)), std::runtime_error);
+  ASSERT_THROW(CompressedImage::from_data("not a ktx file"), std::runtime_error);
+  ASSERT_THROW(CompressedImage::from_data(make_ktx(0, 8, "x")), std::runtime_error);
+}
+
+/* EOF */
@@ -0,0 +1,43 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "util/copy_on_write.hpp"
+
+TEST(CopyOnWriteTest, shares_until_written)
+{
+  CopyOnWrite<std::vector<int> > a(std::vector<int>{1, 2, 3});
+  CopyOnWrite<std::vector<int> > b = a;
+  ASSERT_TRUE(a.is_shared());
+  ASSERT_EQ(&a.get(), &b.get());
+
+  b.write()[0] = 10;
+  ASSERT_FALSE(a.is_shared());
+  ASSERT_FALSE(b.is_shared());
+  ASSERT_EQ((std::vector<int>{1, 2, 3}), *a);
+  ASSERT_EQ((std::vector<int>{10, 2, 3}), *b);
+
+  // unshared values are written in place
+  const std::vector<int>* before = &b.get();
+  b.write().push_back(4);
+  ASSERT_EQ(before, &b.get());
+  ASSERT_EQ(4u, b->size());
+}
+
+/* EOF */
@@ -0,0 +1,46 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "supertux/demo_replayer.hpp"
+
+TEST(DemoReplayerTest, parse_output)
+{
+  const auto result = DemoReplayer::parse_output(
+    "[INFO] loading level\n"
+    "checksum diverged 345\n"
+    "1920 steps\n"
+    "                50%      95%      99%      max  (ms)\n"
+    "frame         2.000    3.000    4.000    9.000\n"
+    "update        1.000    1.500    2.000    5.000\n");
+
+  ASSERT_TRUE(result.complete);
+  ASSERT_EQ(1920, result.steps);
+  ASSERT_EQ(2.0f, result.frame_p50_ms);
+  ASSERT_EQ(4.0f, result.frame_p99_ms);
+  ASSERT_EQ("diverged", result.checksum);
+  ASSERT_EQ(345u, result.diverged_frame);
+}
+
+TEST(DemoReplayerTest, parse_output_incomplete)
+{
+  const auto result = DemoReplayer::parse_output("[FATAL] Unexpected exception: no level\n");
+  ASSERT_FALSE(result.complete);
+  ASSERT_EQ("none", result.checksum);
+}
+
+/* EOF */
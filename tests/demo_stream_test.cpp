@@ -0,0 +1,154 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "math/random.hpp"
+#include "supertux/demo_stream.hpp"
+
+namespace {
+
+/** Input as it looks in practice, controls held for a while */
+std::vector<uint8_t> make_frames(size_t count)
+{
+  Random rng;
+  rng.seed(11);
+
+  std::vector<uint8_t> frames;
+  uint8_t controls = 0;
+  while (frames.size() < count)
+  {
+    if (rng.rand(0, 20) == 0) {
+      controls = static_cast<uint8_t>(rng.rand(0, 63));
+    }
+    frames.push_back(controls);
+  }
+  return frames;
+}
+
+std::string write_demo(const std::vector<uint8_t>& frames, int seed)
+{
+  auto out = std::make_unique<std::ostringstream>();
+  std::ostringstream* stream = out.get();
+
+  DemoWriter writer(std::move(out), seed);
+  for (const auto controls : frames) {
+    writer.add_frame(controls);
+  }
+  writer.finish();
+  return stream->str();
+}
+
+} // namespace
+
+TEST(DemoStreamTest, roundtrip)
+{
+  const auto frames = make_frames(5000);
+  const std::string data = write_demo(frames, 1234);
+
+  // one byte per control and frame in the old format
+  EXPECT_LT(data.size() * 20, frames.size() * DEMO_CONTROL_COUNT);
+
+  DemoReader reader(std::make_unique<std::istringstream>(data));
+  ASSERT_TRUE(reader.is_compact());
+  ASSERT_EQ(1234, reader.get_random_seed());
+
+  uint8_t controls;
+  for (const auto expected : frames) {
+    ASSERT_TRUE(reader.next_frame(controls));
+    ASSERT_EQ(expected, controls);
+  }
+  ASSERT_FALSE(reader.next_frame(controls));
+  ASSERT_EQ(frames.size(), reader.get_frame());
+}
+
+TEST(DemoStreamTest, seek)
+{
+  const auto frames = make_frames(5000);
+  const std::string data = write_demo(frames, 1);
+
+  // with and without the index at the end
+  const std::string truncated = data.substr(0, data.size() - 4);
+  for (const auto& demo : { data, truncated })
+  {
+    DemoReader reader(std::make_unique<std::istringstream>(demo));
+    for (const uint32_t frame : { 4321u, 0u, 640u, 1279u, 4999u, 17u })
+    {
+      reader.seek(frame);
+      ASSERT_EQ(frame, reader.get_frame());
+
+      uint8_t controls;
+      ASSERT_TRUE(reader.next_frame(controls));
+      ASSERT_EQ(frames[frame], controls);
+    }
+
+    reader.seek(5000);
+    uint8_t controls;
+    ASSERT_FALSE(reader.next_frame(controls));
+  }
+}
+
+TEST(DemoStreamTest, old_format)
+{
+  std::string data("random_seed=        42");
+  data.push_back('\0');
+  const char raw[] = { 1, 0, 0, 0, 1, 0,
+                       0, 1, 0, 1, 0, 1 };
+  data.append(raw, sizeof(raw));
+
+  DemoReader reader(std::make_unique<std::istringstream>(data));
+  ASSERT_FALSE(reader.is_compact());
+  ASSERT_EQ(42, reader.get_random_seed());
+
+  uint8_t controls;
+  ASSERT_TRUE(reader.next_frame(controls));
+  ASSERT_EQ(0x11, controls);
+  ASSERT_TRUE(reader.next_frame(controls));
+  ASSERT_EQ(0x2a, controls);
+  ASSERT_FALSE(reader.next_frame(controls));
+
+  reader.seek(1);
+  ASSERT_TRUE(reader.next_frame(controls));
+  ASSERT_EQ(0x2a, controls);
+}
+
+TEST(DemoStreamTest, checksums)
+{
+  auto out = std::make_unique<std::ostringstream>();
+  std::ostringstream* stream = out.get();
+
+  DemoChecksumWriter writer(std::move(out));
+  writer.add_frame(0);
+  writer.add_frame(0x0123456789abcdefULL);
+
+  DemoChecksumReader reader(std::make_unique<std::istringstream>(stream->str()));
+  ASSERT_TRUE(reader.is_valid());
+
+  uint64_t hash;
+  ASSERT_TRUE(reader.next_frame(hash));
+  ASSERT_EQ(0u, hash);
+  ASSERT_TRUE(reader.next_frame(hash));
+  ASSERT_EQ(0x0123456789abcdefULL, hash);
+  ASSERT_EQ(2u, reader.get_frame());
+  ASSERT_FALSE(reader.next_frame(hash));
+
+  DemoChecksumReader invalid(std::make_unique<std::istringstream>(write_demo(make_frames(10), 1)));
+  ASSERT_FALSE(invalid.is_valid());
+}
+
+/* EOF */
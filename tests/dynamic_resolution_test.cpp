@@ -0,0 +1,86 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "video/dynamic_resolution.hpp"
+
+namespace {
+
+/** GPU time of a fill rate bound frame at the given scale */
+float gpu_ms_at(float scale, float full_ms)
+{
+  return full_ms * scale * scale;
+}
+
+void run_frames(DynamicResolution& resolution, int frames, float full_ms)
+{
+  for (int i = 0; i < frames; ++i) {
+    resolution.update(gpu_ms_at(resolution.get_scale(), full_ms), 16.0f, 0.5f, 1.0f);
+  }
+}
+
+} // namespace
+
+TEST(DynamicResolutionTest, stays_at_full_scale_when_fast)
+{
+  DynamicResolution resolution;
+  run_frames(resolution, 300, 8.0f);
+  EXPECT_EQ(1.0f, resolution.get_scale());
+}
+
+TEST(DynamicResolutionTest, scales_down_under_load)
+{
+  DynamicResolution resolution;
+  run_frames(resolution, 300, 32.0f);
+  EXPECT_LT(resolution.get_scale(), 0.75f);
+  EXPECT_LE(gpu_ms_at(resolution.get_scale(), 32.0f), 16.0f);
+}
+
+TEST(DynamicResolutionTest, respects_bounds)
+{
+  DynamicResolution resolution;
+  run_frames(resolution, 300, 1000.0f);
+  EXPECT_EQ(0.5f, resolution.get_scale());
+
+  resolution.update(1.0f, 16.0f, 0.5f, 0.5f);
+  EXPECT_EQ(0.5f, resolution.get_scale());
+}
+
+TEST(DynamicResolutionTest, recovers_when_load_drops)
+{
+  DynamicResolution resolution;
+  run_frames(resolution, 300, 40.0f);
+  ASSERT_LT(resolution.get_scale(), 1.0f);
+
+  run_frames(resolution, 1000, 4.0f);
+  EXPECT_FLOAT_EQ(1.0f, resolution.get_scale());
+}
+
+TEST(DynamicResolutionTest, waits_after_change)
+{
+  DynamicResolution resolution;
+  resolution.update(100.0f, 16.0f, 0.5f, 1.0f);
+  const float scale = resolution.get_scale();
+  ASSERT_LT(scale, 1.0f);
+
+  for (int i = 0; i < DynamicResolution::COOLDOWN_FRAMES; ++i) {
+    resolution.update(100.0f, 16.0f, 0.5f, 1.0f);
+    ASSERT_EQ(scale, resolution.get_scale());
+  }
+}
+
+/* EOF */
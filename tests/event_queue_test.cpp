@@ -0,0 +1,124 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <limits>
+
+#include "supertux/event_queue.hpp"
+
+namespace {
+
+SDL_Event make_event(Uint32 type)
+{
+  SDL_Event event;
+  SDL_zero(event);
+  event.type = type;
+  return event;
+}
+
+SDL_Event make_axis_event(Uint8 axis, Sint16 value)
+{
+  SDL_Event event = make_event(SDL_CONTROLLERAXISMOTION);
+  event.caxis.axis = axis;
+  event.caxis.value = value;
+  return event;
+}
+
+int axis_zone(const SDL_Event& event)
+{
+  return (event.caxis.value < -100) ? -1 : (event.caxis.value > 100) ? 1 : 0;
+}
+
+} // namespace
+
+TEST(EventQueueTest, pop_until)
+{
+  EventQueue queue;
+  queue.push(make_event(SDL_KEYDOWN), 1000);
+  queue.push(make_event(SDL_KEYUP), 3000);
+  queue.push(make_event(SDL_MOUSEBUTTONDOWN), 5000);
+
+  EventQueue::Entry entry;
+  ASSERT_FALSE(queue.pop(999, entry));
+
+  ASSERT_TRUE(queue.pop(3000, entry));
+  EXPECT_EQ(static_cast<Uint32>(SDL_KEYDOWN), entry.event.type);
+  EXPECT_EQ(1000u, entry.time_us);
+
+  ASSERT_TRUE(queue.pop(3000, entry));
+  EXPECT_EQ(static_cast<Uint32>(SDL_KEYUP), entry.event.type);
+
+  ASSERT_FALSE(queue.pop(3000, entry));
+  ASSERT_FALSE(queue.empty());
+
+  ASSERT_TRUE(queue.pop(std::numeric_limits<uint64_t>::max(), entry));
+  EXPECT_EQ(static_cast<Uint32>(SDL_MOUSEBUTTONDOWN), entry.event.type);
+  EXPECT_TRUE(queue.empty());
+}
+
+TEST(EventQueueTest, keeps_order)
+{
+  EventQueue queue;
+  queue.push(make_event(SDL_KEYDOWN), 5000);
+  queue.push(make_event(SDL_KEYUP), 2000);
+
+  // the release can't be handled before the press
+  EventQueue::Entry entry;
+  ASSERT_FALSE(queue.pop(2000, entry));
+
+  ASSERT_TRUE(queue.pop(5000, entry));
+  EXPECT_EQ(static_cast<Uint32>(SDL_KEYDOWN), entry.event.type);
+  ASSERT_TRUE(queue.pop(5000, entry));
+  EXPECT_EQ(static_cast<Uint32>(SDL_KEYUP), entry.event.type);
+  EXPECT_EQ(5000u, entry.time_us);
+}
+
+TEST(EventQueueTest, coalesce_axis)
+{
+  EventQueue queue;
+  queue.set_axis_zone_func(axis_zone);
+
+  // jitter within the dead zone ends up as one event with the latest value
+  for (Sint16 value = 0; value < 50; ++value) {
+    queue.push(make_axis_event(0, value), 1000);
+    queue.push(make_axis_event(1, static_cast<Sint16>(-value)), 1000);
+  }
+
+  // leaving the dead zone is kept, as is a button in between
+  queue.push(make_axis_event(0, 5000), 2000);
+  queue.push(make_event(SDL_CONTROLLERBUTTONDOWN), 2000);
+  queue.push(make_axis_event(0, 6000), 3000);
+
+  EventQueue::Entry entry;
+  ASSERT_TRUE(queue.pop(1000, entry));
+  EXPECT_EQ(0, entry.event.caxis.axis);
+  EXPECT_EQ(49, entry.event.caxis.value);
+  ASSERT_TRUE(queue.pop(1000, entry));
+  EXPECT_EQ(1, entry.event.caxis.axis);
+  EXPECT_EQ(-49, entry.event.caxis.value);
+  ASSERT_FALSE(queue.pop(1000, entry));
+
+  ASSERT_TRUE(queue.pop(3000, entry));
+  EXPECT_EQ(5000, entry.event.caxis.value);
+  ASSERT_TRUE(queue.pop(3000, entry));
+  EXPECT_EQ(static_cast<Uint32>(SDL_CONTROLLERBUTTONDOWN), entry.event.type);
+  ASSERT_TRUE(queue.pop(3000, entry));
+  EXPECT_EQ(6000, entry.event.caxis.value);
+  EXPECT_TRUE(queue.empty());
+}
+
+/* EOF */
@@ -0,0 +1,73 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "math/fast_random.hpp"
+
+TEST(FastRandomTest, ranges)
+{
+  FastRandom random(0);
+  for (int i = 0; i < 1000; ++i)
+  {
+    const int v = random.rand(10, 20);
+    ASSERT_LE(10, v);
+    ASSERT_LT(v, 20);
+
+    const float f = random.randf(-1.0f, 1.0f);
+    ASSERT_LE(-1.0f, f);
+    ASSERT_LT(f, 1.0f);
+
+    ASSERT_LE(0, random.rand());
+  }
+  ASSERT_EQ(5, random.rand(5, 5));
+}
+
+TEST(FastRandomTest, known_sequence)
+{
+  // reference output of pcg32 seeded with 42 on stream 54
+  FastRandom random(42, 54);
+  const uint32_t expected[] = { 0xa15c02b7, 0x7b47f409, 0xba1d3330, 0x83d2f293, 0xbfa4784b, 0xcbed606e };
+  for (const auto value : expected) {
+    ASSERT_EQ(value, random.next());
+  }
+}
+
+TEST(FastRandomTest, streams)
+{
+  FastRandom a(7, 1);
+  FastRandom b(7, 2);
+  FastRandom c(7, 1);
+
+  std::vector<uint32_t> run_a, run_b, run_c;
+  for (int i = 0; i < 100; ++i) {
+    run_a.push_back(a.next());
+    run_b.push_back(b.next());
+    run_c.push_back(c.next());
+  }
+  ASSERT_EQ(run_a, run_c);
+  ASSERT_NE(run_a, run_b);
+
+  FastRandom parent(3);
+  FastRandom child1 = parent.split();
+  FastRandom child2 = parent.split();
+  ASSERT_NE(child1.next(), child2.next());
+}
+
+/* EOF */
@@ -0,0 +1,93 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <string>
+#include <unordered_map>
+
+#include "math/random.hpp"
+#include "util/flat_hash_map.hpp"
+
+TEST(FlatHashMapTest, basics)
+{
+  FlatHashMap<std::string, int> map;
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(nullptr, map.find("foo"));
+
+  map.insert("foo", 1);
+  map.insert("bar", 2);
+  map.insert("foo", 3);
+  ASSERT_EQ(2u, map.size());
+  ASSERT_EQ(3, *map.find("foo"));
+  ASSERT_EQ(2, *map.find("bar"));
+
+  ASSERT_TRUE(map.erase("foo"));
+  ASSERT_FALSE(map.erase("foo"));
+  ASSERT_EQ(nullptr, map.find("foo"));
+  ASSERT_EQ(2, *map.find("bar"));
+
+  map.clear();
+  ASSERT_TRUE(map.empty());
+  ASSERT_EQ(nullptr, map.find("bar"));
+}
+
+TEST(FlatHashMapTest, matches_unordered_map)
+{
+  Random rng;
+  rng.seed(99);
+
+  FlatHashMap<uint32_t, int> map;
+  std::unordered_map<uint32_t, int> expected;
+  for (int i = 0; i < 20000; ++i)
+  {
+    // few distinct keys, so erasing and probe chains get exercised
+    const uint32_t key = static_cast<uint32_t>(rng.rand(0, 200)) << 24 | static_cast<uint32_t>(rng.rand(0, 3));
+    if (rng.rand(0, 3) == 0)
+    {
+      ASSERT_EQ(expected.erase(key) == 1, map.erase(key));
+    }
+    else
+    {
+      expected[key] = i;
+      map.insert(key, i);
+    }
+    ASSERT_EQ(expected.size(), map.size());
+  }
+
+  for (const auto& entry : expected) {
+    ASSERT_NE(nullptr, map.find(entry.first));
+    ASSERT_EQ(entry.second, *map.find(entry.first));
+  }
+  for (uint32_t key = 0; key < 1000; ++key) {
+    ASSERT_EQ(expected.count(key) == 1, map.find(key) != nullptr);
+  }
+}
+
+TEST(FlatHashMapTest, reserve)
+{
+  FlatHashMap<int, int> map;
+  map.insert(5, 50);
+  map.reserve(1000);
+  for (int i = 0; i < 1000; ++i) {
+    map.insert(i, i * 10);
+  }
+  ASSERT_EQ(1000u, map.size());
+  ASSERT_EQ(50, *map.find(5));
+  ASSERT_EQ(9990, *map.find(999));
+}
+
+/* EOF */
@@ -0,0 +1,44 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "util/fnv_hash.hpp"
+
+TEST(FNVHashTest, reference_values)
+{
+  FNVHash empty;
+  ASSERT_EQ(0xcbf29ce484222325ULL, empty.get());
+
+  FNVHash hash;
+  hash.add("foobar", 6);
+  ASSERT_EQ(0x85944171f73967e8ULL, hash.get());
+}
+
+TEST(FNVHashTest, order_matters)
+{
+  FNVHash lhs;
+  lhs.add(1);
+  lhs.add(2.0f);
+
+  FNVHash rhs;
+  rhs.add(2.0f);
+  rhs.add(1);
+
+  ASSERT_NE(lhs.get(), rhs.get());
+}
+
+/* EOF */
@@ -0,0 +1,106 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "video/font.hpp"
+
+namespace {
+
+/** Every byte is 10 pixels wide, good enough to test the wrapping */
+class FixedFont final : public Font
+{
+public:
+  FixedFont() : calls(0) {}
+
+  virtual float get_height() const override { return 10.0f; }
+  virtual float get_text_width(const std::string& text) const override
+  {
+    calls += 1;
+    return 10.0f * static_cast<float>(text.length());
+  }
+  virtual float get_text_height(const std::string&) const override { return 10.0f; }
+  virtual void draw_text(Canvas&, const std::string&, const Vector&, FontAlignment, int, const Color&) override {}
+
+  mutable int calls;
+};
+
+} // namespace
+
+TEST(FontTest, wrap_to_width_fits)
+{
+  FixedFont font;
+  std::string overflow = "x";
+  ASSERT_EQ("hello world", font.wrap_to_width("hello world", 110.0f, &overflow));
+  ASSERT_EQ("", overflow);
+}
+
+TEST(FontTest, wrap_to_width_whitespace)
+{
+  FixedFont font;
+  std::string overflow;
+  ASSERT_EQ("hello big", font.wrap_to_width("hello big world", 100.0f, &overflow));
+  ASSERT_EQ("world", overflow);
+
+  // a space right at the limit may be used
+  ASSERT_EQ("hello", font.wrap_to_width("hello world", 50.0f, &overflow));
+  ASSERT_EQ("world", overflow);
+}
+
+TEST(FontTest, wrap_to_width_hard)
+{
+  FixedFont font;
+  std::string overflow;
+  ASSERT_EQ("abcd", font.wrap_to_width("abcdefgh", 45.0f, &overflow));
+  ASSERT_EQ("efgh", overflow);
+
+  // at least one character is always taken
+  ASSERT_EQ("a", font.wrap_to_width("abc", 5.0f, &overflow));
+  ASSERT_EQ("bc", overflow);
+
+  // multibyte characters are not split
+  ASSERT_EQ("\xc3\xa4", font.wrap_to_width("\xc3\xa4\xc3\xb6", 25.0f, &overflow));
+  ASSERT_EQ("\xc3\xb6", overflow);
+}
+
+TEST(FontTest, wrap_to_width_measures_logarithmically)
+{
+  FixedFont font;
+  std::string text;
+  for (int i = 0; i < 1000; ++i) {
+    text += "word ";
+  }
+
+  std::string overflow;
+  font.wrap_to_width(text, 600.0f, &overflow);
+  ASSERT_LT(font.calls, 20);
+}
+
+TEST(FontTest, text_width_cache)
+{
+  TextWidthCache cache;
+  float width = 0.0f;
+  ASSERT_FALSE(cache.get("foo", width));
+
+  cache.set("foo", 12.0f);
+  ASSERT_TRUE(cache.get("foo", width));
+  ASSERT_EQ(12.0f, width);
+
+  cache.clear();
+  ASSERT_FALSE(cache.get("foo", width));
+}
+
+/* EOF */
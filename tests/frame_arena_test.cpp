@@ -0,0 +1,60 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "video/frame_arena.hpp"
+
+TEST(FrameArenaTest, grows_and_shrinks)
+{
+  FrameArena arena;
+  const size_t initial = arena.get_capacity();
+
+  // a small frame reuses the chunk
+  obstack_alloc(&arena.get(), 1000);
+  ASSERT_GE(arena.get_used(), 1000u);
+  ASSERT_LT(arena.get_used(), 1100u);
+  arena.reset();
+  ASSERT_EQ(0u, arena.get_used());
+  ASSERT_EQ(initial, arena.get_capacity());
+
+  // a large frame spills over, the next ones get a chunk that fits
+  for (int i = 0; i < 100; ++i) {
+    obstack_alloc(&arena.get(), 10000);
+  }
+  arena.reset();
+  const size_t grown = arena.get_capacity();
+  ASSERT_GE(grown, 1000000u);
+
+  for (int i = 0; i < 100; ++i) {
+    obstack_alloc(&arena.get(), 10000);
+  }
+  ASSERT_LE(arena.get_used(), grown);
+  arena.reset();
+  ASSERT_EQ(grown, arena.get_capacity());
+
+  // it only shrinks after many small frames
+  for (int frame = 0; frame < 599; ++frame) {
+    obstack_alloc(&arena.get(), 1000);
+    arena.reset();
+  }
+  ASSERT_EQ(grown, arena.get_capacity());
+  obstack_alloc(&arena.get(), 1000);
+  arena.reset();
+  ASSERT_EQ(initial, arena.get_capacity());
+}
+
+/* EOF */
@@ -0,0 +1,66 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#include "util/interned_string.hpp"
+
+TEST(InternedStringTest, identity)
+{
+  const InternedString a("sounds/jump.wav");
+  const InternedString b(std::string("sounds/") + "jump.wav");
+  const InternedString c("sounds/bigjump.wav");
+
+  ASSERT_EQ(a, b);
+  ASSERT_EQ(&a.str(), &b.str());
+  ASSERT_NE(a, c);
+  ASSERT_EQ("sounds/jump.wav", a.str());
+  ASSERT_EQ(std::hash<InternedString>()(a), std::hash<InternedString>()(b));
+
+  ASSERT_TRUE(InternedString().empty());
+  ASSERT_EQ(InternedString(), InternedString(""));
+
+  std::ostringstream out;
+  out << c;
+  ASSERT_EQ("sounds/bigjump.wav", out.str());
+}
+
+TEST(InternedStringTest, threads)
+{
+  std::vector<const std::string*> results(8);
+  std::vector<std::thread> threads;
+  for (size_t i = 0; i < results.size(); ++i) {
+    threads.emplace_back([&results, i] {
+        for (int j = 0; j < 1000; ++j) {
+          InternedString("thread-test-" + std::to_string(j));
+        }
+        results[i] = &InternedString("thread-test-500").str();
+      });
+  }
+  for (auto& thread : threads) {
+    thread.join();
+  }
+
+  for (const auto* result : results) {
+    ASSERT_EQ(results[0], result);
+  }
+}
+
+/* EOF */
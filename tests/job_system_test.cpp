@@ -0,0 +1,163 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <atomic>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+#include "util/job_system.hpp"
+
+TEST(JobSystemTest, dependencies)
+{
+  JobSystem jobs(4);
+
+  std::atomic<int> counter(0);
+  std::vector<JobSystem::Handle> leaves;
+  for (int i = 0; i < 100; ++i) {
+    leaves.push_back(jobs.schedule([&counter]{ counter += 1; }));
+  }
+
+  int seen = -1;
+  const auto main_id = std::this_thread::get_id();
+  std::thread::id main_job_thread;
+  auto main_job = jobs.schedule_on_main_thread([&]{
+      main_job_thread = std::this_thread::get_id();
+      seen = counter;
+    }, leaves);
+  auto last = jobs.schedule([&counter]{ counter += 1; }, {main_job});
+
+  jobs.wait(last);
+  ASSERT_EQ(100, seen);
+  ASSERT_EQ(101, counter);
+  ASSERT_EQ(main_id, main_job_thread);
+  ASSERT_TRUE(main_job.is_done());
+}
+
+TEST(JobSystemTest, nested_jobs)
+{
+  JobSystem jobs(3);
+
+  std::atomic<int> counter(0);
+  auto outer = jobs.schedule([&jobs, &counter]{
+      std::vector<JobSystem::Handle> inner;
+      for (int i = 0; i < 50; ++i) {
+        inner.push_back(jobs.schedule([&counter]{ counter += 1; }));
+      }
+      // a worker waiting on a queued job runs it instead of blocking
+      for (const auto& job : inner) {
+        jobs.wait(job);
+      }
+    });
+
+  jobs.wait(outer);
+  ASSERT_EQ(50, counter);
+}
+
+TEST(JobSystemTest, wait_runs_only_the_awaited_job)
+{
+  JobSystem jobs(1);
+
+  // keep the only worker busy
+  std::atomic<bool> started(false);
+  std::atomic<bool> release(false);
+  auto busy = jobs.schedule([&started, &release]{
+      started = true;
+      while (!release) {
+        std::this_thread::yield();
+      }
+    });
+  while (!started) {
+    std::this_thread::yield();
+  }
+
+  const auto main_id = std::this_thread::get_id();
+  bool unrelated_main_ran = false;
+  auto unrelated = jobs.schedule([]{});
+  jobs.schedule_on_main_thread([&]{ unrelated_main_ran = true; });
+
+  std::thread::id depend_thread;
+  std::thread::id awaited_thread;
+  auto depend = jobs.schedule([&]{ depend_thread = std::this_thread::get_id(); });
+  auto awaited = jobs.schedule([&]{ awaited_thread = std::this_thread::get_id(); }, {depend});
+
+  jobs.wait(awaited);
+  ASSERT_EQ(main_id, depend_thread);
+  ASSERT_EQ(main_id, awaited_thread);
+  ASSERT_FALSE(unrelated.is_done());
+  ASSERT_FALSE(unrelated_main_ran);
+
+  release = true;
+  jobs.wait(busy);
+  jobs.wait(unrelated);
+  ASSERT_EQ(1, jobs.process_main_thread());
+  ASSERT_TRUE(unrelated_main_ran);
+}
+
+TEST(JobSystemTest, error_skips_dependents)
+{
+  JobSystem jobs(2);
+
+  std::atomic<bool> ran(false);
+  auto fail = jobs.schedule([]{ throw std::runtime_error("fail"); });
+  auto after = jobs.schedule([&ran]{ ran = true; }, {fail});
+
+  ASSERT_THROW(jobs.wait(after), std::runtime_error);
+  ASSERT_THROW(jobs.wait(fail), std::runtime_error);
+  ASSERT_FALSE(ran);
+
+  // depending on an already failed job fails right away
+  auto late = jobs.schedule([&ran]{ ran = true; }, {fail});
+  ASSERT_THROW(jobs.wait(late), std::runtime_error);
+  ASSERT_FALSE(ran);
+}
+
+TEST(JobSystemTest, default_handle)
+{
+  JobSystem jobs(1);
+  JobSystem::Handle handle;
+  ASSERT_TRUE(handle.is_done());
+  jobs.wait(handle);
+  ASSERT_EQ(0, jobs.process_main_thread());
+}
+
+TEST(JobSystemTest, async)
+{
+  JobSystem jobs(3);
+
+  std::vector<std::future<int> > futures;
+  for (int i = 0; i < 100; ++i) {
+    futures.push_back(JobSystem::async([i]{ return i * i; }));
+  }
+
+  for (int i = 0; i < 100; ++i) {
+    ASSERT_EQ(i * i, futures[i].get());
+  }
+
+  auto failed = JobSystem::async([]() -> int { throw std::runtime_error("failed"); });
+  ASSERT_THROW(failed.get(), std::runtime_error);
+}
+
+TEST(JobSystemTest, async_without_job_system)
+{
+  const auto caller = std::this_thread::get_id();
+  auto future = JobSystem::async([]{ return std::this_thread::get_id(); });
+  ASSERT_EQ(caller, future.get());
+}
+
+/* EOF */
@@ -0,0 +1,49 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <stdexcept>
+
+#include "supertux/level_generator.hpp"
+
+TEST(LevelGeneratorTest, parse_params)
+{
+  const auto params = LevelGenerator::parse_params("width=1000,badguys=8,lights=3,seed=7");
+  ASSERT_EQ(1000, params.width);
+  ASSERT_EQ(8, params.badguys);
+  ASSERT_EQ(3, params.lights);
+  ASSERT_EQ(7, params.seed);
+
+  // the rest keeps the defaults
+  const LevelGenerator::Params defaults;
+  ASSERT_EQ(defaults.height, params.height);
+  ASSERT_EQ(defaults.coins, params.coins);
+
+  ASSERT_EQ(defaults.width, LevelGenerator::parse_params("").width);
+}
+
+TEST(LevelGeneratorTest, parse_params_errors)
+{
+  ASSERT_THROW(LevelGenerator::parse_params("bogus=1"), std::runtime_error);
+  ASSERT_THROW(LevelGenerator::parse_params("width"), std::runtime_error);
+  ASSERT_THROW(LevelGenerator::parse_params("width=12x"), std::runtime_error);
+  ASSERT_THROW(LevelGenerator::parse_params("coins=-1"), std::runtime_error);
+  ASSERT_THROW(LevelGenerator::parse_params("height=5"), std::runtime_error);
+}
+
+/* EOF */
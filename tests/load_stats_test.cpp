@@ -0,0 +1,98 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <thread>
+
+#include "supertux/load_stats.hpp"
+#include "util/profiler.hpp"
+
+TEST(LoadStatsTest, nested_phases)
+{
+  g_load_stats.begin("test.stl");
+  {
+    LoadStats::Scope sectors(LoadStats::SECTORS);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    {
+      LoadStats::Scope objects(LoadStats::OBJECTS);
+      g_load_stats.add_object();
+      g_load_stats.add_object();
+      std::this_thread::sleep_for(std::chrono::milliseconds(10));
+    }
+  }
+  g_load_stats.end();
+
+  const LoadStats::Report& report = g_load_stats.get_report();
+  EXPECT_EQ("test.stl", report.level);
+  EXPECT_EQ(2, report.objects);
+
+  // inner phases don't count towards outer ones
+  EXPECT_GE(report.phase_ns[LoadStats::OBJECTS], 10000000u);
+  EXPECT_GE(report.phase_ns[LoadStats::SECTORS], 5000000u);
+  EXPECT_LT(report.phase_ns[LoadStats::SECTORS], report.phase_ns[LoadStats::OBJECTS]);
+  EXPECT_GE(report.total_ns, report.phase_ns[LoadStats::SECTORS] + report.phase_ns[LoadStats::OBJECTS]);
+}
+
+TEST(LoadStatsTest, nested_loads_and_threads)
+{
+  g_load_stats.begin("outer.stl");
+  g_load_stats.begin("inner.stl");
+  g_load_stats.add_file("file.png");
+  g_load_stats.end();
+  EXPECT_TRUE(g_load_stats.is_recording());
+
+  std::thread thread([]{
+      // counted, but not timed
+      LoadStats::Scope textures(LoadStats::TEXTURES);
+      g_load_stats.add_bytes_decoded(1024);
+      g_load_stats.add_file("file.png");
+    });
+  thread.join();
+  g_load_stats.end();
+
+  EXPECT_FALSE(g_load_stats.is_recording());
+
+  const LoadStats::Report& report = g_load_stats.get_report();
+  EXPECT_EQ("outer.stl", report.level);
+  EXPECT_EQ(2, report.files);
+  EXPECT_EQ(1024u, report.bytes_decoded);
+  EXPECT_EQ(0u, report.phase_ns[LoadStats::TEXTURES]);
+
+  // nothing is counted outside of a load
+  g_load_stats.add_object();
+  g_load_stats.begin("empty.stl");
+  g_load_stats.end();
+  EXPECT_EQ(0, g_load_stats.get_report().objects);
+}
+
+TEST(LoadStatsTest, recent_files)
+{
+  const uint64_t start_ns = Profiler::get_time_ns();
+  for (size_t i = 0; i < LoadStats::NUM_RECENT_FILES + 5; ++i) {
+    g_load_stats.add_file("file" + std::to_string(i));
+  }
+
+  const auto files = g_load_stats.get_recent_files(start_ns);
+  ASSERT_EQ(LoadStats::NUM_RECENT_FILES, files.size());
+  EXPECT_EQ("file5", files.front().filename);
+  EXPECT_EQ("file" + std::to_string(LoadStats::NUM_RECENT_FILES + 4), files.back().filename);
+
+  EXPECT_TRUE(g_load_stats.get_recent_files(Profiler::get_time_ns() + 1000000000).empty());
+}
+
+/* EOF */
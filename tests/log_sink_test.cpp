@@ -0,0 +1,75 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "util/log_sink.hpp"
+
+TEST(LogSinkTest, keeps_order)
+{
+  std::ostringstream out;
+  {
+    LogSink sink(out);
+    for (int i = 0; i < 100; ++i) {
+      LogSink::write(std::to_string(i));
+    }
+  }
+
+  std::ostringstream expected;
+  for (int i = 0; i < 100; ++i) {
+    expected << i << '\n';
+  }
+  ASSERT_EQ(expected.str(), out.str());
+}
+
+TEST(LogSinkTest, flush)
+{
+  std::ostringstream out;
+  LogSink sink(out);
+  LogSink::write("hello");
+  sink.flush();
+  ASSERT_EQ("hello\n", out.str());
+}
+
+TEST(LogSinkTest, drops_lines_when_full)
+{
+  std::ostringstream out;
+  {
+    LogSink sink(out);
+
+    for (int i = 0; i < 5000; ++i) {
+      LogSink::write("line");
+    }
+  }
+
+  // every line was either written or counted as dropped
+  const std::string text = out.str();
+  int lines = 0;
+  for (size_t pos = text.find("line\n"); pos != std::string::npos; pos = text.find("line\n", pos + 1)) {
+    lines += 1;
+  }
+
+  int dropped = 0;
+  for (size_t pos = text.find("[WARNING] "); pos != std::string::npos; pos = text.find("[WARNING] ", pos + 1)) {
+    dropped += std::stoi(text.substr(pos + 10));
+  }
+  ASSERT_EQ(5000, lines + dropped);
+}
+
+/* EOF */
@@ -0,0 +1,72 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <set>
+#include <stdint.h>
+
+#include "util/object_pool.hpp"
+
+namespace {
+
+class Pooled final : public PooledObject<Pooled>
+{
+public:
+  Pooled(int value) : m_value(value) {}
+  double m_padding[3] = {};
+  int m_value;
+};
+
+} // namespace
+
+TEST(ObjectPoolTest, reuse)
+{
+  ObjectPool pool(24, 8, 4);
+
+  std::set<void*> slots;
+  for (int i = 0; i < 10; ++i)
+  {
+    void* slot = pool.allocate();
+    ASSERT_EQ(0u, reinterpret_cast<uintptr_t>(slot) % 8);
+    ASSERT_TRUE(slots.insert(slot).second);
+  }
+  ASSERT_EQ(3u, pool.get_block_count());
+
+  void* slot = *slots.begin();
+  pool.deallocate(slot);
+  ASSERT_EQ(slot, pool.allocate());
+  ASSERT_EQ(3u, pool.get_block_count());
+}
+
+TEST(ObjectPoolTest, pooled_object)
+{
+  std::vector<std::unique_ptr<Pooled>> objects;
+  for (int i = 0; i < 1000; ++i) {
+    objects.push_back(std::make_unique<Pooled>(i));
+  }
+  for (int i = 0; i < 1000; ++i) {
+    ASSERT_EQ(i, objects[i]->m_value);
+  }
+
+  Pooled* first = objects.front().get();
+  objects.front().reset();
+  objects.push_back(std::make_unique<Pooled>(1000));
+  ASSERT_EQ(first, objects.back().get());
+}
+
+/* EOF */
@@ -0,0 +1,145 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <sstream>
+#include <stdio.h>
+#include <string>
+#include <thread>
+
+#include "util/profiler.hpp"
+
+namespace {
+
+void record_frame()
+{
+  g_profiler.begin_frame();
+  for (int step = 0; step < 2; ++step)
+  {
+    Profiler::Scope update_scope("update");
+    {
+      Profiler::Scope sector_scope("sector");
+      Profiler::Scope collision_scope("collision");
+    }
+    Profiler::Scope scripts_scope("scripts");
+  }
+  Profiler::Scope draw_scope("draw");
+}
+
+} // namespace
+
+TEST(ProfilerTest, tree)
+{
+  g_profiler.set_enabled(true);
+  record_frame();
+  g_profiler.set_enabled(false);
+  g_profiler.begin_frame();
+
+  const Profiler::Frame* frame = g_profiler.get_frame(0);
+  ASSERT_NE(nullptr, frame);
+  ASSERT_EQ(9u, frame->zones.size());
+
+  const auto tree = Profiler::get_tree(*frame);
+  ASSERT_EQ(5u, tree.size());
+
+  const char* names[] = { "update", "sector", "collision", "scripts", "draw" };
+  const int depths[] = { 0, 1, 2, 1, 0 };
+  const int calls[] = { 2, 2, 2, 2, 1 };
+  for (size_t i = 0; i < tree.size(); ++i)
+  {
+    EXPECT_EQ(std::string(names[i]), tree[i].name);
+    EXPECT_EQ(depths[i], tree[i].depth);
+    EXPECT_EQ(calls[i], tree[i].calls);
+    EXPECT_LE(0.0f, tree[i].ms);
+  }
+  EXPECT_LE(tree[1].ms, tree[0].ms);
+}
+
+TEST(ProfilerTest, ring_buffer)
+{
+  g_profiler.set_enabled(true);
+  g_profiler.begin_frame();
+  ASSERT_EQ(0u, g_profiler.get_frame_count());
+
+  for (size_t i = 0; i < Profiler::NUM_FRAMES + 10; ++i) {
+    g_profiler.begin_frame();
+  }
+
+  ASSERT_EQ(Profiler::NUM_FRAMES, g_profiler.get_frame_count());
+  ASSERT_EQ(nullptr, g_profiler.get_frame(Profiler::NUM_FRAMES));
+  EXPECT_EQ(g_profiler.get_frame(0)->id, g_profiler.get_frame(1)->id + 1);
+  EXPECT_NE(nullptr, g_profiler.get_slowest_frame());
+}
+
+TEST(ProfilerTest, disabled_and_other_threads)
+{
+  g_profiler.set_enabled(false);
+  g_profiler.begin_frame();
+  {
+    Profiler::Scope scope("ignored");
+  }
+
+  g_profiler.set_enabled(true);
+  g_profiler.begin_frame();
+  std::thread thread([]{
+      Profiler::Scope scope("other thread");
+    });
+  thread.join();
+  g_profiler.set_enabled(false);
+  g_profiler.begin_frame();
+
+  ASSERT_EQ(1u, g_profiler.get_frame_count());
+  ASSERT_TRUE(g_profiler.get_frame(0)->zones.empty());
+}
+
+TEST(ProfilerTest, trace)
+{
+  const std::string filename = testing::TempDir() + "profiler_test_trace.json";
+
+  g_profiler.open_trace(filename);
+  g_profiler.set_enabled(true);
+  g_profiler.begin_frame();
+  {
+    Profiler::Scope scope("main \"zone\"");
+    std::thread thread([]{
+        Profiler::set_thread_name("worker");
+        Profiler::Scope worker_scope("worker zone");
+      });
+    thread.join();
+  }
+  g_profiler.set_enabled(false);
+  g_profiler.begin_frame();
+  g_profiler.close_trace();
+  ASSERT_FALSE(g_profiler.is_tracing());
+
+  std::ifstream in(filename);
+  std::stringstream text;
+  text << in.rdbuf();
+  const std::string trace = text.str();
+  remove(filename.c_str());
+
+  EXPECT_EQ(0u, trace.find("{\"traceEvents\":["));
+  EXPECT_EQ(trace.size() - 3, trace.rfind("]}\n"));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"frame\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"main \\\"zone\\\"\""));
+  EXPECT_NE(std::string::npos, trace.find("\"name\":\"worker zone\""));
+  EXPECT_NE(std::string::npos, trace.find("\"args\":{\"name\":\"worker\"}"));
+}
+
+/* EOF */
@@ -112,4 +112,19 @@ TEST(RandomTest, randf_determinism)
   ASSERT_EQ(run1, run2);
 }
 
+TEST(RandomTest, state_hash)
+{
+  Random random;
+  random.seed(0);
+
+  const uint32_t hash = random.get_state_hash();
+  ASSERT_EQ(hash, random.get_state_hash());
+
+  random.rand();
+  ASSERT_NE(hash, random.get_state_hash());
+
+  random.seed(0);
+  ASSERT_EQ(hash, random.get_state_hash());
+}
+
 /* EOF */
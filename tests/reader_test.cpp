@@ -169,4 +169,50 @@ TEST(ReaderTest, syntax_error)
   ASSERT_THROW({mymapping->get("b", myint);}, std::runtime_error);
 }
 
+TEST(ReaderTest, indexed_lookup)
+{
+  std::istringstream in(
+    "(supertux-test\n"
+    "   (k 1) (j 2) (i 3) (h 4) (g 5) (f 6) (e 7) (d 8) (c 9) (b 10) (a 11)\n"
+    "   (c 12)\n"
+    ")\n");
+
+  auto doc = ReaderDocument::from_stream(in);
+  auto mapping = doc.get_root().get_mapping();
+
+  int value = 0;
+  ASSERT_TRUE(mapping.get("a", value));
+  ASSERT_EQ(11, value);
+  ASSERT_TRUE(mapping.get("k", value));
+  ASSERT_EQ(1, value);
+
+  // duplicates resolve to the first entry
+  ASSERT_TRUE(mapping.get("c", value));
+  ASSERT_EQ(9, value);
+
+  ASSERT_FALSE(mapping.get("aa", value));
+  ASSERT_FALSE(mapping.get("l", value));
+  ASSERT_FALSE(mapping.get("", value));
+}
+
+TEST(ReaderTest, unused_keys)
+{
+  std::istringstream in(
+    "(supertux-test\n"
+    "   (x 1)\n"
+    "   (speed 2)\n"
+    "   (y 3)\n"
+    ")\n");
+
+  auto doc = ReaderDocument::from_stream(in);
+  auto mapping = doc.get_root().get_mapping();
+  ASSERT_EQ((std::vector<std::string>{"x", "speed", "y"}), mapping.get_unused_keys());
+
+  int value;
+  mapping.get("x", value);
+  mapping.get("y", value);
+  mapping.get("spede", value);
+  ASSERT_EQ((std::vector<std::string>{"speed"}), mapping.get_unused_keys());
+}
+
 /* EOF */
@@ -0,0 +1,71 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "video/render_stats.hpp"
+
+TEST(RenderStatsTest, sections_and_gpu_time)
+{
+  RenderStats stats;
+
+  stats.begin_frame(true);
+  const uint32_t frame_id = stats.get_frame_id();
+  const size_t section = stats.begin_section(DrawingTarget::COLORMAP, 50, 3);
+  stats.add_draw_call(6);
+  stats.add_draw_call(4);
+  stats.add_texture_bind();
+  stats.end_section();
+
+  // a second context drawing the same layer shares the section
+  ASSERT_EQ(section, stats.begin_section(DrawingTarget::COLORMAP, 50, 1));
+  stats.end_section();
+  ASSERT_NE(section, stats.begin_section(DrawingTarget::LIGHTMAP, 50, 1));
+  stats.end_section();
+  stats.add_state_change();
+  stats.add_elided_call();
+  stats.add_elided_call();
+
+  stats.add_gpu_time(frame_id, section, 1.5f);
+
+  ASSERT_EQ(nullptr, stats.get_complete_frame());
+  stats.begin_frame(true);
+  ASSERT_EQ(nullptr, stats.get_complete_frame());
+  stats.begin_frame(true);
+
+  const RenderStats::Frame* frame = stats.get_complete_frame();
+  ASSERT_NE(nullptr, frame);
+  ASSERT_EQ(frame_id, frame->id);
+  ASSERT_EQ(2u, frame->sections.size());
+  ASSERT_EQ(4, frame->sections[0].counters.requests);
+  ASSERT_EQ(2, frame->sections[0].counters.draw_calls);
+  ASSERT_EQ(10, frame->sections[0].counters.vertices);
+  ASSERT_EQ(1, frame->sections[0].counters.texture_binds);
+  ASSERT_EQ(1.5f, frame->sections[0].counters.gpu_ms);
+  ASSERT_EQ(1, frame->totals.state_changes);
+  ASSERT_EQ(2, frame->totals.elided_calls);
+  ASSERT_EQ(5, frame->totals.requests);
+}
+
+TEST(RenderStatsTest, disabled)
+{
+  RenderStats stats;
+  stats.begin_frame(false);
+  ASSERT_FALSE(stats.is_enabled());
+  ASSERT_EQ(RenderStats::NO_SECTION, stats.begin_section(DrawingTarget::COLORMAP, 0, 1));
+}
+
+/* EOF */
@@ -0,0 +1,75 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <sexp/parser.hpp>
+#include <sexp/value.hpp>
+
+#include "supertux/resave_rules.hpp"
+#include "util/reader_document.hpp"
+#include "util/reader_mapping.hpp"
+
+TEST(ResaveRulesTest, apply)
+{
+  sexp::Value sx = sexp::Parser::from_string(
+    "(supertux-level\n"
+    "  (sector\n"
+    "    (tilemap (width 3) (height 1) (tiles 12 0 12))\n"
+    "    (spiky (sprite \"images/old.sprite\"))\n"
+    "    (decal (sprite \"images/other.sprite\") (name \"images/old.sprite\"))))\n",
+    sexp::Parser::USE_ARRAYS);
+
+  ResaveRules rules;
+  rules.add_tile_rule(12, 34);
+  rules.add_string_rule("sprite", "images/old.sprite", "images/new.sprite");
+  ASSERT_EQ(3u, rules.apply(sx));
+
+  ReaderDocument doc("<test>", std::move(sx));
+  boost::optional<ReaderMapping> sector;
+  ASSERT_TRUE(doc.get_root().get_mapping().get("sector", sector));
+
+  boost::optional<ReaderMapping> tilemap;
+  ASSERT_TRUE(sector->get("tilemap", tilemap));
+  std::vector<unsigned int> tiles;
+  tilemap->get("tiles", tiles);
+  ASSERT_EQ((std::vector<unsigned int>{34, 0, 34}), tiles);
+
+  boost::optional<ReaderMapping> spiky;
+  ASSERT_TRUE(sector->get("spiky", spiky));
+  std::string sprite;
+  spiky->get("sprite", sprite);
+  ASSERT_EQ("images/new.sprite", sprite);
+
+  // the rule is limited to sprite entries
+  boost::optional<ReaderMapping> decal;
+  ASSERT_TRUE(sector->get("decal", decal));
+  std::string name;
+  decal->get("name", name);
+  ASSERT_EQ("images/old.sprite", name);
+}
+
+TEST(ResaveRulesTest, empty)
+{
+  sexp::Value sx = sexp::Parser::from_string("(supertux-level (tiles 1 2 3) (name \"x\"))",
+                                             sexp::Parser::USE_ARRAYS);
+  ResaveRules rules;
+  ASSERT_TRUE(rules.empty());
+  ASSERT_EQ(0u, rules.apply(sx));
+}
+
+/* EOF */
@@ -0,0 +1,65 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <sexp/value.hpp>
+
+#include "util/sexp_cache.hpp"
+
+namespace {
+
+sexp::Value make_document()
+{
+  using sexp::Value;
+  return Value::array({
+      Value::symbol("supertux-tiles"),
+      Value::array({ Value::symbol("tile"),
+                     Value::array({ Value::symbol("id"), Value::integer(-1234567) }),
+                     Value::array({ Value::symbol("images"), Value::string("tiles/blocks/bonus.png") }),
+                     Value::array({ Value::symbol("fps"), Value::real(12.5f) }),
+                     Value::array({ Value::symbol("solid"), Value::boolean(true) }) }),
+      Value::cons(Value::integer(1), Value::nil()),
+      Value::string(""),
+      Value::array({})
+    });
+}
+
+} // namespace
+
+TEST(SExpCacheTest, roundtrip)
+{
+  const sexp::Value sx = make_document();
+  const std::string data = SExpCache::serialize(sx);
+
+  sexp::Value result;
+  ASSERT_TRUE(SExpCache::deserialize(data, result));
+  ASSERT_EQ(sx, result);
+}
+
+TEST(SExpCacheTest, broken_data)
+{
+  const std::string data = SExpCache::serialize(make_document());
+
+  sexp::Value result;
+  for (size_t len = 0; len < data.size(); ++len) {
+    ASSERT_FALSE(SExpCache::deserialize(data.substr(0, len), result));
+  }
+  ASSERT_FALSE(SExpCache::deserialize(data + "x", result));
+  ASSERT_FALSE(SExpCache::deserialize(std::string(1, '\x7f') + data, result));
+}
+
+/* EOF */
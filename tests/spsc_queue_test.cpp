@@ -0,0 +1,75 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <thread>
+
+#include "util/spsc_queue.hpp"
+
+TEST(SPSCQueueTest, full_and_empty)
+{
+  SPSCQueue<int, 4> queue;
+  int value = 0;
+  ASSERT_FALSE(queue.pop(value));
+  ASSERT_TRUE(queue.empty());
+
+  ASSERT_TRUE(queue.push(1));
+  ASSERT_TRUE(queue.push(2));
+  ASSERT_TRUE(queue.push(3));
+  ASSERT_FALSE(queue.push(4));
+
+  ASSERT_TRUE(queue.pop(value));
+  ASSERT_EQ(1, value);
+  ASSERT_TRUE(queue.push(4));
+
+  for (int i = 2; i <= 4; ++i) {
+    ASSERT_TRUE(queue.pop(value));
+    ASSERT_EQ(i, value);
+  }
+  ASSERT_TRUE(queue.empty());
+}
+
+TEST(SPSCQueueTest, threads_keep_order)
+{
+  SPSCQueue<int, 16> queue;
+  const int count = 100000;
+
+  std::thread producer([&queue]{
+      for (int i = 0; i < count; ++i) {
+        while (!queue.push(i)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+
+  int expected = 0;
+  while (expected < count)
+  {
+    int value;
+    if (queue.pop(value)) {
+      ASSERT_EQ(expected, value);
+      expected += 1;
+    } else {
+      std::this_thread::yield();
+    }
+  }
+
+  producer.join();
+}
+
+/* EOF */
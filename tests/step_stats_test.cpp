@@ -0,0 +1,69 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "supertux/step_stats.hpp"
+
+TEST(StepStatsTest, disabled_records_nothing)
+{
+  StepStats stats;
+  stats.begin_step();
+  stats.add(StepStats::UPDATE, 5.0f);
+  ASSERT_EQ(0u, stats.get_step_count());
+  ASSERT_EQ(0.0f, stats.get_percentile(StepStats::UPDATE, 0.5f));
+}
+
+TEST(StepStatsTest, percentiles)
+{
+  StepStats stats;
+  stats.set_enabled(true);
+  for (int i = 1; i <= 100; ++i) {
+    stats.begin_step();
+    stats.add(StepStats::UPDATE, static_cast<float>(i));
+    stats.add(StepStats::UPDATE, 1.0f);
+    stats.add(StepStats::DRAW, 2.0f);
+  }
+
+  ASSERT_EQ(100u, stats.get_step_count());
+  ASSERT_EQ(52.0f, stats.get_percentile(StepStats::UPDATE, 0.5f));
+  ASSERT_EQ(97.0f, stats.get_percentile(StepStats::UPDATE, 0.95f));
+  ASSERT_EQ(101.0f, stats.get_percentile(StepStats::UPDATE, 1.0f));
+  ASSERT_EQ(2.0f, stats.get_percentile(StepStats::DRAW, 0.99f));
+  ASSERT_EQ(0.0f, stats.get_percentile(StepStats::COLLISION, 0.99f));
+  ASSERT_EQ(54.0f, stats.get_frame_percentile(0.5f));
+
+  std::ostringstream out;
+  stats.write_report(out);
+  ASSERT_NE(std::string::npos, out.str().find("100 steps"));
+  ASSERT_NE(std::string::npos, out.str().find("scripting"));
+  ASSERT_NE(std::string::npos, out.str().find("frame"));
+}
+
+TEST(StepStatsTest, scope)
+{
+  StepStats stats;
+  stats.set_enabled(true);
+  stats.begin_step();
+  {
+    StepStats::Scope scope(stats, StepStats::SCRIPTING);
+  }
+  ASSERT_LE(0.0f, stats.get_percentile(StepStats::SCRIPTING, 1.0f));
+}
+
+/* EOF */
@@ -0,0 +1,58 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include "squirrel/symbol_index.hpp"
+
+TEST(SymbolIndexTest, find)
+{
+  SymbolIndex index;
+  index.add("Tux");
+  index.add("Camera");
+  index.add("Text");
+  index.add("Tuxgate");
+
+  std::vector<std::string> result;
+  index.find("Tu", result);
+  ASSERT_EQ((std::vector<std::string>{"Tux", "Tuxgate"}), result);
+
+  result.clear();
+  index.find("", result);
+  ASSERT_EQ((std::vector<std::string>{"Camera", "Text", "Tux", "Tuxgate"}), result);
+
+  result.clear();
+  index.find("Z", result);
+  ASSERT_TRUE(result.empty());
+}
+
+TEST(SymbolIndexTest, refcount)
+{
+  SymbolIndex index;
+  index.add("platform");
+  index.add("platform");
+
+  index.remove("platform");
+  ASSERT_TRUE(index.contains("platform"));
+
+  index.remove("platform");
+  ASSERT_FALSE(index.contains("platform"));
+
+  index.remove("unknown");
+  ASSERT_EQ(0u, index.size());
+}
+
+/* EOF */
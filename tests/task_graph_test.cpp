@@ -0,0 +1,85 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <atomic>
+#include <sstream>
+#include <stdexcept>
+#include <thread>
+
+#include "util/job_system.hpp"
+#include "util/task_graph.hpp"
+
+TEST(TaskGraphTest, dependencies)
+{
+  JobSystem job_system(4);
+  TaskGraph graph;
+
+  std::mutex mutex;
+  std::vector<std::string> order;
+  auto record = [&mutex, &order](const std::string& name) {
+    return [&mutex, &order, name]{
+      std::lock_guard<std::mutex> lock(mutex);
+      order.push_back(name);
+    };
+  };
+
+  const auto main_id = std::this_thread::get_id();
+  std::thread::id video_thread;
+
+  graph.add_task("a", {}, record("a"));
+  graph.add_task("b", {}, record("b"));
+  graph.add_main_task("video", {"a"}, [&]{ video_thread = std::this_thread::get_id(); record("video")(); });
+  graph.add_task("c", {"video", "b"}, record("c"));
+  graph.run(job_system);
+
+  ASSERT_EQ(4u, order.size());
+  ASSERT_EQ(main_id, video_thread);
+
+  auto pos = [&order](const std::string& name) {
+    return std::find(order.begin(), order.end(), name) - order.begin();
+  };
+  ASSERT_LT(pos("a"), pos("video"));
+  ASSERT_LT(pos("video"), pos("c"));
+  ASSERT_LT(pos("b"), pos("c"));
+
+  std::ostringstream out;
+  graph.print_profile(out);
+  ASSERT_NE(std::string::npos, out.str().find("video"));
+}
+
+TEST(TaskGraphTest, unknown_dependency)
+{
+  TaskGraph graph;
+  ASSERT_THROW(graph.add_task("a", {"b"}, []{}), std::runtime_error);
+}
+
+TEST(TaskGraphTest, error_stops_dependents)
+{
+  JobSystem job_system(2);
+  TaskGraph graph;
+
+  std::atomic<bool> ran(false);
+  graph.add_task("fail", {}, []{ throw std::runtime_error("fail"); });
+  graph.add_main_task("after", {"fail"}, [&ran]{ ran = true; });
+  ASSERT_THROW(graph.run(job_system), std::runtime_error);
+  ASSERT_FALSE(ran);
+}
+
+/* EOF */
@@ -0,0 +1,77 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <vector>
+
+#include "video/texture_packer.hpp"
+
+namespace {
+
+bool overlap(const Rect& lhs, const Rect& rhs)
+{
+  return lhs.left < rhs.right && rhs.left < lhs.right &&
+         lhs.top < rhs.bottom && rhs.top < lhs.bottom;
+}
+
+} // namespace
+
+TEST(TexturePackerTest, rows)
+{
+  TexturePacker packer(Size(100, 100));
+
+  Rect region;
+  ASSERT_TRUE(packer.insert(Size(60, 40), region));
+  ASSERT_EQ(Rect(0, 0, 60, 40), region);
+
+  ASSERT_TRUE(packer.insert(Size(40, 30), region));
+  ASSERT_EQ(Rect(60, 0, 100, 30), region);
+
+  // doesn't fit next to the others anymore
+  ASSERT_TRUE(packer.insert(Size(10, 10), region));
+  ASSERT_EQ(Rect(0, 40, 10, 50), region);
+
+  ASSERT_FALSE(packer.insert(Size(101, 1), region));
+  ASSERT_FALSE(packer.insert(Size(100, 61), region));
+  ASSERT_TRUE(packer.insert(Size(100, 50), region));
+  ASSERT_EQ(Rect(0, 50, 100, 100), region);
+  ASSERT_FALSE(packer.insert(Size(1, 1), region));
+}
+
+TEST(TexturePackerTest, no_overlap)
+{
+  TexturePacker packer(Size(256, 256));
+
+  std::vector<Rect> regions;
+  Rect region;
+  for (int i = 0; i < 100; ++i)
+  {
+    const Size size(16 + (i * 7) % 20, 32 - i / 10);
+    if (!packer.insert(size, region))
+      break;
+
+    ASSERT_EQ(size, region.get_size());
+    ASSERT_TRUE(Rect(0, 0, 256, 256).contains(region));
+    for (const auto& other : regions) {
+      ASSERT_FALSE(overlap(region, other));
+    }
+    regions.push_back(region);
+  }
+  ASSERT_GT(regions.size(), 50u);
+}
+
+/* EOF */
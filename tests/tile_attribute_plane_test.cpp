@@ -0,0 +1,155 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+#include "collision/tile_attribute_plane.hpp"
+#include "math/aatriangle.hpp"
+#include "math/random.hpp"
+#include "supertux/tile.hpp"
+
+TEST(TileAttributePlaneTest, set)
+{
+  TileAttributePlane plane;
+  plane.resize(3, 70);
+
+  plane.set(1, 65, Tile::SOLID | Tile::SLOPE, AATriangle::NORTHEAST | AATriangle::DEFORM_TOP);
+  ASSERT_TRUE(plane.is_solid(1, 65));
+  ASSERT_TRUE(plane.is_slope(1, 65));
+  ASSERT_FALSE(plane.is_unisolid(1, 65));
+  ASSERT_EQ(AATriangle::NORTHEAST | AATriangle::DEFORM_TOP, plane.get_slope_data(1, 65));
+  ASSERT_FALSE(plane.is_solid(1, 64));
+  ASSERT_FALSE(plane.is_solid(0, 65));
+
+  plane.set(1, 65, Tile::WATER, 3);
+  ASSERT_FALSE(plane.is_solid(1, 65));
+  ASSERT_FALSE(plane.is_slope(1, 65));
+  ASSERT_EQ(0, plane.get_slope_data(1, 65));
+  ASSERT_TRUE(plane.is_water(1, 65));
+}
+
+TEST(TileAttributePlaneTest, no_slopes)
+{
+  TileAttributePlane plane;
+  plane.resize(4, 4);
+  plane.set(2, 2, Tile::SOLID, AATriangle::SOUTHWEST);
+  ASSERT_TRUE(plane.is_solid(2, 2));
+  ASSERT_FALSE(plane.is_slope(2, 2));
+  ASSERT_EQ(0, plane.get_slope_data(2, 2));
+
+  plane.set(3, 3, Tile::SLOPE, AATriangle::SOUTHWEST);
+  ASSERT_EQ(AATriangle::SOUTHWEST, plane.get_slope_data(3, 3));
+  ASSERT_EQ(0, plane.get_slope_data(2, 2));
+
+  plane.resize(4, 4);
+  ASSERT_FALSE(plane.is_slope(3, 3));
+  ASSERT_EQ(0, plane.get_slope_data(3, 3));
+}
+
+TEST(TileAttributePlaneTest, for_each_solid_or_water)
+{
+  TileAttributePlane plane;
+  plane.resize(3, 100);
+  plane.set(0, 70, Tile::WATER, 0);
+  plane.set(0, 3, Tile::SOLID, 0);
+  plane.set(2, 0, Tile::SOLID | Tile::WATER, 0);
+
+  std::vector<std::pair<int, int> > found;
+  ASSERT_TRUE(plane.for_each_solid_or_water(Rect(0, 0, 3, 100), [&found](int x, int y) {
+        found.push_back(std::make_pair(x, y));
+        return true;
+      }));
+  ASSERT_EQ((std::vector<std::pair<int, int> >{ {0, 3}, {0, 70}, {2, 0} }), found);
+
+  found.clear();
+  plane.for_each_solid(Rect(0, 0, 3, 100), [&found](int x, int y) {
+      found.push_back(std::make_pair(x, y));
+      return true;
+    });
+  ASSERT_EQ((std::vector<std::pair<int, int> >{ {0, 3}, {2, 0} }), found);
+}
+
+TEST(TileAttributePlaneTest, for_each_solid_matches_loop)
+{
+  Random rng;
+  rng.seed(99);
+
+  const int width = 40;
+  const int height = 150;
+  std::vector<uint32_t> attributes(width * height);
+
+  TileAttributePlane plane;
+  plane.resize(width, height);
+  for (int y = 0; y < height; ++y) {
+    for (int x = 0; x < width; ++x) {
+      const int r = rng.rand(4);
+      const uint32_t attr =
+        (r == 0) ? Tile::SOLID :
+        (r == 1) ? (Tile::SOLID | Tile::UNISOLID) :
+        (r == 2) ? (Tile::SOLID | Tile::SLOPE) : 0;
+      attributes[y * width + x] = attr;
+      plane.set(x, y, attr, 0);
+    }
+  }
+
+  for (int q = 0; q < 200; ++q)
+  {
+    const int left = rng.rand(width);
+    const int top = rng.rand(height);
+    const Rect cells(left, top, left + rng.rand(width - left + 1), top + rng.rand(height - top + 1));
+
+    std::vector<std::pair<int, int> > expected;
+    bool fully_solid = false;
+    for (int x = cells.left; x < cells.right; ++x) {
+      for (int y = cells.top; y < cells.bottom; ++y) {
+        if (attributes[y * width + x] & Tile::SOLID) {
+          expected.push_back(std::make_pair(x, y));
+        }
+        if (attributes[y * width + x] == Tile::SOLID) {
+          fully_solid = true;
+        }
+      }
+    }
+
+    std::vector<std::pair<int, int> > found;
+    ASSERT_TRUE(plane.for_each_solid(cells, [&found](int x, int y) {
+          found.push_back(std::make_pair(x, y));
+          return true;
+        }));
+    ASSERT_EQ(expected, found);
+    ASSERT_EQ(fully_solid, plane.any_fully_solid(cells));
+  }
+}
+
+TEST(TileAttributePlaneTest, for_each_solid_stops)
+{
+  TileAttributePlane plane;
+  plane.resize(2, 2);
+  plane.set(0, 0, Tile::SOLID, 0);
+  plane.set(1, 1, Tile::SOLID, 0);
+
+  int calls = 0;
+  ASSERT_FALSE(plane.for_each_solid(Rect(0, 0, 2, 2), [&calls](int, int) {
+        calls += 1;
+        return false;
+      }));
+  ASSERT_EQ(1, calls);
+}
+
+/* EOF */
@@ -0,0 +1,103 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+#include <gtest/gtest.h>
+
+#include <math.h>
+
+#include "math/random.hpp"
+#include "util/timer_wheel.hpp"
+
+TEST(TimerWheelTest, due_in_order)
+{
+  TimerWheel<int> wheel(64.0f);
+  wheel.insert(3, 0.30f);
+  wheel.insert(1, 0.10f);
+  wheel.insert(2, 0.20f);
+
+  std::vector<TimerWheel<int>::Entry> due;
+  wheel.collect(0.10f, due);
+  ASSERT_TRUE(due.empty());
+
+  wheel.collect(0.25f, due);
+  ASSERT_EQ(2u, due.size());
+  EXPECT_EQ(1, due[0].value);
+  EXPECT_EQ(2, due[1].value);
+  EXPECT_EQ(1u, wheel.size());
+
+  due.clear();
+  wheel.collect(1.0f, due);
+  ASSERT_EQ(1u, due.size());
+  EXPECT_EQ(3, due[0].value);
+  EXPECT_TRUE(wheel.empty());
+}
+
+TEST(TimerWheelTest, far_future)
+{
+  TimerWheel<int> wheel(64.0f);
+  wheel.insert(1, 5000.0f);
+  wheel.insert(2, INFINITY);
+  wheel.insert(3, 100.0f);
+
+  std::vector<TimerWheel<int>::Entry> due;
+  for (float time = 0.0f; time < 6000.0f; time += 1.0f / 64.0f) {
+    wheel.collect(time, due);
+  }
+  ASSERT_EQ(2u, due.size());
+  EXPECT_EQ(3, due[0].value);
+  EXPECT_EQ(1, due[1].value);
+  EXPECT_EQ(1u, wheel.size());
+}
+
+TEST(TimerWheelTest, matches_sorted_list)
+{
+  Random rng;
+  rng.seed(99);
+
+  TimerWheel<int> wheel(64.0f);
+  std::vector<float> times;
+  for (int i = 0; i < 2000; ++i)
+  {
+    times.push_back(rng.randf(0.0f, 600.0f));
+    wheel.insert(i, times.back());
+  }
+
+  std::vector<TimerWheel<int>::Entry> due;
+  float now = 0.0f;
+  while (!wheel.empty())
+  {
+    now += rng.randf(0.0f, 2.0f);
+    due.clear();
+    wheel.collect(now, due);
+
+    for (size_t i = 0; i < due.size(); ++i)
+    {
+      ASSERT_LT(due[i].time, now);
+      ASSERT_EQ(times[due[i].value], due[i].time);
+      if (i > 0) {
+        ASSERT_LE(due[i - 1].time, due[i].time);
+      }
+      times[due[i].value] = -1.0f;
+    }
+
+    for (const auto& time : times) {
+      ASSERT_TRUE(time < 0.0f || time >= now);
+    }
+  }
+}
+
+/* EOF */
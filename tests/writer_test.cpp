@@ -0,0 +1,77 @@
+//  SuperTux
+//  Copyright (C) 2020 SuperTux Team
+//
+//  This program is free software: you can redistribute it and/or modify
+//  it under the terms of the GNU General Public License as published by
+//  the Free Software Foundation, either version 3 of the License, or
+//  (at your option) any later version.
+//
+//  This program is distributed in the hope that it will be useful,
+//  but WITHOUT ANY WARRANTY; without even the implied warranty of
+//  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+//  GNU General Public License for more details.
+//
+//  You should have received a copy of the GNU General Public License
+//  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+#include <gtest/gtest.h>
+
+#include <sstream>
+
+#include "util/writer.hpp"
+
+TEST(WriterTest, integer_array)
+{
+  std::ostringstream out;
+  {
+    Writer writer(out);
+    writer.start_list("tilemap");
+    writer.write("tiles", std::vector<unsigned int>{ 1, 22, 333, 0, 4000000000u, 5 }, 3);
+    writer.write("row", std::vector<unsigned int>{ 7, 0, 10 }, 0);
+    writer.end_list("tilemap");
+  }
+
+  ASSERT_EQ("(tilemap\n"
+            "  (tiles\n"
+            "  1 22 333\n"
+            "  0 4000000000 5\n"
+            "  )\n"
+            "  (row 7 0 10)\n"
+            ")\n", out.str());
+}
+
+TEST(WriterTest, raw_fragment)
+{
+  std::ostringstream direct;
+  {
+    Writer writer(direct);
+    writer.start_list("state");
+    writer.start_list("worlds");
+    writer.start_list("world1", true);
+    writer.write("solved", true);
+    writer.end_list("world1");
+    writer.end_list("worlds");
+    writer.end_list("state");
+  }
+
+  std::ostringstream pasted;
+  {
+    Writer writer(pasted);
+    writer.start_list("state");
+    writer.start_list("worlds");
+
+    std::ostringstream out;
+    Writer fragment(out, writer.get_indent_depth());
+    fragment.start_list("world1", true);
+    fragment.write("solved", true);
+    fragment.end_list("world1");
+    writer.write_raw(out.str());
+
+    writer.end_list("worlds");
+    writer.end_list("state");
+  }
+
+  ASSERT_EQ(direct.str(), pasted.str());
+}
+
+/* EOF */
@@ -27,6 +27,11 @@ import sys
 import sexpr
 
 
+# already compressed media is stored, PhysFS then reads it straight
+# from the archive instead of running it through inflate
+STORED_SUFFIXES = [".png", ".jpg", ".jpeg", ".ogg", ".ogv", ".dds", ".zip"]
+
+
 def escape_str(string):
     return "\"%s\"" % string.replace("\"", "\\\"")
 
@@ -80,7 +85,9 @@ def process_addon(fout, addon_dir, nfo, base_url, zipdir):
     # see http://pivotallabs.com/barriers-deterministic-reproducible-zip-files/
     os.remove(os.path.join(zipdir, zipfile))
     zipout = os.path.relpath(os.path.join(zipdir, zipfile), addon_dir)
-    subprocess.call(["zip", "-X", "-r", "--quiet", zipout, "."], cwd=addon_dir)
+    subprocess.call(["zip", "-X", "-r", "--quiet",
+                     "-n", ":".join(STORED_SUFFIXES),
+                     zipout, "."], cwd=addon_dir)
 
     with open(os.path.join(zipdir, zipfile), 'rb') as fin:
         addon.md5 = hashlib.md5(fin.read()).hexdigest()
@@ -0,0 +1,54 @@
+#!/bin/bash
+
+#  SuperTux
+#  Copyright (C) 2020 SuperTux Team
+#
+#  This program is free software: you can redistribute it and/or modify
+#  it under the terms of the GNU General Public License as published by
+#  the Free Software Foundation, either version 3 of the License, or
+#  (at your option) any later version.
+#
+#  This program is distributed in the hope that it will be useful,
+#  but WITHOUT ANY WARRANTY; without even the implied warranty of
+#  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+#  GNU General Public License for more details.
+#
+#  You should have received a copy of the GNU General Public License
+#  along with this program.  If not, see <http://www.gnu.org/licenses/>.
+#
+# Writes an ETC2 compressed .ktx file next to every .png below the
+# given directories (data/images by default). TextureManager uses
+# them instead of the .png when the GPU supports ETC2, see the
+# compressed_textures config option. Files whose .ktx is newer than
+# the .png are skipped.
+#
+# Usage: tools/make-compressed-textures.sh [--clean] [directories...]
+
+if ! type EtcTool > /dev/null 2>&1; then
+	echo "Can't find EtcTool!"
+	echo "This script depends on the EtcTool from etc2comp to be in PATH."
+	echo "Homepage of this tool is: https://github.com/google/etc2comp"
+	exit 1
+fi
+
+clean=0
+if [[ "$1" == "--clean" ]]; then
+	clean=1
+	shift
+fi
+
+if [[ "$#" -eq 0 ]]; then
+	set -- data/images
+fi
+
+find "$@" -iname "*.png" -print0 | while read -d $'\0' png; do
+	ktx="${png%.*}.ktx"
+	if [[ "$clean" -eq 1 ]]; then
+		rm -f "$ktx"
+	elif [[ ! "$ktx" -nt "$png" ]]; then
+		echo "$png"
+		EtcTool "$png" -format RGBA8 -effort 60 -output "$ktx" > /dev/null || rm -f "$ktx"
+	fi
+done
+
+# EOF #
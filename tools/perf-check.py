@@ -0,0 +1,226 @@
+#!/usr/bin/env python3
+#
+# SuperTux
+# Copyright (C) 2020 SuperTux Team
+#
+# This program is free software: you can redistribute it and/or modify
+# it under the terms of the GNU General Public License as published by
+# the Free Software Foundation, either version 3 of the License, or
+# (at your option) any later version.
+#
+# This program is distributed in the hope that it will be useful,
+# but WITHOUT ANY WARRANTY; without even the implied warranty of
+# MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+# GNU General Public License for more details.
+#
+# You should have received a copy of the GNU General Public License
+# along with this program.  If not, see <http://www.gnu.org/licenses/>.
+
+
+import argparse
+import json
+import os
+import re
+import subprocess
+import sys
+import tempfile
+
+
+# fields of benchmark_supertux2 --json that aren't measurements
+IGNORED_FIELDS = ["name", "iterations", "items", "ns_per_iteration"]
+
+# timings are allowed to drift by this much even if the baseline
+# runs happened to agree closely, counters are nearly exact
+MIN_TIME_TOLERANCE = 0.05
+MIN_COUNT_TOLERANCE = 0.01
+
+# how many times the spread seen while recording counts as noise
+NOISE_FACTOR = 2.0
+
+# rows of the 'supertux2 --benchmark-demo' report, the whole frame
+# first, then the subsystems, with 50%, 95%, 99% and max in ms
+DEMO_STEPS_RE = re.compile(r"^(\d+) steps$")
+DEMO_ROW_RE = re.compile(r"^(frame|update|collision|scripting|draw)"
+                         r"\s+([0-9.]+)\s+([0-9.]+)\s+([0-9.]+)\s+([0-9.]+)$")
+
+
+def is_time(metric):
+    return metric.startswith("ns_") or metric.endswith("_ms")
+
+
+def median(values):
+    values = sorted(values)
+    mid = len(values) // 2
+    if len(values) % 2:
+        return values[mid]
+    else:
+        return (values[mid - 1] + values[mid]) / 2.0
+
+
+def run_benchmark(benchmark, runs, extra_args):
+    """Returns {name: {metric: [values]}} over all runs"""
+    results = {}
+    for i in range(runs):
+        fd, filename = tempfile.mkstemp(suffix=".json")
+        os.close(fd)
+        try:
+            print("perf-check: run %d/%d" % (i + 1, runs), file=sys.stderr)
+            subprocess.check_call([benchmark, "--json", filename] + extra_args,
+                                  stdout=subprocess.DEVNULL)
+            with open(filename) as fin:
+                for result in json.load(fin):
+                    metrics = results.setdefault(result["name"], {})
+                    for key, value in result.items():
+                        if key not in IGNORED_FIELDS:
+                            metrics.setdefault(key, []).append(float(value))
+        finally:
+            os.remove(filename)
+    return results
+
+
+def run_demo(game, demo, level, runs):
+    """Returns {name: {metric: [values]}} over all runs of one demo"""
+    metrics = {}
+    for i in range(runs):
+        print("perf-check: demo %s run %d/%d" % (demo, i + 1, runs), file=sys.stderr)
+        output = subprocess.check_output([game, "--benchmark-demo", demo, level],
+                                         universal_newlines=True)
+        found = False
+        for line in output.splitlines():
+            match = DEMO_STEPS_RE.match(line.strip())
+            if match:
+                metrics.setdefault("steps", []).append(float(match.group(1)))
+                continue
+
+            match = DEMO_ROW_RE.match(line.strip())
+            if match:
+                found = True
+                row = match.group(1)
+                metrics.setdefault(row + "_p50_ms", []).append(float(match.group(2)))
+                metrics.setdefault(row + "_p99_ms", []).append(float(match.group(4)))
+
+        if not found:
+            raise RuntimeError("%s --benchmark-demo %s printed no step times" % (game, demo))
+
+    name = "demo/" + os.path.splitext(os.path.basename(demo))[0]
+    return {name: metrics}
+
+
+def run_all(args):
+    results = run_benchmark(args.benchmark, args.runs, args.extra)
+    for demo, level in args.demo:
+        results.update(run_demo(args.game, demo, level, args.runs))
+    return results
+
+
+def record(args):
+    results = run_all(args)
+
+    benchmarks = {}
+    for name, metrics in results.items():
+        entry = {}
+        for metric, values in metrics.items():
+            value = median(values)
+            noise = (max(values) - min(values)) / value if value > 0 else 0.0
+            entry[metric] = {"value": value, "noise": noise}
+        benchmarks[name] = entry
+
+    with open(args.baseline, "w") as fout:
+        json.dump({"runs": args.runs, "benchmarks": benchmarks}, fout, indent=2, sort_keys=True)
+        fout.write("\n")
+    print("perf-check: wrote %d benchmarks to %s" % (len(benchmarks), args.baseline))
+    return 0
+
+
+def check(args):
+    if not os.path.exists(args.baseline):
+        print("perf-check: no baseline at %s, record one with 'make perf_baseline'" % args.baseline,
+              file=sys.stderr)
+        return 1
+
+    with open(args.baseline) as fin:
+        baseline = json.load(fin)["benchmarks"]
+
+    results = run_all(args)
+
+    regressions = 0
+    for name in sorted(results):
+        if name not in baseline:
+            print("%-48s new, not in the baseline" % name)
+            continue
+
+        for metric, values in sorted(results[name].items()):
+            reference = baseline[name].get(metric)
+            if reference is None:
+                continue
+
+            value = median(values)
+            base = reference["value"]
+            floor = MIN_TIME_TOLERANCE if is_time(metric) else MIN_COUNT_TOLERANCE
+            tolerance = max(floor, NOISE_FACTOR * reference["noise"])
+            change = (value - base) / base if base > 0 else (1.0 if value > 0 else 0.0)
+
+            status = "ok"
+            if change > tolerance:
+                status = "REGRESSION"
+                regressions += 1
+            elif change < -tolerance:
+                status = "improved"
+
+            print("%-48s %-16s %14.1f -> %14.1f  %+6.1f%% (limit %4.1f%%)  %s" %
+                  (name, metric, base, value, change * 100.0, tolerance * 100.0, status))
+
+    for name in sorted(baseline):
+        if name not in results:
+            print("%-48s missing, was in the baseline" % name)
+
+    if regressions:
+        print("perf-check: %d regressions" % regressions, file=sys.stderr)
+        return 1
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Compare benchmark_supertux2 and demo benchmark "
+                                     "results against a baseline",
+                                     epilog="Arguments after -- are passed on to benchmark_supertux2, "
+                                     "e.g. -- --video opengl33 levels/world1/welcome_antarctica.stl")
+    parser.add_argument("command", choices=["check", "record"],
+                        help="'record' writes the baseline, 'check' fails on regressions against it")
+    parser.add_argument("--benchmark", required=True, metavar="FILE",
+                        help="benchmark_supertux2 executable")
+    parser.add_argument("--game", metavar="FILE",
+                        help="supertux2 executable, needed for --demo")
+    parser.add_argument("--demo", nargs=2, action="append", default=[], metavar=("DEMO", "LEVEL"),
+                        help="also time 'supertux2 --benchmark-demo DEMO LEVEL', can be repeated")
+    parser.add_argument("--baseline", required=True, metavar="FILE",
+                        help="baseline JSON file")
+    parser.add_argument("--runs", type=int, default=None, metavar="N",
+                        help="number of benchmark runs, 5 for record and 3 for check by default")
+
+    argv = sys.argv[1:]
+    extra = []
+    if "--" in argv:
+        index = argv.index("--")
+        argv, extra = argv[:index], argv[index + 1:]
+
+    args = parser.parse_args(argv)
+    args.extra = extra
+
+    if args.demo and not args.game:
+        parser.error("--demo needs --game")
+
+    if args.runs is None:
+        args.runs = 5 if args.command == "record" else 3
+
+    if args.command == "record":
+        return record(args)
+    else:
+        return check(args)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
+
+
+# EOF #